@@ -2,7 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include "media/capabilities/bucket_utility.h"
+#include "media/base/bucket_utility.h"
 
 #include <algorithm>
 #include <cmath>
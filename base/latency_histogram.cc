@@ -0,0 +1,124 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/notreached.h"
+
+namespace media {
+
+// static
+constexpr int LatencyHistogram::kMaxValueBits;
+constexpr int LatencyHistogram::kSubBucketBits;
+constexpr size_t LatencyHistogram::kSubBucketCount;
+constexpr size_t LatencyHistogram::kBucketCount;
+constexpr uint64_t LatencyHistogram::kMaxValue;
+
+LatencyHistogram::LatencyHistogram() {
+  counts_.fill(0);
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& other) = default;
+
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& other) =
+    default;
+
+LatencyHistogram::~LatencyHistogram() = default;
+
+void LatencyHistogram::Add(base::TimeDelta latency) {
+  const uint64_t value =
+      std::min<uint64_t>(std::max<int64_t>(latency.InMicroseconds(), 0),
+                         kMaxValue);
+  counts_[GetBucketIndex(value)]++;
+  min_ = count_ ? std::min(min_, value) : value;
+  max_ = count_ ? std::max(max_, value) : value;
+  sum_ += value;
+  count_++;
+}
+
+void LatencyHistogram::Clear() {
+  counts_.fill(0);
+  count_ = 0;
+  sum_ = 0;
+  min_ = 0;
+  max_ = 0;
+}
+
+base::TimeDelta LatencyHistogram::min() const {
+  return base::Microseconds(min_);
+}
+
+base::TimeDelta LatencyHistogram::max() const {
+  return base::Microseconds(max_);
+}
+
+base::TimeDelta LatencyHistogram::mean() const {
+  return count_ ? base::Microseconds(sum_ / count_) : base::TimeDelta();
+}
+
+base::TimeDelta LatencyHistogram::Percentile(double percentile) const {
+  if (!count_)
+    return base::TimeDelta();
+
+  // The rank of the sample at |percentile|, counting from one.
+  const uint64_t rank = std::max<uint64_t>(
+      1, std::ceil(std::min(std::max(percentile, 0.0), 100.0) / 100 * count_));
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      // Report the largest value of the bucket, within the recorded
+      // extremes.
+      return base::Microseconds(
+          std::max(min_, std::min(GetBucketMaxValue(i), max_)));
+    }
+  }
+
+  NOTREACHED();
+  return max();
+}
+
+base::Value LatencyHistogram::ToValue() const {
+  base::Value value(base::Value::Type::DICTIONARY);
+  value.SetDoubleKey("count", count_);
+  value.SetDoubleKey("min_us", min().InMicrosecondsF());
+  value.SetDoubleKey("mean_us", mean().InMicrosecondsF());
+  value.SetDoubleKey("p50_us", Percentile(50).InMicrosecondsF());
+  value.SetDoubleKey("p90_us", Percentile(90).InMicrosecondsF());
+  value.SetDoubleKey("p99_us", Percentile(99).InMicrosecondsF());
+  value.SetDoubleKey("max_us", max().InMicrosecondsF());
+  return value;
+}
+
+// static
+size_t LatencyHistogram::GetBucketIndex(uint64_t value) {
+  DCHECK_LE(value, kMaxValue);
+  if (value < kSubBucketCount)
+    return value;
+
+  // Values in [2^n, 2^(n+1)) are split into |kSubBucketCount| buckets of width
+  // 2^(n - kSubBucketBits), which follow the buckets of smaller values.
+  const int shift = 63 - base::bits::CountLeadingZeroBits(value) -
+                    kSubBucketBits;
+  return (shift + 1) * kSubBucketCount + (value >> shift) - kSubBucketCount;
+}
+
+// static
+uint64_t LatencyHistogram::GetBucketMaxValue(size_t index) {
+  DCHECK_LT(index, kBucketCount);
+  if (index < kSubBucketCount)
+    return index;
+
+  const int shift = index / kSubBucketCount - 1;
+  const uint64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+}  // namespace media
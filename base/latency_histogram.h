@@ -0,0 +1,71 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_LATENCY_HISTOGRAM_H_
+#define MEDIA_BASE_LATENCY_HISTOGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "base/time/time.h"
+#include "base/values.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// Histogram of latencies with a bounded relative error, in the manner of an
+// HDR histogram. Latencies are recorded in microseconds; values below 32us
+// are exact, and larger values fall into one of 16 linear sub-buckets of
+// their power of two, so percentiles are within 1/16 of the true value.
+// Adding a sample is O(1) and never allocates.
+class MEDIA_EXPORT LatencyHistogram {
+ public:
+  // Latencies longer than 2^36us (about 19 hours) are recorded as that.
+  static constexpr int kMaxValueBits = 36;
+
+  LatencyHistogram();
+  LatencyHistogram(const LatencyHistogram& other);
+  LatencyHistogram& operator=(const LatencyHistogram& other);
+  ~LatencyHistogram();
+
+  // Negative latencies are recorded as zero.
+  void Add(base::TimeDelta latency);
+  void Clear();
+
+  uint64_t count() const { return count_; }
+  base::TimeDelta min() const;
+  base::TimeDelta max() const;
+  base::TimeDelta mean() const;
+
+  // Returns the latency below which |percentile| percent of the samples fall,
+  // e.g. Percentile(99) for the 99th percentile. Returns zero if there are no
+  // samples.
+  base::TimeDelta Percentile(double percentile) const;
+
+  // Returns a dictionary with the count and the min, mean, p50, p90, p99 and
+  // max latencies, in microseconds.
+  base::Value ToValue() const;
+
+ private:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr size_t kSubBucketCount = 1 << kSubBucketBits;
+  static constexpr size_t kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+  static constexpr uint64_t kMaxValue = (uint64_t{1} << kMaxValueBits) - 1;
+
+  static size_t GetBucketIndex(uint64_t value);
+  static uint64_t GetBucketMaxValue(size_t index);
+
+  std::array<uint64_t, kBucketCount> counts_;
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t min_ = 0;
+  uint64_t max_ = 0;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_LATENCY_HISTOGRAM_H_
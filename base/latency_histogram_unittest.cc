@@ -0,0 +1,72 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/latency_histogram.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.min(), base::TimeDelta());
+  EXPECT_EQ(histogram.max(), base::TimeDelta());
+  EXPECT_EQ(histogram.mean(), base::TimeDelta());
+  EXPECT_EQ(histogram.Percentile(50), base::TimeDelta());
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 20; i++)
+    histogram.Add(base::Microseconds(i));
+
+  EXPECT_EQ(histogram.count(), 20u);
+  EXPECT_EQ(histogram.min(), base::Microseconds(1));
+  EXPECT_EQ(histogram.max(), base::Microseconds(20));
+  EXPECT_EQ(histogram.mean(), base::Microseconds(10));
+  EXPECT_EQ(histogram.Percentile(50), base::Microseconds(10));
+  EXPECT_EQ(histogram.Percentile(90), base::Microseconds(18));
+  EXPECT_EQ(histogram.Percentile(100), base::Microseconds(20));
+}
+
+TEST(LatencyHistogramTest, LargeValuesHaveBoundedError) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 1000; i++)
+    histogram.Add(base::Milliseconds(i));
+
+  for (double percentile : {1.0, 25.0, 50.0, 75.0, 99.0}) {
+    const base::TimeDelta expected = base::Milliseconds(percentile * 10);
+    const base::TimeDelta actual = histogram.Percentile(percentile);
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual, expected * (1 + 1.0 / 16));
+  }
+  EXPECT_EQ(histogram.Percentile(100), base::Milliseconds(1000));
+}
+
+TEST(LatencyHistogramTest, ClampsOutOfRangeValues) {
+  LatencyHistogram histogram;
+  histogram.Add(base::Microseconds(-5));
+  histogram.Add(base::Days(30));
+
+  const base::TimeDelta max_latency = base::Microseconds(
+      (int64_t{1} << LatencyHistogram::kMaxValueBits) - 1);
+  EXPECT_EQ(histogram.min(), base::TimeDelta());
+  EXPECT_EQ(histogram.max(), max_latency);
+  EXPECT_EQ(histogram.Percentile(100), max_latency);
+}
+
+TEST(LatencyHistogramTest, Clear) {
+  LatencyHistogram histogram;
+  histogram.Add(base::Milliseconds(5));
+  histogram.Clear();
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.Percentile(50), base::TimeDelta());
+
+  histogram.Add(base::Milliseconds(1));
+  EXPECT_EQ(histogram.min(), base::Milliseconds(1));
+  EXPECT_EQ(histogram.max(), base::Milliseconds(1));
+}
+
+}  // namespace media
@@ -44,6 +44,10 @@ MediaLog::~MediaLog() {
 // Default *Locked implementations
 void MediaLog::AddLogRecordLocked(std::unique_ptr<MediaLogRecord> event) {}
 
+void MediaLog::AddBinaryRecordLocked(const MediaLogBinaryRecord& record) {
+  AddLogRecordLocked(record.ToLogRecord(id()));
+}
+
 std::string MediaLog::GetErrorMessageLocked() {
   return "";
 }
@@ -57,10 +61,10 @@ void MediaLog::AddMessage(MediaLogMessageLevel level, std::string message) {
 }
 
 void MediaLog::NotifyError(PipelineStatus status) {
-  std::unique_ptr<MediaLogRecord> record(
-      CreateRecord(MediaLogRecord::Type::kMediaStatus));
-  record->params.SetIntPath(MediaLog::kStatusText, status);
-  AddLogRecord(std::move(record));
+  MediaLogBinaryRecord record =
+      CreateBinaryRecord(MediaLogRecord::Type::kMediaStatus);
+  MediaLogBinaryPayload<int>::Store(&record, status);
+  AddBinaryRecord(record);
 }
 
 void MediaLog::NotifyError(Status status) {
@@ -100,6 +104,13 @@ void MediaLog::AddLogRecord(std::unique_ptr<MediaLogRecord> record) {
     parent_log_record_->media_log->AddLogRecordLocked(std::move(record));
 }
 
+void MediaLog::AddBinaryRecord(const MediaLogBinaryRecord& record) {
+  base::AutoLock auto_lock(parent_log_record_->lock);
+  // Forward to the parent log's implementation.
+  if (parent_log_record_->media_log)
+    parent_log_record_->media_log->AddBinaryRecordLocked(record);
+}
+
 std::unique_ptr<MediaLogRecord> MediaLog::CreateRecord(
     MediaLogRecord::Type type) {
   auto record = std::make_unique<MediaLogRecord>();
@@ -109,6 +120,13 @@ std::unique_ptr<MediaLogRecord> MediaLog::CreateRecord(
   return record;
 }
 
+MediaLogBinaryRecord MediaLog::CreateBinaryRecord(MediaLogRecord::Type type) {
+  MediaLogBinaryRecord record;
+  record.type = type;
+  record.time = base::TimeTicks::Now();
+  return record;
+}
+
 void MediaLog::InvalidateLog() {
   base::AutoLock auto_lock(parent_log_record_->lock);
   // Do nothing if this log didn't create the record, i.e.
@@ -11,6 +11,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "base/gtest_prod_util.h"
@@ -21,6 +22,7 @@
 #include "build/build_config.h"
 #include "media/base/buffering_state.h"
 #include "media/base/media_export.h"
+#include "media/base/media_log_binary_record.h"
 #include "media/base/media_log_events.h"
 #include "media/base/media_log_message_levels.h"
 #include "media/base/media_log_properties.h"
@@ -38,8 +40,16 @@ namespace media {
 // thread safe in the sense that it may be called from multiple threads, though
 // it will not be called concurrently.  See below for more details.
 //
+// Implementations that pass records on in batches may also override
+// AddBinaryRecordLocked() to keep binary records, e.g. in a
+// MediaLogRecordBuffer, and only convert them when the batch is sent.
+//
 // Implementations should also call InvalidateLog during destruction, to signal
 // to any child logs that the underlying log is no longer available.
+//
+// Properties and events with plain values are recorded as
+// MediaLogBinaryRecords, which are converted into MediaLogRecords without going
+// through an intermediate base::Value.
 class MEDIA_EXPORT MediaLog {
  public:
   static const char kEventKey[];
@@ -73,7 +83,10 @@ class MEDIA_EXPORT MediaLog {
   // is correct.
   template <MediaLogProperty P, typename T>
   void SetProperty(const T& value) {
-    AddLogRecord(CreatePropertyRecord<P, T>(value));
+    SetPropertyImpl<P, T>(
+        std::integral_constant<
+            bool, MediaLogPropertyBinarySupport<P, T>::kSupported>(),
+        value);
   }
 
   // TODO(tmathmeyer) add the ability to report events with a separated
@@ -86,9 +99,10 @@ class MEDIA_EXPORT MediaLog {
   // media_log->AddEvent<MediaLogEvent::kSeek>(1.99);
   template <MediaLogEvent E, typename... T>
   void AddEvent(const T&... value) {
-    std::unique_ptr<MediaLogRecord> record = CreateEventRecord<E, T...>();
-    MediaLogEventTypeSupport<E, T...>::AddExtraData(&record->params, value...);
-    AddLogRecord(std::move(record));
+    AddEventImpl<E, T...>(
+        std::integral_constant<
+            bool, MediaLogEventBinarySupport<E, T...>::kSupported>(),
+        value...);
   }
 
   // TODO(tmathmeyer) replace with Status when that's ready.
@@ -136,6 +150,9 @@ class MEDIA_EXPORT MediaLog {
   //
   // Please see the documentation for the corresponding public methods.
   virtual void AddLogRecordLocked(std::unique_ptr<MediaLogRecord> event);
+  // Receives the records built by CreateBinaryRecord().  The default converts
+  // |record| and passes it to AddLogRecordLocked(), under the lock.
+  virtual void AddBinaryRecordLocked(const MediaLogBinaryRecord& record);
   virtual void OnWebMediaPlayerDestroyedLocked();
   virtual std::string GetErrorMessageLocked();
 
@@ -189,11 +206,45 @@ class MEDIA_EXPORT MediaLog {
   FRIEND_TEST_ALL_PREFIXES(MediaLogTest, EventsAreForwarded);
   FRIEND_TEST_ALL_PREFIXES(MediaLogTest, EventsAreNotForwardedAfterInvalidate);
 
+  template <MediaLogProperty P, typename T>
+  void SetPropertyImpl(std::true_type is_binary, const T& value) {
+    MediaLogBinaryRecord record =
+        CreateBinaryRecord(MediaLogRecord::Type::kMediaPropertyChange);
+    record.property = P;
+    MediaLogPropertyBinarySupport<P, T>::Store(&record, value);
+    AddBinaryRecord(record);
+  }
+  template <MediaLogProperty P, typename T>
+  void SetPropertyImpl(std::false_type is_binary, const T& value) {
+    AddLogRecord(CreatePropertyRecord<P, T>(value));
+  }
+
+  template <MediaLogEvent E, typename... T>
+  void AddEventImpl(std::true_type is_binary, const T&... value) {
+    using Support = MediaLogEventBinarySupport<E, T...>;
+    MediaLogBinaryRecord record =
+        CreateBinaryRecord(MediaLogRecord::Type::kMediaEventTriggered);
+    record.event_name = Support::EventName();
+    record.data_name = Support::DataName();
+    Support::Store(&record, value...);
+    AddBinaryRecord(record);
+  }
+  template <MediaLogEvent E, typename... T>
+  void AddEventImpl(std::false_type is_binary, const T&... value) {
+    std::unique_ptr<MediaLogRecord> record = CreateEventRecord<E, T...>();
+    MediaLogEventTypeSupport<E, T...>::AddExtraData(&record->params, value...);
+    AddLogRecord(std::move(record));
+  }
+
   // Use |parent_log_record| instead of making a new one.
   explicit MediaLog(scoped_refptr<ParentLogRecord> parent_log_record);
 
   // Helper methods to create events and their parameters.
   std::unique_ptr<MediaLogRecord> CreateRecord(MediaLogRecord::Type type);
+  MediaLogBinaryRecord CreateBinaryRecord(MediaLogRecord::Type type);
+
+  // Same as AddLogRecord(), for a record built by CreateBinaryRecord().
+  void AddBinaryRecord(const MediaLogBinaryRecord& record);
 
   // The underlying media log.
   scoped_refptr<ParentLogRecord> parent_log_record_;
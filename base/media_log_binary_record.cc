@@ -0,0 +1,81 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/media_log_binary_record.h"
+
+#include "base/notreached.h"
+#include "media/base/media_log.h"
+#include "media/base/media_log_properties.h"
+#include "media/base/media_serializers.h"
+
+namespace media {
+
+namespace {
+
+// Serializes the payload of |record| the same way as MediaSerialize() does for
+// the type it was stored from.
+base::Value SerializePayload(const MediaLogBinaryRecord& record) {
+  using PayloadType = MediaLogBinaryRecord::PayloadType;
+  switch (record.payload_type) {
+    case PayloadType::kNone:
+      break;
+    case PayloadType::kBool:
+      return MediaSerialize(record.payload.bool_value);
+    case PayloadType::kInt:
+      return MediaSerialize(record.payload.int_value);
+    case PayloadType::kInt64:
+      return MediaSerialize(record.payload.int64_value);
+    case PayloadType::kDouble:
+      return MediaSerialize(record.payload.double_value);
+    case PayloadType::kTimeDelta:
+      return MediaSerialize(base::Microseconds(record.payload.int64_value));
+    case PayloadType::kSize:
+      return MediaSerialize(gfx::Size(record.payload.size_value.width,
+                                      record.payload.size_value.height));
+    case PayloadType::kRendererType:
+      return MediaSerialize(
+          static_cast<RendererType>(record.payload.int_value));
+    case PayloadType::kVideoDecoderType:
+      return MediaSerialize(
+          static_cast<VideoDecoderType>(record.payload.int_value));
+    case PayloadType::kAudioDecoderType:
+      return MediaSerialize(
+          static_cast<AudioDecoderType>(record.payload.int_value));
+  }
+  NOTREACHED();
+  return base::Value();
+}
+
+}  // namespace
+
+std::unique_ptr<MediaLogRecord> MediaLogBinaryRecord::ToLogRecord(
+    int32_t id) const {
+  auto record = std::make_unique<MediaLogRecord>();
+  record->id = id;
+  record->type = type;
+  record->time = time;
+
+  switch (type) {
+    case MediaLogRecord::Type::kMediaPropertyChange:
+      record->params.SetKey(MediaLogPropertyKeyToString(property),
+                            SerializePayload(*this));
+      break;
+    case MediaLogRecord::Type::kMediaEventTriggered:
+      DCHECK(event_name);
+      record->params.SetString(MediaLog::kEventKey, event_name);
+      if (data_name)
+        record->params.SetKey(data_name, SerializePayload(*this));
+      break;
+    case MediaLogRecord::Type::kMediaStatus:
+      record->params.SetKey(MediaLog::kStatusText, SerializePayload(*this));
+      break;
+    case MediaLogRecord::Type::kMessage:
+      // Messages are strings, so they're never stored in binary form.
+      NOTREACHED();
+      break;
+  }
+  return record;
+}
+
+}  // namespace media
@@ -0,0 +1,128 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_MEDIA_LOG_BINARY_RECORD_H_
+#define MEDIA_BASE_MEDIA_LOG_BINARY_RECORD_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/time/time.h"
+#include "media/base/decoder.h"
+#include "media/base/media_export.h"
+#include "media/base/media_log_record.h"
+#include "media/base/renderer_factory_selector.h"
+#include "ui/gfx/geometry/size.h"
+
+namespace media {
+
+enum class MediaLogProperty;
+
+// A MediaLogRecord whose parameter is a plain value, stored as that value
+// rather than as a base::Value dictionary.  Building one doesn't allocate, so
+// logs that send records in batches can hold on to them cheaply and only build
+// the MediaLogRecord when they send it.  See MediaLog::AddBinaryRecordLocked().
+//
+// Only properties and events whose value is serialized as is, by
+// MEDIA_LOG_PROPERTY_SUPPORTS_TYPE or MEDIA_LOG_EVENT_NAMED_DATA, and with a
+// type supported by MediaLogBinaryPayload, are stored this way.
+struct MEDIA_EXPORT MediaLogBinaryRecord {
+  enum class PayloadType : uint8_t {
+    kNone,
+    kBool,
+    kInt,
+    kInt64,
+    kDouble,
+    kTimeDelta,
+    kSize,
+    kRendererType,
+    kVideoDecoderType,
+    kAudioDecoderType,
+  };
+
+  // Returns the MediaLogRecord for this record, as MediaLog would have built
+  // it directly, for the log with id |id|.
+  std::unique_ptr<MediaLogRecord> ToLogRecord(int32_t id) const;
+
+  MediaLogRecord::Type type = MediaLogRecord::Type::kMessage;
+  base::TimeTicks time;
+
+  // For kMediaPropertyChange records.
+  MediaLogProperty property = {};
+
+  // For kMediaEventTriggered records, the name of the event and of its data,
+  // if any.  Both point to string literals.
+  const char* event_name = nullptr;
+  const char* data_name = nullptr;
+
+  PayloadType payload_type = PayloadType::kNone;
+  union {
+    bool bool_value;
+    int int_value;
+    int64_t int64_value;
+    double double_value;
+    struct {
+      int width;
+      int height;
+    } size_value;
+  } payload = {};
+};
+
+// Stores values of type T in a MediaLogBinaryRecord.  Types without a
+// specialization are not supported, and records for them are built as
+// base::Values right away.
+template <typename T>
+struct MediaLogBinaryPayload {
+  static constexpr bool kSupported = false;
+};
+
+#define MEDIA_LOG_BINARY_PAYLOAD(TYPE, PAYLOAD_TYPE, FIELD, VALUE)       \
+  template <>                                                            \
+  struct MediaLogBinaryPayload<TYPE> {                                   \
+    static constexpr bool kSupported = true;                             \
+    static void Store(MediaLogBinaryRecord* record, const TYPE& value) { \
+      using PayloadType = MediaLogBinaryRecord::PayloadType;             \
+      record->payload_type = PayloadType::PAYLOAD_TYPE;                  \
+      record->payload.FIELD = (VALUE);                                   \
+    }                                                                    \
+  }
+
+MEDIA_LOG_BINARY_PAYLOAD(bool, kBool, bool_value, value);
+MEDIA_LOG_BINARY_PAYLOAD(int, kInt, int_value, value);
+MEDIA_LOG_BINARY_PAYLOAD(int64_t, kInt64, int64_value, value);
+MEDIA_LOG_BINARY_PAYLOAD(float, kDouble, double_value, value);
+MEDIA_LOG_BINARY_PAYLOAD(double, kDouble, double_value, value);
+MEDIA_LOG_BINARY_PAYLOAD(base::TimeDelta,
+                         kTimeDelta,
+                         int64_value,
+                         value.InMicroseconds());
+MEDIA_LOG_BINARY_PAYLOAD(RendererType,
+                         kRendererType,
+                         int_value,
+                         static_cast<int>(value));
+MEDIA_LOG_BINARY_PAYLOAD(VideoDecoderType,
+                         kVideoDecoderType,
+                         int_value,
+                         static_cast<int>(value));
+MEDIA_LOG_BINARY_PAYLOAD(AudioDecoderType,
+                         kAudioDecoderType,
+                         int_value,
+                         static_cast<int>(value));
+
+#undef MEDIA_LOG_BINARY_PAYLOAD
+
+template <>
+struct MediaLogBinaryPayload<gfx::Size> {
+  static constexpr bool kSupported = true;
+  static void Store(MediaLogBinaryRecord* record, const gfx::Size& value) {
+    record->payload_type = MediaLogBinaryRecord::PayloadType::kSize;
+    record->payload.size_value.width = value.width();
+    record->payload.size_value.height = value.height();
+  }
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_MEDIA_LOG_BINARY_RECORD_H_
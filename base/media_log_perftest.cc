@@ -0,0 +1,168 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/time/time.h"
+#include "media/base/media_log.h"
+#include "media/base/media_log_record_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "ui/gfx/geometry/size.h"
+
+namespace media {
+
+namespace {
+
+// Number of players that log at once.
+constexpr size_t kNumPlayers = 16;
+
+// Number of records logged by each player in each measurement.
+constexpr size_t kRecordsPerPlayer = 20000;
+
+// Number of records that each iteration of RunLoggingTest() logs.
+constexpr size_t kRecordsPerIteration = 5;
+
+// Number of iterations of RunLoggingTest() between flushes of a batching log.
+constexpr size_t kIterationsPerFlush = 20;
+
+// Counts the records that reach it, like a log that forwards them somewhere.
+// If |batching|, binary records are held in a MediaLogRecordBuffer until
+// Flush(), like a log that sends records in batches.
+class CountingMediaLog : public MediaLog {
+ public:
+  explicit CountingMediaLog(bool batching)
+      : batching_(batching), pending_records_(kLogLimit) {}
+  ~CountingMediaLog() override { InvalidateLog(); }
+
+  // Logs the same records as SetProperty() and AddEvent() do, but always
+  // builds them as base::Values, as MediaLog did before binary records.
+  template <MediaLogProperty P, typename T>
+  void SetValueProperty(const T& value) {
+    AddLogRecord(CreatePropertyRecord<P, T>(value));
+  }
+  template <MediaLogEvent E, typename... T>
+  void AddValueEvent(const T&... value) {
+    std::unique_ptr<MediaLogRecord> record = CreateEventRecord<E, T...>();
+    MediaLogEventTypeSupport<E, T...>::AddExtraData(&record->params, value...);
+    AddLogRecord(std::move(record));
+  }
+
+  // Converts the held records, as a batching log does when it sends them.
+  // Logging happens on the test's only thread, so this needs no lock.
+  void Flush() { num_records_ += pending_records_.TakeRecords(id()).size(); }
+
+  size_t num_records() const { return num_records_; }
+
+ protected:
+  void AddLogRecordLocked(std::unique_ptr<MediaLogRecord> record) override {
+    num_records_++;
+  }
+  void AddBinaryRecordLocked(const MediaLogBinaryRecord& record) override {
+    if (batching_)
+      pending_records_.Add(record);
+    else
+      MediaLog::AddBinaryRecordLocked(record);
+  }
+
+ private:
+  const bool batching_;
+  MediaLogRecordBuffer pending_records_;
+  size_t num_records_ = 0;
+};
+
+enum class LoggingMode {
+  // Records are built as base::Values.
+  kValueRecords,
+  // Records are stored in binary form, and converted as they are added.
+  kBinaryRecords,
+  // Records are stored in binary form, and converted when the log flushes.
+  kBatchedBinaryRecords,
+};
+
+// Reports the rate at which each of |kNumPlayers| players can log the
+// properties and events that a playing video updates most often.
+void RunLoggingTest(LoggingMode mode, const std::string& story) {
+  std::vector<std::unique_ptr<CountingMediaLog>> logs;
+  for (size_t i = 0; i < kNumPlayers; i++) {
+    logs.push_back(std::make_unique<CountingMediaLog>(
+        mode == LoggingMode::kBatchedBinaryRecords));
+  }
+
+  // Time spent flushing batching logs, which happens off the logging threads
+  // in a real batching log.
+  base::TimeDelta flush_time;
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (size_t i = 0; i < kRecordsPerPlayer / kRecordsPerIteration; i++) {
+    if (mode == LoggingMode::kBatchedBinaryRecords &&
+        i % kIterationsPerFlush == 0) {
+      const base::TimeTicks flush_start = base::TimeTicks::Now();
+      for (auto& log : logs)
+        log->Flush();
+      flush_time += base::TimeTicks::Now() - flush_start;
+    }
+    for (auto& log : logs) {
+      if (mode == LoggingMode::kValueRecords) {
+        log->SetValueProperty<MediaLogProperty::kFramerate>(29.97);
+        log->SetValueProperty<MediaLogProperty::kVideoPlaybackRoughness>(
+            1.5 + i);
+        log->SetValueProperty<MediaLogProperty::kVideoPlaybackFreezing>(
+            base::Milliseconds(i));
+        log->SetValueProperty<MediaLogProperty::kResolution>(
+            gfx::Size(1920, 1080));
+        log->AddValueEvent<MediaLogEvent::kSeek>(0.5 * i);
+      } else {
+        log->SetProperty<MediaLogProperty::kFramerate>(29.97);
+        log->SetProperty<MediaLogProperty::kVideoPlaybackRoughness>(1.5 + i);
+        log->SetProperty<MediaLogProperty::kVideoPlaybackFreezing>(
+            base::Milliseconds(i));
+        log->SetProperty<MediaLogProperty::kResolution>(
+            gfx::Size(1920, 1080));
+        log->AddEvent<MediaLogEvent::kSeek>(0.5 * i);
+      }
+    }
+  }
+  const base::TimeTicks flush_start = base::TimeTicks::Now();
+  for (auto& log : logs)
+    log->Flush();
+  const base::TimeTicks end = base::TimeTicks::Now();
+  flush_time += end - flush_start;
+  const double elapsed = (end - start).InSecondsF();
+
+  for (auto& log : logs)
+    EXPECT_EQ(log->num_records(), kRecordsPerPlayer);
+
+  // The rate seen by the code that logs, which is what holding records in
+  // binary form speeds up, and the rate including the conversion.
+  perf_test::PerfResultReporter reporter("media_log", story);
+  reporter.RegisterImportantMetric("_logged_records_per_second_per_player",
+                                   "records/s");
+  reporter.RegisterImportantMetric("_records_per_second_per_player",
+                                   "records/s");
+  reporter.AddResult("_logged_records_per_second_per_player",
+                     kRecordsPerPlayer / (elapsed - flush_time.InSecondsF()));
+  reporter.AddResult("_records_per_second_per_player",
+                     kRecordsPerPlayer / elapsed);
+}
+
+}  // namespace
+
+TEST(MediaLogPerfTest, ValueRecords) {
+  RunLoggingTest(LoggingMode::kValueRecords, "value_records");
+}
+
+TEST(MediaLogPerfTest, BinaryRecords) {
+  RunLoggingTest(LoggingMode::kBinaryRecords, "binary_records");
+}
+
+TEST(MediaLogPerfTest, BatchedBinaryRecords) {
+  RunLoggingTest(LoggingMode::kBatchedBinaryRecords, "batched_binary_records");
+}
+
+}  // namespace media
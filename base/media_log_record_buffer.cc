@@ -0,0 +1,83 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/media_log_record_buffer.h"
+
+#include <utility>
+
+#include "base/check_op.h"
+
+namespace media {
+
+MediaLogRecordBuffer::Entry::Entry() = default;
+
+MediaLogRecordBuffer::Entry::Entry(Entry&&) = default;
+
+MediaLogRecordBuffer::Entry& MediaLogRecordBuffer::Entry::operator=(Entry&&) =
+    default;
+
+MediaLogRecordBuffer::Entry::~Entry() = default;
+
+MediaLogRecordBuffer::MediaLogRecordBuffer(size_t capacity)
+    : capacity_(capacity) {
+  DCHECK_GT(capacity_, 0u);
+}
+
+MediaLogRecordBuffer::~MediaLogRecordBuffer() = default;
+
+void MediaLogRecordBuffer::Add(const MediaLogBinaryRecord& record) {
+  Entry* entry = NextEntry();
+  entry->binary_record = record;
+  entry->record.reset();
+}
+
+void MediaLogRecordBuffer::Add(std::unique_ptr<MediaLogRecord> record) {
+  DCHECK(record);
+  NextEntry()->record = std::move(record);
+}
+
+std::vector<std::unique_ptr<MediaLogRecord>> MediaLogRecordBuffer::TakeRecords(
+    int32_t id) {
+  std::vector<std::unique_ptr<MediaLogRecord>> records;
+  records.reserve(size_);
+  for (size_t i = 0; i < size_; i++) {
+    Entry& entry = entries_[(begin_ + i) % entries_.size()];
+    if (entry.record)
+      records.push_back(std::move(entry.record));
+    else
+      records.push_back(entry.binary_record.ToLogRecord(id));
+  }
+  Clear();
+  return records;
+}
+
+void MediaLogRecordBuffer::Clear() {
+  // Keep |entries_| allocated, since it's likely to fill up again.
+  for (Entry& entry : entries_)
+    entry.record.reset();
+  begin_ = 0;
+  size_ = 0;
+}
+
+MediaLogRecordBuffer::Entry* MediaLogRecordBuffer::NextEntry() {
+  if (entries_.size() < capacity_ && begin_ + size_ == entries_.size()) {
+    entries_.emplace_back();
+    size_++;
+    return &entries_.back();
+  }
+
+  if (size_ < capacity_) {
+    Entry* entry = &entries_[(begin_ + size_) % entries_.size()];
+    size_++;
+    return entry;
+  }
+
+  // Full: overwrite the oldest entry.
+  Entry* entry = &entries_[begin_];
+  begin_ = (begin_ + 1) % entries_.size();
+  num_dropped_++;
+  return entry;
+}
+
+}  // namespace media
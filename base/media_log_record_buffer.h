@@ -0,0 +1,82 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_MEDIA_LOG_RECORD_BUFFER_H_
+#define MEDIA_BASE_MEDIA_LOG_RECORD_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "media/base/media_export.h"
+#include "media/base/media_log_binary_record.h"
+#include "media/base/media_log_record.h"
+
+namespace media {
+
+// Ring buffer of the most recent records that a batching MediaLog has not
+// passed on yet.  Records are kept in binary form when they have one, and are
+// only converted into MediaLogRecords when they're taken.  Once full, each new
+// record replaces the oldest one.
+//
+// Not thread safe.
+class MEDIA_EXPORT MediaLogRecordBuffer {
+ public:
+  explicit MediaLogRecordBuffer(size_t capacity);
+
+  MediaLogRecordBuffer(const MediaLogRecordBuffer&) = delete;
+  MediaLogRecordBuffer& operator=(const MediaLogRecordBuffer&) = delete;
+
+  ~MediaLogRecordBuffer();
+
+  void Add(const MediaLogBinaryRecord& record);
+  void Add(std::unique_ptr<MediaLogRecord> record);
+
+  // Removes all records, and returns them oldest first.  Binary records are
+  // converted into MediaLogRecords for the log with id |id|.
+  std::vector<std::unique_ptr<MediaLogRecord>> TakeRecords(int32_t id);
+
+  // Removes all records without converting them.
+  void Clear();
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Number of records that have been replaced by newer ones, since this was
+  // created.
+  size_t num_dropped() const { return num_dropped_; }
+
+ private:
+  // Either a binary record, or a MediaLogRecord if |record| is set.
+  struct Entry {
+    Entry();
+    Entry(Entry&&);
+    Entry& operator=(Entry&&);
+    ~Entry();
+
+    MediaLogBinaryRecord binary_record;
+    std::unique_ptr<MediaLogRecord> record;
+  };
+
+  // Returns the entry to store the next record in, dropping the oldest one if
+  // the buffer is full.
+  Entry* NextEntry();
+
+  const size_t capacity_;
+
+  // Grows up to |capacity_| entries, and is then reused.
+  std::vector<Entry> entries_;
+
+  // Index of the oldest entry in |entries_|, and number of entries in use.
+  size_t begin_ = 0;
+  size_t size_ = 0;
+
+  size_t num_dropped_ = 0;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_MEDIA_LOG_RECORD_BUFFER_H_
@@ -0,0 +1,92 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/media_log_record_buffer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+namespace {
+
+constexpr int32_t kLogId = 7;
+
+MediaLogBinaryRecord CreateStatusRecord(int status) {
+  MediaLogBinaryRecord record;
+  record.type = MediaLogRecord::Type::kMediaStatus;
+  MediaLogBinaryPayload<int>::Store(&record, status);
+  return record;
+}
+
+std::unique_ptr<MediaLogRecord> CreateMessageRecord(const std::string& text) {
+  auto record = std::make_unique<MediaLogRecord>();
+  record->id = kLogId;
+  record->type = MediaLogRecord::Type::kMessage;
+  record->params.SetStringKey("info", text);
+  return record;
+}
+
+void ExpectSameRecord(const MediaLogRecord& expected,
+                      const MediaLogRecord& actual) {
+  EXPECT_EQ(expected.id, actual.id);
+  EXPECT_EQ(expected.type, actual.type);
+  EXPECT_EQ(expected.params, actual.params);
+}
+
+}  // namespace
+
+TEST(MediaLogRecordBufferTest, TakesRecordsOldestFirst) {
+  MediaLogRecordBuffer buffer(4);
+  buffer.Add(CreateStatusRecord(1));
+  buffer.Add(CreateMessageRecord("two"));
+  buffer.Add(CreateStatusRecord(3));
+  EXPECT_EQ(buffer.size(), 3u);
+
+  // Binary records are converted as they are taken.
+  std::vector<std::unique_ptr<MediaLogRecord>> records =
+      buffer.TakeRecords(kLogId);
+  ASSERT_EQ(records.size(), 3u);
+  ExpectSameRecord(*CreateStatusRecord(1).ToLogRecord(kLogId), *records[0]);
+  ExpectSameRecord(*CreateMessageRecord("two"), *records[1]);
+  ExpectSameRecord(*CreateStatusRecord(3).ToLogRecord(kLogId), *records[2]);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.num_dropped(), 0u);
+}
+
+TEST(MediaLogRecordBufferTest, DropsOldestRecordsWhenFull) {
+  MediaLogRecordBuffer buffer(2);
+  buffer.Add(CreateStatusRecord(1));
+  buffer.Add(CreateMessageRecord("two"));
+  buffer.Add(CreateStatusRecord(3));
+  buffer.Add(CreateStatusRecord(4));
+  EXPECT_EQ(buffer.size(), 2u);
+  EXPECT_EQ(buffer.num_dropped(), 2u);
+
+  std::vector<std::unique_ptr<MediaLogRecord>> records =
+      buffer.TakeRecords(kLogId);
+  ASSERT_EQ(records.size(), 2u);
+  ExpectSameRecord(*CreateStatusRecord(3).ToLogRecord(kLogId), *records[0]);
+  ExpectSameRecord(*CreateStatusRecord(4).ToLogRecord(kLogId), *records[1]);
+
+  // The buffer is reused once emptied.
+  buffer.Add(CreateMessageRecord("five"));
+  records = buffer.TakeRecords(kLogId);
+  ASSERT_EQ(records.size(), 1u);
+  ExpectSameRecord(*CreateMessageRecord("five"), *records[0]);
+}
+
+TEST(MediaLogRecordBufferTest, Clear) {
+  MediaLogRecordBuffer buffer(2);
+  buffer.Add(CreateStatusRecord(1));
+  buffer.Add(CreateMessageRecord("two"));
+  buffer.Clear();
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_TRUE(buffer.TakeRecords(kLogId).empty());
+}
+
+}  // namespace media
@@ -5,6 +5,7 @@
 #ifndef MEDIA_BASE_MEDIA_LOG_TYPE_ENFORCEMENT_H_
 #define MEDIA_BASE_MEDIA_LOG_TYPE_ENFORCEMENT_H_
 
+#include "media/base/media_log_binary_record.h"
 #include "media/base/media_serializers.h"
 
 namespace media {
@@ -27,23 +28,45 @@ struct MediaLogPropertyTypeSupport {};
 template <MediaLogEvent EVENT, typename T = internal::UnmatchableType>
 struct MediaLogEventTypeSupport {};
 
+// Properties and events whose value can be stored in a MediaLogBinaryRecord,
+// because it is serialized as is.  Only the macros below specialize these, so
+// properties and events with a custom conversion always build a base::Value.
+template <MediaLogProperty PROP, typename T>
+struct MediaLogPropertyBinarySupport {
+  static constexpr bool kSupported = false;
+};
+
+template <MediaLogEvent EVENT, typename T = internal::UnmatchableType>
+struct MediaLogEventBinarySupport {
+  static constexpr bool kSupported = false;
+};
+
 // Lets us define the supported type in a single line in media_log_properties.h.
-#define MEDIA_LOG_PROPERTY_SUPPORTS_TYPE(PROPERTY, TYPE)                 \
-  template <>                                                            \
-  struct MediaLogPropertyTypeSupport<MediaLogProperty::PROPERTY, TYPE> { \
-    static base::Value Convert(const TYPE& type) {                       \
-      return MediaSerialize<TYPE>(type);                                 \
-    }                                                                    \
-  }
+#define MEDIA_LOG_PROPERTY_SUPPORTS_TYPE(PROPERTY, TYPE)                   \
+  template <>                                                              \
+  struct MediaLogPropertyTypeSupport<MediaLogProperty::PROPERTY, TYPE> {   \
+    static base::Value Convert(const TYPE& type) {                         \
+      return MediaSerialize<TYPE>(type);                                   \
+    }                                                                      \
+  };                                                                       \
+  template <>                                                              \
+  struct MediaLogPropertyBinarySupport<MediaLogProperty::PROPERTY, TYPE>   \
+      : MediaLogBinaryPayload<TYPE> {}
 
-#define MEDIA_LOG_EVENT_NAMED_DATA(EVENT, TYPE, DISPLAY)           \
-  template <>                                                      \
-  struct MediaLogEventTypeSupport<MediaLogEvent::EVENT, TYPE> {    \
-    static void AddExtraData(base::Value* params, const TYPE& t) { \
-      DCHECK(params);                                              \
-      params->SetKey(DISPLAY, MediaSerialize<TYPE>(t));            \
-    }                                                              \
-    static std::string TypeName() { return #EVENT; }               \
+#define MEDIA_LOG_EVENT_NAMED_DATA(EVENT, TYPE, DISPLAY)             \
+  template <>                                                        \
+  struct MediaLogEventTypeSupport<MediaLogEvent::EVENT, TYPE> {      \
+    static void AddExtraData(base::Value* params, const TYPE& t) {   \
+      DCHECK(params);                                                \
+      params->SetKey(DISPLAY, MediaSerialize<TYPE>(t));              \
+    }                                                                \
+    static std::string TypeName() { return #EVENT; }                 \
+  };                                                                 \
+  template <>                                                        \
+  struct MediaLogEventBinarySupport<MediaLogEvent::EVENT, TYPE>      \
+      : MediaLogBinaryPayload<TYPE> {                                \
+    static const char* EventName() { return #EVENT; }                \
+    static const char* DataName() { return DISPLAY; }                \
   }
 
 #define MEDIA_LOG_EVENT_NAMED_DATA_OP(EVENT, TYPE, DISPLAY, OP)    \
@@ -57,11 +80,18 @@ struct MediaLogEventTypeSupport {};
   }
 
 // Specifically do not create the Convert or DisplayName methods
-#define MEDIA_LOG_EVENT_TYPELESS(EVENT)                   \
-  template <>                                             \
-  struct MediaLogEventTypeSupport<MediaLogEvent::EVENT> { \
-    static std::string TypeName() { return #EVENT; }      \
-    static void AddExtraData(base::Value* params) {}      \
+#define MEDIA_LOG_EVENT_TYPELESS(EVENT)                     \
+  template <>                                               \
+  struct MediaLogEventTypeSupport<MediaLogEvent::EVENT> {   \
+    static std::string TypeName() { return #EVENT; }        \
+    static void AddExtraData(base::Value* params) {}        \
+  };                                                        \
+  template <>                                               \
+  struct MediaLogEventBinarySupport<MediaLogEvent::EVENT> { \
+    static constexpr bool kSupported = true;                \
+    static const char* EventName() { return #EVENT; }       \
+    static const char* DataName() { return nullptr; }       \
+    static void Store(MediaLogBinaryRecord* record) {}      \
   }
 
 }  // namespace media
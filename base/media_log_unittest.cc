@@ -4,6 +4,7 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "base/macros.h"
 #include "media/base/media_log.h"
@@ -11,9 +12,34 @@
 #include "testing/gtest/include/gtest/gtest.h"
 
 using testing::_;
+using testing::InSequence;
 
 namespace media {
 
+// Keeps the binary records it gets, and counts the other records.
+class BinaryRecordMediaLog : public MediaLog {
+ public:
+  BinaryRecordMediaLog() = default;
+  ~BinaryRecordMediaLog() override { InvalidateLog(); }
+
+  const std::vector<MediaLogBinaryRecord>& binary_records() const {
+    return binary_records_;
+  }
+  int num_records() const { return num_records_; }
+
+ protected:
+  void AddLogRecordLocked(std::unique_ptr<MediaLogRecord> event) override {
+    num_records_++;
+  }
+  void AddBinaryRecordLocked(const MediaLogBinaryRecord& record) override {
+    binary_records_.push_back(record);
+  }
+
+ private:
+  std::vector<MediaLogBinaryRecord> binary_records_;
+  int num_records_ = 0;
+};
+
 // Friend class of MediaLog for access to internal constants.
 class MediaLogTest : public testing::Test {
  protected:
@@ -100,4 +126,63 @@ TEST_F(MediaLogTest, TruncateLongUrlStrings) {
   EXPECT_EQ(*event->params.FindStringPath("origin_url"), expected_url);
 }
 
+TEST_F(MediaLogTest, BinaryRecordsMatchValueRecords) {
+  CreateLog();
+  InSequence s;
+
+  // Properties and events with plain values are recorded in binary form, and
+  // should be converted into the same records as the base::Value path builds.
+  EXPECT_MEDIA_LOG_ON(*root_log_, MockMediaLog::MediaEventToLogString(
+                                      *root_log_->CreatePropertyTestEvent<
+                                          MediaLogProperty::kResolution>(
+                                          gfx::Size(640, 480))));
+  EXPECT_MEDIA_LOG_ON(*root_log_,
+                      MockMediaLog::MediaEventToLogString(
+                          *root_log_->CreatePropertyTestEvent<
+                              MediaLogProperty::kVideoPlaybackFreezing>(
+                              base::TimeDelta::Max())));
+  EXPECT_MEDIA_LOG_ON(*root_log_, MockMediaLog::MediaEventToLogString(
+                                      *root_log_->CreatePropertyTestEvent<
+                                          MediaLogProperty::kTotalBytes>(
+                                          int64_t{12345})));
+  EXPECT_MEDIA_LOG_ON(*root_log_,
+                      MockMediaLog::MediaEventToLogString(
+                          *root_log_->CreatePropertyTestEvent<
+                              MediaLogProperty::kVideoDecoderName>(
+                              VideoDecoderType::kFFmpeg)));
+  EXPECT_MEDIA_LOG_ON(*root_log_, "{\"event\":\"kSeek\",\"seek_target\":1.5}");
+  EXPECT_MEDIA_LOG_ON(*root_log_, "{\"event\":\"kPlay\"}");
+  EXPECT_MEDIA_LOG_ON(*root_log_, "pipeline_error PIPELINE_ERROR_DECODE");
+
+  root_log_->SetProperty<MediaLogProperty::kResolution>(gfx::Size(640, 480));
+  root_log_->SetProperty<MediaLogProperty::kVideoPlaybackFreezing>(
+      base::TimeDelta::Max());
+  root_log_->SetProperty<MediaLogProperty::kTotalBytes>(int64_t{12345});
+  root_log_->SetProperty<MediaLogProperty::kVideoDecoderName>(
+      VideoDecoderType::kFFmpeg);
+  root_log_->AddEvent<MediaLogEvent::kSeek>(1.5);
+  root_log_->AddEvent<MediaLogEvent::kPlay>();
+  root_log_->NotifyError(PIPELINE_ERROR_DECODE);
+
+  auto event = root_log_->take_most_recent_event();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->id, root_log_->id());
+  EXPECT_EQ(event->type, MediaLogRecord::Type::kMediaStatus);
+}
+
+TEST_F(MediaLogTest, BinaryRecordsAreNotConvertedIfOverridden) {
+  BinaryRecordMediaLog root_log;
+  std::unique_ptr<MediaLog> child_media_log(root_log.Clone());
+  child_media_log->SetProperty<MediaLogProperty::kBitrate>(1000);
+  child_media_log->AddEvent<MediaLogEvent::kPlay>();
+  child_media_log->AddMessage(MediaLogMessageLevel::kERROR, "test");
+
+  ASSERT_EQ(root_log.binary_records().size(), 2u);
+  EXPECT_EQ(root_log.binary_records()[0].type,
+            MediaLogRecord::Type::kMediaPropertyChange);
+  EXPECT_EQ(root_log.binary_records()[1].type,
+            MediaLogRecord::Type::kMediaEventTriggered);
+  EXPECT_EQ(root_log.num_records(), 1);
+}
+
 }  // namespace media
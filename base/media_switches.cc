@@ -549,6 +549,17 @@ const base::Feature kVaapiVp9kSVCHWEncoding{"VaapiVp9kSVCHWEncoding",
 const base::Feature kVideoBlitColorAccuracy{"video-blit-color-accuracy",
                                             base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Rank the candidate video decoders of a playback by the decode stats that
+// earlier playbacks in the same process recorded for them.
+const base::Feature kVideoDecoderScoring{"VideoDecoderScoring",
+                                         base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Hash the content of decoded software video frames so that the compositor can
+// skip re-uploading frames whose content did not change, e.g. slides or screen
+// recordings. Hashing backs off while the content keeps changing.
+const base::Feature kVideoFrameContentHashing{
+    "VideoFrameContentHashing", base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Enable VP9 k-SVC decoding with HW decoder for webrtc use case.
 const base::Feature kVp9kSVCHWDecoding {
   "Vp9kSVCHWDecoding",
@@ -34,6 +34,8 @@ class MEDIA_EXPORT NullMediaLog : public media::MediaLog {
 
   void AddLogRecordLocked(
       std::unique_ptr<media::MediaLogRecord> event) override {}
+  void AddBinaryRecordLocked(
+      const media::MediaLogBinaryRecord& record) override {}
 };
 
 }  // namespace media
@@ -0,0 +1,101 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/pipeline_latency_profiler.h"
+
+#include "base/json/json_writer.h"
+
+namespace media {
+
+const char* GetPipelineStageName(PipelineStage stage) {
+  switch (stage) {
+    case PipelineStage::kDemuxerParse:
+      return "demuxer_parse";
+    case PipelineStage::kDemuxerRead:
+      return "demuxer_read";
+    case PipelineStage::kDecode:
+      return "decode";
+    case PipelineStage::kReadyQueue:
+      return "ready_queue";
+    case PipelineStage::kRender:
+      return "render";
+  }
+}
+
+// static
+std::atomic<bool> PipelineLatencyProfiler::enabled_{false};
+
+// static
+PipelineLatencyProfiler* PipelineLatencyProfiler::GetInstance() {
+  static base::NoDestructor<PipelineLatencyProfiler> profiler;
+  return profiler.get();
+}
+
+PipelineLatencyProfiler::PipelineLatencyProfiler() = default;
+
+PipelineLatencyProfiler::~PipelineLatencyProfiler() = default;
+
+void PipelineLatencyProfiler::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void PipelineLatencyProfiler::Record(DemuxerStream::Type stream_type,
+                                     PipelineStage stage,
+                                     base::TimeDelta latency) {
+  if (!IsEnabled())
+    return;
+
+  base::AutoLock auto_lock(lock_);
+  histograms_[HistogramKey(stream_type, stage)].Add(latency);
+}
+
+void PipelineLatencyProfiler::Reset() {
+  base::AutoLock auto_lock(lock_);
+  histograms_.clear();
+}
+
+PipelineLatencyProfiler::HistogramMap PipelineLatencyProfiler::GetHistograms()
+    const {
+  base::AutoLock auto_lock(lock_);
+  return histograms_;
+}
+
+base::Value PipelineLatencyProfiler::ToValue() const {
+  base::Value value(base::Value::Type::DICTIONARY);
+  for (const auto& kv : GetHistograms()) {
+    const std::string stream_type =
+        DemuxerStream::GetTypeName(kv.first.first);
+    base::Value* stages = value.FindDictKey(stream_type);
+    if (!stages) {
+      stages = value.SetKey(stream_type,
+                            base::Value(base::Value::Type::DICTIONARY));
+    }
+    stages->SetKey(GetPipelineStageName(kv.first.second), kv.second.ToValue());
+  }
+  return value;
+}
+
+std::string PipelineLatencyProfiler::ToJSON() const {
+  std::string json;
+  base::JSONWriter::Write(ToValue(), &json);
+  return json;
+}
+
+ScopedPipelineStageTimer::ScopedPipelineStageTimer(
+    DemuxerStream::Type stream_type,
+    PipelineStage stage)
+    : stream_type_(stream_type), stage_(stage) {
+  if (PipelineLatencyProfiler::IsEnabled())
+    start_ = base::TimeTicks::Now();
+}
+
+ScopedPipelineStageTimer::~ScopedPipelineStageTimer() {
+  if (start_.is_null())
+    return;
+
+  PipelineLatencyProfiler::GetInstance()->Record(
+      stream_type_, stage_, base::TimeTicks::Now() - start_);
+}
+
+}  // namespace media
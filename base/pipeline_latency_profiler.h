@@ -0,0 +1,113 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_PIPELINE_LATENCY_PROFILER_H_
+#define MEDIA_BASE_PIPELINE_LATENCY_PROFILER_H_
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "media/base/demuxer_stream.h"
+#include "media/base/latency_histogram.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// Stages of the media pipeline whose latency PipelineLatencyProfiler records.
+enum class PipelineStage {
+  // ChunkDemuxer parsing and buffering appended data, in AppendData() or
+  // AppendChunks(). Not specific to a stream, so recorded for
+  // DemuxerStream::UNKNOWN.
+  kDemuxerParse,
+  // DecoderStream waiting for a DemuxerStream::Read() to return a buffer.
+  kDemuxerRead,
+  // A decoder decoding a buffer, from Decode() to its decode callback.
+  kDecode,
+  // Decoded output waiting in DecoderStream to be read by the renderer.
+  kReadyQueue,
+  // AudioRendererImpl or VideoRendererImpl rendering, from the start to the
+  // end of their Render() call.
+  kRender,
+  kMaxValue = kRender,
+};
+
+MEDIA_EXPORT const char* GetPipelineStageName(PipelineStage stage);
+
+// Records latency histograms for each stage of the media pipelines in the
+// process, for each stream type. Recording is off by default; until it is
+// enabled, instrumented code only checks IsEnabled(), a relaxed atomic load,
+// and does not read the clock.
+class MEDIA_EXPORT PipelineLatencyProfiler {
+ public:
+  using HistogramKey = std::pair<DemuxerStream::Type, PipelineStage>;
+  using HistogramMap = std::map<HistogramKey, LatencyHistogram>;
+
+  static PipelineLatencyProfiler* GetInstance();
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  PipelineLatencyProfiler(const PipelineLatencyProfiler&) = delete;
+  PipelineLatencyProfiler& operator=(const PipelineLatencyProfiler&) = delete;
+
+  // Starts or stops recording. Recorded histograms are kept until Reset().
+  void SetEnabled(bool enabled);
+
+  // Records |latency| for |stage| of a |stream_type| stream. Does nothing if
+  // recording is disabled.
+  void Record(DemuxerStream::Type stream_type,
+              PipelineStage stage,
+              base::TimeDelta latency);
+
+  // Discards all recorded histograms.
+  void Reset();
+
+  // Returns a copy of the histogram of each stream type and stage that has
+  // samples.
+  HistogramMap GetHistograms() const;
+
+  // Returns the histograms as a dictionary of stream types, each a dictionary
+  // of stages; see LatencyHistogram::ToValue().
+  base::Value ToValue() const;
+
+  // Returns ToValue() as JSON.
+  std::string ToJSON() const;
+
+ private:
+  friend class base::NoDestructor<PipelineLatencyProfiler>;
+
+  PipelineLatencyProfiler();
+  ~PipelineLatencyProfiler();
+
+  static std::atomic<bool> enabled_;
+
+  mutable base::Lock lock_;
+  HistogramMap histograms_ GUARDED_BY(lock_);
+};
+
+// Records the time from its construction to its destruction for |stage|, if
+// the profiler was enabled at construction.
+class MEDIA_EXPORT ScopedPipelineStageTimer {
+ public:
+  ScopedPipelineStageTimer(DemuxerStream::Type stream_type,
+                           PipelineStage stage);
+  ScopedPipelineStageTimer(const ScopedPipelineStageTimer&) = delete;
+  ScopedPipelineStageTimer& operator=(const ScopedPipelineStageTimer&) = delete;
+  ~ScopedPipelineStageTimer();
+
+ private:
+  const DemuxerStream::Type stream_type_;
+  const PipelineStage stage_;
+  base::TimeTicks start_;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_PIPELINE_LATENCY_PROFILER_H_
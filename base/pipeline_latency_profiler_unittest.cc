@@ -0,0 +1,90 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/pipeline_latency_profiler.h"
+
+#include "base/json/json_reader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+class PipelineLatencyProfilerTest : public testing::Test {
+ public:
+  PipelineLatencyProfilerTest()
+      : profiler_(PipelineLatencyProfiler::GetInstance()) {}
+
+  ~PipelineLatencyProfilerTest() override {
+    profiler_->SetEnabled(false);
+    profiler_->Reset();
+  }
+
+ protected:
+  PipelineLatencyProfiler* const profiler_;
+};
+
+TEST_F(PipelineLatencyProfilerTest, DisabledByDefault) {
+  EXPECT_FALSE(PipelineLatencyProfiler::IsEnabled());
+
+  profiler_->Record(DemuxerStream::VIDEO, PipelineStage::kDecode,
+                    base::Milliseconds(5));
+  {
+    ScopedPipelineStageTimer timer(DemuxerStream::AUDIO,
+                                   PipelineStage::kRender);
+  }
+  EXPECT_TRUE(profiler_->GetHistograms().empty());
+}
+
+TEST_F(PipelineLatencyProfilerTest, RecordsEachStreamAndStage) {
+  profiler_->SetEnabled(true);
+  profiler_->Record(DemuxerStream::VIDEO, PipelineStage::kDecode,
+                    base::Milliseconds(5));
+  profiler_->Record(DemuxerStream::VIDEO, PipelineStage::kDecode,
+                    base::Milliseconds(7));
+  profiler_->Record(DemuxerStream::AUDIO, PipelineStage::kDecode,
+                    base::Milliseconds(1));
+  {
+    ScopedPipelineStageTimer timer(DemuxerStream::AUDIO,
+                                   PipelineStage::kRender);
+  }
+
+  const PipelineLatencyProfiler::HistogramMap histograms =
+      profiler_->GetHistograms();
+  ASSERT_EQ(histograms.size(), 3u);
+
+  const LatencyHistogram& video_decode =
+      histograms.at({DemuxerStream::VIDEO, PipelineStage::kDecode});
+  EXPECT_EQ(video_decode.count(), 2u);
+  EXPECT_EQ(video_decode.min(), base::Milliseconds(5));
+  EXPECT_EQ(video_decode.max(), base::Milliseconds(7));
+  EXPECT_EQ(
+      histograms.at({DemuxerStream::AUDIO, PipelineStage::kDecode}).count(),
+      1u);
+  EXPECT_EQ(
+      histograms.at({DemuxerStream::AUDIO, PipelineStage::kRender}).count(),
+      1u);
+
+  // Disabling keeps what was recorded, and Reset() discards it.
+  profiler_->SetEnabled(false);
+  EXPECT_EQ(profiler_->GetHistograms().size(), 3u);
+  profiler_->Reset();
+  EXPECT_TRUE(profiler_->GetHistograms().empty());
+}
+
+TEST_F(PipelineLatencyProfilerTest, ToJSON) {
+  profiler_->SetEnabled(true);
+  profiler_->Record(DemuxerStream::VIDEO, PipelineStage::kDemuxerRead,
+                    base::Microseconds(20));
+  profiler_->Record(DemuxerStream::UNKNOWN, PipelineStage::kDemuxerParse,
+                    base::Microseconds(10));
+
+  absl::optional<base::Value> value =
+      base::JSONReader::Read(profiler_->ToJSON());
+  ASSERT_TRUE(value);
+  EXPECT_EQ(value->FindDoublePath("video.demuxer_read.count"), 1);
+  EXPECT_EQ(value->FindDoublePath("video.demuxer_read.p50_us"), 20);
+  EXPECT_EQ(value->FindDoublePath("unknown.demuxer_parse.max_us"), 10);
+  EXPECT_FALSE(value->FindPath("audio"));
+}
+
+}  // namespace media
@@ -14,6 +14,7 @@
 #include "base/bits.h"
 #include "base/cxx17_backports.h"
 #include "base/logging.h"
+#include "base/no_destructor.h"
 #include "base/process/memory.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/stringprintf.h"
@@ -875,11 +876,17 @@ scoped_refptr<VideoFrame> VideoFrame::WrapVideoFrame(
   }
 
   scoped_refptr<VideoFrame> wrapping_frame(
-      new VideoFrame(new_layout.value(), frame->storage_type(), visible_rect,
-                     natural_size, frame->timestamp()));
+      new VideoFrame(std::move(new_layout).value(), frame->storage_type(),
+                     visible_rect, natural_size, frame->timestamp()));
 
-  // Copy all metadata to the wrapped frame->
-  wrapping_frame->metadata().MergeMetadataFrom(frame->metadata());
+  // Copy all metadata to the wrapped frame. |wrapping_frame| has no metadata
+  // of its own yet, so a plain copy is equivalent to merging and cheaper.
+  wrapping_frame->set_metadata(frame->metadata());
+
+  // The content hash covers the visible rect and format, so it no longer
+  // applies if either changes.
+  if (format != frame->format() || visible_rect != frame->visible_rect())
+    wrapping_frame->metadata().content_hash.reset();
 
   if (frame->IsMappable()) {
     for (size_t i = 0; i < new_plane_count; ++i) {
@@ -888,7 +895,6 @@ scoped_refptr<VideoFrame> VideoFrame::WrapVideoFrame(
   }
 
 #if defined(OS_LINUX) || defined(OS_CHROMEOS)
-  DCHECK(frame->dmabuf_fds_);
   // If there are any |dmabuf_fds_| plugged in, we should refer them too.
   wrapping_frame->dmabuf_fds_ = frame->dmabuf_fds_;
 #endif
@@ -903,10 +909,10 @@ scoped_refptr<VideoFrame> VideoFrame::WrapVideoFrame(
   //
   // We must still keep |frame| alive though since it may have destruction
   // observers which signal that the underlying resource is okay to reuse. E.g.,
-  // VideoFramePool.
+  // VideoFramePool. Hold it directly rather than through a bound destruction
+  // observer to save an allocation per wrap.
   if (frame->wrapped_frame_) {
-    wrapping_frame->AddDestructionObserver(
-        base::BindOnce([](scoped_refptr<VideoFrame>) {}, frame));
+    wrapping_frame->intermediate_wrapped_frame_ = frame;
     frame = frame->wrapped_frame_;
   }
 
@@ -1257,11 +1263,15 @@ const gpu::MailboxHolder& VideoFrame::mailbox_holder(
 const std::vector<base::ScopedFD>& VideoFrame::DmabufFds() const {
   DCHECK_EQ(storage_type_, STORAGE_DMABUFS);
 
+  if (!dmabuf_fds_) {
+    static const base::NoDestructor<std::vector<base::ScopedFD>> kNoFds;
+    return *kNoFds;
+  }
   return dmabuf_fds_->fds();
 }
 
 bool VideoFrame::HasDmaBufs() const {
-  return dmabuf_fds_->size() > 0;
+  return dmabuf_fds_ && dmabuf_fds_->size() > 0;
 }
 
 bool VideoFrame::IsSameDmaBufsAs(const VideoFrame& frame) const {
@@ -1355,19 +1365,17 @@ size_t VideoFrame::BitDepth() const {
   return media::BitDepth(format());
 }
 
-VideoFrame::VideoFrame(const VideoFrameLayout& layout,
+VideoFrame::VideoFrame(VideoFrameLayout layout,
                        StorageType storage_type,
                        const gfx::Rect& visible_rect,
                        const gfx::Size& natural_size,
                        base::TimeDelta timestamp,
                        FrameControlType frame_control_type)
-    : layout_(layout),
+    : layout_(std::move(layout)),
       storage_type_(storage_type),
-      visible_rect_(Intersection(visible_rect, gfx::Rect(layout.coded_size()))),
+      visible_rect_(
+          Intersection(visible_rect, gfx::Rect(layout_.coded_size()))),
       natural_size_(natural_size),
-#if defined(OS_LINUX) || defined(OS_CHROMEOS)
-      dmabuf_fds_(base::MakeRefCounted<DmabufHolder>()),
-#endif
       timestamp_(timestamp),
       unique_id_(g_unique_id_generator.GetNext()) {
   DCHECK(IsValidConfigInternal(format(), frame_control_type, coded_size(),
@@ -1392,6 +1400,10 @@ VideoFrame::~VideoFrame() {
         .Run(release_sync_token, std::move(gpu_memory_buffer_));
   }
 
+  // Release any intermediate wrapper first, as its destruction observers were
+  // registered before ours.
+  intermediate_wrapped_frame_.reset();
+
   for (auto& callback : done_callbacks_)
     std::move(callback).Run();
 }
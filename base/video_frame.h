@@ -640,7 +640,7 @@ class MEDIA_EXPORT VideoFrame : public base::RefCountedThreadSafe<VideoFrame> {
   // Clients must use the static factory/wrapping methods to create a new frame.
   // Derived classes should create their own factory/wrapping methods, and use
   // this constructor to do basic initialization.
-  VideoFrame(const VideoFrameLayout& layout,
+  VideoFrame(VideoFrameLayout layout,
              StorageType storage_type,
              const gfx::Rect& visible_rect,
              const gfx::Size& natural_size,
@@ -707,6 +707,11 @@ class MEDIA_EXPORT VideoFrame : public base::RefCountedThreadSafe<VideoFrame> {
   // and natural size on |wrapped_frame_|
   scoped_refptr<VideoFrame> wrapped_frame_;
 
+  // Set by WrapVideoFrame when wrapping a frame which was itself a wrapper. The
+  // intermediate frame is kept alive until this frame is destroyed since it
+  // may have destruction observers of its own.
+  scoped_refptr<VideoFrame> intermediate_wrapped_frame_;
+
   // Storage type for the different planes.
   StorageType storage_type_;  // TODO(mcasas): make const
 
@@ -56,6 +56,7 @@ void VideoFrameMetadata::MergeMetadataFrom(
   MERGE_FIELD(receive_time, metadata_source);
   MERGE_FIELD(wallclock_frame_duration, metadata_source);
   MERGE_FIELD(maximum_composition_delay_in_frames, metadata_source);
+  MERGE_FIELD(content_hash, metadata_source);
 #if BUILDFLAG(USE_VAAPI)
   MERGE_FIELD(hw_va_protected_session_id, metadata_source);
 #endif
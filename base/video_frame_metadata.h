@@ -200,6 +200,12 @@ struct MEDIA_EXPORT VideoFrameMetadata {
   // This is an experimental feature, see crbug.com/1138888 for more
   // information.
   absl::optional<int> maximum_composition_delay_in_frames;
+
+  // Hash of the format, visible size and visible pixel content of the frame,
+  // as computed by ComputeVideoFrameContentHash(). Consumers may treat frames
+  // with equal hashes as identical, e.g. to skip re-uploading static content.
+  // Producers must only set this once the frame content is final.
+  absl::optional<uint64_t> content_hash;
 };
 
 }  // namespace media
@@ -0,0 +1,62 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/time/time.h"
+#include "media/base/video_frame.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+
+namespace {
+
+constexpr int kBenchmarkIterations = 200000;
+constexpr gfx::Size kFrameSize(1280, 720);
+
+void RunWrapChainBenchmark(int wrap_depth, const std::string& story) {
+  scoped_refptr<VideoFrame> decoded_frame = VideoFrame::CreateFrame(
+      PIXEL_FORMAT_I420, kFrameSize, gfx::Rect(kFrameSize), kFrameSize,
+      base::TimeDelta());
+  ASSERT_TRUE(decoded_frame);
+  decoded_frame->metadata().frame_duration = base::Microseconds(4167);
+
+  int observers_run = 0;
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kBenchmarkIterations; ++i) {
+    // Mimic decoder output being re-wrapped by each pipeline layer (e.g.
+    // decoder wrapper, frame pool, renderer) before being dropped by the sink.
+    scoped_refptr<VideoFrame> frame = decoded_frame;
+    for (int depth = 0; depth < wrap_depth; ++depth) {
+      frame = VideoFrame::WrapVideoFrame(frame, frame->format(),
+                                         frame->visible_rect(),
+                                         frame->natural_size());
+      frame->AddDestructionObserver(base::BindOnce(
+          [](int* observers_run) { ++(*observers_run); }, &observers_run));
+    }
+    frame.reset();
+  }
+  const double elapsed = (base::TimeTicks::Now() - start).InSecondsF();
+  EXPECT_EQ(kBenchmarkIterations * wrap_depth, observers_run);
+
+  perf_test::PerfResultReporter reporter("video_frame", story);
+  reporter.RegisterImportantMetric("_wrap_chain", "runs/s");
+  reporter.AddResult("_wrap_chain", kBenchmarkIterations / elapsed);
+}
+
+}  // namespace
+
+// Benchmarks the decode -> wrap -> render chain of VideoFrame wrappers that a
+// high frame rate capture or playback pipeline creates for every frame.
+TEST(VideoFramePerfTest, WrapChain_Depth1) {
+  RunWrapChainBenchmark(1, "depth_1");
+}
+
+TEST(VideoFramePerfTest, WrapChain_Depth3) {
+  RunWrapChainBenchmark(3, "depth_3");
+}
+
+}  // namespace media
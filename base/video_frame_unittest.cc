@@ -421,6 +421,7 @@ TEST(VideoFrame, WrapVideoFrame) {
   // Now all |base_frame| references should be released.
   frame2.reset();
   EXPECT_TRUE(base_frame_done_callback_was_run);
+  EXPECT_TRUE(wrapped_frame_done_callback_was_run);
 }
 
 // Create a frame that wraps unowned memory.
@@ -4,19 +4,28 @@
 
 #include "media/base/video_util.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <utility>
 
+#include "base/barrier_closure.h"
 #include "base/bind.h"
 #include "base/bits.h"
 #include "base/callback_helpers.h"
 #include "base/check_op.h"
+#include "base/hash/md5.h"
 #include "base/logging.h"
 #include "base/notreached.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/numerics/safe_math.h"
+#include "base/system/sys_info.h"
+#include "base/task/task_runner.h"
+#include "base/task/thread_pool.h"
 #include "base/time/time.h"
 #include "gpu/GLES2/gl2extchromium.h"
 #include "gpu/command_buffer/client/raster_interface.h"
+#include "media/base/bind_to_current_loop.h"
 #include "media/base/status_codes.h"
 #include "media/base/video_frame.h"
 #include "media/base/video_frame_pool.h"
@@ -34,26 +43,32 @@ namespace media {
 namespace {
 
 // Helper to apply padding to the region outside visible rect up to the coded
-// size with the repeated last column / row of the visible rect.
+// size with the repeated last column / row of the visible rect. Only visible
+// rows in [|first_row|, |last_row|) are padded to the right; the rows below the
+// visible rect are only padded if |pad_bottom| is true.
 void FillRegionOutsideVisibleRect(uint8_t* data,
                                   size_t stride,
                                   const gfx::Size& coded_size,
-                                  const gfx::Size& visible_size) {
+                                  const gfx::Size& visible_size,
+                                  int first_row,
+                                  int last_row,
+                                  bool pad_bottom) {
   if (visible_size.IsEmpty()) {
-    if (!coded_size.IsEmpty())
+    if (!coded_size.IsEmpty() && pad_bottom)
       memset(data, 0, coded_size.height() * stride);
     return;
   }
 
   const int coded_width = coded_size.width();
+  last_row = std::min(last_row, visible_size.height());
   if (visible_size.width() < coded_width) {
     const int pad_length = coded_width - visible_size.width();
-    uint8_t* dst = data + visible_size.width();
-    for (int i = 0; i < visible_size.height(); ++i, dst += stride)
+    uint8_t* dst = data + first_row * stride + visible_size.width();
+    for (int i = first_row; i < last_row; ++i, dst += stride)
       std::memset(dst, *(dst - 1), pad_length);
   }
 
-  if (visible_size.height() < coded_size.height()) {
+  if (pad_bottom && visible_size.height() < coded_size.height()) {
     uint8_t* dst = data + visible_size.height() * stride;
     uint8_t* src = dst - stride;
     for (int i = visible_size.height(); i < coded_size.height();
@@ -600,7 +615,10 @@ scoped_refptr<VideoFrame> WrapAsI420VideoFrame(
   return wrapped_frame;
 }
 
-bool I420CopyWithPadding(const VideoFrame& src_frame, VideoFrame* dst_frame) {
+namespace {
+
+bool CanCopyWithPadding(const VideoFrame& src_frame,
+                        const VideoFrame* dst_frame) {
   if (!dst_frame || !dst_frame->IsMappable())
     return false;
 
@@ -608,47 +626,232 @@ bool I420CopyWithPadding(const VideoFrame& src_frame, VideoFrame* dst_frame) {
   DCHECK_GE(dst_frame->coded_size().height(),
             src_frame.visible_rect().height());
   DCHECK(dst_frame->visible_rect().origin().IsOrigin());
+  return true;
+}
 
-  if (libyuv::I420Copy(src_frame.visible_data(VideoFrame::kYPlane),
-                       src_frame.stride(VideoFrame::kYPlane),
-                       src_frame.visible_data(VideoFrame::kUPlane),
-                       src_frame.stride(VideoFrame::kUPlane),
-                       src_frame.visible_data(VideoFrame::kVPlane),
-                       src_frame.stride(VideoFrame::kVPlane),
-                       dst_frame->data(VideoFrame::kYPlane),
-                       dst_frame->stride(VideoFrame::kYPlane),
-                       dst_frame->data(VideoFrame::kUPlane),
-                       dst_frame->stride(VideoFrame::kUPlane),
-                       dst_frame->data(VideoFrame::kVPlane),
-                       dst_frame->stride(VideoFrame::kVPlane),
-                       src_frame.visible_rect().width(),
-                       src_frame.visible_rect().height()))
-    return false;
+// Returns true if the visible region of |src_frame| already sits at the start
+// of |dst_frame|'s planes with matching strides, in which case only the padding
+// needs to be written.
+bool IsAlreadyLaidOut(const VideoFrame& src_frame,
+                      const VideoFrame& dst_frame) {
+  for (size_t plane : {VideoFrame::kYPlane, VideoFrame::kUPlane,
+                       VideoFrame::kVPlane}) {
+    if (src_frame.visible_data(plane) != dst_frame.data(plane) ||
+        src_frame.stride(plane) != dst_frame.stride(plane)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies and pads the luma rows [|first_row|, |last_row|) of the visible rect,
+// and the corresponding chroma rows. |first_row| must be even. The region below
+// the visible rect is padded only if |pad_bottom| is true, which must only be
+// done once all visible rows have been written.
+bool I420CopyRowsWithPadding(const VideoFrame& src_frame,
+                             VideoFrame* dst_frame,
+                             int first_row,
+                             int last_row,
+                             bool copy,
+                             bool pad_bottom) {
+  DCHECK_EQ(first_row % 2, 0);
+  const gfx::Size visible_size = src_frame.visible_rect().size();
+  const int first_chroma_row = first_row / 2;
+  const int last_chroma_row = (last_row + 1) / 2;
+
+  if (copy && last_row > first_row) {
+    const auto src_row = [&](size_t plane, int row) {
+      return src_frame.visible_data(plane) + row * src_frame.stride(plane);
+    };
+    const auto dst_row = [&](size_t plane, int row) {
+      return dst_frame->data(plane) + row * dst_frame->stride(plane);
+    };
+    if (libyuv::I420Copy(src_row(VideoFrame::kYPlane, first_row),
+                         src_frame.stride(VideoFrame::kYPlane),
+                         src_row(VideoFrame::kUPlane, first_chroma_row),
+                         src_frame.stride(VideoFrame::kUPlane),
+                         src_row(VideoFrame::kVPlane, first_chroma_row),
+                         src_frame.stride(VideoFrame::kVPlane),
+                         dst_row(VideoFrame::kYPlane, first_row),
+                         dst_frame->stride(VideoFrame::kYPlane),
+                         dst_row(VideoFrame::kUPlane, first_chroma_row),
+                         dst_frame->stride(VideoFrame::kUPlane),
+                         dst_row(VideoFrame::kVPlane, first_chroma_row),
+                         dst_frame->stride(VideoFrame::kVPlane),
+                         visible_size.width(), last_row - first_row)) {
+      return false;
+    }
+  }
 
   // Padding the region outside the visible rect with the repeated last
   // column / row of the visible rect. This can improve the coding efficiency.
   FillRegionOutsideVisibleRect(dst_frame->data(VideoFrame::kYPlane),
                                dst_frame->stride(VideoFrame::kYPlane),
-                               dst_frame->coded_size(),
-                               src_frame.visible_rect().size());
-  FillRegionOutsideVisibleRect(
-      dst_frame->data(VideoFrame::kUPlane),
-      dst_frame->stride(VideoFrame::kUPlane),
-      VideoFrame::PlaneSize(PIXEL_FORMAT_I420, VideoFrame::kUPlane,
-                            dst_frame->coded_size()),
-      VideoFrame::PlaneSize(PIXEL_FORMAT_I420, VideoFrame::kUPlane,
-                            src_frame.visible_rect().size()));
-  FillRegionOutsideVisibleRect(
-      dst_frame->data(VideoFrame::kVPlane),
-      dst_frame->stride(VideoFrame::kVPlane),
-      VideoFrame::PlaneSize(PIXEL_FORMAT_I420, VideoFrame::kVPlane,
-                            dst_frame->coded_size()),
-      VideoFrame::PlaneSize(PIXEL_FORMAT_I420, VideoFrame::kVPlane,
-                            src_frame.visible_rect().size()));
-
+                               dst_frame->coded_size(), visible_size, first_row,
+                               last_row, pad_bottom);
+  for (size_t plane : {VideoFrame::kUPlane, VideoFrame::kVPlane}) {
+    FillRegionOutsideVisibleRect(
+        dst_frame->data(plane), dst_frame->stride(plane),
+        VideoFrame::PlaneSize(PIXEL_FORMAT_I420, plane,
+                              dst_frame->coded_size()),
+        VideoFrame::PlaneSize(PIXEL_FORMAT_I420, plane, visible_size),
+        first_chroma_row, last_chroma_row, pad_bottom);
+  }
   return true;
 }
 
+void I420CopyWithPaddingTask(scoped_refptr<VideoFrame> src_frame,
+                             scoped_refptr<VideoFrame> dst_frame,
+                             bool copy,
+                             size_t task_index,
+                             size_t n_tasks,
+                             bool* result,
+                             base::OnceClosure done) {
+  // Stripes are made of pairs of rows so that each one maps onto whole chroma
+  // rows; the last stripe picks up any odd remaining row.
+  const int height = src_frame->visible_rect().height();
+  base::CheckedNumeric<size_t> chunks = height / 2;
+  const int first_row =
+      base::checked_cast<int>((chunks * task_index / n_tasks).ValueOrDie()) * 2;
+  int last_row = base::checked_cast<int>(
+                     (chunks * (task_index + 1) / n_tasks).ValueOrDie()) *
+                 2;
+  if (task_index + 1 == n_tasks)
+    last_row = height;
+
+  // Each task writes only its own |result| slot; bottom padding is applied
+  // once every stripe has finished.
+  result[task_index] = I420CopyRowsWithPadding(*src_frame, dst_frame.get(),
+                                               first_row, last_row, copy,
+                                               false);
+  std::move(done).Run();
+}
+
+void OnI420CopyWithPaddingStripesDone(scoped_refptr<VideoFrame> src_frame,
+                                      scoped_refptr<VideoFrame> dst_frame,
+                                      std::unique_ptr<bool[]> results,
+                                      size_t n_tasks,
+                                      base::OnceCallback<void(bool)> done_cb) {
+  for (size_t i = 0; i < n_tasks; ++i) {
+    if (!results[i]) {
+      std::move(done_cb).Run(false);
+      return;
+    }
+  }
+
+  // Now that every visible row is in place, pad below the visible rect.
+  const int height = src_frame->visible_rect().height();
+  std::move(done_cb).Run(I420CopyRowsWithPadding(
+      *src_frame, dst_frame.get(), height & ~1, height, false, true));
+}
+
+}  // namespace
+
+bool I420CopyWithPadding(const VideoFrame& src_frame, VideoFrame* dst_frame) {
+  if (!CanCopyWithPadding(src_frame, dst_frame))
+    return false;
+
+  return I420CopyRowsWithPadding(src_frame, dst_frame, 0,
+                                 src_frame.visible_rect().height(),
+                                 !IsAlreadyLaidOut(src_frame, *dst_frame),
+                                 true);
+}
+
+void I420CopyWithPaddingMultiThreaded(
+    scoped_refptr<VideoFrame> src_frame,
+    scoped_refptr<VideoFrame> dst_frame,
+    scoped_refptr<base::TaskRunner> task_runner,
+    base::OnceCallback<void(bool)> done_cb,
+    size_t num_stripes) {
+  done_cb = BindToCurrentLoop(std::move(done_cb));
+  if (!src_frame || !CanCopyWithPadding(*src_frame, dst_frame.get())) {
+    std::move(done_cb).Run(false);
+    return;
+  }
+
+  const bool copy = !IsAlreadyLaidOut(*src_frame, *dst_frame);
+  const int visible_height = src_frame->visible_rect().height();
+
+  // Only the padding is written when no copy is needed, which is cheap enough
+  // to do inline.
+  size_t n_tasks = 1;
+  if (copy && num_stripes) {
+    n_tasks = num_stripes;
+  } else if (copy) {
+    constexpr size_t kTaskBytes = 1024 * 1024;  // 1 MiB
+    const size_t frame_bytes = VideoFrame::AllocationSize(
+        PIXEL_FORMAT_I420, src_frame->visible_rect().size());
+    n_tasks = std::min<size_t>(std::max<size_t>(1, frame_bytes / kTaskBytes),
+                               base::SysInfo::NumberOfProcessors());
+  }
+  n_tasks = std::min<size_t>(n_tasks, std::max(1, visible_height / 2));
+  if (n_tasks <= 1) {
+    std::move(done_cb).Run(I420CopyRowsWithPadding(
+        *src_frame, dst_frame.get(), 0, visible_height, copy, true));
+    return;
+  }
+
+  std::unique_ptr<bool[]> results(new bool[n_tasks]);
+  bool* results_ptr = results.get();
+  base::RepeatingClosure barrier = base::BarrierClosure(
+      n_tasks, base::BindOnce(&OnI420CopyWithPaddingStripesDone, src_frame,
+                              dst_frame, std::move(results), n_tasks,
+                              std::move(done_cb)));
+
+  // |results| is owned by the barrier's callback, which only runs once every
+  // stripe has written its slot.
+  for (size_t i = 0; i < n_tasks; ++i) {
+    auto task = base::BindOnce(I420CopyWithPaddingTask, src_frame, dst_frame,
+                               copy, i, n_tasks, base::Unretained(results_ptr),
+                               barrier);
+    if (task_runner)
+      task_runner->PostTask(FROM_HERE, std::move(task));
+    else
+      base::ThreadPool::PostTask(FROM_HERE, std::move(task));
+  }
+}
+
+absl::optional<uint64_t> ComputeVideoFrameContentHash(
+    const VideoFrame& frame) {
+  if (!frame.IsMappable())
+    return absl::nullopt;
+
+  // MD5 the format and visible size, then the visible rows of each plane in
+  // turn, which hashes every plane as if it were tightly packed. Frames are
+  // only ever compared with each other, so the first 64 bits of the digest
+  // are enough.
+  base::MD5Context context;
+  base::MD5Init(&context);
+  const int header[] = {static_cast<int>(frame.format()),
+                        frame.visible_rect().width(),
+                        frame.visible_rect().height()};
+  base::MD5Update(&context,
+                  base::StringPiece(reinterpret_cast<const char*>(header),
+                                    sizeof(header)));
+
+  const size_t num_planes = VideoFrame::NumPlanes(frame.format());
+  for (size_t plane = 0; plane < num_planes; ++plane) {
+    const uint8_t* row = frame.visible_data(plane);
+    const int stride = frame.stride(plane);
+    const size_t rows = VideoFrame::Rows(plane, frame.format(),
+                                         frame.visible_rect().height());
+    const size_t row_bytes = VideoFrame::RowBytes(
+        plane, frame.format(), frame.visible_rect().width());
+    for (size_t y = 0; y < rows; ++y, row += stride) {
+      base::MD5Update(&context,
+                      base::StringPiece(reinterpret_cast<const char*>(row),
+                                        row_bytes));
+    }
+  }
+
+  base::MD5Digest digest;
+  base::MD5Final(&digest, &context);
+  uint64_t hash;
+  static_assert(sizeof(digest.a) >= sizeof(hash), "MD5 digest is too short");
+  memcpy(&hash, digest.a, sizeof(hash));
+  return hash;
+}
+
 scoped_refptr<VideoFrame> ReadbackTextureBackedFrameToMemorySync(
     const VideoFrame& txt_frame,
     gpu::raster::RasterInterface* ri,
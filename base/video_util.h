@@ -9,10 +9,12 @@
 
 #include <vector>
 
+#include "base/callback_forward.h"
 #include "base/memory/ref_counted.h"
 #include "media/base/media_export.h"
 #include "media/base/status.h"
 #include "media/base/video_types.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/size.h"
@@ -20,8 +22,9 @@
 class GrDirectContext;
 
 namespace base {
+class TaskRunner;
 class TimeDelta;
-}
+}  // namespace base
 
 namespace gpu {
 namespace raster {
@@ -177,7 +180,9 @@ MEDIA_EXPORT scoped_refptr<VideoFrame> WrapAsI420VideoFrame(
 // coded size does not match the requirement. Padding can improve the encoding
 // efficiency in this case, as the encoder will encode the whole coded region.
 // Performance-wise, this function could be expensive as it does memory copy of
-// the whole visible rect.
+// the whole visible rect, unless the visible rect of |src_frame| already sits
+// at the origin of |dst_frame|'s planes with the same strides, in which case
+// only the padding is written.
 // Note:
 // 1. |src_frame| and |dst_frame| should have same size of visible rect.
 // 2. The visible rect's origin of |dst_frame| should be (0,0).
@@ -187,6 +192,19 @@ MEDIA_EXPORT scoped_refptr<VideoFrame> WrapAsI420VideoFrame(
 MEDIA_EXPORT bool I420CopyWithPadding(const VideoFrame& src_frame,
                                       VideoFrame* dst_frame) WARN_UNUSED_RESULT;
 
+// Same as I420CopyWithPadding(), but asynchronous: large frames are split
+// into horizontal stripes which are copied in parallel on |task_runner|, or on
+// the thread pool if |task_runner| is null. |done_cb| is run on the calling
+// sequence with the result once every stripe has been copied; both frames are
+// kept alive until then. |num_stripes| forces the number of stripes, which is
+// otherwise picked from the frame size and the number of processors when 0.
+MEDIA_EXPORT void I420CopyWithPaddingMultiThreaded(
+    scoped_refptr<VideoFrame> src_frame,
+    scoped_refptr<VideoFrame> dst_frame,
+    scoped_refptr<base::TaskRunner> task_runner,
+    base::OnceCallback<void(bool)> done_cb,
+    size_t num_stripes = 0);
+
 // Copy pixel data from |src_frame| to |dst_frame| applying scaling and pixel
 // format conversion as needed. Both frames need to be mappabale and have either
 // I420 or NV12 pixel format.
@@ -195,6 +213,13 @@ MEDIA_EXPORT Status ConvertAndScaleFrame(const VideoFrame& src_frame,
                                          std::vector<uint8_t>& tmp_buf)
     WARN_UNUSED_RESULT;
 
+// Computes a hash of the format, visible size and visible pixel content of a
+// mappable |frame|, suitable for VideoFrameMetadata::content_hash. The hash is
+// the first 64 bits of an MD5 digest, so frames with equal hashes can be taken
+// to be identical. Returns absl::nullopt if |frame| is not mappable.
+MEDIA_EXPORT absl::optional<uint64_t> ComputeVideoFrameContentHash(
+    const VideoFrame& frame);
+
 // Converts kRGBA_8888_SkColorType and kBGRA_8888_SkColorType to the appropriate
 // ARGB, XRGB, ABGR, or XBGR format.
 MEDIA_EXPORT VideoPixelFormat
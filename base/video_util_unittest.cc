@@ -8,7 +8,11 @@
 
 #include <cmath>
 #include <memory>
+#include <utility>
 
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
 #include "media/base/video_frame.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -561,6 +565,76 @@ TEST_F(VideoUtilTest, I420CopyWithPadding) {
   EXPECT_TRUE(VerifyCopyWithPadding(*src_frame, *dst_frame));
 }
 
+// Runs I420CopyWithPaddingMultiThreaded() on the thread pool and returns its
+// result.
+static bool CopyWithPaddingMultiThreaded(scoped_refptr<VideoFrame> src_frame,
+                                         scoped_refptr<VideoFrame> dst_frame,
+                                         size_t num_stripes) {
+  bool result = false;
+  base::RunLoop run_loop;
+  I420CopyWithPaddingMultiThreaded(
+      std::move(src_frame), std::move(dst_frame), nullptr,
+      base::BindOnce(
+          [](bool* result, bool copied) { *result = copied; }, &result)
+          .Then(run_loop.QuitClosure()),
+      num_stripes);
+  run_loop.Run();
+  return result;
+}
+
+TEST_F(VideoUtilTest, I420CopyWithPaddingMultiThreaded) {
+  base::test::TaskEnvironment task_environment;
+  gfx::Size visible_size(39, 31);
+  gfx::Size coded_size(60, 40);
+  scoped_refptr<VideoFrame> src_frame = CreateFrameWithPatternFilled(
+      PIXEL_FORMAT_I420, visible_size, gfx::Rect(visible_size), visible_size,
+      base::TimeDelta());
+
+  EXPECT_FALSE(CopyWithPaddingMultiThreaded(src_frame, nullptr, 0));
+
+  // Force several stripes, including one with the odd last row.
+  scoped_refptr<VideoFrame> dst_frame = CreateFrameWithPatternFilled(
+      PIXEL_FORMAT_I420, coded_size, gfx::Rect(visible_size), coded_size,
+      base::TimeDelta());
+  EXPECT_TRUE(CopyWithPaddingMultiThreaded(src_frame, dst_frame, 4));
+  EXPECT_TRUE(VerifyCopyWithPadding(*src_frame, *dst_frame));
+}
+
+TEST_F(VideoUtilTest, I420CopyWithPaddingInPlace) {
+  gfx::Size visible_size(39, 31);
+  gfx::Size coded_size(60, 40);
+  scoped_refptr<VideoFrame> frame = CreateFrameWithPatternFilled(
+      PIXEL_FORMAT_I420, coded_size, gfx::Rect(visible_size), coded_size,
+      base::TimeDelta());
+
+  // Only the padding should be written when the source and destination share
+  // the same memory.
+  EXPECT_TRUE(I420CopyWithPadding(*frame, frame.get()));
+  EXPECT_TRUE(VerifyCopyWithPadding(*frame, *frame));
+}
+
+TEST_F(VideoUtilTest, ComputeVideoFrameContentHash) {
+  gfx::Size size(64, 48);
+  scoped_refptr<VideoFrame> frame1 = VideoFrame::CreateFrame(
+      PIXEL_FORMAT_I420, size, gfx::Rect(size), size, base::TimeDelta());
+  scoped_refptr<VideoFrame> frame2 = VideoFrame::CreateFrame(
+      PIXEL_FORMAT_I420, size, gfx::Rect(size), size, base::TimeDelta());
+  FillYUV(frame1.get(), 16, 128, 128);
+  FillYUV(frame2.get(), 16, 128, 128);
+
+  // Identical content hashes identically, regardless of the frame.
+  absl::optional<uint64_t> hash1 = ComputeVideoFrameContentHash(*frame1);
+  ASSERT_TRUE(hash1);
+  EXPECT_EQ(hash1, ComputeVideoFrameContentHash(*frame2));
+
+  // Changing a single visible pixel changes the hash.
+  frame2->visible_data(VideoFrame::kUPlane)[5] = 129;
+  EXPECT_NE(hash1, ComputeVideoFrameContentHash(*frame2));
+
+  // Frames without mappable memory can't be hashed.
+  EXPECT_FALSE(ComputeVideoFrameContentHash(*VideoFrame::CreateEOSFrame()));
+}
+
 TEST_F(VideoUtilTest, WrapAsI420VideoFrame) {
   gfx::Size size(640, 480);
   scoped_refptr<VideoFrame> src_frame = VideoFrame::CreateFrame(
@@ -5,6 +5,8 @@
 #ifndef MEDIA_BASE_WATCH_TIME_KEYS_H_
 #define MEDIA_BASE_WATCH_TIME_KEYS_H_
 
+#include <stddef.h>
+
 #include "base/strings/string_piece.h"
 #include "media/base/media_export.h"
 
@@ -80,6 +82,10 @@ enum class WatchTimeKey : int {
   kWatchTimeKeyMax = kVideoBackgroundEmbeddedExperience
 };
 
+// Number of WatchTimeKeys, for arrays indexed by key.
+constexpr size_t kWatchTimeKeyCount =
+    static_cast<size_t>(WatchTimeKey::kWatchTimeKeyMax) + 1;
+
 // Count of the number of underflow events during a media session.
 MEDIA_EXPORT extern const char kWatchTimeUnderflowCount[];
 
@@ -3,11 +3,13 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/check_op.h"
 #include "base/memory/ptr_util.h"
+#include "base/test/bind.h"
 #include "base/test/gtest_util.h"
 #include "base/test/task_environment.h"
 #include "media/capabilities/in_memory_video_decode_stats_db_impl.h"
@@ -390,4 +392,38 @@ TEST_F(SeededInMemoryDBTest, SeedReadFailureOnAppendingingStats) {
   task_environment_.RunUntilIdle();
 }
 
+TEST_F(SeedlessInMemoryDBTest, BatchReadMatchesSingleReads) {
+  const DecodeStatsEntry entry(50, 1, 5);
+  const auto other_key = VideoDescKey::MakeBucketedKey(
+      VP9PROFILE_PROFILE0, gfx::Size(640, 360), 30, "", false);
+
+  InitializeEmptyDB();
+
+  EXPECT_CALL(*this, AppendDecodeStatsCB(true));
+  in_memory_db_->AppendDecodeStats(
+      kTestKey(), entry,
+      base::BindOnce(&InMemoryDBTestBase::AppendDecodeStatsCB,
+                     base::Unretained(this)));
+
+  // The default batch implementation answers each key with GetDecodeStats(),
+  // in the order of the keys.
+  bool batch_done = false;
+  in_memory_db_->GetDecodeStatsBatch(
+      {other_key, kTestKey()},
+      base::BindLambdaForTesting(
+          [&](bool success,
+              std::vector<std::unique_ptr<DecodeStatsEntry>> entries) {
+            batch_done = true;
+            EXPECT_TRUE(success);
+            ASSERT_EQ(entries.size(), 2u);
+            ASSERT_TRUE(entries[0]);
+            EXPECT_EQ(*entries[0], kEmtpyEntry());
+            ASSERT_TRUE(entries[1]);
+            EXPECT_EQ(*entries[1], entry);
+          }));
+
+  task_environment_.RunUntilIdle();
+  EXPECT_TRUE(batch_done);
+}
+
 }  // namespace media
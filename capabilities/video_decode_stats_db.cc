@@ -4,13 +4,76 @@
 
 #include "media/capabilities/video_decode_stats_db.h"
 
+#include <utility>
+
+#include "base/bind.h"
 #include "base/check_op.h"
 #include "base/format_macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/strings/stringprintf.h"
-#include "media/capabilities/bucket_utility.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "media/base/bucket_utility.h"
 
 namespace media {
 
+namespace {
+
+// Collects the results of the GetDecodeStats() calls made for one call to
+// VideoDecodeStatsDB::GetDecodeStatsBatch(), and runs its callback once they
+// are all in.
+class BatchResults : public base::RefCounted<BatchResults> {
+ public:
+  BatchResults(size_t num_keys,
+               VideoDecodeStatsDB::GetDecodeStatsBatchCB get_stats_cb)
+      : entries_(num_keys),
+        num_remaining_(num_keys),
+        get_stats_cb_(std::move(get_stats_cb)) {}
+
+  BatchResults(const BatchResults&) = delete;
+  BatchResults& operator=(const BatchResults&) = delete;
+
+  void OnGotDecodeStats(
+      size_t index,
+      bool success,
+      std::unique_ptr<VideoDecodeStatsDB::DecodeStatsEntry> entry) {
+    DCHECK_GT(num_remaining_, 0u);
+    success_ &= success;
+    entries_[index] = std::move(entry);
+    if (--num_remaining_ == 0)
+      std::move(get_stats_cb_).Run(success_, std::move(entries_));
+  }
+
+ private:
+  friend class base::RefCounted<BatchResults>;
+  ~BatchResults() = default;
+
+  std::vector<std::unique_ptr<VideoDecodeStatsDB::DecodeStatsEntry>> entries_;
+  size_t num_remaining_;
+  bool success_ = true;
+  VideoDecodeStatsDB::GetDecodeStatsBatchCB get_stats_cb_;
+};
+
+}  // namespace
+
+void VideoDecodeStatsDB::GetDecodeStatsBatch(
+    std::vector<VideoDescKey> keys,
+    GetDecodeStatsBatchCB get_stats_cb) {
+  if (keys.empty()) {
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE,
+        base::BindOnce(std::move(get_stats_cb), true,
+                       std::vector<std::unique_ptr<DecodeStatsEntry>>()));
+    return;
+  }
+
+  auto results =
+      base::MakeRefCounted<BatchResults>(keys.size(), std::move(get_stats_cb));
+  for (size_t i = 0; i < keys.size(); i++) {
+    GetDecodeStats(keys[i], base::BindOnce(&BatchResults::OnGotDecodeStats,
+                                           results, i));
+  }
+}
+
 // static
 VideoDecodeStatsDB::VideoDescKey
 VideoDecodeStatsDB::VideoDescKey::MakeBucketedKey(
@@ -42,8 +105,7 @@ VideoDecodeStatsDB::VideoDescKey::VideoDescKey(VideoCodecProfile codec_profile,
 
 std::string VideoDecodeStatsDB::VideoDescKey::Serialize() const {
   std::string video_part =
-      base::StringPrintf("%d|%s|%d", static_cast<int>(codec_profile),
-                         size.ToString().c_str(), frame_rate);
+      SerializePrefix() + base::StringPrintf("%d", frame_rate);
 
   // NOTE: |eme_part| should be completely empty for non-EME stats to preserve
   // backward compat with pre-EME clear stats.
@@ -59,6 +121,11 @@ std::string VideoDecodeStatsDB::VideoDescKey::Serialize() const {
   return video_part + eme_part;
 }
 
+std::string VideoDecodeStatsDB::VideoDescKey::SerializePrefix() const {
+  return base::StringPrintf("%d|%s|", static_cast<int>(codec_profile),
+                            size.ToString().c_str());
+}
+
 std::string VideoDecodeStatsDB::VideoDescKey::ToLogString() const {
   return "Key {" + Serialize() + "}";
 }
@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/callback_forward.h"
 #include "base/check.h"
@@ -33,6 +34,11 @@ class MEDIA_EXPORT VideoDecodeStatsDB {
     // Returns a concise string representation of the key for storing in DB.
     std::string Serialize() const;
 
+    // Returns the start of Serialize() that is shared by every key with the
+    // same codec profile and size bucket (see GetSizeBucket()), whatever its
+    // frame rate and key system.
+    std::string SerializePrefix() const;
+
     // For debug logging. NOT interchangeable with Serialize().
     std::string ToLogString() const;
 
@@ -100,6 +106,15 @@ class MEDIA_EXPORT VideoDecodeStatsDB {
   virtual void GetDecodeStats(const VideoDescKey& key,
                               GetDecodeStatsCB get_stats_cb) = 0;
 
+  // Returns the stats associated with each of `keys`, in the same order, as
+  // GetDecodeStats() would. The boolean signals whether every lookup was
+  // successful. The default implementation calls GetDecodeStats() for each
+  // key; implementations that can answer many keys at once should override it.
+  using GetDecodeStatsBatchCB = base::OnceCallback<
+      void(bool, std::vector<std::unique_ptr<DecodeStatsEntry>>)>;
+  virtual void GetDecodeStatsBatch(std::vector<VideoDescKey> keys,
+                                   GetDecodeStatsBatchCB get_stats_cb);
+
   // Clear all statistics from the DB.
   virtual void ClearStats(base::OnceClosure clear_done_cb) = 0;
 };
@@ -4,9 +4,12 @@
 
 #include "media/capabilities/video_decode_stats_db_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/debug/alias.h"
@@ -17,6 +20,7 @@
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/sequence_checker.h"
+#include "base/strings/string_util.h"
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -41,6 +45,17 @@ const int kMaxDaysToKeepStatsDefault = 30;
 
 const bool kEnableUnweightedEntriesDefault = false;
 
+// Returns the prefix in |prefixes| that |db_key| starts with, or null if there
+// is none.
+const std::string* FindPrefix(const std::vector<std::string>& prefixes,
+                              const std::string& db_key) {
+  for (const auto& prefix : prefixes) {
+    if (base::StartsWith(db_key, prefix, base::CompareCase::SENSITIVE))
+      return &prefix;
+  }
+  return nullptr;
+}
+
 void UmaHistogramOpTime(const std::string& op_name, base::TimeDelta duration) {
   base::UmaHistogramCustomMicrosecondsTimes(
       "Media.VideoDecodeStatsDB.OpTiming." + op_name, duration,
@@ -93,6 +108,16 @@ void VideoDecodeStatsDBImpl::PendingOperation::OnTimeout() {
   timeout_closure_->Cancel();
 }
 
+VideoDecodeStatsDBImpl::PrefixIndex::PrefixIndex() = default;
+
+VideoDecodeStatsDBImpl::PrefixIndex::PrefixIndex(PrefixIndex&& other) =
+    default;
+
+VideoDecodeStatsDBImpl::PrefixIndex&
+VideoDecodeStatsDBImpl::PrefixIndex::operator=(PrefixIndex&& other) = default;
+
+VideoDecodeStatsDBImpl::PrefixIndex::~PrefixIndex() = default;
+
 // static
 int VideoDecodeStatsDBImpl::GetMaxFramesPerBuffer() {
   return base::GetFieldTrialParamByFeatureAsDouble(
@@ -154,6 +179,12 @@ VideoDecodeStatsDBImpl::VideoDecodeStatsDBImpl(
 
 VideoDecodeStatsDBImpl::~VideoDecodeStatsDBImpl() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  // Best effort: hand the unwritten appends to the DB, which will write them
+  // on its own sequence. Their callbacks are dropped, as for any other
+  // operation that's pending when we're destroyed.
+  if (IsInitialized())
+    FlushUnflushedEntries();
 }
 
 VideoDecodeStatsDBImpl::PendingOpId VideoDecodeStatsDBImpl::StartPendingOp(
@@ -239,14 +270,27 @@ void VideoDecodeStatsDBImpl::AppendDecodeStats(
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   DCHECK(IsInitialized());
 
+  std::string db_key = key.Serialize();
+
+  // The key is about to exist in the DB, if it doesn't already.
+  auto index_it = prefix_index_.find(key.SerializePrefix());
+  if (index_it != prefix_index_.end())
+    index_it->second.keys.insert(db_key);
+
+  const DecodeStatsProto* stats_proto = nullptr;
+  if (FindCachedEntry(db_key, &stats_proto)) {
+    DVLOG(3) << __func__ << " Updating cached " << key.ToLogString()
+             << " with " << entry.ToLogString();
+    UpdateCachedEntry(db_key, entry, std::move(append_done_cb));
+    return;
+  }
+
   DVLOG(3) << __func__ << " Reading key " << key.ToLogString()
            << " from DB with intent to update with " << entry.ToLogString();
 
-  db_->GetEntry(
-      key.Serialize(),
-      base::BindOnce(&VideoDecodeStatsDBImpl::WriteUpdatedEntry,
-                     weak_ptr_factory_.GetWeakPtr(), StartPendingOp("Read"),
-                     key, entry, std::move(append_done_cb)));
+  ReadEntry(db_key, base::BindOnce(&VideoDecodeStatsDBImpl::OnReadForAppend,
+                                   weak_ptr_factory_.GetWeakPtr(), db_key,
+                                   entry, std::move(append_done_cb)));
 }
 
 void VideoDecodeStatsDBImpl::GetDecodeStats(const VideoDescKey& key,
@@ -256,11 +300,228 @@ void VideoDecodeStatsDBImpl::GetDecodeStats(const VideoDescKey& key,
 
   DVLOG(3) << __func__ << " " << key.ToLogString();
 
+  std::string db_key = key.Serialize();
+  const DecodeStatsProto* stats_proto = nullptr;
+  if (FindCachedEntry(db_key, &stats_proto)) {
+    // Callers expect the result asynchronously, as it is for a DB read.
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(std::move(get_stats_cb), true,
+                                  CreateDecodeStatsEntry(stats_proto)));
+    return;
+  }
+
+  ReadEntry(db_key, base::BindOnce(&VideoDecodeStatsDBImpl::OnReadForGet,
+                                   weak_ptr_factory_.GetWeakPtr(), db_key,
+                                   std::move(get_stats_cb)));
+}
+
+void VideoDecodeStatsDBImpl::GetDecodeStatsBatch(
+    std::vector<VideoDescKey> keys,
+    GetDecodeStatsBatchCB get_stats_cb) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(IsInitialized());
+
+  DVLOG(3) << __func__ << " " << keys.size() << " keys";
+
+  // Answer what we can from memory, and collect the prefixes to scan for the
+  // rest.
+  std::vector<std::unique_ptr<DecodeStatsEntry>> entries(keys.size());
+  std::vector<std::pair<size_t, std::string>> unresolved_keys;
+  std::vector<std::string> prefixes;
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::string db_key = keys[i].Serialize();
+    const DecodeStatsProto* stats_proto = nullptr;
+    if (FindCachedEntry(db_key, &stats_proto)) {
+      entries[i] = CreateDecodeStatsEntry(stats_proto);
+      continue;
+    }
+
+    std::string prefix = keys[i].SerializePrefix();
+    auto index_it = prefix_index_.find(prefix);
+    if (index_it != prefix_index_.end() && index_it->second.complete &&
+        !index_it->second.keys.count(db_key)) {
+      // Known to have no DB entry.
+      cache_.Put(db_key, nullptr);
+      continue;
+    }
+
+    unresolved_keys.emplace_back(i, std::move(db_key));
+    prefixes.push_back(std::move(prefix));
+  }
+
+  if (unresolved_keys.empty()) {
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE,
+        base::BindOnce(std::move(get_stats_cb), true, std::move(entries)));
+    return;
+  }
+
+  std::sort(prefixes.begin(), prefixes.end());
+  prefixes.erase(std::unique(prefixes.begin(), prefixes.end()),
+                 prefixes.end());
+
+  // Start collecting appends to the prefixes now, in case they don't make it
+  // into the scan.
+  for (const auto& prefix : prefixes)
+    prefix_index_[prefix];
+
+  // The whole DB is small, so one pass over it for every prefix is cheaper
+  // than one seek per key.
+  db_->LoadKeysAndEntriesWithFilter(
+      base::BindRepeating(
+          [](const std::vector<std::string>& prefixes,
+             const std::string& db_key) {
+            return !!FindPrefix(prefixes, db_key);
+          },
+          prefixes),
+      base::BindOnce(&VideoDecodeStatsDBImpl::OnPrefixesScanned,
+                     weak_ptr_factory_.GetWeakPtr(), StartPendingOp("Scan"),
+                     prefixes, clear_count_, std::move(unresolved_keys),
+                     std::move(entries), std::move(get_stats_cb)));
+}
+
+void VideoDecodeStatsDBImpl::OnPrefixesScanned(
+    PendingOpId op_id,
+    std::vector<std::string> prefixes,
+    int clear_count,
+    std::vector<std::pair<size_t, std::string>> unresolved_keys,
+    std::vector<std::unique_ptr<DecodeStatsEntry>> entries,
+    GetDecodeStatsBatchCB get_stats_cb,
+    bool success,
+    std::unique_ptr<std::map<std::string, DecodeStatsProto>> db_entries) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DVLOG(3) << __func__ << " scan " << (success ? "succeeded" : "FAILED!");
+  CompletePendingOp(op_id);
+  UMA_HISTOGRAM_BOOLEAN("Media.VideoDecodeStatsDB.OpSuccess.Scan", success);
+
+  // If the stats were cleared since the scan started, what we read is gone.
+  // The prefixes' indices were dropped along with them.
+  const bool is_current = clear_count == clear_count_;
+  if (success && is_current) {
+    for (const auto& prefix : prefixes)
+      prefix_index_[prefix].complete = true;
+    for (const auto& db_key_and_proto : *db_entries) {
+      const std::string* prefix =
+          FindPrefix(prefixes, db_key_and_proto.first);
+      DCHECK(prefix);
+      prefix_index_[*prefix].keys.insert(db_key_and_proto.first);
+    }
+  }
+
+  for (auto& index_and_db_key : unresolved_keys) {
+    const std::string& db_key = index_and_db_key.second;
+
+    // Prefer the cache, which may have been updated since the scan started.
+    const DecodeStatsProto* stats_proto = nullptr;
+    if (!FindCachedEntry(db_key, &stats_proto)) {
+      if (!success)
+        continue;
+
+      std::unique_ptr<DecodeStatsProto> db_proto;
+      auto it = db_entries->find(db_key);
+      if (is_current && it != db_entries->end())
+        db_proto = std::make_unique<DecodeStatsProto>(std::move(it->second));
+      stats_proto = cache_.Put(db_key, std::move(db_proto))->second.get();
+    }
+
+    entries[index_and_db_key.first] = CreateDecodeStatsEntry(stats_proto);
+  }
+
+  std::move(get_stats_cb).Run(success, std::move(entries));
+}
+
+bool VideoDecodeStatsDBImpl::FindCachedEntry(
+    const std::string& db_key,
+    const DecodeStatsProto** stats_proto) {
+  auto it = cache_.Get(db_key);
+  if (it == cache_.end()) {
+    auto unflushed_it = unflushed_entries_.find(db_key);
+    if (unflushed_it == unflushed_entries_.end())
+      return false;
+    it = cache_.Put(db_key,
+                    std::make_unique<DecodeStatsProto>(unflushed_it->second));
+  }
+
+  *stats_proto = it->second.get();
+  return true;
+}
+
+void VideoDecodeStatsDBImpl::ReadEntry(const std::string& db_key,
+                                       ReadDoneCB read_done_cb) {
+  auto it = pending_reads_.find(db_key);
+  if (it != pending_reads_.end()) {
+    it->second.push_back(std::move(read_done_cb));
+    return;
+  }
+
+  pending_reads_[db_key].push_back(std::move(read_done_cb));
   db_->GetEntry(
-      key.Serialize(),
-      base::BindOnce(&VideoDecodeStatsDBImpl::OnGotDecodeStats,
-                     weak_ptr_factory_.GetWeakPtr(), StartPendingOp("Read"),
-                     std::move(get_stats_cb)));
+      db_key, base::BindOnce(&VideoDecodeStatsDBImpl::OnGotEntry,
+                             weak_ptr_factory_.GetWeakPtr(),
+                             StartPendingOp("Read"), db_key, clear_count_));
+}
+
+void VideoDecodeStatsDBImpl::OnGotEntry(
+    PendingOpId op_id,
+    const std::string& db_key,
+    int clear_count,
+    bool success,
+    std::unique_ptr<DecodeStatsProto> stats_proto) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DVLOG(3) << __func__ << " get " << (success ? "succeeded" : "FAILED!");
+  CompletePendingOp(op_id);
+  UMA_HISTOGRAM_BOOLEAN("Media.VideoDecodeStatsDB.OpSuccess.Read", success);
+
+  if (success && cache_.Peek(db_key) == cache_.end()) {
+    // If the stats were cleared since the read started, what we read is gone.
+    if (clear_count != clear_count_)
+      stats_proto.reset();
+    cache_.Put(db_key, std::move(stats_proto));
+  }
+
+  auto it = pending_reads_.find(db_key);
+  DCHECK(it != pending_reads_.end());
+  std::vector<ReadDoneCB> read_done_cbs = std::move(it->second);
+  pending_reads_.erase(it);
+
+  for (auto& read_done_cb : read_done_cbs)
+    std::move(read_done_cb).Run(success);
+}
+
+void VideoDecodeStatsDBImpl::OnReadForAppend(
+    const std::string& db_key,
+    const DecodeStatsEntry& entry,
+    AppendDecodeStatsCB append_done_cb,
+    bool read_success) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(IsInitialized());
+
+  if (!read_success) {
+    DVLOG(2) << __func__ << " FAILED DB read; ignoring update!";
+    std::move(append_done_cb).Run(false);
+    return;
+  }
+
+  UpdateCachedEntry(db_key, entry, std::move(append_done_cb));
+}
+
+void VideoDecodeStatsDBImpl::OnReadForGet(const std::string& db_key,
+                                          GetDecodeStatsCB get_stats_cb,
+                                          bool read_success) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  std::unique_ptr<DecodeStatsEntry> entry;
+  if (read_success) {
+    const DecodeStatsProto* stats_proto = nullptr;
+    bool found = FindCachedEntry(db_key, &stats_proto);
+    DCHECK(found);
+    entry = CreateDecodeStatsEntry(stats_proto);
+  }
+
+  DVLOG(3) << __func__ << " read " << (read_success ? "succeeded" : "FAILED!")
+           << " entry: " << (entry ? entry->ToLogString() : "nullptr");
+
+  std::move(get_stats_cb).Run(read_success, std::move(entry));
 }
 
 bool VideoDecodeStatsDBImpl::AreStatsUsable(
@@ -311,29 +572,21 @@ bool VideoDecodeStatsDBImpl::AreStatsUsable(
          base::Days(kMaxDaysToKeepStats);
 }
 
-void VideoDecodeStatsDBImpl::WriteUpdatedEntry(
-    PendingOpId op_id,
-    const VideoDescKey& key,
+void VideoDecodeStatsDBImpl::UpdateCachedEntry(
+    const std::string& db_key,
     const DecodeStatsEntry& new_entry,
-    AppendDecodeStatsCB append_done_cb,
-    bool read_success,
-    std::unique_ptr<DecodeStatsProto> stats_proto) {
+    AppendDecodeStatsCB append_done_cb) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   DCHECK(IsInitialized());
-  CompletePendingOp(op_id);
 
-  // Note: outcome of "Write" operation logged in OnEntryUpdated().
-  UMA_HISTOGRAM_BOOLEAN("Media.VideoDecodeStatsDB.OpSuccess.Read",
-                        read_success);
+  const DecodeStatsProto* cached_proto = nullptr;
+  bool found = FindCachedEntry(db_key, &cached_proto);
+  DCHECK(found);
 
-  if (!read_success) {
-    DVLOG(2) << __func__ << " FAILED DB read for " << key.ToLogString()
-             << "; ignoring update!";
-    std::move(append_done_cb).Run(false);
-    return;
-  }
-
-  if (!stats_proto || !AreStatsUsable(stats_proto.get())) {
+  std::unique_ptr<DecodeStatsProto> stats_proto;
+  if (cached_proto && AreStatsUsable(cached_proto)) {
+    stats_proto = std::make_unique<DecodeStatsProto>(*cached_proto);
+  } else {
     // Default instance will have all zeros for numeric types.
     stats_proto = std::make_unique<DecodeStatsProto>();
   }
@@ -453,43 +706,85 @@ void VideoDecodeStatsDBImpl::WriteUpdatedEntry(
   // and discarded any bad data prior to this upcoming save.
   DCHECK(AreStatsUsable(stats_proto.get()));
 
-  // Push the update to the DB.
-  using DBType = leveldb_proto::ProtoDatabase<DecodeStatsProto>;
-  std::unique_ptr<DBType::KeyEntryVector> entries =
-      std::make_unique<DBType::KeyEntryVector>();
-  entries->emplace_back(key.Serialize(), *stats_proto);
+  // Queue the update for the DB. The cache already reflects it.
+  unflushed_entries_[db_key] = *stats_proto;
+  cache_.Put(db_key, std::move(stats_proto));
+  unflushed_append_cbs_.push_back(std::move(append_done_cb));
+
+  if (unflushed_entries_.size() >= kMaxUnflushedEntries) {
+    FlushUnflushedEntries();
+  } else if (!flush_timer_.IsRunning()) {
+    flush_timer_.Start(FROM_HERE, kFlushDelay, this,
+                       &VideoDecodeStatsDBImpl::FlushUnflushedEntries);
+  }
+}
+
+void VideoDecodeStatsDBImpl::FlushUnflushedEntries() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  flush_timer_.Stop();
+
+  if (unflushed_entries_.empty())
+    return;
+
+  DVLOG(3) << __func__ << " Writing " << unflushed_entries_.size()
+           << " entries for " << unflushed_append_cbs_.size() << " appends";
+
+  // All the entries go in one batch, which LevelDB writes atomically.
+  std::vector<std::string> db_keys;
+  auto entries = std::make_unique<ProtoDecodeStatsEntry::KeyEntryVector>();
+  db_keys.reserve(unflushed_entries_.size());
+  entries->reserve(unflushed_entries_.size());
+  for (auto& db_key_and_proto : unflushed_entries_) {
+    db_keys.push_back(db_key_and_proto.first);
+    entries->emplace_back(db_key_and_proto.first,
+                          std::move(db_key_and_proto.second));
+  }
+  unflushed_entries_.clear();
+
+  std::vector<AppendDecodeStatsCB> append_done_cbs;
+  append_done_cbs.swap(unflushed_append_cbs_);
+
   db_->UpdateEntries(
       std::move(entries), std::make_unique<leveldb_proto::KeyVector>(),
-      base::BindOnce(&VideoDecodeStatsDBImpl::OnEntryUpdated,
+      base::BindOnce(&VideoDecodeStatsDBImpl::OnEntriesFlushed,
                      weak_ptr_factory_.GetWeakPtr(), StartPendingOp("Write"),
-                     std::move(append_done_cb)));
+                     std::move(db_keys), std::move(append_done_cbs)));
 }
 
-void VideoDecodeStatsDBImpl::OnEntryUpdated(PendingOpId op_id,
-                                            AppendDecodeStatsCB append_done_cb,
-                                            bool success) {
+void VideoDecodeStatsDBImpl::OnEntriesFlushed(
+    PendingOpId op_id,
+    std::vector<std::string> db_keys,
+    std::vector<AppendDecodeStatsCB> append_done_cbs,
+    bool success) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   DVLOG(3) << __func__ << " update " << (success ? "succeeded" : "FAILED!");
   CompletePendingOp(op_id);
   UMA_HISTOGRAM_BOOLEAN("Media.VideoDecodeStatsDB.OpSuccess.Write", success);
-  std::move(append_done_cb).Run(success);
-}
 
-void VideoDecodeStatsDBImpl::OnGotDecodeStats(
-    PendingOpId op_id,
-    GetDecodeStatsCB get_stats_cb,
-    bool success,
-    std::unique_ptr<DecodeStatsProto> stats_proto) {
-  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  DVLOG(3) << __func__ << " get " << (success ? "succeeded" : "FAILED!");
-  CompletePendingOp(op_id);
-  UMA_HISTOGRAM_BOOLEAN("Media.VideoDecodeStatsDB.OpSuccess.Read", success);
+  if (!success) {
+    // The cache is ahead of the DB now. Drop the entries that haven't been
+    // appended to since, so that they are read from the DB again. Entries
+    // that have will be written, including the failed appends, in the next
+    // batch.
+    for (const auto& db_key : db_keys) {
+      if (unflushed_entries_.find(db_key) != unflushed_entries_.end())
+        continue;
+      auto it = cache_.Peek(db_key);
+      if (it != cache_.end())
+        cache_.Erase(it);
+    }
+  }
 
-  std::unique_ptr<DecodeStatsEntry> entry;
+  for (auto& append_done_cb : append_done_cbs)
+    std::move(append_done_cb).Run(success);
+}
 
-  if (stats_proto && AreStatsUsable(stats_proto.get())) {
-    DCHECK(success);
+std::unique_ptr<DecodeStatsEntry>
+VideoDecodeStatsDBImpl::CreateDecodeStatsEntry(
+    const DecodeStatsProto* stats_proto) {
+  std::unique_ptr<DecodeStatsEntry> entry;
 
+  if (stats_proto && AreStatsUsable(stats_proto)) {
     if (GetEnableUnweightedEntries()) {
       DCHECK_GE(stats_proto->unweighted_average_frames_dropped(), 0);
       DCHECK_LE(stats_proto->unweighted_average_frames_dropped(), 1);
@@ -533,16 +828,26 @@ void VideoDecodeStatsDBImpl::OnGotDecodeStats(
     }
   }
 
-  DVLOG(3) << __func__ << " read " << (success ? "succeeded" : "FAILED!")
-           << " entry: " << (entry ? entry->ToLogString() : "nullptr");
-
-  std::move(get_stats_cb).Run(success, std::move(entry));
+  return entry;
 }
 
 void VideoDecodeStatsDBImpl::ClearStats(base::OnceClosure clear_done_cb) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   DVLOG(2) << __func__;
 
+  // Forget everything, including appends that haven't been written yet, and
+  // whatever is read by the reads that are in progress.
+  clear_count_++;
+  cache_.Clear();
+  prefix_index_.clear();
+  flush_timer_.Stop();
+  unflushed_entries_.clear();
+  for (auto& append_done_cb : unflushed_append_cbs_) {
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(std::move(append_done_cb), false));
+  }
+  unflushed_append_cbs_.clear();
+
   db_->UpdateEntriesWithRemoveFilter(
       std::make_unique<ProtoDecodeStatsEntry::KeyEntryVector>(),
       base::BindRepeating([](const std::string& key) { return true; }),
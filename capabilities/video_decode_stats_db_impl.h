@@ -5,13 +5,20 @@
 #ifndef MEDIA_CAPABILITIES_VIDEO_DECODE_STATS_DB_IMPL_H_
 #define MEDIA_CAPABILITIES_VIDEO_DECODE_STATS_DB_IMPL_H_
 
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/cancelable_callback.h"
 #include "base/containers/flat_map.h"
+#include "base/containers/flat_set.h"
+#include "base/containers/lru_cache.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/metrics/field_trial_params.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "components/leveldb_proto/public/proto_database.h"
 #include "media/base/media_export.h"
 #include "media/base/video_codecs.h"
@@ -34,6 +41,19 @@ class DecodeStatsProto;
 // LevelDB implementation of VideoDecodeStatsDB. This class is not
 // thread safe. All API calls should happen on the same sequence used for
 // construction. API callbacks will also occur on this sequence.
+//
+// Recently used entries are cached in memory, so that reads and appends for
+// them don't touch LevelDB. Appends update the cache right away, and are
+// written to LevelDB together in one batch, kFlushDelay after the first one,
+// or sooner if many entries are waiting. A batch is written atomically, and
+// AppendDecodeStatsCB only reports success once the batch containing the
+// append is on disk, so a crash loses at most the unwritten appends, and
+// never leaves a partial update behind.
+//
+// GetDecodeStatsBatch() answers the keys that aren't cached with one scan of
+// the DB for their key prefixes (see VideoDescKey::SerializePrefix()), and
+// remembers which keys exist for each scanned prefix. Later lookups of keys
+// that don't exist under a scanned prefix need no DB access at all.
 class MEDIA_EXPORT VideoDecodeStatsDBImpl : public VideoDecodeStatsDB {
  public:
   static const char kMaxFramesPerBufferParamName[];
@@ -59,13 +79,31 @@ class MEDIA_EXPORT VideoDecodeStatsDBImpl : public VideoDecodeStatsDB {
                          AppendDecodeStatsCB append_done_cb) override;
   void GetDecodeStats(const VideoDescKey& key,
                       GetDecodeStatsCB get_stats_cb) override;
+  void GetDecodeStatsBatch(std::vector<VideoDescKey> keys,
+                           GetDecodeStatsBatchCB get_stats_cb) override;
   void ClearStats(base::OnceClosure clear_done_cb) override;
 
  private:
   friend class VideoDecodeStatsDBImplTest;
+  friend class VideoDecodeStatsDBImplPerfTest;
 
   using PendingOpId = int;
 
+  // Called with whether a read of the DB, which an operation was waiting for,
+  // succeeded. On success, the entry is in |cache_|.
+  using ReadDoneCB = base::OnceCallback<void(bool success)>;
+
+  // Maximum number of entries in |cache_|. The DB holds one entry per
+  // bucketed VideoDescKey, and a user typically plays a handful of them.
+  static constexpr size_t kCacheSize = 64;
+
+  // Unwritten appends are written this long after the first of them.
+  static constexpr base::TimeDelta kFlushDelay = base::Seconds(10);
+
+  // Unwritten appends are written right away once this many entries are
+  // waiting to be written.
+  static constexpr size_t kMaxUnflushedEntries = 32;
+
   // Private constructor only called by tests (friends). Production code
   // should always use the static Create() method.
   VideoDecodeStatsDBImpl(
@@ -128,6 +166,7 @@ class MEDIA_EXPORT VideoDecodeStatsDBImpl : public VideoDecodeStatsDB {
 
    private:
     friend class VideoDecodeStatsDBImplTest;
+    friend class VideoDecodeStatsDBImplPerfTest;
 
     std::string uma_str_;
     std::unique_ptr<base::CancelableOnceClosure> timeout_closure_;
@@ -146,28 +185,68 @@ class MEDIA_EXPORT VideoDecodeStatsDBImpl : public VideoDecodeStatsDB {
   // Returns true if the DB is successfully initialized.
   bool IsInitialized();
 
-  // Passed as the callback for |OnGotDecodeStats| by |AppendDecodeStats| to
-  // update the database once we've read the existing stats entry.
-  void WriteUpdatedEntry(PendingOpId op_id,
-                         const VideoDescKey& key,
+  // Looks up |db_key| in |cache_|, or in |unflushed_entries_| if it has been
+  // evicted from the cache since it was last appended to. Returns false if
+  // the DB has to be read. Otherwise, sets |stats_proto| to the entry, which
+  // is null if the DB has no entry for |db_key|.
+  bool FindCachedEntry(const std::string& db_key,
+                       const DecodeStatsProto** stats_proto);
+
+  // Reads |db_key| from the DB into |cache_|, then runs |read_done_cb|. Only
+  // one read per key is in progress at a time; operations on a key that's
+  // being read wait for that read, in the order that they were requested.
+  void ReadEntry(const std::string& db_key, ReadDoneCB read_done_cb);
+
+  // Called when the DB read started by ReadEntry() completes.
+  void OnGotEntry(PendingOpId op_id,
+                  const std::string& db_key,
+                  int clear_count,
+                  bool success,
+                  std::unique_ptr<DecodeStatsProto> stats_proto);
+
+  // Passed to ReadEntry() by AppendDecodeStats() and GetDecodeStats() to
+  // finish the operation once the entry has been read.
+  void OnReadForAppend(const std::string& db_key,
+                       const DecodeStatsEntry& entry,
+                       AppendDecodeStatsCB append_done_cb,
+                       bool read_success);
+  void OnReadForGet(const std::string& db_key,
+                    GetDecodeStatsCB get_stats_cb,
+                    bool read_success);
+
+  // Adds |entry| to the cached entry for |db_key|, and queues the result to
+  // be written to the DB. |append_done_cb| is run once it has been written.
+  void UpdateCachedEntry(const std::string& db_key,
                          const DecodeStatsEntry& entry,
-                         AppendDecodeStatsCB append_done_cb,
-                         bool read_success,
-                         std::unique_ptr<DecodeStatsProto> stats_proto);
-
-  // Called when the database has been modified after a call to
-  // |WriteUpdatedEntry|. Will run |append_done_cb| when done.
-  void OnEntryUpdated(PendingOpId op_id,
-                      AppendDecodeStatsCB append_done_cb,
-                      bool success);
-
-  // Called when GetDecodeStats() operation was performed. |get_stats_cb|
-  // will be run with |success| and a |DecodeStatsEntry| created from
-  // |stats_proto| or nullptr if no entry was found for the requested key.
-  void OnGotDecodeStats(PendingOpId op_id,
-                        GetDecodeStatsCB get_stats_cb,
-                        bool success,
-                        std::unique_ptr<DecodeStatsProto> stats_proto);
+                         AppendDecodeStatsCB append_done_cb);
+
+  // Writes all of |unflushed_entries_| to the DB in one batch.
+  void FlushUnflushedEntries();
+
+  // Called when the batch written by FlushUnflushedEntries() is done. Runs
+  // |append_done_cbs| with |success|.
+  void OnEntriesFlushed(PendingOpId op_id,
+                        std::vector<std::string> db_keys,
+                        std::vector<AppendDecodeStatsCB> append_done_cbs,
+                        bool success);
+
+  // Called when the DB scan started by GetDecodeStatsBatch() completes.
+  // |unresolved_keys| are the indices and serialized keys of the requested
+  // keys that |entries| has no answer for yet.
+  void OnPrefixesScanned(
+      PendingOpId op_id,
+      std::vector<std::string> prefixes,
+      int clear_count,
+      std::vector<std::pair<size_t, std::string>> unresolved_keys,
+      std::vector<std::unique_ptr<DecodeStatsEntry>> entries,
+      GetDecodeStatsBatchCB get_stats_cb,
+      bool success,
+      std::unique_ptr<std::map<std::string, DecodeStatsProto>> db_entries);
+
+  // Returns a DecodeStatsEntry for |stats_proto|, or nullptr if it's null or
+  // not usable.
+  std::unique_ptr<DecodeStatsEntry> CreateDecodeStatsEntry(
+      const DecodeStatsProto* stats_proto);
 
   // Internal callback for OnLoadAllKeysForClearing(), initially triggered by
   // ClearStats(). Method simply logs |success| and runs |clear_done_cb|.
@@ -205,6 +284,41 @@ class MEDIA_EXPORT VideoDecodeStatsDBImpl : public VideoDecodeStatsDB {
   // Stores parsed value of |kDefaultWriteTime|.
   base::Time default_write_time_;
 
+  // Latest stats for recently used keys, by serialized VideoDescKey,
+  // including appends that haven't been written to the DB yet. A null proto
+  // means that the DB has no entry for the key.
+  base::LRUCache<std::string, std::unique_ptr<DecodeStatsProto>> cache_{
+      kCacheSize};
+
+  // DB reads in progress, by serialized VideoDescKey, with the operations
+  // waiting for each of them.
+  base::flat_map<std::string, std::vector<ReadDoneCB>> pending_reads_;
+
+  // Entries that have been appended to but not yet written to the DB, and the
+  // callbacks for those appends. Written by FlushUnflushedEntries().
+  base::flat_map<std::string, DecodeStatsProto> unflushed_entries_;
+  std::vector<AppendDecodeStatsCB> unflushed_append_cbs_;
+  base::OneShotTimer flush_timer_;
+
+  // Keys that exist in the DB, for each prefix that GetDecodeStatsBatch() has
+  // scanned or is scanning. Once a scan is |complete|, keys with its prefix
+  // that aren't in |keys| have no DB entry. Appends add their key right away,
+  // so that a scan that's in progress can't miss it.
+  struct PrefixIndex {
+    PrefixIndex();
+    PrefixIndex(PrefixIndex&& other);
+    PrefixIndex& operator=(PrefixIndex&& other);
+    ~PrefixIndex();
+
+    bool complete = false;
+    base::flat_set<std::string> keys;
+  };
+  base::flat_map<std::string, PrefixIndex> prefix_index_;
+
+  // Number of calls to ClearStats(). Reads that were started before the last
+  // call return data that has since been cleared.
+  int clear_count_ = 0;
+
   // Ensures all access to class members come on the same sequence. API calls
   // and callbacks should occur on the same sequence used during construction.
   // LevelDB operations happen on a separate task runner, but all LevelDB
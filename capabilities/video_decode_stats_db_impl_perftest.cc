@@ -0,0 +1,278 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "components/leveldb_proto/testing/fake_db.h"
+#include "media/capabilities/video_decode_stats.pb.h"
+#include "media/capabilities/video_decode_stats_db_impl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "ui/gfx/geometry/size.h"
+
+using leveldb_proto::test::FakeDB;
+
+namespace media {
+
+namespace {
+
+// Number of simulated playbacks in each measurement.
+constexpr size_t kNumPlaybacks = 1000;
+
+// Time from the start of one playback to the start of the next.
+constexpr base::TimeDelta kTimeBetweenPlaybacks = base::Seconds(2);
+
+// Number of configs that a page probes with MediaCapabilities at once.
+constexpr size_t kNumBurstConfigs = 50;
+
+// Simulated time that LevelDB takes for each operation, on the DB sequence, in
+// the burst tests. Operations run one at a time on that sequence.
+constexpr base::TimeDelta kDBOpLatency = base::Milliseconds(2);
+
+}  // namespace
+
+// Counts the LevelDB operations that VideoDecodeStatsDBImpl does for a stream
+// of playbacks, each of which queries the stats for its stream before it
+// starts, and appends to them when it ends, as VideoDecodePerfHistory does.
+// Before the in-memory cache, every playback took two reads and one write.
+//
+// Also measures how long a burst of queries for many configs takes to be
+// answered, one query at a time and as one batch.
+class VideoDecodeStatsDBImplPerfTest : public testing::Test {
+ public:
+  using VideoDescKey = VideoDecodeStatsDB::VideoDescKey;
+  using DecodeStatsEntry = VideoDecodeStatsDB::DecodeStatsEntry;
+
+  VideoDecodeStatsDBImplPerfTest() {
+    fake_db_map_ = std::make_unique<FakeDB<DecodeStatsProto>::EntryMap>();
+    fake_db_ = new FakeDB<DecodeStatsProto>(fake_db_map_.get());
+    stats_db_ = base::WrapUnique(new VideoDecodeStatsDBImpl(
+        std::unique_ptr<FakeDB<DecodeStatsProto>>(fake_db_)));
+
+    stats_db_->Initialize(base::DoNothing());
+    fake_db_->InitStatusCallback(leveldb_proto::Enums::InitStatus::kOK);
+  }
+
+ protected:
+  // Completes the pending DB operations, one at a time, as the fake DB only
+  // holds one callback of each kind. Each one takes |db_op_latency_|.
+  void CompletePendingOps() {
+    while (!stats_db_->pending_ops_.empty()) {
+      ASSERT_EQ(stats_db_->pending_ops_.size(), 1u);
+      const std::string op_name =
+          stats_db_->pending_ops_.begin()->second->uma_str_;
+      task_environment_.FastForwardBy(db_op_latency_);
+      if (op_name == "Read") {
+        num_reads_++;
+        fake_db_->GetCallback(true);
+      } else if (op_name == "Scan") {
+        num_reads_++;
+        fake_db_->LoadCallback(true);
+      } else {
+        ASSERT_EQ(op_name, "Write");
+        num_writes_++;
+        fake_db_->UpdateCallback(true);
+      }
+    }
+  }
+
+  // Reports the DB operations per playback for |kNumPlaybacks| playbacks,
+  // spread over |num_keys| distinct keys.
+  void RunPlaybackTest(const std::string& story, size_t num_keys) {
+    std::vector<VideoDescKey> keys;
+    for (size_t i = 0; i < num_keys; i++) {
+      keys.push_back(VideoDescKey::MakeBucketedKey(
+          VP9PROFILE_PROFILE0, gfx::Size(1920, 1080), 30,
+          "key_system_" + base::NumberToString(i), false));
+    }
+
+    size_t num_appended = 0;
+    size_t num_read = 0;
+    for (size_t i = 0; i < kNumPlaybacks; i++) {
+      // Cycle through the keys in an uneven order, so that some of them are
+      // played more often than others.
+      const VideoDescKey& key = keys[(i * i + i / 3) % num_keys];
+
+      stats_db_->GetDecodeStats(
+          key, base::BindOnce(
+                   [](size_t* num_read, bool success,
+                      std::unique_ptr<DecodeStatsEntry> entry) {
+                     if (success)
+                       (*num_read)++;
+                   },
+                   &num_read));
+      CompletePendingOps();
+
+      stats_db_->AppendDecodeStats(
+          key, DecodeStatsEntry(1000, i % 10, 500),
+          base::BindOnce(
+              [](size_t* num_appended, bool success) {
+                if (success)
+                  (*num_appended)++;
+              },
+              &num_appended));
+      CompletePendingOps();
+
+      task_environment_.FastForwardBy(kTimeBetweenPlaybacks);
+      CompletePendingOps();
+    }
+
+    // Write out the last batch.
+    task_environment_.FastForwardBy(VideoDecodeStatsDBImpl::kFlushDelay);
+    CompletePendingOps();
+    EXPECT_EQ(num_read, kNumPlaybacks);
+    EXPECT_EQ(num_appended, kNumPlaybacks);
+
+    perf_test::PerfResultReporter reporter("video_decode_stats_db", story);
+    reporter.RegisterImportantMetric("_db_ops_per_playback", "count");
+    reporter.RegisterFyiMetric("_db_reads_per_playback", "count");
+    reporter.RegisterFyiMetric("_db_writes_per_playback", "count");
+    reporter.AddResult("_db_ops_per_playback",
+                       static_cast<double>(num_reads_ + num_writes_) /
+                           kNumPlaybacks);
+    reporter.AddResult("_db_reads_per_playback",
+                       static_cast<double>(num_reads_) / kNumPlaybacks);
+    reporter.AddResult("_db_writes_per_playback",
+                       static_cast<double>(num_writes_) / kNumPlaybacks);
+  }
+
+  // Returns |kNumBurstConfigs| keys, for every combination of a few codec
+  // profiles, sizes and frame rates, with |key_system|.
+  std::vector<VideoDescKey> MakeBurstKeys(const std::string& key_system) {
+    const VideoCodecProfile kProfiles[] = {
+        H264PROFILE_MAIN, VP9PROFILE_PROFILE0, AV1PROFILE_PROFILE_MAIN};
+    const gfx::Size kSizes[] = {gfx::Size(640, 360), gfx::Size(1280, 720),
+                                gfx::Size(1920, 1080), gfx::Size(2560, 1440),
+                                gfx::Size(3840, 2160)};
+    const int kFrameRates[] = {24, 30, 60, 120};
+
+    std::vector<VideoDescKey> keys;
+    for (VideoCodecProfile profile : kProfiles) {
+      for (const gfx::Size& size : kSizes) {
+        for (int frame_rate : kFrameRates) {
+          if (keys.size() < kNumBurstConfigs) {
+            keys.push_back(VideoDescKey::MakeBucketedKey(
+                profile, size, frame_rate, key_system, false));
+          }
+        }
+      }
+    }
+    return keys;
+  }
+
+  // Stores stats for every other key in |keys| directly in the fake DB.
+  void SeedDB(const std::vector<VideoDescKey>& keys) {
+    DecodeStatsProto proto;
+    proto.set_frames_decoded(1000);
+    proto.set_frames_dropped(10);
+    proto.set_frames_power_efficient(500);
+    proto.set_last_write_date(base::Time::Now().ToJsTime());
+    for (size_t i = 0; i < keys.size(); i += 2)
+      (*fake_db_map_)[keys[i].Serialize()] = proto;
+  }
+
+  // Reports the time until the last answer for |keys|, and the DB operations
+  // it took, when asked one key at a time, or all at once if |batch|.
+  void RunBurstTest(const std::string& story,
+                    const std::vector<VideoDescKey>& keys,
+                    bool batch) {
+    db_op_latency_ = kDBOpLatency;
+    num_reads_ = 0;
+    num_writes_ = 0;
+
+    size_t num_answered = 0;
+    const base::TimeTicks start = base::TimeTicks::Now();
+    if (batch) {
+      stats_db_->GetDecodeStatsBatch(
+          keys, base::BindOnce(
+                    [](size_t* num_answered, bool success,
+                       std::vector<std::unique_ptr<DecodeStatsEntry>> entries) {
+                      if (success)
+                        *num_answered += entries.size();
+                    },
+                    &num_answered));
+      CompletePendingOps();
+    } else {
+      // Queries are sent at once, but the DB sequence runs them one at a time.
+      // The fake DB only holds one read, so send each one once the previous
+      // one is done, which takes the same time.
+      for (const VideoDescKey& key : keys) {
+        stats_db_->GetDecodeStats(
+            key, base::BindOnce(
+                     [](size_t* num_answered, bool success,
+                        std::unique_ptr<DecodeStatsEntry> entry) {
+                       if (success)
+                         (*num_answered)++;
+                     },
+                     &num_answered));
+        CompletePendingOps();
+      }
+    }
+    task_environment_.RunUntilIdle();
+    const base::TimeDelta latency = base::TimeTicks::Now() - start;
+    EXPECT_EQ(num_answered, keys.size());
+
+    perf_test::PerfResultReporter reporter("video_decode_stats_db", story);
+    reporter.RegisterImportantMetric("_burst_latency", "ms");
+    reporter.RegisterFyiMetric("_db_ops_per_burst", "count");
+    reporter.AddResult("_burst_latency", latency.InMillisecondsF());
+    reporter.AddResult("_db_ops_per_burst",
+                       static_cast<double>(num_reads_ + num_writes_));
+  }
+
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+
+  std::unique_ptr<FakeDB<DecodeStatsProto>::EntryMap> fake_db_map_;
+  FakeDB<DecodeStatsProto>* fake_db_;
+  std::unique_ptr<VideoDecodeStatsDBImpl> stats_db_;
+
+  base::TimeDelta db_op_latency_;
+  size_t num_reads_ = 0;
+  size_t num_writes_ = 0;
+};
+
+// All the keys fit in the cache.
+TEST_F(VideoDecodeStatsDBImplPerfTest, FewKeys) {
+  RunPlaybackTest("20_keys", 20);
+}
+
+// Many more keys than fit in the cache.
+TEST_F(VideoDecodeStatsDBImplPerfTest, ManyKeys) {
+  RunPlaybackTest("500_keys", 500);
+}
+
+// A burst of queries for configs that haven't been queried before.
+TEST_F(VideoDecodeStatsDBImplPerfTest, BurstOfSingleGets) {
+  const std::vector<VideoDescKey> keys = MakeBurstKeys("");
+  SeedDB(keys);
+  RunBurstTest("50_config_burst_single_gets", keys, false);
+}
+
+TEST_F(VideoDecodeStatsDBImplPerfTest, BurstOfBatchedGets) {
+  const std::vector<VideoDescKey> keys = MakeBurstKeys("");
+  SeedDB(keys);
+  RunBurstTest("50_config_burst_batched", keys, true);
+}
+
+// A burst for the same codec profiles and sizes, but other keys, after one
+// batch has warmed up the prefix index.
+TEST_F(VideoDecodeStatsDBImplPerfTest, WarmBurstOfBatchedGets) {
+  const std::vector<VideoDescKey> keys = MakeBurstKeys("");
+  SeedDB(keys);
+  RunBurstTest("50_config_burst_batched_cold", keys, true);
+  RunBurstTest("50_config_burst_batched_warm", MakeBurstKeys("org.w3.clearkey"),
+               true);
+}
+
+}  // namespace media
@@ -4,6 +4,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback.h"
@@ -38,6 +39,11 @@ class VideoDecodeStatsDBImplTest : public ::testing::Test {
   using VideoDescKey = VideoDecodeStatsDB::VideoDescKey;
   using DecodeStatsEntry = VideoDecodeStatsDB::DecodeStatsEntry;
 
+  static constexpr base::TimeDelta kFlushDelay =
+      VideoDecodeStatsDBImpl::kFlushDelay;
+  static constexpr size_t kMaxUnflushedEntries =
+      VideoDecodeStatsDBImpl::kMaxUnflushedEntries;
+
   VideoDecodeStatsDBImplTest()
       : kStatsKeyVp9(VideoDescKey::MakeBucketedKey(VP9PROFILE_PROFILE3,
                                                    gfx::Size(1024, 768),
@@ -111,37 +117,59 @@ class VideoDecodeStatsDBImplTest : public ::testing::Test {
     testing::Mock::VerifyAndClearExpectations(this);
   }
 
-  void AppendStats(const VideoDescKey& key, const DecodeStatsEntry& entry) {
-    EXPECT_CALL(*this, MockAppendDecodeStatsCb(true));
+  // Completes the DB read for an operation on a key that isn't cached. Does
+  // nothing if the key was cached.
+  void CompleteReadIfPending() {
+    if (stats_db_->pending_ops_.empty())
+      return;
+    VerifyOnePendingOp("Read");
+    fake_db_->GetCallback(true);
+  }
+
+  // Waits for the unwritten appends to be written to the DB in one batch,
+  // which either succeeds or fails.
+  void FlushWrites(bool success) {
+    task_environment_.FastForwardBy(kFlushDelay);
+    VerifyOnePendingOp("Write");
+    fake_db_->UpdateCallback(success);
+  }
+
+  void AppendStatsAsync(const VideoDescKey& key,
+                        const DecodeStatsEntry& entry) {
     stats_db_->AppendDecodeStats(
         key, entry,
         base::BindOnce(&VideoDecodeStatsDBImplTest::MockAppendDecodeStatsCb,
                        base::Unretained(this)));
-    VerifyOnePendingOp("Read");
-    fake_db_->GetCallback(true);
-    VerifyOnePendingOp("Write");
-    fake_db_->UpdateCallback(true);
+  }
+
+  void GetDecodeStatsAsync(const VideoDescKey& key) {
+    stats_db_->GetDecodeStats(
+        key, base::BindOnce(&VideoDecodeStatsDBImplTest::GetDecodeStatsCb,
+                            base::Unretained(this)));
+  }
+
+  void AppendStats(const VideoDescKey& key, const DecodeStatsEntry& entry) {
+    EXPECT_CALL(*this, MockAppendDecodeStatsCb(true));
+    AppendStatsAsync(key, entry);
+    CompleteReadIfPending();
+    FlushWrites(true);
     testing::Mock::VerifyAndClearExpectations(this);
   }
 
   void VerifyReadStats(const VideoDescKey& key,
                        const DecodeStatsEntry& expected) {
     EXPECT_CALL(*this, MockGetDecodeStatsCb(true, Pointee(Eq(expected))));
-    stats_db_->GetDecodeStats(
-        key, base::BindOnce(&VideoDecodeStatsDBImplTest::GetDecodeStatsCb,
-                            base::Unretained(this)));
-    VerifyOnePendingOp("Read");
-    fake_db_->GetCallback(true);
+    GetDecodeStatsAsync(key);
+    CompleteReadIfPending();
+    task_environment_.RunUntilIdle();
     testing::Mock::VerifyAndClearExpectations(this);
   }
 
   void VerifyEmptyStats(const VideoDescKey& key) {
     EXPECT_CALL(*this, MockGetDecodeStatsCb(true, nullptr));
-    stats_db_->GetDecodeStats(
-        key, base::BindOnce(&VideoDecodeStatsDBImplTest::GetDecodeStatsCb,
-                            base::Unretained(this)));
-    VerifyOnePendingOp("Read");
-    fake_db_->GetCallback(true);
+    GetDecodeStatsAsync(key);
+    CompleteReadIfPending();
+    task_environment_.RunUntilIdle();
     testing::Mock::VerifyAndClearExpectations(this);
   }
 
@@ -150,6 +178,23 @@ class VideoDecodeStatsDBImplTest : public ::testing::Test {
     MockGetDecodeStatsCb(success, entry.get());
   }
 
+  void GetDecodeStatsBatchAsync(std::vector<VideoDescKey> keys) {
+    batch_done_ = false;
+    stats_db_->GetDecodeStatsBatch(
+        std::move(keys),
+        base::BindOnce(&VideoDecodeStatsDBImplTest::GetDecodeStatsBatchCb,
+                       base::Unretained(this)));
+  }
+
+  void GetDecodeStatsBatchCb(
+      bool success,
+      std::vector<std::unique_ptr<DecodeStatsEntry>> entries) {
+    EXPECT_FALSE(batch_done_);
+    batch_done_ = true;
+    batch_success_ = success;
+    batch_entries_ = std::move(entries);
+  }
+
   void AppendToProtoDB(const VideoDescKey& key,
                        const DecodeStatsProto* const proto) {
     base::RunLoop run_loop;
@@ -197,6 +242,11 @@ class VideoDecodeStatsDBImplTest : public ::testing::Test {
   std::unique_ptr<FakeDB<DecodeStatsProto>::EntryMap> fake_db_map_;
   FakeDB<DecodeStatsProto>* fake_db_;
   std::unique_ptr<VideoDecodeStatsDBImpl> stats_db_;
+
+  // Results of the last GetDecodeStatsBatchAsync().
+  bool batch_done_ = false;
+  bool batch_success_ = false;
+  std::vector<std::unique_ptr<DecodeStatsEntry>> batch_entries_;
 };
 
 TEST_F(VideoDecodeStatsDBImplTest, InitializeFailed) {
@@ -356,12 +406,141 @@ TEST_F(VideoDecodeStatsDBImplTest, FailedWrite) {
   EXPECT_CALL(*this, MockAppendDecodeStatsCb(false));
 
   // Append stats, but fail the internal DB update.
-  stats_db_->AppendDecodeStats(
-      kStatsKeyVp9, DecodeStatsEntry(1000, 2, 10),
-      base::BindOnce(&VideoDecodeStatsDBImplTest::MockAppendDecodeStatsCb,
-                     base::Unretained(this)));
+  AppendStatsAsync(kStatsKeyVp9, DecodeStatsEntry(1000, 2, 10));
+  fake_db_->GetCallback(true);
+  FlushWrites(false);
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  // The failed append should be dropped from the cache too, so that the next
+  // read goes to the DB and finds nothing.
+  VerifyEmptyStats(kStatsKeyVp9);
+}
+
+TEST_F(VideoDecodeStatsDBImplTest, ReadsAreCached) {
+  InitializeDB();
+
+  DecodeStatsProto proto;
+  proto.set_frames_decoded(100);
+  proto.set_frames_dropped(10);
+  proto.set_frames_power_efficient(1);
+  proto.set_last_write_date(base::Time::Now().ToJsTime());
+  AppendToProtoDB(kStatsKeyVp9, &proto);
+
+  // The first read goes to the DB.
+  GetDecodeStatsAsync(kStatsKeyVp9);
+  VerifyOnePendingOp("Read");
+  EXPECT_CALL(*this,
+              MockGetDecodeStatsCb(true, Pointee(Eq(DecodeStatsEntry(
+                                                 100, 10, 1)))));
+  fake_db_->GetCallback(true);
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  // Later reads, and appends, are served from the cache. The callbacks still
+  // run asynchronously.
+  GetDecodeStatsAsync(kStatsKeyVp9);
+  AppendStatsAsync(kStatsKeyVp9, DecodeStatsEntry(100, 0, 0));
+  GetDecodeStatsAsync(kStatsKeyVp9);
+  VerifyNoPendingOps();
+  EXPECT_CALL(*this,
+              MockGetDecodeStatsCb(true, Pointee(Eq(DecodeStatsEntry(
+                                                 100, 10, 1)))));
+  EXPECT_CALL(*this,
+              MockGetDecodeStatsCb(true, Pointee(Eq(DecodeStatsEntry(
+                                                 200, 10, 1)))));
+  task_environment_.RunUntilIdle();
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  EXPECT_CALL(*this, MockAppendDecodeStatsCb(true));
+  FlushWrites(true);
+}
+
+TEST_F(VideoDecodeStatsDBImplTest, OperationsShareOneRead) {
+  InitializeDB();
+
+  // Operations on a key that's being read wait for the read, in order.
+  AppendStatsAsync(kStatsKeyVp9, DecodeStatsEntry(1000, 2, 10));
+  AppendStatsAsync(kStatsKeyVp9, DecodeStatsEntry(1000, 2, 10));
+  GetDecodeStatsAsync(kStatsKeyVp9);
+  VerifyOnePendingOp("Read");
+
+  EXPECT_CALL(*this,
+              MockGetDecodeStatsCb(true, Pointee(Eq(DecodeStatsEntry(
+                                                 2000, 4, 20)))));
   fake_db_->GetCallback(true);
-  fake_db_->UpdateCallback(false);
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  // Both appends are written together.
+  EXPECT_CALL(*this, MockAppendDecodeStatsCb(true)).Times(2);
+  FlushWrites(true);
+}
+
+TEST_F(VideoDecodeStatsDBImplTest, AppendsAreWrittenInOneBatch) {
+  InitializeDB();
+
+  AppendStatsAsync(kStatsKeyVp9, DecodeStatsEntry(1000, 2, 10));
+  fake_db_->GetCallback(true);
+  AppendStatsAsync(kStatsKeyAvc, DecodeStatsEntry(500, 5, 0));
+  fake_db_->GetCallback(true);
+
+  // Nothing is written, nor acknowledged, until the flush delay expires.
+  EXPECT_CALL(*this, MockAppendDecodeStatsCb(_)).Times(0);
+  task_environment_.FastForwardBy(kFlushDelay - base::Milliseconds(1));
+  VerifyNoPendingOps();
+  EXPECT_TRUE(fake_db_map_->empty());
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  EXPECT_CALL(*this, MockAppendDecodeStatsCb(true)).Times(2);
+  task_environment_.FastForwardBy(base::Milliseconds(1));
+  VerifyOnePendingOp("Write");
+  fake_db_->UpdateCallback(true);
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  EXPECT_EQ(fake_db_map_->size(), 2u);
+}
+
+TEST_F(VideoDecodeStatsDBImplTest, WritesWhenManyEntriesAreWaiting) {
+  InitializeDB();
+
+  // Append to distinct keys, until there are enough entries waiting to write
+  // them without waiting for the flush delay.
+  for (size_t i = 0; i < kMaxUnflushedEntries; i++) {
+    VerifyNoPendingOps();
+    AppendStatsAsync(VideoDescKey::MakeBucketedKey(
+                         VP9PROFILE_PROFILE0, gfx::Size(1024, 768), 60,
+                         "key_system_" + base::NumberToString(i), false),
+                     DecodeStatsEntry(1000, 2, 10));
+    fake_db_->GetCallback(true);
+  }
+
+  VerifyOnePendingOp("Write");
+  EXPECT_CALL(*this, MockAppendDecodeStatsCb(true))
+      .Times(static_cast<int>(kMaxUnflushedEntries));
+  fake_db_->UpdateCallback(true);
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  EXPECT_EQ(fake_db_map_->size(), kMaxUnflushedEntries);
+}
+
+TEST_F(VideoDecodeStatsDBImplTest, ClearDropsUnwrittenAppends) {
+  InitializeDB();
+
+  AppendStatsAsync(kStatsKeyVp9, DecodeStatsEntry(1000, 2, 10));
+  fake_db_->GetCallback(true);
+
+  // Clearing fails the append that hasn't been written yet.
+  EXPECT_CALL(*this, MockAppendDecodeStatsCb(false));
+  EXPECT_CALL(*this, MockClearStatsCb);
+  stats_db_->ClearStats(base::BindOnce(
+      &VideoDecodeStatsDBImplTest::MockClearStatsCb, base::Unretained(this)));
+  VerifyOnePendingOp("Clear");
+  fake_db_->UpdateCallback(true);
+  task_environment_.FastForwardBy(kFlushDelay);
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  // Nothing was written, and the cache is empty.
+  VerifyNoPendingOps();
+  EXPECT_TRUE(fake_db_map_->empty());
+  VerifyEmptyStats(kStatsKeyVp9);
 }
 
 TEST_F(VideoDecodeStatsDBImplTest, FillBufferInMixedIncrements) {
@@ -652,7 +831,7 @@ TEST_F(VideoDecodeStatsDBImplTest, EnableUnweightedEntries) {
   // unweighted DB entries. The denominator is 100,000 * the number of appends
   // and the numerator is whatever value achieves the correct unweighted ratio
   // for those appends. See detailed comment in
-  // VideoDecodeStatsDBImpl::OnGotDecodeStats();
+  // VideoDecodeStatsDBImpl::CreateDecodeStatsEntry();
   const int kNumAppendScale = 100000;
   int expected_denominator = kNumAppendScale * num_appends;
   VerifyReadStats(
@@ -774,4 +953,79 @@ TEST_F(VideoDecodeStatsDBImplTest, DiscardCorruptedDBData) {
   VerifyEmptyStats(keyG);
 }
 
+TEST_F(VideoDecodeStatsDBImplTest, BatchGetScansOnce) {
+  InitializeDB();
+
+  DecodeStatsProto proto;
+  proto.set_frames_decoded(100);
+  proto.set_frames_dropped(10);
+  proto.set_frames_power_efficient(1);
+  proto.set_last_write_date(base::Time::Now().ToJsTime());
+  AppendToProtoDB(kStatsKeyVp9, &proto);
+
+  // Same codec profile and size as |kStatsKeyVp9|, but no entry in the DB.
+  const auto key_vp9_30fps = VideoDescKey::MakeBucketedKey(
+      VP9PROFILE_PROFILE3, gfx::Size(1024, 768), 30, "com.widevine.alpha",
+      true);
+  const auto key_vp9_50fps = VideoDescKey::MakeBucketedKey(
+      VP9PROFILE_PROFILE3, gfx::Size(1024, 768), 50, "", false);
+
+  // Keys that aren't cached are answered by a single scan of the DB.
+  GetDecodeStatsBatchAsync({kStatsKeyVp9, key_vp9_30fps, kStatsKeyAvc});
+  VerifyOnePendingOp("Scan");
+  fake_db_->LoadCallback(true);
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(batch_done_);
+  EXPECT_TRUE(batch_success_);
+  ASSERT_EQ(batch_entries_.size(), 3u);
+  ASSERT_TRUE(batch_entries_[0]);
+  EXPECT_EQ(*batch_entries_[0], DecodeStatsEntry(100, 10, 1));
+  EXPECT_FALSE(batch_entries_[1]);
+  EXPECT_FALSE(batch_entries_[2]);
+
+  // The scanned keys are cached now, and other keys with a scanned prefix are
+  // known to have no entry, so none of these touch the DB.
+  GetDecodeStatsBatchAsync({key_vp9_50fps, kStatsKeyAvc, kStatsKeyVp9});
+  VerifyNoPendingOps();
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(batch_done_);
+  EXPECT_TRUE(batch_success_);
+  ASSERT_EQ(batch_entries_.size(), 3u);
+  EXPECT_FALSE(batch_entries_[0]);
+  EXPECT_FALSE(batch_entries_[1]);
+  ASSERT_TRUE(batch_entries_[2]);
+  EXPECT_EQ(*batch_entries_[2], DecodeStatsEntry(100, 10, 1));
+  VerifyEmptyStats(key_vp9_50fps);
+
+  // Appends are visible to later batches.
+  AppendStats(key_vp9_50fps, DecodeStatsEntry(200, 20, 2));
+  GetDecodeStatsBatchAsync({key_vp9_50fps});
+  VerifyNoPendingOps();
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(batch_done_);
+  ASSERT_EQ(batch_entries_.size(), 1u);
+  ASSERT_TRUE(batch_entries_[0]);
+  EXPECT_EQ(*batch_entries_[0], DecodeStatsEntry(200, 20, 2));
+}
+
+TEST_F(VideoDecodeStatsDBImplTest, FailedBatchGet) {
+  InitializeDB();
+
+  GetDecodeStatsBatchAsync({kStatsKeyVp9, kStatsKeyAvc});
+  VerifyOnePendingOp("Scan");
+  fake_db_->LoadCallback(false);
+  ASSERT_TRUE(batch_done_);
+  EXPECT_FALSE(batch_success_);
+  ASSERT_EQ(batch_entries_.size(), 2u);
+  EXPECT_FALSE(batch_entries_[0]);
+  EXPECT_FALSE(batch_entries_[1]);
+
+  // Nothing was learned from the failed scan, so the next batch scans again.
+  GetDecodeStatsBatchAsync({kStatsKeyVp9, kStatsKeyAvc});
+  VerifyOnePendingOp("Scan");
+  fake_db_->LoadCallback(true);
+  ASSERT_TRUE(batch_done_);
+  EXPECT_TRUE(batch_success_);
+}
+
 }  // namespace media
@@ -4,8 +4,8 @@
 
 #include <string>
 
+#include "media/base/bucket_utility.h"
 #include "media/base/video_codecs.h"
-#include "media/capabilities/bucket_utility.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/gfx/geometry/rect.h"
 
@@ -46,6 +46,22 @@ TEST(VideoDecodeStatsDBTest, KeySerialization) {
   ASSERT_EQ("12|640x360|25|com.example|not_hw_secure", keyD.Serialize());
 }
 
+TEST(VideoDecodeStatsDBTest, KeyPrefixSerialization) {
+  // The prefix covers the codec profile and size bucket only.
+  auto keyA =
+      MakeKey(H264PROFILE_BASELINE, gfx::Size(1280, 720), 30, "", false);
+  ASSERT_EQ("0|1280x720|", keyA.SerializePrefix());
+
+  auto keyB = MakeKey(H264PROFILE_BASELINE, gfx::Size(1270, 710), 60,
+                      "org.w3.clearkey", false);
+  ASSERT_EQ(keyA.SerializePrefix(), keyB.SerializePrefix());
+  ASSERT_EQ(0u, keyB.Serialize().find(keyB.SerializePrefix()));
+
+  auto keyC =
+      MakeKey(H264PROFILE_BASELINE, gfx::Size(1280, 1080), 30, "", false);
+  ASSERT_NE(keyA.SerializePrefix(), keyC.SerializePrefix());
+}
+
 TEST(VideoDecodeStatsDBTest, OperatorEquals) {
   auto keyA =
       MakeKey(H264PROFILE_BASELINE, gfx::Size(1280, 720), 30, "", false);
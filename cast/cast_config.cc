@@ -18,6 +18,20 @@ VideoCodecParams::VideoCodecParams(const VideoCodecParams& other) = default;
 
 VideoCodecParams::~VideoCodecParams() = default;
 
+int VideoCodecParams::GetNumberOfTemporalLayers() const {
+  if (!scalability_mode)
+    return 1;
+  switch (*scalability_mode) {
+    case SVCScalabilityMode::kL1T2:
+      return 2;
+    case SVCScalabilityMode::kL1T3:
+      return 3;
+    default:
+      // Spatial layers are not supported.
+      return 1;
+  }
+}
+
 // TODO(miu): Provide IsValidConfig() functions?
 
 FrameSenderConfig::FrameSenderConfig()
@@ -34,6 +48,8 @@ FrameSenderConfig::FrameSenderConfig()
       animated_playout_delay(min_playout_delay),
       rtp_payload_type(RtpPayloadType::UNKNOWN),
       use_external_encoder(false),
+      congestion_control_type(CongestionControlType::ADAPTIVE),
+      enable_fec(false),
       rtp_timebase(0),
       channels(0),
       max_bitrate(0),
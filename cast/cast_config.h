@@ -15,6 +15,8 @@
 #include "base/memory/unsafe_shared_memory_region.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/time/time.h"
+#include "media/base/svc_scalability_mode.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace media {
 class VideoEncodeAccelerator;
@@ -69,6 +71,19 @@ enum class RtpPayloadType {
   LAST = VIDEO_AV1
 };
 
+// Selects the algorithm a video sender uses to pick its encode bitrate.
+enum class CongestionControlType {
+  // Estimates the available bandwidth from how quickly recent frames were
+  // acknowledged, and backs off as the in-flight data approaches the playout
+  // delay. See AdaptiveCongestionControl.
+  ADAPTIVE,
+
+  // Watches the trend of frame acknowledgement delays and backs off as soon
+  // as queues start to build along the path, before frames are late. See
+  // DelayBasedCongestionControl.
+  DELAY_BASED,
+};
+
 // TODO(miu): Eliminate these after moving "default config" into the top-level
 // media/cast directory.  http://crbug.com/530839
 enum SuggestedDefaults {
@@ -141,6 +156,15 @@ struct VideoCodecParams {
   int max_number_of_video_buffers_used;
 
   int number_of_encode_threads;
+
+  // Temporal scalability of the encoded stream. Only kL1T2 and kL1T3 are
+  // supported; when unset, every frame is in the same layer. Frames of the
+  // enhancement layers are never referenced by the base layer, so they may be
+  // dropped on their way to the receiver when the network is congested.
+  absl::optional<SVCScalabilityMode> scalability_mode;
+
+  // Returns the number of temporal layers of |scalability_mode|.
+  int GetNumberOfTemporalLayers() const;
 };
 
 struct FrameSenderConfig {
@@ -173,6 +197,15 @@ struct FrameSenderConfig {
   // software-based one.
   bool use_external_encoder;
 
+  // The bitrate controller used by the built-in video encoders. Ignored when
+  // |use_external_encoder| is true, or for audio, which use a fixed bitrate.
+  CongestionControlType congestion_control_type;
+
+  // If true, the sender follows frames with forward error correction packets
+  // when the receiver reports packet loss. Receivers that do not support FEC
+  // drop these packets.
+  bool enable_fec;
+
   // RTP timebase: The number of RTP units advanced per one second.  For audio,
   // this is the sampling rate.  For video, by convention, this is 90 kHz.
   int rtp_timebase;
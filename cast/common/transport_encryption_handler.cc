@@ -4,14 +4,15 @@
 
 #include "media/cast/common/transport_encryption_handler.h"
 
-#include <stddef.h>
+#include <string.h>
 
-#include <memory>
+#include <algorithm>
 
+#include "base/check_op.h"
 #include "base/logging.h"
 #include "base/notreached.h"
-#include "crypto/encryptor.h"
-#include "crypto/symmetric_key.h"
+#include "base/stl_util.h"
+#include "third_party/boringssl/src/include/openssl/crypto.h"
 
 namespace media {
 namespace cast {
@@ -22,10 +23,12 @@ namespace {
 const size_t kAesBlockSize = 16;
 const size_t kAesKeySize = 16;
 
-std::string GetAesNonce(FrameId frame_id, const std::string& iv_mask) {
+void GetAesNonce(FrameId frame_id,
+                 const std::string& iv_mask,
+                 uint8_t aes_nonce[kAesBlockSize]) {
   DCHECK(!frame_id.is_null());
 
-  std::string aes_nonce(kAesBlockSize, 0);
+  memset(aes_nonce, 0, kAesBlockSize);
 
   // Serializing frame_id in big-endian order (aes_nonce[8] is the most
   // significant byte of frame_id).
@@ -36,26 +39,43 @@ std::string GetAesNonce(FrameId frame_id, const std::string& iv_mask) {
   aes_nonce[8] = (truncated_id >> 24) & 0xff;
 
   for (size_t i = 0; i < kAesBlockSize; ++i) {
-    aes_nonce[i] ^= iv_mask[i];
+    aes_nonce[i] ^= static_cast<uint8_t>(iv_mask[i]);
+  }
+}
+
+// Advances the big-endian 128-bit |counter| by |num_blocks|, as counter mode
+// does once per block.
+void AdvanceCounter(uint8_t counter[kAesBlockSize], size_t num_blocks) {
+  uint64_t carry = num_blocks;
+  for (int i = kAesBlockSize - 1; i >= 0 && carry; --i) {
+    carry += counter[i];
+    counter[i] = carry & 0xff;
+    carry >>= 8;
   }
-  return aes_nonce;
 }
 
 }  // namespace
 
 TransportEncryptionHandler::TransportEncryptionHandler()
-    : key_(), encryptor_(), iv_mask_(), is_activated_(false) {}
+    : key_(), iv_mask_(), is_activated_(false) {}
 
 TransportEncryptionHandler::~TransportEncryptionHandler() = default;
 
 bool TransportEncryptionHandler::Initialize(const std::string& aes_key,
                                             const std::string& aes_iv_mask) {
   is_activated_ = false;
+  keystream_frame_id_ = FrameId();
+  keystream_.clear();
   if (aes_iv_mask.size() == kAesKeySize && aes_key.size() == kAesKeySize) {
+    // Ensure the crypto library is initialized. CRYPTO_library_init may be
+    // safely called concurrently.
+    CRYPTO_library_init();
     iv_mask_ = aes_iv_mask;
-    key_ = crypto::SymmetricKey::Import(crypto::SymmetricKey::AES, aes_key);
-    encryptor_ = std::make_unique<crypto::Encryptor>();
-    encryptor_->Init(key_.get(), crypto::Encryptor::CTR, std::string());
+    if (AES_set_encrypt_key(reinterpret_cast<const uint8_t*>(aes_key.data()),
+                            kAesKeySize * 8, &key_) != 0) {
+      NOTREACHED() << "Failed to set key";
+      return false;
+    }
     is_activated_ = true;
   } else if (aes_iv_mask.size() != 0 || aes_key.size() != 0) {
     DCHECK_EQ(aes_iv_mask.size(), 0u)
@@ -72,14 +92,9 @@ bool TransportEncryptionHandler::Encrypt(FrameId frame_id,
                                          std::string* encrypted_data) {
   if (!is_activated_)
     return false;
-  if (!encryptor_->SetCounter(GetAesNonce(frame_id, iv_mask_))) {
-    NOTREACHED() << "Failed to set counter";
-    return false;
-  }
-  if (!encryptor_->Encrypt(data, encrypted_data)) {
-    NOTREACHED() << "Encrypt error";
-    return false;
-  }
+  encrypted_data->resize(data.size());
+  Crypt(frame_id, reinterpret_cast<const uint8_t*>(data.data()),
+        reinterpret_cast<uint8_t*>(base::data(*encrypted_data)), data.size());
   return true;
 }
 
@@ -89,16 +104,78 @@ bool TransportEncryptionHandler::Decrypt(FrameId frame_id,
   if (!is_activated_) {
     return false;
   }
-  if (!encryptor_->SetCounter(GetAesNonce(frame_id, iv_mask_))) {
-    NOTREACHED() << "Failed to set counter";
+  plaintext->resize(ciphertext.size());
+  Crypt(frame_id, reinterpret_cast<const uint8_t*>(ciphertext.data()),
+        reinterpret_cast<uint8_t*>(base::data(*plaintext)), ciphertext.size());
+  return true;
+}
+
+bool TransportEncryptionHandler::Encrypt(FrameId frame_id,
+                                         base::span<const uint8_t> data,
+                                         base::span<uint8_t> encrypted_data) {
+  if (!is_activated_)
     return false;
-  }
-  if (!encryptor_->Decrypt(ciphertext, plaintext)) {
-    VLOG(1) << "Decryption error";
+  DCHECK_EQ(data.size(), encrypted_data.size());
+  Crypt(frame_id, data.data(), encrypted_data.data(), data.size());
+  return true;
+}
+
+bool TransportEncryptionHandler::EncryptInPlace(FrameId frame_id,
+                                                base::span<uint8_t> data) {
+  if (!is_activated_)
     return false;
-  }
+  Crypt(frame_id, data.data(), data.data(), data.size());
   return true;
 }
 
+bool TransportEncryptionHandler::DecryptInPlace(FrameId frame_id,
+                                                base::span<uint8_t> data) {
+  return EncryptInPlace(frame_id, data);
+}
+
+void TransportEncryptionHandler::PrecomputeKeystream(FrameId frame_id,
+                                                     size_t size) {
+  if (!is_activated_)
+    return;
+  // The keystream is the encryption of zeros. Generating it in one call lets
+  // BoringSSL encrypt many counter blocks at a time, with AES-NI where
+  // available.
+  const size_t num_blocks = (size + kAesBlockSize - 1) / kAesBlockSize;
+  keystream_.assign(num_blocks * kAesBlockSize, 0);
+  keystream_frame_id_ = frame_id;
+  uint8_t counter[kAesBlockSize];
+  GetAesNonce(frame_id, iv_mask_, counter);
+  uint8_t ecount_buf[kAesBlockSize] = {};
+  unsigned int num = 0;
+  AES_ctr128_encrypt(keystream_.data(), keystream_.data(), keystream_.size(),
+                     &key_, counter, ecount_buf, &num);
+}
+
+void TransportEncryptionHandler::Crypt(FrameId frame_id,
+                                       const uint8_t* in,
+                                       uint8_t* out,
+                                       size_t size) {
+  size_t offset = 0;
+  if (frame_id == keystream_frame_id_) {
+    offset = std::min(size, keystream_.size());
+    const uint8_t* const keystream = keystream_.data();
+    for (size_t i = 0; i < offset; ++i)
+      out[i] = in[i] ^ keystream[i];
+    keystream_frame_id_ = FrameId();
+  }
+  if (offset == size)
+    return;
+
+  // |offset| is a whole number of blocks here, so the rest of the frame
+  // starts at a block boundary.
+  uint8_t counter[kAesBlockSize];
+  GetAesNonce(frame_id, iv_mask_, counter);
+  AdvanceCounter(counter, offset / kAesBlockSize);
+  uint8_t ecount_buf[kAesBlockSize] = {};
+  unsigned int num = 0;
+  AES_ctr128_encrypt(in + offset, out + offset, size - offset, &key_, counter,
+                     ecount_buf, &num);
+}
+
 }  // namespace cast
 }  // namespace media
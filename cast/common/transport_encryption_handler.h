@@ -7,23 +7,25 @@
 
 // Helper class to handle encryption for the Cast Transport library.
 
+#include <stddef.h>
 #include <stdint.h>
 
-#include <memory>
 #include <string>
+#include <vector>
 
+#include "base/containers/span.h"
 #include "base/macros.h"
 #include "base/strings/string_piece.h"
 #include "media/cast/common/frame_id.h"
-
-namespace crypto {
-class Encryptor;
-class SymmetricKey;
-}
+#include "third_party/boringssl/src/include/openssl/aes.h"
 
 namespace media {
 namespace cast {
 
+// Encrypts frames with AES-128 in counter mode, the counter starting at a
+// nonce derived from the frame ID and the IV mask. Since encryption and
+// decryption are the same operation in counter mode, the Encrypt*() and
+// Decrypt*() methods are interchangeable.
 class TransportEncryptionHandler {
  public:
   TransportEncryptionHandler();
@@ -44,13 +46,36 @@ class TransportEncryptionHandler {
                const base::StringPiece& ciphertext,
                std::string* plaintext);
 
+  // Encrypts |data| into the caller's buffer |encrypted_data|, which must be
+  // the same size. The two may be the same buffer.
+  bool Encrypt(FrameId frame_id,
+               base::span<const uint8_t> data,
+               base::span<uint8_t> encrypted_data);
+
+  // Encrypts or decrypts |data| in place, without copying the frame.
+  bool EncryptInPlace(FrameId frame_id, base::span<uint8_t> data);
+  bool DecryptInPlace(FrameId frame_id, base::span<uint8_t> data);
+
+  // Generates the keystream for the first |size| bytes of frame |frame_id|
+  // ahead of time, e.g. while the frame is still being encoded. Encrypting
+  // that frame then only XORs the precomputed prefix into the data. Bytes
+  // beyond it are encrypted as usual.
+  void PrecomputeKeystream(FrameId frame_id, size_t size);
+
   bool is_activated() const { return is_activated_; }
 
  private:
-  std::unique_ptr<crypto::SymmetricKey> key_;
-  std::unique_ptr<crypto::Encryptor> encryptor_;
+  // Encrypts |size| bytes from |in| to |out|, which may be the same buffer.
+  void Crypt(FrameId frame_id, const uint8_t* in, uint8_t* out, size_t size);
+
+  AES_KEY key_;
   std::string iv_mask_;
   bool is_activated_;
+
+  // Keystream for the beginning of frame |keystream_frame_id_|, in whole AES
+  // blocks. It is used by at most one encryption.
+  FrameId keystream_frame_id_;
+  std::vector<uint8_t> keystream_;
 };
 
 }  // namespace cast
@@ -0,0 +1,142 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/cast/common/transport_encryption_handler.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "crypto/encryptor.h"
+#include "crypto/symmetric_key.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+namespace cast {
+
+namespace {
+
+const char kAesKey[] = "0123456789abcdef";
+const char kAesIvMask[] = "fedcba9876543210";
+
+std::string MakeFrameData(size_t size) {
+  std::string data(size, 0);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>(i * 13 + 7);
+  return data;
+}
+
+}  // namespace
+
+class TransportEncryptionHandlerTest : public ::testing::Test {
+ protected:
+  TransportEncryptionHandlerTest() {
+    EXPECT_TRUE(handler_.Initialize(kAesKey, kAesIvMask));
+  }
+
+  // Encrypts |data| as the handler did when it was built on
+  // crypto::Encryptor, which receivers in the field expect.
+  static std::string ReferenceEncrypt(FrameId frame_id,
+                                      const std::string& data) {
+    std::unique_ptr<crypto::SymmetricKey> key =
+        crypto::SymmetricKey::Import(crypto::SymmetricKey::AES, kAesKey);
+    crypto::Encryptor encryptor;
+    EXPECT_TRUE(encryptor.Init(key.get(), crypto::Encryptor::CTR, ""));
+    std::string nonce(16, 0);
+    const uint32_t truncated_id = frame_id.lower_32_bits();
+    nonce[8] = static_cast<char>(truncated_id >> 24);
+    nonce[9] = static_cast<char>(truncated_id >> 16);
+    nonce[10] = static_cast<char>(truncated_id >> 8);
+    nonce[11] = static_cast<char>(truncated_id);
+    for (size_t i = 0; i < nonce.size(); ++i)
+      nonce[i] ^= kAesIvMask[i];
+    EXPECT_TRUE(encryptor.SetCounter(nonce));
+    std::string ciphertext;
+    EXPECT_TRUE(encryptor.Encrypt(data, &ciphertext));
+    return ciphertext;
+  }
+
+  TransportEncryptionHandler handler_;
+};
+
+TEST_F(TransportEncryptionHandlerTest, NotActivatedWithoutKey) {
+  TransportEncryptionHandler handler;
+  EXPECT_TRUE(handler.Initialize("", ""));
+  EXPECT_FALSE(handler.is_activated());
+  std::string encrypted;
+  EXPECT_FALSE(handler.Encrypt(FrameId::first(), "data", &encrypted));
+}
+
+TEST_F(TransportEncryptionHandlerTest, MatchesCryptoEncryptor) {
+  EXPECT_TRUE(handler_.is_activated());
+  for (size_t size : {0u, 1u, 16u, 1000u, 65537u}) {
+    const FrameId frame_id = FrameId::first() + static_cast<int64_t>(size);
+    const std::string data = MakeFrameData(size);
+    std::string encrypted;
+    ASSERT_TRUE(handler_.Encrypt(frame_id, data, &encrypted));
+    EXPECT_EQ(ReferenceEncrypt(frame_id, data), encrypted);
+
+    std::string decrypted;
+    ASSERT_TRUE(handler_.Decrypt(frame_id, encrypted, &decrypted));
+    EXPECT_EQ(data, decrypted);
+  }
+}
+
+TEST_F(TransportEncryptionHandlerTest, EncryptsIntoCallerBufferAndInPlace) {
+  const FrameId frame_id = FrameId::first() + 42;
+  const std::string data = MakeFrameData(5000);
+  const std::string expected = ReferenceEncrypt(frame_id, data);
+
+  std::vector<uint8_t> buffer(data.size());
+  ASSERT_TRUE(handler_.Encrypt(frame_id,
+                               base::as_bytes(base::make_span(data)),
+                               base::make_span(buffer)));
+  EXPECT_EQ(expected, std::string(buffer.begin(), buffer.end()));
+
+  std::string in_place = data;
+  ASSERT_TRUE(handler_.EncryptInPlace(
+      frame_id, base::as_writable_bytes(base::make_span(in_place))));
+  EXPECT_EQ(expected, in_place);
+  ASSERT_TRUE(handler_.DecryptInPlace(
+      frame_id, base::as_writable_bytes(base::make_span(in_place))));
+  EXPECT_EQ(data, in_place);
+}
+
+TEST_F(TransportEncryptionHandlerTest, PrecomputedKeystream) {
+  const FrameId frame_id = FrameId::first() + 7;
+  // Keystreams shorter than, longer than, and not a whole number of blocks
+  // of the frame.
+  for (size_t keystream_size : {0u, 100u, 1001u, 5000u, 8000u}) {
+    SCOPED_TRACE(keystream_size);
+    const std::string data = MakeFrameData(5000);
+    handler_.PrecomputeKeystream(frame_id, keystream_size);
+    std::string encrypted;
+    ASSERT_TRUE(handler_.Encrypt(frame_id, data, &encrypted));
+    EXPECT_EQ(ReferenceEncrypt(frame_id, data), encrypted);
+  }
+}
+
+TEST_F(TransportEncryptionHandlerTest, KeystreamOnlyUsedForItsFrame) {
+  const FrameId frame_id = FrameId::first() + 7;
+  const std::string data = MakeFrameData(3000);
+
+  // A keystream for another frame is ignored.
+  handler_.PrecomputeKeystream(frame_id + 1, data.size());
+  std::string encrypted;
+  ASSERT_TRUE(handler_.Encrypt(frame_id, data, &encrypted));
+  EXPECT_EQ(ReferenceEncrypt(frame_id, data), encrypted);
+
+  // A keystream is used once.
+  handler_.PrecomputeKeystream(frame_id, data.size());
+  ASSERT_TRUE(handler_.Encrypt(frame_id, data, &encrypted));
+  std::string decrypted;
+  ASSERT_TRUE(handler_.Decrypt(frame_id, encrypted, &decrypted));
+  EXPECT_EQ(data, decrypted);
+}
+
+}  // namespace cast
+}  // namespace media
@@ -0,0 +1,533 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/cast/logging/binary_event_log.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/check_op.h"
+#include "base/logging.h"
+
+namespace media {
+namespace cast {
+
+namespace {
+
+const uint8_t kLogHeader[] = {'C', 'A', 'S', 'T', 'L', 'O', 'G', 1};
+
+// The first byte of a record holds the CastLoggingEvent in its low bits, the
+// EventMediaType above, and whether it is a packet event.
+const uint8_t kEventTypeMask = 0x0f;
+const int kMediaTypeShift = 4;
+const uint8_t kMediaTypeMask = 0x30;
+const uint8_t kPacketEventFlag = 0x40;
+static_assert(kNumOfLoggingEvents <= kEventTypeMask + 1,
+              "CastLoggingEvent does not fit in a record");
+static_assert(EVENT_MEDIA_TYPE_LAST <= (kMediaTypeMask >> kMediaTypeShift),
+              "EventMediaType does not fit in a record");
+
+// Bits of the field mask of frame records, for the fields which are not at
+// their default values.
+enum FrameFieldFlags {
+  kFrameFieldResolution = 1 << 0,
+  kFrameFieldSize = 1 << 1,
+  kFrameFieldKeyFrame = 1 << 2,
+  kFrameFieldTargetBitrate = 1 << 3,
+  kFrameFieldEncoderCpuUtilization = 1 << 4,
+  kFrameFieldIdealizedBitrateUtilization = 1 << 5,
+  kFrameFieldDelayDelta = 1 << 6,
+};
+
+// Large enough for any record: the type byte, eight varints of up to 10
+// bytes, and two doubles.
+const size_t kMaxRecordSize = 1 + 8 * 10 + 2 * 8;
+
+// Varints are encoded as in protocol buffers: 7 bits per byte, least
+// significant first, with the high bit set on all bytes but the last.
+size_t WriteVarint(uint64_t value, uint8_t* out) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    out[size++] = static_cast<uint8_t>(value) | 0x80;
+    value >>= 7;
+  }
+  out[size++] = static_cast<uint8_t>(value);
+  return size;
+}
+
+// Maps signed values to unsigned ones, so that small magnitudes make short
+// varints.
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+size_t WriteDouble(double value, uint8_t* out) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (size_t i = 0; i < sizeof(bits); ++i)
+    out[i] = static_cast<uint8_t>(bits >> (8 * i));
+  return sizeof(bits);
+}
+
+int64_t ToMicroseconds(base::TimeTicks timestamp) {
+  return (timestamp - base::TimeTicks()).InMicroseconds();
+}
+
+// Reads the fields of a log, failing on any read past its end.
+class LogReader {
+ public:
+  explicit LogReader(base::span<const uint8_t> data) : data_(data) {}
+
+  bool empty() const { return offset_ == data_.size(); }
+
+  bool ReadByte(uint8_t* value) {
+    if (empty())
+      return false;
+    *value = data_[offset_++];
+    return true;
+  }
+
+  bool ReadVarint(uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!ReadByte(&byte))
+        return false;
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadSignedVarint(int64_t* value) {
+    uint64_t encoded;
+    if (!ReadVarint(&encoded))
+      return false;
+    *value = ZigZagDecode(encoded);
+    return true;
+  }
+
+  bool ReadDouble(double* value) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+      uint8_t byte;
+      if (!ReadByte(&byte))
+        return false;
+      bits |= static_cast<uint64_t>(byte) << (8 * i);
+    }
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+  }
+
+  base::span<const uint8_t> ReadRemaining() {
+    base::span<const uint8_t> remaining = data_.subspan(offset_);
+    offset_ = data_.size();
+    return remaining;
+  }
+
+  bool ReadSpan(size_t size, base::span<const uint8_t>* span) {
+    if (data_.size() - offset_ < size)
+      return false;
+    *span = data_.subspan(offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+ private:
+  const base::span<const uint8_t> data_;
+  size_t offset_ = 0;
+};
+
+// The decoding counterpart of BinaryEventLogWriter::EncoderState.
+struct DecoderState {
+  int64_t timestamp_us = 0;
+  uint32_t rtp_timestamps[EVENT_MEDIA_TYPE_LAST + 1] = {0, 0, 0};
+  FrameId frame_ids[EVENT_MEDIA_TYPE_LAST + 1] = {
+      FrameId::first(), FrameId::first(), FrameId::first()};
+};
+
+// Only the lower 32 bits of RTP timestamps are logged, as on the wire. They
+// are expanded against the previous timestamps of the log, which unlike the
+// DecoderState carry over from one chunk to the next.
+using ExpandedRtpTimestamps = RtpTimeTicks[EVENT_MEDIA_TYPE_LAST + 1];
+
+// Reads the fields which frame and packet records share.
+bool ReadCommonFields(LogReader* reader,
+                      EventMediaType media_type,
+                      DecoderState* state,
+                      ExpandedRtpTimestamps& last_rtp_timestamps,
+                      base::TimeTicks* timestamp,
+                      RtpTimeTicks* rtp_timestamp,
+                      FrameId* frame_id) {
+  int64_t timestamp_delta;
+  int64_t rtp_timestamp_delta;
+  uint64_t frame_id_delta;
+  if (!reader->ReadSignedVarint(&timestamp_delta) ||
+      !reader->ReadSignedVarint(&rtp_timestamp_delta) ||
+      !reader->ReadVarint(&frame_id_delta)) {
+    return false;
+  }
+  state->timestamp_us += timestamp_delta;
+  *timestamp = base::TimeTicks() + base::Microseconds(state->timestamp_us);
+  state->rtp_timestamps[media_type] +=
+      static_cast<uint32_t>(rtp_timestamp_delta);
+  last_rtp_timestamps[media_type] =
+      last_rtp_timestamps[media_type].Expand(state->rtp_timestamps[media_type]);
+  *rtp_timestamp = last_rtp_timestamps[media_type];
+  if (frame_id_delta == 0) {
+    *frame_id = FrameId();
+  } else {
+    state->frame_ids[media_type] += ZigZagDecode(frame_id_delta - 1);
+    *frame_id = state->frame_ids[media_type];
+  }
+  return true;
+}
+
+bool ReadFrameFields(LogReader* reader, FrameEvent* frame_event) {
+  uint64_t fields;
+  if (!reader->ReadVarint(&fields))
+    return false;
+  int64_t value;
+  uint64_t unsigned_value;
+  if (fields & kFrameFieldResolution) {
+    if (!reader->ReadSignedVarint(&value))
+      return false;
+    frame_event->width = static_cast<int>(value);
+    if (!reader->ReadSignedVarint(&value))
+      return false;
+    frame_event->height = static_cast<int>(value);
+  }
+  if (fields & kFrameFieldSize) {
+    if (!reader->ReadVarint(&unsigned_value))
+      return false;
+    frame_event->size = static_cast<uint32_t>(unsigned_value);
+  }
+  frame_event->key_frame = !!(fields & kFrameFieldKeyFrame);
+  if (fields & kFrameFieldTargetBitrate) {
+    if (!reader->ReadSignedVarint(&value))
+      return false;
+    frame_event->target_bitrate = static_cast<int>(value);
+  }
+  if ((fields & kFrameFieldEncoderCpuUtilization) &&
+      !reader->ReadDouble(&frame_event->encoder_cpu_utilization)) {
+    return false;
+  }
+  if ((fields & kFrameFieldIdealizedBitrateUtilization) &&
+      !reader->ReadDouble(&frame_event->idealized_bitrate_utilization)) {
+    return false;
+  }
+  if (fields & kFrameFieldDelayDelta) {
+    if (!reader->ReadSignedVarint(&value))
+      return false;
+    frame_event->delay_delta = base::Microseconds(value);
+  }
+  return true;
+}
+
+bool ReadPacketFields(LogReader* reader, PacketEvent* packet_event) {
+  uint64_t packet_id;
+  uint64_t max_packet_id;
+  uint64_t size;
+  if (!reader->ReadVarint(&packet_id) || !reader->ReadVarint(&max_packet_id) ||
+      !reader->ReadVarint(&size)) {
+    return false;
+  }
+  packet_event->packet_id = static_cast<uint16_t>(packet_id);
+  packet_event->max_packet_id = static_cast<uint16_t>(max_packet_id);
+  packet_event->size = static_cast<uint32_t>(size);
+  return true;
+}
+
+// Decodes the records of one chunk.
+bool ReplayChunk(base::span<const uint8_t> chunk,
+                 ExpandedRtpTimestamps& last_rtp_timestamps,
+                 RawEventSubscriber* subscriber) {
+  LogReader reader(chunk);
+  DecoderState state;
+  while (!reader.empty()) {
+    uint8_t type_byte;
+    reader.ReadByte(&type_byte);
+    const int event_type = type_byte & kEventTypeMask;
+    const int media_type = (type_byte & kMediaTypeMask) >> kMediaTypeShift;
+    if (event_type >= kNumOfLoggingEvents ||
+        media_type > EVENT_MEDIA_TYPE_LAST) {
+      return false;
+    }
+
+    if (type_byte & kPacketEventFlag) {
+      PacketEvent packet_event;
+      packet_event.type = static_cast<CastLoggingEvent>(event_type);
+      packet_event.media_type = static_cast<EventMediaType>(media_type);
+      if (!ReadCommonFields(&reader, packet_event.media_type, &state,
+                            last_rtp_timestamps, &packet_event.timestamp,
+                            &packet_event.rtp_timestamp,
+                            &packet_event.frame_id) ||
+          !ReadPacketFields(&reader, &packet_event)) {
+        return false;
+      }
+      subscriber->OnReceivePacketEvent(packet_event);
+    } else {
+      FrameEvent frame_event;
+      frame_event.type = static_cast<CastLoggingEvent>(event_type);
+      frame_event.media_type = static_cast<EventMediaType>(media_type);
+      if (!ReadCommonFields(&reader, frame_event.media_type, &state,
+                            last_rtp_timestamps, &frame_event.timestamp,
+                            &frame_event.rtp_timestamp,
+                            &frame_event.frame_id) ||
+          !ReadFrameFields(&reader, &frame_event)) {
+        return false;
+      }
+      subscriber->OnReceiveFrameEvent(frame_event);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+BinaryEventLogWriter::EncoderState::EncoderState()
+    : timestamp_us(0),
+      frame_ids{FrameId::first(), FrameId::first(), FrameId::first()} {}
+
+BinaryEventLogWriter::BinaryEventLogWriter(size_t buffer_size,
+                                           OutputCallback output_callback)
+    : output_callback_(std::move(output_callback)),
+      header_written_(false),
+      chunk_sizes_(std::max<size_t>(2, (buffer_size + kChunkSize - 1) /
+                                           kChunkSize),
+                   0),
+      current_chunk_(0),
+      num_chunks_dropped_(0) {
+  static_assert(kMaxRecordSize <= kChunkSize, "Records must fit in a chunk");
+  buffer_.resize(chunk_sizes_.size() * kChunkSize);
+}
+
+BinaryEventLogWriter::~BinaryEventLogWriter() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+}
+
+void BinaryEventLogWriter::OnReceiveFrameEvent(const FrameEvent& frame_event) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  uint8_t record[kMaxRecordSize];
+  size_t size = EncodeFrameEvent(frame_event, record);
+  if (!HasRoomFor(size)) {
+    // The record is encoded again, against the new chunk's initial state.
+    StartNextChunk();
+    size = EncodeFrameEvent(frame_event, record);
+  }
+  AppendRecord(record, size);
+}
+
+void BinaryEventLogWriter::OnReceivePacketEvent(
+    const PacketEvent& packet_event) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  uint8_t record[kMaxRecordSize];
+  size_t size = EncodePacketEvent(packet_event, record);
+  if (!HasRoomFor(size)) {
+    StartNextChunk();
+    size = EncodePacketEvent(packet_event, record);
+  }
+  AppendRecord(record, size);
+}
+
+void BinaryEventLogWriter::Flush() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  if (chunk_sizes_[current_chunk_] > 0)
+    StartNextChunk();
+}
+
+std::vector<uint8_t> BinaryEventLogWriter::GetLog() const {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  std::vector<uint8_t> log(std::begin(kLogHeader), std::end(kLogHeader));
+  // From the oldest chunk to the current one.
+  for (size_t i = 1; i <= chunk_sizes_.size(); ++i) {
+    const size_t chunk = (current_chunk_ + i) % chunk_sizes_.size();
+    if (chunk_sizes_[chunk] == 0)
+      continue;
+    uint8_t chunk_size[10];
+    log.insert(log.end(), chunk_size,
+               chunk_size + WriteVarint(chunk_sizes_[chunk], chunk_size));
+    const auto chunk_begin = buffer_.begin() + chunk * kChunkSize;
+    log.insert(log.end(), chunk_begin, chunk_begin + chunk_sizes_[chunk]);
+  }
+  return log;
+}
+
+size_t BinaryEventLogWriter::EncodeFrameEvent(const FrameEvent& frame_event,
+                                              uint8_t* record) {
+  const int media_type = frame_event.media_type;
+  size_t size = 0;
+  record[size++] = static_cast<uint8_t>(frame_event.type) |
+                   static_cast<uint8_t>(media_type << kMediaTypeShift);
+
+  const int64_t timestamp_us = ToMicroseconds(frame_event.timestamp);
+  size += WriteVarint(ZigZagEncode(timestamp_us - state_.timestamp_us),
+                      record + size);
+  state_.timestamp_us = timestamp_us;
+  // RTP timestamps are 32 bits on the wire, so a 32-bit difference suffices.
+  size += WriteVarint(
+      ZigZagEncode(static_cast<int32_t>(
+          frame_event.rtp_timestamp.lower_32_bits() -
+          state_.rtp_timestamps[media_type].lower_32_bits())),
+      record + size);
+  state_.rtp_timestamps[media_type] = frame_event.rtp_timestamp;
+  if (frame_event.frame_id.is_null()) {
+    record[size++] = 0;
+  } else {
+    size += WriteVarint(
+        ZigZagEncode(frame_event.frame_id - state_.frame_ids[media_type]) + 1,
+        record + size);
+    state_.frame_ids[media_type] = frame_event.frame_id;
+  }
+
+  uint64_t fields = 0;
+  if (frame_event.width != 0 || frame_event.height != 0)
+    fields |= kFrameFieldResolution;
+  if (frame_event.size != 0)
+    fields |= kFrameFieldSize;
+  if (frame_event.key_frame)
+    fields |= kFrameFieldKeyFrame;
+  if (frame_event.target_bitrate != 0)
+    fields |= kFrameFieldTargetBitrate;
+  if (frame_event.encoder_cpu_utilization != -1.0)
+    fields |= kFrameFieldEncoderCpuUtilization;
+  if (frame_event.idealized_bitrate_utilization != -1.0)
+    fields |= kFrameFieldIdealizedBitrateUtilization;
+  if (!frame_event.delay_delta.is_zero())
+    fields |= kFrameFieldDelayDelta;
+  size += WriteVarint(fields, record + size);
+
+  if (fields & kFrameFieldResolution) {
+    size += WriteVarint(ZigZagEncode(frame_event.width), record + size);
+    size += WriteVarint(ZigZagEncode(frame_event.height), record + size);
+  }
+  if (fields & kFrameFieldSize)
+    size += WriteVarint(frame_event.size, record + size);
+  if (fields & kFrameFieldTargetBitrate) {
+    size +=
+        WriteVarint(ZigZagEncode(frame_event.target_bitrate), record + size);
+  }
+  if (fields & kFrameFieldEncoderCpuUtilization)
+    size += WriteDouble(frame_event.encoder_cpu_utilization, record + size);
+  if (fields & kFrameFieldIdealizedBitrateUtilization) {
+    size +=
+        WriteDouble(frame_event.idealized_bitrate_utilization, record + size);
+  }
+  if (fields & kFrameFieldDelayDelta) {
+    size += WriteVarint(ZigZagEncode(frame_event.delay_delta.InMicroseconds()),
+                        record + size);
+  }
+  DCHECK_LE(size, kMaxRecordSize);
+  return size;
+}
+
+size_t BinaryEventLogWriter::EncodePacketEvent(const PacketEvent& packet_event,
+                                               uint8_t* record) {
+  const int media_type = packet_event.media_type;
+  size_t size = 0;
+  record[size++] = static_cast<uint8_t>(packet_event.type) |
+                   static_cast<uint8_t>(media_type << kMediaTypeShift) |
+                   kPacketEventFlag;
+
+  const int64_t timestamp_us = ToMicroseconds(packet_event.timestamp);
+  size += WriteVarint(ZigZagEncode(timestamp_us - state_.timestamp_us),
+                      record + size);
+  state_.timestamp_us = timestamp_us;
+  size += WriteVarint(
+      ZigZagEncode(static_cast<int32_t>(
+          packet_event.rtp_timestamp.lower_32_bits() -
+          state_.rtp_timestamps[media_type].lower_32_bits())),
+      record + size);
+  state_.rtp_timestamps[media_type] = packet_event.rtp_timestamp;
+  if (packet_event.frame_id.is_null()) {
+    record[size++] = 0;
+  } else {
+    size += WriteVarint(
+        ZigZagEncode(packet_event.frame_id - state_.frame_ids[media_type]) + 1,
+        record + size);
+    state_.frame_ids[media_type] = packet_event.frame_id;
+  }
+
+  size += WriteVarint(packet_event.packet_id, record + size);
+  size += WriteVarint(packet_event.max_packet_id, record + size);
+  size += WriteVarint(packet_event.size, record + size);
+  DCHECK_LE(size, kMaxRecordSize);
+  return size;
+}
+
+bool BinaryEventLogWriter::HasRoomFor(size_t size) const {
+  return chunk_sizes_[current_chunk_] + size <= kChunkSize;
+}
+
+void BinaryEventLogWriter::AppendRecord(const uint8_t* record, size_t size) {
+  DCHECK(HasRoomFor(size));
+  std::copy(record, record + size,
+            buffer_.begin() + current_chunk_ * kChunkSize +
+                chunk_sizes_[current_chunk_]);
+  chunk_sizes_[current_chunk_] += size;
+}
+
+void BinaryEventLogWriter::StartNextChunk() {
+  const size_t chunk_size = chunk_sizes_[current_chunk_];
+  if (chunk_size > 0 && output_callback_) {
+    uint8_t varint[10];
+    RunOutputCallback(base::make_span(varint, WriteVarint(chunk_size, varint)));
+    RunOutputCallback(
+        base::make_span(buffer_.data() + current_chunk_ * kChunkSize,
+                        chunk_size));
+  }
+
+  current_chunk_ = (current_chunk_ + 1) % chunk_sizes_.size();
+  if (chunk_sizes_[current_chunk_] > 0) {
+    DVLOG(2) << "Event log full, dropping a chunk of "
+             << chunk_sizes_[current_chunk_] << " bytes.";
+    ++num_chunks_dropped_;
+    chunk_sizes_[current_chunk_] = 0;
+  }
+  state_ = EncoderState();
+}
+
+void BinaryEventLogWriter::RunOutputCallback(base::span<const uint8_t> data) {
+  if (!header_written_) {
+    header_written_ = true;
+    output_callback_.Run(kLogHeader);
+  }
+  output_callback_.Run(data);
+}
+
+bool ReplayBinaryEventLog(base::span<const uint8_t> log,
+                          RawEventSubscriber* subscriber) {
+  LogReader reader(log);
+  base::span<const uint8_t> header;
+  if (!reader.ReadSpan(sizeof(kLogHeader), &header) ||
+      memcmp(header.data(), kLogHeader, sizeof(kLogHeader)) != 0) {
+    return false;
+  }
+  ExpandedRtpTimestamps last_rtp_timestamps;
+  while (!reader.empty()) {
+    uint64_t chunk_size;
+    if (!reader.ReadVarint(&chunk_size) || chunk_size > kChunkSize)
+      return false;
+    base::span<const uint8_t> chunk;
+    if (!reader.ReadSpan(chunk_size, &chunk)) {
+      // Pass on what is left of a truncated chunk, e.g. of a log which was
+      // still being written to.
+      ReplayChunk(reader.ReadRemaining(), last_rtp_timestamps, subscriber);
+      return false;
+    }
+    if (!ReplayChunk(chunk, last_rtp_timestamps, subscriber))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace cast
+}  // namespace media
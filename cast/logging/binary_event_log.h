@@ -0,0 +1,125 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_CAST_LOGGING_BINARY_EVENT_LOG_H_
+#define MEDIA_CAST_LOGGING_BINARY_EVENT_LOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/span.h"
+#include "base/threading/thread_checker.h"
+#include "media/cast/logging/logging_defines.h"
+#include "media/cast/logging/raw_event_subscriber.h"
+
+namespace media {
+namespace cast {
+
+// A RawEventSubscriber implementation that encodes every event it receives
+// into a compact binary record, and keeps the records in a ring buffer of
+// fixed size. Unlike EncodingEventSubscriber, memory use does not grow with
+// the length of the session, and there is no serialization step at the end:
+// the log can be streamed out as it is written.
+//
+// The log is a header followed by chunks. Each chunk is a varint byte count,
+// followed by records. A record is a byte holding the event type and media
+// type, followed by varint fields, most of them deltas from the previous
+// record in the chunk. Every chunk can therefore be decoded on its own, and
+// when the ring buffer is full, the oldest chunk is dropped as a whole.
+//
+// Use ReplayBinaryEventLog() to decode a log.
+class BinaryEventLogWriter final : public RawEventSubscriber {
+ public:
+  // Receives parts of the log as soon as they are complete: the header first,
+  // then each chunk. Concatenated, they make up the whole log.
+  using OutputCallback =
+      base::RepeatingCallback<void(base::span<const uint8_t> data)>;
+
+  // Size of each chunk of the ring buffer, and thus how often the log is
+  // passed to the OutputCallback.
+  static constexpr size_t kChunkSize = 4096;
+
+  // |buffer_size| is the memory set aside for the log, rounded up to a whole
+  // number of chunks, and at least two of them. If |output_callback| is set,
+  // it is run on the thread which receives the events.
+  BinaryEventLogWriter(size_t buffer_size, OutputCallback output_callback);
+
+  BinaryEventLogWriter(const BinaryEventLogWriter&) = delete;
+  BinaryEventLogWriter& operator=(const BinaryEventLogWriter&) = delete;
+
+  ~BinaryEventLogWriter() final;
+
+  // RawEventSubscriber implementations.
+  void OnReceiveFrameEvent(const FrameEvent& frame_event) final;
+  void OnReceivePacketEvent(const PacketEvent& packet_event) final;
+
+  // Ends the current chunk, and passes it to the OutputCallback, even if it
+  // is not full.
+  void Flush();
+
+  // Returns the events still held in the ring buffer, as a log.
+  std::vector<uint8_t> GetLog() const;
+
+  // The number of chunks dropped from the ring buffer to make room for newer
+  // events.
+  size_t num_chunks_dropped() const { return num_chunks_dropped_; }
+
+ private:
+  // The values which records are delta-encoded against. They are reset at the
+  // start of each chunk.
+  struct EncoderState {
+    EncoderState();
+
+    int64_t timestamp_us;
+    // By EventMediaType.
+    RtpTimeTicks rtp_timestamps[EVENT_MEDIA_TYPE_LAST + 1];
+    FrameId frame_ids[EVENT_MEDIA_TYPE_LAST + 1];
+  };
+
+  // Encodes the event into |record|, of at least kMaxRecordSize bytes, and
+  // returns its size.
+  size_t EncodeFrameEvent(const FrameEvent& frame_event, uint8_t* record);
+  size_t EncodePacketEvent(const PacketEvent& packet_event, uint8_t* record);
+
+  // Returns true if a record of |size| bytes fits in the current chunk.
+  bool HasRoomFor(size_t size) const;
+
+  // Appends a record to the current chunk.
+  void AppendRecord(const uint8_t* record, size_t size);
+
+  // Ends the current chunk and moves on to the next one, dropping its events
+  // if it was in use.
+  void StartNextChunk();
+
+  void RunOutputCallback(base::span<const uint8_t> data);
+
+  const OutputCallback output_callback_;
+  bool header_written_;
+
+  // |chunk_sizes_.size()| chunks of kChunkSize bytes each. The chunks after
+  // |current_chunk_| are older, and unused ones have a size of zero.
+  std::vector<uint8_t> buffer_;
+  std::vector<size_t> chunk_sizes_;
+  size_t current_chunk_;
+  size_t num_chunks_dropped_;
+
+  EncoderState state_;
+
+  // All functions must be called on the main thread.
+  base::ThreadChecker thread_checker_;
+};
+
+// Decodes |log| and passes each of its events to |subscriber|, in the order
+// they were logged. Returns false if the log is malformed or truncated, in
+// which case the events up to that point will have been passed on.
+bool ReplayBinaryEventLog(base::span<const uint8_t> log,
+                          RawEventSubscriber* subscriber);
+
+}  // namespace cast
+}  // namespace media
+
+#endif  // MEDIA_CAST_LOGGING_BINARY_EVENT_LOG_H_
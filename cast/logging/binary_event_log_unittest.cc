@@ -0,0 +1,297 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/cast/logging/binary_event_log.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/bind.h"
+#include "media/cast/logging/encoding_event_subscriber.h"
+#include "media/cast/logging/proto/raw_events.pb.h"
+#include "media/cast/logging/simple_event_subscriber.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+namespace cast {
+
+namespace {
+
+void ExpectFrameEventsEqual(const FrameEvent& expected,
+                            const FrameEvent& actual) {
+  EXPECT_EQ(expected.rtp_timestamp, actual.rtp_timestamp);
+  EXPECT_EQ(expected.frame_id, actual.frame_id);
+  EXPECT_EQ(expected.width, actual.width);
+  EXPECT_EQ(expected.height, actual.height);
+  EXPECT_EQ(expected.size, actual.size);
+  EXPECT_EQ(expected.timestamp, actual.timestamp);
+  EXPECT_EQ(expected.type, actual.type);
+  EXPECT_EQ(expected.media_type, actual.media_type);
+  EXPECT_EQ(expected.delay_delta, actual.delay_delta);
+  EXPECT_EQ(expected.key_frame, actual.key_frame);
+  EXPECT_EQ(expected.target_bitrate, actual.target_bitrate);
+  EXPECT_EQ(expected.encoder_cpu_utilization, actual.encoder_cpu_utilization);
+  EXPECT_EQ(expected.idealized_bitrate_utilization,
+            actual.idealized_bitrate_utilization);
+}
+
+void ExpectPacketEventsEqual(const PacketEvent& expected,
+                             const PacketEvent& actual) {
+  EXPECT_EQ(expected.rtp_timestamp, actual.rtp_timestamp);
+  EXPECT_EQ(expected.frame_id, actual.frame_id);
+  EXPECT_EQ(expected.max_packet_id, actual.max_packet_id);
+  EXPECT_EQ(expected.packet_id, actual.packet_id);
+  EXPECT_EQ(expected.size, actual.size);
+  EXPECT_EQ(expected.timestamp, actual.timestamp);
+  EXPECT_EQ(expected.type, actual.type);
+  EXPECT_EQ(expected.media_type, actual.media_type);
+}
+
+}  // namespace
+
+class BinaryEventLogTest : public ::testing::Test {
+ protected:
+  BinaryEventLogTest() = default;
+
+  // Logs the events of |num_frames| video frames of three packets each,
+  // interleaved with audio frames, as a sender would, into |subscriber|.
+  void LogSession(int num_frames, RawEventSubscriber* subscriber) {
+    base::TimeTicks now = base::TimeTicks() + base::Seconds(1234);
+    // Start just short of the RTP timestamp wrapping around.
+    RtpTimeTicks video_rtp_timestamp =
+        RtpTimeTicks().Expand(UINT32_C(0xffffff00));
+    RtpTimeTicks audio_rtp_timestamp = RtpTimeTicks().Expand(UINT32_C(1000));
+    for (int i = 0; i < num_frames; ++i) {
+      const FrameId frame_id = FrameId::first() + i;
+      FrameEvent capture_event;
+      capture_event.timestamp = now;
+      capture_event.type = FRAME_CAPTURE_END;
+      capture_event.media_type = VIDEO_EVENT;
+      capture_event.rtp_timestamp = video_rtp_timestamp;
+      capture_event.width = 1280;
+      capture_event.height = 720;
+      LogFrameEvent(capture_event, subscriber);
+
+      FrameEvent encode_event;
+      encode_event.timestamp = now + base::Milliseconds(5);
+      encode_event.type = FRAME_ENCODED;
+      encode_event.media_type = VIDEO_EVENT;
+      encode_event.rtp_timestamp = video_rtp_timestamp;
+      encode_event.frame_id = frame_id;
+      encode_event.size = 3000 + i;
+      encode_event.key_frame = i % 30 == 0;
+      encode_event.target_bitrate = 2000000;
+      encode_event.encoder_cpu_utilization = 0.25 + i * 0.001;
+      encode_event.idealized_bitrate_utilization = 0.5;
+      LogFrameEvent(encode_event, subscriber);
+
+      for (uint16_t packet_id = 0; packet_id < 3; ++packet_id) {
+        PacketEvent packet_event;
+        packet_event.timestamp = now + base::Milliseconds(6 + packet_id);
+        packet_event.type = PACKET_SENT_TO_NETWORK;
+        packet_event.media_type = VIDEO_EVENT;
+        packet_event.rtp_timestamp = video_rtp_timestamp;
+        packet_event.frame_id = frame_id;
+        packet_event.packet_id = packet_id;
+        packet_event.max_packet_id = 2;
+        packet_event.size = packet_id < 2 ? 1200 : 600 + i;
+        LogPacketEvent(packet_event, subscriber);
+      }
+
+      FrameEvent audio_event;
+      audio_event.timestamp = now + base::Milliseconds(10);
+      audio_event.type = FRAME_ENCODED;
+      audio_event.media_type = AUDIO_EVENT;
+      audio_event.rtp_timestamp = audio_rtp_timestamp;
+      audio_event.frame_id = frame_id;
+      audio_event.size = 160;
+      LogFrameEvent(audio_event, subscriber);
+
+      FrameEvent ack_event;
+      ack_event.timestamp = now + base::Milliseconds(40);
+      ack_event.type = FRAME_ACK_RECEIVED;
+      ack_event.media_type = VIDEO_EVENT;
+      ack_event.rtp_timestamp = video_rtp_timestamp;
+      ack_event.frame_id = frame_id;
+      // Receiver events may be logged out of order.
+      if (i % 7 == 3)
+        ack_event.delay_delta = base::Milliseconds(-12);
+      LogFrameEvent(ack_event, subscriber);
+
+      now += base::Milliseconds(33);
+      video_rtp_timestamp += RtpTimeDelta::FromTicks(3000);
+      audio_rtp_timestamp += RtpTimeDelta::FromTicks(480);
+    }
+  }
+
+  void LogFrameEvent(const FrameEvent& frame_event,
+                     RawEventSubscriber* subscriber) {
+    frame_events_.push_back(frame_event);
+    subscriber->OnReceiveFrameEvent(frame_event);
+  }
+
+  void LogPacketEvent(const PacketEvent& packet_event,
+                      RawEventSubscriber* subscriber) {
+    packet_events_.push_back(packet_event);
+    subscriber->OnReceivePacketEvent(packet_event);
+  }
+
+  void AppendToOutput(base::span<const uint8_t> data) {
+    output_.insert(output_.end(), data.begin(), data.end());
+  }
+
+  std::vector<FrameEvent> frame_events_;
+  std::vector<PacketEvent> packet_events_;
+  std::vector<uint8_t> output_;
+};
+
+TEST_F(BinaryEventLogTest, RoundTrip) {
+  BinaryEventLogWriter writer(1 << 20,
+                              BinaryEventLogWriter::OutputCallback());
+  LogSession(100, &writer);
+  EXPECT_EQ(0u, writer.num_chunks_dropped());
+
+  SimpleEventSubscriber replayed;
+  EXPECT_TRUE(ReplayBinaryEventLog(writer.GetLog(), &replayed));
+  std::vector<FrameEvent> frame_events;
+  std::vector<PacketEvent> packet_events;
+  replayed.GetFrameEventsAndReset(&frame_events);
+  replayed.GetPacketEventsAndReset(&packet_events);
+
+  ASSERT_EQ(frame_events_.size(), frame_events.size());
+  for (size_t i = 0; i < frame_events.size(); ++i)
+    ExpectFrameEventsEqual(frame_events_[i], frame_events[i]);
+  ASSERT_EQ(packet_events_.size(), packet_events.size());
+  for (size_t i = 0; i < packet_events.size(); ++i)
+    ExpectPacketEventsEqual(packet_events_[i], packet_events[i]);
+}
+
+TEST_F(BinaryEventLogTest, RecordsAreCompact) {
+  BinaryEventLogWriter writer(1 << 20,
+                              BinaryEventLogWriter::OutputCallback());
+  LogSession(100, &writer);
+  const size_t num_events = frame_events_.size() + packet_events_.size();
+  EXPECT_LT(writer.GetLog().size(), num_events * 16);
+}
+
+TEST_F(BinaryEventLogTest, KeepsTheNewestEventsInBoundedMemory) {
+  BinaryEventLogWriter writer(2 * BinaryEventLogWriter::kChunkSize,
+                              BinaryEventLogWriter::OutputCallback());
+  LogSession(1000, &writer);
+  EXPECT_GT(writer.num_chunks_dropped(), 0u);
+
+  const std::vector<uint8_t> log = writer.GetLog();
+  EXPECT_LE(log.size(), 2 * BinaryEventLogWriter::kChunkSize + 16);
+
+  // The log holds the last events, in full.
+  SimpleEventSubscriber replayed;
+  EXPECT_TRUE(ReplayBinaryEventLog(log, &replayed));
+  std::vector<FrameEvent> frame_events;
+  std::vector<PacketEvent> packet_events;
+  replayed.GetFrameEventsAndReset(&frame_events);
+  replayed.GetPacketEventsAndReset(&packet_events);
+  ASSERT_FALSE(frame_events.empty());
+  ASSERT_LT(frame_events.size(), frame_events_.size());
+  const size_t first_frame_event = frame_events_.size() - frame_events.size();
+  for (size_t i = 0; i < frame_events.size(); ++i)
+    ExpectFrameEventsEqual(frame_events_[first_frame_event + i],
+                           frame_events[i]);
+  ASSERT_FALSE(packet_events.empty());
+  const size_t first_packet_event =
+      packet_events_.size() - packet_events.size();
+  for (size_t i = 0; i < packet_events.size(); ++i)
+    ExpectPacketEventsEqual(packet_events_[first_packet_event + i],
+                            packet_events[i]);
+}
+
+TEST_F(BinaryEventLogTest, StreamsTheWholeLog) {
+  BinaryEventLogWriter writer(
+      2 * BinaryEventLogWriter::kChunkSize,
+      base::BindRepeating(&BinaryEventLogTest::AppendToOutput,
+                          base::Unretained(this)));
+  LogSession(1000, &writer);
+  writer.Flush();
+  EXPECT_GT(writer.num_chunks_dropped(), 0u);
+
+  // Even though the ring buffer dropped events, all of them were streamed.
+  SimpleEventSubscriber replayed;
+  EXPECT_TRUE(ReplayBinaryEventLog(output_, &replayed));
+  std::vector<FrameEvent> frame_events;
+  std::vector<PacketEvent> packet_events;
+  replayed.GetFrameEventsAndReset(&frame_events);
+  replayed.GetPacketEventsAndReset(&packet_events);
+  EXPECT_EQ(frame_events_.size(), frame_events.size());
+  EXPECT_EQ(packet_events_.size(), packet_events.size());
+}
+
+TEST_F(BinaryEventLogTest, StreamedLogMatchesBufferedLog) {
+  BinaryEventLogWriter writer(
+      1 << 20, base::BindRepeating(&BinaryEventLogTest::AppendToOutput,
+                                   base::Unretained(this)));
+  LogSession(100, &writer);
+  writer.Flush();
+  EXPECT_EQ(0u, writer.num_chunks_dropped());
+  EXPECT_EQ(writer.GetLog(), output_);
+}
+
+TEST_F(BinaryEventLogTest, RejectsMalformedLogs) {
+  BinaryEventLogWriter writer(1 << 20,
+                              BinaryEventLogWriter::OutputCallback());
+  LogSession(10, &writer);
+  std::vector<uint8_t> log = writer.GetLog();
+
+  SimpleEventSubscriber replayed;
+  std::vector<FrameEvent> frame_events;
+  EXPECT_FALSE(ReplayBinaryEventLog(
+      base::make_span(log.data(), log.size() - 1), &replayed));
+  replayed.GetFrameEventsAndReset(&frame_events);
+  EXPECT_FALSE(frame_events.empty());
+
+  log[0] = 'X';
+  EXPECT_FALSE(ReplayBinaryEventLog(log, &replayed));
+  replayed.GetFrameEventsAndReset(&frame_events);
+  EXPECT_TRUE(frame_events.empty());
+}
+
+TEST_F(BinaryEventLogTest, ReplayedEventsEncodeLikeTheOriginals) {
+  BinaryEventLogWriter writer(1 << 20,
+                              BinaryEventLogWriter::OutputCallback());
+  EncodingEventSubscriber expected(VIDEO_EVENT, 1000);
+  LogSession(50, &writer);
+  for (const FrameEvent& frame_event : frame_events_)
+    expected.OnReceiveFrameEvent(frame_event);
+  for (const PacketEvent& packet_event : packet_events_)
+    expected.OnReceivePacketEvent(packet_event);
+
+  EncodingEventSubscriber actual(VIDEO_EVENT, 1000);
+  EXPECT_TRUE(ReplayBinaryEventLog(writer.GetLog(), &actual));
+
+  proto::LogMetadata expected_metadata;
+  FrameEventList expected_frame_events;
+  PacketEventList expected_packet_events;
+  expected.GetEventsAndReset(&expected_metadata, &expected_frame_events,
+                             &expected_packet_events);
+  proto::LogMetadata metadata;
+  FrameEventList frame_events;
+  PacketEventList packet_events;
+  actual.GetEventsAndReset(&metadata, &frame_events, &packet_events);
+
+  EXPECT_EQ(expected_metadata.SerializeAsString(),
+            metadata.SerializeAsString());
+  ASSERT_EQ(expected_frame_events.size(), frame_events.size());
+  for (size_t i = 0; i < frame_events.size(); ++i) {
+    EXPECT_EQ(expected_frame_events[i]->SerializeAsString(),
+              frame_events[i]->SerializeAsString());
+  }
+  ASSERT_EQ(expected_packet_events.size(), packet_events.size());
+  for (size_t i = 0; i < packet_events.size(); ++i) {
+    EXPECT_EQ(expected_packet_events[i]->SerializeAsString(),
+              packet_events[i]->SerializeAsString());
+  }
+}
+
+}  // namespace cast
+}  // namespace media
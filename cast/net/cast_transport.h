@@ -63,6 +63,10 @@ class RtcpObserver {
 
   // Called on receiving RTP receiver logs.
   virtual void OnReceivedReceiverLog(const RtcpReceiverLogMessage& log) {}
+
+  // Called on receiving a receiver report block, with the fraction of RTP
+  // packets lost since the previous one.
+  virtual void OnReceivedPacketLoss(double fraction_lost) {}
 };
 
 // The application should only trigger this class from the transport thread.
@@ -104,8 +108,11 @@ class CastTransport {
                                 std::unique_ptr<RtcpObserver> rtcp_observer) {}
 
   // Encrypt, packetize and transmit |frame|. |ssrc| must refer to a
-  // a channel already established with InitializeStream.
-  virtual void InsertFrame(uint32_t ssrc, const EncodedFrame& frame) = 0;
+  // a channel already established with InitializeStream. The frame's data is
+  // encrypted in place, and its packets are sent and resent from it without
+  // being copied.
+  virtual void InsertFrame(uint32_t ssrc,
+                           std::unique_ptr<EncodedFrame> frame) = 0;
 
   // Sends a RTCP sender report to the receiver.
   // |ssrc| is the SSRC for this report.
@@ -11,13 +11,15 @@ CastTransportRtpConfig::CastTransportRtpConfig()
     : rtp_stream_id(0),
       ssrc(0),
       feedback_ssrc(0),
-      rtp_payload_type(RtpPayloadType::UNKNOWN) {}
+      rtp_payload_type(RtpPayloadType::UNKNOWN),
+      enable_fec(false) {}
 
 CastTransportRtpConfig::~CastTransportRtpConfig() = default;
 
 EncodedFrame::EncodedFrame()
     : dependency(UNKNOWN_DEPENDENCY),
-      new_playout_delay_ms(0) {}
+      new_playout_delay_ms(0),
+      temporal_layer_id(0) {}
 
 EncodedFrame::~EncodedFrame() = default;
 
@@ -29,6 +31,7 @@ void EncodedFrame::CopyMetadataTo(EncodedFrame* dest) const {
   dest->rtp_timestamp = this->rtp_timestamp;
   dest->reference_time = this->reference_time;
   dest->new_playout_delay_ms = this->new_playout_delay_ms;
+  dest->temporal_layer_id = this->temporal_layer_id;
 }
 
 RtcpSenderInfo::RtcpSenderInfo()
@@ -40,6 +40,10 @@ struct CastTransportRtpConfig {
   // strings, crypto is not being used.
   std::string aes_key;
   std::string aes_iv_mask;
+
+  // Whether to send forward error correction packets when the receiver
+  // reports packet loss.
+  bool enable_fec;
 };
 
 // A combination of metadata and data for one encoded frame.  This can contain
@@ -110,6 +114,12 @@ struct EncodedFrame {
   // Playout delay extension. Zero means no change.
   uint16_t new_playout_delay_ms;
 
+  // The temporal layer of this frame, zero being the base layer. Frames are
+  // only ever referenced by frames of the same or a higher layer. This is not
+  // sent to the receiver: it lets the sender drop frames of the enhancement
+  // layers under congestion.
+  uint8_t temporal_layer_id;
+
   // The encoded signal data.
   std::string data;
 };
@@ -128,6 +138,11 @@ class PacketTransport {
   // will return true indicating that the channel is not blocked.
   virtual bool SendPacket(PacketRef packet, base::OnceClosure cb) = 0;
 
+  // Sends any packets the transport is holding back from earlier SendPacket()
+  // calls in order to send them together. PacedSender calls this at the end
+  // of every burst.
+  virtual void FlushPackets() {}
+
   // Returns the number of bytes ever sent.
   virtual int64_t GetBytesSent() = 0;
 
@@ -0,0 +1,55 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/cast/net/cast_transport_defines.h"
+
+#include <utility>
+
+#include "base/check_op.h"
+
+namespace media {
+namespace cast {
+
+OutgoingPacket::OutgoingPacket() = default;
+
+OutgoingPacket::OutgoingPacket(Packet data) : data(std::move(data)) {}
+
+OutgoingPacket::OutgoingPacket(Packet header,
+                               scoped_refptr<base::RefCountedMemory> payload,
+                               size_t payload_offset,
+                               size_t payload_size)
+    : data(std::move(header)),
+      payload(std::move(payload)),
+      payload_offset(payload_offset),
+      payload_size(payload_size) {
+  DCHECK(this->payload);
+  DCHECK_LE(payload_offset + payload_size, this->payload->size());
+}
+
+OutgoingPacket::~OutgoingPacket() = default;
+
+scoped_refptr<OutgoingPacket> OutgoingPacket::CopyHeaders() const {
+  if (!payload)
+    return base::MakeRefCounted<OutgoingPacket>(data);
+  return base::MakeRefCounted<OutgoingPacket>(data, payload, payload_offset,
+                                              payload_size);
+}
+
+base::span<const uint8_t> OutgoingPacket::payload_span() const {
+  if (!payload)
+    return base::span<const uint8_t>();
+  return base::make_span(payload->front() + payload_offset, payload_size);
+}
+
+Packet OutgoingPacket::ToPacket() const {
+  Packet packet;
+  packet.reserve(size());
+  packet.insert(packet.end(), data.begin(), data.end());
+  const base::span<const uint8_t> rest = payload_span();
+  packet.insert(packet.end(), rest.begin(), rest.end());
+  return packet;
+}
+
+}  // namespace cast
+}  // namespace media
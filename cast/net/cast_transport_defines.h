@@ -12,8 +12,10 @@
 #include <set>
 #include <vector>
 
+#include "base/containers/span.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
 #include "media/cast/common/frame_id.h"
 
 namespace media {
@@ -46,7 +48,49 @@ using PacketIdSet = std::set<uint16_t>;
 using MissingFramesAndPacketsMap = std::map<FrameId, PacketIdSet>;
 
 using Packet = std::vector<uint8_t>;
-using PacketRef = scoped_refptr<base::RefCountedData<Packet>>;
+
+// A packet on its way to the network. |data| holds either the whole packet
+// or, when |payload| is set, only its headers, which are followed on the wire
+// by |payload_size| bytes of |payload| from |payload_offset|. The packets of a
+// frame, and their retransmissions, all point into the same payload buffer
+// instead of each holding a copy of their part of the frame.
+class OutgoingPacket : public base::RefCountedThreadSafe<OutgoingPacket> {
+ public:
+  OutgoingPacket();
+  explicit OutgoingPacket(Packet data);
+  OutgoingPacket(Packet header,
+                 scoped_refptr<base::RefCountedMemory> payload,
+                 size_t payload_offset,
+                 size_t payload_size);
+
+  OutgoingPacket(const OutgoingPacket&) = delete;
+  OutgoingPacket& operator=(const OutgoingPacket&) = delete;
+
+  // Returns a new packet with a copy of the headers, which shares the
+  // payload with this one.
+  scoped_refptr<OutgoingPacket> CopyHeaders() const;
+
+  // The size of the packet on the wire.
+  size_t size() const { return data.size() + payload_size; }
+
+  // The part of the packet which follows |data|; empty if there is none.
+  base::span<const uint8_t> payload_span() const;
+
+  // Returns the packet as one contiguous buffer. This copies the payload, so
+  // is only meant for transports which cannot send the two parts together.
+  Packet ToPacket() const;
+
+  Packet data;
+  scoped_refptr<base::RefCountedMemory> payload;
+  size_t payload_offset = 0;
+  size_t payload_size = 0;
+
+ private:
+  friend class base::RefCountedThreadSafe<OutgoingPacket>;
+  ~OutgoingPacket();
+};
+
+using PacketRef = scoped_refptr<OutgoingPacket>;
 using PacketList = std::vector<PacketRef>;
 
 }  // namespace cast
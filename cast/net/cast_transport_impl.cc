@@ -13,6 +13,8 @@
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
+#include "base/containers/span.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/task/single_thread_task_runner.h"
 #include "build/build_config.h"
 #include "media/cast/net/cast_transport_defines.h"
@@ -79,6 +81,11 @@ class CastTransportImpl::RtcpClient : public RtcpObserver {
 
   void OnReceivedPli() override { rtcp_observer_->OnReceivedPli(); }
 
+  void OnReceivedPacketLoss(double fraction_lost) override {
+    cast_transport_impl_->OnReceivedPacketLoss(rtp_sender_ssrc_,
+                                               fraction_lost);
+  }
+
  private:
   const uint32_t rtp_sender_ssrc_;
   const std::unique_ptr<RtcpObserver> rtcp_observer_;
@@ -188,34 +195,58 @@ void CastTransportImpl::InitializeStream(
 }
 
 namespace {
-void EncryptAndSendFrame(const EncodedFrame& frame,
+void EncryptAndSendFrame(std::unique_ptr<EncodedFrame> frame,
                          TransportEncryptionHandler* encryptor,
                          RtpSender* sender) {
-  if (encryptor->is_activated()) {
-    EncodedFrame encrypted_frame;
-    frame.CopyMetadataTo(&encrypted_frame);
-    if (encryptor->Encrypt(frame.frame_id, frame.data, &encrypted_frame.data)) {
-      sender->SendFrame(encrypted_frame);
-    } else {
-      LOG(ERROR) << "Encryption failed.  Not sending frame with ID "
-                 << frame.frame_id;
-    }
-  } else {
-    sender->SendFrame(frame);
+  if (encryptor->is_activated() &&
+      !encryptor->EncryptInPlace(
+          frame->frame_id,
+          base::as_writable_bytes(base::make_span(frame->data)))) {
+    LOG(ERROR) << "Encryption failed.  Not sending frame with ID "
+               << frame->frame_id;
+    return;
   }
+
+  // The packets of the frame, and their retransmissions, are sent straight
+  // from the frame's own buffer.
+  scoped_refptr<base::RefCountedMemory> payload =
+      base::RefCountedString::TakeString(&frame->data);
+  sender->SendFrame(*frame, std::move(payload));
 }
 }  // namespace
 
-void CastTransportImpl::InsertFrame(uint32_t ssrc, const EncodedFrame& frame) {
+void CastTransportImpl::InsertFrame(uint32_t ssrc,
+                                    std::unique_ptr<EncodedFrame> frame) {
   auto it = sessions_.find(ssrc);
   if (it == sessions_.end()) {
     NOTREACHED() << "Invalid InsertFrame call.";
     return;
   }
 
-  it->second->rtcp_session->WillSendFrame(frame.frame_id);
-  EncryptAndSendFrame(frame, &it->second->encryptor,
-                      it->second->rtp_sender.get());
+  RtpStreamSession* const session = it->second.get();
+  const FrameId frame_id = frame->frame_id;
+  const size_t frame_size = frame->data.size();
+  session->rtcp_session->WillSendFrame(frame_id);
+  EncryptAndSendFrame(std::move(frame), &session->encryptor,
+                      session->rtp_sender.get());
+
+  // Generate the keystream for the next frame, which is likely to be about
+  // the size of this one, once the packets of this one are on their way.
+  if (session->encryptor.is_activated()) {
+    transport_task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&CastTransportImpl::PrecomputeKeystream,
+                       weak_factory_.GetWeakPtr(), ssrc, frame_id + 1,
+                       frame_size));
+  }
+}
+
+void CastTransportImpl::PrecomputeKeystream(uint32_t ssrc,
+                                            FrameId frame_id,
+                                            size_t size) {
+  auto it = sessions_.find(ssrc);
+  if (it != sessions_.end())
+    it->second->encryptor.PrecomputeKeystream(frame_id, size);
 }
 
 void CastTransportImpl::SendSenderReport(
@@ -368,6 +399,14 @@ void CastTransportImpl::OnReceivedLogMessage(
   }
 }
 
+void CastTransportImpl::OnReceivedPacketLoss(uint32_t ssrc,
+                                             double fraction_lost) {
+  auto it = sessions_.find(ssrc);
+  if (it == sessions_.end() || !it->second->rtp_sender)
+    return;
+  it->second->rtp_sender->OnReceivedPacketLoss(fraction_lost);
+}
+
 void CastTransportImpl::OnReceivedCastMessage(
     uint32_t ssrc,
     const RtcpCastMessage& cast_message) {
@@ -68,7 +68,7 @@ class CastTransportImpl final : public CastTransport {
   // CastTransport implementation for sending.
   void InitializeStream(const CastTransportRtpConfig& config,
                         std::unique_ptr<RtcpObserver> rtcp_observer) final;
-  void InsertFrame(uint32_t ssrc, const EncodedFrame& frame) final;
+  void InsertFrame(uint32_t ssrc, std::unique_ptr<EncodedFrame> frame) final;
 
   void SendSenderReport(uint32_t ssrc,
                         base::TimeTicks current_time,
@@ -138,6 +138,10 @@ class CastTransportImpl final : public CastTransport {
   // Called when a packet is received.
   bool OnReceivedPacket(std::unique_ptr<Packet> packet);
 
+  // Prepares the session with |ssrc| to encrypt |size| bytes of frame
+  // |frame_id| quickly.
+  void PrecomputeKeystream(uint32_t ssrc, FrameId frame_id, size_t size);
+
   // Called when a log message is received.
   void OnReceivedLogMessage(EventMediaType media_type,
                             const RtcpReceiverLogMessage& log);
@@ -146,6 +150,9 @@ class CastTransportImpl final : public CastTransport {
   void OnReceivedCastMessage(uint32_t ssrc,
                              const RtcpCastMessage& cast_message);
 
+  // Called when a receiver report block is received.
+  void OnReceivedPacketLoss(uint32_t ssrc, double fraction_lost);
+
   const base::TickClock* const clock_;  // Not owned by this class.
   const base::TimeDelta logging_flush_interval_;
   const std::unique_ptr<Client> transport_client_;
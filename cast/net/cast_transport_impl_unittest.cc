@@ -58,7 +58,7 @@ class FakePacketSender : public PacketTransport {
       return false;
     }
     ++packets_sent_;
-    bytes_sent_ += packet->data.size();
+    bytes_sent_ += packet->size();
     return true;
   }
 
@@ -212,7 +212,8 @@ TEST_F(CastTransportImplTest, NacksCancelRetransmits) {
   fake_frame.dependency = EncodedFrame::KEY;
   fake_frame.data.resize(5000, ' ');
 
-  transport_sender_->InsertFrame(kVideoSsrc, fake_frame);
+  transport_sender_->InsertFrame(kVideoSsrc,
+                                 std::make_unique<EncodedFrame>(fake_frame));
   task_runner_->Sleep(base::Milliseconds(10));
   EXPECT_EQ(4, transport_->packets_sent());
   EXPECT_EQ(1, num_times_logging_callback_called_);
@@ -260,7 +261,8 @@ TEST_F(CastTransportImplTest, CancelRetransmits) {
   fake_frame.dependency = EncodedFrame::KEY;
   fake_frame.data.resize(5000, ' ');
 
-  transport_sender_->InsertFrame(kVideoSsrc, fake_frame);
+  transport_sender_->InsertFrame(kVideoSsrc,
+                                 std::make_unique<EncodedFrame>(fake_frame));
   task_runner_->Sleep(base::Milliseconds(10));
   EXPECT_EQ(4, transport_->packets_sent());
   EXPECT_EQ(1, num_times_logging_callback_called_);
@@ -304,7 +306,8 @@ TEST_F(CastTransportImplTest, Kickstart) {
   fake_frame.data.resize(5000, ' ');
 
   transport_->SetPaused(true);
-  transport_sender_->InsertFrame(kVideoSsrc, fake_frame);
+  transport_sender_->InsertFrame(kVideoSsrc,
+                                 std::make_unique<EncodedFrame>(fake_frame));
   transport_sender_->ResendFrameForKickstart(kVideoSsrc, fake_frame.frame_id);
   transport_->SetPaused(false);
   task_runner_->Sleep(base::Milliseconds(10));
@@ -345,11 +348,13 @@ TEST_F(CastTransportImplTest, DedupRetransmissionWithAudio) {
   fake_audio.reference_time = testing_clock_.NowTicks();
   fake_audio.dependency = EncodedFrame::KEY;
   fake_audio.data.resize(100, ' ');
-  transport_sender_->InsertFrame(kAudioSsrc, fake_audio);
+  transport_sender_->InsertFrame(kAudioSsrc,
+                                 std::make_unique<EncodedFrame>(fake_audio));
   task_runner_->Sleep(base::Milliseconds(2));
   fake_audio.frame_id = FrameId::first() + 2;
   fake_audio.reference_time = testing_clock_.NowTicks();
-  transport_sender_->InsertFrame(kAudioSsrc, fake_audio);
+  transport_sender_->InsertFrame(kAudioSsrc,
+                                 std::make_unique<EncodedFrame>(fake_audio));
   task_runner_->Sleep(base::Milliseconds(2));
   EXPECT_EQ(2, transport_->packets_sent());
 
@@ -368,7 +373,8 @@ TEST_F(CastTransportImplTest, DedupRetransmissionWithAudio) {
   fake_video.referenced_frame_id = FrameId::first() + 1;
   fake_video.dependency = EncodedFrame::KEY;
   fake_video.data.resize(5000, ' ');
-  transport_sender_->InsertFrame(kVideoSsrc, fake_video);
+  transport_sender_->InsertFrame(kVideoSsrc,
+                                 std::make_unique<EncodedFrame>(fake_video));
   task_runner_->RunTasks();
   EXPECT_EQ(6, transport_->packets_sent());
   EXPECT_EQ(0, num_times_logging_callback_called_);  // Only 4 ms since last.
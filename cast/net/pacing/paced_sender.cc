@@ -4,8 +4,12 @@
 
 #include "media/cast/net/pacing/paced_sender.h"
 
+#include <algorithm>
+
 #include "base/big_endian.h"
 #include "base/bind.h"
+#include "base/bits.h"
+#include "base/hash/hash.h"
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
 
@@ -19,21 +23,31 @@ static const int64_t kPacingIntervalMs = 10;
 // bursts of packets.
 static const size_t kPacingMaxBurstsPerFrame = 3;
 static const size_t kMaxDedupeWindowMs = 500;
+// The number of dropped enhancement layer frames remembered per SSRC, to
+// reject their retransmission. This is more than are ever in flight.
+static const size_t kMaxDroppedFramesPerSsrc = 32;
+
+bool IsSameFrame(const PacketKey& a, const PacketKey& b) {
+  return a.capture_time == b.capture_time && a.ssrc == b.ssrc &&
+         a.frame_id == b.frame_id;
+}
 
 }  // namespace
 
 DedupInfo::DedupInfo() : last_byte_acked_for_audio(0) {}
 
-PacketKey::PacketKey() : ssrc(0), packet_id(0) {}
+PacketKey::PacketKey() : ssrc(0), packet_id(0), temporal_layer_id(0) {}
 
 PacketKey::PacketKey(base::TimeTicks capture_time,
                      uint32_t ssrc,
                      FrameId frame_id,
-                     uint16_t packet_id)
+                     uint16_t packet_id,
+                     uint8_t temporal_layer_id)
     : capture_time(capture_time),
       ssrc(ssrc),
       frame_id(frame_id),
-      packet_id(packet_id) {}
+      packet_id(packet_id),
+      temporal_layer_id(temporal_layer_id) {}
 
 PacketKey::PacketKey(const PacketKey& other) = default;
 
@@ -51,18 +65,136 @@ struct PacedSender::PacketSendRecord {
   int cancel_count;  // Number of times the packet was canceled (debugging).
 };
 
-struct PacedSender::RtpSession {
-  explicit RtpSession(bool is_audio_stream)
-      : last_byte_sent(0), is_audio(is_audio_stream) {}
-  RtpSession() = default;
+// Open-addressed hash table of PacketSendRecords, keyed by PacketKey and
+// hashed on (ssrc, frame_id, packet_id). Records are grouped into windows: a
+// record is visible while it was last written in the current or the previous
+// window, so starting a new window forgets everything written before the
+// previous one without touching it. Slots of forgotten records are reused by
+// later insertions and dropped when the table is rehashed.
+class PacedSender::PacketSendHistory {
+ public:
+  PacketSendHistory() : slots_(kInitialCapacity) {}
+
+  PacketSendHistory(const PacketSendHistory&) = delete;
+  PacketSendHistory& operator=(const PacketSendHistory&) = delete;
+
+  // Returns the record for |key|, or null if there is none.
+  PacketSendRecord* Find(const PacketKey& key) {
+    for (size_t i = IndexFor(key); slots_[i].used; i = Next(i)) {
+      if (slots_[i].key == key)
+        return IsVisible(slots_[i]) ? &slots_[i].record : nullptr;
+    }
+    return nullptr;
+  }
+
+  // Returns the record for |key|, creating an empty one if there is none, and
+  // moves it into the current window.
+  PacketSendRecord* FindOrCreate(const PacketKey& key) {
+    Slot* reusable = nullptr;
+    size_t i = IndexFor(key);
+    for (; slots_[i].used; i = Next(i)) {
+      Slot& slot = slots_[i];
+      if (slot.key == key) {
+        if (!IsVisible(slot))
+          slot.record = PacketSendRecord();
+        return Touch(&slot);
+      }
+      if (!reusable && !IsVisible(slot))
+        reusable = &slot;
+    }
+
+    Slot* slot = reusable;
+    if (!slot) {
+      // Keep the load factor below 3/4 so that probe sequences stay short.
+      if ((used_slots_ + 1) * 4 > slots_.size() * 3) {
+        Rehash();
+        return FindOrCreate(key);
+      }
+      slot = &slots_[i];
+      slot->used = true;
+      ++used_slots_;
+    }
+    slot->key = key;
+    slot->record = PacketSendRecord();
+    slot->window = 0;
+    return Touch(slot);
+  }
+
+  // Number of records written in the current window.
+  size_t current_window_size() const { return current_window_size_; }
+
+  void StartNewWindow() {
+    ++window_;
+    current_window_size_ = 0;
+  }
+
+ private:
+  static constexpr size_t kInitialCapacity = 256;
+
+  struct Slot {
+    PacketKey key;
+    PacketSendRecord record;
+    uint32_t window = 0;
+    bool used = false;
+  };
 
-  // Tracks recently-logged RTP timestamps so that it can expand the truncated
-  // values found in packets.
-  RtpTimeTicks last_logged_rtp_timestamp_;
-  int64_t last_byte_sent;
-  bool is_audio;
+  bool IsVisible(const Slot& slot) const { return slot.window + 1 >= window_; }
+
+  size_t IndexFor(const PacketKey& key) const {
+    return base::HashInts64(
+               (static_cast<uint64_t>(key.ssrc) << 16) | key.packet_id,
+               key.frame_id.lower_32_bits()) &
+           (slots_.size() - 1);
+  }
+
+  size_t Next(size_t index) const { return (index + 1) & (slots_.size() - 1); }
+
+  PacketSendRecord* Touch(Slot* slot) {
+    if (slot->window != window_) {
+      slot->window = window_;
+      ++current_window_size_;
+    }
+    return &slot->record;
+  }
+
+  // Rebuilds the table from the visible records only, growing it if they
+  // would fill more than a quarter of it.
+  void Rehash() {
+    std::vector<Slot> old_slots;
+    old_slots.swap(slots_);
+    size_t visible = 0;
+    for (const Slot& slot : old_slots)
+      visible += slot.used && IsVisible(slot);
+    slots_.resize(std::max(
+        kInitialCapacity,
+        size_t{1} << base::bits::Log2Ceiling(
+            base::checked_cast<uint32_t>(visible * 4 + 1))));
+    used_slots_ = 0;
+    for (Slot& slot : old_slots) {
+      if (!slot.used || !IsVisible(slot))
+        continue;
+      size_t i = IndexFor(slot.key);
+      while (slots_[i].used)
+        i = Next(i);
+      slots_[i] = std::move(slot);
+      ++used_slots_;
+    }
+  }
+
+  // Always a power of two.
+  std::vector<Slot> slots_;
+  size_t used_slots_ = 0;
+  // Window 0 is never current, so unused slots are never visible.
+  uint32_t window_ = 1;
+  size_t current_window_size_ = 0;
 };
 
+PacedSender::SsrcQueue::SsrcQueue() = default;
+PacedSender::SsrcQueue::SsrcQueue(SsrcQueue&&) = default;
+PacedSender::SsrcQueue& PacedSender::SsrcQueue::operator=(SsrcQueue&&) =
+    default;
+PacedSender::SsrcQueue::~SsrcQueue() = default;
+
 PacedSender::PacedSender(
     size_t target_burst_size,
     size_t max_burst_size,
@@ -81,7 +213,8 @@ PacedSender::PacedSender(
       next_max_burst_size_(target_burst_size_),
       next_next_max_burst_size_(target_burst_size_),
       current_burst_size_(0),
-      state_(State_Unblocked) {}
+      state_(State_Unblocked),
+      send_history_(std::make_unique<PacketSendHistory>()) {}
 
 PacedSender::~PacedSender() = default;
 
@@ -94,13 +227,16 @@ void PacedSender::RegisterSsrc(uint32_t ssrc, bool is_audio) {
 
 void PacedSender::RegisterPrioritySsrc(uint32_t ssrc) {
   priority_ssrcs_.push_back(ssrc);
+  auto it = queues_.find(ssrc);
+  if (it != queues_.end())
+    it->second.is_priority = true;
 }
 
 int64_t PacedSender::GetLastByteSentForPacket(const PacketKey& packet_key) {
-  PacketSendHistory::const_iterator it = send_history_.find(packet_key);
-  if (it == send_history_.end())
+  const PacketSendRecord* record = send_history_->Find(packet_key);
+  if (!record)
     return 0;
-  return it->second.last_byte_sent;
+  return record->last_byte_sent;
 }
 
 int64_t PacedSender::GetLastByteSentForSsrc(uint32_t ssrc) {
@@ -115,29 +251,23 @@ bool PacedSender::SendPackets(const SendPacketVector& packets) {
   if (packets.empty()) {
     return true;
   }
-  const bool high_priority = IsHighPriority(packets.begin()->first);
+  if (packets.front().first.temporal_layer_id == 0)
+    DropEnhancementLayerFrames(packets.front().first);
   for (size_t i = 0; i < packets.size(); i++) {
     if (VLOG_IS_ON(2)) {
-      PacketSendHistory::const_iterator history_it =
-          send_history_.find(packets[i].first);
-      if (history_it != send_history_.end() &&
-          history_it->second.cancel_count > 0) {
+      const PacketSendRecord* record = send_history_->Find(packets[i].first);
+      if (record && record->cancel_count > 0) {
         VLOG(2) << "PacedSender::SendPackets() called for packet CANCELED "
-                << history_it->second.cancel_count << " times: "
+                << record->cancel_count << " times: "
                 << "ssrc=" << packets[i].first.ssrc
                 << ", frame_id=" << packets[i].first.frame_id
                 << ", packet_id=" << packets[i].first.packet_id;
       }
     }
 
-    DCHECK(IsHighPriority(packets[i].first) == high_priority);
-    if (high_priority) {
-      priority_packet_list_[packets[i].first] =
-          make_pair(PacketType_Normal, packets[i].second);
-    } else {
-      packet_list_[packets[i].first] =
-          make_pair(PacketType_Normal, packets[i].second);
-    }
+    DCHECK_EQ(IsHighPriority(packets[i].first),
+              IsHighPriority(packets.front().first));
+    EnqueuePacket(packets[i].first, PacketType_Normal, packets[i].second);
   }
   if (state_ == State_Unblocked) {
     SendStoredPackets();
@@ -148,10 +278,10 @@ bool PacedSender::SendPackets(const SendPacketVector& packets) {
 bool PacedSender::ShouldResend(const PacketKey& packet_key,
                                const DedupInfo& dedup_info,
                                const base::TimeTicks& now) {
-  PacketSendHistory::const_iterator it = send_history_.find(packet_key);
+  const PacketSendRecord* record = send_history_->Find(packet_key);
 
   // No history of previous transmission. It might be sent too long ago.
-  if (it == send_history_.end())
+  if (!record)
     return true;
 
   // Suppose there is request to retransmit X and there is an audio
@@ -160,20 +290,21 @@ bool PacedSender::ShouldResend(const PacketKey& packet_key,
   // Only do this for video packets.
   //
   // TODO(miu): This sounds wrong.  Audio packets are always transmitted first
-  // (because they are put in |priority_packet_list_|, see PopNextPacket()).
+  // (because their SSRC is registered as a priority SSRC, see
+  // PopNextPacket()).
   auto session_it = sessions_.find(packet_key.ssrc);
   // The session should always have been registered in |sessions_|.
   DCHECK(session_it != sessions_.end());
   if (!session_it->second.is_audio) {
     if (dedup_info.last_byte_acked_for_audio &&
-        it->second.last_byte_sent_for_audio &&
+        record->last_byte_sent_for_audio &&
         dedup_info.last_byte_acked_for_audio <
-        it->second.last_byte_sent_for_audio) {
+        record->last_byte_sent_for_audio) {
       return false;
     }
   }
   // Retransmission interval has to be greater than |resend_interval|.
-  if (now - it->second.time < dedup_info.resend_interval)
+  if (now - record->time < dedup_info.resend_interval)
     return false;
   return true;
 }
@@ -183,35 +314,28 @@ bool PacedSender::ResendPackets(const SendPacketVector& packets,
   if (packets.empty()) {
     return true;
   }
-  const bool high_priority = IsHighPriority(packets.begin()->first);
   const base::TimeTicks now = clock_->NowTicks();
   for (size_t i = 0; i < packets.size(); i++) {
     if (VLOG_IS_ON(2)) {
-      PacketSendHistory::const_iterator history_it =
-          send_history_.find(packets[i].first);
-      if (history_it != send_history_.end() &&
-          history_it->second.cancel_count > 0) {
+      const PacketSendRecord* record = send_history_->Find(packets[i].first);
+      if (record && record->cancel_count > 0) {
         VLOG(2) << "PacedSender::ReendPackets() called for packet CANCELED "
-                << history_it->second.cancel_count << " times: "
+                << record->cancel_count << " times: "
                 << "ssrc=" << packets[i].first.ssrc
                 << ", frame_id=" << packets[i].first.frame_id
                 << ", packet_id=" << packets[i].first.packet_id;
       }
     }
 
-    if (!ShouldResend(packets[i].first, dedup_info, now)) {
-      LogPacketEvent(packets[i].second->data, PACKET_RTX_REJECTED);
+    if (WasFrameDropped(packets[i].first) ||
+        !ShouldResend(packets[i].first, dedup_info, now)) {
+      LogPacketEvent(*packets[i].second, PACKET_RTX_REJECTED);
       continue;
     }
 
-    DCHECK(IsHighPriority(packets[i].first) == high_priority);
-    if (high_priority) {
-      priority_packet_list_[packets[i].first] =
-          make_pair(PacketType_Resend, packets[i].second);
-    } else {
-      packet_list_[packets[i].first] =
-          make_pair(PacketType_Resend, packets[i].second);
-    }
+    DCHECK_EQ(IsHighPriority(packets[i].first),
+              IsHighPriority(packets.front().first));
+    EnqueuePacket(packets[i].first, PacketType_Resend, packets[i].second);
   }
   if (state_ == State_Unblocked) {
     SendStoredPackets();
@@ -221,84 +345,209 @@ bool PacedSender::ResendPackets(const SendPacketVector& packets,
 
 bool PacedSender::SendRtcpPacket(uint32_t ssrc, PacketRef packet) {
   if (state_ == State_TransportBlocked) {
-    const PacketKey key(base::TimeTicks(), ssrc, FrameId::first(), 0);
-    priority_packet_list_[key] = make_pair(PacketType_RTCP, packet);
+    auto it = std::lower_bound(
+        pending_rtcp_packets_.begin(), pending_rtcp_packets_.end(), ssrc,
+        [](const std::pair<uint32_t, PacketRef>& pending, uint32_t value) {
+          return pending.first < value;
+        });
+    if (it != pending_rtcp_packets_.end() && it->first == ssrc) {
+      it->second = std::move(packet);
+    } else {
+      pending_rtcp_packets_.insert(it, std::make_pair(ssrc, std::move(packet)));
+      ++queued_packet_count_;
+    }
   } else {
     // We pass the RTCP packets straight through.
     if (!transport_->SendPacket(packet,
                                 base::BindOnce(&PacedSender::SendStoredPackets,
                                                weak_factory_.GetWeakPtr()))) {
       state_ = State_TransportBlocked;
+    } else {
+      transport_->FlushPackets();
     }
   }
   return true;
 }
 
 void PacedSender::CancelSendingPacket(const PacketKey& packet_key) {
-  packet_list_.erase(packet_key);
-  priority_packet_list_.erase(packet_key);
+  auto queue_it = queues_.find(packet_key.ssrc);
+  if (queue_it != queues_.end()) {
+    SsrcQueue* queue = &queue_it->second;
+    auto it = std::lower_bound(
+        queue->packets.begin(), queue->packets.end(), packet_key,
+        [](const QueuedPacket& queued, const PacketKey& value) {
+          return queued.key < value;
+        });
+    if (it != queue->packets.end() && it->key == packet_key && it->packet)
+      RemoveQueuedPacket(queue, it - queue->packets.begin());
+  }
 
   if (VLOG_IS_ON(2)) {
-    auto history_it = send_history_.find(packet_key);
-    if (history_it != send_history_.end())
-      ++history_it->second.cancel_count;
+    PacketSendRecord* record = send_history_->Find(packet_key);
+    if (record)
+      ++record->cancel_count;
   }
 }
 
 PacketRef PacedSender::PopNextPacket(PacketType* packet_type,
                                      PacketKey* packet_key) {
-  // Always pop from the priority list first.
-  PacketList* list =
-      !priority_packet_list_.empty() ? &priority_packet_list_ : &packet_list_;
-  DCHECK(!list->empty());
+  DCHECK(!empty());
+
+  // RTCP packets go first.
+  if (!pending_rtcp_packets_.empty()) {
+    *packet_type = PacketType_RTCP;
+    *packet_key = PacketKey(base::TimeTicks(),
+                            pending_rtcp_packets_.front().first,
+                            FrameId::first(), 0);
+    PacketRef ret = std::move(pending_rtcp_packets_.front().second);
+    pending_rtcp_packets_.erase(pending_rtcp_packets_.begin());
+    --queued_packet_count_;
+    return ret;
+  }
+
+  // Then the queue with the earliest packet, preferring high-priority SSRCs.
+  SsrcQueue* queue = nullptr;
+  for (auto& entry : queues_) {
+    SsrcQueue& candidate = entry.second;
+    if (candidate.packets.empty())
+      continue;
+    if (!queue || (candidate.is_priority && !queue->is_priority) ||
+        (candidate.is_priority == queue->is_priority &&
+         candidate.packets.front().key < queue->packets.front().key)) {
+      queue = &candidate;
+    }
+  }
+  DCHECK(queue);
 
   // Determine which packet in the frame should be popped by examining the
   // |send_history_| for prior transmission attempts.  Packets that have never
   // been transmitted will be popped first.  If all packets have transmitted
   // before, pop the one that has not been re-attempted for the longest time.
-  auto it = list->begin();
-  PacketKey last_key = it->first;
-  last_key.packet_id = UINT16_C(0xffff);
-  PacketSendHistory::const_iterator history_it =
-      send_history_.lower_bound(it->first);
+  const base::circular_deque<QueuedPacket>& packets = queue->packets;
+  const PacketKey& first_key = packets.front().key;
   base::TimeTicks earliest_send_time =
       base::TimeTicks() + base::TimeDelta::Max();
-  auto found_it = it;
-  while (true) {
-    if (history_it == send_history_.end() || it->first < history_it->first) {
+  size_t found_index = 0;
+  for (size_t i = 0;
+       i < packets.size() && IsSameFrame(packets[i].key, first_key); ++i) {
+    // Skip holes left by canceled packets.
+    if (!packets[i].packet)
+      continue;
+
+    const PacketSendRecord* record = send_history_->Find(packets[i].key);
+    if (!record) {
       // There is no send history for this packet, which means it has not been
       // transmitted yet.
-      found_it = it;
+      found_index = i;
       break;
     }
+    if (record->time < earliest_send_time) {
+      earliest_send_time = record->time;
+      found_index = i;
+    }
+  }
+
+  *packet_type = packets[found_index].type;
+  *packet_key = packets[found_index].key;
+  PacketRef ret = packets[found_index].packet;
+  RemoveQueuedPacket(queue, found_index);
+  return ret;
+}
+
+void PacedSender::EnqueuePacket(const PacketKey& key,
+                                PacketType type,
+                                const PacketRef& packet) {
+  auto result = queues_.try_emplace(key.ssrc);
+  SsrcQueue& queue = result.first->second;
+  if (result.second)
+    queue.is_priority = IsHighPriority(key);
+
+  base::circular_deque<QueuedPacket>& packets = queue.packets;
+  auto it = packets.end();
+  if (!packets.empty() && !(packets.back().key < key)) {
+    it = std::lower_bound(
+        packets.begin(), packets.end(), key,
+        [](const QueuedPacket& queued, const PacketKey& value) {
+          return queued.key < value;
+        });
+  }
 
-    DCHECK(it->first == history_it->first);
-    if (history_it->second.time < earliest_send_time) {
-      earliest_send_time = history_it->second.time;
-      found_it = it;
+  if (it != packets.end() && it->key == key) {
+    // The packet is already queued, or there is a hole where it used to be.
+    if (!it->packet) {
+      ++queue.size;
+      ++queued_packet_count_;
     }
+    it->type = type;
+    it->packet = packet;
+    return;
+  }
+
+  packets.insert(it, QueuedPacket{key, type, packet});
+  ++queue.size;
+  ++queued_packet_count_;
+}
+
+void PacedSender::RemoveQueuedPacket(SsrcQueue* queue, size_t index) {
+  DCHECK(queue->packets[index].packet);
+  queue->packets[index].packet = nullptr;
+  --queue->size;
+  --queued_packet_count_;
+
+  if (!queue->size) {
+    queue->packets.clear();
+    return;
+  }
+  while (!queue->packets.front().packet)
+    queue->packets.pop_front();
+}
 
-    // Advance to next packet for the current frame, or break if there are no
-    // more.
-    ++it;
-    if (it == list->end() || last_key < it->first)
+void PacedSender::DropEnhancementLayerFrames(const PacketKey& base_layer_key) {
+  auto queue_it = queues_.find(base_layer_key.ssrc);
+  if (queue_it == queues_.end())
+    return;
+  SsrcQueue* queue = &queue_it->second;
+
+  // Packets are sorted by capture time, so the search stops at the first one
+  // captured at the same time as the base layer frame, or later.
+  size_t i = 0;
+  while (i < queue->packets.size()) {
+    const QueuedPacket& queued = queue->packets[i];
+    if (!(queued.key.capture_time < base_layer_key.capture_time))
       break;
+    if (!queued.packet || queued.key.temporal_layer_id == 0) {
+      ++i;
+      continue;
+    }
 
-    // Advance to next history entry.  Since there may be "holes" in the packet
-    // list (e.g., due to packets canceled for retransmission), it's possible
-    // |history_it| will have to be advanced more than once even though |it| was
-    // only advanced once.
-    do {
-      ++history_it;
-    } while (history_it != send_history_.end() &&
-             history_it->first < it->first);
+    const FrameId frame_id = queued.key.frame_id;
+    if (queue->dropped_frame_ids.empty() ||
+        queue->dropped_frame_ids.back() != frame_id) {
+      VLOG(1) << "Dropping enhancement layer frame " << frame_id
+              << " of ssrc " << base_layer_key.ssrc
+              << " behind base layer frame " << base_layer_key.frame_id;
+      queue->dropped_frame_ids.push_back(frame_id);
+      if (queue->dropped_frame_ids.size() > kMaxDroppedFramesPerSsrc)
+        queue->dropped_frame_ids.pop_front();
+    }
+    // Removing the front packet pops it, along with the holes behind it.
+    const bool is_front = i == 0;
+    RemoveQueuedPacket(queue, i);
+    if (!is_front)
+      ++i;
   }
+}
 
-  *packet_type = found_it->second.first;
-  *packet_key = found_it->first;
-  PacketRef ret = found_it->second.second;
-  list->erase(found_it);
-  return ret;
+bool PacedSender::WasFrameDropped(const PacketKey& packet_key) const {
+  if (packet_key.temporal_layer_id == 0)
+    return false;
+  auto queue_it = queues_.find(packet_key.ssrc);
+  if (queue_it == queues_.end())
+    return false;
+  const base::circular_deque<FrameId>& dropped_frame_ids =
+      queue_it->second.dropped_frame_ids;
+  return std::find(dropped_frame_ids.begin(), dropped_frame_ids.end(),
+                   packet_key.frame_id) != dropped_frame_ids.end();
 }
 
 bool PacedSender::IsHighPriority(const PacketKey& packet_key) const {
@@ -307,11 +556,11 @@ bool PacedSender::IsHighPriority(const PacketKey& packet_key) const {
 }
 
 bool PacedSender::empty() const {
-  return packet_list_.empty() && priority_packet_list_.empty();
+  return queued_packet_count_ == 0;
 }
 
 size_t PacedSender::size() const {
-  return packet_list_.size() + priority_packet_list_.size();
+  return queued_packet_count_;
 }
 
 // This function can be called from three places:
@@ -358,6 +607,7 @@ void PacedSender::SendStoredPackets() {
       &PacedSender::SendStoredPackets, weak_factory_.GetWeakPtr());
   while (!empty()) {
     if (current_burst_size_ >= current_max_burst_size_) {
+      transport_->FlushPackets();
       transport_task_runner_->PostDelayedTask(FROM_HERE,
                                               cb,
                                               burst_end_ - now);
@@ -367,7 +617,8 @@ void PacedSender::SendStoredPackets() {
     PacketType packet_type;
     PacketKey packet_key;
     PacketRef packet = PopNextPacket(&packet_type, &packet_key);
-    PacketSendRecord* const send_record = &(send_history_[packet_key]);
+    PacketSendRecord* const send_record =
+        send_history_->FindOrCreate(packet_key);
     send_record->time = now;
 
     if (send_record->cancel_count > 0 && packet_type != PacketType_RTCP) {
@@ -380,10 +631,10 @@ void PacedSender::SendStoredPackets() {
 
     switch (packet_type) {
       case PacketType_Resend:
-        LogPacketEvent(packet->data, PACKET_RETRANSMITTED);
+        LogPacketEvent(*packet, PACKET_RETRANSMITTED);
         break;
       case PacketType_Normal:
-        LogPacketEvent(packet->data, PACKET_SENT_TO_NETWORK);
+        LogPacketEvent(*packet, PACKET_SENT_TO_NETWORK);
         break;
       case PacketType_RTCP:
         break;
@@ -394,7 +645,6 @@ void PacedSender::SendStoredPackets() {
     // Save the send record.
     send_record->last_byte_sent = transport_->GetBytesSent();
     send_record->last_byte_sent_for_audio = last_byte_sent_for_audio_;
-    send_history_buffer_[packet_key] = *send_record;
 
     auto it = sessions_.find(packet_key.ssrc);
     // The session should always have been registered in |sessions_|.
@@ -409,22 +659,23 @@ void PacedSender::SendStoredPackets() {
     }
     current_burst_size_++;
   }
+  transport_->FlushPackets();
 
   // Keep ~0.5 seconds of data (1000 packets).
   //
   // TODO(miu): This has no relation to the actual size of the frames, and so
   // there's no way to reason whether 1000 is enough or too much, or whatever.
-  if (send_history_buffer_.size() >=
+  if (send_history_->current_window_size() >=
       max_burst_size_ * kMaxDedupeWindowMs / kPacingIntervalMs) {
-    send_history_.swap(send_history_buffer_);
-    send_history_buffer_.clear();
+    send_history_->StartNewWindow();
   }
-  DCHECK_LE(send_history_buffer_.size(),
+  DCHECK_LE(send_history_->current_window_size(),
             max_burst_size_ * kMaxDedupeWindowMs / kPacingIntervalMs);
   state_ = State_Unblocked;
 }
 
-void PacedSender::LogPacketEvent(const Packet& packet, CastLoggingEvent type) {
+void PacedSender::LogPacketEvent(const OutgoingPacket& packet,
+                                 CastLoggingEvent type) {
   if (!recent_packet_events_)
     return;
 
@@ -436,8 +687,9 @@ void PacedSender::LogPacketEvent(const Packet& packet, CastLoggingEvent type) {
   // TODO(miu): This parsing logic belongs in RtpParser.
   event.timestamp = clock_->NowTicks();
   event.type = type;
-  base::BigEndianReader reader(reinterpret_cast<const char*>(&packet[0]),
-                               packet.size());
+  // The headers are all in |packet.data|.
+  base::BigEndianReader reader(reinterpret_cast<const char*>(&packet.data[0]),
+                               packet.data.size());
   bool success = reader.Skip(4);
   uint32_t truncated_rtp_timestamp;
   success &= reader.ReadU32(&truncated_rtp_timestamp);
@@ -8,11 +8,13 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#include <map>
 #include <memory>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "base/containers/circular_deque.h"
+#include "base/containers/flat_map.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "base/task/single_thread_task_runner.h"
@@ -40,12 +42,16 @@ struct PacketKey {
   uint32_t ssrc;
   FrameId frame_id;
   uint16_t packet_id;
+  // The temporal layer of the frame (see EncodedFrame). This is a property of
+  // the frame rather than part of its identity, so it is not compared.
+  uint8_t temporal_layer_id;
 
   PacketKey();  // Do not use.  This is for STL containers.
   PacketKey(base::TimeTicks capture_time,
             uint32_t ssrc,
             FrameId frame_id,
-            uint16_t packet_id);
+            uint16_t packet_id,
+            uint8_t temporal_layer_id = 0);
   PacketKey(const PacketKey& other);
 
   ~PacketKey();
@@ -134,7 +140,11 @@ class PacedSender final : public PacedPacketSender {
   // This function is currently only used by unittests.
   int64_t GetLastByteSentForSsrc(uint32_t ssrc);
 
-  // PacedPacketSender implementation.
+  // PacedPacketSender implementation. When the packets of a base layer frame
+  // are sent while those of enhancement layer frames captured before it are
+  // still queued, the pacer is more than a frame behind: the enhancement layer
+  // frames are dropped, and their retransmission rejected, so that the base
+  // layer is not held up behind them.
   bool SendPackets(const SendPacketVector& packets) final;
   bool ResendPackets(const SendPacketVector& packets,
                      const DedupInfo& dedup_info) final;
@@ -154,7 +164,7 @@ class PacedSender final : public PacedPacketSender {
 
   // Convenience method for building a PacketEvent and storing it in the
   // externally-owned container of |recent_packet_events_|.
-  void LogPacketEvent(const Packet& packet, CastLoggingEvent event);
+  void LogPacketEvent(const OutgoingPacket& packet, CastLoggingEvent event);
 
   // Returns true if retransmission for packet indexed by |packet_key| is
   // accepted. |dedup_info| contains information to help deduplicate
@@ -185,9 +195,70 @@ class PacedSender final : public PacedPacketSender {
     State_BurstFull
   };
 
+  // A packet waiting to be sent. |packet| is null once the packet has been
+  // canceled, or popped from behind the front of its queue; such holes are
+  // skipped and dropped once they reach the front.
+  struct QueuedPacket {
+    PacketKey key;
+    PacketType type;
+    PacketRef packet;
+  };
+
+  // The packets queued for one SSRC, sorted by PacketKey. Packets of new
+  // frames carry increasing capture times and are appended, so only
+  // retransmissions of older frames are inserted in the middle. The front,
+  // if any, is never a hole.
+  struct SsrcQueue {
+    SsrcQueue();
+    SsrcQueue(SsrcQueue&&);
+    SsrcQueue& operator=(SsrcQueue&&);
+    ~SsrcQueue();
+
+    bool is_priority = false;
+    // Number of packets in |packets| which are not holes.
+    size_t size = 0;
+    base::circular_deque<QueuedPacket> packets;
+    // The most recent enhancement layer frames dropped from |packets|, oldest
+    // first.
+    base::circular_deque<FrameId> dropped_frame_ids;
+  };
+
+  struct RtpSession {
+    explicit RtpSession(bool is_audio_stream)
+        : last_byte_sent(0), is_audio(is_audio_stream) {}
+    RtpSession() = default;
+
+    // Tracks recently-logged RTP timestamps so that it can expand the
+    // truncated values found in packets.
+    RtpTimeTicks last_logged_rtp_timestamp_;
+    int64_t last_byte_sent;
+    bool is_audio;
+  };
+
+  struct PacketSendRecord;
+  class PacketSendHistory;
+
   bool empty() const;
   size_t size() const;
 
+  // Adds |packet| to the queue for its SSRC. A packet already queued under
+  // |key| is replaced.
+  void EnqueuePacket(const PacketKey& key,
+                     PacketType type,
+                     const PacketRef& packet);
+
+  // Turns the packet at |index| in |queue| into a hole, and drops holes from
+  // the front of |queue|.
+  void RemoveQueuedPacket(SsrcQueue* queue, size_t index);
+
+  // Removes the queued packets of enhancement layer frames captured before
+  // the base layer frame identified by |base_layer_key|.
+  void DropEnhancementLayerFrames(const PacketKey& base_layer_key);
+
+  // Returns true if the frame of |packet_key| was dropped by
+  // DropEnhancementLayerFrames().
+  bool WasFrameDropped(const PacketKey& packet_key) const;
+
   // Returns the next packet to send. RTCP packets have highest priority, then
   // high-priority RTP packets, then normal-priority RTP packets.  Packets
   // within a frame are selected based on fairness to ensure all have an equal
@@ -210,17 +281,19 @@ class PacedSender final : public PacedPacketSender {
   // Set of SSRCs that have higher priority. This is a vector instead of a
   // set because there's only very few in it (most likely 1).
   std::vector<uint32_t> priority_ssrcs_;
-  typedef std::map<PacketKey, std::pair<PacketType, PacketRef> > PacketList;
-  PacketList packet_list_;
-  PacketList priority_packet_list_;
 
-  struct PacketSendRecord;
-  using PacketSendHistory = std::map<PacketKey, PacketSendRecord>;
-  PacketSendHistory send_history_;
-  PacketSendHistory send_history_buffer_;
+  // RTP packets waiting to be sent, per SSRC.
+  base::flat_map<uint32_t, SsrcQueue> queues_;
+  // RTCP packets which arrived while the transport was blocked, sorted by
+  // SSRC. These go out before any RTP packets. A newer RTCP packet for the
+  // same SSRC replaces an older one.
+  std::vector<std::pair<uint32_t, PacketRef>> pending_rtcp_packets_;
+  // Number of packets in |queues_| and |pending_rtcp_packets_|.
+  size_t queued_packet_count_ = 0;
+
+  std::unique_ptr<PacketSendHistory> send_history_;
 
-  struct RtpSession;
-  using SessionMap = std::map<uint32_t, RtpSession>;
+  using SessionMap = base::flat_map<uint32_t, RtpSession>;
   // Records all the cast sessions with the sender SSRC as the key. These
   // sessions are in sync with those in CastTransportImpl.
   SessionMap sessions_;
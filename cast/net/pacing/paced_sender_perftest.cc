@@ -0,0 +1,147 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/memory/scoped_refptr.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/time/time.h"
+#include "media/base/fake_single_thread_task_runner.h"
+#include "media/cast/net/pacing/paced_sender.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+namespace cast {
+
+namespace {
+
+constexpr int kNumSessions = 100;
+constexpr int kVideoPacketsPerFrame = 8;
+constexpr size_t kPacketSize = 1200;
+constexpr int kNumIntervals = 2000;
+constexpr base::TimeDelta kPacingInterval = base::Milliseconds(10);
+
+// Frames are NACKed this many intervals after they were sent, and
+// acknowledged one interval later.
+constexpr int kNackDelayIntervals = 4;
+
+class CountingTransport final : public PacketTransport {
+ public:
+  bool SendPacket(PacketRef packet, base::OnceClosure cb) final {
+    ++packets_sent_;
+    bytes_sent_ += packet->data.size();
+    return true;
+  }
+  int64_t GetBytesSent() final { return bytes_sent_; }
+  void StartReceiving(PacketReceiverCallbackWithStatus packet_receiver) final {}
+  void StopReceiving() final {}
+
+  int64_t packets_sent() const { return packets_sent_; }
+
+ private:
+  int64_t packets_sent_ = 0;
+  int64_t bytes_sent_ = 0;
+};
+
+}  // namespace
+
+// Drives one PacedSender with many simultaneous audio and video sessions, as a
+// mirroring gateway does, optionally with every video frame NACKed in full.
+class PacedSenderPerfTest : public testing::TestWithParam<bool> {
+ public:
+  PacedSenderPerfTest()
+      : task_runner_(
+            base::MakeRefCounted<FakeSingleThreadTaskRunner>(&clock_)),
+        packet_(base::MakeRefCounted<OutgoingPacket>(Packet(kPacketSize, 0))) {
+    clock_.Advance(base::Seconds(1));
+    paced_sender_ = std::make_unique<PacedSender>(
+        kTargetBurstSize, kMaxBurstSize, &clock_, nullptr, &transport_,
+        task_runner_);
+
+    // Each interval enqueues one video frame and one audio packet per session;
+    // allow about that many packets per burst so the queues stay shallow but
+    // never empty.
+    const int burst_size = kNumSessions * (kVideoPacketsPerFrame + 1);
+    paced_sender_->SetTargetBurstSize(burst_size);
+    paced_sender_->SetMaxBurstSize(burst_size);
+
+    for (int i = 0; i < kNumSessions; ++i) {
+      paced_sender_->RegisterSsrc(AudioSsrc(i), true);
+      paced_sender_->RegisterPrioritySsrc(AudioSsrc(i));
+      paced_sender_->RegisterSsrc(VideoSsrc(i), false);
+    }
+  }
+
+  PacedSenderPerfTest(const PacedSenderPerfTest&) = delete;
+  PacedSenderPerfTest& operator=(const PacedSenderPerfTest&) = delete;
+
+ protected:
+  static uint32_t AudioSsrc(int session) { return 2 * session + 1; }
+  static uint32_t VideoSsrc(int session) { return 2 * session + 2; }
+
+  SendPacketVector MakeFrame(uint32_t ssrc, int interval, int num_packets) {
+    const base::TimeTicks capture_time =
+        base::TimeTicks() + kPacingInterval * interval;
+    SendPacketVector packets;
+    packets.reserve(num_packets);
+    for (int i = 0; i < num_packets; ++i) {
+      packets.emplace_back(
+          PacketKey(capture_time, ssrc, FrameId::first() + interval, i),
+          packet_);
+    }
+    return packets;
+  }
+
+  base::SimpleTestTickClock clock_;
+  scoped_refptr<FakeSingleThreadTaskRunner> task_runner_;
+  CountingTransport transport_;
+  std::unique_ptr<PacedSender> paced_sender_;
+  const PacketRef packet_;
+};
+
+TEST_P(PacedSenderPerfTest, ManySessions) {
+  const bool nack_storm = GetParam();
+
+  DedupInfo dedup_info;
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (int interval = 0; interval < kNumIntervals; ++interval) {
+    for (int session = 0; session < kNumSessions; ++session) {
+      paced_sender_->SendPackets(MakeFrame(AudioSsrc(session), interval, 1));
+      paced_sender_->SendPackets(
+          MakeFrame(VideoSsrc(session), interval, kVideoPacketsPerFrame));
+
+      const int nacked_interval = interval - kNackDelayIntervals;
+      if (!nack_storm || nacked_interval < 0)
+        continue;
+      paced_sender_->ResendPackets(
+          MakeFrame(VideoSsrc(session), nacked_interval,
+                    kVideoPacketsPerFrame),
+          dedup_info);
+      if (nacked_interval > 0) {
+        for (const auto& packet : MakeFrame(VideoSsrc(session),
+                                            nacked_interval - 1,
+                                            kVideoPacketsPerFrame)) {
+          paced_sender_->CancelSendingPacket(packet.first);
+        }
+      }
+    }
+    task_runner_->Sleep(kPacingInterval);
+  }
+  const double elapsed = (base::TimeTicks::Now() - start).InSecondsF();
+
+  perf_test::PerfResultReporter reporter(
+      "paced_sender", nack_storm ? "100_sessions_nack_storm" : "100_sessions");
+  reporter.RegisterImportantMetric("_packets_sent", "packets/s");
+  reporter.AddResult("_packets_sent", transport_.packets_sent() / elapsed);
+}
+
+INSTANTIATE_TEST_SUITE_P(All, PacedSenderPerfTest, testing::Bool());
+
+}  // namespace cast
+}  // namespace media
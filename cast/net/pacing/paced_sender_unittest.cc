@@ -124,7 +124,7 @@ class PacedSenderTest : public ::testing::Test {
       PacketKey key(frame_tick, audio ? kAudioSsrc : kVideoSsrc,
                     FrameId::first(), i);
 
-      PacketRef packet(new base::RefCountedData<Packet>);
+      PacketRef packet(new OutgoingPacket);
       packet->data.resize(packet_size, kValue);
       // Fill-in packet header fields to test the header parsing (for populating
       // the logging events).
@@ -188,7 +188,7 @@ TEST_F(PacedSenderTest, PassThroughRtcp) {
   mock_transport_.AddExpectedSizesAndPacketIds(kSize2, kRtcpPacketIdMagic, 1);
   Packet tmp(kSize2, kValue);
   EXPECT_TRUE(
-      paced_sender_->SendRtcpPacket(1, new base::RefCountedData<Packet>(tmp)));
+      paced_sender_->SendRtcpPacket(1, new OutgoingPacket(tmp)));
 }
 
 TEST_F(PacedSenderTest, BasicPace) {
@@ -236,6 +236,25 @@ TEST_F(PacedSenderTest, BasicPace) {
   }
 }
 
+TEST_F(PacedSenderTest, CanceledPacketsAreNotSent) {
+  SendPacketVector packets = CreateSendPacketVector(kSize1, 20, false);
+
+  // The first burst sends the first 10 packets.
+  mock_transport_.AddExpectedSizesAndPacketIds(kSize1, UINT16_C(0), 10);
+  EXPECT_TRUE(paced_sender_->SendPackets(packets));
+  EXPECT_TRUE(mock_transport_.expecting_nothing_else());
+
+  // Cancel three of the queued packets, and queue one of them again.
+  paced_sender_->CancelSendingPacket(packets[12].first);
+  paced_sender_->CancelSendingPacket(packets[15].first);
+  paced_sender_->CancelSendingPacket(packets[19].first);
+  EXPECT_TRUE(paced_sender_->SendPackets(SendPacketVector(1, packets[15])));
+
+  mock_transport_.AddExpectedSizesAndPacketIds(kSize1, UINT16_C(10), 2);
+  mock_transport_.AddExpectedSizesAndPacketIds(kSize1, UINT16_C(13), 6);
+  EXPECT_TRUE(RunUntilEmpty(3));
+}
+
 TEST_F(PacedSenderTest, PaceWithNack) {
   // Testing what happen when we get multiple NACK requests for a fully lost
   // frames just as we sent the first packets in a frame.
@@ -430,7 +449,7 @@ TEST_F(PacedSenderTest, SendPriority) {
 
   // Send RTCP packet. This is queued and will be sent first.
   EXPECT_TRUE(paced_sender_->SendRtcpPacket(
-      kVideoSsrc, new base::RefCountedData<Packet>(Packet(kSize3, kValue))));
+      kVideoSsrc, new OutgoingPacket(Packet(kSize3, kValue))));
 
   // Resend video packets. This is queued and will be sent
   // earlier than normal video packets.
@@ -536,5 +555,39 @@ TEST_F(PacedSenderTest, AllPacketsInSameFrameAreResentFairly) {
   ASSERT_TRUE(mock_transport_.expecting_nothing_else());
 }
 
+TEST_F(PacedSenderTest, DropsEnhancementLayerFramesBehindBaseLayer) {
+  SendPacketVector base_frame = CreateSendPacketVector(kSize1, 15, false);
+  SendPacketVector enhancement_frame =
+      CreateSendPacketVector(kSize2, 5, false);
+  for (auto& packet : enhancement_frame) {
+    packet.first.frame_id = FrameId::first() + 1;
+    packet.first.temporal_layer_id = 1;
+  }
+  SendPacketVector next_base_frame = CreateSendPacketVector(kSize3, 5, false);
+  for (auto& packet : next_base_frame)
+    packet.first.frame_id = FrameId::first() + 2;
+
+  // The first burst sends part of the base layer frame, and the enhancement
+  // layer frame is queued behind the rest.
+  mock_transport_.AddExpectedSizesAndPacketIds(kSize1, UINT16_C(0), 10);
+  EXPECT_TRUE(paced_sender_->SendPackets(base_frame));
+  EXPECT_TRUE(paced_sender_->SendPackets(enhancement_frame));
+
+  // The next base layer frame arrives before the enhancement layer frame could
+  // be sent, which is dropped.
+  EXPECT_TRUE(paced_sender_->SendPackets(next_base_frame));
+  mock_transport_.AddExpectedSizesAndPacketIds(kSize1, UINT16_C(10), 5);
+  mock_transport_.AddExpectedSizesAndPacketIds(kSize3, UINT16_C(0), 5);
+  EXPECT_TRUE(RunUntilEmpty(3));
+
+  // Its retransmission is rejected.
+  packet_events_.clear();
+  EXPECT_TRUE(paced_sender_->ResendPackets(enhancement_frame, DedupInfo()));
+  EXPECT_TRUE(RunUntilEmpty(3));
+  ASSERT_EQ(enhancement_frame.size(), packet_events_.size());
+  for (const PacketEvent& e : packet_events_)
+    EXPECT_EQ(PACKET_RTX_REJECTED, e.type);
+}
+
 }  // namespace cast
 }  // namespace media
@@ -145,7 +145,7 @@ void RtcpBuilder::AddRtcpHeader(RtcpPacketFields payload, int format_or_count) {
 }
 
 void RtcpBuilder::Start() {
-  packet_ = new base::RefCountedData<Packet>;
+  packet_ = new OutgoingPacket;
   packet_->data.resize(kMaxIpPacketSize);
   writer_ = base::BigEndianWriter(
       reinterpret_cast<char*>(&(packet_->data[0])), kMaxIpPacketSize);
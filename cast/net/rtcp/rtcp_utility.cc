@@ -31,6 +31,7 @@ RtcpParser::RtcpParser(uint32_t local_ssrc, uint32_t remote_ssrc)
     : local_ssrc_(local_ssrc),
       remote_ssrc_(remote_ssrc),
       has_sender_report_(false),
+      fraction_lost_(0),
       has_last_report_(false),
       has_cast_message_(false),
       has_cst2_message_(false),
@@ -180,8 +181,10 @@ bool RtcpParser::ParseRR(base::BigEndianReader* reader,
 
 bool RtcpParser::ParseReportBlock(base::BigEndianReader* reader) {
   uint32_t ssrc, last_report, delay;
+  uint8_t fraction_lost;
   if (!reader->ReadU32(&ssrc) ||
-      !reader->Skip(12) ||
+      !reader->ReadU8(&fraction_lost) ||
+      !reader->Skip(11) ||
       !reader->ReadU32(&last_report) ||
       !reader->ReadU32(&delay))
     return false;
@@ -189,6 +192,7 @@ bool RtcpParser::ParseReportBlock(base::BigEndianReader* reader) {
   if (ssrc == local_ssrc_) {
     last_report_ = last_report;
     delay_since_last_report_ = delay;
+    fraction_lost_ = fraction_lost;
     has_last_report_ = true;
   }
 
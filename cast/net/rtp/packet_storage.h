@@ -24,7 +24,8 @@ class PacketStorage {
 
   virtual ~PacketStorage();
 
-  // Store all of the packets for a frame.
+  // Store all of the packets for a frame. The packets' headers are kept
+  // along with a reference to the frame's payload, which they share.
   void StoreFrame(FrameId frame_id, const SendPacketVector& packets);
 
   // Release all of the packets for a frame.
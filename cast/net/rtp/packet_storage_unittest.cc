@@ -35,7 +35,7 @@ static void StoreFrames(int number_of_frames,
       packets.push_back(
           std::make_pair(PacketKey(base::TimeTicks(), kSsrc, first_frame_id + i,
                                    base::checked_cast<uint16_t>(j)),
-                         new base::RefCountedData<Packet>(test_packet)));
+                         new OutgoingPacket(test_packet)));
     }
     storage->StoreFrame(first_frame_id, packets);
     ++first_frame_id;
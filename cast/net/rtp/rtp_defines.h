@@ -27,6 +27,11 @@ static const uint8_t kCastExtensionCountmask = 0x3f;
 
 // Cast RTP extensions.
 static const uint8_t kCastRtpExtensionAdaptiveLatency = 1;
+static const uint8_t kCastRtpExtensionFec = 2;
+
+// Sizes of the extensions, including their type and size fields.
+static const uint16_t kCastRtpExtensionAdaptiveLatencyLength = 4;
+static const uint16_t kCastRtpExtensionFecLength = 8;
 
 struct RtpCastHeader {
   RtpCastHeader();
@@ -47,6 +52,15 @@ struct RtpCastHeader {
   FrameId reference_frame_id;
   uint16_t new_playout_delay_ms;
   uint8_t num_extensions;
+
+  // Set for the XOR parity packets of a frame (see rtp_fec.h), which protect
+  // the |fec_num_packets| data packets starting at |fec_first_packet_id|.
+  // |fec_length_recovery| is the XOR of their payload sizes. Parity packets
+  // have |packet_id|s above |max_packet_id|.
+  bool is_fec;
+  uint16_t fec_first_packet_id;
+  uint16_t fec_num_packets;
+  uint16_t fec_length_recovery;
 };
 
 class RtpPayloadFeedback {
@@ -0,0 +1,49 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/cast/net/rtp/rtp_fec.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/cxx17_backports.h"
+
+namespace media {
+namespace cast {
+
+namespace {
+
+// Below this loss rate, retransmissions alone recover losses well enough.
+constexpr double kMinFecPacketLoss = 0.005;
+
+// With a group of k data packets and one parity packet, a group is only lost
+// to retransmission when two or more of its k + 1 packets are lost. Sizing
+// groups at about 1 / (3 * loss) keeps that below ~5% of the groups at the
+// loss rates Cast sees, for an overhead of about three times the loss rate.
+constexpr double kGroupSizeTimesLoss = 1.0 / 3;
+constexpr int kMinGroupSize = 2;
+constexpr int kMaxGroupSize = 24;
+
+}  // namespace
+
+int FecGroupSizeForPacketLoss(double fraction_lost) {
+  if (fraction_lost < kMinFecPacketLoss)
+    return 0;
+  const int group_size =
+      static_cast<int>(std::floor(kGroupSizeTimesLoss / fraction_lost));
+  return base::clamp(group_size, kMinGroupSize, kMaxGroupSize);
+}
+
+void XorIntoParity(const uint8_t* data,
+                   size_t size,
+                   std::vector<uint8_t>* parity) {
+  if (parity->size() < size)
+    parity->resize(size, 0);
+  uint8_t* const out = parity->data();
+  for (size_t i = 0; i < size; ++i)
+    out[i] ^= data[i];
+}
+
+}  // namespace cast
+}  // namespace media
@@ -0,0 +1,43 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Forward error correction for Cast RTP streams.
+//
+// A sender may follow the data packets of a frame with XOR parity packets, so
+// that a receiver can rebuild a lost packet without waiting a round trip for
+// its retransmission. Each parity packet protects a run of consecutive data
+// packets of one frame: its payload is the XOR of their payloads, each
+// zero-padded to the longest, and its kCastRtpExtensionFec header extension
+// carries the run and the XOR of the payload sizes. Any one packet of the run
+// can be rebuilt from the parity packet and the others.
+//
+// Parity packets use packet IDs above the frame's max_packet_id, which
+// receivers without FEC support reject. They are never retransmitted.
+
+#ifndef MEDIA_CAST_NET_RTP_RTP_FEC_H_
+#define MEDIA_CAST_NET_RTP_RTP_FEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace media {
+namespace cast {
+
+// Returns how many data packets each parity packet should protect, given the
+// fraction of packets the receiver reports lost, or 0 if the loss is too low
+// for FEC to be worth its overhead.
+int FecGroupSizeForPacketLoss(double fraction_lost);
+
+// XORs the |size| bytes at |data| into |parity|, first zero-extending
+// |parity| if it is shorter.
+void XorIntoParity(const uint8_t* data,
+                   size_t size,
+                   std::vector<uint8_t>* parity);
+
+}  // namespace cast
+}  // namespace media
+
+#endif  // MEDIA_CAST_NET_RTP_RTP_FEC_H_
@@ -20,7 +20,11 @@ RtpPacketBuilder::RtpPacketBuilder()
       sequence_number_(0),
       marker_(false),
       payload_type_(0),
-      ssrc_(0) {}
+      ssrc_(0),
+      is_fec_(false),
+      fec_first_packet_id_(0),
+      fec_num_packets_(0),
+      fec_length_recovery_(0) {}
 
 void RtpPacketBuilder::SetKeyFrame(bool is_key) { is_key_ = is_key; }
 
@@ -56,6 +60,15 @@ void RtpPacketBuilder::SetSsrc(uint32_t ssrc) {
   ssrc_ = ssrc;
 }
 
+void RtpPacketBuilder::SetFec(uint16_t first_packet_id,
+                              uint16_t num_packets,
+                              uint16_t length_recovery) {
+  is_fec_ = true;
+  fec_first_packet_id_ = first_packet_id;
+  fec_num_packets_ = num_packets;
+  fec_length_recovery_ = length_recovery;
+}
+
 void RtpPacketBuilder::BuildHeader(uint8_t* data, uint32_t data_length) {
   BuildCommonHeader(data, data_length);
   BuildCastHeader(data + kRtpHeaderLength, data_length - kRtpHeaderLength);
@@ -71,13 +84,21 @@ void RtpPacketBuilder::BuildCastHeader(uint8_t* data, uint32_t data_length) {
       (is_key_ && (reference_frame_id_ != frame_id_)) ||
       (!is_key_ && (reference_frame_id_ != (frame_id_ - 1)));
   big_endian_writer.WriteU8((is_key_ ? 0x80 : 0) |
-                            (includes_specific_frame_reference ? 0x40 : 0));
+                            (includes_specific_frame_reference ? 0x40 : 0) |
+                            (is_fec_ ? 1 : 0));
   big_endian_writer.WriteU8(frame_id_);
   big_endian_writer.WriteU16(packet_id_);
   big_endian_writer.WriteU16(max_packet_id_);
   if (includes_specific_frame_reference) {
     big_endian_writer.WriteU8(reference_frame_id_);
   }
+  if (is_fec_) {
+    big_endian_writer.WriteU16((kCastRtpExtensionFec << 10) |
+                               (kCastRtpExtensionFecLength - 2));
+    big_endian_writer.WriteU16(fec_first_packet_id_);
+    big_endian_writer.WriteU16(fec_num_packets_);
+    big_endian_writer.WriteU16(fec_length_recovery_);
+  }
 }
 
 void RtpPacketBuilder::BuildCommonHeader(uint8_t* data, uint32_t data_length) {
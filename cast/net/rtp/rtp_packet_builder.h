@@ -33,6 +33,10 @@ class RtpPacketBuilder {
   void SetMarkerBit(bool marker);
   void SetPayloadType(int payload_type);
   void SetSsrc(uint32_t ssrc);
+  // Makes the packet an FEC parity packet, with the FEC extension.
+  void SetFec(uint16_t first_packet_id,
+              uint16_t num_packets,
+              uint16_t length_recovery);
   void BuildHeader(uint8_t* data, uint32_t data_length);
 
  private:
@@ -46,6 +50,10 @@ class RtpPacketBuilder {
   bool marker_;
   int payload_type_;
   uint32_t ssrc_;
+  bool is_fec_;
+  uint16_t fec_first_packet_id_;
+  uint16_t fec_num_packets_;
+  uint16_t fec_length_recovery_;
 
   void BuildCastHeader(uint8_t* data, uint32_t data_length);
   void BuildCommonHeader(uint8_t* data, uint32_t data_length);
@@ -4,12 +4,13 @@
 
 #include "media/cast/net/rtp/rtp_packetizer.h"
 
-#include <string>
+#include <utility>
 
 #include "base/big_endian.h"
 #include "base/check_op.h"
 #include "media/cast/net/pacing/paced_sender.h"
 #include "media/cast/net/rtp/rtp_defines.h"
+#include "media/cast/net/rtp/rtp_fec.h"
 
 namespace media {
 namespace cast {
@@ -18,7 +19,8 @@ RtpPacketizerConfig::RtpPacketizerConfig()
     : payload_type(-1),
       max_payload_length(kMaxIpPacketSize - 28),  // Default is IP-v4/UDP.
       sequence_number(0),
-      ssrc(0) {}
+      ssrc(0),
+      enable_fec(false) {}
 
 RtpPacketizerConfig::~RtpPacketizerConfig() = default;
 
@@ -29,6 +31,8 @@ RtpPacketizer::RtpPacketizer(PacedSender* const transport,
       transport_(transport),
       packet_storage_(packet_storage),
       sequence_number_(config_.sequence_number),
+      packet_loss_(0),
+      fec_group_size_(0),
       send_packet_count_(0),
       send_octet_count_(0) {
   DCHECK(transport) << "Invalid argument";
@@ -41,19 +45,43 @@ uint16_t RtpPacketizer::NextSequenceNumber() {
   return sequence_number_ - 1;
 }
 
-void RtpPacketizer::SendFrameAsPackets(const EncodedFrame& frame) {
+void RtpPacketizer::OnReceivedPacketLoss(double fraction_lost) {
+  if (!config_.enable_fec)
+    return;
+  // Receiver reports cover short intervals; smooth them so that a single
+  // burst does not switch FEC on and off.
+  packet_loss_ = (3 * packet_loss_ + fraction_lost) / 4;
+  fec_group_size_ = FecGroupSizeForPacketLoss(packet_loss_);
+}
+
+void RtpPacketizer::SendFrameAsPackets(
+    const EncodedFrame& frame,
+    scoped_refptr<base::RefCountedMemory> payload) {
+  DCHECK(payload);
+  const size_t frame_size = payload->size();
   uint16_t rtp_header_length = kRtpHeaderLength + kCastHeaderLength;
+  // Parity packets are as large as the largest data packet plus their header
+  // extensions; leave room for these when they may be sent.
+  if (config_.enable_fec) {
+    rtp_header_length += kCastRtpExtensionFecLength;
+    if (frame.new_playout_delay_ms)
+      rtp_header_length += kCastRtpExtensionAdaptiveLatencyLength;
+  }
   uint16_t max_length = config_.max_payload_length - rtp_header_length - 1;
 
   // Split the payload evenly (round number up).
-  size_t num_packets = (frame.data.size() + max_length) / max_length;
-  size_t payload_length = (frame.data.size() + num_packets) / num_packets;
+  size_t num_packets = (frame_size + max_length) / max_length;
+  size_t payload_length = (frame_size + num_packets) / num_packets;
   DCHECK_LE(payload_length, max_length) << "Invalid argument";
 
   SendPacketVector packets;
+  SendPacketVector fec_packets;
+  std::vector<uint8_t> parity;
+  uint16_t fec_first_packet_id = 0;
+  uint16_t fec_length_recovery = 0;
 
-  size_t remaining_size = frame.data.size();
-  std::string::const_iterator data_iter = frame.data.begin();
+  size_t remaining_size = frame_size;
+  size_t payload_offset = 0;
 
   uint8_t num_extensions = 0;
   if (frame.new_playout_delay_ms)
@@ -61,12 +89,16 @@ void RtpPacketizer::SendFrameAsPackets(const EncodedFrame& frame) {
   DCHECK_LE(num_extensions, kCastExtensionCountmask);
 
   while (remaining_size > 0) {
-    PacketRef packet(new base::RefCountedData<Packet>);
-
     if (remaining_size < payload_length) {
       payload_length = remaining_size;
     }
     remaining_size -= payload_length;
+
+    // The packet only holds its headers, and points into |payload| for the
+    // rest.
+    PacketRef packet = base::MakeRefCounted<OutgoingPacket>(
+        Packet(), payload, payload_offset, payload_length);
+    payload_offset += payload_length;
     BuildCommonRTPheader(
         &packet->data, remaining_size == 0, frame.rtp_timestamp);
 
@@ -98,15 +130,32 @@ void RtpPacketizer::SendFrameAsPackets(const EncodedFrame& frame) {
       packet->data.push_back(static_cast<uint8_t>(frame.new_playout_delay_ms));
     }
 
-    // Copy payload data.
-    packet->data.insert(packet->data.end(),
-                        data_iter,
-                        data_iter + payload_length);
-    data_iter += payload_length;
+    if (fec_group_size_ > 0) {
+      const base::span<const uint8_t> packet_payload = packet->payload_span();
+      XorIntoParity(packet_payload.data(), payload_length, &parity);
+      fec_length_recovery ^= static_cast<uint16_t>(payload_length);
+      const uint16_t num_protected = packet_id - fec_first_packet_id + 1;
+      if (num_protected == fec_group_size_ || remaining_size == 0) {
+        const uint16_t fec_packet_id =
+            static_cast<uint16_t>(num_packets + fec_packets.size());
+        fec_packets.push_back(make_pair(
+            PacketKey(frame.reference_time, config_.ssrc, frame.frame_id,
+                      fec_packet_id, frame.temporal_layer_id),
+            BuildFecPacket(frame, fec_packet_id, num_packets,
+                           fec_first_packet_id, num_protected,
+                           fec_length_recovery, parity)));
+        ++send_packet_count_;
+        send_octet_count_ += parity.size();
+        parity.clear();
+        fec_first_packet_id = packet_id + 1;
+        fec_length_recovery = 0;
+      }
+    }
 
-    packets.push_back(make_pair(PacketKey(frame.reference_time, config_.ssrc,
-                                          frame.frame_id, packet_id),
-                                packet));
+    packets.push_back(
+        make_pair(PacketKey(frame.reference_time, config_.ssrc,
+                            frame.frame_id, packet_id, frame.temporal_layer_id),
+                  packet));
 
     // Update stats.
     ++send_packet_count_;
@@ -116,10 +165,58 @@ void RtpPacketizer::SendFrameAsPackets(const EncodedFrame& frame) {
 
   packet_storage_->StoreFrame(frame.frame_id, packets);
 
-  // Send to network.
+  // Send to network. Parity packets go last: they are only useful once the
+  // packets they protect have been sent, and are not stored for
+  // retransmission.
+  packets.insert(packets.end(), fec_packets.begin(), fec_packets.end());
   transport_->SendPackets(packets);
 }
 
+PacketRef RtpPacketizer::BuildFecPacket(const EncodedFrame& frame,
+                                        uint16_t packet_id,
+                                        size_t num_packets,
+                                        uint16_t first_packet_id,
+                                        uint16_t num_protected,
+                                        uint16_t length_recovery,
+                                        const std::vector<uint8_t>& parity) {
+  PacketRef packet = base::MakeRefCounted<OutgoingPacket>();
+  BuildCommonRTPheader(&packet->data, false, frame.rtp_timestamp);
+
+  // The Cast header matches that of the frame's first data packet, except that
+  // the packet ID is above the max packet ID and the FEC extension is present.
+  // Repeating the playout delay lets the receiver recover the first packet
+  // without losing it.
+  const uint8_t num_extensions = frame.new_playout_delay_ms ? 2 : 1;
+  uint8_t byte0 = kCastReferenceFrameIdBitMask | num_extensions;
+  if (frame.dependency == EncodedFrame::KEY)
+    byte0 |= kCastKeyFrameBitMask;
+  packet->data.push_back(byte0);
+  packet->data.push_back(frame.frame_id.lower_8_bits());
+  const size_t start_size = packet->data.size();
+  size_t header_size = 4 + 1 + kCastRtpExtensionFecLength;
+  if (frame.new_playout_delay_ms)
+    header_size += kCastRtpExtensionAdaptiveLatencyLength;
+  packet->data.resize(start_size + header_size);
+  base::BigEndianWriter big_endian_writer(
+      reinterpret_cast<char*>(&(packet->data[start_size])), header_size);
+  big_endian_writer.WriteU16(packet_id);
+  big_endian_writer.WriteU16(static_cast<uint16_t>(num_packets - 1));
+  big_endian_writer.WriteU8(frame.referenced_frame_id.lower_8_bits());
+  if (frame.new_playout_delay_ms) {
+    big_endian_writer.WriteU16((kCastRtpExtensionAdaptiveLatency << 10) |
+                               (kCastRtpExtensionAdaptiveLatencyLength - 2));
+    big_endian_writer.WriteU16(frame.new_playout_delay_ms);
+  }
+  big_endian_writer.WriteU16((kCastRtpExtensionFec << 10) |
+                             (kCastRtpExtensionFecLength - 2));
+  big_endian_writer.WriteU16(first_packet_id);
+  big_endian_writer.WriteU16(num_protected);
+  big_endian_writer.WriteU16(length_recovery);
+
+  packet->data.insert(packet->data.end(), parity.begin(), parity.end());
+  return packet;
+}
+
 void RtpPacketizer::BuildCommonRTPheader(Packet* packet,
                                          bool marker_bit,
                                          RtpTimeTicks rtp_timestamp) {
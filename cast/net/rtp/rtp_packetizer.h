@@ -9,7 +9,9 @@
 #include <stdint.h>
 
 #include <cmath>
+#include <vector>
 
+#include "base/memory/ref_counted_memory.h"
 #include "media/cast/common/rtp_time.h"
 #include "media/cast/net/rtp/packet_storage.h"
 
@@ -29,6 +31,10 @@ struct RtpPacketizerConfig {
 
   // SSRC.
   unsigned int ssrc;
+
+  // Whether to follow frames with XOR parity packets (see rtp_fec.h) when the
+  // receiver reports packet loss. The receiver must support them.
+  bool enable_fec;
 };
 
 // This object is only called from the main cast thread.
@@ -41,7 +47,15 @@ class RtpPacketizer {
                 RtpPacketizerConfig rtp_packetizer_config);
   ~RtpPacketizer();
 
-  void SendFrameAsPackets(const EncodedFrame& frame);
+  // Sends |frame| with |payload| in place of its data, which is ignored. The
+  // packets, and the PacketStorage, point into |payload| rather than each
+  // holding a copy of their part of it.
+  void SendFrameAsPackets(const EncodedFrame& frame,
+                          scoped_refptr<base::RefCountedMemory> payload);
+
+  // Called with the fraction of packets lost reported by the receiver. Sets
+  // how much FEC, if enabled, protects the following frames.
+  void OnReceivedPacketLoss(double fraction_lost);
 
   // Return the next sequence number, and increment by one. Enables unique
   // incremental sequence numbers for every packet (including retransmissions).
@@ -55,12 +69,27 @@ class RtpPacketizer {
                             bool marker_bit,
                             RtpTimeTicks rtp_timestamp);
 
+  // Builds the parity packet protecting the |num_protected| data packets from
+  // |first_packet_id| of |frame|, which has |num_packets| data packets.
+  PacketRef BuildFecPacket(const EncodedFrame& frame,
+                           uint16_t packet_id,
+                           size_t num_packets,
+                           uint16_t first_packet_id,
+                           uint16_t num_protected,
+                           uint16_t length_recovery,
+                           const std::vector<uint8_t>& parity);
+
   RtpPacketizerConfig config_;
   PacedSender* const transport_;  // Not owned by this class.
   PacketStorage* packet_storage_;
 
   uint16_t sequence_number_;
 
+  // Smoothed fraction of packets lost, and the resulting number of data
+  // packets per parity packet; 0 when no parity packets are sent.
+  double packet_loss_;
+  int fec_group_size_;
+
   size_t send_packet_count_;
   size_t send_octet_count_;
 };
@@ -8,12 +8,16 @@
 #include <stdint.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/test/simple_test_tick_clock.h"
 #include "media/base/fake_single_thread_task_runner.h"
 #include "media/cast/net/pacing/paced_sender.h"
 #include "media/cast/net/rtp/packet_storage.h"
+#include "media/cast/net/rtp/rtp_fec.h"
 #include "media/cast/net/rtp/rtp_parser.h"
 #include "testing/gmock/include/gmock/gmock.h"
 
@@ -62,7 +66,7 @@ class TestRtpPacketTransport : public PacketTransport {
     EXPECT_EQ(expected_number_of_packets_ - 1, rtp_header.max_packet_id);
     EXPECT_TRUE(rtp_header.is_reference);
     EXPECT_EQ(expected_frame_id_ - 1, rtp_header.reference_frame_id);
-    if (rtp_header.packet_id != 0) {
+    if (rtp_header.packet_id != 0 && !rtp_header.is_fec) {
       EXPECT_EQ(rtp_header.num_extensions, 0)
           << "Extensions only allowed on first packet of a frame";
     }
@@ -74,9 +78,24 @@ class TestRtpPacketTransport : public PacketTransport {
     RtpCastHeader rtp_header;
     const uint8_t* payload_data;
     size_t payload_size;
-    parser.ParsePacket(&packet->data[0], packet->data.size(), &rtp_header,
-                       &payload_data, &payload_size);
+    const Packet wire_packet = packet->ToPacket();
+    EXPECT_TRUE(parser.ParsePacket(&wire_packet[0], wire_packet.size(),
+                                   &rtp_header, &payload_data, &payload_size));
+    if (rtp_header.is_fec) {
+      // Parity packets follow all of the frame's data packets.
+      VerifyCommonRtpHeader(rtp_header);
+      EXPECT_FALSE(rtp_header.marker);
+      EXPECT_EQ(expected_frame_id_, rtp_header.frame_id);
+      EXPECT_EQ(expected_number_of_packets_, data_payloads_.size());
+      EXPECT_EQ(expected_number_of_packets_ + fec_headers_.size(),
+                rtp_header.packet_id);
+      fec_headers_.push_back(rtp_header);
+      fec_payloads_.emplace_back(payload_data, payload_data + payload_size);
+      ++sequence_number_;
+      return true;
+    }
     VerifyRtpHeader(rtp_header);
+    data_payloads_.emplace_back(payload_data, payload_data + payload_size);
     ++sequence_number_;
     ++expected_packet_id_;
     return true;
@@ -99,6 +118,9 @@ class TestRtpPacketTransport : public PacketTransport {
   }
 
   RtpPacketizerConfig config_;
+  std::vector<std::vector<uint8_t>> data_payloads_;
+  std::vector<RtpCastHeader> fec_headers_;
+  std::vector<std::vector<uint8_t>> fec_payloads_;
   uint32_t sequence_number_;
   size_t packets_sent_;
   size_t number_of_packets_;
@@ -135,6 +157,13 @@ class RtpPacketizerTest : public ::testing::Test {
     video_frame_.rtp_timestamp = RtpTimeTicks().Expand(UINT32_C(0x0055aa11));
   }
 
+  // Sends |video_frame_| with a copy of its data as the payload.
+  void SendVideoFrame() {
+    std::string payload = video_frame_.data;
+    rtp_packetizer_->SendFrameAsPackets(
+        video_frame_, base::RefCountedString::TakeString(&payload));
+  }
+
   void RunTasks(int during_ms) {
     for (int i = 0; i < during_ms; ++i) {
       // Call process the timers every 1 ms.
@@ -160,7 +189,7 @@ TEST_F(RtpPacketizerTest, SendStandardPackets) {
 
   testing_clock_.Advance(base::Milliseconds(kTimestampMs));
   video_frame_.reference_time = testing_clock_.NowTicks();
-  rtp_packetizer_->SendFrameAsPackets(video_frame_);
+  SendVideoFrame();
   RunTasks(33 + 1);
   EXPECT_EQ(expected_num_of_packets, transport_->number_of_packets_received());
 }
@@ -173,7 +202,7 @@ TEST_F(RtpPacketizerTest, SendPacketsWithAdaptivePlayoutExtension) {
   testing_clock_.Advance(base::Milliseconds(kTimestampMs));
   video_frame_.reference_time = testing_clock_.NowTicks();
   video_frame_.new_playout_delay_ms = 500;
-  rtp_packetizer_->SendFrameAsPackets(video_frame_);
+  SendVideoFrame();
   RunTasks(33 + 1);
   EXPECT_EQ(expected_num_of_packets, transport_->number_of_packets_received());
 }
@@ -188,12 +217,126 @@ TEST_F(RtpPacketizerTest, Stats) {
 
   testing_clock_.Advance(base::Milliseconds(kTimestampMs));
   video_frame_.reference_time = testing_clock_.NowTicks();
-  rtp_packetizer_->SendFrameAsPackets(video_frame_);
+  SendVideoFrame();
   RunTasks(33 + 1);
   EXPECT_EQ(expected_num_of_packets, rtp_packetizer_->send_packet_count());
   EXPECT_EQ(kFrameSize, rtp_packetizer_->send_octet_count());
   EXPECT_EQ(expected_num_of_packets, transport_->number_of_packets_received());
 }
 
+TEST_F(RtpPacketizerTest, NoFecWithoutPacketLoss) {
+  config_.enable_fec = true;
+  rtp_packetizer_ = std::make_unique<RtpPacketizer>(
+      pacer_.get(), &packet_storage_, config_);
+  rtp_packetizer_->OnReceivedPacketLoss(0);
+
+  const size_t max_length = kMaxPacketLength - kRtpHeaderLength -
+                            kCastHeaderLength - kCastRtpExtensionFecLength - 1;
+  const size_t expected_num_of_packets = kFrameSize / max_length + 1;
+  transport_->set_expected_number_of_packets(expected_num_of_packets);
+  transport_->set_rtp_timestamp(video_frame_.rtp_timestamp);
+
+  testing_clock_.Advance(base::Milliseconds(kTimestampMs));
+  video_frame_.reference_time = testing_clock_.NowTicks();
+  SendVideoFrame();
+  RunTasks(33 + 1);
+  EXPECT_EQ(expected_num_of_packets, transport_->number_of_packets_received());
+  EXPECT_TRUE(transport_->fec_headers_.empty());
+}
+
+TEST_F(RtpPacketizerTest, SendFecPacketsWhenLossIsReported) {
+  config_.enable_fec = true;
+  rtp_packetizer_ = std::make_unique<RtpPacketizer>(
+      pacer_.get(), &packet_storage_, config_);
+  // Settle on a 10% loss rate, which is protected by one parity packet for
+  // every three data packets.
+  for (int i = 0; i < 10; ++i)
+    rtp_packetizer_->OnReceivedPacketLoss(0.1);
+
+  const size_t max_length = kMaxPacketLength - kRtpHeaderLength -
+                            kCastHeaderLength - kCastRtpExtensionFecLength - 1;
+  const size_t expected_num_of_packets = kFrameSize / max_length + 1;
+  transport_->set_expected_number_of_packets(expected_num_of_packets);
+  transport_->set_rtp_timestamp(video_frame_.rtp_timestamp);
+  for (size_t i = 0; i < kFrameSize; ++i)
+    video_frame_.data[i] = static_cast<char>(i * 7);
+
+  testing_clock_.Advance(base::Milliseconds(kTimestampMs));
+  video_frame_.reference_time = testing_clock_.NowTicks();
+  SendVideoFrame();
+  RunTasks(33 + 1);
+
+  const size_t expected_num_of_fec_packets = (expected_num_of_packets + 2) / 3;
+  ASSERT_EQ(expected_num_of_packets, transport_->data_payloads_.size());
+  ASSERT_EQ(expected_num_of_fec_packets, transport_->fec_headers_.size());
+  EXPECT_EQ(expected_num_of_packets + expected_num_of_fec_packets,
+            rtp_packetizer_->send_packet_count());
+
+  // Only the data packets are kept for retransmission.
+  const SendPacketVector* stored_packets =
+      packet_storage_.GetFramePackets(video_frame_.frame_id);
+  ASSERT_TRUE(stored_packets);
+  EXPECT_EQ(expected_num_of_packets, stored_packets->size());
+
+  // Each parity packet is the XOR of the data packets it protects.
+  uint16_t next_protected_packet_id = 0;
+  for (size_t i = 0; i < expected_num_of_fec_packets; ++i) {
+    const RtpCastHeader& header = transport_->fec_headers_[i];
+    EXPECT_EQ(next_protected_packet_id, header.fec_first_packet_id);
+    std::vector<uint8_t> parity;
+    uint16_t length_recovery = 0;
+    for (int id = header.fec_first_packet_id;
+         id < header.fec_first_packet_id + header.fec_num_packets; ++id) {
+      const std::vector<uint8_t>& payload = transport_->data_payloads_[id];
+      XorIntoParity(payload.data(), payload.size(), &parity);
+      length_recovery ^= static_cast<uint16_t>(payload.size());
+    }
+    EXPECT_EQ(parity, transport_->fec_payloads_[i]);
+    EXPECT_EQ(length_recovery, header.fec_length_recovery);
+    next_protected_packet_id += header.fec_num_packets;
+  }
+  EXPECT_EQ(expected_num_of_packets, next_protected_packet_id);
+}
+
+TEST_F(RtpPacketizerTest, PacketsShareThePayloadBuffer) {
+  size_t expected_num_of_packets = kFrameSize / kMaxPacketLength + 1;
+  transport_->set_expected_number_of_packets(expected_num_of_packets);
+  transport_->set_rtp_timestamp(video_frame_.rtp_timestamp);
+  for (size_t i = 0; i < kFrameSize; ++i)
+    video_frame_.data[i] = static_cast<char>(i * 7);
+  auto payload = base::MakeRefCounted<base::RefCountedBytes>(
+      reinterpret_cast<const uint8_t*>(video_frame_.data.data()),
+      video_frame_.data.size());
+
+  testing_clock_.Advance(base::Milliseconds(kTimestampMs));
+  video_frame_.reference_time = testing_clock_.NowTicks();
+  rtp_packetizer_->SendFrameAsPackets(video_frame_, payload);
+  RunTasks(33 + 1);
+  EXPECT_EQ(expected_num_of_packets, transport_->number_of_packets_received());
+
+  // The stored packets hold only their headers, and point into consecutive
+  // parts of the caller's buffer rather than copies of it.
+  const SendPacketVector* stored_packets =
+      packet_storage_.GetFramePackets(video_frame_.frame_id);
+  ASSERT_TRUE(stored_packets);
+  ASSERT_EQ(expected_num_of_packets, stored_packets->size());
+  size_t offset = 0;
+  for (size_t i = 0; i < stored_packets->size(); ++i) {
+    const OutgoingPacket& packet = *(*stored_packets)[i].second;
+    EXPECT_EQ(payload, packet.payload);
+    EXPECT_EQ(offset, packet.payload_offset);
+    EXPECT_LE(packet.data.size(),
+              static_cast<size_t>(kRtpHeaderLength + kCastHeaderLength));
+    offset += packet.payload_size;
+
+    // What went out on the wire is the headers followed by that payload.
+    const std::vector<uint8_t>& sent_payload = transport_->data_payloads_[i];
+    EXPECT_EQ(std::vector<uint8_t>(packet.payload_span().begin(),
+                                   packet.payload_span().end()),
+              sent_payload);
+  }
+  EXPECT_EQ(kFrameSize, offset);
+}
+
 }  // namespace cast
 }  // namespace media
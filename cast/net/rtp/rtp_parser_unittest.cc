@@ -123,6 +123,49 @@ TEST_F(RtpParserTest, MaxPacketId) {
   ExpectParsesPacket();
 }
 
+TEST_F(RtpParserTest, ParseFecPacket) {
+  packet_builder_.SetFrameIds(10, 9);
+  packet_builder_.SetPacketId(16);
+  packet_builder_.SetMaxPacketId(15);
+  packet_builder_.SetFec(12, 4, 0x1234);
+  packet_builder_.SetMarkerBit(false);
+  packet_builder_.BuildHeader(packet_, kPacketLength);
+  cast_header_.frame_id = FrameId::first() + 10;
+  cast_header_.reference_frame_id = FrameId::first() + 9;
+  cast_header_.packet_id = 16;
+  cast_header_.max_packet_id = 15;
+  cast_header_.marker = false;
+  ExpectParsesPacket();
+
+  RtpCastHeader parsed_header;
+  const uint8_t* payload = NULL;
+  size_t payload_size = 0;
+  ASSERT_TRUE(rtp_parser_.ParsePacket(packet_, kPacketLength, &parsed_header,
+                                      &payload, &payload_size));
+  EXPECT_TRUE(parsed_header.is_fec);
+  EXPECT_EQ(12, parsed_header.fec_first_packet_id);
+  EXPECT_EQ(4, parsed_header.fec_num_packets);
+  EXPECT_EQ(0x1234, parsed_header.fec_length_recovery);
+  EXPECT_EQ(kPacketLength - kRtpHeaderLength - kCastHeaderLength -
+                kCastRtpExtensionFecLength,
+            payload_size);
+}
+
+TEST_F(RtpParserTest, FecPacketMustProtectDataPackets) {
+  packet_builder_.SetFrameIds(10, 9);
+  packet_builder_.SetPacketId(16);
+  packet_builder_.SetMaxPacketId(15);
+  packet_builder_.SetFec(14, 3, 0);
+  packet_builder_.BuildHeader(packet_, kPacketLength);
+  ExpectDoesNotParsePacket();
+
+  // Parity packet IDs must be above the max packet ID.
+  packet_builder_.SetPacketId(15);
+  packet_builder_.SetFec(14, 2, 0);
+  packet_builder_.BuildHeader(packet_, kPacketLength);
+  ExpectDoesNotParsePacket();
+}
+
 TEST_F(RtpParserTest, InvalidPayloadType) {
   packet_builder_.SetKeyFrame(true);
   packet_builder_.SetFrameIds(10, 10);
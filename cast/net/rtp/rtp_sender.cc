@@ -5,6 +5,7 @@
 #include "media/cast/net/rtp/rtp_sender.h"
 
 #include <memory>
+#include <utility>
 
 #include "base/big_endian.h"
 #include "base/logging.h"
@@ -18,11 +19,12 @@ namespace {
 
 // If there is only one referecne to the packet then copy the
 // reference and return.
-// Otherwise return a deep copy of the packet.
+// Otherwise return a copy of the packet's headers, which still shares the
+// frame's payload.
 PacketRef FastCopyPacket(const PacketRef& packet) {
   if (packet->HasOneRef())
     return packet;
-  return base::WrapRefCounted(new base::RefCountedData<Packet>(packet->data));
+  return packet->CopyHeaders();
 }
 
 }  // namespace
@@ -47,17 +49,24 @@ bool RtpSender::Initialize(const CastTransportRtpConfig& config) {
     config_.payload_type = 127;
   else
     config_.payload_type = 96;
+  config_.enable_fec = config.enable_fec;
   packetizer_ = std::make_unique<RtpPacketizer>(transport_, &storage_, config_);
   return true;
 }
 
-void RtpSender::SendFrame(const EncodedFrame& frame) {
+void RtpSender::SendFrame(const EncodedFrame& frame,
+                          scoped_refptr<base::RefCountedMemory> payload) {
   DCHECK(packetizer_);
-  packetizer_->SendFrameAsPackets(frame);
+  packetizer_->SendFrameAsPackets(frame, std::move(payload));
   LOG_IF(DFATAL, storage_.GetNumberOfStoredFrames() > kMaxUnackedFrames)
       << "Possible bug: Frames are not being actively released from storage.";
 }
 
+void RtpSender::OnReceivedPacketLoss(double fraction_lost) {
+  DCHECK(packetizer_);
+  packetizer_->OnReceivedPacketLoss(fraction_lost);
+}
+
 void RtpSender::ResendPackets(
     const MissingFramesAndPacketsMap& missing_frames_and_packets,
     bool cancel_rtx_if_not_in_list, const DedupInfo& dedup_info) {
@@ -15,6 +15,7 @@
 #include <set>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/weak_ptr.h"
 #include "base/time/time.h"
 #include "media/cast/cast_environment.h"
@@ -46,7 +47,13 @@ class RtpSender {
   // configuration is invalid.
   bool Initialize(const CastTransportRtpConfig& config);
 
-  void SendFrame(const EncodedFrame& frame);
+  // Sends |frame| with |payload| in place of its data. See
+  // RtpPacketizer::SendFrameAsPackets().
+  void SendFrame(const EncodedFrame& frame,
+                 scoped_refptr<base::RefCountedMemory> payload);
+
+  // Called with the fraction of packets lost from each receiver report.
+  void OnReceivedPacketLoss(double fraction_lost);
 
   void ResendPackets(const MissingFramesAndPacketsMap& missing_packets,
                      bool cancel_rtx_if_not_in_list,
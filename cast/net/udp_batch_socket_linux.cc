@@ -0,0 +1,306 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/cast/net/udp_batch_socket_linux.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/check.h"
+#include "base/posix/eintr_wrapper.h"
+#include "net/base/net_errors.h"
+#include "net/base/sockaddr_storage.h"
+
+// Older kernel headers lack the UDP GSO definitions (added in Linux 4.18).
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+namespace media {
+namespace cast {
+
+namespace {
+
+// The kernel caps the number of segments in one GSO send (UDP_MAX_SEGMENTS).
+constexpr size_t kMaxGsoSegments = 64;
+
+// A GSO send is a single UDP datagram as far as the socket layer is concerned,
+// so its payload must stay below the 64 KiB datagram limit.
+constexpr size_t kMaxGsoPayloadBytes = 65000;
+
+constexpr size_t kGsoControlSize = CMSG_SPACE(sizeof(uint16_t));
+
+// A packet is sent from its headers and, if it has one, its payload.
+constexpr size_t kMaxIovecsPerPacket = 2;
+
+int LastSystemError() {
+  if (errno == EAGAIN || errno == EWOULDBLOCK)
+    return net::ERR_IO_PENDING;
+  return net::MapSystemError(errno);
+}
+
+}  // namespace
+
+UdpBatchSocket::ReceivedPacket::ReceivedPacket() = default;
+UdpBatchSocket::ReceivedPacket::ReceivedPacket(ReceivedPacket&&) = default;
+UdpBatchSocket::ReceivedPacket& UdpBatchSocket::ReceivedPacket::operator=(
+    ReceivedPacket&&) = default;
+UdpBatchSocket::ReceivedPacket::~ReceivedPacket() = default;
+
+UdpBatchSocket::UdpBatchSocket()
+    : recv_buffers_(new uint8_t[kMaxBatchSize * kMaxIpPacketSize]),
+      recv_iovecs_(kMaxBatchSize),
+      recv_addrs_(kMaxBatchSize),
+      recv_msgs_(kMaxBatchSize),
+      send_iovecs_(kMaxBatchSize * kMaxIovecsPerPacket),
+      send_msgs_(kMaxBatchSize),
+      packets_per_msg_(kMaxBatchSize),
+      send_control_(new uint8_t[kMaxBatchSize * kGsoControlSize]) {
+  for (size_t i = 0; i < kMaxBatchSize; ++i) {
+    recv_iovecs_[i].iov_base = recv_buffers_.get() + i * kMaxIpPacketSize;
+    recv_iovecs_[i].iov_len = kMaxIpPacketSize;
+    memset(&recv_msgs_[i], 0, sizeof(recv_msgs_[i]));
+    recv_msgs_[i].msg_hdr.msg_name = &recv_addrs_[i];
+    recv_msgs_[i].msg_hdr.msg_iov = &recv_iovecs_[i];
+    recv_msgs_[i].msg_hdr.msg_iovlen = 1;
+  }
+}
+
+UdpBatchSocket::~UdpBatchSocket() {
+  // The watchers must stop before the descriptor is closed.
+  read_watcher_.reset();
+  write_watcher_.reset();
+}
+
+int UdpBatchSocket::Open(const sockaddr* addr) {
+  DCHECK(!socket_.is_valid());
+  address_family_ = addr->sa_family;
+  socket_.reset(socket(address_family_,
+                       SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP));
+  if (!socket_.is_valid())
+    return net::MapSystemError(errno);
+
+  // Matches net::UDPSocket::AllowAddressReuse().
+  const int reuse = 1;
+  if (setsockopt(socket_.get(), SOL_SOCKET, SO_REUSEADDR, &reuse,
+                 sizeof(reuse)) < 0) {
+    return net::MapSystemError(errno);
+  }
+  return net::OK;
+}
+
+int UdpBatchSocket::Bind(const net::IPEndPoint& local_addr) {
+  net::SockaddrStorage storage;
+  if (!local_addr.ToSockAddr(storage.addr, &storage.addr_len))
+    return net::ERR_ADDRESS_INVALID;
+  int result = Open(storage.addr);
+  if (result != net::OK)
+    return result;
+  if (bind(socket_.get(), storage.addr, storage.addr_len) < 0)
+    return net::MapSystemError(errno);
+  return net::OK;
+}
+
+int UdpBatchSocket::Connect(const net::IPEndPoint& remote_addr) {
+  net::SockaddrStorage storage;
+  if (!remote_addr.ToSockAddr(storage.addr, &storage.addr_len))
+    return net::ERR_ADDRESS_INVALID;
+  int result = Open(storage.addr);
+  if (result != net::OK)
+    return result;
+  if (HANDLE_EINTR(connect(socket_.get(), storage.addr, storage.addr_len)) < 0)
+    return net::MapSystemError(errno);
+  return net::OK;
+}
+
+int UdpBatchSocket::SetSendBufferSize(int32_t send_buffer_size) {
+  DCHECK(socket_.is_valid());
+  if (setsockopt(socket_.get(), SOL_SOCKET, SO_SNDBUF, &send_buffer_size,
+                 sizeof(send_buffer_size)) < 0) {
+    return net::MapSystemError(errno);
+  }
+  return net::OK;
+}
+
+int UdpBatchSocket::SetDiffServCodePoint(net::DiffServCodePoint dscp) {
+  DCHECK(socket_.is_valid());
+  if (dscp == net::DSCP_NO_CHANGE)
+    return net::OK;
+
+  // The DSCP occupies the upper six bits of the TOS / traffic class byte.
+  const int tos = dscp << 2;
+  const int result =
+      address_family_ == AF_INET6
+          ? setsockopt(socket_.get(), IPPROTO_IPV6, IPV6_TCLASS, &tos,
+                       sizeof(tos))
+          : setsockopt(socket_.get(), IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+  return result < 0 ? net::MapSystemError(errno) : net::OK;
+}
+
+bool UdpBatchSocket::EnableGso() {
+  DCHECK(socket_.is_valid());
+  int segment_size = 0;
+  socklen_t length = sizeof(segment_size);
+  gso_enabled_ = getsockopt(socket_.get(), SOL_UDP, UDP_SEGMENT, &segment_size,
+                            &length) == 0;
+  return gso_enabled_;
+}
+
+void UdpBatchSocket::WatchReadable(base::RepeatingClosure callback) {
+  DCHECK(socket_.is_valid());
+  read_watcher_ = base::FileDescriptorWatcher::WatchReadable(
+      socket_.get(), std::move(callback));
+}
+
+void UdpBatchSocket::StopWatchingReadable() {
+  read_watcher_.reset();
+}
+
+void UdpBatchSocket::WatchWritable(base::RepeatingClosure callback) {
+  DCHECK(socket_.is_valid());
+  write_watcher_ = base::FileDescriptorWatcher::WatchWritable(
+      socket_.get(), std::move(callback));
+}
+
+void UdpBatchSocket::StopWatchingWritable() {
+  write_watcher_.reset();
+}
+
+int UdpBatchSocket::ReceiveBatch(std::vector<ReceivedPacket>* packets) {
+  DCHECK(socket_.is_valid());
+
+  // The kernel overwrites the address lengths, so reset them on every call.
+  for (auto& msg : recv_msgs_)
+    msg.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+
+  const int count = HANDLE_EINTR(recvmmsg(socket_.get(), recv_msgs_.data(),
+                                          kMaxBatchSize, MSG_DONTWAIT,
+                                          nullptr));
+  if (count < 0)
+    return LastSystemError();
+
+  for (int i = 0; i < count; ++i) {
+    const msghdr& hdr = recv_msgs_[i].msg_hdr;
+    // Datagrams larger than kMaxIpPacketSize are not valid cast packets.
+    if (hdr.msg_flags & MSG_TRUNC)
+      continue;
+
+    ReceivedPacket received;
+    if (!received.address.FromSockAddr(
+            reinterpret_cast<const sockaddr*>(hdr.msg_name), hdr.msg_namelen)) {
+      continue;
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(recv_iovecs_[i].iov_base);
+    received.packet =
+        std::make_unique<Packet>(data, data + recv_msgs_[i].msg_len);
+    packets->push_back(std::move(received));
+  }
+  return count;
+}
+
+int UdpBatchSocket::SendBatch(base::span<const PacketRef> packets,
+                              const net::IPEndPoint& remote_addr) {
+  DCHECK(socket_.is_valid());
+  if (packets.empty())
+    return 0;
+
+  net::SockaddrStorage storage;
+  const bool has_remote_addr = remote_addr.address().IsValid();
+  if (has_remote_addr &&
+      !remote_addr.ToSockAddr(storage.addr, &storage.addr_len)) {
+    return net::ERR_ADDRESS_INVALID;
+  }
+
+  // Pack the packets into messages. Without GSO every packet is a message of
+  // its own. With GSO, a run of packets of the same size, of which only the
+  // last may be shorter, goes out as one message which the kernel (or the
+  // NIC) splits back into datagrams. Either way, a packet is gathered from its
+  // headers and its payload, which is not copied out of the frame.
+  const size_t num_packets = std::min(packets.size(), kMaxBatchSize);
+  size_t num_msgs = 0;
+  size_t num_iovecs = 0;
+  for (size_t i = 0; i < num_packets;) {
+    const size_t segment_size = packets[i]->size();
+    size_t run = 1;
+    size_t run_bytes = segment_size;
+    if (gso_enabled_ && segment_size > 0) {
+      while (i + run < num_packets && run < kMaxGsoSegments) {
+        const size_t size = packets[i + run]->size();
+        if (size == 0 || size > segment_size ||
+            run_bytes + size > kMaxGsoPayloadBytes) {
+          break;
+        }
+        run_bytes += size;
+        ++run;
+        if (size < segment_size)
+          break;
+      }
+    }
+
+    const size_t first_iovec = num_iovecs;
+    for (size_t j = 0; j < run; ++j) {
+      OutgoingPacket& packet = *packets[i + j];
+      send_iovecs_[num_iovecs].iov_base = packet.data.data();
+      send_iovecs_[num_iovecs].iov_len = packet.data.size();
+      ++num_iovecs;
+      if (packet.payload_size > 0) {
+        // sendmsg() does not write to the buffers, despite the non-const
+        // iov_base.
+        send_iovecs_[num_iovecs].iov_base =
+            const_cast<uint8_t*>(packet.payload_span().data());
+        send_iovecs_[num_iovecs].iov_len = packet.payload_size;
+        ++num_iovecs;
+      }
+    }
+
+    msghdr& hdr = send_msgs_[num_msgs].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    if (has_remote_addr) {
+      hdr.msg_name = storage.addr;
+      hdr.msg_namelen = storage.addr_len;
+    }
+    hdr.msg_iov = &send_iovecs_[first_iovec];
+    hdr.msg_iovlen = num_iovecs - first_iovec;
+    if (run > 1) {
+      hdr.msg_control = send_control_.get() + num_msgs * kGsoControlSize;
+      hdr.msg_controllen = kGsoControlSize;
+      cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      const uint16_t gso_size = static_cast<uint16_t>(segment_size);
+      memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+    }
+    packets_per_msg_[num_msgs++] = run;
+    i += run;
+  }
+
+  const int sent_msgs = HANDLE_EINTR(
+      sendmmsg(socket_.get(), send_msgs_.data(), num_msgs, MSG_DONTWAIT));
+  if (sent_msgs < 0) {
+    // Some devices can't checksum segmented sends and fail them with EIO.
+    // Fall back to plain sendmmsg() from here on.
+    if (errno == EIO && gso_enabled_) {
+      gso_enabled_ = false;
+      return SendBatch(packets, remote_addr);
+    }
+    return LastSystemError();
+  }
+
+  size_t sent_packets = 0;
+  for (int i = 0; i < sent_msgs; ++i)
+    sent_packets += packets_per_msg_[i];
+  return static_cast<int>(sent_packets);
+}
+
+}  // namespace cast
+}  // namespace media
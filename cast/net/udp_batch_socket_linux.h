@@ -0,0 +1,123 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_CAST_NET_UDP_BATCH_SOCKET_LINUX_H_
+#define MEDIA_CAST_NET_UDP_BATCH_SOCKET_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/span.h"
+#include "base/files/file_descriptor_watcher_posix.h"
+#include "base/files/scoped_file.h"
+#include "media/cast/net/cast_transport_defines.h"
+#include "net/base/ip_endpoint.h"
+#include "net/socket/diff_serv_code_point.h"
+
+namespace media {
+namespace cast {
+
+// A non-blocking UDP socket which moves datagrams to and from the kernel in
+// batches: recvmmsg() into a preallocated ring of packet buffers, sendmmsg()
+// for outgoing bursts and, when enabled and supported by the kernel, UDP
+// generic segmentation offload (GSO) for runs of equal-sized packets.
+//
+// All methods must be called on the same IO thread. Errors are reported as
+// net::Error codes, as with net::UDPSocket.
+class UdpBatchSocket {
+ public:
+  // Maximum number of datagrams moved by a single system call.
+  static constexpr size_t kMaxBatchSize = 64;
+
+  struct ReceivedPacket {
+    ReceivedPacket();
+    ReceivedPacket(ReceivedPacket&&);
+    ReceivedPacket& operator=(ReceivedPacket&&);
+    ~ReceivedPacket();
+
+    std::unique_ptr<Packet> packet;
+    net::IPEndPoint address;
+  };
+
+  UdpBatchSocket();
+
+  UdpBatchSocket(const UdpBatchSocket&) = delete;
+  UdpBatchSocket& operator=(const UdpBatchSocket&) = delete;
+
+  ~UdpBatchSocket();
+
+  // Opens the socket and binds it to |local_addr|.
+  int Bind(const net::IPEndPoint& local_addr);
+
+  // Opens the socket and connects it to |remote_addr|.
+  int Connect(const net::IPEndPoint& remote_addr);
+
+  int SetSendBufferSize(int32_t send_buffer_size);
+  int SetDiffServCodePoint(net::DiffServCodePoint dscp);
+
+  // Turns on UDP GSO for SendBatch() if the kernel supports it. Returns true
+  // if GSO is in use.
+  bool EnableGso();
+  bool gso_enabled() const { return gso_enabled_; }
+
+  // Runs |callback| whenever the socket is readable, until
+  // StopWatchingReadable() is called.
+  void WatchReadable(base::RepeatingClosure callback);
+  void StopWatchingReadable();
+
+  // Runs |callback| whenever the socket is writable, until
+  // StopWatchingWritable() is called.
+  void WatchWritable(base::RepeatingClosure callback);
+  void StopWatchingWritable();
+
+  // Receives up to kMaxBatchSize datagrams and appends them to |packets|.
+  // Returns the number of datagrams received, net::ERR_IO_PENDING if none
+  // are waiting, or another net error.
+  int ReceiveBatch(std::vector<ReceivedPacket>* packets);
+
+  // Sends as many of |packets| as the socket accepts, up to kMaxBatchSize,
+  // to |remote_addr|, or to the connected peer if |remote_addr| is empty.
+  // Returns the number of packets sent, net::ERR_IO_PENDING if the socket
+  // buffer is full, or another net error.
+  int SendBatch(base::span<const PacketRef> packets,
+                const net::IPEndPoint& remote_addr);
+
+ private:
+  int Open(const sockaddr* addr);
+
+  base::ScopedFD socket_;
+  int address_family_ = AF_UNSPEC;
+  bool gso_enabled_ = false;
+
+  // The receive ring: |recv_buffers_| holds kMaxBatchSize slots of
+  // kMaxIpPacketSize bytes, which |recv_msgs_| point into. Datagrams are
+  // copied out into right-sized Packets, so the ring is reused for the
+  // lifetime of the socket.
+  std::unique_ptr<uint8_t[]> recv_buffers_;
+  std::vector<iovec> recv_iovecs_;
+  std::vector<sockaddr_storage> recv_addrs_;
+  std::vector<mmsghdr> recv_msgs_;
+
+  // Scratch space for SendBatch(), sized once. A message carries either a
+  // single packet or, with GSO, a run of packets as one iovec array, with one
+  // iovec for the headers of each packet and one for its payload.
+  std::vector<iovec> send_iovecs_;
+  std::vector<mmsghdr> send_msgs_;
+  std::vector<size_t> packets_per_msg_;
+  std::unique_ptr<uint8_t[]> send_control_;
+
+  std::unique_ptr<base::FileDescriptorWatcher::Controller> read_watcher_;
+  std::unique_ptr<base::FileDescriptorWatcher::Controller> write_watcher_;
+};
+
+}  // namespace cast
+}  // namespace media
+
+#endif  // MEDIA_CAST_NET_UDP_BATCH_SOCKET_LINUX_H_
@@ -68,7 +68,7 @@ UdpPacketPipeWriter::~UdpPacketPipeWriter() {}
 
 void UdpPacketPipeWriter::Write(PacketRef packet, base::OnceClosure done_cb) {
   DCHECK(done_cb);
-  current_packet_size_ = packet->data.size();
+  current_packet_size_ = packet->size();
   data_pipe_writer_.Write(
       reinterpret_cast<uint8_t*>(&current_packet_size_), sizeof(uint16_t),
       base::BindOnce(&UdpPacketPipeWriter::WritePacketPayload,
@@ -83,8 +83,18 @@ void UdpPacketPipeWriter::WritePacketPayload(PacketRef packet,
     OnPacketWritten(PacketRef(), std::move(done_cb), false);
     return;
   }
+  // The data pipe is a byte stream, so a packet whose payload is held apart
+  // from its headers is written in two parts rather than put together first.
   const uint8_t* buffer = packet->data.data();
   const int buffer_size = packet->data.size();
+  if (packet->payload_size) {
+    data_pipe_writer_.Write(
+        buffer, buffer_size,
+        base::BindOnce(&UdpPacketPipeWriter::WriteSharedPayload,
+                       base::Unretained(this), std::move(packet),
+                       std::move(done_cb)));
+    return;
+  }
   data_pipe_writer_.Write(
       buffer, buffer_size,
       base::BindOnce(&UdpPacketPipeWriter::OnPacketWritten,
@@ -92,6 +102,21 @@ void UdpPacketPipeWriter::WritePacketPayload(PacketRef packet,
                      std::move(done_cb)));
 }
 
+void UdpPacketPipeWriter::WriteSharedPayload(PacketRef packet,
+                                             base::OnceClosure done_cb,
+                                             bool success) {
+  if (!success) {
+    OnPacketWritten(PacketRef(), std::move(done_cb), false);
+    return;
+  }
+  const base::span<const uint8_t> payload = packet->payload_span();
+  data_pipe_writer_.Write(
+      payload.data(), payload.size(),
+      base::BindOnce(&UdpPacketPipeWriter::OnPacketWritten,
+                     base::Unretained(this), std::move(packet),
+                     std::move(done_cb)));
+}
+
 void UdpPacketPipeWriter::OnPacketWritten(PacketRef packet,
                                           base::OnceClosure done_cb,
                                           bool success) {
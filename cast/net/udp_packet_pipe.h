@@ -67,6 +67,12 @@ class UdpPacketPipeWriter {
                           base::OnceClosure done_cb,
                           bool success);
 
+  // Called by |data_pipe_writer_| once the headers of a packet which points
+  // into a shared payload are written. Writes the rest of the packet.
+  void WriteSharedPayload(PacketRef packet,
+                          base::OnceClosure done_cb,
+                          bool success);
+
   // Called by |data_pipe_writer_| when the writing completes.
   void OnPacketWritten(PacketRef packet,
                        base::OnceClosure done_cb,
@@ -12,6 +12,7 @@
 #include "base/callback.h"
 #include "base/containers/circular_deque.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/test/mock_callback.h"
 #include "base/test/task_environment.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -60,7 +61,7 @@ TEST_F(UdpPacketPipeTest, Normal) {
   // Writes |packet1|. Expected to be done successfully.
   base::MockCallback<base::OnceClosure> done_callback;
   EXPECT_CALL(done_callback, Run()).Times(1);
-  writer_->Write(new base::RefCountedData<Packet>(packet1),
+  writer_->Write(new OutgoingPacket(packet1),
                  done_callback.Get());
   task_environment_.RunUntilIdle();
 
@@ -68,7 +69,7 @@ TEST_F(UdpPacketPipeTest, Normal) {
   // limit.
   base::MockCallback<base::OnceClosure> done_callback2;
   EXPECT_CALL(done_callback2, Run()).Times(0);
-  writer_->Write(new base::RefCountedData<Packet>(packet2),
+  writer_->Write(new OutgoingPacket(packet2),
                  done_callback2.Get());
   task_environment_.RunUntilIdle();
   testing::Mock::VerifyAndClearExpectations(&done_callback2);
@@ -95,5 +96,24 @@ TEST_F(UdpPacketPipeTest, Normal) {
   EXPECT_TRUE(packets_read_.empty());
 }
 
+TEST_F(UdpPacketPipeTest, PacketWithSharedPayload) {
+  std::string header = "ab";
+  std::string payload = "wxyz";
+  scoped_refptr<OutgoingPacket> packet = base::MakeRefCounted<OutgoingPacket>(
+      Packet(header.begin(), header.end()),
+      base::RefCountedString::TakeString(&payload), 1, 2);
+
+  // The headers and the part of the payload are read back as one packet.
+  base::MockCallback<base::OnceClosure> done_callback;
+  EXPECT_CALL(done_callback, Run()).Times(1);
+  writer_->Write(packet, done_callback.Get());
+  reader_->Read(
+      base::BindOnce(&UdpPacketPipeTest::OnPacketRead, base::Unretained(this)));
+  task_environment_.RunUntilIdle();
+  ASSERT_EQ(1u, packets_read_.size());
+  const std::string expected = "abxy";
+  EXPECT_EQ(Packet(expected.begin(), expected.end()), *packets_read_.front());
+}
+
 }  // namespace cast
 }  // namespace media
@@ -19,6 +19,11 @@
 #include "net/log/net_log_source.h"
 #include "net/traffic_annotation/network_traffic_annotation.h"
 
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+#include "base/containers/span.h"
+#include "media/cast/net/udp_batch_socket_linux.h"
+#endif
+
 using media::cast::transport_util::kOptionPacerMaxBurstSize;
 using media::cast::transport_util::LookupOptionWithDefault;
 
@@ -32,6 +37,15 @@ const char kOptionDscp[] = "DSCP";
 const char kOptionDisableNonBlockingIO[] = "disable_non_blocking_io";
 #endif
 const char kOptionSendBufferMinSize[] = "send_buffer_min_size";
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+const char kOptionBatchedIO[] = "batched_io";
+const char kOptionUdpGso[] = "udp_gso";
+
+// Receiving stops after this many full batches in one wakeup so that a flood
+// of packets can't starve other tasks on the IO thread. The socket watcher
+// fires again while packets are waiting.
+const int kMaxReceiveBatchesPerWakeup = 4;
+#endif
 
 bool IsEmpty(const net::IPEndPoint& addr) {
   return (addr.address().empty() || addr.address().IsZero()) && !addr.port();
@@ -79,6 +93,20 @@ void UdpTransportImpl::StartReceiving(
     PacketReceiverCallbackWithStatus packet_receiver) {
   DCHECK(io_thread_proxy_->RunsTasksInCurrentSequence());
 
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  if (use_batched_io_ || batch_socket_) {
+    packet_receiver_ = std::move(packet_receiver);
+    if (!batch_socket_ && !OpenBatchSocket()) {
+      status_callback_.Run(TRANSPORT_SOCKET_ERROR);
+      return;
+    }
+    batch_socket_->WatchReadable(
+        base::BindRepeating(&UdpTransportImpl::OnBatchSocketReadable,
+                            weak_factory_.GetWeakPtr()));
+    return;
+  }
+#endif
+
   if (!udp_socket_) {
     status_callback_.Run(TRANSPORT_SOCKET_ERROR);
     return;
@@ -135,6 +163,10 @@ void UdpTransportImpl::StopReceiving() {
   DCHECK(io_thread_proxy_->RunsTasksInCurrentSequence());
   packet_receiver_ = PacketReceiverCallbackWithStatus();
   mojo_packet_receiver_ = nullptr;
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  if (batch_socket_)
+    batch_socket_->StopWatchingReadable();
+#endif
 }
 
 void UdpTransportImpl::SetDscp(net::DiffServCodePoint dscp) {
@@ -196,38 +228,127 @@ void UdpTransportImpl::ReceiveNextPacket(int length_or_status) {
       return;
     }
 
-    // Confirm the packet has come from the expected remote address; otherwise,
-    // ignore it.  If this is the first packet being received and no remote
-    // address has been set, set the remote address and expect all future
-    // packets to come from the same one.
-    // TODO(hubbe): We should only do this if the caller used a valid ssrc.
-    if (IsEmpty(remote_addr_)) {
-      remote_addr_ = recv_addr_;
-      VLOG(1) << "Setting remote address from first received packet: "
-              << remote_addr_.ToString();
-      next_packet_->resize(length_or_status);
-      if (!packet_receiver_.Run(std::move(next_packet_))) {
-        VLOG(1) << "Packet was not valid, resetting remote address.";
-        remote_addr_ = net::IPEndPoint();
-      }
-    } else if (!(remote_addr_ == recv_addr_)) {
-      VLOG(1) << "Ignoring packet received from an unrecognized address: "
-              << recv_addr_.ToString() << ".";
-    } else {
-      next_packet_->resize(length_or_status);
-      packet_receiver_.Run(std::move(next_packet_));
-    }
+    next_packet_->resize(length_or_status);
+    DeliverReceivedPacket(std::move(next_packet_), recv_addr_);
     length_or_status = net::ERR_IO_PENDING;
   }
 }
 
+void UdpTransportImpl::DeliverReceivedPacket(std::unique_ptr<Packet> packet,
+                                             const net::IPEndPoint& from) {
+  // Confirm the packet has come from the expected remote address; otherwise,
+  // ignore it.  If this is the first packet being received and no remote
+  // address has been set, set the remote address and expect all future
+  // packets to come from the same one.
+  // TODO(hubbe): We should only do this if the caller used a valid ssrc.
+  if (IsEmpty(remote_addr_)) {
+    remote_addr_ = from;
+    VLOG(1) << "Setting remote address from first received packet: "
+            << remote_addr_.ToString();
+    if (!packet_receiver_.Run(std::move(packet))) {
+      VLOG(1) << "Packet was not valid, resetting remote address.";
+      remote_addr_ = net::IPEndPoint();
+    }
+  } else if (!(remote_addr_ == from)) {
+    VLOG(1) << "Ignoring packet received from an unrecognized address: "
+            << from.ToString() << ".";
+  } else {
+    packet_receiver_.Run(std::move(packet));
+  }
+}
+
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+bool UdpTransportImpl::OpenBatchSocket() {
+  // The batch socket replaces |udp_socket_|, which is never opened.
+  udp_socket_.reset();
+
+  auto batch_socket = std::make_unique<UdpBatchSocket>();
+  if (!IsEmpty(local_addr_)) {
+    if (batch_socket->Bind(local_addr_) != net::OK) {
+      LOG(ERROR) << "Failed to bind local address.";
+      return false;
+    }
+  } else if (!IsEmpty(remote_addr_)) {
+    if (batch_socket->Connect(remote_addr_) != net::OK) {
+      LOG(ERROR) << "Failed to connect to remote address.";
+      return false;
+    }
+    client_connected_ = true;
+  } else {
+    NOTREACHED() << "Either local or remote address has to be defined.";
+    return false;
+  }
+  if (batch_socket->SetSendBufferSize(send_buffer_size_) != net::OK) {
+    LOG(WARNING) << "Failed to set socket send buffer size.";
+  }
+  if (use_gso_ && !batch_socket->EnableGso())
+    VLOG(1) << "UDP GSO is not supported; sending without it.";
+
+  batch_socket_ = std::move(batch_socket);
+  return true;
+}
+
+void UdpTransportImpl::OnBatchSocketReadable() {
+  DCHECK(io_thread_proxy_->RunsTasksInCurrentSequence());
+
+  std::vector<UdpBatchSocket::ReceivedPacket> packets;
+  packets.reserve(UdpBatchSocket::kMaxBatchSize);
+  for (int i = 0; i < kMaxReceiveBatchesPerWakeup; ++i) {
+    packets.clear();
+    const int result = batch_socket_->ReceiveBatch(&packets);
+    if (result < 0) {
+      if (result != net::ERR_IO_PENDING)
+        VLOG(1) << "Failed to receive packets: Status code is " << result;
+      return;
+    }
+    for (auto& received : packets) {
+      if (packet_receiver_.is_null())
+        return;
+      DeliverReceivedPacket(std::move(received.packet), received.address);
+    }
+    // A short batch means the socket has been drained.
+    if (static_cast<size_t>(result) < UdpBatchSocket::kMaxBatchSize)
+      return;
+  }
+}
+
+void UdpTransportImpl::OnBatchSocketWritable() {
+  DCHECK(io_thread_proxy_->RunsTasksInCurrentSequence());
+  DCHECK(batch_send_blocked_);
+
+  batch_socket_->StopWatchingWritable();
+  batch_send_blocked_ = false;
+  FlushPackets();
+  if (!batch_send_blocked_ && !batch_send_unblocked_cb_.is_null())
+    std::move(batch_send_unblocked_cb_).Run();
+}
+#endif
+
 bool UdpTransportImpl::SendPacket(PacketRef packet, base::OnceClosure cb) {
   DCHECK(io_thread_proxy_->RunsTasksInCurrentSequence());
+
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  if (batch_socket_) {
+    // Increase byte count no matter the packet was sent or dropped.
+    bytes_sent_ += packet->size();
+    send_batch_.push_back(std::move(packet));
+    if (!batch_send_blocked_ &&
+        send_batch_.size() >= UdpBatchSocket::kMaxBatchSize) {
+      FlushPackets();
+    }
+    if (batch_send_blocked_) {
+      batch_send_unblocked_cb_ = std::move(cb);
+      return false;
+    }
+    return true;
+  }
+#endif
+
   if (!udp_socket_)
     return true;
 
   // Increase byte count no matter the packet was sent or dropped.
-  bytes_sent_ += packet->data.size();
+  bytes_sent_ += packet->size();
 
   DCHECK(!send_pending_);
   if (send_pending_) {
@@ -248,6 +369,10 @@ bool UdpTransportImpl::SendPacket(PacketRef packet, base::OnceClosure cb) {
     }
   }
 
+  // net::UDPSocket cannot gather a packet from several buffers, so a packet
+  // whose payload is held apart from its headers is put together here.
+  if (packet->payload)
+    packet = base::MakeRefCounted<OutgoingPacket>(packet->ToPacket());
   auto buf = base::MakeRefCounted<net::WrappedIOBuffer>(
       reinterpret_cast<char*>(&packet->data.front()));
 
@@ -308,6 +433,56 @@ bool UdpTransportImpl::SendPacket(PacketRef packet, base::OnceClosure cb) {
   return true;
 }
 
+void UdpTransportImpl::FlushPackets() {
+  DCHECK(io_thread_proxy_->RunsTasksInCurrentSequence());
+
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  if (!batch_socket_ || batch_send_blocked_ || send_batch_.empty())
+    return;
+
+  if (next_dscp_value_ != net::DSCP_NO_CHANGE) {
+    int result = batch_socket_->SetDiffServCodePoint(next_dscp_value_);
+    if (result != net::OK) {
+      VLOG(1) << "Unable to set DSCP: " << next_dscp_value_
+              << " to socket; Error: " << result;
+    }
+    next_dscp_value_ = net::DSCP_NO_CHANGE;
+  }
+
+  if (!client_connected_ && IsEmpty(remote_addr_)) {
+    VLOG(1) << "Failed to send packets; socket is neither bound nor "
+            << "connected.";
+    send_batch_.clear();
+    return;
+  }
+
+  // A connected socket must not be given a destination address.
+  const net::IPEndPoint destination =
+      client_connected_ ? net::IPEndPoint() : remote_addr_;
+  size_t sent = 0;
+  while (sent < send_batch_.size()) {
+    const int result = batch_socket_->SendBatch(
+        base::make_span(send_batch_).subspan(sent), destination);
+    if (result == net::ERR_IO_PENDING) {
+      batch_send_blocked_ = true;
+      batch_socket_->WatchWritable(
+          base::BindRepeating(&UdpTransportImpl::OnBatchSocketWritable,
+                              weak_factory_.GetWeakPtr()));
+      break;
+    }
+    if (result < 0) {
+      // sendmmsg() only fails outright if the first message fails. Drop that
+      // packet, as the unbatched path would, and carry on with the rest.
+      VLOG(1) << "Failed to send packet: " << result << ".";
+      ++sent;
+      continue;
+    }
+    sent += result;
+  }
+  send_batch_.erase(send_batch_.begin(), send_batch_.begin() + sent);
+#endif
+}
+
 int64_t UdpTransportImpl::GetBytesSent() {
   return bytes_sent_;
 }
@@ -341,6 +516,10 @@ void UdpTransportImpl::SetUdpOptions(const base::DictionaryValue& options) {
     UseNonBlockingIO();
   }
 #endif
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  use_gso_ = options.HasKey(kOptionUdpGso);
+  use_batched_io_ = use_gso_ || options.HasKey(kOptionBatchedIO);
+#endif
 }
 
 void UdpTransportImpl::SetSendBufferSize(int32_t send_buffer_size) {
@@ -363,13 +542,15 @@ void UdpTransportImpl::ReadNextPacketToSend() {
 void UdpTransportImpl::OnPacketReadFromDataPipe(
     std::unique_ptr<Packet> packet) {
   DVLOG(3) << __func__;
-  // TODO(https://crbug.com/530834): Avoid making copy of the |packet|.
   if (!SendPacket(
-          base::WrapRefCounted(new base::RefCountedData<Packet>(*packet)),
+          base::MakeRefCounted<OutgoingPacket>(std::move(*packet)),
           base::BindRepeating(&UdpTransportImpl::ReadNextPacketToSend,
                               base::Unretained(this)))) {
     return;  // Waiting for the packet to be sent out.
   }
+  // Packets arrive from the data pipe one at a time, so there is no burst to
+  // batch up.
+  FlushPackets();
   // Force a post task to prevent the stack from growing too deep.
   base::SequencedTaskRunnerHandle::Get()->PostTask(
       FROM_HERE, base::BindOnce(&UdpTransportImpl::ReadNextPacketToSend,
@@ -8,6 +8,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -27,6 +28,7 @@
 namespace media {
 namespace cast {
 
+class UdpBatchSocket;
 class UdpPacketPipeReader;
 
 // This class implements UDP transport mechanism for Cast.
@@ -54,6 +56,7 @@ class UdpTransportImpl final : public PacketTransport, public UdpTransport {
 
   // PacketTransport implementations.
   bool SendPacket(PacketRef packet, base::OnceClosure cb) final;
+  void FlushPackets() final;
   int64_t GetBytesSent() final;
   // Start receiving packets. Packets are submitted to |packet_receiver|.
   void StartReceiving(PacketReceiverCallbackWithStatus packet_receiver) final;
@@ -78,6 +81,14 @@ class UdpTransportImpl final : public PacketTransport, public UdpTransport {
   //   "disable_non_blocking_io" (value ignored)
   //       - Windows only.  Turns off non-blocking IO for the socket.
   //         Note: Non-blocking IO is, by default, enabled on all platforms.
+  //   "batched_io" (value ignored)
+  //       - Linux only.  Receives with recvmmsg() and sends each pacer burst
+  //         with a single sendmmsg().
+  //   "udp_gso" (value ignored)
+  //       - Linux only, implies "batched_io".  Sends runs of equal-sized
+  //         packets with UDP generic segmentation offload, if supported.
+  // Like the send buffer size, the batching options take effect on the next
+  // StartReceiving().
   void SetUdpOptions(const base::DictionaryValue& options);
 
   // This has to be called before |StartReceiving()| to change the
@@ -115,6 +126,21 @@ class UdpTransportImpl final : public PacketTransport, public UdpTransport {
   // is already avilable in the pipe, and async otherwise.
   void ReadNextPacketToSend();
 
+  // Passes a packet received from |from| to |packet_receiver_|, after checking
+  // that it came from the remote peer.
+  void DeliverReceivedPacket(std::unique_ptr<Packet> packet,
+                             const net::IPEndPoint& from);
+
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  // Opens |batch_socket_| in place of |udp_socket_|. Returns false on failure.
+  bool OpenBatchSocket();
+
+  // Called when |batch_socket_| is readable or, while |batch_send_blocked_|,
+  // writable.
+  void OnBatchSocketReadable();
+  void OnBatchSocketWritable();
+#endif
+
   const scoped_refptr<base::SingleThreadTaskRunner> io_thread_proxy_;
   const net::IPEndPoint local_addr_;
   net::IPEndPoint remote_addr_;
@@ -138,6 +164,21 @@ class UdpTransportImpl final : public PacketTransport, public UdpTransport {
   // called.
   std::unique_ptr<UdpPacketPipeReader> reader_;
 
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  // Batched IO, enabled through SetUdpOptions(). When |batch_socket_| is open
+  // it is used instead of |udp_socket_|.
+  bool use_batched_io_ = false;
+  bool use_gso_ = false;
+  std::unique_ptr<UdpBatchSocket> batch_socket_;
+
+  // Packets accepted by SendPacket() but not yet sent. They go out together
+  // from FlushPackets(), or once the socket becomes writable again if
+  // |batch_send_blocked_|.
+  std::vector<PacketRef> send_batch_;
+  bool batch_send_blocked_ = false;
+  base::OnceClosure batch_send_unblocked_cb_;
+#endif
+
   // NOTE: Weak pointers must be invalidated before all other member variables.
   base::WeakPtrFactory<UdpTransportImpl> weak_factory_{this};
 };
@@ -16,8 +16,11 @@
 #include "media/cast/sender/congestion_control.h"
 
 #include <algorithm>
+#include <cmath>
 #include <deque>
+#include <utility>
 
+#include "base/containers/circular_deque.h"
 #include "base/cxx17_backports.h"
 #include "base/logging.h"
 #include "base/macros.h"
@@ -47,6 +50,7 @@ class AdaptiveCongestionControl final : public CongestionControl {
   void SendFrameToTransport(FrameId frame_id,
                             size_t frame_size_in_bits,
                             base::TimeTicks when) final;
+  void DropFrame(FrameId frame_id, base::TimeTicks when) final;
   void AckFrame(FrameId frame_id, base::TimeTicks when) final;
   void AckLaterFrames(std::vector<FrameId> received_frames,
                       base::TimeTicks when) final;
@@ -121,6 +125,7 @@ class FixedCongestionControl final : public CongestionControl {
   void SendFrameToTransport(FrameId frame_id,
                             size_t frame_size_in_bits,
                             base::TimeTicks when) final {}
+  void DropFrame(FrameId frame_id, base::TimeTicks when) final {}
   void AckFrame(FrameId frame_id, base::TimeTicks when) final {}
   void AckLaterFrames(std::vector<FrameId> received_frames,
                       base::TimeTicks when) final {}
@@ -133,6 +138,129 @@ class FixedCongestionControl final : public CongestionControl {
   const int bitrate_;
 };
 
+// A delay-gradient controller modelled on Google Congestion Control. Cast
+// feedback does not carry per-packet arrival times, so each ACK stands in for
+// the arrival of the newest frame it covers: the change in (ACK time - send
+// time) from one ACK to the next is the delay gradient. A trendline fitted to
+// the accumulated gradient is compared against an adaptive threshold to
+// detect whether queues are building (overuse), draining (underuse) or
+// steady, and an AIMD rate controller reacts to that signal.
+class DelayBasedCongestionControl final : public CongestionControl {
+ public:
+  DelayBasedCongestionControl(const base::TickClock* clock,
+                              int max_bitrate_configured,
+                              int min_bitrate_configured,
+                              int start_bitrate_configured);
+
+  DelayBasedCongestionControl(const DelayBasedCongestionControl&) = delete;
+  DelayBasedCongestionControl& operator=(const DelayBasedCongestionControl&) =
+      delete;
+
+  ~DelayBasedCongestionControl() final;
+
+  // CongestionControl implementation.
+  void UpdateRtt(base::TimeDelta rtt) final;
+  void UpdateTargetPlayoutDelay(base::TimeDelta delay) final;
+  void SendFrameToTransport(FrameId frame_id,
+                            size_t frame_size_in_bits,
+                            base::TimeTicks when) final;
+  void DropFrame(FrameId frame_id, base::TimeTicks when) final;
+  void AckFrame(FrameId frame_id, base::TimeTicks when) final;
+  void AckLaterFrames(std::vector<FrameId> received_frames,
+                      base::TimeTicks when) final;
+  int GetBitrate(base::TimeTicks playout_time,
+                 base::TimeDelta playout_delay) final;
+
+ private:
+  enum class BandwidthUsage { kNormal, kUnderusing, kOverusing };
+  enum class RateControlState { kHold, kIncrease, kDecrease };
+
+  struct InFlightFrame {
+    FrameId frame_id;
+    base::TimeTicks send_time;
+    size_t frame_size_in_bits;
+    bool acked;
+  };
+
+  // Marks |frame| as acked at |when| and folds it into the current ACK group.
+  void OnFrameAcked(InFlightFrame* frame, base::TimeTicks when);
+
+  // Drops the acked frames at the front of |in_flight_frames_|.
+  void PruneAckedFrames();
+
+  // Feeds the completed ACK group into the trendline and the rate controller.
+  void ProcessAckGroup();
+
+  // Compares the latest trendline slope against the adaptive threshold.
+  BandwidthUsage Detect(double trend, base::TimeDelta since_last_sample);
+  void UpdateThreshold(double modified_trend,
+                       base::TimeDelta since_last_sample);
+
+  void UpdateRate(BandwidthUsage usage, base::TimeTicks now);
+  void DecreaseRate(base::TimeTicks now);
+
+  // Returns the rate at which frames were acked over the last
+  // kAckedBitrateWindow, or 0 if less than a window's worth of ACKs was seen.
+  double AckedBitrate() const;
+
+  base::TimeDelta ResponseTime() const;
+
+  // Returns the queueing delay above which the path counts as overused, a
+  // share of the target playout delay, or zero (no limit) until that is set.
+  base::TimeDelta MaxQueueDelay() const;
+
+  const base::TickClock* const clock_;  // Not owned by this class.
+  const int max_bitrate_configured_;
+  const int min_bitrate_configured_;
+  base::TimeDelta target_playout_delay_;
+
+  double target_bitrate_;
+  RateControlState rate_control_state_ = RateControlState::kIncrease;
+  base::TimeTicks last_rate_update_time_;
+  base::TimeTicks last_decrease_time_;
+  // Smoothed acked bitrate observed when the rate was last cut, which
+  // estimates the path capacity. Zero until the first decrease.
+  double link_capacity_estimate_ = 0;
+  base::TimeDelta rtt_;
+
+  // Sent but not yet acked frames, in FrameId order. Frames acked out of
+  // order stay in place, marked |acked|, until everything before them is.
+  base::circular_deque<InFlightFrame> in_flight_frames_;
+  FrameId last_sent_frame_id_;
+
+  // The ACK group being collected: all frames newly acked at the same time
+  // form one sample, timed by the newest frame among them.
+  base::TimeTicks group_send_time_;
+  base::TimeTicks group_ack_time_;
+  // The last group fed into the trendline.
+  base::TimeTicks last_group_send_time_;
+  base::TimeTicks last_group_ack_time_;
+  // The lowest (ACK time - send time) seen, i.e. that of an empty path, and
+  // how much the last group's exceeded it.
+  base::TimeDelta min_ack_delay_ = base::TimeDelta::Max();
+  base::TimeDelta queue_delay_;
+
+  // (ACK time, bits) of frames acked within the last kAckedBitrateWindow.
+  base::circular_deque<std::pair<base::TimeTicks, size_t>> acked_bits_;
+  size_t acked_bits_in_window_ = 0;
+  base::TimeTicks first_ack_time_;
+
+  // Trendline estimator state: the accumulated delay gradient, its smoothed
+  // value and a window of (ACK time, smoothed delay) points the slope is
+  // fitted to, in milliseconds relative to |first_ack_time_|.
+  double accumulated_delay_ms_ = 0;
+  double smoothed_delay_ms_ = 0;
+  base::circular_deque<std::pair<double, double>> delay_history_;
+  int num_delay_samples_ = 0;
+  double previous_trend_ = 0;
+
+  // Overuse detector state.
+  double threshold_ms_;
+  base::TimeDelta time_over_using_ = base::Milliseconds(-1);
+  int overuse_counter_ = 0;
+  BandwidthUsage last_usage_ = BandwidthUsage::kNormal;
+};
+
 CongestionControl* NewAdaptiveCongestionControl(const base::TickClock* clock,
                                                 int max_bitrate_configured,
                                                 int min_bitrate_configured,
@@ -147,6 +275,16 @@ CongestionControl* NewFixedCongestionControl(int bitrate) {
   return new FixedCongestionControl(bitrate);
 }
 
+CongestionControl* NewDelayBasedCongestionControl(
+    const base::TickClock* clock,
+    int max_bitrate_configured,
+    int min_bitrate_configured,
+    int start_bitrate_configured) {
+  return new DelayBasedCongestionControl(clock, max_bitrate_configured,
+                                         min_bitrate_configured,
+                                         start_bitrate_configured);
+}
+
 // This means that we *try* to keep our buffer 90% empty.
 // If it is less full, we increase the bandwidth, if it is more
 // we decrease the bandwidth. Making this smaller makes the
@@ -329,6 +467,17 @@ void AdaptiveCongestionControl::SendFrameToTransport(FrameId frame_id,
   frame_stats->frame_size_in_bits = frame_size_in_bits;
 }
 
+void AdaptiveCongestionControl::DropFrame(FrameId frame_id,
+                                          base::TimeTicks when) {
+  // Like a frame which was sent and ACKed at once, but with no data.
+  last_enqueued_frame_ = frame_id;
+  FrameStats* frame_stats = GetFrameStats(frame_id);
+  DCHECK(frame_stats);
+  frame_stats->enqueue_time = when;
+  frame_stats->ack_time = when;
+  frame_stats->frame_size_in_bits = 0;
+}
+
 base::TimeTicks AdaptiveCongestionControl::EstimatedSendingTime(
     FrameId frame_id,
     double estimated_bitrate) {
@@ -431,5 +580,387 @@ int AdaptiveCongestionControl::GetBitrate(base::TimeTicks playout_time,
                      max_bitrate_configured_);
 }
 
+// Trendline estimator: the window of points the slope is fitted to, the
+// smoothing applied to the accumulated delay, and the gain applied to the
+// slope before it is compared with the threshold.
+static const size_t kTrendlineWindowSize = 20;
+static const double kTrendlineSmoothingCoeff = 0.9;
+static const double kTrendlineThresholdGain = 4.0;
+static const int kMaxTrendlineSamples = 60;
+
+// Overuse detector: the adaptive threshold moves towards the magnitude of the
+// trend, faster upwards than downwards, so that the controller is not starved
+// by concurrent TCP flows but still catches sustained queue growth.
+static const double kInitialThresholdMs = 12.5;
+static const double kMinThresholdMs = 6;
+static const double kMaxThresholdMs = 600;
+static const double kThresholdUpGain = 0.0087;
+static const double kThresholdDownGain = 0.039;
+static const double kMaxThresholdOutlierMs = 15;
+static const int64_t kMaxThresholdUpdateMs = 100;
+static const int64_t kOverusingTimeThresholdMs = 10;
+
+// Rate controller: the multiplicative decrease applied to the acked bitrate
+// on overuse, the multiplicative increase per second while far from the link
+// capacity estimate, and the packet size that sets the additive increase
+// near it.
+static const double kDecreaseFactor = 0.85;
+static const double kMultiplicativeIncreasePerSecond = 1.08;
+static const double kAdditiveIncreasePacketBits = 1200 * 8;
+static const double kMaxTargetOverAckedBitrate = 1.5;
+static const int64_t kAckedBitrateWindowMs = 1000;
+
+// The share of the target playout delay that queueing may take up before the
+// path counts as overused, whatever the trend. Increases stop at half of it.
+static const int kMaxQueueDelayDivisor = 4;
+
+DelayBasedCongestionControl::DelayBasedCongestionControl(
+    const base::TickClock* clock,
+    int max_bitrate_configured,
+    int min_bitrate_configured,
+    int start_bitrate_configured)
+    : clock_(clock),
+      max_bitrate_configured_(max_bitrate_configured),
+      min_bitrate_configured_(min_bitrate_configured),
+      target_bitrate_(base::clamp(start_bitrate_configured,
+                                  min_bitrate_configured,
+                                  max_bitrate_configured)),
+      last_sent_frame_id_(FrameId::first() - 1),
+      threshold_ms_(kInitialThresholdMs) {
+  DCHECK_GE(max_bitrate_configured, min_bitrate_configured) << "Invalid config";
+  DCHECK_GT(min_bitrate_configured, 0);
+  last_rate_update_time_ = clock->NowTicks();
+}
+
+DelayBasedCongestionControl::~DelayBasedCongestionControl() = default;
+
+void DelayBasedCongestionControl::UpdateRtt(base::TimeDelta rtt) {
+  rtt_ = rtt_.is_zero() ? rtt : (7 * rtt_ + rtt) / 8;
+}
+
+void DelayBasedCongestionControl::UpdateTargetPlayoutDelay(
+    base::TimeDelta delay) {
+  target_playout_delay_ = delay;
+}
+
+void DelayBasedCongestionControl::SendFrameToTransport(
+    FrameId frame_id,
+    size_t frame_size_in_bits,
+    base::TimeTicks when) {
+  // Frames are sent once, in order; re-sends for kickstarting are not new
+  // data and must not restart the frame's delay measurement.
+  if (frame_id <= last_sent_frame_id_)
+    return;
+  last_sent_frame_id_ = frame_id;
+  in_flight_frames_.push_back({frame_id, when, frame_size_in_bits, false});
+}
+
+void DelayBasedCongestionControl::DropFrame(FrameId frame_id,
+                                            base::TimeTicks when) {
+  // The frame holds its place in |in_flight_frames_|, already acked so that
+  // it yields no delay sample.
+  if (frame_id <= last_sent_frame_id_)
+    return;
+  last_sent_frame_id_ = frame_id;
+  in_flight_frames_.push_back({frame_id, when, 0, true});
+  PruneAckedFrames();
+}
+
+void DelayBasedCongestionControl::AckFrame(FrameId frame_id,
+                                           base::TimeTicks when) {
+  while (!in_flight_frames_.empty() &&
+         in_flight_frames_.front().frame_id <= frame_id) {
+    InFlightFrame& frame = in_flight_frames_.front();
+    if (!frame.acked)
+      OnFrameAcked(&frame, when);
+    in_flight_frames_.pop_front();
+  }
+  PruneAckedFrames();
+}
+
+void DelayBasedCongestionControl::AckLaterFrames(
+    std::vector<FrameId> received_frames,
+    base::TimeTicks when) {
+  DCHECK(std::is_sorted(received_frames.begin(), received_frames.end()));
+  if (in_flight_frames_.empty())
+    return;
+  const FrameId first_in_flight = in_flight_frames_.front().frame_id;
+  for (FrameId frame_id : received_frames) {
+    if (frame_id < first_in_flight)
+      continue;
+    const size_t index = frame_id - first_in_flight;
+    if (index >= in_flight_frames_.size())
+      break;
+    InFlightFrame& frame = in_flight_frames_[index];
+    DCHECK_EQ(frame.frame_id, frame_id);
+    if (!frame.acked)
+      OnFrameAcked(&frame, when);
+  }
+  PruneAckedFrames();
+}
+
+void DelayBasedCongestionControl::OnFrameAcked(InFlightFrame* frame,
+                                               base::TimeTicks when) {
+  frame->acked = true;
+
+  if (first_ack_time_.is_null())
+    first_ack_time_ = when;
+  acked_bits_.emplace_back(when, frame->frame_size_in_bits);
+  acked_bits_in_window_ += frame->frame_size_in_bits;
+  while (when - acked_bits_.front().first >
+         base::Milliseconds(kAckedBitrateWindowMs)) {
+    acked_bits_in_window_ -= acked_bits_.front().second;
+    acked_bits_.pop_front();
+  }
+
+  // Frames acked together (typically by one RTCP message) form a group; the
+  // group is timed by its most recently sent frame.
+  if (when != group_ack_time_) {
+    if (!group_ack_time_.is_null())
+      ProcessAckGroup();
+    group_ack_time_ = when;
+    group_send_time_ = frame->send_time;
+  } else {
+    group_send_time_ = std::max(group_send_time_, frame->send_time);
+  }
+}
+
+void DelayBasedCongestionControl::PruneAckedFrames() {
+  while (!in_flight_frames_.empty() && in_flight_frames_.front().acked)
+    in_flight_frames_.pop_front();
+}
+
+void DelayBasedCongestionControl::ProcessAckGroup() {
+  // A group timed by a frame older than the last one carries no new
+  // information about the current queueing delay.
+  if (group_send_time_ <= last_group_send_time_)
+    return;
+
+  const base::TimeDelta ack_delay = group_ack_time_ - group_send_time_;
+  min_ack_delay_ = std::min(min_ack_delay_, ack_delay);
+  queue_delay_ = ack_delay - min_ack_delay_;
+  TRACE_COUNTER_ID1("cast.stream", "Queue Delay", this,
+                    queue_delay_.InMilliseconds());
+
+  if (last_group_ack_time_.is_null()) {
+    last_group_send_time_ = group_send_time_;
+    last_group_ack_time_ = group_ack_time_;
+    return;
+  }
+
+  const base::TimeDelta inter_arrival = group_ack_time_ - last_group_ack_time_;
+  const base::TimeDelta inter_departure =
+      group_send_time_ - last_group_send_time_;
+  last_group_send_time_ = group_send_time_;
+  last_group_ack_time_ = group_ack_time_;
+
+  // Trendline estimator: fit a line to the smoothed, accumulated delay
+  // gradient; its slope is positive while queues along the path grow.
+  accumulated_delay_ms_ += (inter_arrival - inter_departure).InMillisecondsF();
+  smoothed_delay_ms_ = kTrendlineSmoothingCoeff * smoothed_delay_ms_ +
+                       (1 - kTrendlineSmoothingCoeff) * accumulated_delay_ms_;
+  num_delay_samples_ = std::min(num_delay_samples_ + 1, kMaxTrendlineSamples);
+  delay_history_.emplace_back(
+      (group_ack_time_ - first_ack_time_).InMillisecondsF(),
+      smoothed_delay_ms_);
+  if (delay_history_.size() > kTrendlineWindowSize)
+    delay_history_.pop_front();
+
+  double trend = previous_trend_;
+  if (delay_history_.size() == kTrendlineWindowSize) {
+    double mean_x = 0;
+    double mean_y = 0;
+    for (const auto& point : delay_history_) {
+      mean_x += point.first;
+      mean_y += point.second;
+    }
+    mean_x /= delay_history_.size();
+    mean_y /= delay_history_.size();
+    double numerator = 0;
+    double denominator = 0;
+    for (const auto& point : delay_history_) {
+      numerator += (point.first - mean_x) * (point.second - mean_y);
+      denominator += (point.first - mean_x) * (point.first - mean_x);
+    }
+    if (denominator != 0)
+      trend = numerator / denominator;
+  }
+
+  BandwidthUsage usage = Detect(trend, inter_arrival);
+  previous_trend_ = trend;
+  // The trend needs a full window of samples to react, while frames queued
+  // for a large share of the playout delay are about to arrive too late.
+  if (MaxQueueDelay().is_positive() && queue_delay_ > MaxQueueDelay())
+    usage = BandwidthUsage::kOverusing;
+  UpdateRate(usage, group_ack_time_);
+}
+
+DelayBasedCongestionControl::BandwidthUsage DelayBasedCongestionControl::Detect(
+    double trend,
+    base::TimeDelta since_last_sample) {
+  const double modified_trend =
+      num_delay_samples_ * trend * kTrendlineThresholdGain;
+  TRACE_COUNTER_ID1("cast.stream", "Delay Trend", this, modified_trend);
+
+  if (modified_trend > threshold_ms_) {
+    if (time_over_using_.is_negative()) {
+      // Assume the overuse started half-way through the sample interval.
+      time_over_using_ = since_last_sample / 2;
+    } else {
+      time_over_using_ += since_last_sample;
+    }
+    ++overuse_counter_;
+    if (time_over_using_ > base::Milliseconds(kOverusingTimeThresholdMs) &&
+        overuse_counter_ > 1 && trend >= previous_trend_) {
+      time_over_using_ = base::TimeDelta();
+      overuse_counter_ = 0;
+      last_usage_ = BandwidthUsage::kOverusing;
+    }
+  } else if (modified_trend < -threshold_ms_) {
+    time_over_using_ = base::Milliseconds(-1);
+    overuse_counter_ = 0;
+    last_usage_ = BandwidthUsage::kUnderusing;
+  } else {
+    time_over_using_ = base::Milliseconds(-1);
+    overuse_counter_ = 0;
+    last_usage_ = BandwidthUsage::kNormal;
+  }
+
+  UpdateThreshold(modified_trend, since_last_sample);
+  return last_usage_;
+}
+
+void DelayBasedCongestionControl::UpdateThreshold(
+    double modified_trend,
+    base::TimeDelta since_last_sample) {
+  const double magnitude = std::abs(modified_trend);
+  // Don't let spikes from e.g. a rerouted path drag the threshold along.
+  if (magnitude > threshold_ms_ + kMaxThresholdOutlierMs)
+    return;
+  const double gain =
+      magnitude < threshold_ms_ ? kThresholdDownGain : kThresholdUpGain;
+  const double elapsed_ms =
+      std::min(since_last_sample,
+               base::Milliseconds(kMaxThresholdUpdateMs))
+          .InMillisecondsF();
+  threshold_ms_ += gain * (magnitude - threshold_ms_) * elapsed_ms;
+  threshold_ms_ = base::clamp(threshold_ms_, kMinThresholdMs, kMaxThresholdMs);
+}
+
+void DelayBasedCongestionControl::UpdateRate(BandwidthUsage usage,
+                                             base::TimeTicks now) {
+  switch (usage) {
+    case BandwidthUsage::kOverusing:
+      // Give each decrease a response time to take effect before cutting
+      // again.
+      if (rate_control_state_ != RateControlState::kDecrease ||
+          now - last_decrease_time_ > ResponseTime()) {
+        DecreaseRate(now);
+      }
+      break;
+    case BandwidthUsage::kUnderusing:
+      // Let the queues drain at the current rate.
+      rate_control_state_ = RateControlState::kHold;
+      break;
+    case BandwidthUsage::kNormal:
+      // Don't probe for more while the queue already takes up a good part of
+      // the playout delay; wait for it to drain.
+      if (MaxQueueDelay().is_positive() &&
+          queue_delay_ > MaxQueueDelay() / 2) {
+        rate_control_state_ = RateControlState::kHold;
+        break;
+      }
+      if (rate_control_state_ == RateControlState::kIncrease) {
+        const double elapsed_seconds =
+            std::min(now - last_rate_update_time_, base::Seconds(1))
+                .InSecondsF();
+        const bool near_capacity =
+            link_capacity_estimate_ > 0 &&
+            target_bitrate_ < link_capacity_estimate_ * 1.5;
+        if (near_capacity) {
+          // Additive increase: about one packet per response time.
+          target_bitrate_ += kAdditiveIncreasePacketBits /
+                             ResponseTime().InSecondsF() * elapsed_seconds;
+        } else {
+          target_bitrate_ *=
+              std::pow(kMultiplicativeIncreasePerSecond, elapsed_seconds);
+        }
+        // Never run far ahead of what the path has actually delivered.
+        const double acked_bitrate = AckedBitrate();
+        if (acked_bitrate > 0) {
+          target_bitrate_ = std::min(
+              target_bitrate_, kMaxTargetOverAckedBitrate * acked_bitrate +
+                                   kAdditiveIncreasePacketBits);
+        }
+      }
+      rate_control_state_ = RateControlState::kIncrease;
+      break;
+  }
+  target_bitrate_ = base::clamp(target_bitrate_,
+                                static_cast<double>(min_bitrate_configured_),
+                                static_cast<double>(max_bitrate_configured_));
+  last_rate_update_time_ = now;
+}
+
+void DelayBasedCongestionControl::DecreaseRate(base::TimeTicks now) {
+  const double acked_bitrate = AckedBitrate();
+  const double decreased_bitrate =
+      kDecreaseFactor * (acked_bitrate > 0 ? acked_bitrate : target_bitrate_);
+  if (decreased_bitrate < target_bitrate_) {
+    target_bitrate_ = std::max(decreased_bitrate,
+                               static_cast<double>(min_bitrate_configured_));
+  }
+  if (acked_bitrate > 0) {
+    link_capacity_estimate_ =
+        link_capacity_estimate_ > 0
+            ? 0.95 * link_capacity_estimate_ + 0.05 * acked_bitrate
+            : acked_bitrate;
+  }
+  rate_control_state_ = RateControlState::kDecrease;
+  last_decrease_time_ = now;
+  VLOG(2) << "Delay-based decrease to " << (target_bitrate_ / 1E6) << " Mbps";
+}
+
+double DelayBasedCongestionControl::AckedBitrate() const {
+  if (acked_bits_.empty() ||
+      acked_bits_.back().first - first_ack_time_ <
+          base::Milliseconds(kAckedBitrateWindowMs)) {
+    return 0;
+  }
+  return acked_bits_in_window_ /
+         base::Milliseconds(kAckedBitrateWindowMs).InSecondsF();
+}
+
+base::TimeDelta DelayBasedCongestionControl::ResponseTime() const {
+  return rtt_ + base::Milliseconds(100);
+}
+
+base::TimeDelta DelayBasedCongestionControl::MaxQueueDelay() const {
+  return target_playout_delay_ / kMaxQueueDelayDivisor;
+}
+
+int DelayBasedCongestionControl::GetBitrate(base::TimeTicks playout_time,
+                                            base::TimeDelta playout_delay) {
+  const base::TimeTicks now = clock_->NowTicks();
+
+  // The delay trend only moves when ACKs arrive. If the path stalls, or loses
+  // so much that a frame has been waiting for half the playout delay, treat
+  // it as overuse rather than wait for ACKs that may come too late.
+  if (!in_flight_frames_.empty() && playout_delay.is_positive() &&
+      now - in_flight_frames_.front().send_time > playout_delay / 2 &&
+      now - last_decrease_time_ > ResponseTime()) {
+    DecreaseRate(now);
+    last_rate_update_time_ = now;
+  }
+
+  const int bits_per_second = base::ClampRound(target_bitrate_);
+  VLOG(3) << " DBR:" << (bits_per_second / 1E6)
+          << " THR:" << threshold_ms_;
+  TRACE_COUNTER_ID1("cast.stream", "Delay Based Bitrate", this,
+                    bits_per_second);
+  return base::clamp(bits_per_second, min_bitrate_configured_,
+                     max_bitrate_configured_);
+}
+
 }  // namespace cast
 }  // namespace media
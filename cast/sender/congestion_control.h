@@ -33,6 +33,11 @@ class CongestionControl {
                                     size_t frame_size_in_bits,
                                     base::TimeTicks when) = 0;
 
+  // Called instead of SendFrameToTransport() when an encoded frame of a
+  // temporal enhancement layer is dropped rather than sent. The frame takes no
+  // time to transmit and is never ACKed on its own.
+  virtual void DropFrame(FrameId frame_id, base::TimeTicks when) = 0;
+
   // Called when we receive an ACK for a frame.
   virtual void AckFrame(FrameId frame_id, base::TimeTicks when) = 0;
 
@@ -53,6 +58,17 @@ CongestionControl* NewAdaptiveCongestionControl(const base::TickClock* clock,
 
 CongestionControl* NewFixedCongestionControl(int bitrate);
 
+// Returns a delay-gradient controller, in the spirit of Google Congestion
+// Control: it tracks the trend of the time between sending a frame and
+// receiving its ACK, backs off multiplicatively when that trend shows queues
+// building along the path, and probes upwards while it is flat. It starts at
+// |start_bitrate_configured|, or at the minimum if that is not set.
+CongestionControl* NewDelayBasedCongestionControl(
+    const base::TickClock* clock,
+    int max_bitrate_configured,
+    int min_bitrate_configured,
+    int start_bitrate_configured);
+
 }  // namespace cast
 }  // namespace media
 
@@ -4,6 +4,8 @@
 
 #include <stddef.h>
 #include <stdint.h>
+
+#include <algorithm>
 #include <vector>
 
 #include "base/bind.h"
@@ -186,5 +188,186 @@ TEST_F(CongestionControlTest, RetainsSufficientHistory) {
   }
 }
 
+class DelayBasedCongestionControlTest : public ::testing::Test {
+ public:
+  DelayBasedCongestionControlTest(const DelayBasedCongestionControlTest&) =
+      delete;
+  DelayBasedCongestionControlTest& operator=(
+      const DelayBasedCongestionControlTest&) = delete;
+
+ protected:
+  static constexpr base::TimeDelta kPlayoutDelay = base::Milliseconds(400);
+  static constexpr base::TimeDelta kOneWayDelay = base::Milliseconds(10);
+
+  DelayBasedCongestionControlTest()
+      : task_runner_(new FakeSingleThreadTaskRunner(&testing_clock_)) {
+    testing_clock_.Advance(base::Milliseconds(kStartMillisecond));
+  }
+
+  void CreateCongestionControl(int start_bitrate) {
+    congestion_control_.reset(NewDelayBasedCongestionControl(
+        &testing_clock_, kMaxBitrateConfigured, kMinBitrateConfigured,
+        start_bitrate));
+    congestion_control_->UpdateTargetPlayoutDelay(kPlayoutDelay);
+    link_free_time_ = testing_clock_.NowTicks();
+  }
+
+  void AckFrame(FrameId frame_id) {
+    congestion_control_->AckFrame(frame_id, testing_clock_.NowTicks());
+  }
+
+  // Sends a frame now and ACKs it |ack_delay| later.
+  void SendAndAckFrame(base::TimeDelta ack_delay) {
+    congestion_control_->SendFrameToTransport(frame_id_, 16384,
+                                              testing_clock_.NowTicks());
+    task_runner_->Sleep(ack_delay);
+    AckFrame(frame_id_++);
+  }
+
+  int GetBitrate() {
+    return congestion_control_->GetBitrate(
+        testing_clock_.NowTicks() + kPlayoutDelay, kPlayoutDelay);
+  }
+
+  // Sends a frame every kFrameDelayMs, sized for the bitrate the congestion
+  // control asks for, through a FIFO bottleneck of |link_bitrate|. Returns
+  // the average bitrate requested over the second half of the run.
+  int RunThroughBottleneck(base::TimeDelta duration, double link_bitrate) {
+    const int num_frames = duration.IntDiv(base::Milliseconds(kFrameDelayMs));
+    int64_t bitrate_sum = 0;
+    for (int i = 0; i < num_frames; ++i) {
+      const base::TimeTicks now = testing_clock_.NowTicks();
+      congestion_control_->UpdateRtt(2 * kOneWayDelay);
+      const int bitrate =
+          congestion_control_->GetBitrate(now + kPlayoutDelay, kPlayoutDelay);
+      EXPECT_GE(bitrate, kMinBitrateConfigured);
+      EXPECT_LE(bitrate, kMaxBitrateConfigured);
+      if (i >= num_frames / 2)
+        bitrate_sum += bitrate;
+
+      const size_t frame_size = bitrate * kFrameDelayMs / 1000;
+      congestion_control_->SendFrameToTransport(frame_id_, frame_size, now);
+      link_free_time_ = std::max(link_free_time_, now) +
+                        base::Seconds(frame_size / link_bitrate);
+      queueing_delay_ = link_free_time_ - now;
+      task_runner_->PostDelayedTask(
+          FROM_HERE,
+          base::BindOnce(&DelayBasedCongestionControlTest::AckFrame,
+                         base::Unretained(this), frame_id_),
+          queueing_delay_ + 2 * kOneWayDelay);
+      ++frame_id_;
+      task_runner_->Sleep(base::Milliseconds(kFrameDelayMs));
+    }
+    return bitrate_sum / (num_frames - num_frames / 2);
+  }
+
+  base::SimpleTestTickClock testing_clock_;
+  std::unique_ptr<CongestionControl> congestion_control_;
+  scoped_refptr<FakeSingleThreadTaskRunner> task_runner_;
+  FrameId frame_id_ = FrameId::first();
+  base::TimeTicks link_free_time_;
+  base::TimeDelta queueing_delay_;
+};
+
+// Tests that the bitrate ramps up to the maximum while the ACK delay stays
+// flat.
+TEST_F(DelayBasedCongestionControlTest, IncreasesOnUncongestedPath) {
+  CreateCongestionControl(kMinBitrateConfigured);
+  const int average_bitrate =
+      RunThroughBottleneck(base::Seconds(45), 10 * kMaxBitrateConfigured);
+  EXPECT_GT(average_bitrate, kMaxBitrateConfigured * 0.8);
+  EXPECT_LT(queueing_delay_, base::Milliseconds(10));
+}
+
+// Tests that, starting well above the capacity of the path, the bitrate is cut
+// once queues start to build and then settles around that capacity while
+// keeping the queue short.
+TEST_F(DelayBasedCongestionControlTest, ConvergesToBottleneckBitrate) {
+  constexpr double kLinkBitrate = 1500000;
+  CreateCongestionControl(kMaxBitrateConfigured * 0.8);
+  const int average_bitrate =
+      RunThroughBottleneck(base::Seconds(30), kLinkBitrate);
+  EXPECT_GT(average_bitrate, kLinkBitrate * 0.75);
+  EXPECT_LT(average_bitrate, kLinkBitrate * 1.1);
+  EXPECT_LT(queueing_delay_, kPlayoutDelay / 2);
+}
+
+// Tests that the bitrate backs off when frames stop being ACKed at all, even
+// though no delay samples arrive.
+TEST_F(DelayBasedCongestionControlTest, DecreasesWhenAcksStall) {
+  constexpr int kStartBitrate = 4000000;
+  CreateCongestionControl(kStartBitrate);
+  int bitrate = kStartBitrate;
+  for (int i = 0; i < 30; ++i) {
+    bitrate = congestion_control_->GetBitrate(
+        testing_clock_.NowTicks() + kPlayoutDelay, kPlayoutDelay);
+    congestion_control_->SendFrameToTransport(
+        frame_id_++, bitrate * kFrameDelayMs / 1000, testing_clock_.NowTicks());
+    task_runner_->Sleep(base::Milliseconds(kFrameDelayMs));
+  }
+  EXPECT_LT(bitrate, kStartBitrate / 2);
+  EXPECT_GE(bitrate, kMinBitrateConfigured);
+}
+
+// Tests that a frame queued for more than a quarter of the target playout
+// delay cuts the bitrate, before the trendline has enough samples to react.
+TEST_F(DelayBasedCongestionControlTest, DecreasesWhenQueueDelayGrows) {
+  CreateCongestionControl(2 * kMinBitrateConfigured);
+  for (int i = 0; i < 3; ++i)
+    SendAndAckFrame(2 * kOneWayDelay);
+  const int bitrate = GetBitrate();
+
+  SendAndAckFrame(2 * kOneWayDelay + kPlayoutDelay / 2);
+  // The ACK of the next frame closes the delayed frame's ACK group.
+  SendAndAckFrame(2 * kOneWayDelay);
+  EXPECT_LT(GetBitrate(), bitrate);
+}
+
+// Tests that frames ACKed out of order do not leave stale entries behind.
+TEST_F(DelayBasedCongestionControlTest, HandlesOutOfOrderAcks) {
+  CreateCongestionControl(2 * kMinBitrateConfigured);
+  for (int i = 0; i < 4; ++i) {
+    congestion_control_->SendFrameToTransport(FrameId::first() + i, 16384,
+                                              testing_clock_.NowTicks());
+  }
+  task_runner_->Sleep(base::Milliseconds(kFrameDelayMs));
+
+  congestion_control_->AckLaterFrames(
+      {FrameId::first() + 1, FrameId::first() + 3}, testing_clock_.NowTicks());
+  congestion_control_->AckFrame(FrameId::first() + 2,
+                                testing_clock_.NowTicks());
+
+  // With every frame ACKed, nothing is in flight, so however long the receiver
+  // stays quiet there is no reason to back off.
+  task_runner_->Sleep(kPlayoutDelay);
+  EXPECT_EQ(2 * kMinBitrateConfigured,
+            congestion_control_->GetBitrate(
+                testing_clock_.NowTicks() + kPlayoutDelay, kPlayoutDelay));
+}
+
+// Tests that frames of the temporal enhancement layers dropped by the sender
+// neither hold up the frames after them nor count as in flight.
+TEST_F(DelayBasedCongestionControlTest, HandlesDroppedFrames) {
+  CreateCongestionControl(2 * kMinBitrateConfigured);
+  for (int i = 0; i < 4; ++i) {
+    const FrameId frame_id = FrameId::first() + i;
+    if (i % 2)
+      congestion_control_->DropFrame(frame_id, testing_clock_.NowTicks());
+    else
+      congestion_control_->SendFrameToTransport(frame_id, 16384,
+                                                testing_clock_.NowTicks());
+  }
+  task_runner_->Sleep(base::Milliseconds(kFrameDelayMs));
+
+  congestion_control_->AckLaterFrames({FrameId::first() + 2},
+                                      testing_clock_.NowTicks());
+  congestion_control_->AckFrame(FrameId::first(), testing_clock_.NowTicks());
+
+  task_runner_->Sleep(kPlayoutDelay);
+  EXPECT_EQ(2 * kMinBitrateConfigured,
+            congestion_control_->GetBitrate(
+                testing_clock_.NowTicks() + kPlayoutDelay, kPlayoutDelay));
+}
+
 }  // namespace cast
 }  // namespace media
@@ -4,8 +4,10 @@
 
 #include "media/cast/sender/external_video_encoder.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <iterator>
 #include <sstream>
 #include <utility>
 
@@ -17,6 +19,7 @@
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
 #include "build/build_config.h"
 #include "media/base/bind_to_current_loop.h"
 #include "media/base/bitrate.h"
@@ -56,6 +59,20 @@ constexpr int kBacklogRedlineThreshold = 4;
 // histograms must encompass the range [-255, 255] (inclusive).
 constexpr int kQuantizationHistogramSize = 511;
 
+// The most temporal layers of a supported scalability mode (L1T3).
+constexpr int kMaxTemporalLayers = 3;
+
+// Returns the temporal layer of an encoded frame, as reported by the encoder.
+uint8_t GetTemporalLayerId(const media::BitstreamBufferMetadata& metadata) {
+  if (metadata.vp8)
+    return metadata.vp8->temporal_idx;
+  if (metadata.vp9)
+    return metadata.vp9->temporal_idx;
+  if (metadata.h264)
+    return metadata.h264->temporal_idx;
+  return 0;
+}
+
 }  // namespace
 
 namespace media {
@@ -63,6 +80,19 @@ namespace cast {
 
 // Container for the associated data of a video frame being processed.
 struct InProgressExternalVideoFrameEncode {
+  // How far the frame has got on its way to the VEA.
+  enum class State {
+    // |frame_to_encode| is being copied into a VEA input buffer.
+    kCopying,
+    // |frame_to_encode| can be handed to the VEA.
+    kReady,
+    // The VEA has the frame.
+    kEncoding,
+  };
+
+  // Identifies this encode to the callback of its input buffer copy.
+  const uint64_t id;
+
   // The source content to encode.
   const scoped_refptr<VideoFrame> video_frame;
 
@@ -80,12 +110,22 @@ struct InProgressExternalVideoFrameEncode {
   // of the CastEnvironment clock, the latter of which might be simulated.
   const base::TimeTicks start_time;
 
+  // The frame handed to the VEA: |video_frame| itself, or its copy in a VEA
+  // input buffer.
+  scoped_refptr<VideoFrame> frame_to_encode;
+
+  bool key_frame_requested = false;
+
+  State state = State::kCopying;
+
   InProgressExternalVideoFrameEncode(
+      uint64_t encode_id,
       scoped_refptr<VideoFrame> v_frame,
       base::TimeTicks r_time,
       VideoEncoder::FrameEncodedCallback callback,
       int bit_rate)
-      : video_frame(std::move(v_frame)),
+      : id(encode_id),
+        video_frame(std::move(v_frame)),
         reference_time(r_time),
         frame_encoded_callback(std::move(callback)),
         target_bit_rate(bit_rate),
@@ -105,7 +145,8 @@ class ExternalVideoEncoder::VEAClientImpl final
       const scoped_refptr<base::SingleThreadTaskRunner>& encoder_task_runner,
       std::unique_ptr<media::VideoEncodeAccelerator> vea,
       double max_frame_rate,
-      StatusChangeCallback status_change_cb)
+      StatusChangeCallback status_change_cb,
+      ExternalVideoEncoder::CopyFrameCallback copy_frame_cb)
       : cast_environment_(cast_environment),
         task_runner_(encoder_task_runner),
         max_frame_rate_(max_frame_rate),
@@ -116,8 +157,10 @@ class ExternalVideoEncoder::VEAClientImpl final
         key_frame_encountered_(false),
         codec_profile_(media::VIDEO_CODEC_PROFILE_UNKNOWN),
         key_frame_quantizer_parsable_(false),
+        num_temporal_layers_(1),
         requested_bit_rate_(-1),
-        allocate_input_buffer_in_progress_(false) {}
+        allocate_input_buffer_in_progress_(false),
+        copy_frame_cb_(std::move(copy_frame_cb)) {}
 
   VEAClientImpl(const VEAClientImpl&) = delete;
   VEAClientImpl& operator=(const VEAClientImpl&) = delete;
@@ -129,13 +172,29 @@ class ExternalVideoEncoder::VEAClientImpl final
   void Initialize(const gfx::Size& frame_size,
                   VideoCodecProfile codec_profile,
                   int start_bit_rate,
+                  int num_temporal_layers,
                   FrameId first_frame_id) {
     DCHECK(task_runner_->RunsTasksInCurrentSequence());
+    DCHECK_GE(num_temporal_layers, 1);
+    DCHECK_LE(num_temporal_layers, kMaxTemporalLayers);
 
     requested_bit_rate_ = start_bit_rate;
-    const media::VideoEncodeAccelerator::Config config(
+    num_temporal_layers_ = num_temporal_layers;
+    media::VideoEncodeAccelerator::Config config(
         media::PIXEL_FORMAT_I420, frame_size, codec_profile,
         media::Bitrate::ConstantBitrate(start_bit_rate));
+    if (num_temporal_layers > 1) {
+      // The structure of the temporal layers is up to the encoder. Frames
+      // only ever reference frames of a lower layer, or the previous frame of
+      // the base layer, which is what BitstreamBufferReady() assumes.
+      media::VideoEncodeAccelerator::Config::SpatialLayer layer;
+      layer.width = frame_size.width();
+      layer.height = frame_size.height();
+      layer.bitrate_bps = start_bit_rate;
+      layer.framerate = static_cast<uint32_t>(max_frame_rate_ + 0.5);
+      layer.num_of_temporal_layers = num_temporal_layers;
+      config.spatial_layers.push_back(layer);
+    }
     encoder_active_ = video_encode_accelerator_->Initialize(config, this);
     next_frame_id_ = first_frame_id;
     codec_profile_ = codec_profile;
@@ -178,8 +237,8 @@ class ExternalVideoEncoder::VEAClientImpl final
     DCHECK(task_runner_->RunsTasksInCurrentSequence());
 
     in_progress_frame_encodes_.push_back(InProgressExternalVideoFrameEncode(
-        video_frame, reference_time, std::move(frame_encoded_callback),
-        requested_bit_rate_));
+        next_encode_id_++, video_frame, reference_time,
+        std::move(frame_encoded_callback), requested_bit_rate_));
 
     if (!encoder_active_) {
       AbortLatestEncodeAttemptDueToErrors();
@@ -213,9 +272,11 @@ class ExternalVideoEncoder::VEAClientImpl final
     // TODO(crbug.com/888829): Revisit whether we can remove this memcpy, if VEA
     // can accept other "memory backing" methods.
     scoped_refptr<media::VideoFrame> frame = video_frame;
-    if (video_frame->coded_size() != frame_coded_size_ ||
+    const bool needs_copy =
+        video_frame->coded_size() != frame_coded_size_ ||
         video_frame->storage_type() !=
-            media::VideoFrame::StorageType::STORAGE_SHMEM) {
+            media::VideoFrame::StorageType::STORAGE_SHMEM;
+    if (needs_copy) {
       const int index = free_input_buffer_index_.back();
       std::pair<base::UnsafeSharedMemoryRegion,
                 base::WritableSharedMemoryMapping>* input_buffer =
@@ -227,7 +288,7 @@ class ExternalVideoEncoder::VEAClientImpl final
           video_frame->visible_rect().size(),
           input_buffer->second.GetMemoryAsSpan<uint8_t>().data(),
           input_buffer->second.size(), video_frame->timestamp());
-      if (!frame || !media::I420CopyWithPadding(*video_frame, frame.get())) {
+      if (!frame) {
         LOG(DFATAL) << "Error: ExternalVideoEncoder: copy failed.";
         AbortLatestEncodeAttemptDueToErrors();
         return;
@@ -239,8 +300,36 @@ class ExternalVideoEncoder::VEAClientImpl final
           index)));
       free_input_buffer_index_.pop_back();
     }
-    // BitstreamBufferReady will be called once the encoder is done.
-    video_encode_accelerator_->Encode(std::move(frame), key_frame_requested);
+
+    // Frames go to the VEA in order, so a frame that needs no copy still waits
+    // behind any frame whose copy is in progress.
+    InProgressExternalVideoFrameEncode& encode =
+        in_progress_frame_encodes_.back();
+    encode.frame_to_encode = frame;
+    encode.key_frame_requested = key_frame_requested;
+    if (!needs_copy) {
+      encode.state = InProgressExternalVideoFrameEncode::State::kReady;
+      EncodePendingFrames();
+      return;
+    }
+
+    base::OnceCallback<void(bool)> copied_cb =
+        base::BindOnce(&VEAClientImpl::OnFrameCopied, this, encode.id);
+    if (copy_frame_cb_) {
+      copy_frame_cb_.Run(std::move(video_frame), std::move(frame),
+                         media::BindToCurrentLoop(std::move(copied_cb)));
+      return;
+    }
+
+    // Large frames are copied in stripes on the thread pool, so that they
+    // don't hold up this thread. Processes without a thread pool, e.g. tests
+    // running everything on one fake task runner, copy on this thread.
+    scoped_refptr<base::TaskRunner> copy_task_runner;
+    if (!base::ThreadPoolInstance::Get())
+      copy_task_runner = task_runner_;
+    media::I420CopyWithPaddingMultiThreaded(
+        std::move(video_frame), std::move(frame), std::move(copy_task_runner),
+        std::move(copied_cb));
   }
 
  protected:
@@ -342,6 +431,8 @@ class ExternalVideoEncoder::VEAClientImpl final
     } else if (!in_progress_frame_encodes_.empty()) {
       InProgressExternalVideoFrameEncode& request =
           in_progress_frame_encodes_.front();
+      DCHECK(request.state ==
+             InProgressExternalVideoFrameEncode::State::kEncoding);
 
       std::unique_ptr<SenderEncodedFrame> encoded_frame(
           new SenderEncodedFrame());
@@ -350,8 +441,22 @@ class ExternalVideoEncoder::VEAClientImpl final
       encoded_frame->frame_id = next_frame_id_++;
       if (metadata.key_frame) {
         encoded_frame->referenced_frame_id = encoded_frame->frame_id;
-      } else {
+        last_frame_id_of_layer_.fill(encoded_frame->frame_id);
+      } else if (num_temporal_layers_ == 1) {
         encoded_frame->referenced_frame_id = encoded_frame->frame_id - 1;
+      } else {
+        const int layer = std::min<int>(GetTemporalLayerId(metadata),
+                                        num_temporal_layers_ - 1);
+        encoded_frame->temporal_layer_id = layer;
+        // A base layer frame references the previous one, and the others the
+        // newest frame of a lower layer.
+        FrameId referenced_frame_id = last_frame_id_of_layer_[0];
+        for (int i = 1; i < layer; ++i) {
+          referenced_frame_id =
+              std::max(referenced_frame_id, last_frame_id_of_layer_[i]);
+        }
+        encoded_frame->referenced_frame_id = referenced_frame_id;
+        last_frame_id_of_layer_[layer] = encoded_frame->frame_id;
       }
       encoded_frame->rtp_timestamp = RtpTimeTicks::FromTimeDelta(
           request.video_frame->timestamp(), kVideoFrequency);
@@ -483,14 +588,70 @@ class ExternalVideoEncoder::VEAClientImpl final
   // encode, or to abort a frame encode when shutting down.
   void AbortLatestEncodeAttemptDueToErrors() {
     DCHECK(task_runner_->RunsTasksInCurrentSequence());
+    AbortEncodeAttemptDueToErrors(std::prev(in_progress_frame_encodes_.end()));
+  }
+
+  void AbortEncodeAttemptDueToErrors(
+      std::list<InProgressExternalVideoFrameEncode>::iterator encode) {
+    DCHECK(task_runner_->RunsTasksInCurrentSequence());
 
     std::unique_ptr<SenderEncodedFrame> no_result(nullptr);
     cast_environment_->PostTask(
         CastEnvironment::MAIN, FROM_HERE,
-        base::BindOnce(
-            std::move(in_progress_frame_encodes_.back().frame_encoded_callback),
-            std::move(no_result)));
-    in_progress_frame_encodes_.pop_back();
+        base::BindOnce(std::move(encode->frame_encoded_callback),
+                       std::move(no_result)));
+    in_progress_frame_encodes_.erase(encode);
+  }
+
+  // Called once the frame of the encode with |encode_id| has been copied into
+  // its input buffer.
+  void OnFrameCopied(uint64_t encode_id, bool success) {
+    DCHECK(task_runner_->RunsTasksInCurrentSequence());
+
+    const auto encode = std::find_if(
+        in_progress_frame_encodes_.begin(), in_progress_frame_encodes_.end(),
+        [encode_id](const InProgressExternalVideoFrameEncode& encode) {
+          return encode.id == encode_id;
+        });
+    if (encode == in_progress_frame_encodes_.end())
+      return;
+    DCHECK(encode->state ==
+           InProgressExternalVideoFrameEncode::State::kCopying);
+
+    if (success) {
+      encode->state = InProgressExternalVideoFrameEncode::State::kReady;
+    } else {
+      LOG(ERROR) << "Error: ExternalVideoEncoder: copy failed.";
+      AbortEncodeAttemptDueToErrors(encode);
+    }
+    EncodePendingFrames();
+  }
+
+  // Hands the frames that are ready to the VEA in encode order, stopping at
+  // the first frame still being copied.
+  void EncodePendingFrames() {
+    DCHECK(task_runner_->RunsTasksInCurrentSequence());
+
+    auto encode = in_progress_frame_encodes_.begin();
+    while (encode != in_progress_frame_encodes_.end()) {
+      switch (encode->state) {
+        case InProgressExternalVideoFrameEncode::State::kCopying:
+          return;
+        case InProgressExternalVideoFrameEncode::State::kReady:
+          if (!encoder_active_) {
+            AbortEncodeAttemptDueToErrors(encode++);
+            continue;
+          }
+          encode->state = InProgressExternalVideoFrameEncode::State::kEncoding;
+          // BitstreamBufferReady will be called once the encoder is done.
+          video_encode_accelerator_->Encode(std::move(encode->frame_to_encode),
+                                            encode->key_frame_requested);
+          break;
+        case InProgressExternalVideoFrameEncode::State::kEncoding:
+          break;
+      }
+      ++encode;
+    }
   }
 
   // Parse H264 SPS, PPS, and Slice header, and return the averaged frame
@@ -573,6 +734,11 @@ class ExternalVideoEncoder::VEAClientImpl final
   bool key_frame_quantizer_parsable_;
   H264Parser h264_parser_;
 
+  // The number of temporal layers the encoder was configured with, and the
+  // ID of the newest frame of each, which later frames reference.
+  int num_temporal_layers_;
+  std::array<FrameId, kMaxTemporalLayers> last_frame_id_of_layer_;
+
   // Shared memory buffers for output with the VideoAccelerator.
   std::vector<std::pair<base::UnsafeSharedMemoryRegion,
                         base::WritableSharedMemoryMapping>>
@@ -594,6 +760,9 @@ class ExternalVideoEncoder::VEAClientImpl final
   // FIFO list.
   std::list<InProgressExternalVideoFrameEncode> in_progress_frame_encodes_;
 
+  // Identifies the next entry of |in_progress_frame_encodes_|.
+  uint64_t next_encode_id_ = 0;
+
   // The requested encode bit rate for the next frame.
   int requested_bit_rate_;
 
@@ -611,6 +780,9 @@ class ExternalVideoEncoder::VEAClientImpl final
   // Set to true when the allocation of an input buffer is in progress, and
   // reset to false after the allocated buffer is received.
   bool allocate_input_buffer_in_progress_;
+
+  // Replaces the copy of frames into input buffers, if set.
+  const ExternalVideoEncoder::CopyFrameCallback copy_frame_cb_;
 };
 
 // static
@@ -700,6 +872,13 @@ void ExternalVideoEncoder::GenerateKeyFrame() {
   key_frame_requested_ = true;
 }
 
+void ExternalVideoEncoder::SetCopyFrameCallbackForTesting(
+    CopyFrameCallback copy_frame_cb) {
+  DCHECK(cast_environment_->CurrentlyOn(CastEnvironment::MAIN));
+  DCHECK(!client_);
+  copy_frame_cb_ = std::move(copy_frame_cb);
+}
+
 void ExternalVideoEncoder::OnCreateVideoEncodeAccelerator(
     const FrameSenderConfig& video_config,
     FrameId first_frame_id,
@@ -767,11 +946,15 @@ void ExternalVideoEncoder::OnCreateVideoEncodeAccelerator(
   DCHECK(!client_);
   client_ = new VEAClientImpl(cast_environment_, encoder_task_runner,
                               std::move(vea), video_config.max_frame_rate,
-                              std::move(wrapped_status_change_cb));
+                              std::move(wrapped_status_change_cb),
+                              copy_frame_cb_);
   client_->task_runner()->PostTask(
       FROM_HERE,
-      base::BindOnce(&VEAClientImpl::Initialize, client_, frame_size_,
-                     codec_profile, bit_rate_, first_frame_id));
+      base::BindOnce(
+          &VEAClientImpl::Initialize, client_, frame_size_, codec_profile,
+          bit_rate_,
+          video_config.video_codec_params.GetNumberOfTemporalLayers(),
+          first_frame_id));
 }
 
 SizeAdaptableExternalVideoEncoder::SizeAdaptableExternalVideoEncoder(
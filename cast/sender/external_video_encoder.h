@@ -10,6 +10,7 @@
 
 #include <memory>
 
+#include "base/callback.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "media/cast/cast_environment.h"
@@ -26,6 +27,13 @@ namespace cast {
 // emits media::cast::EncodedFrames.
 class ExternalVideoEncoder final : public VideoEncoder {
  public:
+  // Copies a source frame into a VEA input buffer, then runs the callback with
+  // whether the copy succeeded.
+  using CopyFrameCallback = base::RepeatingCallback<void(
+      scoped_refptr<VideoFrame> src_frame,
+      scoped_refptr<VideoFrame> dst_frame,
+      base::OnceCallback<void(bool)> done_cb)>;
+
   // Returns true if the current platform and system configuration supports
   // using ExternalVideoEncoder with the given |video_config|.
   static bool IsSupported(const FrameSenderConfig& video_config);
@@ -50,6 +58,11 @@ class ExternalVideoEncoder final : public VideoEncoder {
   void SetBitRate(int new_bit_rate) final;
   void GenerateKeyFrame() final;
 
+  // Replaces I420CopyWithPaddingMultiThreaded() as the copy of frames into VEA
+  // input buffers, so tests control when, and whether, each copy completes.
+  // Must be called before the VEA is created.
+  void SetCopyFrameCallbackForTesting(CopyFrameCallback copy_frame_cb);
+
  private:
   class VEAClientImpl;
 
@@ -77,6 +90,8 @@ class ExternalVideoEncoder final : public VideoEncoder {
 
   scoped_refptr<VEAClientImpl> client_;
 
+  CopyFrameCallback copy_frame_cb_;
+
   // Provides a weak pointer for the OnCreateVideoEncoderAccelerator() callback.
   // NOTE: Weak pointers must be invalidated before all other member variables.
   base::WeakPtrFactory<ExternalVideoEncoder> weak_factory_{this};
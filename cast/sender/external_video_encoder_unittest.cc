@@ -6,8 +6,19 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "media/base/fake_single_thread_task_runner.h"
 #include "media/base/video_frame.h"
 #include "media/base/video_types.h"
+#include "media/cast/cast_environment.h"
+#include "media/cast/sender/fake_video_encode_accelerator_factory.h"
+#include "media/cast/test/utility/default_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace media {
@@ -15,6 +26,8 @@ namespace cast {
 
 namespace {
 
+constexpr gfx::Size kFrameSize(320, 240);
+
 scoped_refptr<VideoFrame> CreateFrame(const uint8_t* y_plane_data,
                                       const gfx::Size& size) {
   scoped_refptr<VideoFrame> result = VideoFrame::CreateFrame(PIXEL_FORMAT_I420,
@@ -33,6 +46,140 @@ scoped_refptr<VideoFrame> CreateFrame(const uint8_t* y_plane_data,
 
 } // namespace
 
+class ExternalVideoEncoderTest : public ::testing::Test {
+ public:
+  ExternalVideoEncoderTest(const ExternalVideoEncoderTest&) = delete;
+  ExternalVideoEncoderTest& operator=(const ExternalVideoEncoderTest&) =
+      delete;
+
+ protected:
+  ExternalVideoEncoderTest()
+      : task_runner_(new FakeSingleThreadTaskRunner(&testing_clock_)),
+        task_runner_handle_override_(task_runner_),
+        cast_environment_(new CastEnvironment(&testing_clock_,
+                                              task_runner_,
+                                              task_runner_,
+                                              task_runner_)),
+        vea_factory_(task_runner_) {
+    testing_clock_.Advance(base::TimeTicks::Now() - base::TimeTicks());
+  }
+
+  ~ExternalVideoEncoderTest() override = default;
+
+  void SetUp() final {
+    FrameSenderConfig video_config = GetDefaultVideoSenderConfig();
+    video_config.codec = CODEC_VIDEO_VP8;
+    video_config.use_external_encoder = true;
+    video_encoder_ = std::make_unique<ExternalVideoEncoder>(
+        cast_environment_, video_config, kFrameSize, FrameId::first(),
+        base::BindRepeating(
+            &ExternalVideoEncoderTest::OnOperationalStatusChange,
+            base::Unretained(this)),
+        base::BindRepeating(
+            &FakeVideoEncodeAcceleratorFactory::CreateVideoEncodeAccelerator,
+            base::Unretained(&vea_factory_)));
+    video_encoder_->SetCopyFrameCallbackForTesting(base::BindRepeating(
+        &ExternalVideoEncoderTest::CopyFrame, base::Unretained(this)));
+    vea_factory_.RespondWithVideoEncodeAccelerator();
+    task_runner_->RunTasks();
+    ASSERT_EQ(STATUS_INITIALIZED, operational_status_);
+  }
+
+  void TearDown() final {
+    video_encoder_.reset();
+    task_runner_->RunTasks();
+  }
+
+  // Encodes the frame numbered |frame_number|. The encoder allocates its input
+  // buffers on demand and drops each frame that finds none free, so with no
+  // copies completing every other frame is dropped, until all the buffers are
+  // allocated.
+  void EncodeFrame(int frame_number) {
+    const scoped_refptr<VideoFrame> frame = VideoFrame::CreateColorFrame(
+        kFrameSize, 0x80, 0x80, 0x80, base::Milliseconds(frame_number * 33));
+    ASSERT_TRUE(video_encoder_->EncodeVideoFrame(
+        frame, testing_clock_.NowTicks(),
+        base::BindOnce(&ExternalVideoEncoderTest::OnFrameEncoded,
+                       base::Unretained(this), frame_number)));
+    task_runner_->RunTasks();
+  }
+
+  // Finishes the |index|-th copy of a frame into an input buffer.
+  void CompleteCopy(size_t index, bool success) {
+    ASSERT_LT(index, copies_.size());
+    std::move(copies_[index]).Run(success);
+    task_runner_->RunTasks();
+  }
+
+  const std::vector<int>& encoded_frames() const { return encoded_frames_; }
+  const std::vector<int>& dropped_frames() const { return dropped_frames_; }
+  size_t num_copies() const { return copies_.size(); }
+
+ private:
+  void OnOperationalStatusChange(OperationalStatus status) {
+    operational_status_ = status;
+  }
+
+  void CopyFrame(scoped_refptr<VideoFrame> src_frame,
+                 scoped_refptr<VideoFrame> dst_frame,
+                 base::OnceCallback<void(bool)> done_cb) {
+    copies_.push_back(std::move(done_cb));
+  }
+
+  void OnFrameEncoded(int frame_number,
+                      std::unique_ptr<SenderEncodedFrame> encoded_frame) {
+    if (encoded_frame)
+      encoded_frames_.push_back(frame_number);
+    else
+      dropped_frames_.push_back(frame_number);
+  }
+
+  base::SimpleTestTickClock testing_clock_;
+  const scoped_refptr<FakeSingleThreadTaskRunner> task_runner_;
+  base::ThreadTaskRunnerHandleOverrideForTesting task_runner_handle_override_;
+  const scoped_refptr<CastEnvironment> cast_environment_;
+  FakeVideoEncodeAcceleratorFactory vea_factory_;
+  OperationalStatus operational_status_ = STATUS_UNINITIALIZED;
+  std::unique_ptr<ExternalVideoEncoder> video_encoder_;
+  std::vector<base::OnceCallback<void(bool)>> copies_;
+  std::vector<int> encoded_frames_;
+  std::vector<int> dropped_frames_;
+};
+
+// Frames reach the VEA in encode order even when their copies finish in the
+// opposite order.
+TEST_F(ExternalVideoEncoderTest, EncodesInOrderWhenCopiesFinishOutOfOrder) {
+  for (int i = 0; i < 6; ++i)
+    EncodeFrame(i);
+  EXPECT_EQ(std::vector<int>({0, 2, 4}), dropped_frames());
+  ASSERT_EQ(3u, num_copies());
+
+  CompleteCopy(2, true);
+  CompleteCopy(1, true);
+  EXPECT_TRUE(encoded_frames().empty());
+
+  CompleteCopy(0, true);
+  EXPECT_EQ(std::vector<int>({1, 3, 5}), encoded_frames());
+  EXPECT_EQ(std::vector<int>({0, 2, 4}), dropped_frames());
+}
+
+// A failed copy drops its own frame, even while an earlier frame is still
+// being copied, and does not hold up the frames after it.
+TEST_F(ExternalVideoEncoderTest, DropsFrameWhoseCopyFailed) {
+  for (int i = 0; i < 6; ++i)
+    EncodeFrame(i);
+  ASSERT_EQ(3u, num_copies());
+
+  CompleteCopy(1, false);
+  EXPECT_EQ(std::vector<int>({0, 2, 4, 3}), dropped_frames());
+  EXPECT_TRUE(encoded_frames().empty());
+
+  CompleteCopy(2, true);
+  CompleteCopy(0, false);
+  EXPECT_EQ(std::vector<int>({0, 2, 4, 3, 1}), dropped_frames());
+  EXPECT_EQ(std::vector<int>({5}), encoded_frames());
+}
+
 TEST(QuantizerEstimator, EstimatesForTrivialFrames) {
   QuantizerEstimator qe;
 
@@ -30,6 +30,11 @@ constexpr base::TimeDelta kReceiverProcessTime = base::Milliseconds(250);
 // maximum frame rate.
 constexpr int kMaxFrameBurst = 5;
 
+// The fraction of the allowed in-flight media duration above which frames of
+// the temporal enhancement layers are dropped rather than sent, leaving the
+// rest for the base layer.
+constexpr double kMaxEnhancementLayerInFlightFraction = 0.5;
+
 }  // namespace
 
 // Convenience macro used in logging statements throughout this file.
@@ -96,6 +101,7 @@ FrameSender::FrameSender(scoped_refptr<CastEnvironment> cast_environment,
   transport_config.rtp_payload_type = config.rtp_payload_type;
   transport_config.aes_key = config.aes_key;
   transport_config.aes_iv_mask = config.aes_iv_mask;
+  transport_config.enable_fec = config.enable_fec;
 
   transport_sender->InitializeStream(
       transport_config,
@@ -247,6 +253,24 @@ void FrameSender::SendEncodedFrame(
   const FrameId frame_id = encoded_frame->frame_id;
   const bool is_first_frame_to_be_sent = last_send_time_.is_null();
 
+  // Recorded for dropped frames too: the receiver ACKs past them, and the ACK
+  // event of a dropped frame ID must not read an older frame's timestamps.
+  RecordLatestFrameTimestamps(frame_id,
+                              encoded_frame->reference_time,
+                              encoded_frame->rtp_timestamp);
+
+  // Frames of the enhancement layers are not needed to decode the base layer,
+  // so they can be dropped without the receiver losing the picture. It skips
+  // over the missing frame IDs.
+  dropped_frames_[frame_id.lower_8_bits()] =
+      !is_first_frame_to_be_sent && encoded_frame->temporal_layer_id > 0 &&
+      ShouldDropEnhancementLayerFrame(*encoded_frame);
+  if (dropped_frames_[frame_id.lower_8_bits()]) {
+    congestion_control_->DropFrame(frame_id,
+                                   cast_environment_->Clock()->NowTicks());
+    return;
+  }
+
   if (picture_lost_at_receiver_ &&
       (encoded_frame->dependency == EncodedFrame::KEY)) {
     picture_lost_at_receiver_ = false;
@@ -287,10 +311,6 @@ void FrameSender::SendEncodedFrame(
       encoded_frame->lossy_utilization;
   cast_environment_->logger()->DispatchFrameEvent(std::move(encode_event));
 
-  RecordLatestFrameTimestamps(frame_id,
-                              encoded_frame->reference_time,
-                              encoded_frame->rtp_timestamp);
-
   if (!is_audio_) {
     // Used by chrome/browser/media/cast_mirroring_performance_browsertest.cc
     TRACE_EVENT_INSTANT1(
@@ -327,7 +347,7 @@ void FrameSender::SendEncodedFrame(
   TRACE_EVENT_NESTABLE_ASYNC_BEGIN1(
       "cast.stream", name, TRACE_ID_WITH_SCOPE(name, frame_id.lower_32_bits()),
       "rtp_timestamp", encoded_frame->rtp_timestamp.lower_32_bits());
-  transport_sender_->InsertFrame(ssrc_, *encoded_frame);
+  transport_sender_->InsertFrame(ssrc_, std::move(encoded_frame));
 }
 
 void FrameSender::OnCancelSendingFrames() {}
@@ -434,6 +454,24 @@ void FrameSender::OnReceivedPli() {
   picture_lost_at_receiver_ = true;
 }
 
+bool FrameSender::ShouldDropEnhancementLayerFrame(
+    const EncodedFrame& encoded_frame) const {
+  DCHECK_GT(encoded_frame.temporal_layer_id, 0);
+  if (dropped_frames_[encoded_frame.referenced_frame_id.lower_8_bits()]) {
+    VLOG(1) << SENDER_SSRC << "Dropping enhancement layer frame "
+            << encoded_frame.frame_id << ": its reference was dropped.";
+    return true;
+  }
+  const base::TimeDelta max_in_flight =
+      GetAllowedInFlightMediaDuration() * kMaxEnhancementLayerInFlightFraction;
+  if (GetInFlightMediaDuration() > max_in_flight) {
+    VLOG(1) << SENDER_SSRC << "Dropping enhancement layer frame "
+            << encoded_frame.frame_id << ": in-flight duration is too high.";
+    return true;
+  }
+  return false;
+}
+
 bool FrameSender::ShouldDropNextFrame(base::TimeDelta frame_duration) const {
   // Check that accepting the next frame won't cause more frames to become
   // in-flight than the system's design limit.
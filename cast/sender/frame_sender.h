@@ -111,6 +111,11 @@ class FrameSender {
   // the next frame having the given |frame_duration|.
   bool ShouldDropNextFrame(base::TimeDelta frame_duration) const;
 
+  // Returns true if |encoded_frame|, of a temporal enhancement layer, should
+  // be dropped instead of sent: either the network is congested enough that
+  // the base layer needs all of it, or the frame it references was dropped.
+  bool ShouldDropEnhancementLayerFrame(const EncodedFrame& encoded_frame) const;
+
   // Record or retrieve a recent history of each frame's timestamps.
   // Warning: If a frame ID too far in the past is requested, the getters will
   // silently succeed but return incorrect values.  Be sure to respect
@@ -203,6 +208,9 @@ class FrameSender {
   // buffer is the lower 8 bits of the FrameId.
   base::TimeTicks frame_reference_times_[256];
   RtpTimeTicks frame_rtp_timestamps_[256];
+  // Whether each recent frame was dropped by SendEncodedFrame(), indexed the
+  // same way.
+  bool dropped_frames_[256] = {};
 
   // NOTE: Weak pointers must be invalidated before all other member variables.
   base::WeakPtrFactory<FrameSender> weak_factory_{this};
@@ -91,8 +91,9 @@ class VideoEncoderTest
     return !!video_encoder_;
   }
 
-  bool is_testing_software_vp8_encoder() const {
-    return video_config_.codec == CODEC_VIDEO_VP8 &&
+  bool is_testing_software_vpx_encoder() const {
+    return (video_config_.codec == CODEC_VIDEO_VP8 ||
+            video_config_.codec == CODEC_VIDEO_VP9) &&
         !video_config_.use_external_encoder;
   }
 
@@ -122,6 +123,10 @@ class VideoEncoderTest
     video_encoder_.reset();
   }
 
+  void set_scalability_mode(SVCScalabilityMode scalability_mode) {
+    video_config_.video_codec_params.scalability_mode = scalability_mode;
+  }
+
   base::TimeTicks Now() { return testing_clock_.NowTicks(); }
 
   void RunTasksAndAdvanceClock() {
@@ -316,7 +321,7 @@ TEST_P(VideoEncoderTest, MAYBE_EncodesVariedFrameSizes) {
 
     // The utilization metrics are computed for all but the Mac Video Toolbox
     // encoder.
-    if (is_testing_software_vp8_encoder()) {
+    if (is_testing_software_vpx_encoder()) {
       ASSERT_TRUE(std::isfinite(encoded_frame->encoder_utilization));
       EXPECT_LE(0.0, encoded_frame->encoder_utilization);
       ASSERT_TRUE(std::isfinite(encoded_frame->lossy_utilization));
@@ -356,6 +361,54 @@ TEST_P(VideoEncoderTest, MAYBE_CanBeDestroyedBeforeVEAIsCreated) {
   ExpectVEAResponseForExternalVideoEncoder(1);
 }
 
+// Tests that, with L1T3 temporal scalability, the software VPX encoders emit
+// frames in the 0, 2, 1, 2 pattern of temporal layers, each referencing the
+// previous frame of the base layer, or the newest frame of a lower layer.
+TEST_P(VideoEncoderTest, EncodesTemporalLayers) {
+  if (!is_testing_software_vpx_encoder())
+    return;
+
+  set_scalability_mode(SVCScalabilityMode::kL1T3);
+  CreateEncoder();
+
+  using EncodedFrames = std::vector<std::unique_ptr<SenderEncodedFrame>>;
+  EncodedFrames encoded_frames;
+  base::WeakPtrFactory<EncodedFrames> encoded_frames_weak_factory(
+      &encoded_frames);
+  constexpr int kNumFrames = 12;
+  for (int i = 0; i < kNumFrames; ++i) {
+    EXPECT_TRUE(video_encoder()->EncodeVideoFrame(
+        CreateTestVideoFrame(gfx::Size(128, 72)), Now(),
+        base::BindOnce(
+            [](base::WeakPtr<EncodedFrames> encoded_frames,
+               std::unique_ptr<SenderEncodedFrame> encoded_frame) {
+              if (encoded_frames)
+                encoded_frames->emplace_back(std::move(encoded_frame));
+            },
+            encoded_frames_weak_factory.GetWeakPtr())));
+    RunTasksAndAdvanceClock();
+  }
+  video_encoder()->EmitFrames();
+  RunTasksAndAdvanceClock();
+  encoded_frames_weak_factory.InvalidateWeakPtrs();
+
+  const uint8_t kExpectedLayers[] = {0, 2, 1, 2};
+  const int kExpectedReferenceDistances[] = {4, 1, 2, 1};
+  ASSERT_EQ(static_cast<size_t>(kNumFrames), encoded_frames.size());
+  for (int i = 0; i < kNumFrames; ++i) {
+    const SenderEncodedFrame& encoded_frame = *encoded_frames[i];
+    if (i == 0) {
+      EXPECT_EQ(EncodedFrame::KEY, encoded_frame.dependency);
+      EXPECT_EQ(0, encoded_frame.temporal_layer_id);
+      continue;
+    }
+    EXPECT_EQ(EncodedFrame::DEPENDENT, encoded_frame.dependency);
+    EXPECT_EQ(kExpectedLayers[i % 4], encoded_frame.temporal_layer_id);
+    EXPECT_EQ(kExpectedReferenceDistances[i % 4],
+              encoded_frame.frame_id - encoded_frame.referenced_frame_id);
+  }
+}
+
 namespace {
 std::vector<std::pair<Codec, bool>> DetermineEncodersToTest() {
   std::vector<std::pair<Codec, bool>> values;
@@ -363,6 +416,8 @@ std::vector<std::pair<Codec, bool>> DetermineEncodersToTest() {
   values.push_back(std::make_pair(CODEC_VIDEO_FAKE, false));
   // Software VP8 encoder.
   values.push_back(std::make_pair(CODEC_VIDEO_VP8, false));
+  // Software VP9 encoder.
+  values.push_back(std::make_pair(CODEC_VIDEO_VP9, false));
   // Hardware-accelerated encoder (faked).
   values.push_back(std::make_pair(CODEC_VIDEO_VP8, true));
 #if defined(OS_MAC)
@@ -79,6 +79,25 @@ void LogVideoCaptureTimestamps(CastEnvironment* cast_environment,
   cast_environment->logger()->DispatchFrameEvent(std::move(capture_end_event));
 }
 
+CongestionControl* NewVideoCongestionControl(const base::TickClock* clock,
+                                             const FrameSenderConfig& config) {
+  if (config.use_external_encoder) {
+    return NewFixedCongestionControl((config.min_bitrate + config.max_bitrate) /
+                                     2);
+  }
+  switch (config.congestion_control_type) {
+    case CongestionControlType::ADAPTIVE:
+      break;
+    case CongestionControlType::DELAY_BASED:
+      return NewDelayBasedCongestionControl(clock, config.max_bitrate,
+                                            config.min_bitrate,
+                                            config.start_bitrate);
+  }
+  return NewAdaptiveCongestionControl(clock, config.max_bitrate,
+                                      config.min_bitrate,
+                                      config.max_frame_rate);
+}
+
 }  // namespace
 
 // Note, we use a fixed bitrate value when external video encoder is used.
@@ -97,13 +116,7 @@ VideoSender::VideoSender(
           cast_environment,
           transport_sender,
           video_config,
-          video_config.use_external_encoder
-              ? NewFixedCongestionControl(
-                    (video_config.min_bitrate + video_config.max_bitrate) / 2)
-              : NewAdaptiveCongestionControl(cast_environment->Clock(),
-                                             video_config.max_bitrate,
-                                             video_config.min_bitrate,
-                                             video_config.max_frame_rate)),
+          NewVideoCongestionControl(cast_environment->Clock(), video_config)),
       frames_in_encoder_(0),
       last_bitrate_(0),
       playout_delay_change_cb_(std::move(playout_delay_change_cb)),
@@ -4,6 +4,9 @@
 
 #include "media/cast/sender/vpx_encoder.h"
 
+#include <algorithm>
+
+#include "base/containers/span.h"
 #include "base/logging.h"
 #include "media/base/video_frame.h"
 #include "media/cast/constants.h"
@@ -50,6 +53,55 @@ const double kEquivalentEncodingSpeedStepPerQpStep = 1 / 20.0;
 const int kHighestEncodingSpeed = 12;
 const int kLowestEncodingSpeed = 6;
 
+// The same for VP9, for which libvpx only accepts speeds in [-9, 9], and
+// speeds lower than 5 are not meant for real-time encoding.
+const int kHighestVp9EncodingSpeed = 9;
+const int kLowestVp9EncodingSpeed = 5;
+
+// VP9 tile columns must be at least 256 pixels wide, and there may be at most
+// 64 of them.
+const int kMinVp9TileColumnWidth = 256;
+const int kMaxVp9TileColumnsLog2 = 6;
+
+// The encode time of frames, relative to their duration, above which frames
+// are at risk of missing their deadline and more threads are put to use, and
+// below which threads are given back.
+const double kHighDeadlineUtilization = 0.85;
+const double kLowDeadlineUtilization = 0.4;
+
+// A frame of a temporal layering pattern: which reference buffer it predicts
+// from, and which ones it updates. The ALTREF buffer is not used.
+struct TemporalLayerFrame {
+  int temporal_layer_id;
+  bool references_golden;  // Otherwise, it references the LAST buffer.
+  bool updates_last;
+  bool updates_golden;
+};
+
+// L1T2: the base layer predicts from the previous base layer frame, and the
+// frames in between from the base layer frame before them.
+const TemporalLayerFrame kL1T2Pattern[] = {
+    {0, false, true, false},
+    {1, false, false, false},
+};
+
+// L1T3: the same, but the frames of the middle layer are kept in the GOLDEN
+// buffer, for the top layer frame after them to predict from.
+const TemporalLayerFrame kL1T3Pattern[] = {
+    {0, false, true, false},
+    {2, false, false, false},
+    {1, false, false, true},
+    {2, true, false, false},
+};
+
+base::span<const TemporalLayerFrame> GetTemporalLayerPattern(int num_layers) {
+  DCHECK_GT(num_layers, 1);
+  DCHECK_LE(num_layers, 3);
+  if (num_layers == 2)
+    return kL1T2Pattern;
+  return kL1T3Pattern;
+}
+
 bool HasSufficientFeedback(
     const FeedbackSignalAccumulator<base::TimeDelta>& accumulator) {
   const base::TimeDelta amount_of_history =
@@ -57,6 +109,38 @@ bool HasSufficientFeedback(
   return amount_of_history.InMicroseconds() >= 250000;  // 0.25 second.
 }
 
+// Returns the number of threads worth using to encode frames of |frame_size|.
+// Every thread encodes rows of macroblocks, or of tiles for VP9, and small
+// frames do not have enough of them to keep many threads busy.
+int GetEncodeThreadsForFrameSize(const gfx::Size& frame_size,
+                                 int max_threads) {
+  const int area = frame_size.GetArea();
+  int threads;
+  if (area >= 3840 * 2160)
+    threads = 16;
+  else if (area >= 1920 * 1080)
+    threads = 8;
+  else if (area >= 1280 * 720)
+    threads = 4;
+  else if (area >= 640 * 360)
+    threads = 2;
+  else
+    threads = 1;
+  return std::max(1, std::min(threads, max_threads));
+}
+
+// Returns the log2 of the number of VP9 tile columns for |threads| threads to
+// encode frames |width| pixels wide in parallel.
+int GetVp9TileColumnsLog2(int width, int threads) {
+  int tile_columns_log2 = 0;
+  while (tile_columns_log2 < kMaxVp9TileColumnsLog2 &&
+         (2 << tile_columns_log2) <= threads &&
+         (width >> (tile_columns_log2 + 1)) >= kMinVp9TileColumnWidth) {
+    ++tile_columns_log2;
+  }
+  return tile_columns_log2;
+}
+
 }  // namespace
 
 VpxEncoder::VpxEncoder(const FrameSenderConfig& video_config)
@@ -71,7 +155,22 @@ VpxEncoder::VpxEncoder(const FrameSenderConfig& video_config)
       bitrate_kbit_(cast_config_.start_bitrate / 1000),
       next_frame_id_(FrameId::first()),
       encoding_speed_acc_(base::Microseconds(kEncodingSpeedAccHalfLife)),
-      encoding_speed_(kHighestEncodingSpeed) {
+      highest_encoding_speed_(video_config.codec == CODEC_VIDEO_VP9
+                                  ? kHighestVp9EncodingSpeed
+                                  : kHighestEncodingSpeed),
+      lowest_encoding_speed_(video_config.codec == CODEC_VIDEO_VP9
+                                 ? kLowestVp9EncodingSpeed
+                                 : kLowestEncodingSpeed),
+      max_encode_threads_(std::max(
+          1, video_config.video_codec_params.number_of_encode_threads)),
+      encode_threads_(1),
+      tile_columns_log2_(0),
+      deadline_utilization_acc_(
+          base::Microseconds(kEncodingSpeedAccHalfLife)),
+      num_temporal_layers_(
+          video_config.video_codec_params.GetNumberOfTemporalLayers()),
+      temporal_pattern_index_(0) {
+  encoding_speed_ = highest_encoding_speed_;
   config_.g_timebase.den = 0;  // Not initialized.
   DCHECK_LE(cast_config_.video_codec_params.min_qp,
             cast_config_.video_codec_params.max_cpu_saver_qp);
@@ -108,8 +207,11 @@ void VpxEncoder::ConfigureForNewFrameSize(const gfx::Size& frame_size) {
       config_.g_w = frame_size.width();
       config_.g_h = frame_size.height();
       config_.rc_min_quantizer = cast_config_.video_codec_params.min_qp;
-      if (vpx_codec_enc_config_set(&encoder_, &config_) == VPX_CODEC_OK)
+      if (vpx_codec_enc_config_set(&encoder_, &config_) == VPX_CODEC_OK) {
+        SetEncodeThreads(
+            GetEncodeThreadsForFrameSize(frame_size, max_encode_threads_));
         return;
+      }
       DVLOG(1) << "libvpx rejected the attempt to use a smaller frame size in "
                   "the current instance.";
     }
@@ -135,7 +237,9 @@ void VpxEncoder::ConfigureForNewFrameSize(const gfx::Size& frame_size) {
   // Populate encoder configuration with default values.
   CHECK_EQ(vpx_codec_enc_config_default(ctx, &config_, 0), VPX_CODEC_OK);
 
-  config_.g_threads = cast_config_.video_codec_params.number_of_encode_threads;
+  // The encoder is created for as many threads as it may ever use, so that
+  // UpdateEncodeThreads() can change their number without re-creating it.
+  config_.g_threads = max_encode_threads_;
   config_.g_w = frame_size.width();
   config_.g_h = frame_size.height();
   // Set the timebase to match that of base::TimeDelta.
@@ -185,9 +289,121 @@ void VpxEncoder::ConfigureForNewFrameSize(const gfx::Size& frame_size) {
   // windows machines. We choose to set negative values instead to directly set
   // the encoding speed to the encoder. Starting with the highest encoding speed
   // to avoid large cpu usage from the beginning.
-  encoding_speed_ = kHighestEncodingSpeed;
+  encoding_speed_ = highest_encoding_speed_;
   CHECK_EQ(vpx_codec_control(&encoder_, VP8E_SET_CPUUSED, -encoding_speed_),
            VPX_CODEC_OK);
+
+  if (cast_config_.codec == CODEC_VIDEO_VP9) {
+    // Let threads encode rows of the same tile column, so that the number of
+    // tile columns, which costs compression efficiency, can stay low.
+    CHECK_EQ(vpx_codec_control(&encoder_, VP9E_SET_ROW_MT, 1), VPX_CODEC_OK);
+  }
+  SetEncodeThreads(
+      GetEncodeThreadsForFrameSize(frame_size, max_encode_threads_));
+}
+
+void VpxEncoder::SetEncodeThreads(int threads) {
+  DCHECK(is_initialized());
+  DCHECK_GE(threads, 1);
+  DCHECK_LE(threads, max_encode_threads_);
+  if (static_cast<int>(config_.g_threads) != threads) {
+    config_.g_threads = threads;
+    CHECK_EQ(vpx_codec_enc_config_set(&encoder_, &config_), VPX_CODEC_OK);
+  }
+  encode_threads_ = threads;
+
+  if (cast_config_.codec == CODEC_VIDEO_VP9) {
+    tile_columns_log2_ = GetVp9TileColumnsLog2(config_.g_w, threads);
+    CHECK_EQ(vpx_codec_control(&encoder_, VP9E_SET_TILE_COLUMNS,
+                               tile_columns_log2_),
+             VPX_CODEC_OK);
+  }
+  DVLOG(1) << "VPX encoding with " << encode_threads_ << " threads and "
+           << (1 << tile_columns_log2_) << " tile columns.";
+}
+
+void VpxEncoder::UpdateEncodeThreads(double deadline_utilization,
+                                     base::TimeDelta timestamp,
+                                     bool is_key_frame) {
+  if (is_key_frame) {
+    deadline_utilization_acc_.Reset(deadline_utilization, timestamp);
+    return;
+  }
+  deadline_utilization_acc_.Update(deadline_utilization, timestamp);
+  if (!HasSufficientFeedback(deadline_utilization_acc_))
+    return;
+
+  const double utilization = deadline_utilization_acc_.current();
+  int threads = encode_threads_;
+  if (utilization > kHighDeadlineUtilization &&
+      encoding_speed_ == highest_encoding_speed_) {
+    // Raising the speed is cheaper in quality than more tile columns, so
+    // threads are only added once the speed is at its highest.
+    threads = std::min(max_encode_threads_, encode_threads_ * 2);
+  } else if (utilization < kLowDeadlineUtilization) {
+    const gfx::Size frame_size(config_.g_w, config_.g_h);
+    threads = std::max(
+        GetEncodeThreadsForFrameSize(frame_size, max_encode_threads_),
+        encode_threads_ / 2);
+  }
+  if (threads == encode_threads_)
+    return;
+  SetEncodeThreads(threads);
+  // Let the effect of the change show before making the next one.
+  deadline_utilization_acc_.Reset(utilization, timestamp);
+}
+
+vpx_enc_frame_flags_t VpxEncoder::GetTemporalLayerFlags() {
+  if (key_frame_requested_)
+    return VPX_EFLAG_FORCE_KF;
+  if (num_temporal_layers_ == 1)
+    return 0;
+
+  const base::span<const TemporalLayerFrame> pattern =
+      GetTemporalLayerPattern(num_temporal_layers_);
+  temporal_pattern_index_ = (temporal_pattern_index_ + 1) % pattern.size();
+  const TemporalLayerFrame& frame = pattern[temporal_pattern_index_];
+  vpx_enc_frame_flags_t flags = VP8_EFLAG_NO_REF_ARF | VP8_EFLAG_NO_UPD_ARF;
+  flags |=
+      frame.references_golden ? VP8_EFLAG_NO_REF_LAST : VP8_EFLAG_NO_REF_GF;
+  if (!frame.updates_last)
+    flags |= VP8_EFLAG_NO_UPD_LAST;
+  if (!frame.updates_golden)
+    flags |= VP8_EFLAG_NO_UPD_GF;
+  // The entropy contexts carry over from frame to frame too, so frames which
+  // may be dropped must leave them alone.
+  if (frame.temporal_layer_id > 0)
+    flags |= VP8_EFLAG_NO_UPD_ENTROPY;
+  return flags;
+}
+
+void VpxEncoder::SetTemporalLayerDependency(EncodedFrame* encoded_frame) {
+  if (encoded_frame->dependency == EncodedFrame::KEY) {
+    // Key frames refresh every reference buffer, and restart the pattern.
+    temporal_pattern_index_ = 0;
+    encoded_frame->temporal_layer_id = 0;
+    last_buffer_frame_id_ = encoded_frame->frame_id;
+    golden_buffer_frame_id_ = encoded_frame->frame_id;
+    return;
+  }
+  if (num_temporal_layers_ == 1) {
+    // Frame dependencies could theoretically be relaxed by looking for the
+    // VPX_FRAME_IS_DROPPABLE flag, but in recent testing (Oct 2014), this
+    // flag never seems to be set.
+    encoded_frame->referenced_frame_id = encoded_frame->frame_id - 1;
+    return;
+  }
+
+  const TemporalLayerFrame& frame =
+      GetTemporalLayerPattern(num_temporal_layers_)[temporal_pattern_index_];
+  encoded_frame->temporal_layer_id = frame.temporal_layer_id;
+  encoded_frame->referenced_frame_id = frame.references_golden
+                                           ? golden_buffer_frame_id_
+                                           : last_buffer_frame_id_;
+  if (frame.updates_last)
+    last_buffer_frame_id_ = encoded_frame->frame_id;
+  if (frame.updates_golden)
+    golden_buffer_frame_id_ = encoded_frame->frame_id;
 }
 
 void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
@@ -274,8 +490,7 @@ void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
   // micro-managed via calls to UpdateRates().
   CHECK_EQ(vpx_codec_encode(&encoder_, &vpx_image, 0,
                             predicted_frame_duration.InMicroseconds(),
-                            key_frame_requested_ ? VPX_EFLAG_FORCE_KF : 0,
-                            VPX_DL_REALTIME),
+                            GetTemporalLayerFlags(), VPX_DL_REALTIME),
            VPX_CODEC_OK)
       << "BUG: Invalid arguments passed to vpx_codec_encode().";
 
@@ -292,11 +507,8 @@ void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
       encoded_frame->referenced_frame_id = encoded_frame->frame_id;
     } else {
       encoded_frame->dependency = EncodedFrame::DEPENDENT;
-      // Frame dependencies could theoretically be relaxed by looking for the
-      // VPX_FRAME_IS_DROPPABLE flag, but in recent testing (Oct 2014), this
-      // flag never seems to be set.
-      encoded_frame->referenced_frame_id = encoded_frame->frame_id - 1;
     }
+    SetTemporalLayerDependency(encoded_frame);
     encoded_frame->rtp_timestamp =
         RtpTimeTicks::FromTimeDelta(video_frame->timestamp(), kVideoFrequency);
     encoded_frame->reference_time = reference_time;
@@ -335,6 +547,8 @@ void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
   encoded_frame->lossy_utilization = perfect_quantizer / 63.0;
 
   DVLOG(2) << "VPX encoded frame_id " << encoded_frame->frame_id
+           << ", temporal layer: "
+           << static_cast<int>(encoded_frame->temporal_layer_id)
            << ", sized: " << encoded_frame->data.size()
            << ", encoder_utilization: " << encoded_frame->encoder_utilization
            << ", lossy_utilization: " << encoded_frame->lossy_utilization
@@ -344,7 +558,8 @@ void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
     key_frame_requested_ = false;
   }
   if (encoded_frame->dependency == EncodedFrame::KEY) {
-    encoding_speed_acc_.Reset(kHighestEncodingSpeed, video_frame->timestamp());
+    encoding_speed_acc_.Reset(highest_encoding_speed_,
+                              video_frame->timestamp());
   } else {
     // Equivalent encoding speed considering both cpu_used setting and
     // quantizer.
@@ -365,9 +580,9 @@ void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
     // |min_quantizer| if needed.
     double next_encoding_speed = encoding_speed_acc_.current();
     int next_min_qp;
-    if (next_encoding_speed > kHighestEncodingSpeed) {
-      double remainder = next_encoding_speed - kHighestEncodingSpeed;
-      next_encoding_speed = kHighestEncodingSpeed;
+    if (next_encoding_speed > highest_encoding_speed_) {
+      double remainder = next_encoding_speed - highest_encoding_speed_;
+      next_encoding_speed = highest_encoding_speed_;
       next_min_qp =
           static_cast<int>(remainder / kEquivalentEncodingSpeedStepPerQpStep +
                            cast_config_.video_codec_params.min_qp + 0.5);
@@ -375,7 +590,7 @@ void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
                              cast_config_.video_codec_params.max_cpu_saver_qp);
     } else {
       next_encoding_speed =
-          std::max<double>(kLowestEncodingSpeed, next_encoding_speed) + 0.5;
+          std::max<double>(lowest_encoding_speed_, next_encoding_speed) + 0.5;
       next_min_qp = cast_config_.video_codec_params.min_qp;
     }
     if (encoding_speed_ != static_cast<int>(next_encoding_speed)) {
@@ -388,6 +603,10 @@ void VpxEncoder::Encode(scoped_refptr<media::VideoFrame> video_frame,
       CHECK_EQ(vpx_codec_enc_config_set(&encoder_, &config_), VPX_CODEC_OK);
     }
   }
+
+  UpdateEncodeThreads(encoded_frame->encoder_utilization,
+                      video_frame->timestamp(),
+                      encoded_frame->dependency == EncodedFrame::KEY);
 }
 
 void VpxEncoder::UpdateRates(uint32_t new_bitrate) {
@@ -54,6 +54,25 @@ class VpxEncoder final : public SoftwareVideoEncoder {
   // |encoder_| instance.
   void ConfigureForNewFrameSize(const gfx::Size& frame_size);
 
+  // Changes the number of threads the |encoder_| uses, and for VP9, the number
+  // of tile columns, without re-creating it.
+  void SetEncodeThreads(int threads);
+
+  // Puts more threads to use when frames are at risk of missing their
+  // deadline, even at the highest encoding speed, and gives them back once
+  // encoding is comfortably within the deadline.
+  void UpdateEncodeThreads(double deadline_utilization,
+                           base::TimeDelta timestamp,
+                           bool is_key_frame);
+
+  // Returns the encoding flags which make the next frame follow the temporal
+  // layering pattern, and advances |temporal_pattern_index_|.
+  vpx_enc_frame_flags_t GetTemporalLayerFlags();
+
+  // Sets the temporal layer and reference of |encoded_frame|, which was
+  // encoded with the flags from the last call to GetTemporalLayerFlags().
+  void SetTemporalLayerDependency(EncodedFrame* encoded_frame);
+
   const FrameSenderConfig cast_config_;
 
   const double target_encoder_utilization_;
@@ -85,6 +104,35 @@ class VpxEncoder final : public SoftwareVideoEncoder {
 
   // The higher the speed, the less CPU usage, and the lower quality.
   int encoding_speed_;
+
+  // The range of |encoding_speed_|, which depends on the codec.
+  const int highest_encoding_speed_;
+  const int lowest_encoding_speed_;
+
+  // The most threads the |encoder_| may use, from the config, and the number
+  // it currently uses, which is adapted to the frame size and encode time.
+  const int max_encode_threads_;
+  int encode_threads_;
+
+  // For VP9, the log2 of the number of tile columns, which bounds how many
+  // threads can encode a frame.
+  int tile_columns_log2_;
+
+  // The accumulator (time averaging) of the encode time of frames, relative
+  // to their duration.
+  FeedbackSignalAccumulator<base::TimeDelta> deadline_utilization_acc_;
+
+  // The number of temporal layers, from the scalability mode in the config.
+  const int num_temporal_layers_;
+
+  // The position of the last encoded frame in the temporal layering pattern,
+  // which restarts at every key frame.
+  size_t temporal_pattern_index_;
+
+  // The IDs of the frames in the LAST and GOLDEN reference buffers of the
+  // |encoder_|, which frames of the temporal layers reference.
+  FrameId last_buffer_frame_id_;
+  FrameId golden_buffer_frame_id_;
 };
 
 }  // namespace cast
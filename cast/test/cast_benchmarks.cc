@@ -20,13 +20,32 @@
 // $ export PROFILE_FILE=cast_benchmark.profile
 // Then after running the program, you can view the profile with:
 // $ pprof ./out/Release/cast_benchmarks $PROFILE_FILE --gv
+//
+// With --udp-loopback, the program instead measures how fast UdpTransportImpl
+// moves packets over the loopback interface, with and without batched IO:
+// $ ./out/Release/cast_benchmarks --udp-loopback
+//
+// With --encryption, the program instead measures the throughput of frame
+// encryption in TransportEncryptionHandler, with each of its APIs:
+// $ ./out/Release/cast_benchmarks --encryption
+//
+// With --framer, the program instead measures how fast the receiver's Framer
+// reassembles frames from their packets:
+// $ ./out/Release/cast_benchmarks --framer
+//
+// With --vpx-encoder, the program instead measures how fast the software VP8
+// and VP9 encoders keep up with 30 fps video at 1080p and 4K:
+// $ ./out/Release/cast_benchmarks --vpx-encoder
 
 #include <math.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -34,38 +53,56 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/command_line.h"
+#include "base/containers/span.h"
 #include "base/debug/profiler.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_file.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/memory/weak_ptr.h"
 #include "base/run_loop.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
+#include "base/system/sys_info.h"
 #include "base/task/single_thread_task_runner.h"
+#include "base/test/bind.h"
 #include "base/test/simple_test_tick_clock.h"
+#include "base/test/task_environment.h"
 #include "base/threading/thread.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "base/time/tick_clock.h"
+#include "base/values.h"
+#include "build/build_config.h"
 #include "media/base/audio_bus.h"
 #include "media/base/fake_single_thread_task_runner.h"
 #include "media/base/video_frame.h"
 #include "media/cast/cast_config.h"
 #include "media/cast/cast_environment.h"
 #include "media/cast/cast_sender.h"
+#include "media/cast/common/transport_encryption_handler.h"
+#include "media/cast/constants.h"
 #include "media/cast/logging/simple_event_subscriber.h"
 #include "media/cast/net/cast_transport.h"
 #include "media/cast/net/cast_transport_config.h"
 #include "media/cast/net/cast_transport_defines.h"
 #include "media/cast/net/cast_transport_impl.h"
+#include "media/cast/net/udp_transport_impl.h"
+#include "media/cast/sender/sender_encoded_frame.h"
+#include "media/cast/sender/vpx_encoder.h"
 #include "media/cast/test/loopback_transport.h"
 #include "media/cast/test/receiver/cast_receiver.h"
+#include "media/cast/test/receiver/framer.h"
 #include "media/cast/test/skewed_single_thread_task_runner.h"
 #include "media/cast/test/skewed_tick_clock.h"
 #include "media/cast/test/utility/audio_utility.h"
 #include "media/cast/test/utility/default_config.h"
+#include "media/cast/test/utility/net_utility.h"
 #include "media/cast/test/utility/test_util.h"
 #include "media/cast/test/utility/udp_proxy.h"
 #include "media/cast/test/utility/video_utility.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/geometry/rect.h"
+#include "ui/gfx/geometry/size.h"
 
 namespace media {
 namespace cast {
@@ -107,13 +144,13 @@ class CastTransportWrapper : public CastTransport {
     transport_->InitializeStream(config, std::move(rtcp_observer));
   }
 
-  void InsertFrame(uint32_t ssrc, const EncodedFrame& frame) final {
+  void InsertFrame(uint32_t ssrc, std::unique_ptr<EncodedFrame> frame) final {
     if (ssrc == audio_ssrc_) {
-      *encoded_audio_bytes_ += frame.data.size();
+      *encoded_audio_bytes_ += frame->data.size();
     } else if (ssrc == video_ssrc_) {
-      *encoded_video_bytes_ += frame.data.size();
+      *encoded_video_bytes_ += frame->data.size();
     }
-    transport_->InsertFrame(ssrc, frame);
+    transport_->InsertFrame(ssrc, std::move(frame));
   }
 
   void SendSenderReport(uint32_t ssrc,
@@ -708,12 +745,390 @@ class CastBenchmark {
   base::Lock lock_;
 };
 
+namespace {
+
+void IgnoreTransportStatus(CastTransportStatus status) {}
+
+// Sends packets between two UdpTransportImpls over the loopback interface as
+// fast as they go, in bursts the size PacedSender uses, and reports the
+// throughput.
+class UdpLoopbackBenchmark {
+ public:
+  static constexpr size_t kPacketSize = 1200;
+  static constexpr size_t kBurstSize = kMaxBurstSize;
+
+  explicit UdpLoopbackBenchmark(const base::DictionaryValue& options) {
+    const net::IPEndPoint sender_addr = test::GetFreeLocalPort();
+    const net::IPEndPoint receiver_addr = test::GetFreeLocalPort();
+    sender_ = std::make_unique<UdpTransportImpl>(
+        base::ThreadTaskRunnerHandle::Get(), sender_addr, receiver_addr,
+        base::BindRepeating(&IgnoreTransportStatus));
+    receiver_ = std::make_unique<UdpTransportImpl>(
+        base::ThreadTaskRunnerHandle::Get(), receiver_addr, sender_addr,
+        base::BindRepeating(&IgnoreTransportStatus));
+    sender_->SetUdpOptions(options);
+    receiver_->SetUdpOptions(options);
+  }
+
+  UdpLoopbackBenchmark(const UdpLoopbackBenchmark&) = delete;
+  UdpLoopbackBenchmark& operator=(const UdpLoopbackBenchmark&) = delete;
+
+  void Run(const std::string& name, size_t num_packets) {
+    num_packets_ = num_packets;
+    packet_ = base::MakeRefCounted<OutgoingPacket>(Packet(kPacketSize, 0));
+    receiver_->StartReceiving(
+        base::BindRepeating(&UdpLoopbackBenchmark::OnPacketReceived,
+                            base::Unretained(this)));
+    sender_->StartReceiving(base::BindRepeating(
+        [](std::unique_ptr<Packet> packet) { return true; }));
+
+    start_time_ = base::TimeTicks::Now();
+    last_receive_time_ = start_time_;
+    SendBurst();
+    run_loop_.Run();
+
+    const double seconds = (last_receive_time_ - start_time_).InSecondsF();
+    fprintf(stdout,
+            "udp loopback %-10s: %zu/%zu packets received, "
+            "%.0f packets/s, %.1f Mbit/s\n",
+            name.c_str(), packets_received_, num_packets_,
+            packets_received_ / seconds,
+            packets_received_ * kPacketSize * 8 / seconds / 1e6);
+    fflush(stdout);
+  }
+
+ private:
+  void SendBurst() {
+    for (size_t i = 0; i < kBurstSize && packets_sent_ < num_packets_; ++i) {
+      ++packets_sent_;
+      if (!sender_->SendPacket(
+              packet_, base::BindOnce(&UdpLoopbackBenchmark::SendBurst,
+                                      base::Unretained(this)))) {
+        return;  // Resumed once the socket drains.
+      }
+    }
+    sender_->FlushPackets();
+
+    if (packets_sent_ < num_packets_) {
+      base::ThreadTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE, base::BindOnce(&UdpLoopbackBenchmark::SendBurst,
+                                    base::Unretained(this)));
+    } else {
+      // Packets which haven't arrived shortly after the last send are counted
+      // as lost.
+      base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+          FROM_HERE, run_loop_.QuitClosure(), base::Milliseconds(200));
+    }
+  }
+
+  bool OnPacketReceived(std::unique_ptr<Packet> packet) {
+    last_receive_time_ = base::TimeTicks::Now();
+    if (++packets_received_ == num_packets_)
+      run_loop_.Quit();
+    return true;
+  }
+
+  std::unique_ptr<UdpTransportImpl> sender_;
+  std::unique_ptr<UdpTransportImpl> receiver_;
+  PacketRef packet_;
+  size_t num_packets_ = 0;
+  size_t packets_sent_ = 0;
+  size_t packets_received_ = 0;
+  base::TimeTicks start_time_;
+  base::TimeTicks last_receive_time_;
+  base::RunLoop run_loop_;
+};
+
+void RunUdpLoopbackBenchmarks() {
+  base::test::TaskEnvironment task_environment(
+      base::test::TaskEnvironment::MainThreadType::IO);
+  constexpr size_t kNumPackets = 200000;
+
+  std::vector<std::string> modes = {"default"};
+#if defined(OS_LINUX) || defined(OS_CHROMEOS)
+  modes.push_back("batched_io");
+  modes.push_back("udp_gso");
+#endif
+  for (const std::string& mode : modes) {
+    base::DictionaryValue options;
+    if (mode != "default")
+      options.SetBoolKey(mode, true);
+    UdpLoopbackBenchmark(options).Run(mode, kNumPackets);
+  }
+}
+
+// Feeds the packets of many frames to a Framer and takes the frames out again,
+// as FrameReceiver does, and reports the throughput.
+class FramerBenchmark : public RtpPayloadFeedback {
+ public:
+  // The payload size RtpPacketizer uses for full packets.
+  static constexpr size_t kPayloadSize = 1200;
+
+  FramerBenchmark() = default;
+
+  FramerBenchmark(const FramerBenchmark&) = delete;
+  FramerBenchmark& operator=(const FramerBenchmark&) = delete;
+
+  ~FramerBenchmark() override = default;
+
+  // Reassembles |num_frames| frames of |frame_size| bytes, receiving the
+  // packets of each frame last to first if |reverse_packet_order|.
+  void Run(size_t frame_size, size_t num_frames, bool reverse_packet_order) {
+    Framer framer(&clock_, this, 1, true, kMaxUnackedFrames);
+    const std::string frame_data(frame_size, 'x');
+    const size_t num_packets = (frame_size + kPayloadSize - 1) / kPayloadSize;
+    RtpCastHeader header;
+    header.max_packet_id = static_cast<uint16_t>(num_packets - 1);
+    EncodedFrame frame;
+    size_t bytes_received = 0;
+
+    const base::TimeTicks start = base::TimeTicks::Now();
+    for (size_t i = 0; i < num_frames; ++i) {
+      header.frame_id = FrameId::first() + static_cast<int64_t>(i);
+      header.reference_frame_id = header.frame_id;
+      header.is_key_frame = true;
+      for (size_t j = 0; j < num_packets; ++j) {
+        header.packet_id = static_cast<uint16_t>(
+            reverse_packet_order ? num_packets - 1 - j : j);
+        const size_t offset = header.packet_id * kPayloadSize;
+        bool duplicate = false;
+        framer.InsertPacket(
+            reinterpret_cast<const uint8_t*>(frame_data.data()) + offset,
+            std::min(kPayloadSize, frame_size - offset), header, &duplicate);
+      }
+      bool next_frame = false;
+      bool have_multiple_frames = false;
+      CHECK(framer.PeekEncodedFrame(&frame, &next_frame,
+                                    &have_multiple_frames));
+      framer.TakeFrameData(frame.frame_id, &frame.data);
+      bytes_received += frame.data.size();
+      framer.ReleaseFrame(frame.frame_id);
+    }
+    const double seconds = (base::TimeTicks::Now() - start).InSecondsF();
+
+    CHECK_EQ(bytes_received, num_frames * frame_size);
+    fprintf(stdout,
+            "framer %7zu byte frames%s: %.0f frames/s, %.0f packets/s, "
+            "%.0f MB/s\n",
+            frame_size, reverse_packet_order ? " (reordered)" : "",
+            num_frames / seconds, num_frames * num_packets / seconds,
+            bytes_received / seconds / 1e6);
+    fflush(stdout);
+  }
+
+  // RtpPayloadFeedback implementation.
+  void CastFeedback(const RtcpCastMessage& cast_feedback) final {}
+
+ private:
+  base::SimpleTestTickClock clock_;
+};
+
+void RunFramerBenchmarks() {
+  // Audio, 20 Mbit/s video at 60 fps, and a key frame.
+  constexpr size_t kFrameSizes[] = {500, 42 * 1024, 512 * 1024};
+  constexpr size_t kBytesPerRun = size_t{1} << 30;
+  for (size_t frame_size : kFrameSizes) {
+    for (bool reverse_packet_order : {false, true}) {
+      FramerBenchmark().Run(frame_size, kBytesPerRun / frame_size,
+                            reverse_packet_order);
+    }
+  }
+}
+
+// Encrypts frames of the sizes seen when mirroring at high bitrates, and
+// reports the throughput of each of the TransportEncryptionHandler APIs.
+void RunEncryptionBenchmarks() {
+  // 20 Mbit/s at 60 fps, and a key frame.
+  constexpr size_t kFrameSizes[] = {42 * 1024, 512 * 1024};
+  constexpr size_t kBytesPerRun = size_t{1} << 30;
+
+  TransportEncryptionHandler handler;
+  CHECK(handler.Initialize(std::string(16, 'k'), std::string(16, 'i')));
+
+  for (size_t frame_size : kFrameSizes) {
+    const std::string frame_data(frame_size, 'x');
+    std::string encrypted_string;
+    std::vector<uint8_t> encrypted_buffer(frame_size);
+    std::string in_place = frame_data;
+    const size_t num_frames = kBytesPerRun / frame_size;
+
+    // Returns the throughput, in MB/s, of |encrypt| run on every frame, after
+    // |prepare| when given. Only |encrypt| is timed.
+    auto measure = [&](const base::RepeatingCallback<void(FrameId)>& encrypt,
+                       const base::RepeatingCallback<void(FrameId)>& prepare) {
+      base::TimeDelta elapsed;
+      FrameId frame_id = FrameId::first();
+      for (size_t i = 0; i < num_frames; ++i, ++frame_id) {
+        if (prepare)
+          prepare.Run(frame_id);
+        const base::TimeTicks start = base::TimeTicks::Now();
+        encrypt.Run(frame_id);
+        elapsed += base::TimeTicks::Now() - start;
+      }
+      return num_frames * frame_size / elapsed.InSecondsF() / 1e6;
+    };
+
+    const double copying = measure(
+        base::BindLambdaForTesting([&](FrameId frame_id) {
+          // The previous API: a new string for every frame.
+          std::string encrypted;
+          handler.Encrypt(frame_id, frame_data, &encrypted);
+        }),
+        base::RepeatingCallback<void(FrameId)>());
+    const double reused_string = measure(
+        base::BindLambdaForTesting([&](FrameId frame_id) {
+          handler.Encrypt(frame_id, frame_data, &encrypted_string);
+        }),
+        base::RepeatingCallback<void(FrameId)>());
+    const double caller_buffer = measure(
+        base::BindLambdaForTesting([&](FrameId frame_id) {
+          handler.Encrypt(frame_id, base::as_bytes(base::make_span(frame_data)),
+                          base::make_span(encrypted_buffer));
+        }),
+        base::RepeatingCallback<void(FrameId)>());
+    const double in_place_rate = measure(
+        base::BindLambdaForTesting([&](FrameId frame_id) {
+          handler.EncryptInPlace(
+              frame_id, base::as_writable_bytes(base::make_span(in_place)));
+        }),
+        base::RepeatingCallback<void(FrameId)>());
+    const double precomputed = measure(
+        base::BindLambdaForTesting([&](FrameId frame_id) {
+          handler.EncryptInPlace(
+              frame_id, base::as_writable_bytes(base::make_span(in_place)));
+        }),
+        base::BindLambdaForTesting([&](FrameId frame_id) {
+          handler.PrecomputeKeystream(frame_id, frame_size);
+        }));
+
+    fprintf(stdout,
+            "encryption %7zu byte frames (MB/s): new string %.0f, "
+            "reused string %.0f, caller buffer %.0f, in place %.0f, "
+            "precomputed keystream %.0f\n",
+            frame_size, copying, reused_string, caller_buffer, in_place_rate,
+            precomputed);
+    fflush(stdout);
+  }
+}
+
+// Loads the frames which RunVpxEncoderBenchmarks() encodes: those of a raw
+// I420 clip if one is given, or else plaid patterns, moving from frame to
+// frame, and noise, as a stand-in for the detail of camera content.
+std::vector<scoped_refptr<VideoFrame>> LoadEncoderBenchmarkFrames(
+    const gfx::Size& frame_size,
+    FILE* clip) {
+  constexpr int kMaxFrames = 60;
+  std::vector<scoped_refptr<VideoFrame>> frames;
+  for (int i = 0; i < kMaxFrames; ++i) {
+    scoped_refptr<VideoFrame> frame =
+        VideoFrame::CreateFrame(PIXEL_FORMAT_I420, frame_size,
+                                gfx::Rect(frame_size), frame_size,
+                                base::TimeDelta());
+    if (clip) {
+      if (!PopulateVideoFrameFromFile(frame.get(), clip))
+        break;
+    } else if (i % 10 == 9) {
+      PopulateVideoFrameWithNoise(frame.get());
+    } else {
+      PopulateVideoFrame(frame.get(), i * 3);
+    }
+    frames.push_back(std::move(frame));
+  }
+  CHECK(!frames.empty()) << "The clip has no frames.";
+  return frames;
+}
+
+// Encodes 30 fps video at 1080p and 4K with the software VpxEncoder, as a
+// sender without a hardware encoder would, and reports the encode rate and
+// the share of frames which missed their 33 ms deadline. The frames come
+// from a raw I420 clip with --vpx-clip=<file> --vpx-clip-size=<w>x<h>.
+void RunVpxEncoderBenchmarks() {
+  constexpr int kFrameRate = 30;
+  constexpr int kNumFrames = 300;
+  const base::CommandLine* cmd = base::CommandLine::ForCurrentProcess();
+
+  std::vector<gfx::Size> frame_sizes = {gfx::Size(1920, 1080),
+                                        gfx::Size(3840, 2160)};
+  base::ScopedFILE clip;
+  if (cmd->HasSwitch("vpx-clip")) {
+    int width = 0;
+    int height = 0;
+    CHECK_EQ(2, sscanf(cmd->GetSwitchValueASCII("vpx-clip-size").c_str(),
+                       "%dx%d", &width, &height))
+        << "--vpx-clip-size=<width>x<height> is required with --vpx-clip.";
+    frame_sizes = {gfx::Size(width, height)};
+    clip.reset(base::OpenFile(cmd->GetSwitchValuePath("vpx-clip"), "rb"));
+    CHECK(clip) << "Cannot open the clip.";
+  }
+
+  const int max_threads = base::SysInfo::NumberOfProcessors();
+  for (const gfx::Size& frame_size : frame_sizes) {
+    if (clip)
+      rewind(clip.get());
+    const std::vector<scoped_refptr<VideoFrame>> frames =
+        LoadEncoderBenchmarkFrames(frame_size, clip.get());
+    for (Codec codec : {CODEC_VIDEO_VP8, CODEC_VIDEO_VP9}) {
+      for (int threads : {1, max_threads}) {
+        FrameSenderConfig config = GetDefaultVideoSenderConfig();
+        config.codec = codec;
+        config.max_frame_rate = kFrameRate;
+        config.start_bitrate = config.max_bitrate = 20000000;
+        config.video_codec_params.number_of_encode_threads = threads;
+        VpxEncoder encoder(config);
+        encoder.Initialize();
+
+        const base::TimeDelta deadline = base::Seconds(1) / kFrameRate;
+        int num_late_frames = 0;
+        base::TimeDelta total_encode_time;
+        for (int i = 0; i < kNumFrames; ++i) {
+          const scoped_refptr<VideoFrame>& frame = frames[i % frames.size()];
+          frame->set_timestamp(deadline * i);
+          SenderEncodedFrame encoded_frame;
+          const base::TimeTicks start = base::TimeTicks::Now();
+          encoder.Encode(frame, start, &encoded_frame);
+          const base::TimeDelta encode_time = base::TimeTicks::Now() - start;
+          total_encode_time += encode_time;
+          if (encode_time > deadline)
+            ++num_late_frames;
+        }
+
+        fprintf(stdout,
+                "vpx encoder %s %s, %2d threads: %.1f frames/s, "
+                "%.1f%% of frames late\n",
+                codec == CODEC_VIDEO_VP9 ? "VP9" : "VP8",
+                frame_size.ToString().c_str(), threads,
+                kNumFrames / total_encode_time.InSecondsF(),
+                100.0 * num_late_frames / kNumFrames);
+        fflush(stdout);
+      }
+    }
+  }
+}
+
+}  // namespace
+
 }  // namespace cast
 }  // namespace media
 
 int main(int argc, char** argv) {
   base::AtExitManager at_exit;
   base::CommandLine::Init(argc, argv);
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch("udp-loopback")) {
+    media::cast::RunUdpLoopbackBenchmarks();
+    return 0;
+  }
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch("encryption")) {
+    media::cast::RunEncryptionBenchmarks();
+    return 0;
+  }
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch("framer")) {
+    media::cast::RunFramerBenchmarks();
+    return 0;
+  }
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch("vpx-encoder")) {
+    media::cast::RunVpxEncoderBenchmarks();
+    return 0;
+  }
   media::cast::CastBenchmark benchmark;
   if (getenv("PROFILE_FILE")) {
     std::string profile_file(getenv("PROFILE_FILE"));
@@ -197,14 +197,14 @@ class LoopBackTransport : public PacketTransport {
     if (!send_packets_)
       return true;
 
-    bytes_sent_ += packet->data.size();
+    bytes_sent_ += packet->size();
     if (drop_packets_belonging_to_odd_frames_) {
       const uint8_t truncated_frame_id = packet->data[13];
       if (truncated_frame_id % 2 == 1)
         return true;
     }
 
-    std::unique_ptr<Packet> packet_copy(new Packet(packet->data));
+    std::unique_ptr<Packet> packet_copy(new Packet(packet->ToPacket()));
     packet_pipe_->Send(std::move(packet_copy));
     return true;
   }
@@ -1083,6 +1083,25 @@ TEST_F(End2EndTest, CAST_E2E_TEST(BasicFakeSoftwareVideo)) {
   EXPECT_EQ(30ul, video_ticks_.size());
 }
 
+// Tests that the receiver keeps up with large frames, each of which spans a
+// few dozen packets.
+TEST_F(End2EndTest, CAST_E2E_TEST(HighBitrateFakeSoftwareVideo)) {
+  Configure(CODEC_VIDEO_FAKE, CODEC_AUDIO_PCM16);
+  video_sender_config_.min_bitrate = 8000000;
+  video_sender_config_.max_bitrate = 8000000;
+  video_sender_config_.start_bitrate = 8000000;
+  Create();
+  StartBasicPlayer();
+
+  const int kNumFrames = 300;
+  for (int frames_counter = 0; frames_counter < kNumFrames; ++frames_counter) {
+    SendVideoFrame(frames_counter, testing_clock_sender_.NowTicks());
+    RunTasks(kFrameTimerMs);
+  }
+  RunTasks(2 * kFrameTimerMs + 1);  // Empty the pipeline.
+  EXPECT_EQ(static_cast<size_t>(kNumFrames), video_ticks_.size());
+}
+
 // The following tests run many many iterations to make sure that buffers don't
 // fill, timers don't go askew etc. However, these high-level tests are too
 // expensive when running under sanitizers, or in non-optimized debug builds.
@@ -46,9 +46,9 @@ LoopBackTransport::~LoopBackTransport() = default;
 
 bool LoopBackTransport::SendPacket(PacketRef packet, base::OnceClosure cb) {
   DCHECK(cast_environment_->CurrentlyOn(CastEnvironment::MAIN));
-  std::unique_ptr<Packet> packet_copy(new Packet(packet->data));
+  std::unique_ptr<Packet> packet_copy(new Packet(packet->ToPacket()));
   packet_pipe_->Send(std::move(packet_copy));
-  bytes_sent_ += packet->data.size();
+  bytes_sent_ += packet->size();
   return true;
 }
 
@@ -7,6 +7,8 @@
 
 #include <stdint.h>
 
+#include <memory>
+
 #include "media/cast/net/cast_transport.h"
 #include "testing/gmock/include/gmock/gmock.h"
 
@@ -18,7 +20,8 @@ class MockCastTransport : public CastTransport {
   MockCastTransport();
   ~MockCastTransport() override;
 
-  MOCK_METHOD2(InsertFrame, void(uint32_t ssrc, const EncodedFrame& frame));
+  MOCK_METHOD2(InsertFrame,
+               void(uint32_t ssrc, std::unique_ptr<EncodedFrame> frame));
   MOCK_METHOD3(SendSenderReport,
                void(uint32_t ssrc,
                     base::TimeTicks current_time,
@@ -4,11 +4,28 @@
 
 #include "media/cast/test/receiver/frame_buffer.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
 #include "base/check_op.h"
+#include "media/cast/net/cast_transport_defines.h"
+#include "media/cast/net/rtp/rtp_fec.h"
 
 namespace media {
 namespace cast {
 
+namespace {
+
+// Marks packets in |packet_sizes_| which have not been received. Payloads are
+// never this large.
+const uint16_t kNotReceived = 0xffff;
+static_assert(kMaxIpPacketSize < kNotReceived,
+              "kNotReceived must not be a valid payload size");
+
+}  // namespace
+
 FrameBuffer::FrameBuffer()
     : max_packet_id_(0),
       num_packets_received_(0),
@@ -16,46 +33,250 @@ FrameBuffer::FrameBuffer()
       new_playout_delay_ms_(0),
       is_key_frame_(false),
       total_data_size_(0),
-      packets_() {}
+      slot_size_(0),
+      is_irregular_(false),
+      num_fec_packets_(0) {}
 
 FrameBuffer::~FrameBuffer() = default;
 
+FrameBuffer::FecPacket::FecPacket()
+    : packet_id(0), first_packet_id(0), num_packets(0), length_recovery(0) {}
+FrameBuffer::FecPacket::FecPacket(FecPacket&&) = default;
+FrameBuffer::FecPacket& FrameBuffer::FecPacket::operator=(FecPacket&&) =
+    default;
+FrameBuffer::FecPacket::~FecPacket() = default;
+
+void FrameBuffer::Reset() {
+  frame_id_ = FrameId();
+  max_packet_id_ = 0;
+  num_packets_received_ = 0;
+  max_seen_packet_id_ = 0;
+  new_playout_delay_ms_ = 0;
+  is_key_frame_ = false;
+  total_data_size_ = 0;
+  last_referenced_frame_id_ = FrameId();
+  rtp_timestamp_ = RtpTimeTicks();
+  packet_sizes_.clear();
+  data_.clear();
+  slot_size_ = 0;
+  is_irregular_ = false;
+  pending_last_packet_.clear();
+  num_fec_packets_ = 0;
+}
+
+void FrameBuffer::InitializeFromHeader(const RtpCastHeader& rtp_header) {
+  frame_id_ = rtp_header.frame_id;
+  max_packet_id_ = rtp_header.max_packet_id;
+  is_key_frame_ = rtp_header.is_key_frame;
+  new_playout_delay_ms_ = rtp_header.new_playout_delay_ms;
+  if (is_key_frame_)
+    DCHECK_EQ(rtp_header.frame_id, rtp_header.reference_frame_id);
+  last_referenced_frame_id_ = rtp_header.reference_frame_id;
+  rtp_timestamp_ = rtp_header.rtp_timestamp;
+  packet_sizes_.assign(max_packet_id_ + 1, kNotReceived);
+}
+
 bool FrameBuffer::InsertPacket(const uint8_t* payload_data,
                                size_t payload_size,
                                const RtpCastHeader& rtp_header) {
+  DCHECK(!rtp_header.is_fec);
   // Is this the first packet in the frame?
-  if (packets_.empty()) {
-    frame_id_ = rtp_header.frame_id;
-    max_packet_id_ = rtp_header.max_packet_id;
-    is_key_frame_ = rtp_header.is_key_frame;
-    new_playout_delay_ms_ = rtp_header.new_playout_delay_ms;
-    if (is_key_frame_)
-      DCHECK_EQ(rtp_header.frame_id, rtp_header.reference_frame_id);
-    last_referenced_frame_id_ = rtp_header.reference_frame_id;
-    rtp_timestamp_ = rtp_header.rtp_timestamp;
-  }
+  if (frame_id_.is_null())
+    InitializeFromHeader(rtp_header);
   // Is this the correct frame?
   if (rtp_header.frame_id != frame_id_)
     return false;
 
+  if (rtp_header.packet_id > max_packet_id_ ||
+      payload_size > kMaxIpPacketSize) {
+    return false;
+  }
+
   // Insert every packet only once.
-  if (packets_.find(rtp_header.packet_id) != packets_.end()) {
+  if (HasPacket(rtp_header.packet_id)) {
     return false;
   }
 
-  std::vector<uint8_t> data;
-  std::pair<PacketMap::iterator, bool> retval =
-      packets_.insert(make_pair(rtp_header.packet_id, data));
+  if (rtp_header.new_playout_delay_ms)
+    new_playout_delay_ms_ = rtp_header.new_playout_delay_ms;
+  StorePacket(rtp_header.packet_id, payload_data, payload_size);
+  max_seen_packet_id_ = std::max(max_seen_packet_id_, rtp_header.packet_id);
+  return true;
+}
 
-  // Insert the packet.
-  retval.first->second.resize(payload_size);
-  std::copy(payload_data, payload_data + payload_size,
-            retval.first->second.begin());
+bool FrameBuffer::InsertFecPacket(const uint8_t* payload_data,
+                                  size_t payload_size,
+                                  const RtpCastHeader& rtp_header) {
+  DCHECK(rtp_header.is_fec);
+  if (frame_id_.is_null())
+    InitializeFromHeader(rtp_header);
+  if (rtp_header.frame_id != frame_id_ ||
+      rtp_header.max_packet_id != max_packet_id_) {
+    return false;
+  }
 
+  for (size_t i = 0; i < num_fec_packets_; ++i) {
+    if (fec_packets_[i].packet_id == rtp_header.packet_id)
+      return false;
+  }
+  if (num_fec_packets_ == fec_packets_.size())
+    fec_packets_.emplace_back();
+  FecPacket& fec = fec_packets_[num_fec_packets_++];
+  fec.packet_id = rtp_header.packet_id;
+  fec.first_packet_id = rtp_header.fec_first_packet_id;
+  fec.num_packets = rtp_header.fec_num_packets;
+  fec.length_recovery = rtp_header.fec_length_recovery;
+  fec.parity.assign(payload_data, payload_data + payload_size);
+
+  if (rtp_header.new_playout_delay_ms)
+    new_playout_delay_ms_ = rtp_header.new_playout_delay_ms;
+  // Parity packets are sent after all of the frame's data packets, so any
+  // still missing are lost rather than late.
+  max_seen_packet_id_ = max_packet_id_;
+  return true;
+}
+
+int FrameBuffer::RecoverPackets() {
+  int num_recovered = 0;
+  for (size_t i = 0; i < num_fec_packets_;) {
+    const FecPacket& fec = fec_packets_[i];
+    int num_missing = 0;
+    for (int id = fec.first_packet_id;
+         id < fec.first_packet_id + fec.num_packets; ++id) {
+      if (!HasPacket(id))
+        ++num_missing;
+    }
+    if (num_missing > 1) {
+      ++i;
+      continue;
+    }
+    // The parity packet is of no further use once its packets are all here,
+    // or if it proves to be inconsistent with them.
+    if (num_missing == 1 && RecoverPacket(fec))
+      ++num_recovered;
+    --num_fec_packets_;
+    std::swap(fec_packets_[i], fec_packets_[num_fec_packets_]);
+  }
+  return num_recovered;
+}
+
+bool FrameBuffer::RecoverPacket(const FecPacket& fec) {
+  recovered_packet_.assign(fec.parity.begin(), fec.parity.end());
+  uint16_t length = fec.length_recovery;
+  int missing_packet_id = -1;
+  for (int id = fec.first_packet_id;
+       id < fec.first_packet_id + fec.num_packets; ++id) {
+    if (!HasPacket(id)) {
+      missing_packet_id = id;
+      continue;
+    }
+    const uint16_t packet_id = static_cast<uint16_t>(id);
+    XorIntoParity(PacketData(packet_id), packet_sizes_[packet_id],
+                  &recovered_packet_);
+    length ^= packet_sizes_[packet_id];
+  }
+  if (missing_packet_id < 0 || missing_packet_id > max_packet_id_ ||
+      length > recovered_packet_.size() || length > kMaxIpPacketSize) {
+    return false;
+  }
+  StorePacket(static_cast<uint16_t>(missing_packet_id),
+              recovered_packet_.data(), length);
+  return true;
+}
+
+bool FrameBuffer::HasPacket(int packet_id) const {
+  return packet_id >= 0 &&
+         static_cast<size_t>(packet_id) < packet_sizes_.size() &&
+         packet_sizes_[packet_id] != kNotReceived;
+}
+
+const uint8_t* FrameBuffer::PacketData(uint16_t packet_id) const {
+  DCHECK(HasPacket(packet_id));
+  DCHECK(!Complete());
+  if (packet_id == max_packet_id_ && max_packet_id_ > 0 && slot_size_ == 0)
+    return pending_last_packet_.data();
+  return reinterpret_cast<const uint8_t*>(data_.data()) +
+         packet_id * slot_size_;
+}
+
+void FrameBuffer::StorePacket(uint16_t packet_id,
+                              const uint8_t* payload_data,
+                              size_t payload_size) {
+  DCHECK(!HasPacket(packet_id));
+  DCHECK_LE(payload_size, kMaxIpPacketSize);
+  const bool is_last_packet = packet_id == max_packet_id_;
+
+  if (max_packet_id_ == 0) {
+    // A single packet frame.
+    slot_size_ = payload_size;
+    data_.resize(payload_size);
+  } else if (slot_size_ == 0 && !is_last_packet) {
+    // The first packet that reveals the frame's packet size.
+    const bool has_pending_last_packet = HasPacket(max_packet_id_);
+    if (has_pending_last_packet &&
+        pending_last_packet_.size() > payload_size) {
+      SwitchToIrregularLayout();
+    } else {
+      slot_size_ = payload_size;
+      data_.resize((max_packet_id_ + 1) * slot_size_);
+      if (has_pending_last_packet) {
+        std::copy(pending_last_packet_.begin(), pending_last_packet_.end(),
+                  data_.begin() + max_packet_id_ * slot_size_);
+      }
+    }
+  } else if (slot_size_ != 0 && !is_irregular_ &&
+             (is_last_packet ? payload_size > slot_size_
+                             : payload_size != slot_size_)) {
+    SwitchToIrregularLayout();
+  }
+
+  if (slot_size_ == 0) {
+    // The last packet arrived first, and its position is not yet known.
+    DCHECK(is_last_packet);
+    pending_last_packet_.assign(payload_data, payload_data + payload_size);
+  } else {
+    std::copy(payload_data, payload_data + payload_size,
+              data_.begin() + packet_id * slot_size_);
+  }
+
+  packet_sizes_[packet_id] = static_cast<uint16_t>(payload_size);
   ++num_packets_received_;
-  max_seen_packet_id_ = std::max(max_seen_packet_id_, rtp_header.packet_id);
   total_data_size_ += payload_size;
-  return true;
+  if (Complete())
+    FinishFrame();
+}
+
+void FrameBuffer::SwitchToIrregularLayout() {
+  DCHECK(!is_irregular_);
+  DCHECK_LE(slot_size_, kMaxIpPacketSize);
+  const size_t old_slot_size = slot_size_;
+  is_irregular_ = true;
+  slot_size_ = kMaxIpPacketSize;
+  data_.resize((max_packet_id_ + 1) * slot_size_);
+  // Slots only grow, so moving the packets from the last one down never
+  // overwrites a packet which has yet to be moved.
+  for (int id = max_packet_id_; id >= 0; --id) {
+    if (!HasPacket(id))
+      continue;
+    if (id == max_packet_id_ && old_slot_size == 0) {
+      std::copy(pending_last_packet_.begin(), pending_last_packet_.end(),
+                data_.begin() + id * slot_size_);
+    } else {
+      memmove(&data_[id * slot_size_], &data_[id * old_slot_size],
+              packet_sizes_[id]);
+    }
+  }
+}
+
+void FrameBuffer::FinishFrame() {
+  if (is_irregular_) {
+    size_t offset = 0;
+    for (size_t id = 0; id <= max_packet_id_; ++id) {
+      memmove(&data_[offset], &data_[id * slot_size_], packet_sizes_[id]);
+      offset += packet_sizes_[id];
+    }
+  }
+  data_.resize(total_data_size_);
 }
 
 bool FrameBuffer::Complete() const {
@@ -63,6 +284,13 @@ bool FrameBuffer::Complete() const {
 }
 
 bool FrameBuffer::AssembleEncodedFrame(EncodedFrame* frame) const {
+  if (!GetEncodedFrameMetadata(frame))
+    return false;
+  frame->data = data_;
+  return true;
+}
+
+bool FrameBuffer::GetEncodedFrameMetadata(EncodedFrame* frame) const {
   if (!Complete())
     return false;
 
@@ -77,34 +305,24 @@ bool FrameBuffer::AssembleEncodedFrame(EncodedFrame* frame) const {
   frame->referenced_frame_id = last_referenced_frame_id_;
   frame->rtp_timestamp = rtp_timestamp_;
   frame->new_playout_delay_ms = new_playout_delay_ms_;
-
-  // Build the data vector.
-  frame->data.clear();
-  frame->data.reserve(total_data_size_);
-  PacketMap::const_iterator it;
-  for (it = packets_.begin(); it != packets_.end(); ++it)
-    frame->data.insert(frame->data.end(), it->second.begin(), it->second.end());
   return true;
 }
 
+void FrameBuffer::TakeFrameData(std::string* data) {
+  DCHECK(Complete());
+  DCHECK_EQ(data_.size(), total_data_size_);
+  data->swap(data_);
+  data_.clear();
+}
+
 void FrameBuffer::GetMissingPackets(bool newest_frame,
                                     PacketIdSet* missing_packets) const {
   // Missing packets capped by max_seen_packet_id_.
   // (Iff it's the latest frame)
-  int maximum = newest_frame ? max_seen_packet_id_ : max_packet_id_;
-  int packet = 0;
-  for (auto i = packets_.begin(); i != packets_.end() && packet <= maximum;
-       ++i) {
-    int end = std::min<int>(i->first, maximum + 1);
-    while (packet < end) {
+  const int maximum = newest_frame ? max_seen_packet_id_ : max_packet_id_;
+  for (int packet = 0; packet <= maximum; ++packet) {
+    if (!HasPacket(packet))
       missing_packets->insert(packet);
-      packet++;
-    }
-    packet++;
-  }
-  while (packet <= maximum) {
-    missing_packets->insert(packet);
-    packet++;
   }
 }
 
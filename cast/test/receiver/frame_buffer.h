@@ -8,7 +8,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#include <map>
+#include <string>
 #include <vector>
 
 #include "base/macros.h"
@@ -19,8 +19,14 @@
 namespace media {
 namespace cast {
 
-typedef std::map<uint16_t, std::vector<uint8_t>> PacketMap;
-
+// Reassembles one frame from its packets. Payloads are written into a single
+// slab, indexed by packet ID. The Cast sender gives every packet of a frame
+// the same payload size, save the last, so each packet is copied straight to
+// its final place in the frame, and a complete frame is already contiguous.
+// Packets of irregular sizes are also handled, at the cost of compacting the
+// slab once the frame is complete. A buffer can be Reset() and reused for
+// another frame, keeping its memory, so that inserting packets does not
+// allocate.
 class FrameBuffer {
  public:
   FrameBuffer();
@@ -29,9 +35,27 @@ class FrameBuffer {
   FrameBuffer& operator=(const FrameBuffer&) = delete;
 
   ~FrameBuffer();
+
+  // Empties the buffer so it can hold another frame.
+  void Reset();
+
+  // Returns false if the packet does not belong to this frame, is a
+  // duplicate, or is malformed.
   bool InsertPacket(const uint8_t* payload_data,
                     size_t payload_size,
                     const RtpCastHeader& rtp_header);
+
+  // Stores an FEC parity packet (|rtp_header.is_fec|) for RecoverPackets().
+  // Returns false if it does not belong to this frame or is a duplicate.
+  bool InsertFecPacket(const uint8_t* payload_data,
+                       size_t payload_size,
+                       const RtpCastHeader& rtp_header);
+
+  // Rebuilds the missing data packets that the stored parity packets allow,
+  // and drops the parity packets which are no longer of use. Returns the
+  // number of packets recovered.
+  int RecoverPackets();
+
   bool Complete() const;
 
   void GetMissingPackets(bool newest_frame, PacketIdSet* missing_packets) const;
@@ -42,11 +66,56 @@ class FrameBuffer {
   // remains unchanged.
   bool AssembleEncodedFrame(EncodedFrame* frame) const;
 
+  // Like AssembleEncodedFrame(), but leaves |frame->data| untouched.
+  bool GetEncodedFrameMetadata(EncodedFrame* frame) const;
+
+  // Hands the data of a complete frame to |data| by swapping buffers, rather
+  // than copying it. This may be done once, when the frame is about to be
+  // released.
+  void TakeFrameData(std::string* data);
+
   bool is_key_frame() const { return is_key_frame_; }
   FrameId last_referenced_frame_id() const { return last_referenced_frame_id_; }
   FrameId frame_id() const { return frame_id_; }
 
  private:
+  struct FecPacket {
+    FecPacket();
+    FecPacket(FecPacket&&);
+    FecPacket& operator=(FecPacket&&);
+    ~FecPacket();
+
+    uint16_t packet_id;
+    uint16_t first_packet_id;
+    uint16_t num_packets;
+    uint16_t length_recovery;
+    std::vector<uint8_t> parity;
+  };
+
+  // Takes the frame's metadata from the header of its first packet received.
+  void InitializeFromHeader(const RtpCastHeader& rtp_header);
+
+  bool HasPacket(int packet_id) const;
+
+  // Returns the payload of a received packet.
+  const uint8_t* PacketData(uint16_t packet_id) const;
+
+  // Inserts a packet's payload, which must be new.
+  void StorePacket(uint16_t packet_id,
+                   const uint8_t* payload_data,
+                   size_t payload_size);
+
+  // Moves the packets received so far to slots of the maximum packet size,
+  // when they turn out not to share the same size.
+  void SwitchToIrregularLayout();
+
+  // Makes |data_| hold exactly the frame's data, once it is complete.
+  void FinishFrame();
+
+  // Returns true if |fec| could be used to rebuild the one packet it protects
+  // that has not been received, and inserts that packet.
+  bool RecoverPacket(const FecPacket& fec);
+
   FrameId frame_id_;
   uint16_t max_packet_id_;
   uint16_t num_packets_received_;
@@ -56,7 +125,25 @@ class FrameBuffer {
   size_t total_data_size_;
   FrameId last_referenced_frame_id_;
   RtpTimeTicks rtp_timestamp_;
-  PacketMap packets_;
+
+  // The payload size of each packet, by packet ID, or kNotReceived.
+  std::vector<uint16_t> packet_sizes_;
+
+  // Packet |i| is stored at |i * slot_size_| in |data_|. The slot size is the
+  // payload size of the frame's packets, learnt from the first one received
+  // that is not the last packet, or kMaxIpPacketSize for irregular frames. A
+  // last packet received before the slot size is known waits in
+  // |pending_last_packet_|.
+  std::string data_;
+  size_t slot_size_;
+  bool is_irregular_;
+  std::vector<uint8_t> pending_last_packet_;
+
+  // Parity packets not yet used. Only the first |num_fec_packets_| are valid;
+  // the others are kept so that their memory is reused.
+  std::vector<FecPacket> fec_packets_;
+  size_t num_fec_packets_;
+  std::vector<uint8_t> recovered_packet_;
 };
 
 }  // namespace cast
@@ -4,6 +4,9 @@
 
 #include <stdint.h>
 
+#include <string>
+#include <vector>
+
 #include "base/macros.h"
 #include "media/cast/net/cast_transport_defines.h"
 #include "media/cast/test/receiver/frame_buffer.h"
@@ -26,6 +29,36 @@ class FrameBufferTest : public ::testing::Test {
 
   ~FrameBufferTest() override = default;
 
+  // Splits |data| into packets of |packet_size| bytes, the last one holding
+  // the remainder.
+  static std::vector<std::string> Packetize(const std::string& data,
+                                            size_t packet_size) {
+    std::vector<std::string> packets;
+    for (size_t offset = 0; offset < data.size(); offset += packet_size)
+      packets.push_back(data.substr(offset, packet_size));
+    return packets;
+  }
+
+  static std::string MakeFrameData(size_t size) {
+    std::string data(size, 0);
+    for (size_t i = 0; i < size; ++i)
+      data[i] = static_cast<char>(i * 7 + i / 251);
+    return data;
+  }
+
+  // Inserts the packets of |packets| in the order given by |packet_ids|.
+  void InsertPackets(const std::vector<std::string>& packets,
+                     const std::vector<uint16_t>& packet_ids) {
+    rtp_header_.max_packet_id = static_cast<uint16_t>(packets.size() - 1);
+    for (uint16_t packet_id : packet_ids) {
+      rtp_header_.packet_id = packet_id;
+      const std::string& packet = packets[packet_id];
+      EXPECT_TRUE(buffer_.InsertPacket(
+          reinterpret_cast<const uint8_t*>(packet.data()), packet.size(),
+          rtp_header_));
+    }
+  }
+
   FrameBuffer buffer_;
   std::vector<uint8_t> payload_;
   RtpCastHeader rtp_header_;
@@ -94,5 +127,69 @@ TEST_F(FrameBufferTest, IncompleteFrame) {
   EXPECT_TRUE(buffer_.Complete());
 }
 
+TEST_F(FrameBufferTest, RejectsPacketsBeyondMaxPacketId) {
+  rtp_header_.max_packet_id = 1;
+  rtp_header_.packet_id = 2;
+  EXPECT_FALSE(
+      buffer_.InsertPacket(&payload_[0], payload_.size(), rtp_header_));
+  EXPECT_FALSE(buffer_.Complete());
+}
+
+TEST_F(FrameBufferTest, AssemblesPacketsReceivedOutOfOrder) {
+  const std::string data = MakeFrameData(5000);
+  const std::vector<std::string> packets = Packetize(data, 1200);
+  // The last packet first, before the packet size is known.
+  InsertPackets(packets, {4, 2, 0, 3, 1});
+  EXPECT_TRUE(buffer_.Complete());
+  EncodedFrame frame;
+  EXPECT_TRUE(buffer_.AssembleEncodedFrame(&frame));
+  EXPECT_EQ(data, frame.data);
+}
+
+TEST_F(FrameBufferTest, AssemblesPacketsOfIrregularSizes) {
+  const std::string data = MakeFrameData(3000);
+  const std::vector<std::string> packets = {
+      data.substr(0, 700), data.substr(700, 1000), data.substr(1700, 300),
+      data.substr(2000, 1000)};
+  // A last packet larger than the first packet received, and a packet of yet
+  // another size.
+  InsertPackets(packets, {3, 0, 2, 1});
+  EXPECT_TRUE(buffer_.Complete());
+  EncodedFrame frame;
+  EXPECT_TRUE(buffer_.AssembleEncodedFrame(&frame));
+  EXPECT_EQ(data, frame.data);
+}
+
+TEST_F(FrameBufferTest, ReportsMissingPackets) {
+  const std::vector<std::string> packets =
+      Packetize(MakeFrameData(6000), 1000);
+  InsertPackets(packets, {0, 2, 3});
+  PacketIdSet missing_packets;
+  buffer_.GetMissingPackets(true, &missing_packets);
+  EXPECT_EQ(PacketIdSet({1}), missing_packets);
+  missing_packets.clear();
+  buffer_.GetMissingPackets(false, &missing_packets);
+  EXPECT_EQ(PacketIdSet({1, 4, 5}), missing_packets);
+}
+
+TEST_F(FrameBufferTest, HandsOutFrameDataAndIsReusable) {
+  const std::string data = MakeFrameData(4000);
+  InsertPackets(Packetize(data, 1000), {0, 1, 2, 3});
+  std::string frame_data;
+  buffer_.TakeFrameData(&frame_data);
+  EXPECT_EQ(data, frame_data);
+
+  buffer_.Reset();
+  EXPECT_TRUE(buffer_.frame_id().is_null());
+  EXPECT_FALSE(buffer_.Complete());
+  rtp_header_.frame_id = FrameId::first() + 1;
+  const std::string next_data = MakeFrameData(1500);
+  InsertPackets(Packetize(next_data, 1000), {1, 0});
+  EncodedFrame frame;
+  EXPECT_TRUE(buffer_.AssembleEncodedFrame(&frame));
+  EXPECT_EQ(FrameId::first() + 1, frame.frame_id);
+  EXPECT_EQ(next_data, frame.data);
+}
+
 }  // namespace cast
 }  // namespace media
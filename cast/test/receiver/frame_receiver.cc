@@ -10,6 +10,7 @@
 
 #include "base/big_endian.h"
 #include "base/bind.h"
+#include "base/containers/span.h"
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
 #include "media/cast/cast_config.h"
@@ -203,15 +204,14 @@ void FrameReceiver::EmitAvailableEncodedFrames() {
   DCHECK(cast_environment_->CurrentlyOn(CastEnvironment::MAIN));
 
   while (!frame_request_queue_.empty()) {
-    // Attempt to peek at the next completed frame from the |framer_|.
-    // TODO(miu): We should only be peeking at the metadata, and not copying the
-    // payload yet!  Or, at least, peek using a StringPiece instead of a copy.
+    // Attempt to peek at the metadata of the next completed frame from the
+    // |framer_|. Its payload is only taken once it is certain to be emitted.
     std::unique_ptr<EncodedFrame> encoded_frame(new EncodedFrame());
     bool is_consecutively_next_frame = false;
     bool have_multiple_complete_frames = false;
-    if (!framer_.GetEncodedFrame(encoded_frame.get(),
-                                 &is_consecutively_next_frame,
-                                 &have_multiple_complete_frames)) {
+    if (!framer_.PeekEncodedFrame(encoded_frame.get(),
+                                  &is_consecutively_next_frame,
+                                  &have_multiple_complete_frames)) {
       VLOG(1) << "Wait for more packets to produce a completed frame.";
       return;  // ProcessParsedPacket() will invoke this method in the future.
     }
@@ -254,17 +254,17 @@ void FrameReceiver::EmitAvailableEncodedFrames() {
     // frame from somewhere later in the stream, AND we have given up
     // on waiting for any frames in between, so now we can ACK the frame.
     framer_.AckFrame(encoded_frame->frame_id);
+    framer_.TakeFrameData(encoded_frame->frame_id, &encoded_frame->data);
 
     // Decrypt the payload data in the frame, if crypto is being used.
     if (decryptor_.is_activated()) {
-      std::string decrypted_data;
-      if (!decryptor_.Decrypt(encoded_frame->frame_id, encoded_frame->data,
-                              &decrypted_data)) {
+      if (!decryptor_.DecryptInPlace(
+              encoded_frame->frame_id,
+              base::as_writable_bytes(base::make_span(encoded_frame->data)))) {
         // Decryption failed.  Give up on this frame.
         framer_.ReleaseFrame(encoded_frame->frame_id);
         continue;
       }
-      encoded_frame->data.swap(decrypted_data);
     }
 
     // At this point, we have a decrypted EncodedFrame ready to be emitted.
@@ -10,12 +10,19 @@
 namespace media {
 namespace cast {
 
+static_assert((Framer::kFrameWindowSize & (Framer::kFrameWindowSize - 1)) == 0,
+              "kFrameWindowSize must be a power of two");
+static_assert(Framer::kFrameWindowSize > kMaxUnackedFrames,
+              "The frame window must hold all of the frames in flight");
+
 Framer::Framer(const base::TickClock* clock,
                RtpPayloadFeedback* incoming_payload_feedback,
                uint32_t ssrc,
                bool decoder_faster_than_max_frame_rate,
                int max_unacked_frames)
     : decoder_faster_than_max_frame_rate_(decoder_faster_than_max_frame_rate),
+      frames_(new FrameBuffer[kFrameWindowSize]),
+      num_frames_(0),
       cast_msg_builder_(clock,
                         incoming_payload_feedback,
                         this,
@@ -50,28 +57,47 @@ bool Framer::InsertPacket(const uint8_t* payload_data,
     return false;
   }
 
-  // Update the last received frame id.
+  // Update the last received frame id, dropping any frames which no longer
+  // fit in the window.
   if (rtp_header.frame_id > newest_frame_id_) {
     newest_frame_id_ = rtp_header.frame_id;
+    RemoveFramesUpTo(newest_frame_id_ - kFrameWindowSize);
+  } else if (newest_frame_id_ - rtp_header.frame_id >= kFrameWindowSize) {
+    VLOG(2) << "Packet outside of the frame window, ignored: frame "
+            << rtp_header.frame_id;
+    return false;
   }
 
   // Insert packet.
-  const auto it = frames_.find(rtp_header.frame_id);
-  FrameBuffer* buffer;
-  if (it == frames_.end()) {
-    buffer = new FrameBuffer();
-    frames_.insert(std::make_pair(rtp_header.frame_id,
-                                  std::unique_ptr<FrameBuffer>(buffer)));
-  } else {
-    buffer = it->second.get();
+  FrameBuffer* buffer = GetFrame(rtp_header.frame_id);
+  if (!buffer) {
+    buffer = &frames_[SlotIndex(rtp_header.frame_id)];
+    DCHECK(buffer->frame_id().is_null());
+    if (num_frames_ == 0 || rtp_header.frame_id < oldest_frame_id_)
+      oldest_frame_id_ = rtp_header.frame_id;
+    ++num_frames_;
   }
-  if (!buffer->InsertPacket(payload_data, payload_size, rtp_header)) {
+  // Parity packets for a frame which is already complete are treated as
+  // duplicates.
+  const bool inserted =
+      rtp_header.is_fec
+          ? !buffer->Complete() && buffer->InsertFecPacket(
+                                       payload_data, payload_size, rtp_header)
+          : buffer->InsertPacket(payload_data, payload_size, rtp_header);
+  if (!inserted) {
     VLOG(3) << "Packet already received, ignored: frame " << rtp_header.frame_id
             << ", packet " << rtp_header.packet_id;
     *duplicate = true;
     return false;
   }
 
+  // A new packet, whether data or parity, may allow a lost one to be rebuilt
+  // without waiting for its retransmission.
+  const int num_recovered = buffer->RecoverPackets();
+  VLOG_IF(2, num_recovered > 0)
+      << "Recovered " << num_recovered << " packets of frame "
+      << rtp_header.frame_id << " from FEC";
+
   return buffer->Complete();
 }
 
@@ -79,25 +105,23 @@ bool Framer::InsertPacket(const uint8_t* payload_data,
 bool Framer::GetEncodedFrame(EncodedFrame* frame,
                              bool* next_frame,
                              bool* have_multiple_decodable_frames) {
-  *have_multiple_decodable_frames = HaveMultipleDecodableFrames();
-
-  // Find frame id.
-  FrameBuffer* buffer = FindNextFrameForRelease();
-  if (buffer) {
-    // We have our next frame.
-    *next_frame = true;
-  } else {
-    // Check if we can skip frames when our decoder is too slow.
-    if (!decoder_faster_than_max_frame_rate_)
-      return false;
+  FrameBuffer* const buffer =
+      FindFrameToEmit(next_frame, have_multiple_decodable_frames);
+  return buffer && buffer->AssembleEncodedFrame(frame);
+}
 
-    buffer = FindOldestDecodableFrame();
-    if (!buffer)
-      return false;
-    *next_frame = false;
-  }
+bool Framer::PeekEncodedFrame(EncodedFrame* frame,
+                              bool* next_frame,
+                              bool* have_multiple_decodable_frames) {
+  FrameBuffer* const buffer =
+      FindFrameToEmit(next_frame, have_multiple_decodable_frames);
+  return buffer && buffer->GetEncodedFrameMetadata(frame);
+}
 
-  return buffer->AssembleEncodedFrame(frame);
+void Framer::TakeFrameData(FrameId frame_id, std::string* data) {
+  FrameBuffer* const buffer = GetFrame(frame_id);
+  DCHECK(buffer && buffer->Complete());
+  buffer->TakeFrameData(data);
 }
 
 void Framer::AckFrame(FrameId frame_id) {
@@ -106,9 +130,9 @@ void Framer::AckFrame(FrameId frame_id) {
 }
 
 void Framer::ReleaseFrame(FrameId frame_id) {
-  const auto it = frames_.begin();
-  const bool skipped_old_frame = it->first < frame_id;
-  frames_.erase(it, frames_.upper_bound(frame_id));
+  const bool skipped_old_frame =
+      num_frames_ > 0 && oldest_frame_id_ < frame_id;
+  RemoveFramesUpTo(frame_id);
   last_released_frame_ = frame_id;
   if (skipped_old_frame)
     cast_msg_builder_.UpdateCastMessage();
@@ -122,26 +146,91 @@ void Framer::SendCastMessage() {
   cast_msg_builder_.UpdateCastMessage();
 }
 
+size_t Framer::SlotIndex(FrameId frame_id) {
+  return frame_id.lower_32_bits() & (kFrameWindowSize - 1);
+}
+
+FrameBuffer* Framer::GetFrame(FrameId frame_id) const {
+  FrameBuffer* const buffer = &frames_[SlotIndex(frame_id)];
+  return buffer->frame_id() == frame_id ? buffer : nullptr;
+}
+
+void Framer::RemoveFramesUpTo(FrameId frame_id) {
+  if (num_frames_ == 0 || frame_id < oldest_frame_id_)
+    return;
+
+  if (frame_id - oldest_frame_id_ < kFrameWindowSize) {
+    for (FrameId id = oldest_frame_id_; id <= frame_id; ++id) {
+      FrameBuffer* const buffer = GetFrame(id);
+      if (buffer) {
+        buffer->Reset();
+        --num_frames_;
+      }
+    }
+  } else {
+    for (int i = 0; i < kFrameWindowSize; ++i) {
+      FrameBuffer& buffer = frames_[i];
+      if (!buffer.frame_id().is_null() && buffer.frame_id() <= frame_id) {
+        buffer.Reset();
+        --num_frames_;
+      }
+    }
+  }
+
+  // The frames left are all newer than |frame_id|, and within the window.
+  oldest_frame_id_ = frame_id + 1;
+  while (num_frames_ > 0 && !GetFrame(oldest_frame_id_))
+    ++oldest_frame_id_;
+}
+
+FrameBuffer* Framer::FindFrameToEmit(bool* next_frame,
+                                     bool* have_multiple_decodable_frames) {
+  *have_multiple_decodable_frames = HaveMultipleDecodableFrames();
+
+  // Find frame id.
+  FrameBuffer* buffer = FindNextFrameForRelease();
+  if (buffer) {
+    // We have our next frame.
+    *next_frame = true;
+    return buffer;
+  }
+
+  // Check if we can skip frames when our decoder is too slow.
+  if (!decoder_faster_than_max_frame_rate_)
+    return nullptr;
+
+  buffer = FindOldestDecodableFrame();
+  if (buffer)
+    *next_frame = false;
+  return buffer;
+}
+
 FrameBuffer* Framer::FindNextFrameForRelease() {
-  for (const auto& entry : frames_) {
-    if (entry.second->Complete() && IsNextFrameForRelease(*entry.second))
-      return entry.second.get();
+  for (FrameId id = oldest_frame_id_; num_frames_ > 0 && id <= newest_frame_id_;
+       ++id) {
+    FrameBuffer* const buffer = GetFrame(id);
+    if (buffer && buffer->Complete() && IsNextFrameForRelease(*buffer))
+      return buffer;
   }
   return nullptr;
 }
 
 FrameBuffer* Framer::FindOldestDecodableFrame() {
-  for (const auto& entry : frames_) {
-    if (entry.second->Complete() && IsDecodableFrame(*entry.second))
-      return entry.second.get();
+  for (FrameId id = oldest_frame_id_; num_frames_ > 0 && id <= newest_frame_id_;
+       ++id) {
+    FrameBuffer* const buffer = GetFrame(id);
+    if (buffer && buffer->Complete() && IsDecodableFrame(*buffer))
+      return buffer;
   }
   return nullptr;
 }
 
 bool Framer::HaveMultipleDecodableFrames() const {
   bool found_one = false;
-  for (const auto& entry : frames_) {
-    if (entry.second->Complete() && IsDecodableFrame(*entry.second)) {
+  for (FrameId id = oldest_frame_id_; num_frames_ > 0 && id <= newest_frame_id_;
+       ++id) {
+    const FrameBuffer* const buffer = GetFrame(id);
+    if (buffer && buffer->Complete() && IsDecodableFrame(*buffer)) {
       if (found_one)
         return true;  // Found another.
       else
@@ -152,30 +241,32 @@ bool Framer::HaveMultipleDecodableFrames() const {
 }
 
 bool Framer::Empty() const {
-  return frames_.empty();
+  return num_frames_ == 0;
 }
 
 int Framer::NumberOfCompleteFrames() const {
   int count = 0;
-  for (const auto& entry : frames_) {
-    if (entry.second->Complete())
+  for (FrameId id = oldest_frame_id_; num_frames_ > 0 && id <= newest_frame_id_;
+       ++id) {
+    const FrameBuffer* const buffer = GetFrame(id);
+    if (buffer && buffer->Complete())
       ++count;
   }
   return count;
 }
 
 bool Framer::FrameExists(FrameId frame_id) const {
-  return frames_.end() != frames_.find(frame_id);
+  return GetFrame(frame_id) != nullptr;
 }
 
 void Framer::GetMissingPackets(FrameId frame_id,
                                bool last_frame,
                                PacketIdSet* missing_packets) const {
-  const auto it = frames_.find(frame_id);
-  if (it == frames_.end())
+  const FrameBuffer* const buffer = GetFrame(frame_id);
+  if (!buffer)
     return;
 
-  it->second->GetMissingPackets(last_frame, missing_packets);
+  buffer->GetMissingPackets(last_frame, missing_packets);
 }
 
 bool Framer::IsNextFrameForRelease(const FrameBuffer& buffer) const {
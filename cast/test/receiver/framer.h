@@ -8,8 +8,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#include <map>
 #include <memory>
+#include <string>
 
 #include "base/macros.h"
 #include "base/time/tick_clock.h"
@@ -21,8 +21,14 @@
 namespace media {
 namespace cast {
 
+// Reassembles frames from their packets. Frames in flight are kept in a ring
+// of kFrameWindowSize FrameBuffers, indexed by frame ID, whose memory is
+// reused from one frame to the next.
 class Framer {
  public:
+  // The number of frames, counting back from the newest, which can be held.
+  static constexpr int kFrameWindowSize = 256;
+
   Framer(const base::TickClock* clock,
          RtpPayloadFeedback* incoming_payload_feedback,
          uint32_t ssrc,
@@ -36,7 +42,9 @@ class Framer {
 
   // Return true when receiving the last packet in a frame, creating a
   // complete frame. If a duplicate packet for an already complete frame is
-  // received, the function returns false but sets |duplicate| to true.
+  // received, the function returns false but sets |duplicate| to true. FEC
+  // parity packets complete a frame when they allow a lost packet to be
+  // rebuilt.
   bool InsertPacket(const uint8_t* payload_data,
                     size_t payload_size,
                     const RtpCastHeader& rtp_header,
@@ -51,6 +59,17 @@ class Framer {
                        bool* next_frame,
                        bool* have_multiple_complete_frames);
 
+  // Like GetEncodedFrame(), but only sets the metadata of |video_frame|,
+  // without copying its data. The data can then be taken with
+  // TakeFrameData() once the frame is about to be released.
+  bool PeekEncodedFrame(EncodedFrame* video_frame,
+                        bool* next_frame,
+                        bool* have_multiple_complete_frames);
+
+  // Moves the data of the complete frame |frame_id| into |data|, without
+  // copying it.
+  void TakeFrameData(FrameId frame_id, std::string* data);
+
   // TODO(hubbe): Move this elsewhere.
   void AckFrame(FrameId frame_id);
 
@@ -71,6 +90,18 @@ class Framer {
                          PacketIdSet* missing_packets) const;
 
  private:
+  static size_t SlotIndex(FrameId frame_id);
+
+  // Returns the buffer holding |frame_id|, or nullptr if there is none.
+  FrameBuffer* GetFrame(FrameId frame_id) const;
+
+  // Empties the buffers of |frame_id| and all older frames.
+  void RemoveFramesUpTo(FrameId frame_id);
+
+  // Helper for GetEncodedFrame() and PeekEncodedFrame().
+  FrameBuffer* FindFrameToEmit(bool* next_frame,
+                               bool* have_multiple_decodable_frames);
+
   // Identifies the next frame to be released (rendered) and returns its
   // associated buffer, or returns nullptr there is none.
   FrameBuffer* FindNextFrameForRelease();
@@ -87,7 +118,15 @@ class Framer {
   bool IsDecodableFrame(const FrameBuffer& frame) const;
 
   const bool decoder_faster_than_max_frame_rate_;
-  std::map<FrameId, std::unique_ptr<FrameBuffer>> frames_;
+
+  // The ring of frame buffers. A frame is in slot SlotIndex(frame_id), and
+  // empty slots have a null frame ID. All frames lie between
+  // |oldest_frame_id_| and |newest_frame_id_|, less than kFrameWindowSize
+  // apart.
+  const std::unique_ptr<FrameBuffer[]> frames_;
+  int num_frames_;
+  FrameId oldest_frame_id_;
+
   CastMessageBuilder cast_msg_builder_;
   bool waiting_for_key_;
   FrameId last_released_frame_;
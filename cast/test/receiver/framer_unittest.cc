@@ -4,10 +4,14 @@
 
 #include <stdint.h>
 
+#include <string>
+#include <vector>
+
 #include "base/macros.h"
 #include "base/test/simple_test_tick_clock.h"
 #include "media/cast/net/cast_transport_defines.h"
 #include "media/cast/net/rtp/mock_rtp_payload_feedback.h"
+#include "media/cast/net/rtp/rtp_fec.h"
 #include "media/cast/test/receiver/framer.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -31,6 +35,33 @@ class FramerTest : public ::testing::Test {
 
   ~FramerTest() override = default;
 
+  // Fills |packets| with the payloads of a key frame and returns the FEC
+  // parity packet protecting all of them, setting |fec_header|.
+  std::vector<uint8_t> BuildFecProtectedFrame(
+      std::vector<std::vector<uint8_t>>* packets,
+      RtpCastHeader* fec_header) {
+    const size_t kPacketSizes[] = {100, 100, 60};
+    rtp_header_.frame_id = FrameId::first();
+    rtp_header_.reference_frame_id = FrameId::first();
+    rtp_header_.is_key_frame = true;
+    rtp_header_.max_packet_id = 2;
+    *fec_header = rtp_header_;
+    fec_header->packet_id = 3;
+    fec_header->is_fec = true;
+    fec_header->fec_first_packet_id = 0;
+    fec_header->fec_num_packets = 3;
+    std::vector<uint8_t> parity;
+    for (size_t i = 0; i < 3; ++i) {
+      std::vector<uint8_t> packet(kPacketSizes[i]);
+      for (size_t j = 0; j < packet.size(); ++j)
+        packet[j] = static_cast<uint8_t>(i * 31 + j);
+      XorIntoParity(packet.data(), packet.size(), &parity);
+      fec_header->fec_length_recovery ^= static_cast<uint16_t>(packet.size());
+      packets->push_back(packet);
+    }
+    return parity;
+  }
+
   std::vector<uint8_t> payload_;
   RtpCastHeader rtp_header_;
   MockRtpPayloadFeedback mock_rtp_payload_feedback_;
@@ -439,5 +470,129 @@ TEST_F(FramerTest, SkipsMissingFramesWhenLaterKeyFramesAreAvailable) {
   framer_.ReleaseFrame(frame.frame_id);
 }
 
+TEST_F(FramerTest, RecoverLostPacketFromFec) {
+  EncodedFrame frame;
+  bool next_frame = false;
+  bool multiple = false;
+  bool duplicate = false;
+
+  std::vector<std::vector<uint8_t>> packets;
+  RtpCastHeader fec_header;
+  std::vector<uint8_t> parity = BuildFecProtectedFrame(&packets, &fec_header);
+
+  // Packet 1 is lost.
+  rtp_header_.packet_id = 0;
+  EXPECT_FALSE(framer_.InsertPacket(packets[0].data(), packets[0].size(),
+                                    rtp_header_, &duplicate));
+  rtp_header_.packet_id = 2;
+  EXPECT_FALSE(framer_.InsertPacket(packets[2].data(), packets[2].size(),
+                                    rtp_header_, &duplicate));
+  EXPECT_TRUE(framer_.InsertPacket(parity.data(), parity.size(), fec_header,
+                                   &duplicate));
+  EXPECT_FALSE(duplicate);
+
+  ASSERT_TRUE(framer_.GetEncodedFrame(&frame, &next_frame, &multiple));
+  std::string expected_data;
+  for (const auto& packet : packets)
+    expected_data.append(packet.begin(), packet.end());
+  EXPECT_EQ(expected_data, frame.data);
+
+  // A late retransmission of the lost packet is a duplicate.
+  rtp_header_.packet_id = 1;
+  EXPECT_FALSE(framer_.InsertPacket(packets[1].data(), packets[1].size(),
+                                    rtp_header_, &duplicate));
+  EXPECT_TRUE(duplicate);
+}
+
+TEST_F(FramerTest, RecoverFromFecOnceOnlyOnePacketIsMissing) {
+  EncodedFrame frame;
+  bool next_frame = false;
+  bool multiple = false;
+  bool duplicate = false;
+
+  std::vector<std::vector<uint8_t>> packets;
+  RtpCastHeader fec_header;
+  std::vector<uint8_t> parity = BuildFecProtectedFrame(&packets, &fec_header);
+
+  // Packets 0 and 2 are lost; parity alone can't rebuild them.
+  rtp_header_.packet_id = 1;
+  EXPECT_FALSE(framer_.InsertPacket(packets[1].data(), packets[1].size(),
+                                    rtp_header_, &duplicate));
+  EXPECT_FALSE(framer_.InsertPacket(parity.data(), parity.size(), fec_header,
+                                    &duplicate));
+  EXPECT_FALSE(framer_.GetEncodedFrame(&frame, &next_frame, &multiple));
+
+  // Both are reported missing.
+  PacketIdSet missing_packets;
+  framer_.GetMissingPackets(rtp_header_.frame_id, true, &missing_packets);
+  EXPECT_EQ(2u, missing_packets.size());
+
+  // The retransmission of packet 2 allows packet 0 to be rebuilt.
+  rtp_header_.packet_id = 2;
+  EXPECT_TRUE(framer_.InsertPacket(packets[2].data(), packets[2].size(),
+                                   rtp_header_, &duplicate));
+  ASSERT_TRUE(framer_.GetEncodedFrame(&frame, &next_frame, &multiple));
+  EXPECT_EQ(std::string(packets[0].begin(), packets[0].end()),
+            frame.data.substr(0, packets[0].size()));
+}
+
+TEST_F(FramerTest, PeekAndTakeFrameData) {
+  EncodedFrame frame;
+  bool next_frame = false;
+  bool multiple = false;
+  bool duplicate = false;
+
+  rtp_header_.frame_id = FrameId::first();
+  rtp_header_.reference_frame_id = FrameId::first();
+  rtp_header_.is_key_frame = true;
+  rtp_header_.max_packet_id = 1;
+  for (size_t i = 0; i < payload_.size(); ++i)
+    payload_[i] = static_cast<uint8_t>(i);
+  framer_.InsertPacket(&payload_[0], payload_.size(), rtp_header_, &duplicate);
+  rtp_header_.packet_id = 1;
+  EXPECT_TRUE(framer_.InsertPacket(&payload_[0], 10, rtp_header_, &duplicate));
+
+  // Peeking leaves the data in the framer.
+  EXPECT_TRUE(framer_.PeekEncodedFrame(&frame, &next_frame, &multiple));
+  EXPECT_TRUE(next_frame);
+  EXPECT_EQ(FrameId::first(), frame.frame_id);
+  EXPECT_TRUE(frame.data.empty());
+
+  framer_.TakeFrameData(frame.frame_id, &frame.data);
+  std::string expected_data(payload_.begin(), payload_.end());
+  expected_data.append(payload_.begin(), payload_.begin() + 10);
+  EXPECT_EQ(expected_data, frame.data);
+  framer_.ReleaseFrame(frame.frame_id);
+  EXPECT_TRUE(framer_.Empty());
+}
+
+TEST_F(FramerTest, DropsFramesOutsideTheWindow) {
+  bool duplicate = false;
+
+  // An incomplete key frame.
+  rtp_header_.frame_id = FrameId::first();
+  rtp_header_.reference_frame_id = FrameId::first();
+  rtp_header_.is_key_frame = true;
+  rtp_header_.max_packet_id = 1;
+  framer_.InsertPacket(&payload_[0], payload_.size(), rtp_header_, &duplicate);
+  EXPECT_TRUE(framer_.FrameExists(FrameId::first()));
+
+  // A frame one window ahead pushes it out.
+  rtp_header_.frame_id = FrameId::first() + Framer::kFrameWindowSize;
+  rtp_header_.reference_frame_id = rtp_header_.frame_id;
+  framer_.InsertPacket(&payload_[0], payload_.size(), rtp_header_, &duplicate);
+  EXPECT_FALSE(framer_.FrameExists(FrameId::first()));
+  EXPECT_TRUE(framer_.FrameExists(rtp_header_.frame_id));
+
+  // Packets of the dropped frame are no longer accepted.
+  rtp_header_.frame_id = FrameId::first();
+  rtp_header_.reference_frame_id = FrameId::first();
+  rtp_header_.packet_id = 1;
+  EXPECT_FALSE(framer_.InsertPacket(&payload_[0], payload_.size(), rtp_header_,
+                                    &duplicate));
+  EXPECT_FALSE(framer_.FrameExists(FrameId::first()));
+  EXPECT_EQ(0, framer_.NumberOfCompleteFrames());
+}
+
 }  // namespace cast
 }  // namespace media
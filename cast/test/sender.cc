@@ -6,6 +6,7 @@
 // or read from a file.
 
 #include <stdint.h>
+#include <stdio.h>
 
 #include <memory>
 #include <utility>
@@ -15,7 +16,9 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/command_line.h"
+#include "base/containers/span.h"
 #include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
 #include "base/json/json_writer.h"
 #include "base/logging.h"
 #include "base/message_loop/message_pump_type.h"
@@ -32,9 +35,8 @@
 #include "media/cast/cast_config.h"
 #include "media/cast/cast_environment.h"
 #include "media/cast/cast_sender.h"
-#include "media/cast/logging/encoding_event_subscriber.h"
+#include "media/cast/logging/binary_event_log.h"
 #include "media/cast/logging/logging_defines.h"
-#include "media/cast/logging/proto/raw_events.pb.h"
 #include "media/cast/logging/receiver_time_offset_estimator_impl.h"
 #include "media/cast/logging/stats_event_subscriber.h"
 #include "media/cast/net/cast_transport.h"
@@ -86,16 +88,20 @@ net::IPEndPoint CreateUDPAddress(const std::string& ip_str, uint16_t port) {
   return net::IPEndPoint(ip_address, port);
 }
 
-void WriteLogsToFileAndDestroySubscribers(
+void WriteToLogFile(FILE* log_file, base::span<const uint8_t> data) {
+  if (fwrite(data.data(), 1, data.size(), log_file) != data.size())
+    VLOG(1) << "Failed to write to the event log file.";
+  fflush(log_file);
+}
+
+void FlushLogAndDestroyWriter(
     const scoped_refptr<media::cast::CastEnvironment>& cast_environment,
-    std::unique_ptr<media::cast::EncodingEventSubscriber>
-        video_event_subscriber,
-    std::unique_ptr<media::cast::EncodingEventSubscriber>
-        audio_event_subscriber,
-    base::ScopedFILE video_log_file,
-    base::ScopedFILE audio_log_file) {
-  cast_environment->logger()->Unsubscribe(video_event_subscriber.get());
-  cast_environment->logger()->Unsubscribe(audio_event_subscriber.get());
+    std::unique_ptr<media::cast::BinaryEventLogWriter> event_log_writer,
+    base::ScopedFILE log_file) {
+  cast_environment->logger()->Unsubscribe(event_log_writer.get());
+  event_log_writer->Flush();
+  // The writer must not outlive the file it writes to.
+  event_log_writer.reset();
 }
 
 void WriteStatsAndDestroySubscribers(
@@ -226,21 +232,18 @@ int main(int argc, char** argv) {
               remote_endpoint, base::BindRepeating(&UpdateCastTransportStatus)),
           io_task_executor.task_runner());
 
-  // Set up event subscribers.
-  std::unique_ptr<media::cast::EncodingEventSubscriber> video_event_subscriber;
-  std::unique_ptr<media::cast::EncodingEventSubscriber> audio_event_subscriber;
-  std::string video_log_file_name("/tmp/video_events.log.gz");
-  std::string audio_log_file_name("/tmp/audio_events.log.gz");
-  LOG(INFO) << "Logging audio events to: " << audio_log_file_name;
-  LOG(INFO) << "Logging video events to: " << video_log_file_name;
-  video_event_subscriber =
-      std::make_unique<media::cast::EncodingEventSubscriber>(
-          media::cast::VIDEO_EVENT, 10000);
-  audio_event_subscriber =
-      std::make_unique<media::cast::EncodingEventSubscriber>(
-          media::cast::AUDIO_EVENT, 10000);
-  cast_environment->logger()->Subscribe(video_event_subscriber.get());
-  cast_environment->logger()->Subscribe(audio_event_subscriber.get());
+  // Set up the event log. It is written to the file as the session goes,
+  // and can be decoded with cast_event_log_decoder.
+  std::string log_file_name("/tmp/cast_events.log");
+  LOG(INFO) << "Logging events to: " << log_file_name;
+  base::ScopedFILE log_file(fopen(log_file_name.c_str(), "wb"));
+  if (!log_file) {
+    VLOG(1) << "Failed to open log file for writing.";
+    exit(-1);
+  }
+  auto event_log_writer = std::make_unique<media::cast::BinaryEventLogWriter>(
+      1 << 20, base::BindRepeating(&WriteToLogFile, log_file.get()));
+  cast_environment->logger()->Subscribe(event_log_writer.get());
 
   // Subscribers for stats.
   std::unique_ptr<media::cast::ReceiverTimeOffsetEstimatorImpl>
@@ -257,25 +260,11 @@ int main(int argc, char** argv) {
   cast_environment->logger()->Subscribe(video_stats_subscriber.get());
   cast_environment->logger()->Subscribe(audio_stats_subscriber.get());
 
-  base::ScopedFILE video_log_file(fopen(video_log_file_name.c_str(), "w"));
-  if (!video_log_file) {
-    VLOG(1) << "Failed to open video log file for writing.";
-    exit(-1);
-  }
-
-  base::ScopedFILE audio_log_file(fopen(audio_log_file_name.c_str(), "w"));
-  if (!audio_log_file) {
-    VLOG(1) << "Failed to open audio log file for writing.";
-    exit(-1);
-  }
-
   const int logging_duration_seconds = 10;
   io_task_executor.task_runner()->PostDelayedTask(
       FROM_HERE,
-      base::BindOnce(&WriteLogsToFileAndDestroySubscribers, cast_environment,
-                     std::move(video_event_subscriber),
-                     std::move(audio_event_subscriber),
-                     std::move(video_log_file), std::move(audio_log_file)),
+      base::BindOnce(&FlushLogAndDestroyWriter, cast_environment,
+                     std::move(event_log_writer), std::move(log_file)),
       base::Seconds(logging_duration_seconds));
 
   io_task_executor.task_runner()->PostDelayedTask(
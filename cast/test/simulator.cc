@@ -29,6 +29,26 @@
 //   File path to write YUV decoded frames in YUV4MPEG2 format.
 // --no-simulation
 //   Do not run network simulation.
+// --congestion-control=
+//   The video congestion control: "adaptive" (default) or "delay-based".
+// --evaluate-congestion-control
+//   Instead of a single run, run every built-in network profile with each
+//   congestion control, using the full default video bitrate range, and
+//   print the throughput, queueing delay and loss on the sender to receiver
+//   path for each. --run-time applies to every run.
+// --fec
+//   Send video with forward error correction.
+// --evaluate-fec
+//   Instead of a single run, run a path with 1% to 5% random packet loss
+//   with and without FEC, and print the video frame completion latency for
+//   each. --run-time applies to every run.
+// --scalability-mode=
+//   Encode video in temporal layers: "L1T2" or "L1T3". Frames of the upper
+//   layers are dropped by the sender under congestion.
+// --evaluate-temporal-layers
+//   Instead of a single run, run every built-in network profile with one, two
+//   and three temporal layers, and print the throughput and the video frame
+//   completion latency for each. --run-time applies to every run.
 //
 // Output:
 // - Raw event log of the simulation session tagged with the unique test ID,
@@ -37,8 +57,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "base/at_exit.h"
 #include "base/base_paths.h"
@@ -65,6 +88,7 @@
 #include "media/base/audio_bus.h"
 #include "media/base/fake_single_thread_task_runner.h"
 #include "media/base/media.h"
+#include "media/base/svc_scalability_mode.h"
 #include "media/base/video_frame.h"
 #include "media/cast/cast_config.h"
 #include "media/cast/cast_environment.h"
@@ -78,6 +102,8 @@
 #include "media/cast/net/cast_transport_config.h"
 #include "media/cast/net/cast_transport_defines.h"
 #include "media/cast/net/cast_transport_impl.h"
+#include "media/cast/net/rtcp/rtcp_utility.h"
+#include "media/cast/net/rtp/rtp_defines.h"
 #include "media/cast/test/fake_media_source.h"
 #include "media/cast/test/loopback_transport.h"
 #include "media/cast/test/proto/network_simulation_model.pb.h"
@@ -88,14 +114,22 @@
 #include "media/cast/test/utility/test_util.h"
 #include "media/cast/test/utility/udp_proxy.h"
 #include "media/cast/test/utility/video_utility.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 using media::cast::proto::IPPModel;
+using media::cast::proto::NetworkProfile;
 using media::cast::proto::NetworkSimulationModel;
 using media::cast::proto::NetworkSimulationModelType;
+using media::cast::proto::RandomLossModel;
 
 namespace media {
 namespace cast {
 namespace {
+const char kCongestionControl[] = "congestion-control";
+const char kEvaluateCongestionControl[] = "evaluate-congestion-control";
+const char kEvaluateFec[] = "evaluate-fec";
+const char kEvaluateTemporalLayers[] = "evaluate-temporal-layers";
+const char kFec[] = "fec";
 const char kLibDir[] = "lib-dir";
 const char kModelPath[] = "model";
 const char kMetricsOutputPath[] = "metrics-output";
@@ -103,6 +137,7 @@ const char kOutputPath[] = "output";
 const char kMaxFrameRate[] = "max-frame-rate";
 const char kNoSimulation[] = "no-simulation";
 const char kRunTime[] = "run-time";
+const char kScalabilityMode[] = "scalability-mode";
 const char kSimulationId[] = "sim-id";
 const char kSourcePath[] = "source";
 const char kSourceFrameRate[] = "source-frame-rate";
@@ -167,6 +202,145 @@ class TransportClient : public CastTransport::Client {
   PacketProxy* const packet_proxy_;                 // Not owned by this class.
 };
 
+// Packet statistics of the sender to receiver path, collected by a pair of
+// PathStatsPipes placed around the simulated network.
+struct PathStats {
+  int64_t packets_sent = 0;
+  int64_t packets_delivered = 0;
+  int64_t bytes_delivered = 0;
+  // Times at which the RTP packets now in the network entered it, keyed by
+  // SSRC and sequence number. A retransmission restarts its packet's entry.
+  std::map<std::pair<uint32_t, uint16_t>, base::TimeTicks> in_network;
+  // Transit time of each delivered RTP packet.
+  std::vector<base::TimeDelta> transit_times;
+};
+
+class PathStatsPipe final : public test::PacketPipe {
+ public:
+  enum Position { kEntry, kExit };
+
+  PathStatsPipe(PathStats* stats, Position position)
+      : stats_(stats), position_(position) {}
+
+  PathStatsPipe(const PathStatsPipe&) = delete;
+  PathStatsPipe& operator=(const PathStatsPipe&) = delete;
+
+  ~PathStatsPipe() final = default;
+
+  // PacketPipe implementation.
+  void Send(std::unique_ptr<Packet> packet) final {
+    if (packet->size() >= kRtpHeaderLength &&
+        !IsRtcpPacket(packet->data(), packet->size())) {
+      const uint8_t* const header = packet->data();
+      const uint16_t sequence_number = (header[2] << 8) | header[3];
+      const uint32_t ssrc = (header[8] << 24) | (header[9] << 16) |
+                            (header[10] << 8) | header[11];
+      const auto key = std::make_pair(ssrc, sequence_number);
+      const base::TimeTicks now = clock_->NowTicks();
+      if (position_ == kEntry) {
+        ++stats_->packets_sent;
+        stats_->in_network[key] = now;
+      } else {
+        ++stats_->packets_delivered;
+        stats_->bytes_delivered += packet->size();
+        auto it = stats_->in_network.find(key);
+        if (it != stats_->in_network.end()) {
+          stats_->transit_times.push_back(now - it->second);
+          stats_->in_network.erase(it);
+        }
+      }
+    }
+    pipe_->Send(std::move(packet));
+  }
+
+ private:
+  PathStats* const stats_;  // Not owned by this class.
+  const Position position_;
+};
+
+// The results of one simulation run.
+struct SimulationResult {
+  // Payload delivered to the receiver, including retransmissions.
+  double throughput_kbps = 0;
+  // Transit time on the sender to receiver path in excess of the shortest
+  // transit time seen, i.e. time spent queued in the simulated network.
+  double mean_queueing_delay_ms = 0;
+  double p95_queueing_delay_ms = 0;
+  // Fraction of the RTP packets sent that the network dropped.
+  double packet_loss = 0;
+  int late_video_frames = 0;
+  double avg_encoded_bitrate_kbps = 0;
+  // Time from the encoding of a video frame to its decoding, over the frames
+  // decoded.
+  double mean_frame_completion_ms = 0;
+  double p95_frame_completion_ms = 0;
+};
+
+// How the video sender is configured for a simulation run.
+struct SenderOptions {
+  CongestionControlType congestion_control_type =
+      CongestionControlType::ADAPTIVE;
+  bool enable_fec = false;
+  absl::optional<SVCScalabilityMode> scalability_mode;
+};
+
+// Measures how long each video frame takes to become available to the
+// receiver: from its FRAME_ENCODED event on the sender to its FRAME_DECODED
+// event on the receiver. This includes the time spent waiting for lost packets
+// to be retransmitted or rebuilt. Subscribe to the loggers of both sides.
+class FrameCompletionTracker final : public RawEventSubscriber {
+ public:
+  FrameCompletionTracker() = default;
+
+  FrameCompletionTracker(const FrameCompletionTracker&) = delete;
+  FrameCompletionTracker& operator=(const FrameCompletionTracker&) = delete;
+
+  ~FrameCompletionTracker() final = default;
+
+  // RawEventSubscriber implementations.
+  void OnReceiveFrameEvent(const FrameEvent& frame_event) final {
+    if (frame_event.media_type != VIDEO_EVENT)
+      return;
+    if (frame_event.type == FRAME_ENCODED) {
+      encode_times_[frame_event.rtp_timestamp] = frame_event.timestamp;
+    } else if (frame_event.type == FRAME_DECODED) {
+      auto it = encode_times_.find(frame_event.rtp_timestamp);
+      if (it == encode_times_.end())
+        return;
+      completion_times_.push_back(frame_event.timestamp - it->second);
+      // Frames older than this one will not be decoded anymore.
+      encode_times_.erase(encode_times_.begin(), ++it);
+    }
+  }
+
+  void OnReceivePacketEvent(const PacketEvent& packet_event) final {}
+
+  std::vector<base::TimeDelta>& completion_times() {
+    return completion_times_;
+  }
+
+ private:
+  std::map<RtpTimeTicks, base::TimeTicks> encode_times_;
+  std::vector<base::TimeDelta> completion_times_;
+};
+
+std::unique_ptr<test::PacketPipe> NewProfilePipe(NetworkProfile profile) {
+  switch (profile) {
+    case media::cast::proto::GOOD_NETWORK:
+      return test::GoodNetwork();
+    case media::cast::proto::WIFI_NETWORK:
+      return test::WifiNetwork();
+    case media::cast::proto::SLOW_NETWORK:
+      return test::SlowNetwork();
+    case media::cast::proto::BAD_NETWORK:
+      return test::BadNetwork();
+    case media::cast::proto::EVIL_NETWORK:
+      return test::EvilNetwork();
+  }
+  NOTREACHED();
+  return nullptr;
+}
+
 // Maintains a queue of encoded video frames.
 // This works by tracking FRAME_CAPTURE_END and FRAME_ENCODED events.
 // If a video frame is detected to be encoded it transfers a frame
@@ -296,12 +470,14 @@ void GotAudioFrame(int* counter,
 //
 // |log_output_path| is the path to write serialized log.
 // |extra_data| is extra tagging information to write to log.
-void RunSimulation(const base::FilePath& source_path,
-                   const base::FilePath& log_output_path,
-                   const base::FilePath& metrics_output_path,
-                   const base::FilePath& yuv_output_path,
-                   const std::string& extra_data,
-                   const NetworkSimulationModel& model) {
+SimulationResult RunSimulation(
+    const base::FilePath& source_path,
+    const base::FilePath& log_output_path,
+    const base::FilePath& metrics_output_path,
+    const base::FilePath& yuv_output_path,
+    const std::string& extra_data,
+    const NetworkSimulationModel& model,
+    const SenderOptions& sender_options) {
   // Fake clock. Make sure start time is non zero.
   base::SimpleTestTickClock testing_clock;
   testing_clock.Advance(base::Seconds(1));
@@ -326,6 +502,9 @@ void RunSimulation(const base::FilePath& source_path,
                                                  30 * 60 * 60);
   sender_env->logger()->Subscribe(&audio_event_subscriber);
   sender_env->logger()->Subscribe(&video_event_subscriber);
+  FrameCompletionTracker frame_completion_tracker;
+  sender_env->logger()->Subscribe(&frame_completion_tracker);
+  receiver_env->logger()->Subscribe(&frame_completion_tracker);
 
   // Audio sender config.
   FrameSenderConfig audio_sender_config = GetDefaultAudioSenderConfig();
@@ -341,9 +520,20 @@ void RunSimulation(const base::FilePath& source_path,
 
   // Video sender config.
   FrameSenderConfig video_sender_config = GetDefaultVideoSenderConfig();
-  video_sender_config.max_bitrate = 2500000;
-  video_sender_config.min_bitrate = 2000000;
-  video_sender_config.start_bitrate = 2000000;
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch(
+          kEvaluateCongestionControl)) {
+    // Give the congestion control the full default range to work with.
+    video_sender_config.start_bitrate = video_sender_config.min_bitrate;
+  } else {
+    video_sender_config.max_bitrate = 2500000;
+    video_sender_config.min_bitrate = 2000000;
+    video_sender_config.start_bitrate = 2000000;
+  }
+  video_sender_config.congestion_control_type =
+      sender_options.congestion_control_type;
+  video_sender_config.enable_fec = sender_options.enable_fec;
+  video_sender_config.video_codec_params.scalability_mode =
+      sender_options.scalability_mode;
   video_sender_config.min_playout_delay =
       video_sender_config.max_playout_delay =
           audio_sender_config.max_playout_delay;
@@ -381,37 +571,65 @@ void RunSimulation(const base::FilePath& source_path,
       CastSender::Create(sender_env, transport_sender.get()));
 
   // Initialize network simulation model.
-  const bool use_network_simulation =
-      model.type() == media::cast::proto::INTERRUPTED_POISSON_PROCESS;
+  std::unique_ptr<test::PacketPipe> sender_to_receiver_pipe;
+  std::unique_ptr<test::PacketPipe> receiver_to_sender_pipe;
   std::unique_ptr<test::InterruptedPoissonProcess> ipp;
-  if (use_network_simulation) {
-    LOG(INFO) << "Running Poisson based network simulation.";
-    const IPPModel& ipp_model = model.ipp();
-    std::vector<double> average_rates(ipp_model.average_rate_size());
-    std::copy(ipp_model.average_rate().begin(),
-              ipp_model.average_rate().end(),
-              average_rates.begin());
-    ipp = std::make_unique<test::InterruptedPoissonProcess>(
-        average_rates, ipp_model.coef_burstiness(), ipp_model.coef_variance(),
-        0);
-    receiver_to_sender->Initialize(ipp->NewBuffer(128 * 1024),
-                                   transport_sender->PacketReceiverForTesting(),
-                                   task_runner, &testing_clock);
-    sender_to_receiver->Initialize(
-        ipp->NewBuffer(128 * 1024),
-        transport_receiver->PacketReceiverForTesting(), task_runner,
-        &testing_clock);
-  } else {
-    LOG(INFO) << "No network simulation.";
-    receiver_to_sender->Initialize(std::unique_ptr<test::PacketPipe>(),
-                                   transport_sender->PacketReceiverForTesting(),
-                                   task_runner, &testing_clock);
-    sender_to_receiver->Initialize(
-        std::unique_ptr<test::PacketPipe>(),
-        transport_receiver->PacketReceiverForTesting(), task_runner,
-        &testing_clock);
+  switch (model.type()) {
+    case media::cast::proto::INTERRUPTED_POISSON_PROCESS: {
+      LOG(INFO) << "Running Poisson based network simulation.";
+      const IPPModel& ipp_model = model.ipp();
+      std::vector<double> average_rates(ipp_model.average_rate_size());
+      std::copy(ipp_model.average_rate().begin(),
+                ipp_model.average_rate().end(), average_rates.begin());
+      ipp = std::make_unique<test::InterruptedPoissonProcess>(
+          average_rates, ipp_model.coef_burstiness(),
+          ipp_model.coef_variance(), 0);
+      receiver_to_sender_pipe = ipp->NewBuffer(128 * 1024);
+      sender_to_receiver_pipe = ipp->NewBuffer(128 * 1024);
+      break;
+    }
+    case media::cast::proto::BUILT_IN_PROFILE:
+      LOG(INFO) << "Running simulation of network profile "
+                << proto::NetworkProfile_Name(model.profile()) << ".";
+      receiver_to_sender_pipe = NewProfilePipe(model.profile());
+      sender_to_receiver_pipe = NewProfilePipe(model.profile());
+      break;
+    case media::cast::proto::RANDOM_LOSS: {
+      const RandomLossModel& random_loss = model.random_loss();
+      LOG(INFO) << "Running simulation of " << 100 * random_loss.drop_fraction()
+                << "% random packet loss.";
+      const double delay_seconds = random_loss.one_way_delay_ms() / 1000.0;
+      // Only media packets are dropped, so that runs differ only in how lost
+      // media packets are recovered.
+      receiver_to_sender_pipe = test::NewConstantDelay(delay_seconds);
+      sender_to_receiver_pipe =
+          test::NewRandomDrop(random_loss.drop_fraction());
+      sender_to_receiver_pipe->AppendToPipe(
+          test::NewConstantDelay(delay_seconds));
+      break;
+    }
+    case media::cast::proto::NO_SIMULATION:
+      LOG(INFO) << "No network simulation.";
+      break;
   }
 
+  // Measure the sender to receiver path on both sides of the simulated
+  // network.
+  PathStats path_stats;
+  auto measured_pipe =
+      std::make_unique<PathStatsPipe>(&path_stats, PathStatsPipe::kEntry);
+  if (sender_to_receiver_pipe)
+    measured_pipe->AppendToPipe(std::move(sender_to_receiver_pipe));
+  measured_pipe->AppendToPipe(
+      std::make_unique<PathStatsPipe>(&path_stats, PathStatsPipe::kExit));
+
+  receiver_to_sender->Initialize(std::move(receiver_to_sender_pipe),
+                                 transport_sender->PacketReceiverForTesting(),
+                                 task_runner, &testing_clock);
+  sender_to_receiver->Initialize(std::move(measured_pipe),
+                                 transport_receiver->PacketReceiverForTesting(),
+                                 task_runner, &testing_clock);
+
   // Initialize a fake media source and a tracker to encoded video frames.
   const bool quality_test = !metrics_output_path.empty();
   FakeMediaSource media_source(task_runner,
@@ -450,7 +668,7 @@ void RunSimulation(const base::FilePath& source_path,
     base::ScopedFILE file(base::OpenFile(yuv_output_path, "wb"));
     if (!file.get()) {
       LOG(ERROR) << "Cannot save YUV output to file.";
-      return;
+      return SimulationResult();
     }
     LOG(INFO) << "Writing YUV output to file: " << yuv_output_path.value();
 
@@ -483,6 +701,8 @@ void RunSimulation(const base::FilePath& source_path,
   // Unsubscribe from logging events.
   sender_env->logger()->Unsubscribe(&audio_event_subscriber);
   sender_env->logger()->Unsubscribe(&video_event_subscriber);
+  sender_env->logger()->Unsubscribe(&frame_completion_tracker);
+  receiver_env->logger()->Unsubscribe(&frame_completion_tracker);
   if (quality_test)
     sender_env->logger()->Unsubscribe(video_frame_tracker.get());
 
@@ -561,6 +781,53 @@ void RunSimulation(const base::FilePath& source_path,
             << " ms)";
   LOG(INFO) << "Average encoded bitrate (kbps): " << avg_encoded_bitrate;
   LOG(INFO) << "Average target bitrate (kbps): " << avg_target_bitrate;
+
+  // Compute and print statistics for the sender to receiver path.
+  SimulationResult result;
+  result.late_video_frames = late_video_frames;
+  result.avg_encoded_bitrate_kbps = avg_encoded_bitrate;
+  result.throughput_kbps =
+      path_stats.bytes_delivered * kKilobitsPerByte / elapsed_time.InSecondsF();
+  if (path_stats.packets_sent > 0) {
+    result.packet_loss =
+        1.0 - static_cast<double>(path_stats.packets_delivered) /
+                  path_stats.packets_sent;
+  }
+  std::vector<base::TimeDelta>& transit_times = path_stats.transit_times;
+  if (!transit_times.empty()) {
+    std::sort(transit_times.begin(), transit_times.end());
+    const base::TimeDelta min_transit_time = transit_times.front();
+    base::TimeDelta total_queueing_delay;
+    for (base::TimeDelta transit_time : transit_times)
+      total_queueing_delay += transit_time - min_transit_time;
+    result.mean_queueing_delay_ms =
+        total_queueing_delay.InMillisecondsF() / transit_times.size();
+    result.p95_queueing_delay_ms =
+        (transit_times[transit_times.size() * 95 / 100] - min_transit_time)
+            .InMillisecondsF();
+  }
+  LOG(INFO) << "Path throughput (kbps): " << result.throughput_kbps;
+  LOG(INFO) << "Path queueing delay (ms): mean "
+            << result.mean_queueing_delay_ms << ", 95th percentile "
+            << result.p95_queueing_delay_ms;
+  LOG(INFO) << "Path packet loss: " << result.packet_loss;
+
+  std::vector<base::TimeDelta>& completion_times =
+      frame_completion_tracker.completion_times();
+  if (!completion_times.empty()) {
+    std::sort(completion_times.begin(), completion_times.end());
+    base::TimeDelta total_completion_time;
+    for (base::TimeDelta completion_time : completion_times)
+      total_completion_time += completion_time;
+    result.mean_frame_completion_ms =
+        total_completion_time.InMillisecondsF() / completion_times.size();
+    result.p95_frame_completion_ms =
+        completion_times[completion_times.size() * 95 / 100]
+            .InMillisecondsF();
+  }
+  LOG(INFO) << "Video frame completion latency (ms): mean "
+            << result.mean_frame_completion_ms << ", 95th percentile "
+            << result.p95_frame_completion_ms;
   LOG(INFO) << "Writing log: " << log_output_path.value();
 
   // Truncate file and then write serialized log.
@@ -568,7 +835,7 @@ void RunSimulation(const base::FilePath& source_path,
     base::ScopedFILE file(base::OpenFile(log_output_path, "wb"));
     if (!file.get()) {
       LOG(INFO) << "Cannot write to log.";
-      return;
+      return result;
     }
   }
 
@@ -583,6 +850,104 @@ void RunSimulation(const base::FilePath& source_path,
     }
     WriteFile(metrics_output_path, line.data(), line.length());
   }
+  return result;
+}
+
+// Runs every built-in network profile with each congestion control and prints
+// a comparison table.
+void EvaluateCongestionControl(const base::FilePath& source_path,
+                               const base::FilePath& log_output_path,
+                               const std::string& extra_data) {
+  constexpr CongestionControlType kCongestionControlTypes[] = {
+      CongestionControlType::ADAPTIVE, CongestionControlType::DELAY_BASED};
+
+  std::string table = base::StringPrintf(
+      "\n%-14s %-12s %10s %10s %10s %8s %6s\n", "profile", "controller",
+      "tput_kbps", "qdelay_ms", "q95_ms", "loss_%", "late");
+  for (int i = proto::NetworkProfile_MIN; i <= proto::NetworkProfile_MAX; ++i) {
+    NetworkSimulationModel model;
+    model.set_type(media::cast::proto::BUILT_IN_PROFILE);
+    model.set_profile(static_cast<NetworkProfile>(i));
+    for (CongestionControlType type : kCongestionControlTypes) {
+      SenderOptions sender_options;
+      sender_options.congestion_control_type = type;
+      const SimulationResult result =
+          RunSimulation(source_path, log_output_path, base::FilePath(),
+                        base::FilePath(), extra_data, model, sender_options);
+      base::StringAppendF(
+          &table, "%-14s %-12s %10.0f %10.1f %10.1f %8.2f %6d\n",
+          proto::NetworkProfile_Name(model.profile()).c_str(),
+          type == CongestionControlType::ADAPTIVE ? "adaptive" : "delay-based",
+          result.throughput_kbps, result.mean_queueing_delay_ms,
+          result.p95_queueing_delay_ms, 100 * result.packet_loss,
+          result.late_video_frames);
+    }
+  }
+  LOG(INFO) << "Congestion control evaluation:" << table;
+}
+
+// Runs a path with increasing random packet loss with and without FEC and
+// prints a comparison table.
+void EvaluateFec(const base::FilePath& source_path,
+                 const base::FilePath& log_output_path,
+                 const std::string& extra_data) {
+  constexpr int kOneWayDelayMs = 50;
+
+  std::string table =
+      base::StringPrintf("\n%-7s %-4s %12s %12s %10s %6s\n", "loss_%", "fec",
+                         "complete_ms", "c95_ms", "tput_kbps", "late");
+  for (int loss_percent = 1; loss_percent <= 5; ++loss_percent) {
+    NetworkSimulationModel model;
+    model.set_type(media::cast::proto::RANDOM_LOSS);
+    model.mutable_random_loss()->set_drop_fraction(loss_percent / 100.0);
+    model.mutable_random_loss()->set_one_way_delay_ms(kOneWayDelayMs);
+    for (bool enable_fec : {false, true}) {
+      SenderOptions sender_options;
+      sender_options.enable_fec = enable_fec;
+      const SimulationResult result =
+          RunSimulation(source_path, log_output_path, base::FilePath(),
+                        base::FilePath(), extra_data, model, sender_options);
+      base::StringAppendF(&table, "%-7d %-4s %12.1f %12.1f %10.0f %6d\n",
+                          loss_percent, enable_fec ? "on" : "off",
+                          result.mean_frame_completion_ms,
+                          result.p95_frame_completion_ms,
+                          result.throughput_kbps, result.late_video_frames);
+    }
+  }
+  LOG(INFO) << "FEC evaluation (" << kOneWayDelayMs
+            << " ms one-way delay):" << table;
+}
+
+// Runs every built-in network profile with one, two and three temporal layers
+// and prints a comparison table.
+void EvaluateTemporalLayers(const base::FilePath& source_path,
+                            const base::FilePath& log_output_path,
+                            const std::string& extra_data) {
+  const absl::optional<SVCScalabilityMode> kScalabilityModes[] = {
+      absl::nullopt, SVCScalabilityMode::kL1T2, SVCScalabilityMode::kL1T3};
+
+  std::string table = base::StringPrintf(
+      "\n%-14s %-6s %10s %12s %12s %6s\n", "profile", "layers", "tput_kbps",
+      "complete_ms", "c95_ms", "late");
+  for (int i = proto::NetworkProfile_MIN; i <= proto::NetworkProfile_MAX; ++i) {
+    NetworkSimulationModel model;
+    model.set_type(media::cast::proto::BUILT_IN_PROFILE);
+    model.set_profile(static_cast<NetworkProfile>(i));
+    for (const auto& scalability_mode : kScalabilityModes) {
+      SenderOptions sender_options;
+      sender_options.scalability_mode = scalability_mode;
+      const SimulationResult result =
+          RunSimulation(source_path, log_output_path, base::FilePath(),
+                        base::FilePath(), extra_data, model, sender_options);
+      base::StringAppendF(
+          &table, "%-14s %-6s %10.0f %12.1f %12.1f %6d\n",
+          proto::NetworkProfile_Name(model.profile()).c_str(),
+          scalability_mode ? GetScalabilityModeName(*scalability_mode) : "L1T1",
+          result.throughput_kbps, result.mean_frame_completion_ms,
+          result.p95_frame_completion_ms, result.late_video_frames);
+    }
+  }
+  LOG(INFO) << "Temporal layer evaluation:" << table;
 }
 
 NetworkSimulationModel DefaultModel() {
@@ -616,6 +981,16 @@ bool IsModelValid(const NetworkSimulationModel& model) {
   if (!model.has_type())
     return false;
   NetworkSimulationModelType type = model.type();
+  if (type == media::cast::proto::BUILT_IN_PROFILE)
+    return model.has_profile();
+  if (type == media::cast::proto::RANDOM_LOSS) {
+    if (!model.has_random_loss())
+      return false;
+    const RandomLossModel& random_loss = model.random_loss();
+    return random_loss.drop_fraction() >= 0.0 &&
+           random_loss.drop_fraction() < 1.0 &&
+           random_loss.one_way_delay_ms() >= 0;
+  }
   if (type == media::cast::proto::INTERRUPTED_POISSON_PROCESS) {
     if (!model.has_ipp())
       return false;
@@ -696,9 +1071,6 @@ int main(int argc, char** argv) {
       media::cast::kYuvOutputPath);
   std::string sim_id = cmd->GetSwitchValueASCII(media::cast::kSimulationId);
 
-  NetworkSimulationModel model = media::cast::LoadModel(
-      cmd->GetSwitchValuePath(media::cast::kModelPath));
-
   base::DictionaryValue values;
   values.SetBoolean("sim", true);
   values.SetString("sim-id", sim_id);
@@ -706,8 +1078,49 @@ int main(int argc, char** argv) {
   std::string extra_data;
   base::JSONWriter::Write(values, &extra_data);
 
+  if (cmd->HasSwitch(media::cast::kEvaluateCongestionControl)) {
+    media::cast::EvaluateCongestionControl(source_path, log_output_path,
+                                           extra_data);
+    return 0;
+  }
+  if (cmd->HasSwitch(media::cast::kEvaluateFec)) {
+    media::cast::EvaluateFec(source_path, log_output_path, extra_data);
+    return 0;
+  }
+  if (cmd->HasSwitch(media::cast::kEvaluateTemporalLayers)) {
+    media::cast::EvaluateTemporalLayers(source_path, log_output_path,
+                                        extra_data);
+    return 0;
+  }
+
+  const std::string congestion_control =
+      cmd->GetSwitchValueASCII(media::cast::kCongestionControl);
+  media::cast::SenderOptions sender_options;
+  if (congestion_control == "delay-based") {
+    sender_options.congestion_control_type =
+        media::cast::CongestionControlType::DELAY_BASED;
+  } else if (!congestion_control.empty() && congestion_control != "adaptive") {
+    LOG(ERROR) << "Unknown congestion control: " << congestion_control;
+    return 1;
+  }
+  sender_options.enable_fec = cmd->HasSwitch(media::cast::kFec);
+  const std::string scalability_mode =
+      cmd->GetSwitchValueASCII(media::cast::kScalabilityMode);
+  if (scalability_mode == "L1T2") {
+    sender_options.scalability_mode = media::SVCScalabilityMode::kL1T2;
+  } else if (scalability_mode == "L1T3") {
+    sender_options.scalability_mode = media::SVCScalabilityMode::kL1T3;
+  } else if (!scalability_mode.empty()) {
+    LOG(ERROR) << "Unsupported scalability mode: " << scalability_mode;
+    return 1;
+  }
+
+  NetworkSimulationModel model = media::cast::LoadModel(
+      cmd->GetSwitchValuePath(media::cast::kModelPath));
+
   // Run.
   media::cast::RunSimulation(source_path, log_output_path, metrics_output_path,
-                             yuv_output_path, extra_data, model);
+                             yuv_output_path, extra_data, model,
+                             sender_options);
   return 0;
 }
@@ -0,0 +1,208 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Decodes a binary cast event log, as written by BinaryEventLogWriter, and
+// prints the stats which StatsEventSubscriber computes from its events.
+//
+// Usage:
+//   cast_event_log_decoder --input=/tmp/cast_events.log
+//       [--proto-output=/tmp/cast_events]
+//
+// With --proto-output, the events are also aggregated by
+// EncodingEventSubscriber, and written to <prefix>.audio and <prefix>.video:
+// the proto::LogMetadata, then each proto::AggregatedFrameEvent, then each
+// proto::AggregatedPacketEvent, each message preceded by its size as a
+// big-endian 32-bit integer.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_file.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/values.h"
+#include "media/cast/logging/binary_event_log.h"
+#include "media/cast/logging/encoding_event_subscriber.h"
+#include "media/cast/logging/logging_defines.h"
+#include "media/cast/logging/proto/raw_events.pb.h"
+#include "media/cast/logging/receiver_time_offset_estimator_impl.h"
+#include "media/cast/logging/stats_event_subscriber.h"
+
+namespace media {
+namespace cast {
+
+namespace {
+
+const char kSwitchInput[] = "input";
+const char kSwitchProtoOutput[] = "proto-output";
+
+// Large enough to hold every frame of a long session.
+const size_t kMaxEncodedFrames = 1000000;
+
+// Passes the events of a log on to the subscribers which produce the outputs
+// of a live session, with the clock following the time of the events.
+class EventLogReplayer final : public RawEventSubscriber {
+ public:
+  EventLogReplayer()
+      : offset_estimator_(new ReceiverTimeOffsetEstimatorImpl()) {
+    for (EventMediaType media_type : {AUDIO_EVENT, VIDEO_EVENT}) {
+      stats_subscribers_.push_back(std::make_unique<StatsEventSubscriber>(
+          media_type, &clock_, offset_estimator_.get()));
+      encoding_subscribers_.push_back(
+          std::make_unique<EncodingEventSubscriber>(media_type,
+                                                    kMaxEncodedFrames));
+    }
+  }
+
+  EventLogReplayer(const EventLogReplayer&) = delete;
+  EventLogReplayer& operator=(const EventLogReplayer&) = delete;
+
+  ~EventLogReplayer() final = default;
+
+  void OnReceiveFrameEvent(const FrameEvent& frame_event) final {
+    AdvanceClockTo(frame_event.timestamp);
+    offset_estimator_->OnReceiveFrameEvent(frame_event);
+    for (const auto& subscriber : stats_subscribers_)
+      subscriber->OnReceiveFrameEvent(frame_event);
+    for (const auto& subscriber : encoding_subscribers_)
+      subscriber->OnReceiveFrameEvent(frame_event);
+  }
+
+  void OnReceivePacketEvent(const PacketEvent& packet_event) final {
+    AdvanceClockTo(packet_event.timestamp);
+    offset_estimator_->OnReceivePacketEvent(packet_event);
+    for (const auto& subscriber : stats_subscribers_)
+      subscriber->OnReceivePacketEvent(packet_event);
+    for (const auto& subscriber : encoding_subscribers_)
+      subscriber->OnReceivePacketEvent(packet_event);
+  }
+
+  void PrintStats() const {
+    for (const auto& subscriber : stats_subscribers_) {
+      std::string json;
+      base::JSONWriter::WriteWithOptions(
+          *subscriber->GetStats(), base::JSONWriter::OPTIONS_PRETTY_PRINT,
+          &json);
+      printf("%s\n", json.c_str());
+    }
+  }
+
+  bool WriteProtos(const base::FilePath& prefix) {
+    return WriteProtoFile(prefix.AddExtension(FILE_PATH_LITERAL("audio")),
+                          encoding_subscribers_[0].get()) &&
+           WriteProtoFile(prefix.AddExtension(FILE_PATH_LITERAL("video")),
+                          encoding_subscribers_[1].get());
+  }
+
+ private:
+  // The stats are computed over the time span of the log rather than the
+  // time of decoding, so their clock follows the events. Events are only
+  // roughly in order, so the clock never goes back.
+  void AdvanceClockTo(base::TimeTicks timestamp) {
+    if (!has_events_) {
+      has_events_ = true;
+      clock_.SetNowTicks(timestamp);
+      for (const auto& subscriber : stats_subscribers_)
+        subscriber->Reset();
+    } else if (timestamp > clock_.NowTicks()) {
+      clock_.SetNowTicks(timestamp);
+    }
+  }
+
+  static bool WriteMessage(FILE* file,
+                           const google::protobuf::MessageLite& message) {
+    const std::string serialized = message.SerializeAsString();
+    const uint32_t size = static_cast<uint32_t>(serialized.size());
+    const uint8_t size_bytes[] = {
+        static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16),
+        static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size)};
+    return fwrite(size_bytes, 1, sizeof(size_bytes), file) ==
+               sizeof(size_bytes) &&
+           fwrite(serialized.data(), 1, serialized.size(), file) ==
+               serialized.size();
+  }
+
+  static bool WriteProtoFile(const base::FilePath& path,
+                             EncodingEventSubscriber* subscriber) {
+    proto::LogMetadata metadata;
+    FrameEventList frame_events;
+    PacketEventList packet_events;
+    subscriber->GetEventsAndReset(&metadata, &frame_events, &packet_events);
+
+    base::ScopedFILE file(base::OpenFile(path, "wb"));
+    if (!file) {
+      LOG(ERROR) << "Failed to open " << path.value() << " for writing.";
+      return false;
+    }
+    bool success = WriteMessage(file.get(), metadata);
+    for (const auto& frame_event : frame_events)
+      success = success && WriteMessage(file.get(), *frame_event);
+    for (const auto& packet_event : packet_events)
+      success = success && WriteMessage(file.get(), *packet_event);
+    if (!success)
+      LOG(ERROR) << "Failed to write to " << path.value() << ".";
+    return success;
+  }
+
+  base::SimpleTestTickClock clock_;
+  bool has_events_ = false;
+  const std::unique_ptr<ReceiverTimeOffsetEstimatorImpl> offset_estimator_;
+  // By EventMediaType.
+  std::vector<std::unique_ptr<StatsEventSubscriber>> stats_subscribers_;
+  std::vector<std::unique_ptr<EncodingEventSubscriber>> encoding_subscribers_;
+};
+
+}  // namespace
+
+}  // namespace cast
+}  // namespace media
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  base::CommandLine::Init(argc, argv);
+  InitLogging(logging::LoggingSettings());
+
+  const base::CommandLine* cmd = base::CommandLine::ForCurrentProcess();
+  const base::FilePath input_path = cmd->GetSwitchValuePath(
+      media::cast::kSwitchInput);
+  if (input_path.empty()) {
+    fprintf(stderr, "Usage: %s --input=<event log> [--proto-output=<prefix>]\n",
+            argv[0]);
+    return 1;
+  }
+
+  std::string log;
+  if (!base::ReadFileToString(input_path, &log)) {
+    LOG(ERROR) << "Failed to read " << input_path.value() << ".";
+    return 1;
+  }
+
+  media::cast::EventLogReplayer replayer;
+  if (!media::cast::ReplayBinaryEventLog(
+          base::as_bytes(base::make_span(log)), &replayer)) {
+    // A log which was still being written to ends with a partial chunk, the
+    // events of which have still been replayed.
+    LOG(WARNING) << "The event log is truncated or malformed.";
+  }
+
+  replayer.PrintStats();
+
+  const base::FilePath proto_output_prefix = cmd->GetSwitchValuePath(
+      media::cast::kSwitchProtoOutput);
+  if (!proto_output_prefix.empty() &&
+      !replayer.WriteProtos(proto_output_prefix)) {
+    return 1;
+  }
+  return 0;
+}
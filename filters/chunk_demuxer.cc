@@ -21,6 +21,7 @@
 #include "media/base/bind_to_current_loop.h"
 #include "media/base/media_tracks.h"
 #include "media/base/mime_util.h"
+#include "media/base/pipeline_latency_profiler.h"
 #include "media/base/stream_parser_buffer.h"
 #include "media/base/timestamp_constants.h"
 #include "media/base/video_codecs.h"
@@ -917,6 +918,8 @@ bool ChunkDemuxer::AppendData(const std::string& id,
                               base::TimeDelta append_window_end,
                               base::TimeDelta* timestamp_offset) {
   DVLOG(1) << "AppendData(" << id << ", " << length << ")";
+  ScopedPipelineStageTimer stage_timer(DemuxerStream::UNKNOWN,
+                                       PipelineStage::kDemuxerParse);
 
   DCHECK(!id.empty());
   DCHECK(timestamp_offset);
@@ -979,6 +982,8 @@ bool ChunkDemuxer::AppendChunks(
   DCHECK(buffer_queue);
   DVLOG(1) << __func__ << ": " << id
            << ", buffer_queue size()=" << buffer_queue->size();
+  ScopedPipelineStageTimer stage_timer(DemuxerStream::UNKNOWN,
+                                       PipelineStage::kDemuxerParse);
 
   DCHECK(!id.empty());
   DCHECK(timestamp_offset);
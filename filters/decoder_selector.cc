@@ -32,6 +32,18 @@ namespace media {
 namespace {
 
 const char kSelectDecoderTrace[] = "DecoderSelector::SelectDecoder";
+const char kRankDecoderTrace[] = "DecoderSelector::RankDecoder";
+
+const char* GetDecoderPriorityName(DecoderPriority priority) {
+  switch (priority) {
+    case DecoderPriority::kNormal:
+      return "normal";
+    case DecoderPriority::kDeprioritized:
+      return "deprioritized";
+    case DecoderPriority::kSkipped:
+      return "skipped";
+  }
+}
 
 bool SkipDecoderForRTC(const AudioDecoderConfig& /*config*/,
                        const AudioDecoder& /*decoder*/) {
@@ -274,6 +286,13 @@ void DecoderSelector<StreamType>::OverrideDecoderPriorityCBForTesting(
   decoder_priority_cb_ = std::move(decoder_priority_cb);
 }
 
+template <DemuxerStream::Type StreamType>
+void DecoderSelector<StreamType>::SetDecoderScoreCB(
+    DecoderScoreCB decoder_score_cb) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  decoder_score_cb_ = std::move(decoder_score_cb);
+}
+
 template <DemuxerStream::Type StreamType>
 void DecoderSelector<StreamType>::CreateDecoders() {
   // Post-insert decoders returned by `create_decoders_cb_`, so that
@@ -428,8 +447,16 @@ void DecoderSelector<StreamType>::FilterAndSortAvailableDecoders() {
       continue;
 
     // Run the predicate on this decoder.
-    switch (decoder_priority_cb_.Run(config_, *decoder)) {
+    const DecoderPriority priority =
+        decoder_priority_cb_.Run(config_, *decoder);
+    switch (priority) {
       case DecoderPriority::kSkipped:
+        if (decoder_score_cb_) {
+          TRACE_EVENT_INSTANT2(
+              "media", kRankDecoderTrace, TRACE_EVENT_SCOPE_THREAD, "decoder",
+              GetDecoderName(decoder->GetDecoderType()), "priority",
+              GetDecoderPriorityName(priority));
+        }
         continue;
       case DecoderPriority::kNormal:
         decoders_.push_back(std::move(decoder));
@@ -440,11 +467,47 @@ void DecoderSelector<StreamType>::FilterAndSortAvailableDecoders() {
     }
   }
 
+  if (decoder_score_cb_) {
+    SortDecodersByScore(&decoders_, DecoderPriority::kNormal);
+    SortDecodersByScore(&deprioritized_decoders,
+                        DecoderPriority::kDeprioritized);
+  }
+
   // Post-insert deprioritized decoders
   std::move(deprioritized_decoders.begin(), deprioritized_decoders.end(),
             std::inserter(decoders_, decoders_.end()));
 }
 
+template <DemuxerStream::Type StreamType>
+void DecoderSelector<StreamType>::SortDecodersByScore(
+    std::vector<std::unique_ptr<Decoder>>* decoders,
+    DecoderPriority priority) {
+  DCHECK(decoder_score_cb_);
+
+  // Score each decoder once, since the callback may have to look up stats.
+  std::vector<std::pair<double, std::unique_ptr<Decoder>>> scored_decoders;
+  scored_decoders.reserve(decoders->size());
+  for (auto& decoder : *decoders) {
+    const double score = decoder_score_cb_.Run(config_, *decoder);
+    TRACE_EVENT_INSTANT3("media", kRankDecoderTrace, TRACE_EVENT_SCOPE_THREAD,
+                         "decoder", GetDecoderName(decoder->GetDecoderType()),
+                         "priority", GetDecoderPriorityName(priority), "score",
+                         score);
+    DVLOG(2) << __func__ << ": " << decoder->GetDecoderType()
+             << " priority=" << GetDecoderPriorityName(priority)
+             << " score=" << score;
+    scored_decoders.emplace_back(score, std::move(decoder));
+  }
+
+  std::stable_sort(
+      scored_decoders.begin(), scored_decoders.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  decoders->clear();
+  for (auto& scored_decoder : scored_decoders)
+    decoders->push_back(std::move(scored_decoder.second));
+}
+
 // These forward declarations tell the compiler that we will use
 // DecoderSelector with these arguments, allowing us to keep these definitions
 // in our .cc without causing linker errors. This also means if anyone tries to
@@ -67,6 +67,12 @@ class MEDIA_EXPORT DecoderSelector {
       base::RepeatingCallback<DecoderPriority(const DecoderConfig&,
                                               const Decoder&)>;
 
+  // Callback to score a decoder for a config. Decoders with higher scores are
+  // tried first among decoders of the same DecoderPriority; decoders with equal
+  // scores keep their relative order.
+  using DecoderScoreCB =
+      base::RepeatingCallback<double(const DecoderConfig&, const Decoder&)>;
+
   // Emits the result of a single call to SelectDecoder(). Parameters are
   //   1: The initialized Decoder. nullptr if selection failed.
   //   2: The initialized DecryptingDemuxerStream, if one was created. This
@@ -129,6 +135,11 @@ class MEDIA_EXPORT DecoderSelector {
   // Useful for writing tests in a platform-agnostic manner.
   void OverrideDecoderPriorityCBForTesting(DecoderPriorityCB priority_cb);
 
+  // Ranks decoders by |decoder_score_cb| in addition to their priority. Scores
+  // are evaluated whenever the list of decoders is sorted, so a config change
+  // that restarts selection ranks the decoders again for the new config.
+  void SetDecoderScoreCB(DecoderScoreCB decoder_score_cb);
+
  private:
   void CreateDecoders();
   void InitializeDecoder();
@@ -138,12 +149,15 @@ class MEDIA_EXPORT DecoderSelector {
   void OnDecryptingDemuxerStreamInitializeDone(PipelineStatus status);
   void RunSelectDecoderCB();
   void FilterAndSortAvailableDecoders();
+  void SortDecodersByScore(std::vector<std::unique_ptr<Decoder>>* decoders,
+                           DecoderPriority priority);
 
   scoped_refptr<base::SequencedTaskRunner> task_runner_;
   SEQUENCE_CHECKER(sequence_checker_);
 
   CreateDecodersCB create_decoders_cb_;
   DecoderPriorityCB decoder_priority_cb_;
+  DecoderScoreCB decoder_score_cb_;
   MediaLog* media_log_;
 
   StreamTraits* traits_ = nullptr;
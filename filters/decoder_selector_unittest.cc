@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <map>
 #include <memory>
 #include <tuple>
 
@@ -413,6 +414,20 @@ class DecoderSelectorTest : public ::testing::Test {
         base::BindRepeating(&Self::OnWaiting, base::Unretained(this)));
   }
 
+  // Scores the mock decoders by id, as stats recorded for each decoder would.
+  // Decoders without a score get 0.
+  void SetDecoderScores(std::map<int, double> scores) {
+    decoder_selector_->SetDecoderScoreCB(base::BindRepeating(
+        [](const std::map<int, double>& scores,
+           const typename Selector::DecoderConfig& /*config*/,
+           const Decoder& decoder) {
+          auto it = scores.find(
+              static_cast<const MockDecoder&>(decoder).GetDecoderId());
+          return it == scores.end() ? 0.0 : it->second;
+        },
+        std::move(scores)));
+  }
+
   void UseClearDecoderConfig() {
     TypeParam::UseNormalClearDecoderConfig(demuxer_stream_);
   }
@@ -621,6 +636,92 @@ TYPED_TEST(DecoderSelectorTest, ClearStream_SkipAllDecoders) {
   this->SelectDecoder();
 }
 
+// Tests that decoders are tried in order of their scores, and that decoders
+// with equal scores retain their relative order.
+TYPED_TEST(DecoderSelectorTest, ClearStream_DecoderScoresOrderDecoders) {
+  this->AddMockPlatformDecoder(kDecoder1, kAlwaysSucceed);
+  this->AddMockDecoder(kDecoder2, kAlwaysSucceed);
+  this->AddMockPlatformDecoder(kDecoder3, kAlwaysSucceed);
+  this->AddMockDecoder(kDecoder4, kAlwaysSucceed);
+
+  this->UseClearDecoderConfig();
+  this->CreateDecoderSelector();
+  this->decoder_selector_->OverrideDecoderPriorityCBForTesting(
+      base::BindRepeating(TypeParam::NormalDecoderPriorityCB));
+  this->SetDecoderScores({{kDecoder2, 0.5}, {kDecoder3, 0.9}});
+
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder3));
+  this->SelectDecoder();
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder2));
+  this->SelectDecoder();
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder1));
+  this->SelectDecoder();
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder4));
+  this->SelectDecoder();
+
+  EXPECT_CALL(*this, NoDecoderSelected());
+  this->SelectDecoder();
+}
+
+// Tests that scores only order decoders of the same priority.
+TYPED_TEST(DecoderSelectorTest, ClearStream_DecoderScoresRetainPriority) {
+  this->AddMockPlatformDecoder(kDecoder1, kAlwaysSucceed);
+  this->AddMockDecoder(kDecoder2, kAlwaysSucceed);
+  this->AddMockPlatformDecoder(kDecoder3, kAlwaysSucceed);
+  this->AddMockDecoder(kDecoder4, kAlwaysSucceed);
+
+  this->UseClearDecoderConfig();
+  this->CreateDecoderSelector();
+  this->decoder_selector_->OverrideDecoderPriorityCBForTesting(
+      base::BindRepeating(TypeParam::MockDecoderPriorityCB));
+  this->SetDecoderScores(
+      {{kDecoder2, 0.1}, {kDecoder3, 1.0}, {kDecoder4, 0.9}});
+
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder4));
+  this->SelectDecoder();
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder2));
+  this->SelectDecoder();
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder3));
+  this->SelectDecoder();
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder1));
+  this->SelectDecoder();
+
+  EXPECT_CALL(*this, NoDecoderSelected());
+  this->SelectDecoder();
+}
+
+// Tests that decoders are scored again for the new config after a config
+// change.
+TYPED_TEST(DecoderSelectorTest, ClearStream_DecoderScoresFollowConfigChange) {
+  this->AddMockPlatformDecoder(kDecoder1, kAlwaysSucceed);
+  this->AddMockDecoder(kDecoder2, kAlwaysSucceed);
+
+  this->UseClearDecoderConfig();
+  this->CreateDecoderSelector();
+  this->decoder_selector_->OverrideDecoderPriorityCBForTesting(
+      base::BindRepeating(TypeParam::NormalDecoderPriorityCB));
+
+  // Score decoders as the mock priority callback would rank them, so that
+  // platform decoders score higher only for high-quality configs.
+  this->decoder_selector_->SetDecoderScoreCB(base::BindRepeating(
+      [](const typename TestFixture::Selector::DecoderConfig& config,
+         const typename TestFixture::Decoder& decoder) {
+        return TypeParam::MockDecoderPriorityCB(config, decoder) ==
+                       DecoderPriority::kNormal
+                   ? 1.0
+                   : 0.0;
+      }));
+
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder2));
+  this->SelectDecoder();
+  this->decoder_selector_->FinalizeDecoderSelection();
+
+  this->UseHighQualityClearDecoderConfig();
+  this->decoder_selector_->NotifyConfigChanged();
+  EXPECT_CALL(*this, OnDecoderSelected(kDecoder1));
+  this->SelectDecoder();
+}
+
 TYPED_TEST(DecoderSelectorTest, ClearStream_ForceHardwareDecoders) {
   base::test::ScopedFeatureList features;
   features.InitAndEnableFeature(TypeParam::ForceHardwareDecodersFeature());
@@ -19,6 +19,7 @@
 #include "media/base/limits.h"
 #include "media/base/media_log.h"
 #include "media/base/media_switches.h"
+#include "media/base/pipeline_latency_profiler.h"
 #include "media/base/timestamp_constants.h"
 #include "media/base/video_decoder.h"
 #include "media/base/video_frame.h"
@@ -29,6 +30,13 @@ namespace media {
 #define FUNCTION_DVLOG(level) \
   DVLOG(level) << __func__ << "<" << GetStreamTypeString() << ">"
 
+// Returns the current time if the pipeline latency profiler is enabled, or a
+// null time otherwise, so that the clock is only read when profiling.
+static base::TimeTicks GetProfilerStartTime() {
+  return PipelineLatencyProfiler::IsEnabled() ? base::TimeTicks::Now()
+                                              : base::TimeTicks();
+}
+
 template <DemuxerStream::Type StreamType>
 static const char* GetDecodeTraceString();
 template <DemuxerStream::Type StreamType>
@@ -201,8 +209,14 @@ void DecoderStream<StreamType>::Read(ReadCB read_cb) {
 
   if (!ready_outputs_.empty()) {
     read_cb_ = BindToCurrentLoop(std::move(read_cb));
+    if (!ready_output_times_.front().is_null()) {
+      PipelineLatencyProfiler::GetInstance()->Record(
+          StreamType, PipelineStage::kReadyQueue,
+          base::TimeTicks::Now() - ready_output_times_.front());
+    }
     SatisfyRead(ready_outputs_.front());
     ready_outputs_.pop_front();
+    ready_output_times_.pop_front();
     MaybePrepareAnotherOutput();
   } else {
     read_cb_ = std::move(read_cb);
@@ -500,11 +514,12 @@ void DecoderStream<StreamType>::DecodeInternal(
   ++pending_decode_requests_;
 
   const int buffer_size = is_eos ? 0 : buffer->data_size();
+  const base::TimeTicks decode_start = GetProfilerStartTime();
   decoder_->Decode(
       std::move(buffer),
       base::BindOnce(&DecoderStream<StreamType>::OnDecodeDone,
                      fallback_weak_factory_.GetWeakPtr(), buffer_size,
-                     decoding_eos_, std::move(trace_event)));
+                     decoding_eos_, std::move(trace_event), decode_start));
 }
 
 template <DemuxerStream::Type StreamType>
@@ -519,6 +534,7 @@ void DecoderStream<StreamType>::OnDecodeDone(
     int buffer_size,
     bool end_of_stream,
     std::unique_ptr<ScopedDecodeTrace> trace_event,
+    base::TimeTicks decode_start,
     Status status) {
   FUNCTION_DVLOG(status.is_ok() ? 3 : 1) << ": " << status.code();
   DCHECK(state_ == STATE_NORMAL || state_ == STATE_FLUSHING_DECODER ||
@@ -530,6 +546,12 @@ void DecoderStream<StreamType>::OnDecodeDone(
   if (trace_event)
     trace_event->EndTrace(status);
 
+  if (!decode_start.is_null()) {
+    PipelineLatencyProfiler::GetInstance()->Record(
+        StreamType, PipelineStage::kDecode,
+        base::TimeTicks::Now() - decode_start);
+  }
+
   if (end_of_stream) {
     DCHECK(!pending_decode_requests_);
     decoding_eos_ = false;
@@ -658,6 +680,7 @@ void DecoderStream<StreamType>::OnDecodeOutputReady(
 
   // Store decoded output.
   ready_outputs_.push_back(std::move(output));
+  ready_output_times_.push_back(GetProfilerStartTime());
 }
 
 template <DemuxerStream::Type StreamType>
@@ -683,6 +706,7 @@ void DecoderStream<StreamType>::ReadFromDemuxerStream() {
   TRACE_EVENT_ASYNC_BEGIN0("media", GetDemuxerReadTraceString<StreamType>(),
                            this);
   pending_demuxer_read_ = true;
+  demuxer_read_start_ = GetProfilerStartTime();
   stream_->Read(base::BindOnce(&DecoderStream<StreamType>::OnBufferReady,
                                weak_factory_.GetWeakPtr()));
 }
@@ -706,6 +730,13 @@ void DecoderStream<StreamType>::OnBufferReady(
   DCHECK_EQ(buffer != nullptr, status == DemuxerStream::kOk) << status;
   pending_demuxer_read_ = false;
 
+  if (!demuxer_read_start_.is_null()) {
+    PipelineLatencyProfiler::GetInstance()->Record(
+        StreamType, PipelineStage::kDemuxerRead,
+        base::TimeTicks::Now() - demuxer_read_start_);
+    demuxer_read_start_ = base::TimeTicks();
+  }
+
   // If parallel decode requests are supported, multiple read requests might
   // have been sent to the demuxer. The buffers might arrive while the decoder
   // is reinitializing after falling back on first decode error.
@@ -935,6 +966,7 @@ void DecoderStream<StreamType>::ClearOutputs() {
   if (preparing_output_)
     CompletePrepare(nullptr);
   ready_outputs_.clear();
+  ready_output_times_.clear();
   unprepared_outputs_.clear();
   prepare_weak_factory_.InvalidateWeakPtrs();
 }
@@ -986,10 +1018,12 @@ void DecoderStream<StreamType>::OnPreparedOutputReady(
   traits_->OnOutputReady(output.get());
   CompletePrepare(output.get());
   unprepared_outputs_.pop_front();
-  if (!read_cb_)
+  if (!read_cb_) {
     ready_outputs_.emplace_back(std::move(output));
-  else
+    ready_output_times_.push_back(GetProfilerStartTime());
+  } else {
     SatisfyRead(std::move(output));
+  }
 
   MaybePrepareAnotherOutput();
 
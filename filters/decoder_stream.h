@@ -133,6 +133,13 @@ class MEDIA_EXPORT DecoderStream {
     decoder_change_observer_cb_ = std::move(decoder_change_observer_cb);
   }
 
+  // Allows ranking of candidate decoders, e.g. by their recorded performance.
+  // See DecoderSelector::SetDecoderScoreCB().
+  void set_decoder_score_cb(
+      typename DecoderSelector<StreamType>::DecoderScoreCB decoder_score_cb) {
+    decoder_selector_.SetDecoderScoreCB(std::move(decoder_score_cb));
+  }
+
   int get_pending_buffers_size_for_testing() const {
     return pending_buffers_.size();
   }
@@ -198,6 +205,7 @@ class MEDIA_EXPORT DecoderStream {
   void OnDecodeDone(int buffer_size,
                     bool end_of_stream,
                     std::unique_ptr<ScopedDecodeTrace> trace_event,
+                    base::TimeTicks decode_start,
                     media::Status status);
 
   // Output callback passed to Decoder::Initialize().
@@ -271,6 +279,10 @@ class MEDIA_EXPORT DecoderStream {
   base::circular_deque<scoped_refptr<Output>> unprepared_outputs_;
   base::circular_deque<scoped_refptr<Output>> ready_outputs_;
 
+  // When each of |ready_outputs_| was queued, or null times if the profiler
+  // was disabled then.
+  base::circular_deque<base::TimeTicks> ready_output_times_;
+
   // Number of outstanding decode requests sent to the |decoder_|.
   int pending_decode_requests_;
 
@@ -294,6 +306,9 @@ class MEDIA_EXPORT DecoderStream {
   // overwritten in many cases.
   bool pending_demuxer_read_;
 
+  // When the pending demuxer read started, if it is being profiled.
+  base::TimeTicks demuxer_read_start_;
+
   // Timestamp after which all outputs need to be prepared.
   base::TimeDelta skip_prepare_until_timestamp_;
 
@@ -0,0 +1,80 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/filters/video_decoder_scorer.h"
+
+#include "base/bind.h"
+#include "base/cxx17_backports.h"
+#include "media/base/bucket_utility.h"
+
+namespace media {
+
+// static
+constexpr uint64_t VideoDecoderScorer::kMinFramesForScore;
+constexpr double VideoDecoderScorer::kUnknownScore;
+constexpr double VideoDecoderScorer::kPowerEfficientWeight;
+constexpr double VideoDecoderScorer::kSoftwareLoadPenalty;
+
+VideoDecoderScorer::VideoDecoderScorer() = default;
+
+VideoDecoderScorer::~VideoDecoderScorer() = default;
+
+void VideoDecoderScorer::AppendStats(VideoDecoderType decoder_type,
+                                     const VideoDecoderConfig& config,
+                                     const DecodeStats& stats) {
+  StatsKey key;
+  if (!GetStatsKey(decoder_type, config, &key))
+    return;
+
+  base::AutoLock auto_lock(lock_);
+  DecodeStats& entry = stats_[key];
+  entry.frames_decoded += stats.frames_decoded;
+  entry.frames_dropped += stats.frames_dropped;
+  entry.frames_power_efficient += stats.frames_power_efficient;
+}
+
+void VideoDecoderScorer::SetSystemLoad(double load) {
+  base::AutoLock auto_lock(lock_);
+  system_load_ = base::clamp(load, 0.0, 1.0);
+}
+
+double VideoDecoderScorer::Score(const VideoDecoderConfig& config,
+                                 const VideoDecoder& decoder) const {
+  StatsKey key;
+  if (!GetStatsKey(decoder.GetDecoderType(), config, &key))
+    return kUnknownScore;
+
+  base::AutoLock auto_lock(lock_);
+  auto it = stats_.find(key);
+  if (it == stats_.end() || it->second.frames_decoded < kMinFramesForScore)
+    return kUnknownScore;
+
+  const DecodeStats& stats = it->second;
+  const double frames_decoded = stats.frames_decoded;
+  double score = 1.0 - stats.frames_dropped / frames_decoded;
+  score +=
+      kPowerEfficientWeight * stats.frames_power_efficient / frames_decoded;
+  if (!decoder.IsPlatformDecoder())
+    score -= kSoftwareLoadPenalty * system_load_;
+  return score;
+}
+
+VideoDecoderSelector::DecoderScoreCB VideoDecoderScorer::GetDecoderScoreCB() {
+  return base::BindRepeating(&VideoDecoderScorer::Score,
+                             base::WrapRefCounted(this));
+}
+
+// static
+bool VideoDecoderScorer::GetStatsKey(VideoDecoderType decoder_type,
+                                     const VideoDecoderConfig& config,
+                                     StatsKey* key) {
+  const gfx::Size size = GetSizeBucket(config.natural_size());
+  if (size.IsEmpty())
+    return false;
+
+  *key = StatsKey(decoder_type, config.profile(), size.width(), size.height());
+  return true;
+}
+
+}  // namespace media
@@ -0,0 +1,98 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_FILTERS_VIDEO_DECODER_SCORER_H_
+#define MEDIA_FILTERS_VIDEO_DECODER_SCORER_H_
+
+#include <stdint.h>
+
+#include <tuple>
+
+#include "base/containers/flat_map.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "media/base/media_export.h"
+#include "media/base/video_codecs.h"
+#include "media/base/video_decoder.h"
+#include "media/base/video_decoder_config.h"
+#include "media/filters/decoder_selector.h"
+
+namespace media {
+
+// Scores video decoders for VideoDecoderSelector from the decode stats
+// recorded for each decoder type, in the same config buckets (profile and
+// bucketed size) that VideoDecodeStatsDB uses, and from the current system
+// load.  Decoders that played a bucket smoothly are tried before decoders
+// with no stats for it, and decoders that dropped frames are tried after
+// them.  Without any stats the decoder order is unchanged.
+//
+// Shared by all of the decoder streams in a process, so that stats recorded
+// by one playback rank the decoders of the next.
+class MEDIA_EXPORT VideoDecoderScorer
+    : public base::RefCountedThreadSafe<VideoDecoderScorer> {
+ public:
+  // Decoders need at least this many decoded frames in a bucket to be scored.
+  static constexpr uint64_t kMinFramesForScore = 300;
+
+  // Score of decoders without enough stats. Equal to the score of a decoder
+  // that drops 5% of its frames, the most VideoDecodePerfHistory considers
+  // smooth by default.
+  static constexpr double kUnknownScore = 0.95;
+
+  // Added to the score in proportion to the fraction of frames that were
+  // decoded power efficiently, to break ties between smooth decoders.
+  static constexpr double kPowerEfficientWeight = 0.05;
+
+  // Subtracted from the score of scored non-platform decoders in proportion
+  // to the system load, since software decoding competes for the CPU.
+  static constexpr double kSoftwareLoadPenalty = 0.1;
+
+  // Frame counts of one or more playbacks, as in PipelineStatistics.
+  struct DecodeStats {
+    uint64_t frames_decoded = 0;
+    uint64_t frames_dropped = 0;
+    uint64_t frames_power_efficient = 0;
+  };
+
+  VideoDecoderScorer();
+  VideoDecoderScorer(const VideoDecoderScorer&) = delete;
+  VideoDecoderScorer& operator=(const VideoDecoderScorer&) = delete;
+
+  // Adds |stats| for playback of |config| by a decoder of |decoder_type|.
+  void AppendStats(VideoDecoderType decoder_type,
+                   const VideoDecoderConfig& config,
+                   const DecodeStats& stats);
+
+  // Sets the current system load, from 0 (idle) to 1 (fully loaded).
+  void SetSystemLoad(double load);
+
+  // Returns the score of |decoder| for |config|. Higher is better.
+  double Score(const VideoDecoderConfig& config,
+               const VideoDecoder& decoder) const;
+
+  // Returns a callback for VideoDecoderSelector::SetDecoderScoreCB() that
+  // keeps this scorer alive.
+  VideoDecoderSelector::DecoderScoreCB GetDecoderScoreCB();
+
+ private:
+  friend class base::RefCountedThreadSafe<VideoDecoderScorer>;
+  ~VideoDecoderScorer();
+
+  // Decoder type, profile, and bucketed width and height.
+  using StatsKey = std::tuple<VideoDecoderType, VideoCodecProfile, int, int>;
+
+  // Returns false if |config| is too small to be bucketed.
+  static bool GetStatsKey(VideoDecoderType decoder_type,
+                          const VideoDecoderConfig& config,
+                          StatsKey* key);
+
+  mutable base::Lock lock_;
+  base::flat_map<StatsKey, DecodeStats> stats_ GUARDED_BY(lock_);
+  double system_load_ GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_FILTERS_VIDEO_DECODER_SCORER_H_
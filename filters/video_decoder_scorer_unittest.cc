@@ -0,0 +1,112 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/filters/video_decoder_scorer.h"
+
+#include "base/memory/scoped_refptr.h"
+#include "media/base/mock_filters.h"
+#include "media/base/test_helpers.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+namespace {
+
+// A mock decoder that reports a real decoder type, so that it can be scored.
+class TypedMockVideoDecoder : public MockVideoDecoder {
+ public:
+  TypedMockVideoDecoder(VideoDecoderType decoder_type, bool is_platform_decoder)
+      : MockVideoDecoder(is_platform_decoder, false, 0),
+        decoder_type_(decoder_type) {}
+
+  VideoDecoderType GetDecoderType() const override { return decoder_type_; }
+
+ private:
+  const VideoDecoderType decoder_type_;
+};
+
+using DecodeStats = VideoDecoderScorer::DecodeStats;
+
+}  // namespace
+
+class VideoDecoderScorerTest : public ::testing::Test {
+ public:
+  VideoDecoderScorerTest()
+      : scorer_(base::MakeRefCounted<VideoDecoderScorer>()),
+        hw_decoder_(VideoDecoderType::kMojo, true),
+        vpx_decoder_(VideoDecoderType::kVpx, false),
+        ffmpeg_decoder_(VideoDecoderType::kFFmpeg, false) {}
+
+ protected:
+  scoped_refptr<VideoDecoderScorer> scorer_;
+  TypedMockVideoDecoder hw_decoder_;
+  TypedMockVideoDecoder vpx_decoder_;
+  TypedMockVideoDecoder ffmpeg_decoder_;
+};
+
+TEST_F(VideoDecoderScorerTest, DecodersWithoutStatsAreUnknown) {
+  const VideoDecoderConfig config = TestVideoConfig::Normal();
+  EXPECT_EQ(scorer_->Score(config, hw_decoder_),
+            VideoDecoderScorer::kUnknownScore);
+  EXPECT_EQ(scorer_->Score(config, vpx_decoder_),
+            VideoDecoderScorer::kUnknownScore);
+
+  // Too few frames to be scored.
+  scorer_->AppendStats(VideoDecoderType::kVpx, config, DecodeStats{100, 0, 0});
+  EXPECT_EQ(scorer_->Score(config, vpx_decoder_),
+            VideoDecoderScorer::kUnknownScore);
+}
+
+TEST_F(VideoDecoderScorerTest, ScoresBySmoothnessAndPowerEfficiency) {
+  const VideoDecoderConfig config = TestVideoConfig::Normal();
+  scorer_->AppendStats(VideoDecoderType::kMojo, config,
+                       DecodeStats{1000, 0, 1000});
+  scorer_->AppendStats(VideoDecoderType::kVpx, config, DecodeStats{1000, 0, 0});
+  scorer_->AppendStats(VideoDecoderType::kFFmpeg, config,
+                       DecodeStats{1000, 200, 0});
+
+  const double hw_score = scorer_->Score(config, hw_decoder_);
+  const double vpx_score = scorer_->Score(config, vpx_decoder_);
+  const double ffmpeg_score = scorer_->Score(config, ffmpeg_decoder_);
+
+  // Power efficiency breaks the tie between the smooth decoders, and the
+  // decoder that drops frames ranks below decoders without stats.
+  EXPECT_GT(hw_score, vpx_score);
+  EXPECT_GT(vpx_score, VideoDecoderScorer::kUnknownScore);
+  EXPECT_LT(ffmpeg_score, VideoDecoderScorer::kUnknownScore);
+}
+
+TEST_F(VideoDecoderScorerTest, AppendsStats) {
+  const VideoDecoderConfig config = TestVideoConfig::Normal();
+  scorer_->AppendStats(VideoDecoderType::kVpx, config, DecodeStats{200, 0, 0});
+  scorer_->AppendStats(VideoDecoderType::kVpx, config,
+                       DecodeStats{200, 100, 0});
+  EXPECT_DOUBLE_EQ(scorer_->Score(config, vpx_decoder_), 0.75);
+}
+
+TEST_F(VideoDecoderScorerTest, StatsAreBucketedByConfig) {
+  scorer_->AppendStats(VideoDecoderType::kVpx, TestVideoConfig::Normal(),
+                       DecodeStats{1000, 500, 0});
+  EXPECT_EQ(scorer_->Score(TestVideoConfig::Large(), vpx_decoder_),
+            VideoDecoderScorer::kUnknownScore);
+  EXPECT_EQ(scorer_->Score(TestVideoConfig::NormalH264(), vpx_decoder_),
+            VideoDecoderScorer::kUnknownScore);
+  EXPECT_LT(scorer_->Score(TestVideoConfig::Normal(), vpx_decoder_),
+            VideoDecoderScorer::kUnknownScore);
+}
+
+TEST_F(VideoDecoderScorerTest, SystemLoadPenalizesSoftwareDecoders) {
+  const VideoDecoderConfig config = TestVideoConfig::Normal();
+  scorer_->AppendStats(VideoDecoderType::kMojo, config,
+                       DecodeStats{1000, 10, 0});
+  scorer_->AppendStats(VideoDecoderType::kVpx, config, DecodeStats{1000, 0, 0});
+  EXPECT_GT(scorer_->Score(config, vpx_decoder_),
+            scorer_->Score(config, hw_decoder_));
+
+  scorer_->SetSystemLoad(1.0);
+  EXPECT_LT(scorer_->Score(config, vpx_decoder_),
+            scorer_->Score(config, hw_decoder_));
+}
+
+}  // namespace media
@@ -412,9 +412,11 @@ void VideoRendererAlgorithm::EnqueueFrame(scoped_refptr<VideoFrame> frame) {
 
   // Project the current cadence calculations to include the new frame.  These
   // may not be accurate until the next Render() call.  These updates are done
-  // to ensure EffectiveFramesQueued() returns a semi-reliable result.
+  // to ensure EffectiveFramesQueued() returns a semi-reliable result. Frames
+  // before the new one keep their position in the cadence sequence, so only
+  // the new frame and those after it need to be updated.
   if (cadence_estimator_.has_cadence())
-    UpdateCadenceForFrames();
+    UpdateCadenceForFrames(new_frame_index);
 
   UpdateEffectiveFramesQueued();
 #ifndef NDEBUG
@@ -466,8 +468,8 @@ void VideoRendererAlgorithm::UpdateFrameStatistics() {
   DCHECK(!frame_queue_.empty());
 
   // Figure out all current ready frame times at once.
-  std::vector<base::TimeDelta> media_timestamps;
-  media_timestamps.reserve(frame_queue_.size());
+  std::vector<base::TimeDelta>& media_timestamps = media_timestamps_;
+  media_timestamps.clear();
   for (const auto& ready_frame : frame_queue_)
     media_timestamps.push_back(ready_frame.frame->timestamp());
 
@@ -489,7 +491,8 @@ void VideoRendererAlgorithm::UpdateFrameStatistics() {
     }
   }
 
-  std::vector<base::TimeTicks> wall_clock_times;
+  std::vector<base::TimeTicks>& wall_clock_times = wall_clock_times_;
+  wall_clock_times.clear();
   was_time_moving_ =
       wall_clock_time_cb_.Run(media_timestamps, &wall_clock_times);
   DCHECK_EQ(wall_clock_times.size(),
@@ -580,8 +583,8 @@ void VideoRendererAlgorithm::UpdateFrameStatistics() {
   UpdateCadenceForFrames();
 }
 
-void VideoRendererAlgorithm::UpdateCadenceForFrames() {
-  for (size_t i = 0; i < frame_queue_.size(); ++i) {
+void VideoRendererAlgorithm::UpdateCadenceForFrames(size_t start_index) {
+  for (size_t i = start_index; i < frame_queue_.size(); ++i) {
     // It's always okay to adjust the ideal render count, since the cadence
     // selection method will still count its current render count towards
     // cadence selection.
@@ -626,9 +629,13 @@ int VideoRendererAlgorithm::FindBestFrameByCoverage(
   // deadline_max]. Frames outside of the interval are considered to have no
   // coverage, while those which completely overlap the interval have complete
   // coverage.
+  //
+  // The best and second best frames are tracked in a single pass; on ties the
+  // earliest frame wins in both cases.
   int best_frame_by_coverage = -1;
   base::TimeDelta best_coverage;
-  std::vector<base::TimeDelta> coverage(frame_queue_.size(), base::TimeDelta());
+  *second_best = -1;
+  base::TimeDelta second_best_coverage;
   for (size_t i = 0; i < frame_queue_.size(); ++i) {
     const ReadyFrame& frame = frame_queue_[i];
 
@@ -648,23 +655,22 @@ int VideoRendererAlgorithm::FindBestFrameByCoverage(
     const base::TimeDelta duration =
         end_time - std::max(deadline_min, frame.start_time);
 
-    coverage[i] = duration;
-    if (coverage[i] > best_coverage) {
+    if (duration > best_coverage) {
+      // The previous best is always earlier than any tied second best, so it
+      // takes over as second best on ties.
+      if (best_frame_by_coverage >= 0 &&
+          best_coverage >= second_best_coverage) {
+        *second_best = best_frame_by_coverage;
+        second_best_coverage = best_coverage;
+      }
       best_frame_by_coverage = i;
-      best_coverage = coverage[i];
+      best_coverage = duration;
+    } else if (duration > second_best_coverage) {
+      *second_best = i;
+      second_best_coverage = duration;
     }
   }
 
-  // Find the second best frame by coverage; done by zeroing the coverage for
-  // the previous best and recomputing the maximum.
-  *second_best = -1;
-  if (best_frame_by_coverage >= 0) {
-    coverage[best_frame_by_coverage] = base::TimeDelta();
-    auto it = std::max_element(coverage.begin(), coverage.end());
-    if (it->is_positive())
-      *second_best = it - coverage.begin();
-  }
-
   // If two frames have coverage within half a millisecond, prefer the earliest
   // frame as having the best coverage.  Value chosen via experimentation to
   // ensure proper coverage calculation for 24fps in 60Hz where +/- 100us of
@@ -672,7 +678,7 @@ int VideoRendererAlgorithm::FindBestFrameByCoverage(
   // an allowed jitter of 3%.
   const base::TimeDelta kAllowableJitter = base::Microseconds(500);
   if (*second_best >= 0 && best_frame_by_coverage > *second_best &&
-      (best_coverage - coverage[*second_best]).magnitude() <=
+      (best_coverage - second_best_coverage).magnitude() <=
           kAllowableJitter) {
     std::swap(best_frame_by_coverage, *second_best);
   }
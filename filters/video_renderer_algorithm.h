@@ -8,6 +8,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <vector>
+
 #include "base/callback.h"
 #include "base/containers/circular_deque.h"
 #include "base/macros.h"
@@ -228,10 +230,11 @@ class MEDIA_EXPORT VideoRendererAlgorithm {
   // playback rate changes occur though).
   void UpdateFrameStatistics();
 
-  // Updates the ideal render count for all frames in |frame_queue_| based on
-  // the cadence returned by |cadence_estimator_|.  Cadence is assigned based
-  // on |frame_counter_|.
-  void UpdateCadenceForFrames();
+  // Updates the ideal render count for all frames in |frame_queue_| starting at
+  // |start_index| based on the cadence returned by |cadence_estimator_|.
+  // Cadence is assigned based on |frame_counter_|. Frames before |start_index|
+  // must already have up to date ideal render counts.
+  void UpdateCadenceForFrames(size_t start_index = 0);
 
   // If |cadence_estimator_| has detected a valid cadence, attempts to find the
   // next frame which should be rendered.  Returns -1 if not enough frames are
@@ -349,6 +352,11 @@ class MEDIA_EXPORT VideoRendererAlgorithm {
   // Current number of effective frames in the |frame_queue_|.  Updated by calls
   // to UpdateEffectiveFramesQueued() whenever the |frame_queue_| is changed.
   size_t effective_frames_queued_;
+
+  // Scratch storage for UpdateFrameStatistics(), kept around to avoid
+  // allocating on every Render() call.
+  std::vector<base::TimeDelta> media_timestamps_;
+  std::vector<base::TimeTicks> wall_clock_times_;
 };
 
 }  // namespace media
@@ -0,0 +1,101 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <tuple>
+
+#include "base/bind.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/time/time.h"
+#include "media/base/media_util.h"
+#include "media/base/video_frame_pool.h"
+#include "media/base/wall_clock_time_source.h"
+#include "media/filters/video_renderer_algorithm.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+
+namespace {
+
+constexpr int kRenderIterations = 100000;
+constexpr double kFrameRate = 60;
+
+}  // namespace
+
+// Measures the cost of VideoRendererAlgorithm::Render() when driven by a high
+// refresh rate display with a deep queue of decoded frames; Render() runs on
+// the compositor thread for every vsync of every visible video.
+class VideoRendererAlgorithmPerfTest
+    : public testing::TestWithParam<std::tuple<double, size_t>> {
+ public:
+  VideoRendererAlgorithmPerfTest()
+      : algorithm_(base::BindRepeating(&WallClockTimeSource::GetWallClockTimes,
+                                       base::Unretained(&time_source_)),
+                   &media_log_) {
+    // Null TimeTicks have special meaning to the algorithm.
+    tick_clock_.Advance(base::Milliseconds(10));
+    time_source_.SetTickClockForTesting(&tick_clock_);
+  }
+
+  VideoRendererAlgorithmPerfTest(const VideoRendererAlgorithmPerfTest&) =
+      delete;
+  VideoRendererAlgorithmPerfTest& operator=(
+      const VideoRendererAlgorithmPerfTest&) = delete;
+
+  void EnqueueNextFrame() {
+    const gfx::Size size(8, 8);
+    algorithm_.EnqueueFrame(frame_pool_.CreateFrame(
+        PIXEL_FORMAT_I420, size, gfx::Rect(size), size,
+        base::Seconds(next_frame_index_++ / kFrameRate)));
+  }
+
+ protected:
+  base::SimpleTestTickClock tick_clock_;
+  WallClockTimeSource time_source_;
+  NullMediaLog media_log_;
+  VideoFramePool frame_pool_;
+  VideoRendererAlgorithm algorithm_;
+  int next_frame_index_ = 0;
+};
+
+TEST_P(VideoRendererAlgorithmPerfTest, Render) {
+  const double display_rate = std::get<0>(GetParam());
+  const size_t queue_depth = std::get<1>(GetParam());
+  const base::TimeDelta render_interval = base::Seconds(1.0 / display_rate);
+
+  for (size_t i = 0; i < queue_depth; ++i)
+    EnqueueNextFrame();
+  time_source_.StartTicking();
+
+  size_t frames_dropped = 0;
+  base::TimeTicks deadline_min = tick_clock_.NowTicks();
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kRenderIterations; ++i) {
+    algorithm_.Render(deadline_min, deadline_min + render_interval,
+                      &frames_dropped);
+    deadline_min += render_interval;
+    tick_clock_.Advance(render_interval);
+
+    // Keep the queue topped up like VideoRendererImpl would.
+    while (algorithm_.frames_queued() < queue_depth)
+      EnqueueNextFrame();
+  }
+  const double elapsed = (base::TimeTicks::Now() - start).InSecondsF();
+
+  perf_test::PerfResultReporter reporter(
+      "video_renderer_algorithm",
+      base::StringPrintf("%dhz_queue_%zu", static_cast<int>(display_rate),
+                         queue_depth));
+  reporter.RegisterImportantMetric("_render", "runs/s");
+  reporter.AddResult("_render", kRenderIterations / elapsed);
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         VideoRendererAlgorithmPerfTest,
+                         testing::Combine(testing::Values(120.0, 144.0, 240.0),
+                                          testing::Values(4u, 16u, 64u)));
+
+}  // namespace media
@@ -128,6 +128,14 @@ struct COMPONENT_EXPORT(LEARNING_COMMON) LearningTask {
   // Number of trees in the random forest.
   size_t rf_number_of_trees = 100;
 
+  // Fraction of the trees that are replaced, by trees trained on the current
+  // data, each time the model is retrained.  The rest are kept from the
+  // previous model.  With 1, every retrain builds the whole forest from
+  // scratch.  Lower values spread the cost of training over retrains, at the
+  // price of adapting to new examples more slowly.  Not used with
+  // |use_one_hot_conversion|, since the conversion changes with the data.
+  double rf_replacement_fraction = 1.0;
+
   // Should ExtraTrees apply one-hot conversion automatically?  RandomTree has
   // been modified to support nominals directly, though it isn't exactly the
   // same as one-hot conversion.  It is, however, much faster.
@@ -0,0 +1,179 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/learning/impl/columnar_training_data.h"
+
+#include <algorithm>
+
+#include "base/check_op.h"
+
+namespace media {
+namespace learning {
+
+namespace {
+
+// Replaces |values| by their indices in the sorted list of distinct values,
+// which is returned in |dictionary|.
+void Intern(std::vector<double> values,
+            std::vector<Value>* dictionary,
+            std::vector<ColumnarTrainingData::ValueIndex>* indices) {
+  std::vector<double> distinct_values = values;
+  std::sort(distinct_values.begin(), distinct_values.end());
+  distinct_values.erase(
+      std::unique(distinct_values.begin(), distinct_values.end()),
+      distinct_values.end());
+
+  dictionary->reserve(distinct_values.size());
+  for (double value : distinct_values)
+    dictionary->push_back(Value(value));
+
+  indices->reserve(values.size());
+  for (double value : values) {
+    indices->push_back(
+        std::lower_bound(distinct_values.begin(), distinct_values.end(),
+                         value) -
+        distinct_values.begin());
+  }
+}
+
+std::vector<bool> GetNumericFeatures(const LearningTask& task) {
+  std::vector<bool> numeric_features;
+  for (const auto& description : task.feature_descriptions) {
+    numeric_features.push_back(description.ordering ==
+                               LearningTask::Ordering::kNumeric);
+  }
+  return numeric_features;
+}
+
+}  // namespace
+
+ColumnarTrainingData::Column::Column() = default;
+
+ColumnarTrainingData::Column::Column(const Column& rhs) = default;
+
+ColumnarTrainingData::Column::Column(Column&& rhs) = default;
+
+ColumnarTrainingData::Column::~Column() = default;
+
+ColumnarTrainingData::Column& ColumnarTrainingData::Column::operator=(
+    const Column& rhs) = default;
+
+ColumnarTrainingData::Column& ColumnarTrainingData::Column::operator=(
+    Column&& rhs) = default;
+
+ColumnarTrainingData::ColumnarTrainingData(const LearningTask& task,
+                                           const TrainingData& training_data)
+    : ColumnarTrainingData(training_data, GetNumericFeatures(task)) {}
+
+ColumnarTrainingData::ColumnarTrainingData(const TrainingData& training_data)
+    : ColumnarTrainingData(
+          training_data,
+          std::vector<bool>(training_data.size()
+                                ? training_data[0].features.size()
+                                : 0,
+                            false)) {}
+
+ColumnarTrainingData::ColumnarTrainingData(
+    const TrainingData& training_data,
+    const std::vector<bool>& numeric_features) {
+  const size_t num_examples = training_data.size();
+
+  // Copy one feature at a time, so that we write to one column at a time.
+  columns_.resize(numeric_features.size());
+  for (size_t f = 0; f < columns_.size(); f++) {
+    std::vector<double> values;
+    values.reserve(num_examples);
+    for (const LabelledExample& example : training_data) {
+      DCHECK_EQ(example.features.size(), columns_.size());
+      values.push_back(example.features[f].value());
+    }
+
+    Column& column = columns_[f];
+    column.is_numeric = numeric_features[f];
+    if (column.is_numeric)
+      column.numeric_values = std::move(values);
+    else
+      Intern(std::move(values), &column.dictionary, &column.indices);
+  }
+
+  std::vector<double> targets;
+  targets.reserve(num_examples);
+  weights_.reserve(num_examples);
+  for (const LabelledExample& example : training_data) {
+    targets.push_back(example.target_value.value());
+    weights_.push_back(example.weight);
+  }
+  Intern(std::move(targets), &target_values_, &targets_);
+}
+
+ColumnarTrainingData::ColumnarTrainingData(const ColumnarTrainingData& rhs) =
+    default;
+
+ColumnarTrainingData::ColumnarTrainingData(ColumnarTrainingData&& rhs) =
+    default;
+
+ColumnarTrainingData& ColumnarTrainingData::operator=(
+    const ColumnarTrainingData& rhs) = default;
+
+ColumnarTrainingData& ColumnarTrainingData::operator=(
+    ColumnarTrainingData&& rhs) = default;
+
+ColumnarTrainingData::~ColumnarTrainingData() = default;
+
+FeatureValue ColumnarTrainingData::GetFeature(size_t example,
+                                              size_t feature) const {
+  const Column& column = columns_[feature];
+  if (column.is_numeric)
+    return FeatureValue(column.numeric_values[example]);
+  return column.dictionary[column.indices[example]];
+}
+
+FeatureVector ColumnarTrainingData::GetFeatures(size_t example) const {
+  FeatureVector features;
+  features.reserve(columns_.size());
+  for (size_t f = 0; f < columns_.size(); f++)
+    features.push_back(GetFeature(example, f));
+  return features;
+}
+
+TargetHistogram ColumnarTrainingData::GetTargetHistogram(
+    const std::vector<size_t>& training_idx) const {
+  std::vector<double> counts(target_values_.size());
+  for (size_t idx : training_idx)
+    counts[targets_[idx]] += weights_[idx];
+
+  TargetHistogram histogram;
+  for (size_t i = 0; i < counts.size(); i++) {
+    if (counts[i])
+      histogram[target_values_[i]] = counts[i];
+  }
+  return histogram;
+}
+
+bool ColumnarTrainingData::FeaturesLess(size_t a, size_t b) const {
+  for (const Column& column : columns_) {
+    if (column.is_numeric) {
+      if (column.numeric_values[a] != column.numeric_values[b])
+        return column.numeric_values[a] < column.numeric_values[b];
+    } else if (column.indices[a] != column.indices[b]) {
+      return column.indices[a] < column.indices[b];
+    }
+  }
+  return false;
+}
+
+bool ColumnarTrainingData::FeaturesEqual(size_t a, size_t b) const {
+  for (const Column& column : columns_) {
+    if (column.is_numeric) {
+      if (column.numeric_values[a] != column.numeric_values[b])
+        return false;
+    } else if (column.indices[a] != column.indices[b]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace learning
+}  // namespace media
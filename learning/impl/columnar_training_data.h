@@ -0,0 +1,139 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_LEARNING_IMPL_COLUMNAR_TRAINING_DATA_H_
+#define MEDIA_LEARNING_IMPL_COLUMNAR_TRAINING_DATA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/component_export.h"
+#include "media/learning/common/labelled_example.h"
+#include "media/learning/common/learning_task.h"
+#include "media/learning/common/target_histogram.h"
+#include "media/learning/common/value.h"
+
+namespace media {
+namespace learning {
+
+// TrainingData stored by feature rather than by example, for trainers that
+// scan one feature over many examples at a time.
+//
+// Each numeric feature is a contiguous column of doubles.  Each nominal
+// feature is a column of indices into a dictionary of its distinct values.
+// The dictionary is sorted, so comparing indices is the same as comparing the
+// values; a nominal split only needs to compare integers.  Targets are
+// interned the same way, so that they can be counted in a plain array.
+//
+// Every example must have the same number of features.
+class COMPONENT_EXPORT(LEARNING_IMPL) ColumnarTrainingData {
+ public:
+  // Index of a value in a dictionary.
+  using ValueIndex = uint32_t;
+
+  // Stores |training_data|, with numeric columns for the features that |task|
+  // describes as kNumeric.
+  ColumnarTrainingData(const LearningTask& task,
+                       const TrainingData& training_data);
+
+  // Stores |training_data| with every feature interned, for trainers that
+  // only care whether feature values are equal.
+  explicit ColumnarTrainingData(const TrainingData& training_data);
+
+  ColumnarTrainingData(const ColumnarTrainingData& rhs);
+  ColumnarTrainingData(ColumnarTrainingData&& rhs);
+
+  ColumnarTrainingData& operator=(const ColumnarTrainingData& rhs);
+  ColumnarTrainingData& operator=(ColumnarTrainingData&& rhs);
+
+  ~ColumnarTrainingData();
+
+  // Number of examples.
+  size_t size() const { return weights_.size(); }
+  bool empty() const { return weights_.empty(); }
+
+  size_t num_features() const { return columns_.size(); }
+
+  bool is_numeric(size_t feature) const {
+    return columns_[feature].is_numeric;
+  }
+
+  // Values of the numeric |feature|, in example order.
+  const std::vector<double>& numeric_column(size_t feature) const {
+    return columns_[feature].numeric_values;
+  }
+
+  // Values of the nominal |feature|, in example order, as indices into
+  // dictionary(feature).
+  const std::vector<ValueIndex>& nominal_column(size_t feature) const {
+    return columns_[feature].indices;
+  }
+
+  // Distinct values of the nominal |feature|, in increasing order.
+  const std::vector<FeatureValue>& dictionary(size_t feature) const {
+    return columns_[feature].dictionary;
+  }
+
+  // Targets, in example order, as indices into target_values().
+  const std::vector<ValueIndex>& targets() const { return targets_; }
+
+  // Distinct target values, in increasing order.
+  const std::vector<TargetValue>& target_values() const {
+    return target_values_;
+  }
+
+  // Example weights, in example order.
+  const std::vector<double>& weights() const { return weights_; }
+
+  // Returns the |feature|-th feature of the |example|-th example.
+  FeatureValue GetFeature(size_t example, size_t feature) const;
+
+  // Returns all features of the |example|-th example.
+  FeatureVector GetFeatures(size_t example) const;
+
+  // Returns the weighted distribution of the targets of |training_idx|.
+  TargetHistogram GetTargetHistogram(
+      const std::vector<size_t>& training_idx) const;
+
+  // Compare the features of two examples, in the same order as FeatureVector.
+  bool FeaturesLess(size_t a, size_t b) const;
+  bool FeaturesEqual(size_t a, size_t b) const;
+
+ private:
+  struct Column {
+    Column();
+    Column(const Column& rhs);
+    Column(Column&& rhs);
+    ~Column();
+
+    Column& operator=(const Column& rhs);
+    Column& operator=(Column&& rhs);
+
+    bool is_numeric = false;
+
+    // For numeric columns.
+    std::vector<double> numeric_values;
+
+    // For nominal columns.
+    std::vector<ValueIndex> indices;
+    std::vector<FeatureValue> dictionary;
+  };
+
+  ColumnarTrainingData(const TrainingData& training_data,
+                       const std::vector<bool>& numeric_features);
+
+  std::vector<Column> columns_;
+  std::vector<ValueIndex> targets_;
+  std::vector<TargetValue> target_values_;
+  std::vector<double> weights_;
+
+  // Copy / assignment is allowed.
+};
+
+}  // namespace learning
+}  // namespace media
+
+#endif  // MEDIA_LEARNING_IMPL_COLUMNAR_TRAINING_DATA_H_
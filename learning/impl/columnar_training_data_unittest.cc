@@ -0,0 +1,136 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/learning/impl/columnar_training_data.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+namespace learning {
+
+class ColumnarTrainingDataTest : public testing::Test {
+ public:
+  ColumnarTrainingDataTest() {
+    LearningTask::ValueDescription nominal;
+    nominal.ordering = LearningTask::Ordering::kUnordered;
+    LearningTask::ValueDescription numeric;
+    numeric.ordering = LearningTask::Ordering::kNumeric;
+    task_.feature_descriptions.push_back(nominal);
+    task_.feature_descriptions.push_back(numeric);
+  }
+
+  LearningTask task_;
+};
+
+TEST_F(ColumnarTrainingDataTest, EmptyTrainingDataWorks) {
+  ColumnarTrainingData data(task_, TrainingData());
+  EXPECT_TRUE(data.empty());
+  EXPECT_EQ(data.size(), 0u);
+  EXPECT_EQ(data.num_features(), 2u);
+  EXPECT_TRUE(data.dictionary(0).empty());
+  EXPECT_TRUE(data.numeric_column(1).empty());
+  EXPECT_TRUE(data.target_values().empty());
+}
+
+TEST_F(ColumnarTrainingDataTest, ColumnsMatchExamples) {
+  TrainingData training_data;
+  training_data.push_back(
+      LabelledExample({FeatureValue("b"), FeatureValue(1.5)}, TargetValue(2)));
+  training_data.push_back(
+      LabelledExample({FeatureValue("a"), FeatureValue(-3)}, TargetValue(1)));
+  LabelledExample weighted({FeatureValue("b"), FeatureValue(7)},
+                           TargetValue(2));
+  weighted.weight = 5;
+  training_data.push_back(weighted);
+
+  ColumnarTrainingData data(task_, training_data);
+  ASSERT_EQ(data.size(), training_data.size());
+  EXPECT_FALSE(data.is_numeric(0));
+  EXPECT_TRUE(data.is_numeric(1));
+
+  // The nominal feature should be interned, with the dictionary in order.
+  ASSERT_EQ(data.dictionary(0).size(), 2u);
+  EXPECT_LT(data.dictionary(0)[0], data.dictionary(0)[1]);
+  EXPECT_EQ(data.nominal_column(0)[0], data.nominal_column(0)[2]);
+  EXPECT_NE(data.nominal_column(0)[0], data.nominal_column(0)[1]);
+
+  EXPECT_EQ(data.numeric_column(1), std::vector<double>({1.5, -3, 7}));
+  EXPECT_EQ(data.target_values(),
+            std::vector<TargetValue>({TargetValue(1), TargetValue(2)}));
+  EXPECT_EQ(data.targets(),
+            std::vector<ColumnarTrainingData::ValueIndex>({1, 0, 1}));
+  EXPECT_EQ(data.weights(), std::vector<double>({1, 1, 5}));
+
+  for (size_t i = 0; i < training_data.size(); i++)
+    EXPECT_EQ(data.GetFeatures(i), training_data[i].features);
+}
+
+TEST_F(ColumnarTrainingDataTest, TargetHistogramIsWeighted) {
+  TrainingData training_data;
+  LabelledExample example_1({FeatureValue(1), FeatureValue(1)},
+                            TargetValue(1));
+  example_1.weight = 3;
+  training_data.push_back(example_1);
+  training_data.push_back(
+      LabelledExample({FeatureValue(1), FeatureValue(2)}, TargetValue(2)));
+  training_data.push_back(
+      LabelledExample({FeatureValue(1), FeatureValue(3)}, TargetValue(1)));
+
+  ColumnarTrainingData data(task_, training_data);
+  TargetHistogram histogram = data.GetTargetHistogram({0, 2});
+  EXPECT_EQ(histogram.size(), 1u);
+  EXPECT_EQ(histogram[TargetValue(1)], 4);
+
+  histogram = data.GetTargetHistogram({0, 1, 2});
+  EXPECT_EQ(histogram.size(), 2u);
+  EXPECT_EQ(histogram[TargetValue(1)], 4);
+  EXPECT_EQ(histogram[TargetValue(2)], 1);
+}
+
+TEST_F(ColumnarTrainingDataTest, ComparisonsMatchFeatureVector) {
+  TrainingData training_data;
+  training_data.push_back(
+      LabelledExample({FeatureValue(2), FeatureValue(1)}, TargetValue(1)));
+  training_data.push_back(
+      LabelledExample({FeatureValue(1), FeatureValue(5)}, TargetValue(1)));
+  training_data.push_back(
+      LabelledExample({FeatureValue(2), FeatureValue(0)}, TargetValue(1)));
+  training_data.push_back(
+      LabelledExample({FeatureValue(1), FeatureValue(5)}, TargetValue(2)));
+
+  // With numeric columns, and with every feature interned.
+  for (const ColumnarTrainingData& data :
+       {ColumnarTrainingData(task_, training_data),
+        ColumnarTrainingData(training_data)}) {
+    for (size_t a = 0; a < training_data.size(); a++) {
+      for (size_t b = 0; b < training_data.size(); b++) {
+        EXPECT_EQ(data.FeaturesLess(a, b),
+                  training_data[a].features < training_data[b].features);
+        EXPECT_EQ(data.FeaturesEqual(a, b),
+                  training_data[a].features == training_data[b].features);
+      }
+    }
+  }
+}
+
+TEST_F(ColumnarTrainingDataTest, InterningEveryFeatureWorks) {
+  TrainingData training_data;
+  training_data.push_back(
+      LabelledExample({FeatureValue(3), FeatureValue(1.5)}, TargetValue(1)));
+  training_data.push_back(
+      LabelledExample({FeatureValue(1), FeatureValue(1.5)}, TargetValue(1)));
+
+  ColumnarTrainingData data(training_data);
+  EXPECT_EQ(data.num_features(), 2u);
+  EXPECT_FALSE(data.is_numeric(0));
+  EXPECT_FALSE(data.is_numeric(1));
+  EXPECT_EQ(data.dictionary(0),
+            std::vector<FeatureValue>({FeatureValue(1), FeatureValue(3)}));
+  EXPECT_EQ(data.dictionary(1), std::vector<FeatureValue>({FeatureValue(1.5)}));
+  for (size_t i = 0; i < training_data.size(); i++)
+    EXPECT_EQ(data.GetFeatures(i), training_data[i].features);
+}
+
+}  // namespace learning
+}  // namespace media
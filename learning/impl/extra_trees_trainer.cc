@@ -4,10 +4,14 @@
 
 #include "media/learning/impl/extra_trees_trainer.h"
 
+#include <algorithm>
+#include <cmath>
 #include <set>
 
 #include "base/bind.h"
 #include "base/check_op.h"
+#include "base/task/thread_pool.h"
+#include "media/learning/impl/flat_tree_ensemble.h"
 #include "media/learning/impl/voting_ensemble.h"
 
 namespace media {
@@ -21,58 +25,142 @@ void ExtraTreesTrainer::Train(const LearningTask& task,
                               const TrainingData& training_data,
                               TrainedModelCB model_cb) {
   // Make sure that there is no training in progress.
-  DCHECK_EQ(trees_.size(), 0u);
+  DCHECK(!model_cb_);
+  DCHECK_EQ(num_pending_trees_, 0u);
   DCHECK_EQ(converter_.get(), nullptr);
 
   task_ = task;
-  trees_.reserve(task.rf_number_of_trees);
+  model_cb_ = std::move(model_cb);
+
+  // Keep the trees of the last model only if they were trained for the same
+  // forest.  One-hot conversion depends on the data, so trees trained on
+  // converted data can't be mixed with new ones.
+  const bool incremental = task.rf_replacement_fraction < 1.0 &&
+                           !task.use_one_hot_conversion &&
+                           trees_.size() == task.rf_number_of_trees;
+  size_t num_trees_to_train = task.rf_number_of_trees;
+  if (incremental) {
+    const size_t num_to_replace = static_cast<size_t>(
+        std::ceil(task.rf_replacement_fraction * trees_.size()));
+    num_trees_to_train =
+        std::min(trees_.size(), std::max<size_t>(1, num_to_replace));
+  } else {
+    trees_.clear();
+    trees_.resize(task.rf_number_of_trees);
+    next_tree_to_replace_ = 0;
+  }
+
+  // Converting the data takes time in the number of examples and features,
+  // so do that on the thread pool too.  |training_data| is copied since the
+  // caller keeps changing its own.
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE,
+      {base::TaskPriority::BEST_EFFORT,
+       base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+      base::BindOnce(&ExtraTreesTrainer::PrepareTrainingData, task_,
+                     training_data),
+      base::BindOnce(&ExtraTreesTrainer::OnTrainingDataPrepared, AsWeakPtr(),
+                     num_trees_to_train));
+}
+
+ExtraTreesTrainer::PreparedTrainingData::PreparedTrainingData() = default;
+
+ExtraTreesTrainer::PreparedTrainingData::PreparedTrainingData(
+    PreparedTrainingData&& rhs) = default;
 
-  // Instantiate our tree trainer if we haven't already.  We do this now only
-  // so that we can send it our rng, mostly for tests.
-  // TODO(liberato): We should always take the rng in the ctor, rather than
-  // via SetRngForTesting.  Then we can do this earlier.
-  if (!tree_trainer_)
-    tree_trainer_ = std::make_unique<RandomTreeTrainer>(rng());
+ExtraTreesTrainer::PreparedTrainingData::~PreparedTrainingData() = default;
 
+// static
+ExtraTreesTrainer::PreparedTrainingData ExtraTreesTrainer::PrepareTrainingData(
+    LearningTask task,
+    TrainingData training_data) {
   // We've modified RandomTree to handle nominals, so we don't need to do one-
   // hot conversion normally.  It's slow.  However, the changes to RandomTree
   // are only approximately the same thing.
-  if (task_.use_one_hot_conversion) {
-    converter_ = std::make_unique<OneHotConverter>(task, training_data);
-    converted_training_data_ = converter_->Convert(training_data);
-    task_ = converter_->converted_task();
+  //
+  // Either way, store the data by column once, and share it between trees.
+  PreparedTrainingData prepared;
+  if (task.use_one_hot_conversion) {
+    prepared.converter = std::make_unique<OneHotConverter>(task, training_data);
+    prepared.data = base::MakeRefCounted<SharedTrainingData>(
+        ColumnarTrainingData(prepared.converter->converted_task(),
+                             prepared.converter->Convert(training_data)));
   } else {
-    converted_training_data_ = training_data;
+    prepared.data = base::MakeRefCounted<SharedTrainingData>(
+        ColumnarTrainingData(task, training_data));
+  }
+  return prepared;
+}
+
+void ExtraTreesTrainer::OnTrainingDataPrepared(size_t num_trees_to_train,
+                                               PreparedTrainingData prepared) {
+  converter_ = std::move(prepared.converter);
+  if (converter_)
+    task_ = converter_->converted_task();
+
+  if (num_trees_to_train == 0) {
+    FinishTraining();
+    return;
+  }
+
+  // Draw all the seeds here, so that the trees don't depend on the order in
+  // which the thread pool runs them.
+  num_pending_trees_ = num_trees_to_train;
+  for (size_t i = 0; i < num_trees_to_train; i++) {
+    const size_t index = next_tree_to_replace_;
+    next_tree_to_replace_ = (next_tree_to_replace_ + 1) % trees_.size();
+    trees_[index].reset();
+    base::ThreadPool::PostTaskAndReplyWithResult(
+        FROM_HERE,
+        {base::TaskPriority::BEST_EFFORT,
+         base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+        base::BindOnce(&ExtraTreesTrainer::TrainTree, task_, prepared.data,
+                       rng()->Generate()),
+        base::BindOnce(&ExtraTreesTrainer::OnRandomTreeModel, AsWeakPtr(),
+                       index));
   }
+}
 
-  // Start training.  Send in nullptr to start the process.
-  OnRandomTreeModel(std::move(model_cb), nullptr);
+// static
+std::unique_ptr<Model> ExtraTreesTrainer::TrainTree(
+    LearningTask task,
+    scoped_refptr<SharedTrainingData> training_data,
+    uint64_t seed) {
+  SeededRandomNumberGenerator rng(seed);
+  RandomTreeTrainer tree_trainer(&rng);
+  return tree_trainer.TrainTree(task, training_data->data);
 }
 
-void ExtraTreesTrainer::OnRandomTreeModel(TrainedModelCB model_cb,
+void ExtraTreesTrainer::OnRandomTreeModel(size_t index,
                                           std::unique_ptr<Model> model) {
-  // Allow a null Model to make it easy to start training.
-  if (model)
-    trees_.push_back(std::move(model));
-
-  // If this is the last tree, then return the finished model.
-  if (trees_.size() == task_.rf_number_of_trees) {
-    std::unique_ptr<Model> finished_model =
-        std::make_unique<VotingEnsemble>(std::move(trees_));
-    // If we have a converter, then wrap everything in a ConvertingModel.
-    if (converter_) {
-      finished_model = std::make_unique<ConvertingModel>(
-          std::move(converter_), std::move(finished_model));
-    }
-
-    std::move(model_cb).Run(std::move(finished_model));
-    return;
+  DCHECK_GT(num_pending_trees_, 0u);
+  trees_[index] = std::move(model);
+  if (--num_pending_trees_ == 0)
+    FinishTraining();
+}
+
+void ExtraTreesTrainer::FinishTraining() {
+  // Compile the trees for faster prediction.  That works for any trees that
+  // RandomTreeTrainer builds, but fall back to voting otherwise.  Voting
+  // takes the trees, so they can't be kept for the next round.
+  std::unique_ptr<Model> finished_model = FlatTreeEnsemble::Compile(trees_);
+  if (!finished_model) {
+    finished_model = std::make_unique<VotingEnsemble>(std::move(trees_));
+    trees_.clear();
   }
 
-  // Train the next tree.
-  auto cb = base::BindOnce(&ExtraTreesTrainer::OnRandomTreeModel, AsWeakPtr(),
-                           std::move(model_cb));
-  tree_trainer_->Train(task_, converted_training_data_, std::move(cb));
+  // If we have a converter, then wrap everything in a ConvertingModel.
+  if (converter_) {
+    finished_model = std::make_unique<ConvertingModel>(
+        std::move(converter_), std::move(finished_model));
+    trees_.clear();
+  }
+
+  // Don't hold on to trees that will never be reused.
+  if (task_.rf_replacement_fraction >= 1.0)
+    trees_.clear();
+
+  std::move(model_cb_).Run(std::move(finished_model));
 }
 
 }  // namespace learning
@@ -5,13 +5,18 @@
 #ifndef MEDIA_LEARNING_IMPL_EXTRA_TREES_TRAINER_H_
 #define MEDIA_LEARNING_IMPL_EXTRA_TREES_TRAINER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <memory>
 #include <vector>
 
 #include "base/component_export.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "media/learning/common/learning_task.h"
+#include "media/learning/impl/columnar_training_data.h"
 #include "media/learning/impl/one_hot.h"
 #include "media/learning/impl/random_number_generator.h"
 #include "media/learning/impl/random_tree_trainer.h"
@@ -28,6 +33,16 @@ namespace learning {
 // chosen.  The feature with the best randomly chosen split point is used.
 //
 // These will automatically convert nominal values to one-hot vectors.
+//
+// The training data is converted to columns, and to one-hot vectors if
+// needed, on the thread pool, and then the trees are trained in parallel on
+// the thread pool too.  Each gets its own
+// SeededRandomNumberGenerator, seeded from rng() before any of them start, so
+// the result doesn't depend on the order in which they finish.
+//
+// If LearningTask::rf_replacement_fraction is less than one, then the trees
+// are kept between calls to Train(), and only that fraction of them, oldest
+// first, is replaced by trees trained on the new data.
 class COMPONENT_EXPORT(LEARNING_IMPL) ExtraTreesTrainer
     : public TrainingAlgorithm,
       public HasRandomNumberGenerator,
@@ -46,15 +61,51 @@ class COMPONENT_EXPORT(LEARNING_IMPL) ExtraTreesTrainer
              TrainedModelCB model_cb) override;
 
  private:
-  void OnRandomTreeModel(TrainedModelCB model_cb, std::unique_ptr<Model> model);
+  using SharedTrainingData = base::RefCountedData<ColumnarTrainingData>;
+
+  // Training data converted for the trees, and the converter that was used,
+  // if any.
+  struct PreparedTrainingData {
+    PreparedTrainingData();
+    PreparedTrainingData(PreparedTrainingData&& rhs);
+    ~PreparedTrainingData();
+
+    std::unique_ptr<OneHotConverter> converter;
+    scoped_refptr<SharedTrainingData> data;
+  };
+
+  // Converts |training_data| on a thread pool thread.
+  static PreparedTrainingData PrepareTrainingData(LearningTask task,
+                                                  TrainingData training_data);
+
+  // Starts training |num_trees_to_train| trees on |prepared|.
+  void OnTrainingDataPrepared(size_t num_trees_to_train,
+                              PreparedTrainingData prepared);
 
-  std::unique_ptr<TrainingAlgorithm> tree_trainer_;
+  // Trains one tree on a thread pool thread.
+  static std::unique_ptr<Model> TrainTree(
+      LearningTask task,
+      scoped_refptr<SharedTrainingData> training_data,
+      uint64_t seed);
+
+  // Called with the tree that was trained for |trees_[index]|.
+  void OnRandomTreeModel(size_t index, std::unique_ptr<Model> model);
+
+  // Sends the finished model to |model_cb_|.
+  void FinishTraining();
 
   // In-flight training.
   LearningTask task_;
-  std::vector<std::unique_ptr<Model>> trees_;
   std::unique_ptr<OneHotConverter> converter_;
-  TrainingData converted_training_data_;
+  TrainedModelCB model_cb_;
+  size_t num_pending_trees_ = 0;
+
+  // Trees of the current model, which are kept between calls to Train() for
+  // incremental retraining.  Slots that are being retrained are null.
+  std::vector<std::unique_ptr<Model>> trees_;
+
+  // Index of the oldest tree in |trees_|, which is the next to be replaced.
+  size_t next_tree_to_replace_ = 0;
 };
 
 }  // namespace learning
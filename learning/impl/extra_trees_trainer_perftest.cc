@@ -0,0 +1,123 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/process/process_metrics.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "media/learning/impl/extra_trees_trainer.h"
+#include "media/learning/impl/test_random_number_generator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+namespace learning {
+
+namespace {
+
+// Size of the example window, as for a LearningTaskController with the
+// default LearningTask.
+constexpr size_t kNumExamples = 1000;
+
+// Number of features of each example.
+constexpr size_t kNumFeatures = 16;
+
+// Number of times the model is retrained in each measurement.
+constexpr size_t kNumRetrains = 10;
+
+}  // namespace
+
+class ExtraTreesTrainerPerfTest : public testing::Test {
+ public:
+  ExtraTreesTrainerPerfTest() : rng_(0) {
+    trainer_.SetRandomNumberGeneratorForTesting(&rng_);
+    for (size_t i = 0; i < kNumFeatures; i++) {
+      LearningTask::ValueDescription desc;
+      desc.ordering = LearningTask::Ordering::kNumeric;
+      task_.feature_descriptions.push_back(desc);
+    }
+  }
+
+ protected:
+  // Returns a window of uniformly random features, with a target that depends
+  // on a few of them plus some noise.
+  TrainingData MakeTrainingData() {
+    TrainingData data;
+    for (size_t i = 0; i < kNumExamples; i++) {
+      FeatureVector features;
+      for (size_t f = 0; f < kNumFeatures; f++)
+        features.push_back(FeatureValue(rng_.GenerateDouble(1.0)));
+      const double score = features[0].value() + features[1].value() -
+                           features[2].value() + rng_.GenerateDouble(0.5);
+      data.push_back(
+          LabelledExample(std::move(features), TargetValue(score > 0.75)));
+    }
+    return data;
+  }
+
+  void Train(const TrainingData& data) {
+    std::unique_ptr<Model> model;
+    trainer_.Train(
+        task_, data,
+        base::BindOnce(
+            [](std::unique_ptr<Model>* model_out,
+               std::unique_ptr<Model> model) { *model_out = std::move(model); },
+            &model));
+    task_environment_.RunUntilIdle();
+    ASSERT_TRUE(model);
+  }
+
+  // Trains an initial model, then reports the wall and CPU time per retrain
+  // with |replacement_fraction| of the trees replaced each time.
+  void RunRetrainingTest(const std::string& story,
+                         double replacement_fraction) {
+    task_.rf_replacement_fraction = replacement_fraction;
+    Train(MakeTrainingData());
+
+    // Generating data isn't part of the measurement.
+    std::vector<TrainingData> windows;
+    for (size_t i = 0; i < kNumRetrains; i++)
+      windows.push_back(MakeTrainingData());
+
+    std::unique_ptr<base::ProcessMetrics> process_metrics =
+        base::ProcessMetrics::CreateCurrentProcessMetrics();
+    const base::TimeDelta start_cpu = process_metrics->GetCumulativeCPUUsage();
+    const base::TimeTicks start = base::TimeTicks::Now();
+    for (const TrainingData& window : windows)
+      Train(window);
+    const base::TimeDelta wall_time = base::TimeTicks::Now() - start;
+    const base::TimeDelta cpu_time =
+        process_metrics->GetCumulativeCPUUsage() - start_cpu;
+
+    perf_test::PerfResultReporter reporter("extra_trees_trainer", story);
+    reporter.RegisterImportantMetric("_wall_time_per_retrain", "ms");
+    reporter.RegisterImportantMetric("_cpu_time_per_retrain", "ms");
+    reporter.AddResult("_wall_time_per_retrain",
+                       wall_time.InMillisecondsF() / kNumRetrains);
+    reporter.AddResult("_cpu_time_per_retrain",
+                       cpu_time.InMillisecondsF() / kNumRetrains);
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  TestRandomNumberGenerator rng_;
+  ExtraTreesTrainer trainer_;
+  LearningTask task_;
+};
+
+TEST_F(ExtraTreesTrainerPerfTest, FullRetraining) {
+  RunRetrainingTest("full", 1.0);
+}
+
+TEST_F(ExtraTreesTrainerPerfTest, IncrementalRetraining) {
+  RunRetrainingTest("incremental_10_percent", 0.1);
+}
+
+}  // namespace learning
+}  // namespace media
@@ -31,8 +31,14 @@ class ExtraTreesTest : public testing::TestWithParam<LearningTask::Ordering> {
 
   std::unique_ptr<Model> Train(const LearningTask& task,
                                const TrainingData& data) {
+    return TrainWith(&trainer_, task, data);
+  }
+
+  std::unique_ptr<Model> TrainWith(ExtraTreesTrainer* trainer,
+                                   const LearningTask& task,
+                                   const TrainingData& data) {
     std::unique_ptr<Model> model;
-    trainer_.Train(
+    trainer->Train(
         task_, data,
         base::BindOnce(
             [](std::unique_ptr<Model>* model_out,
@@ -200,6 +206,81 @@ TEST_P(ExtraTreesTest, RegressionVsBinaryClassification) {
   }
 }
 
+TEST_P(ExtraTreesTest, SameSeedGivesSameModel) {
+  // Trees finish in whatever order the thread pool runs them, but a trainer
+  // with an rng in the same state should still build the same forest.
+  SetupFeatures(4);
+  task_.rf_number_of_trees = 10;
+  FisherIrisDataset iris;
+  TrainingData training_data = iris.GetTrainingData();
+  auto model = Train(task_, training_data);
+
+  TestRandomNumberGenerator other_rng(0);
+  ExtraTreesTrainer other_trainer;
+  other_trainer.SetRandomNumberGeneratorForTesting(&other_rng);
+  auto other_model = TrainWith(&other_trainer, task_, training_data);
+
+  for (const LabelledExample& example : training_data) {
+    FeatureVector perturbed = example.features;
+    for (FeatureValue& value : perturbed)
+      value = FeatureValue(value.value() + 0.05);
+    EXPECT_EQ(model->PredictDistribution(example.features),
+              other_model->PredictDistribution(example.features));
+    EXPECT_EQ(model->PredictDistribution(perturbed),
+              other_model->PredictDistribution(perturbed));
+  }
+}
+
+TEST_P(ExtraTreesTest, IncrementalRetrainingReplacesSomeTrees) {
+  SetupFeatures(1);
+  task_.rf_number_of_trees = 8;
+  task_.rf_replacement_fraction = 0.25;
+  const FeatureVector features({FeatureValue(123)});
+  TrainingData data_1;
+  data_1.push_back(LabelledExample(features, TargetValue(1)));
+  TrainingData data_2;
+  data_2.push_back(LabelledExample(features, TargetValue(2)));
+
+  // Every tree votes once, for the only target in the data it was trained on.
+  auto model = Train(task_, data_1);
+  TargetHistogram distribution = model->PredictDistribution(features);
+  EXPECT_EQ(distribution[TargetValue(1)], 8);
+
+  // Each retrain should replace two trees, and keep the rest.
+  model = Train(task_, data_2);
+  distribution = model->PredictDistribution(features);
+  EXPECT_EQ(distribution[TargetValue(1)], 6);
+  EXPECT_EQ(distribution[TargetValue(2)], 2);
+
+  model = Train(task_, data_2);
+  distribution = model->PredictDistribution(features);
+  EXPECT_EQ(distribution[TargetValue(1)], 4);
+  EXPECT_EQ(distribution[TargetValue(2)], 4);
+
+  // Changing the number of trees should start over.
+  task_.rf_number_of_trees = 4;
+  model = Train(task_, data_2);
+  distribution = model->PredictDistribution(features);
+  EXPECT_EQ(distribution[TargetValue(1)], 0);
+  EXPECT_EQ(distribution[TargetValue(2)], 4);
+}
+
+TEST_P(ExtraTreesTest, FullRetrainingReplacesAllTrees) {
+  SetupFeatures(1);
+  task_.rf_number_of_trees = 8;
+  const FeatureVector features({FeatureValue(123)});
+  TrainingData data_1;
+  data_1.push_back(LabelledExample(features, TargetValue(1)));
+  TrainingData data_2;
+  data_2.push_back(LabelledExample(features, TargetValue(2)));
+
+  Train(task_, data_1);
+  auto model = Train(task_, data_2);
+  TargetHistogram distribution = model->PredictDistribution(features);
+  EXPECT_EQ(distribution[TargetValue(1)], 0);
+  EXPECT_EQ(distribution[TargetValue(2)], 8);
+}
+
 INSTANTIATE_TEST_SUITE_P(ExtraTreesTest,
                          ExtraTreesTest,
                          testing::ValuesIn({LearningTask::Ordering::kUnordered,
@@ -0,0 +1,138 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/learning/impl/flat_tree_ensemble.h"
+
+#include "base/check_op.h"
+
+namespace media {
+namespace learning {
+
+// static
+std::unique_ptr<FlatTreeEnsemble> FlatTreeEnsemble::Compile(
+    const std::vector<std::unique_ptr<Model>>& trees) {
+  // Can't use make_unique with a private constructor.
+  std::unique_ptr<FlatTreeEnsemble> ensemble(new FlatTreeEnsemble());
+  ensemble->tree_roots_.reserve(trees.size());
+  for (const auto& tree : trees) {
+    const int root = tree->AddToFlatTreeEnsemble(ensemble.get());
+    if (root < 0)
+      return nullptr;
+    ensemble->tree_roots_.push_back(root);
+  }
+
+  // The lookup is only needed while adding leaves.
+  ensemble->target_indices_.clear();
+  return ensemble;
+}
+
+FlatTreeEnsemble::FlatTreeEnsemble() {
+  leaf_begin_.push_back(0);
+}
+
+FlatTreeEnsemble::~FlatTreeEnsemble() = default;
+
+int FlatTreeEnsemble::AddLeafNode(const TargetHistogram& distribution) {
+  const int leaf = static_cast<int>(leaf_begin_.size()) - 1;
+  for (const auto& entry : distribution) {
+    auto result = target_indices_.emplace(entry.first, target_values_.size());
+    if (result.second)
+      target_values_.push_back(entry.first);
+    leaf_targets_.push_back(result.first->second);
+    leaf_counts_.push_back(entry.second);
+  }
+  leaf_begin_.push_back(leaf_targets_.size());
+
+  feature_index_.push_back(kLeaf);
+  split_point_.push_back(0);
+  is_numeric_.push_back(false);
+  children_.push_back(leaf);
+  children_.push_back(kNoChild);
+  return static_cast<int>(feature_index_.size()) - 1;
+}
+
+int FlatTreeEnsemble::AddInteriorNode(int feature_index,
+                                      LearningTask::Ordering ordering,
+                                      FeatureValue split_point) {
+  DCHECK_GE(feature_index, 0);
+  feature_index_.push_back(feature_index);
+  split_point_.push_back(split_point.value());
+  is_numeric_.push_back(ordering == LearningTask::Ordering::kNumeric);
+  children_.push_back(kNoChild);
+  children_.push_back(kNoChild);
+  return static_cast<int>(feature_index_.size()) - 1;
+}
+
+void FlatTreeEnsemble::SetChild(int node, bool branch, int child) {
+  DCHECK_NE(feature_index_[node], kLeaf);
+  children_[2 * node + branch] = child;
+}
+
+int FlatTreeEnsemble::FindLeaf(int root, const FeatureVector& instance) const {
+  int node = root;
+  while (feature_index_[node] != kLeaf) {
+    DCHECK_LT(static_cast<size_t>(feature_index_[node]), instance.size());
+    const double value = instance[feature_index_[node]].value();
+    // Same tests as the tree's interior nodes: "==" for nominal features, and
+    // ">" for numeric ones.
+    const bool branch = is_numeric_[node] ? value > split_point_[node]
+                                          : value == split_point_[node];
+    node = children_[2 * node + branch];
+    if (node == kNoChild)
+      return -1;
+  }
+  return children_[2 * node];
+}
+
+void FlatTreeEnsemble::AddVotes(int leaf, double* votes) const {
+  for (uint32_t i = leaf_begin_[leaf]; i < leaf_begin_[leaf + 1]; i++)
+    votes[leaf_targets_[i]] += leaf_counts_[i];
+}
+
+TargetHistogram FlatTreeEnsemble::ToTargetHistogram(
+    const double* votes) const {
+  // Only the targets that some tree voted for end up in the histogram, as
+  // when the trees' histograms are added together.
+  TargetHistogram distribution;
+  for (size_t i = 0; i < target_values_.size(); i++) {
+    if (votes[i] != 0)
+      distribution[target_values_[i]] = votes[i];
+  }
+  return distribution;
+}
+
+TargetHistogram FlatTreeEnsemble::PredictDistribution(
+    const FeatureVector& instance) {
+  std::vector<double> votes(target_values_.size());
+  for (int32_t root : tree_roots_) {
+    const int leaf = FindLeaf(root, instance);
+    if (leaf >= 0)
+      AddVotes(leaf, votes.data());
+  }
+  return ToTargetHistogram(votes.data());
+}
+
+std::vector<TargetHistogram> FlatTreeEnsemble::PredictDistributions(
+    const std::vector<FeatureVector>& instances) const {
+  // One row of votes per instance.  Trees are visited in the same order as by
+  // PredictDistribution(), so the sums are identical.
+  const size_t num_targets = target_values_.size();
+  std::vector<double> votes(instances.size() * num_targets);
+  for (int32_t root : tree_roots_) {
+    for (size_t i = 0; i < instances.size(); i++) {
+      const int leaf = FindLeaf(root, instances[i]);
+      if (leaf >= 0)
+        AddVotes(leaf, votes.data() + i * num_targets);
+    }
+  }
+
+  std::vector<TargetHistogram> distributions;
+  distributions.reserve(instances.size());
+  for (size_t i = 0; i < instances.size(); i++)
+    distributions.push_back(ToTargetHistogram(votes.data() + i * num_targets));
+  return distributions;
+}
+
+}  // namespace learning
+}  // namespace media
@@ -0,0 +1,116 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_LEARNING_IMPL_FLAT_TREE_ENSEMBLE_H_
+#define MEDIA_LEARNING_IMPL_FLAT_TREE_ENSEMBLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/component_export.h"
+#include "base/containers/flat_map.h"
+#include "media/learning/common/learning_task.h"
+#include "media/learning/impl/model.h"
+
+namespace media {
+namespace learning {
+
+// Ensemble of decision trees, compiled into a form that's quick to evaluate.
+// It predicts the same distributions as a VotingEnsemble of the same trees.
+//
+// The nodes of all trees are kept in parallel arrays, one per node field,
+// rather than as a graph of heap-allocated nodes.  Each tree's nodes are
+// contiguous and in depth-first order, so a prediction walks a few cache lines
+// instead of chasing pointers through a map per node.  Leaves refer to their
+// distributions by index into another set of arrays, and target values are
+// interned so that votes are summed into a plain array.
+//
+// Use PredictDistributions() to evaluate many instances at once; it runs one
+// tree at a time over all of them, which keeps that tree's nodes in cache.
+class COMPONENT_EXPORT(LEARNING_IMPL) FlatTreeEnsemble : public Model {
+ public:
+  // Compiles |trees|, which must all be decision trees, as produced by
+  // RandomTreeTrainer.  Returns nullptr if any of them is not.
+  static std::unique_ptr<FlatTreeEnsemble> Compile(
+      const std::vector<std::unique_ptr<Model>>& trees);
+
+  FlatTreeEnsemble(const FlatTreeEnsemble&) = delete;
+  FlatTreeEnsemble& operator=(const FlatTreeEnsemble&) = delete;
+
+  ~FlatTreeEnsemble() override;
+
+  // Model
+  TargetHistogram PredictDistribution(const FeatureVector& instance) override;
+
+  // Returns the prediction for each of |instances|, in order.
+  std::vector<TargetHistogram> PredictDistributions(
+      const std::vector<FeatureVector>& instances) const;
+
+  size_t num_trees() const { return tree_roots_.size(); }
+  size_t num_nodes() const { return feature_index_.size(); }
+
+  // Called by decision tree models from AddToFlatTreeEnsemble(), to add their
+  // nodes.  Each returns the index of the new node.  An interior node must
+  // have its children set with SetChild() once they have been added.
+  int AddLeafNode(const TargetHistogram& distribution);
+  int AddInteriorNode(int feature_index,
+                      LearningTask::Ordering ordering,
+                      FeatureValue split_point);
+
+  // Sets the node that |node| goes to when its test is |branch|: for numeric
+  // features, whether the value is > the split point; otherwise, whether it's
+  // == the split point.
+  void SetChild(int node, bool branch, int child);
+
+ private:
+  FlatTreeEnsemble();
+
+  // Returns the leaf of the tree rooted at |root| that |instance| reaches, or
+  // -1 if it takes a branch that was never seen in training.
+  int FindLeaf(int root, const FeatureVector& instance) const;
+
+  // Adds the distribution of |leaf| to |votes|, indexed like
+  // |target_values_|.
+  void AddVotes(int leaf, double* votes) const;
+
+  TargetHistogram ToTargetHistogram(const double* votes) const;
+
+  // Marks a leaf in |feature_index_|.
+  static constexpr int32_t kLeaf = -1;
+
+  // Marks a branch with no child in |children_|.
+  static constexpr int32_t kNoChild = -1;
+
+  // Root node of each tree.
+  std::vector<int32_t> tree_roots_;
+
+  // Per node.  For interior nodes, the feature to test and the value to test
+  // it against.  For leaves, |feature_index_| is kLeaf.
+  std::vector<int32_t> feature_index_;
+  std::vector<double> split_point_;
+  std::vector<uint8_t> is_numeric_;
+
+  // Two per node: for interior nodes, the children for a false and true test,
+  // in that order.  For leaves, the first is the index of the leaf.
+  std::vector<int32_t> children_;
+
+  // Per leaf, the range of |leaf_targets_| and |leaf_counts_| holding its
+  // distribution, which is [leaf_begin_[i], leaf_begin_[i + 1]).
+  std::vector<uint32_t> leaf_begin_;
+  std::vector<uint32_t> leaf_targets_;
+  std::vector<double> leaf_counts_;
+
+  // Every target value predicted by some leaf, and the reverse mapping that's
+  // used while the ensemble is being built.
+  std::vector<TargetValue> target_values_;
+  base::flat_map<TargetValue, uint32_t> target_indices_;
+};
+
+}  // namespace learning
+}  // namespace media
+
+#endif  // MEDIA_LEARNING_IMPL_FLAT_TREE_ENSEMBLE_H_
@@ -0,0 +1,164 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "media/learning/impl/fisher_iris_dataset.h"
+#include "media/learning/impl/flat_tree_ensemble.h"
+#include "media/learning/impl/random_tree_trainer.h"
+#include "media/learning/impl/test_random_number_generator.h"
+#include "media/learning/impl/voting_ensemble.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+namespace learning {
+
+namespace {
+
+// Number of trees, as for ExtraTreesTrainer with the default LearningTask.
+constexpr size_t kNumTrees = 100;
+
+// Size of the synthetic data sets.
+constexpr size_t kNumSyntheticExamples = 2000;
+
+// Each measurement makes at least this many predictions.
+constexpr size_t kMinPredictions = 100000;
+
+}  // namespace
+
+class FlatTreeEnsemblePerfTest : public testing::Test {
+ public:
+  FlatTreeEnsemblePerfTest() : rng_(0) {}
+
+ protected:
+  void SetupFeatures(size_t n) {
+    task_.feature_descriptions.clear();
+    for (size_t i = 0; i < n; i++) {
+      LearningTask::ValueDescription desc;
+      desc.ordering = LearningTask::Ordering::kNumeric;
+      task_.feature_descriptions.push_back(desc);
+    }
+  }
+
+  // Returns a training set of |num_features| uniformly random features, with
+  // a target that depends on a few of them plus some noise, so that the trees
+  // grow reasonably deep.
+  TrainingData MakeSyntheticData(size_t num_features) {
+    TrainingData data;
+    for (size_t i = 0; i < kNumSyntheticExamples; i++) {
+      FeatureVector features;
+      for (size_t f = 0; f < num_features; f++)
+        features.push_back(FeatureValue(rng_.GenerateDouble(1.0)));
+      const double score = features[0].value() + features[1].value() -
+                           features[2].value() + rng_.GenerateDouble(0.5);
+      data.push_back(
+          LabelledExample(std::move(features), TargetValue(score > 0.75)));
+    }
+    return data;
+  }
+
+  std::vector<std::unique_ptr<Model>> TrainTrees(const TrainingData& data) {
+    RandomTreeTrainer trainer(&rng_);
+    std::vector<std::unique_ptr<Model>> trees;
+    for (size_t i = 0; i < kNumTrees; i++) {
+      trainer.Train(task_, data,
+                    base::BindOnce(
+                        [](std::vector<std::unique_ptr<Model>>* trees,
+                           std::unique_ptr<Model> model) {
+                          trees->push_back(std::move(model));
+                        },
+                        &trees));
+      task_environment_.RunUntilIdle();
+    }
+    return trees;
+  }
+
+  // Reports predictions per second for a VotingEnsemble of trees trained on
+  // |data|, and for the FlatTreeEnsemble compiled from them, one instance at
+  // a time and in batches.
+  void RunPredictionTest(const std::string& story, const TrainingData& data) {
+    std::vector<std::unique_ptr<Model>> trees = TrainTrees(data);
+    std::unique_ptr<FlatTreeEnsemble> flat_model =
+        FlatTreeEnsemble::Compile(trees);
+    ASSERT_TRUE(flat_model);
+    VotingEnsemble voting_model(std::move(trees));
+
+    std::vector<FeatureVector> instances;
+    for (const LabelledExample& example : data)
+      instances.push_back(example.features);
+    const size_t num_rounds =
+        (kMinPredictions + instances.size() - 1) / instances.size();
+
+    perf_test::PerfResultReporter reporter("flat_tree_ensemble", story);
+    reporter.RegisterImportantMetric("_voting_ensemble", "predictions/s");
+    reporter.RegisterImportantMetric("_flat", "predictions/s");
+    reporter.RegisterImportantMetric("_flat_batch", "predictions/s");
+    reporter.RegisterFyiMetric("_nodes", "count");
+
+    // Keep the results, so that the work isn't optimized away.
+    double total_counts = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (size_t round = 0; round < num_rounds; round++) {
+      for (const FeatureVector& instance : instances)
+        total_counts += voting_model.PredictDistribution(instance).size();
+    }
+    reporter.AddResult("_voting_ensemble",
+                       num_rounds * instances.size() /
+                           (base::TimeTicks::Now() - start).InSecondsF());
+
+    start = base::TimeTicks::Now();
+    for (size_t round = 0; round < num_rounds; round++) {
+      for (const FeatureVector& instance : instances)
+        total_counts += flat_model->PredictDistribution(instance).size();
+    }
+    reporter.AddResult("_flat",
+                       num_rounds * instances.size() /
+                           (base::TimeTicks::Now() - start).InSecondsF());
+
+    start = base::TimeTicks::Now();
+    for (size_t round = 0; round < num_rounds; round++) {
+      for (const TargetHistogram& distribution :
+           flat_model->PredictDistributions(instances)) {
+        total_counts += distribution.size();
+      }
+    }
+    reporter.AddResult("_flat_batch",
+                       num_rounds * instances.size() /
+                           (base::TimeTicks::Now() - start).InSecondsF());
+
+    reporter.AddResult("_nodes", flat_model->num_nodes());
+    EXPECT_GT(total_counts, 0);
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  TestRandomNumberGenerator rng_;
+  LearningTask task_;
+};
+
+TEST_F(FlatTreeEnsemblePerfTest, FisherIris) {
+  SetupFeatures(4);
+  FisherIrisDataset iris;
+  RunPredictionTest("fisher_iris", iris.GetTrainingData());
+}
+
+TEST_F(FlatTreeEnsemblePerfTest, Synthetic16Features) {
+  SetupFeatures(16);
+  RunPredictionTest("synthetic_16_features", MakeSyntheticData(16));
+}
+
+TEST_F(FlatTreeEnsemblePerfTest, Synthetic128Features) {
+  SetupFeatures(128);
+  RunPredictionTest("synthetic_128_features", MakeSyntheticData(128));
+}
+
+}  // namespace learning
+}  // namespace media
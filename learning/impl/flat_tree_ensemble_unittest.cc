@@ -0,0 +1,136 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/learning/impl/flat_tree_ensemble.h"
+
+#include "base/bind.h"
+#include "base/test/task_environment.h"
+#include "media/learning/impl/fisher_iris_dataset.h"
+#include "media/learning/impl/lookup_table_trainer.h"
+#include "media/learning/impl/random_tree_trainer.h"
+#include "media/learning/impl/test_random_number_generator.h"
+#include "media/learning/impl/voting_ensemble.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+namespace learning {
+
+class FlatTreeEnsembleTest
+    : public testing::TestWithParam<LearningTask::Ordering> {
+ public:
+  FlatTreeEnsembleTest() : rng_(0), ordering_(GetParam()) {}
+
+  // Set up |task_| to have |n| features with the given ordering.
+  void SetupFeatures(size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      LearningTask::ValueDescription desc;
+      desc.ordering = ordering_;
+      task_.feature_descriptions.push_back(desc);
+    }
+  }
+
+  std::unique_ptr<Model> Train(TrainingAlgorithm* trainer,
+                               const TrainingData& data) {
+    std::unique_ptr<Model> model;
+    trainer->Train(
+        task_, data,
+        base::BindOnce(
+            [](std::unique_ptr<Model>* model_out,
+               std::unique_ptr<Model> model) { *model_out = std::move(model); },
+            &model));
+    task_environment_.RunUntilIdle();
+    return model;
+  }
+
+  std::vector<std::unique_ptr<Model>> TrainTrees(const TrainingData& data,
+                                                 size_t n) {
+    RandomTreeTrainer trainer(&rng_);
+    std::vector<std::unique_ptr<Model>> trees;
+    for (size_t i = 0; i < n; i++)
+      trees.push_back(Train(&trainer, data));
+    return trees;
+  }
+
+  base::test::TaskEnvironment task_environment_;
+
+  TestRandomNumberGenerator rng_;
+  LearningTask task_;
+  // Feature ordering.
+  LearningTask::Ordering ordering_;
+};
+
+TEST_P(FlatTreeEnsembleTest, EmptyTrainingDataWorks) {
+  auto flat_model = FlatTreeEnsemble::Compile(TrainTrees(TrainingData(), 3));
+  ASSERT_NE(flat_model.get(), nullptr);
+  EXPECT_EQ(flat_model->num_trees(), 3u);
+  EXPECT_EQ(flat_model->PredictDistribution(FeatureVector()),
+            TargetHistogram());
+}
+
+TEST_P(FlatTreeEnsembleTest, MatchesVotingEnsembleOnFisherIris) {
+  SetupFeatures(4);
+  FisherIrisDataset iris;
+  const TrainingData& training_data = iris.GetTrainingData();
+  std::vector<std::unique_ptr<Model>> trees = TrainTrees(training_data, 10);
+  auto flat_model = FlatTreeEnsemble::Compile(trees);
+  ASSERT_NE(flat_model.get(), nullptr);
+  EXPECT_EQ(flat_model->num_trees(), 10u);
+  VotingEnsemble voting_model(std::move(trees));
+
+  // The compiled model adds up the same votes in the same order, so the
+  // predictions should match exactly, one at a time or as a batch.
+  std::vector<FeatureVector> instances;
+  for (const LabelledExample& example : training_data) {
+    instances.push_back(example.features);
+    // Perturb the features to reach some of the branches between examples.
+    FeatureVector perturbed = example.features;
+    for (FeatureValue& value : perturbed)
+      value = FeatureValue(value.value() + 0.05);
+    instances.push_back(perturbed);
+  }
+  std::vector<TargetHistogram> batch =
+      flat_model->PredictDistributions(instances);
+  ASSERT_EQ(batch.size(), instances.size());
+  for (size_t i = 0; i < instances.size(); i++) {
+    TargetHistogram expected = voting_model.PredictDistribution(instances[i]);
+    EXPECT_EQ(flat_model->PredictDistribution(instances[i]), expected);
+    EXPECT_EQ(batch[i], expected);
+  }
+}
+
+TEST_P(FlatTreeEnsembleTest, UnknownFeatureValueHandling) {
+  SetupFeatures(1);
+  TrainingData training_data;
+  training_data.push_back(
+      LabelledExample({FeatureValue(123)}, TargetValue(1)));
+  training_data.push_back(
+      LabelledExample({FeatureValue(456)}, TargetValue(2)));
+  std::vector<std::unique_ptr<Model>> trees = TrainTrees(training_data, 3);
+  auto flat_model = FlatTreeEnsemble::Compile(trees);
+  ASSERT_NE(flat_model.get(), nullptr);
+  VotingEnsemble voting_model(std::move(trees));
+
+  const FeatureVector unknown({FeatureValue(789)});
+  EXPECT_EQ(flat_model->PredictDistribution(unknown),
+            voting_model.PredictDistribution(unknown));
+}
+
+TEST_P(FlatTreeEnsembleTest, OtherModelsAreNotCompiled) {
+  SetupFeatures(1);
+  TrainingData training_data;
+  training_data.push_back(
+      LabelledExample({FeatureValue(123)}, TargetValue(1)));
+  std::vector<std::unique_ptr<Model>> models = TrainTrees(training_data, 1);
+  LookupTableTrainer lookup_table_trainer;
+  models.push_back(Train(&lookup_table_trainer, training_data));
+  EXPECT_EQ(FlatTreeEnsemble::Compile(models), nullptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(FlatTreeEnsembleTest,
+                         FlatTreeEnsembleTest,
+                         testing::ValuesIn({LearningTask::Ordering::kUnordered,
+                                            LearningTask::Ordering::kNumeric}));
+
+}  // namespace learning
+}  // namespace media
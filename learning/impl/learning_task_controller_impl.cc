@@ -168,9 +168,9 @@ void LearningTaskControllerImpl::AddFinishedExample(LabelledExample example,
   training_is_in_progress_ = true;
   // Note that this copies the training data, so it's okay if we add more
   // examples to our copy before this returns.
-  // TODO(liberato): Post to a background task runner, and bind |model_cb| to
-  // the current one.  Be careful about ownership if we invalidate |trainer_|
-  // on this thread.  Be sure to post destruction to that sequence.
+  // ExtraTreesTrainer converts the data and trains its trees on the thread
+  // pool, and, depending on LearningTask::rf_replacement_fraction, may replace
+  // only some of them.  The other trainers still train on this sequence.
   trainer_->Train(task_, *training_data_, std::move(model_cb));
 }
 
@@ -4,17 +4,44 @@
 
 #include "media/learning/impl/lookup_table_trainer.h"
 
-#include <map>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
 
+#include "base/containers/flat_map.h"
+#include "media/learning/impl/columnar_training_data.h"
 
 namespace media {
 namespace learning {
 
 class LookupTable : public Model {
  public:
-  LookupTable(const TrainingData& training_data) {
-    for (auto& example : training_data)
-      buckets_[example.features] += example;
+  explicit LookupTable(const ColumnarTrainingData& training_data) {
+    // Sort the examples by their features, so that equal feature vectors are
+    // next to each other.  Every feature is interned, so this only compares
+    // integers.  The buckets then come out in order.
+    std::vector<size_t> order(training_data.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&training_data](size_t a, size_t b) {
+      return training_data.FeaturesLess(a, b);
+    });
+
+    std::vector<std::pair<FeatureVector, TargetHistogram>> buckets;
+    for (size_t begin = 0; begin < order.size();) {
+      size_t end = begin + 1;
+      while (end < order.size() &&
+             training_data.FeaturesEqual(order[begin], order[end])) {
+        end++;
+      }
+      buckets.emplace_back(
+          training_data.GetFeatures(order[begin]),
+          training_data.GetTargetHistogram(std::vector<size_t>(
+              order.begin() + begin, order.begin() + end)));
+      begin = end;
+    }
+    buckets_ = base::flat_map<FeatureVector, TargetHistogram>(
+        base::sorted_unique, std::move(buckets));
   }
 
   // Model
@@ -27,7 +54,7 @@ class LookupTable : public Model {
   }
 
  private:
-  std::map<FeatureVector, TargetHistogram> buckets_;
+  base::flat_map<FeatureVector, TargetHistogram> buckets_;
 };
 
 LookupTableTrainer::LookupTableTrainer() = default;
@@ -38,7 +65,7 @@ void LookupTableTrainer::Train(const LearningTask& task,
                                const TrainingData& training_data,
                                TrainedModelCB model_cb) {
   std::unique_ptr<LookupTable> lookup_table =
-      std::make_unique<LookupTable>(training_data);
+      std::make_unique<LookupTable>(ColumnarTrainingData(training_data));
 
   // TODO(liberato): post?
   std::move(model_cb).Run(std::move(lookup_table));
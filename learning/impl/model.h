@@ -13,6 +13,8 @@
 namespace media {
 namespace learning {
 
+class FlatTreeEnsemble;
+
 // One trained model, useful for making predictions.
 // TODO(liberato): Provide an API for incremental update, for those models that
 // can support it.
@@ -26,6 +28,13 @@ class COMPONENT_EXPORT(LEARNING_IMPL) Model {
   virtual TargetHistogram PredictDistribution(
       const FeatureVector& instance) = 0;
 
+  // If this model is a decision tree, adds it to |ensemble| and returns the
+  // index of its root node.  Returns -1, and leaves |ensemble| in an
+  // unspecified state, for any other kind of model.
+  virtual int AddToFlatTreeEnsemble(FlatTreeEnsemble* ensemble) const {
+    return -1;
+  }
+
   // TODO(liberato): Consider adding an async prediction helper.
 };
 
@@ -4,8 +4,6 @@
 
 #include "media/learning/impl/one_hot.h"
 
-#include <set>
-
 namespace media {
 namespace learning {
 
@@ -14,6 +12,10 @@ OneHotConverter::OneHotConverter(const LearningTask& task,
     : converted_task_(task) {
   converted_task_.feature_descriptions.clear();
 
+  // Storing the data by column interns each nominal feature, which finds its
+  // distinct values in order.
+  const ColumnarTrainingData columnar_training_data(task, training_data);
+
   // store
   converters_.resize(task.feature_descriptions.size());
 
@@ -28,7 +30,7 @@ OneHotConverter::OneHotConverter(const LearningTask& task,
       continue;
     }
 
-    ProcessOneFeature(i, feature, training_data);
+    ProcessOneFeature(i, feature, columnar_training_data);
   }
 }
 
@@ -77,16 +79,12 @@ FeatureVector OneHotConverter::Convert(
 void OneHotConverter::ProcessOneFeature(
     size_t index,
     const LearningTask::ValueDescription& original_description,
-    const TrainingData& training_data) {
-  // Collect all the distinct values for |index|.
-  std::set<Value> values;
-  for (auto& example : training_data) {
-    DCHECK_GE(example.features.size(), index);
-    values.insert(example.features[index]);
-  }
+    const ColumnarTrainingData& training_data) {
+  // All the distinct values for |index|.
+  const std::vector<FeatureValue>& values = training_data.dictionary(index);
 
-  // We let the set's ordering be the one-hot value.  It doesn't really matter
-  // as long as we don't change it once we pick it.
+  // We let the dictionary's ordering be the one-hot value.  It doesn't really
+  // matter as long as we don't change it once we pick it.
   ValueVectorIndexMap value_map;
   // Vector index that should be set to one for each distinct value.  This will
   // start at the next feature in the adjusted task.
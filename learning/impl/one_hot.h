@@ -14,6 +14,7 @@
 #include "media/learning/common/labelled_example.h"
 #include "media/learning/common/learning_task.h"
 #include "media/learning/common/value.h"
+#include "media/learning/impl/columnar_training_data.h"
 #include "media/learning/impl/model.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
@@ -47,7 +48,7 @@ class COMPONENT_EXPORT(LEARNING_IMPL) OneHotConverter {
   void ProcessOneFeature(
       size_t index,
       const LearningTask::ValueDescription& original_description,
-      const TrainingData& training_data);
+      const ColumnarTrainingData& training_data);
 
   // Learning task with the feature descriptions adjusted for the one-hot model.
   LearningTask converted_task_;
@@ -46,6 +46,20 @@ double RandomNumberGenerator::GenerateDouble(double range) {
   return base::BitsToOpenEndedUnitInterval(Generate()) * range;
 }
 
+SeededRandomNumberGenerator::SeededRandomNumberGenerator(uint64_t seed)
+    : state_(seed) {}
+
+SeededRandomNumberGenerator::~SeededRandomNumberGenerator() = default;
+
+uint64_t SeededRandomNumberGenerator::Generate() {
+  // SplitMix64, which is fast and passes BigCrush.  See
+  // http://prng.di.unimi.it/splitmix64.c .
+  uint64_t z = (state_ += UINT64_C(0x9e3779b97f4a7c15));
+  z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+  return z ^ (z >> 31);
+}
+
 HasRandomNumberGenerator::HasRandomNumberGenerator(RandomNumberGenerator* rng)
     : rng_(rng ? rng : RandomNumberGenerator::Default()) {}
 
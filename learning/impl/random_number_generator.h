@@ -41,6 +41,23 @@ class COMPONENT_EXPORT(LEARNING_IMPL) RandomNumberGenerator {
   double GenerateDouble(double range);
 };
 
+// Generator that returns the same sequence for the same seed, on any platform.
+// This lets work that's split up across threads be repeatable, by giving each
+// piece its own generator seeded from a shared one.  The values are not
+// unpredictable; don't use this for anything that needs them to be.
+class COMPONENT_EXPORT(LEARNING_IMPL) SeededRandomNumberGenerator
+    : public RandomNumberGenerator {
+ public:
+  explicit SeededRandomNumberGenerator(uint64_t seed);
+  ~SeededRandomNumberGenerator() override;
+
+  // RandomNumberGenerator
+  uint64_t Generate() override;
+
+ private:
+  uint64_t state_;
+};
+
 // Handy mix-in class if you want to support rng injection.
 class COMPONENT_EXPORT(LEARNING_IMPL) HasRandomNumberGenerator {
  public:
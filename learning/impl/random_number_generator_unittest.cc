@@ -4,6 +4,7 @@
 
 #include "base/bind.h"
 #include "base/callback.h"
+#include "media/learning/impl/random_number_generator.h"
 #include "media/learning/impl/test_random_number_generator.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -99,4 +100,25 @@ TEST_F(RandomNumberGeneratorTest, DoublesStayInRange) {
   EXPECT_GE(num_non_integer, 900);
 }
 
+TEST_F(RandomNumberGeneratorTest, SeededGeneratorIsRepeatable) {
+  SeededRandomNumberGenerator rng_1(123);
+  SeededRandomNumberGenerator rng_2(123);
+  SeededRandomNumberGenerator rng_3(124);
+  int num_different = 0;
+  for (int i = 0; i < 100; i++) {
+    const uint64_t v = rng_1.Generate();
+    EXPECT_EQ(v, rng_2.Generate());
+    num_different += (v != rng_3.Generate());
+  }
+  EXPECT_EQ(num_different, 100);
+
+  SeededRandomNumberGenerator rng_4(0);
+  GenerateAndVerify(base::BindRepeating(
+                        [](RandomNumberGenerator* rng) {
+                          return static_cast<int64_t>(rng->Generate(5));
+                        },
+                        &rng_4),
+                    0, 4);
+}
+
 }  // namespace media
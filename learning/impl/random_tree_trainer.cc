@@ -6,10 +6,12 @@
 
 #include <math.h>
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/check_op.h"
 #include "base/threading/sequenced_task_runner_handle.h"
-#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "media/learning/impl/flat_tree_ensemble.h"
 
 namespace media {
 namespace learning {
@@ -25,12 +27,6 @@ RandomTreeTrainer::Split::~Split() = default;
 RandomTreeTrainer::Split& RandomTreeTrainer::Split::operator=(Split&& rhs) =
     default;
 
-RandomTreeTrainer::Split::BranchInfo::BranchInfo() = default;
-
-RandomTreeTrainer::Split::BranchInfo::BranchInfo(BranchInfo&& rhs) = default;
-
-RandomTreeTrainer::Split::BranchInfo::~BranchInfo() = default;
-
 struct InteriorNode : public Model {
   InteriorNode(const LearningTask& task,
                int split_index,
@@ -76,6 +72,19 @@ struct InteriorNode : public Model {
     return total;
   }
 
+  int AddToFlatTreeEnsemble(FlatTreeEnsemble* ensemble) const override {
+    const int node =
+        ensemble->AddInteriorNode(split_index_, ordering_, split_point_);
+    for (auto& child_pair : children_) {
+      const int child = child_pair.second->AddToFlatTreeEnsemble(ensemble);
+      if (child < 0)
+        return -1;
+      // Branches are keyed by the result of the node's test, as 0 or 1.
+      ensemble->SetChild(node, child_pair.first.value() != 0, child);
+    }
+    return node;
+  }
+
   // Add |child| has the node for feature value |v|.
   void AddChild(FeatureValue v, std::unique_ptr<Model> child) {
     DCHECK_EQ(children_.count(v), 0u);
@@ -95,12 +104,8 @@ struct InteriorNode : public Model {
 };
 
 struct LeafNode : public Model {
-  LeafNode(const TrainingData& training_data,
-           const std::vector<size_t> training_idx,
-           LearningTask::Ordering ordering) {
-    for (size_t idx : training_idx)
-      distribution_ += training_data[idx];
-
+  explicit LeafNode(TargetHistogram distribution)
+      : distribution_(std::move(distribution)) {
     // Each leaf gets one vote.
     // See https://en.wikipedia.org/wiki/Bootstrap_aggregating .  TL;DR: the
     // individual trees should average (regression) or vote (classification).
@@ -119,6 +124,10 @@ struct LeafNode : public Model {
     return distribution_;
   }
 
+  int AddToFlatTreeEnsemble(FlatTreeEnsemble* ensemble) const override {
+    return ensemble->AddLeafNode(distribution_);
+  }
+
  private:
   TargetHistogram distribution_;
 };
@@ -131,28 +140,38 @@ RandomTreeTrainer::~RandomTreeTrainer() {}
 void RandomTreeTrainer::Train(const LearningTask& task,
                               const TrainingData& training_data,
                               TrainedModelCB model_cb) {
+  // It's a little odd that we don't post training.  Perhaps we should.
+  auto model = TrainTree(task, training_data);
+  base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(std::move(model_cb), std::move(model)));
+}
+
+std::unique_ptr<Model> RandomTreeTrainer::TrainTree(
+    const LearningTask& task,
+    const TrainingData& training_data) {
+  return TrainTree(task, ColumnarTrainingData(task, training_data));
+}
+
+std::unique_ptr<Model> RandomTreeTrainer::TrainTree(
+    const LearningTask& task,
+    const ColumnarTrainingData& training_data) {
   // Start with all the training data.
   std::vector<size_t> training_idx;
   training_idx.reserve(training_data.size());
   for (size_t idx = 0; idx < training_data.size(); idx++)
     training_idx.push_back(idx);
 
-  // It's a little odd that we don't post training.  Perhaps we should.
-  auto model = Train(task, training_data, training_idx);
-  base::SequencedTaskRunnerHandle::Get()->PostTask(
-      FROM_HERE, base::BindOnce(std::move(model_cb), std::move(model)));
+  return Train(task, training_data, training_idx);
 }
 
 std::unique_ptr<Model> RandomTreeTrainer::Train(
     const LearningTask& task,
-    const TrainingData& training_data,
+    const ColumnarTrainingData& training_data,
     const std::vector<size_t>& training_idx) {
-  if (training_data.empty()) {
-    return std::make_unique<LeafNode>(training_data, std::vector<size_t>(),
-                                      LearningTask::Ordering::kUnordered);
-  }
+  if (training_data.empty())
+    return std::make_unique<LeafNode>(TargetHistogram());
 
-  DCHECK_EQ(task.feature_descriptions.size(), training_data[0].features.size());
+  DCHECK_EQ(task.feature_descriptions.size(), training_data.num_features());
 
   // Start with all features unused.
   FeatureSet unused_set;
@@ -162,9 +181,25 @@ std::unique_ptr<Model> RandomTreeTrainer::Train(
   return Build(task, training_data, training_idx, unused_set);
 }
 
+namespace {
+
+// Returns true if |column| has the same value for all of |training_idx|.
+template <typename T>
+bool IsConstant(const std::vector<T>& column,
+                const std::vector<size_t>& training_idx) {
+  const T first_value = column[training_idx[0]];
+  for (size_t idx : training_idx) {
+    if (column[idx] != first_value)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 std::unique_ptr<Model> RandomTreeTrainer::Build(
     const LearningTask& task,
-    const TrainingData& training_data,
+    const ColumnarTrainingData& training_data,
     const std::vector<size_t>& training_idx,
     const FeatureSet& unused_set) {
   DCHECK_GT(training_idx.size(), 0u);
@@ -172,50 +207,27 @@ std::unique_ptr<Model> RandomTreeTrainer::Build(
   // TODO: enforce a minimum number of samples.  ExtraTrees uses 2 for
   // classification, and 5 for regression.
 
-  // Remove any constant attributes in |training_data| from |unused_set|.  Also
-  // check if our training data has a constant target value.  For both features
-  // and the target value, if the Optional has a value then it's the singular
-  // value that we've found so far.  If we find a second one, then we'll clear
-  // the Optional.
-  absl::optional<TargetValue> target_value(
-      training_data[training_idx[0]].target_value);
-  std::vector<absl::optional<FeatureValue>> feature_values;
-  feature_values.resize(training_data[0].features.size());
-  for (size_t feature_idx : unused_set) {
-    feature_values[feature_idx] =
-        training_data[training_idx[0]].features[feature_idx];
-  }
-  for (size_t idx : training_idx) {
-    const LabelledExample& example = training_data[idx];
-    // Record this target value to see if there is more than one.  We skip the
-    // insertion if we've already determined that it's not constant.
-    if (target_value && target_value != example.target_value)
-      target_value.reset();
-
-    // For all features in |unused_set|, see if it's a constant in our subset of
-    // the training data.
-    for (size_t feature_idx : unused_set) {
-      auto& value = feature_values[feature_idx];
-      if (value && *value != example.features[feature_idx])
-        value.reset();
-    }
-  }
-
   // Is the output constant in |training_data|?  If so, then generate a leaf.
   // If we're not normalizing leaves, then this matters since this training data
   // might be split across multiple leaves.
-  if (target_value) {
-    return std::make_unique<LeafNode>(training_data, training_idx,
-                                      task.target_description.ordering);
+  if (IsConstant(training_data.targets(), training_idx)) {
+    return std::make_unique<LeafNode>(
+        training_data.GetTargetHistogram(training_idx));
   }
 
   // Remove any constant features from the unused set, so that we don't try to
   // split on them.  It would work, but it would be trivially useless.  We also
-  // don't want to use one of our potential splits on it.
+  // don't want to use one of our potential splits on it.  Each check scans one
+  // column.
   FeatureSet new_unused_set = unused_set;
   for (size_t feature_idx : unused_set) {
-    auto& value = feature_values[feature_idx];
-    if (value)
+    const bool is_constant =
+        training_data.is_numeric(feature_idx)
+            ? IsConstant(training_data.numeric_column(feature_idx),
+                         training_idx)
+            : IsConstant(training_data.nominal_column(feature_idx),
+                         training_idx);
+    if (is_constant)
       new_unused_set.erase(feature_idx);
   }
 
@@ -255,20 +267,39 @@ std::unique_ptr<Model> RandomTreeTrainer::Build(
   // Note that we can have a split with no index (i.e., no features left, or no
   // feature was an improvement in nats), or with a single index (had features,
   // but all had the same value).  Either way, we should end up with a leaf.
-  if (best_potential_split.branch_infos.size() < 2) {
+  if (best_potential_split.num_branches < 2) {
     // Stop when there is no more tree.
-    return std::make_unique<LeafNode>(training_data, training_idx,
-                                      task.target_description.ordering);
+    return std::make_unique<LeafNode>(
+        training_data.GetTargetHistogram(training_idx));
+  }
+
+  // Only now that we've chosen a split do we need the training set for each
+  // branch.
+  const size_t split_index = best_potential_split.split_index;
+  std::vector<size_t> branch_idx[2];
+  if (training_data.is_numeric(split_index)) {
+    const std::vector<double>& column =
+        training_data.numeric_column(split_index);
+    const double split_point = best_potential_split.split_point.value();
+    for (size_t idx : training_idx)
+      branch_idx[column[idx] > split_point].push_back(idx);
+  } else {
+    const std::vector<ColumnarTrainingData::ValueIndex>& column =
+        training_data.nominal_column(split_index);
+    const ColumnarTrainingData::ValueIndex split_value =
+        best_potential_split.split_value_index;
+    for (size_t idx : training_idx)
+      branch_idx[column[idx] == split_value].push_back(idx);
   }
 
   // Build an interior node
   std::unique_ptr<InteriorNode> node = std::make_unique<InteriorNode>(
-      task, best_potential_split.split_index, best_potential_split.split_point);
+      task, split_index, best_potential_split.split_point);
 
-  for (auto& branch_iter : best_potential_split.branch_infos) {
-    node->AddChild(branch_iter.first,
-                   Build(task, training_data, branch_iter.second.training_idx,
-                         new_unused_set));
+  for (int branch = 0; branch < 2; branch++) {
+    node->AddChild(
+        FeatureValue(branch),
+        Build(task, training_data, branch_idx[branch], new_unused_set));
   }
 
   return node;
@@ -276,7 +307,7 @@ std::unique_ptr<Model> RandomTreeTrainer::Build(
 
 RandomTreeTrainer::Split RandomTreeTrainer::ConstructSplit(
     const LearningTask& task,
-    const TrainingData& training_data,
+    const ColumnarTrainingData& training_data,
     const std::vector<size_t>& training_idx,
     int split_index) {
   // We should not be given a training set of size 0, since there's no need to
@@ -287,60 +318,66 @@ RandomTreeTrainer::Split RandomTreeTrainer::ConstructSplit(
 
   bool is_numeric = task.feature_descriptions[split_index].ordering ==
                     LearningTask::Ordering::kNumeric;
+  DCHECK_EQ(is_numeric, training_data.is_numeric(split_index));
 
   // TODO(liberato): Consider removing nominal feature support and RF.  That
   // would make this code somewhat simpler.
 
-  // For a numeric split, find the split point.  Otherwise, we'll split on every
-  // nominal value that this feature has in |training_data|.
+  // Count the weight of each target value along each branch, with branch 1's
+  // counts after all of branch 0's.  For a numeric split, branch 1 is for
+  // values > the split point.  For a nominal split, it's for values == the
+  // split point.  |total_weight| will hold the total weight of all examples
+  // that come into this node.
+  const std::vector<ColumnarTrainingData::ValueIndex>& targets =
+      training_data.targets();
+  const std::vector<double>& weights = training_data.weights();
+  const size_t num_targets = training_data.target_values().size();
+  std::vector<double> branch_counts(2 * num_targets);
+  double branch_weights[2] = {0., 0.};
+  double total_weight = 0.;
+
+  // For a numeric split, find the split point.  Otherwise, we'll split on a
+  // random nominal value that this feature has in |training_data|.
   if (is_numeric) {
     split.split_point =
         FindSplitPoint_Numeric(split.split_index, training_data, training_idx);
+    const std::vector<double>& column =
+        training_data.numeric_column(split.split_index);
+    const double split_point = split.split_point.value();
+    for (size_t idx : training_idx) {
+      const int branch = column[idx] > split_point;
+      branch_counts[branch * num_targets + targets[idx]] += weights[idx];
+      branch_weights[branch] += weights[idx];
+      total_weight += weights[idx];
+    }
   } else {
-    split.split_point =
+    split.split_value_index =
         FindSplitPoint_Nominal(split.split_index, training_data, training_idx);
+    split.split_point = training_data.dictionary(
+        split.split_index)[split.split_value_index];
+    const std::vector<ColumnarTrainingData::ValueIndex>& column =
+        training_data.nominal_column(split.split_index);
+    const ColumnarTrainingData::ValueIndex split_value =
+        split.split_value_index;
+    for (size_t idx : training_idx) {
+      const int branch = column[idx] == split_value;
+      branch_counts[branch * num_targets + targets[idx]] += weights[idx];
+      branch_weights[branch] += weights[idx];
+      total_weight += weights[idx];
+    }
   }
 
-  // Find the split's feature values and construct the training set for each.
-  // I think we want to iterate on the underlying vector, and look up the int in
-  // the training data directly.  |total_weight| will hold the total weight of
-  // all examples that come into this node.
-  double total_weight = 0.;
-  for (size_t idx : training_idx) {
-    const LabelledExample& example = training_data[idx];
-    total_weight += example.weight;
-
-    // Get the value of the |index|-th feature for |example|.
-    FeatureValue v_i = example.features[split.split_index];
-
-    // Figure out what value this example would use for splitting.  For nominal,
-    // it's 1 or 0, based on whether |v_i| is equal to the split or not.  For
-    // numeric, it's whether |v_i| is <= the split point or not (0 for <=, and 1
-    // for >).
-    FeatureValue split_feature;
-    if (is_numeric)
-      split_feature = FeatureValue(v_i > split.split_point);
-    else
-      split_feature = FeatureValue(v_i == split.split_point);
-
-    // Add |v_i| to the right training set.  Remember that emplace will do
-    // nothing if the key already exists.
-    auto result =
-        split.branch_infos.emplace(split_feature, Split::BranchInfo());
-    auto iter = result.first;
-
-    Split::BranchInfo& branch_info = iter->second;
-    branch_info.training_idx.push_back(idx);
-    branch_info.target_histogram += example;
-  }
+  split.num_branches = (branch_weights[0] > 0) + (branch_weights[1] > 0);
 
   // Figure out how good / bad this split is.
   switch (task.target_description.ordering) {
     case LearningTask::Ordering::kUnordered:
-      ComputeSplitScore_Nominal(&split, total_weight);
+      ComputeSplitScore_Nominal(&split, branch_counts, branch_weights,
+                                total_weight);
       break;
     case LearningTask::Ordering::kNumeric:
-      ComputeSplitScore_Numeric(&split, total_weight);
+      ComputeSplitScore_Numeric(&split, training_data.target_values(),
+                                branch_counts, branch_weights, total_weight);
       break;
   }
 
@@ -349,21 +386,27 @@ RandomTreeTrainer::Split RandomTreeTrainer::ConstructSplit(
 
 void RandomTreeTrainer::ComputeSplitScore_Nominal(
     Split* split,
+    const std::vector<double>& branch_counts,
+    const double branch_weights[2],
     double total_incoming_weight) {
+  const size_t num_targets = branch_counts.size() / 2;
+
   // Compute the nats given that we're at this node.
   split->nats_remaining = 0;
-  for (auto& info_iter : split->branch_infos) {
-    Split::BranchInfo& branch_info = info_iter.second;
-
+  for (int branch = 0; branch < 2; branch++) {
     // |weight_along_branch| is the total weight of examples that would follow
     // this branch in the tree.
-    const double weight_along_branch =
-        branch_info.target_histogram.total_counts();
+    const double weight_along_branch = branch_weights[branch];
+    if (!weight_along_branch)
+      continue;
     // |p_branch| is the probability of following this branch.
     const double p_branch = weight_along_branch / total_incoming_weight;
-    for (auto& iter : branch_info.target_histogram) {
-      double p = iter.second / total_incoming_weight;
-      // p*log(p) is the expected nats if the answer is |iter|.  We multiply
+    const double* counts = &branch_counts[branch * num_targets];
+    for (size_t target = 0; target < num_targets; target++) {
+      if (!counts[target])
+        continue;
+      double p = counts[target] / total_incoming_weight;
+      // p*log(p) is the expected nats if the answer is |target|.  We multiply
       // that by the probability of being in this bucket at all.
       split->nats_remaining -= (p * log(p)) * p_branch;
     }
@@ -372,39 +415,46 @@ void RandomTreeTrainer::ComputeSplitScore_Nominal(
 
 void RandomTreeTrainer::ComputeSplitScore_Numeric(
     Split* split,
+    const std::vector<TargetValue>& target_values,
+    const std::vector<double>& branch_counts,
+    const double branch_weights[2],
     double total_incoming_weight) {
+  const size_t num_targets = target_values.size();
+
   // Compute the nats given that we're at this node.
   split->nats_remaining = 0;
-  for (auto& info_iter : split->branch_infos) {
-    Split::BranchInfo& branch_info = info_iter.second;
-
+  for (int branch = 0; branch < 2; branch++) {
     // |weight_along_branch| is the total weight of examples that would follow
     // this branch in the tree.
-    const double weight_along_branch =
-        branch_info.target_histogram.total_counts();
+    const double weight_along_branch = branch_weights[branch];
+    if (!weight_along_branch)
+      continue;
     // |p_branch| is the probability of following this branch.
     const double p_branch = weight_along_branch / total_incoming_weight;
+    const double* counts = &branch_counts[branch * num_targets];
 
     // Compute the average at this node.  Note that we have no idea if the leaf
-    // node would actually use an average, but really it should match.  It would
-    // be really nice if we could compute the value (or TargetHistogram) as
-    // part of computing the split, and have somebody just hand that target
-    // distribution to the leaf if it ends up as one.
-    double average = branch_info.target_histogram.Average();
-
-    for (auto& iter : branch_info.target_histogram) {
-      // Compute the squared error for all |iter.second| counts that each have a
-      // value of |iter.first|, when this leaf approximates them as |average|.
-      double sq_err = (iter.first.value() - average) *
-                      (iter.first.value() - average) * iter.second;
-      split->nats_remaining += sq_err * p_branch;
+    // node would actually use an average, but really it should match.
+    double total_value = 0.;
+    for (size_t target = 0; target < num_targets; target++)
+      total_value += target_values[target].value() * counts[target];
+    const double average = total_value / weight_along_branch;
+
+    for (size_t target = 0; target < num_targets; target++) {
+      if (!counts[target])
+        continue;
+      // Compute the squared error for all |counts[target]| counts that each
+      // have a value of |target_values[target]|, when this leaf approximates
+      // them as |average|.
+      const double error = target_values[target].value() - average;
+      split->nats_remaining += error * error * counts[target] * p_branch;
     }
   }
 }
 
 FeatureValue RandomTreeTrainer::FindSplitPoint_Numeric(
     size_t split_index,
-    const TrainingData& training_data,
+    const ColumnarTrainingData& training_data,
     const std::vector<size_t>& training_idx) {
   // We should not be given a training set of size 0, since there's no need to
   // check an empty split.
@@ -415,38 +465,29 @@ FeatureValue RandomTreeTrainer::FindSplitPoint_Numeric(
   // adjacent feature values), or (b) choose the best split point by drawing
   // uniformly over the range that contains our feature values.  (a) is
   // appropriate with RandomForest, while (b) is appropriate with ExtraTrees.
-  FeatureValue v_min = training_data[training_idx[0]].features[split_index];
-  FeatureValue v_max = training_data[training_idx[0]].features[split_index];
+  const std::vector<double>& column = training_data.numeric_column(split_index);
+  double v_min = column[training_idx[0]];
+  double v_max = v_min;
   for (size_t idx : training_idx) {
-    const LabelledExample& example = training_data[idx];
-    // Get the value of the |split_index|-th feature for
-    FeatureValue v_i = example.features[split_index];
-    if (v_i < v_min)
-      v_min = v_i;
-
-    if (v_i > v_max)
-      v_max = v_i;
+    v_min = std::min(v_min, column[idx]);
+    v_max = std::max(v_max, column[idx]);
   }
 
-  FeatureValue v_split;
   if (v_max == v_min) {
     // Pick |v_split| to return a trivial split, so that this ends up as a
     // leaf node anyway.
-    v_split = v_max;
-  } else {
-    // Choose a random split point.  Note that we want to end up with two
-    // buckets, so we don't have a trivial split.  By picking [v_min, v_max),
-    // |v_min| will always be in one bucket and |v_max| will always not be.
-    v_split = FeatureValue(
-        rng()->GenerateDouble(v_max.value() - v_min.value()) + v_min.value());
+    return FeatureValue(v_max);
   }
 
-  return v_split;
+  // Choose a random split point.  Note that we want to end up with two
+  // buckets, so we don't have a trivial split.  By picking [v_min, v_max),
+  // |v_min| will always be in one bucket and |v_max| will always not be.
+  return FeatureValue(rng()->GenerateDouble(v_max - v_min) + v_min);
 }
 
-FeatureValue RandomTreeTrainer::FindSplitPoint_Nominal(
+ColumnarTrainingData::ValueIndex RandomTreeTrainer::FindSplitPoint_Nominal(
     size_t split_index,
-    const TrainingData& training_data,
+    const ColumnarTrainingData& training_data,
     const std::vector<size_t>& training_idx) {
   // We should not be given a training set of size 0, since there's no need to
   // check an empty split.
@@ -467,18 +508,20 @@ FeatureValue RandomTreeTrainer::FindSplitPoint_Nominal(
   // trivial features which will be removed from consideration early (we never
   // consider features with only one value), and the != branch won't have any
   // "Yes" values for us to pick at a lower level.
-  std::set<FeatureValue> values;
-  for (size_t idx : training_idx) {
-    const LabelledExample& example = training_data[idx];
-    values.insert(example.features[split_index]);
-  }
+  //
+  // The values are interned in order, so sorting their indices sorts them the
+  // same way as the values.
+  const std::vector<ColumnarTrainingData::ValueIndex>& column =
+      training_data.nominal_column(split_index);
+  std::vector<ColumnarTrainingData::ValueIndex> values;
+  values.reserve(training_idx.size());
+  for (size_t idx : training_idx)
+    values.push_back(column[idx]);
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
 
   // Select one uniformly at random.
-  size_t which = rng()->Generate(values.size());
-  auto it = values.begin();
-  for (; which > 0; it++, which--)
-    ;
-  return *it;
+  return values[rng()->Generate(values.size())];
 }
 
 }  // namespace learning
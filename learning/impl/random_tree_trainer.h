@@ -6,13 +6,14 @@
 #define MEDIA_LEARNING_IMPL_RANDOM_TREE_TRAINER_H_
 
 #include <limits>
-#include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "base/component_export.h"
 #include "base/macros.h"
 #include "media/learning/common/learning_task.h"
+#include "media/learning/impl/columnar_training_data.h"
 #include "media/learning/impl/random_number_generator.h"
 #include "media/learning/impl/training_algorithm.h"
 
@@ -90,17 +91,28 @@ class COMPONENT_EXPORT(LEARNING_IMPL) RandomTreeTrainer
              const TrainingData& examples,
              TrainedModelCB model_cb) override;
 
+  // Train on all examples, and return the tree.  Unlike Train(), this doesn't
+  // need a task runner, so it may be called on any thread.
+  std::unique_ptr<Model> TrainTree(const LearningTask& task,
+                                   const TrainingData& examples);
+
+  // Same as above, for examples that have already been stored by column.
+  // Training many trees on the same data should use this, so that the data
+  // is only converted once.
+  std::unique_ptr<Model> TrainTree(const LearningTask& task,
+                                   const ColumnarTrainingData& examples);
+
  private:
   // Train on the subset |training_idx|.
   std::unique_ptr<Model> Train(const LearningTask& task,
-                               const TrainingData& examples,
+                               const ColumnarTrainingData& examples,
                                const std::vector<size_t>& training_idx);
 
   // Set of feature indices.
   using FeatureSet = std::set<int>;
 
-  // Information about a proposed split, and the training sets that would result
-  // from that split.
+  // Information about a proposed split.  Branch 0 is for examples that fail
+  // the split's test, and branch 1 is for those that pass it.
   struct Split {
     Split();
     explicit Split(int index);
@@ -117,69 +129,66 @@ class COMPONENT_EXPORT(LEARNING_IMPL) RandomTreeTrainer
     // Feature index to split on.
     size_t split_index = 0;
 
-    // For numeric splits, branch 0 is <= |split_point|, and 1 is > .
+    // For numeric splits, branch 0 is <= |split_point|, and 1 is > .  For
+    // nominal splits, branch 1 is == |split_point|, and 0 is != .
     FeatureValue split_point;
 
+    // For nominal splits, the index of |split_point| in the feature's
+    // dictionary.
+    ColumnarTrainingData::ValueIndex split_value_index = 0;
+
     // Expected nats needed to compute the class, given that we're at this
     // node in the tree.
     // "nat" == entropy measured with natural log rather than base-2.
     double nats_remaining = std::numeric_limits<double>::infinity();
 
-    // Per-branch (i.e. per-child node) information about this split.
-    struct BranchInfo {
-      explicit BranchInfo();
-      BranchInfo(const BranchInfo& rhs) = delete;
-      BranchInfo(BranchInfo&& rhs);
-      ~BranchInfo();
-
-      BranchInfo& operator=(const BranchInfo& rhs) = delete;
-      BranchInfo& operator=(BranchInfo&& rhs) = delete;
-
-      // Training set for this branch of the split.  |training_idx| holds the
-      // indices that we're using out of our training data.
-      std::vector<size_t> training_idx;
-
-      // Number of occurances of each target value in |training_data| along this
-      // branch of the split.
-      // This is a flat_map since we're likely to have a very small (e.g.,
-      // "true / "false") number of targets.
-      TargetHistogram target_histogram;
-    };
-
-    // [feature value at this split] = info about which examples take this
-    // branch of the split.
-    std::map<FeatureValue, BranchInfo> branch_infos;
+    // Number of branches that some example takes: 0, 1 or 2.
+    int num_branches = 0;
   };
 
-  // Build this node from |training_data|.  |used_set| is the set of features
-  // that we already used higher in the tree.
+  // Build this node from the examples |training_idx| of |training_data|.
+  // |used_set| is the set of features that we already used higher in the
+  // tree.
   std::unique_ptr<Model> Build(const LearningTask& task,
-                               const TrainingData& training_data,
+                               const ColumnarTrainingData& training_data,
                                const std::vector<size_t>& training_idx,
                                const FeatureSet& used_set);
 
   // Compute and return a split of |training_data| on the |index|-th feature.
   Split ConstructSplit(const LearningTask& task,
-                       const TrainingData& training_data,
+                       const ColumnarTrainingData& training_data,
                        const std::vector<size_t>& training_idx,
                        int index);
 
   // Fill in |nats_remaining| for |split| for a nominal target.
-  // |total_incoming_weight| is the total weight of all instances coming into
-  // the node that we're splitting.
-  void ComputeSplitScore_Nominal(Split* split, double total_incoming_weight);
-
-  // Fill in |nats_remaining| for |split| for a numeric target.
-  void ComputeSplitScore_Numeric(Split* split, double total_incoming_weight);
-
-  // Compute the split point for |training_data| for a nominal feature.
-  FeatureValue FindSplitPoint_Nominal(size_t index,
-                                      const TrainingData& training_data,
-                                      const std::vector<size_t>& training_idx);
+  // |branch_counts| holds, for each branch in turn, the total weight of each
+  // target value along that branch, indexed like the training data's
+  // target_values().  |branch_weights| holds the total weight along each
+  // branch, and |total_incoming_weight| is the total weight of all instances
+  // coming into the node that we're splitting.
+  void ComputeSplitScore_Nominal(Split* split,
+                                 const std::vector<double>& branch_counts,
+                                 const double branch_weights[2],
+                                 double total_incoming_weight);
+
+  // Fill in |nats_remaining| for |split| for a numeric target.  |target_values|
+  // are the values that |branch_counts| is indexed by.
+  void ComputeSplitScore_Numeric(Split* split,
+                                 const std::vector<TargetValue>& target_values,
+                                 const std::vector<double>& branch_counts,
+                                 const double branch_weights[2],
+                                 double total_incoming_weight);
+
+  // Compute the split point for |training_data| for a nominal feature, and
+  // return its index in the feature's dictionary.
+  ColumnarTrainingData::ValueIndex FindSplitPoint_Nominal(
+      size_t index,
+      const ColumnarTrainingData& training_data,
+      const std::vector<size_t>& training_idx);
 
   // Compute the split point for |training_data| for a numeric feature.
   FeatureValue FindSplitPoint_Numeric(size_t index,
-                                      const TrainingData& training_data,
+                                      const ColumnarTrainingData& training_data,
                                       const std::vector<size_t>& training_idx);
 };
 
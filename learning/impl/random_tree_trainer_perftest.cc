@@ -0,0 +1,133 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "media/learning/impl/columnar_training_data.h"
+#include "media/learning/impl/random_tree_trainer.h"
+#include "media/learning/impl/test_random_number_generator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+namespace learning {
+
+namespace {
+
+// Number of features of each example.
+constexpr size_t kNumFeatures = 16;
+
+// Number of distinct values of each nominal feature.
+constexpr size_t kNumNominalValues = 20;
+
+// Number of trees trained in each measurement.
+constexpr size_t kNumTrees = 20;
+
+}  // namespace
+
+class RandomTreeTrainerPerfTest : public testing::Test {
+ public:
+  RandomTreeTrainerPerfTest() : rng_(0), trainer_(&rng_) {}
+
+ protected:
+  void SetupFeatures(LearningTask::Ordering ordering) {
+    task_.feature_descriptions.clear();
+    for (size_t i = 0; i < kNumFeatures; i++) {
+      LearningTask::ValueDescription desc;
+      desc.ordering = ordering;
+      task_.feature_descriptions.push_back(desc);
+    }
+  }
+
+  // Returns |num_examples| examples of random features, with a target that
+  // depends on a few of them plus some noise.  Nominal features take one of
+  // a few hashed strings, as they would in a real task.
+  TrainingData MakeTrainingData(size_t num_examples) {
+    const bool is_numeric = task_.feature_descriptions[0].ordering ==
+                            LearningTask::Ordering::kNumeric;
+    TrainingData data;
+    for (size_t i = 0; i < num_examples; i++) {
+      FeatureVector features;
+      double score = rng_.GenerateDouble(0.5);
+      for (size_t f = 0; f < kNumFeatures; f++) {
+        if (is_numeric) {
+          const double value = rng_.GenerateDouble(1.0);
+          features.push_back(FeatureValue(value));
+          if (f < 3)
+            score += value;
+        } else {
+          const size_t value = rng_.Generate(kNumNominalValues);
+          features.push_back(
+              FeatureValue("value_" + base::NumberToString(value)));
+          if (f < 3)
+            score += value % 2;
+        }
+      }
+      data.push_back(
+          LabelledExample(std::move(features), TargetValue(score > 1.5)));
+    }
+    return data;
+  }
+
+  // Reports the time to store a window of |num_examples| examples by column,
+  // and then to train a tree on it.
+  void RunTrainingTest(const std::string& story, size_t num_examples) {
+    const TrainingData data = MakeTrainingData(num_examples);
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    const ColumnarTrainingData columnar_data(task_, data);
+    const base::TimeDelta conversion_time = base::TimeTicks::Now() - start;
+
+    size_t num_predicted_targets = 0;
+    start = base::TimeTicks::Now();
+    for (size_t i = 0; i < kNumTrees; i++) {
+      std::unique_ptr<Model> tree = trainer_.TrainTree(task_, columnar_data);
+      // Keep the result, so that the work isn't optimized away.
+      num_predicted_targets +=
+          tree->PredictDistribution(data[i].features).size();
+    }
+    const base::TimeDelta training_time = base::TimeTicks::Now() - start;
+
+    perf_test::PerfResultReporter reporter("random_tree_trainer", story);
+    reporter.RegisterImportantMetric("_columnar_conversion", "ms");
+    reporter.RegisterImportantMetric("_time_per_tree", "ms");
+    reporter.AddResult("_columnar_conversion",
+                       conversion_time.InMillisecondsF());
+    reporter.AddResult("_time_per_tree",
+                       training_time.InMillisecondsF() / kNumTrees);
+    EXPECT_GT(num_predicted_targets, 0u);
+  }
+
+  TestRandomNumberGenerator rng_;
+  RandomTreeTrainer trainer_;
+  LearningTask task_;
+};
+
+TEST_F(RandomTreeTrainerPerfTest, Numeric10kExamples) {
+  SetupFeatures(LearningTask::Ordering::kNumeric);
+  RunTrainingTest("numeric_10k_examples", 10000);
+}
+
+TEST_F(RandomTreeTrainerPerfTest, Numeric50kExamples) {
+  SetupFeatures(LearningTask::Ordering::kNumeric);
+  RunTrainingTest("numeric_50k_examples", 50000);
+}
+
+TEST_F(RandomTreeTrainerPerfTest, Nominal10kExamples) {
+  SetupFeatures(LearningTask::Ordering::kUnordered);
+  RunTrainingTest("nominal_10k_examples", 10000);
+}
+
+TEST_F(RandomTreeTrainerPerfTest, Nominal50kExamples) {
+  SetupFeatures(LearningTask::Ordering::kUnordered);
+  RunTrainingTest("nominal_50k_examples", 50000);
+}
+
+}  // namespace learning
+}  // namespace media
@@ -4,6 +4,8 @@
 
 #include "media/mojo/services/mojo_media_log.h"
 
+#include <utility>
+
 #include "base/bind.h"
 #include "base/logging.h"
 #include "base/threading/sequenced_task_runner_handle.h"
@@ -14,7 +16,9 @@ MojoMediaLog::MojoMediaLog(
     mojo::PendingRemote<mojom::MediaLog> remote_media_log,
     scoped_refptr<base::SequencedTaskRunner> task_runner)
     : remote_media_log_(std::move(remote_media_log)),
-      task_runner_(std::move(task_runner)) {
+      task_runner_(std::move(task_runner)),
+      pending_records_(std::make_unique<MediaLogRecordBuffer>(kLogLimit)),
+      sending_records_(std::make_unique<MediaLogRecordBuffer>(kLogLimit)) {
   DVLOG(1) << __func__;
 }
 
@@ -24,28 +28,53 @@ MojoMediaLog::~MojoMediaLog() {
   // anything that was cloned from us.  Effectively, we're a log that just
   // happens to operate via mojo.
   InvalidateLog();
+
+  // Send what is still queued, since the posted send won't run anymore.  This
+  // matters, for example, when we're logging why a VideoDecoder failed to
+  // initialize, since it will be destroyed synchronously when Initialize
+  // returns.
+  if (task_runner_->RunsTasksInCurrentSequence())
+    SendPendingRecords();
 }
 
 void MojoMediaLog::AddLogRecordLocked(std::unique_ptr<MediaLogRecord> event) {
   DVLOG(2) << __func__;
   DCHECK(event);
 
-  // Don't post unless we need to.  Otherwise, we can order a log entry after
-  // our own destruction.  While safe, this loses the message.  This can happen,
-  // for example, when we're logging why a VideoDecoder failed to initialize.
-  // It will be destroyed synchronously when Initialize returns.
-  //
-  // Also, we post here, so this is the base case.  :)
-  if (task_runner_->RunsTasksInCurrentSequence()) {
-    remote_media_log_->AddLogRecord(*event);
+  base::AutoLock auto_lock(pending_lock_);
+  pending_records_->Add(std::move(event));
+  ScheduleSendLocked();
+}
+
+void MojoMediaLog::AddBinaryRecordLocked(const MediaLogBinaryRecord& record) {
+  DVLOG(2) << __func__;
+
+  base::AutoLock auto_lock(pending_lock_);
+  pending_records_->Add(record);
+  ScheduleSendLocked();
+}
+
+void MojoMediaLog::ScheduleSendLocked() {
+  if (send_scheduled_)
     return;
+
+  send_scheduled_ = true;
+  task_runner_->PostTask(FROM_HERE,
+                         base::BindOnce(&MojoMediaLog::SendPendingRecords,
+                                        weak_ptr_factory_.GetWeakPtr()));
+}
+
+void MojoMediaLog::SendPendingRecords() {
+  DCHECK(task_runner_->RunsTasksInCurrentSequence());
+
+  {
+    base::AutoLock auto_lock(pending_lock_);
+    send_scheduled_ = false;
+    std::swap(pending_records_, sending_records_);
   }
 
-  // From other threads, we have little choice.
-  task_runner_->PostTask(
-      FROM_HERE,
-      base::BindOnce(&MojoMediaLog::AddLogRecord,
-                     weak_ptr_factory_.GetWeakPtr(), std::move(event)));
+  for (const auto& record : sending_records_->TakeRecords(id()))
+    remote_media_log_->AddLogRecord(*record);
 }
 
 }  // namespace media
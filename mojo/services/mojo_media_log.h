@@ -9,8 +9,11 @@
 
 #include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/synchronization/lock.h"
 #include "base/task/sequenced_task_runner.h"
+#include "base/thread_annotations.h"
 #include "media/base/media_log.h"
+#include "media/base/media_log_record_buffer.h"
 #include "media/mojo/mojom/media_log.mojom.h"
 #include "mojo/public/cpp/bindings/pending_remote.h"
 #include "mojo/public/cpp/bindings/remote.h"
@@ -27,16 +30,35 @@ class MojoMediaLog final : public MediaLog {
   ~MojoMediaLog() final;
 
  protected:
-  // MediaLog implementation.  May be called from any thread, but will only
-  // use |remote_media_log_| on |task_runner_|.
+  // MediaLog implementation.  May be called from any thread.  Records are
+  // queued, and sent to |remote_media_log_| in batches on |task_runner_|.
+  // Binary records are only converted when their batch is sent.
   void AddLogRecordLocked(std::unique_ptr<MediaLogRecord> event) override;
+  void AddBinaryRecordLocked(const MediaLogBinaryRecord& record) override;
 
  private:
+  // Posts SendPendingRecords(), unless it is already posted.
+  void ScheduleSendLocked() EXCLUSIVE_LOCKS_REQUIRED(pending_lock_);
+
+  // Converts the queued records, and sends them oldest first.
+  void SendPendingRecords();
+
   mojo::Remote<mojom::MediaLog> remote_media_log_;
 
   // The mojo service thread on which we'll access |remote_media_log_|.
   scoped_refptr<base::SequencedTaskRunner> task_runner_;
 
+  // Records that have not been sent yet, up to MediaLog::kLogLimit of them.
+  // SendPendingRecords() swaps them with |sending_records_|, so that they are
+  // converted without holding |pending_lock_|.
+  base::Lock pending_lock_;
+  std::unique_ptr<MediaLogRecordBuffer> pending_records_
+      GUARDED_BY(pending_lock_);
+  bool send_scheduled_ GUARDED_BY(pending_lock_) = false;
+
+  // Only used on |task_runner_|.
+  std::unique_ptr<MediaLogRecordBuffer> sending_records_;
+
   base::WeakPtrFactory<MojoMediaLog> weak_ptr_factory_{this};
 };
 
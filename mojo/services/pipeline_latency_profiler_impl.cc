@@ -0,0 +1,57 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/mojo/services/pipeline_latency_profiler_impl.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "media/base/pipeline_latency_profiler.h"
+#include "mojo/public/cpp/bindings/self_owned_receiver.h"
+
+namespace media {
+
+// static
+void PipelineLatencyProfilerImpl::Create(
+    mojo::PendingReceiver<mojom::PipelineLatencyProfiler> receiver) {
+  mojo::MakeSelfOwnedReceiver(
+      std::make_unique<PipelineLatencyProfilerImpl>(
+          media::PipelineLatencyProfiler::GetInstance()),
+      std::move(receiver));
+}
+
+PipelineLatencyProfilerImpl::PipelineLatencyProfilerImpl(
+    media::PipelineLatencyProfiler* profiler)
+    : profiler_(profiler) {}
+
+PipelineLatencyProfilerImpl::~PipelineLatencyProfilerImpl() = default;
+
+void PipelineLatencyProfilerImpl::SetEnabled(bool enabled) {
+  profiler_->SetEnabled(enabled);
+}
+
+void PipelineLatencyProfilerImpl::Reset() {
+  profiler_->Reset();
+}
+
+void PipelineLatencyProfilerImpl::GetStageLatencies(
+    GetStageLatenciesCallback callback) {
+  std::vector<mojom::PipelineStageLatencyPtr> latencies;
+  for (const auto& kv : profiler_->GetHistograms()) {
+    const LatencyHistogram& histogram = kv.second;
+    latencies.push_back(mojom::PipelineStageLatency::New(
+        DemuxerStream::GetTypeName(kv.first.first),
+        GetPipelineStageName(kv.first.second), histogram.count(),
+        histogram.min(), histogram.mean(), histogram.Percentile(50),
+        histogram.Percentile(90), histogram.Percentile(99), histogram.max()));
+  }
+  std::move(callback).Run(std::move(latencies));
+}
+
+void PipelineLatencyProfilerImpl::DumpToJSON(DumpToJSONCallback callback) {
+  std::move(callback).Run(profiler_->ToJSON());
+}
+
+}  // namespace media
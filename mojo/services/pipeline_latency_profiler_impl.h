@@ -0,0 +1,44 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_MOJO_SERVICES_PIPELINE_LATENCY_PROFILER_IMPL_H_
+#define MEDIA_MOJO_SERVICES_PIPELINE_LATENCY_PROFILER_IMPL_H_
+
+#include "media/mojo/mojom/pipeline_latency_profiler.mojom.h"
+#include "media/mojo/services/media_mojo_export.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+
+namespace media {
+
+class PipelineLatencyProfiler;
+
+// Exposes the PipelineLatencyProfiler of the process it runs in. Must be bound
+// in the process whose media pipelines are being profiled, normally the
+// renderer.
+class MEDIA_MOJO_EXPORT PipelineLatencyProfilerImpl final
+    : public mojom::PipelineLatencyProfiler {
+ public:
+  static void Create(
+      mojo::PendingReceiver<mojom::PipelineLatencyProfiler> receiver);
+
+  explicit PipelineLatencyProfilerImpl(
+      media::PipelineLatencyProfiler* profiler);
+  PipelineLatencyProfilerImpl(const PipelineLatencyProfilerImpl&) = delete;
+  PipelineLatencyProfilerImpl& operator=(const PipelineLatencyProfilerImpl&) =
+      delete;
+  ~PipelineLatencyProfilerImpl() final;
+
+  // mojom::PipelineLatencyProfiler implementation.
+  void SetEnabled(bool enabled) final;
+  void Reset() final;
+  void GetStageLatencies(GetStageLatenciesCallback callback) final;
+  void DumpToJSON(DumpToJSONCallback callback) final;
+
+ private:
+  media::PipelineLatencyProfiler* const profiler_;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_MOJO_SERVICES_PIPELINE_LATENCY_PROFILER_IMPL_H_
@@ -0,0 +1,110 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/mojo/services/pipeline_latency_profiler_impl.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/json/json_reader.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
+#include "media/base/pipeline_latency_profiler.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+class PipelineLatencyProfilerImplTest : public testing::Test {
+ public:
+  PipelineLatencyProfilerImplTest() {
+    PipelineLatencyProfilerImpl::Create(
+        profiler_remote_.BindNewPipeAndPassReceiver());
+  }
+
+  ~PipelineLatencyProfilerImplTest() override {
+    profiler()->SetEnabled(false);
+    profiler()->Reset();
+  }
+
+  PipelineLatencyProfiler* profiler() {
+    return PipelineLatencyProfiler::GetInstance();
+  }
+
+  std::vector<mojom::PipelineStageLatencyPtr> GetStageLatencies() {
+    std::vector<mojom::PipelineStageLatencyPtr> result;
+    base::RunLoop run_loop;
+    profiler_remote_->GetStageLatencies(
+        base::BindOnce(
+            [](std::vector<mojom::PipelineStageLatencyPtr>* result,
+               std::vector<mojom::PipelineStageLatencyPtr> latencies) {
+              *result = std::move(latencies);
+            },
+            &result)
+            .Then(run_loop.QuitClosure()));
+    run_loop.Run();
+    return result;
+  }
+
+ protected:
+  base::test::TaskEnvironment task_environment_;
+  mojo::Remote<mojom::PipelineLatencyProfiler> profiler_remote_;
+};
+
+TEST_F(PipelineLatencyProfilerImplTest, SetEnabledAndReset) {
+  profiler_remote_->SetEnabled(true);
+  profiler_remote_.FlushForTesting();
+  EXPECT_TRUE(PipelineLatencyProfiler::IsEnabled());
+
+  profiler()->Record(DemuxerStream::AUDIO, PipelineStage::kRender,
+                     base::Microseconds(100));
+  EXPECT_EQ(profiler()->GetHistograms().size(), 1u);
+
+  profiler_remote_->Reset();
+  profiler_remote_->SetEnabled(false);
+  profiler_remote_.FlushForTesting();
+  EXPECT_FALSE(PipelineLatencyProfiler::IsEnabled());
+  EXPECT_TRUE(profiler()->GetHistograms().empty());
+}
+
+TEST_F(PipelineLatencyProfilerImplTest, GetStageLatencies) {
+  profiler()->SetEnabled(true);
+  profiler()->Record(DemuxerStream::VIDEO, PipelineStage::kReadyQueue,
+                     base::Milliseconds(2));
+  profiler()->Record(DemuxerStream::VIDEO, PipelineStage::kReadyQueue,
+                     base::Milliseconds(4));
+
+  std::vector<mojom::PipelineStageLatencyPtr> latencies = GetStageLatencies();
+  ASSERT_EQ(latencies.size(), 1u);
+  EXPECT_EQ(latencies[0]->stream_type, "video");
+  EXPECT_EQ(latencies[0]->stage, "ready_queue");
+  EXPECT_EQ(latencies[0]->count, 2u);
+  EXPECT_EQ(latencies[0]->min, base::Milliseconds(2));
+  EXPECT_EQ(latencies[0]->mean, base::Milliseconds(3));
+  EXPECT_EQ(latencies[0]->max, base::Milliseconds(4));
+}
+
+TEST_F(PipelineLatencyProfilerImplTest, DumpToJSON) {
+  profiler()->SetEnabled(true);
+  profiler()->Record(DemuxerStream::AUDIO, PipelineStage::kDecode,
+                     base::Microseconds(10));
+
+  std::string json;
+  base::RunLoop run_loop;
+  profiler_remote_->DumpToJSON(
+      base::BindOnce(
+          [](std::string* json, const std::string& result) { *json = result; },
+          &json)
+          .Then(run_loop.QuitClosure()));
+  run_loop.Run();
+
+  absl::optional<base::Value> value = base::JSONReader::Read(json);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(value->FindDoublePath("audio.decode.count"), 1);
+  EXPECT_EQ(value->FindDoublePath("audio.decode.p99_us"), 10);
+}
+
+}  // namespace media
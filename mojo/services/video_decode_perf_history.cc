@@ -159,6 +159,49 @@ void VideoDecodePerfHistory::GetPerfInfo(mojom::PredictionFeaturesPtr features,
                                 std::move(got_info_cb)));
 }
 
+void VideoDecodePerfHistory::GetPerfInfoBatch(
+    std::vector<mojom::PredictionFeaturesPtr> features,
+    GetPerfInfoBatchCallback got_infos_cb) {
+  DVLOG(3) << __func__ << " " << features.size() << " configs";
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (db_init_status_ == FAILED) {
+    // Optimistically claim perf is both smooth and power efficient.
+    std::vector<mojom::VideoDecodePerfInfoPtr> infos;
+    for (size_t i = 0; i < features.size(); i++)
+      infos.push_back(mojom::VideoDecodePerfInfo::New(true, true));
+    std::move(got_infos_cb).Run(std::move(infos));
+    return;
+  }
+
+  // Defer this request until the DB is initialized.
+  if (db_init_status_ != COMPLETE) {
+    init_deferred_api_calls_.push_back(
+        base::BindOnce(&VideoDecodePerfHistory::GetPerfInfoBatch,
+                       weak_ptr_factory_.GetWeakPtr(), std::move(features),
+                       std::move(got_infos_cb)));
+    InitDatabase();
+    return;
+  }
+
+  std::vector<VideoDecodeStatsDB::VideoDescKey> video_keys;
+  video_keys.reserve(features.size());
+  for (const auto& config : features) {
+    DCHECK_NE(config->profile, VIDEO_CODEC_PROFILE_UNKNOWN);
+    DCHECK_GT(config->frames_per_sec, 0);
+    DCHECK(config->video_size.width() > 0 && config->video_size.height() > 0);
+    video_keys.push_back(VideoDecodeStatsDB::VideoDescKey::MakeBucketedKey(
+        config->profile, config->video_size, config->frames_per_sec,
+        config->key_system, config->use_hw_secure_codecs));
+  }
+
+  db_->GetDecodeStatsBatch(
+      video_keys,
+      base::BindOnce(&VideoDecodePerfHistory::OnGotStatsForBatchRequest,
+                     weak_ptr_factory_.GetWeakPtr(), video_keys,
+                     std::move(got_infos_cb)));
+}
+
 void VideoDecodePerfHistory::AssessStats(
     const VideoDecodeStatsDB::VideoDescKey& key,
     const VideoDecodeStatsDB::DecodeStatsEntry* stats,
@@ -231,6 +274,34 @@ void VideoDecodePerfHistory::OnGotStatsForRequest(
   std::move(got_info_cb).Run(is_smooth, is_power_efficient);
 }
 
+void VideoDecodePerfHistory::OnGotStatsForBatchRequest(
+    const std::vector<VideoDecodeStatsDB::VideoDescKey>& video_keys,
+    GetPerfInfoBatchCallback got_infos_cb,
+    bool database_success,
+    std::vector<std::unique_ptr<VideoDecodeStatsDB::DecodeStatsEntry>>
+        stats) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(got_infos_cb);
+  DCHECK_EQ(db_init_status_, COMPLETE);
+  DCHECK_EQ(video_keys.size(), stats.size());
+  DVLOG(3) << __func__ << " " << video_keys.size() << " configs"
+           << (database_success ? "" : ", query FAILED");
+
+  // As for GetPerfInfo(), configs without stats are assumed to perform well.
+  std::vector<mojom::VideoDecodePerfInfoPtr> infos;
+  infos.reserve(video_keys.size());
+  for (size_t i = 0; i < video_keys.size(); i++) {
+    bool is_smooth = false;
+    bool is_power_efficient = false;
+    AssessStats(video_keys[i], stats[i].get(), &is_smooth,
+                &is_power_efficient);
+    infos.push_back(
+        mojom::VideoDecodePerfInfo::New(is_smooth, is_power_efficient));
+  }
+
+  std::move(got_infos_cb).Run(std::move(infos));
+}
+
 VideoDecodePerfHistory::SaveCallback VideoDecodePerfHistory::GetSaveCallback() {
   return base::BindRepeating(&VideoDecodePerfHistory::SavePerfRecord,
                              weak_ptr_factory_.GetWeakPtr());
@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/metrics/field_trial_params.h"
@@ -74,6 +75,8 @@ class MEDIA_MOJO_EXPORT VideoDecodePerfHistory
   // mojom::VideoDecodePerfHistory implementation:
   void GetPerfInfo(mojom::PredictionFeaturesPtr features,
                    GetPerfInfoCallback got_info_cb) override;
+  void GetPerfInfoBatch(std::vector<mojom::PredictionFeaturesPtr> features,
+                        GetPerfInfoBatchCallback got_infos_cb) override;
 
   // Provides a callback for saving a stats record for the described stream.
   // This callback will silently fail if called after |this| is destroyed.
@@ -145,6 +148,16 @@ class MEDIA_MOJO_EXPORT VideoDecodePerfHistory
       bool database_success,
       std::unique_ptr<VideoDecodeStatsDB::DecodeStatsEntry> stats);
 
+  // Internal callback for database queries made from GetPerfInfoBatch() (mojo
+  // API). Assesses performance for each of |video_keys| and passes results to
+  // |got_infos_cb|.
+  void OnGotStatsForBatchRequest(
+      const std::vector<VideoDecodeStatsDB::VideoDescKey>& video_keys,
+      GetPerfInfoBatchCallback got_infos_cb,
+      bool database_success,
+      std::vector<std::unique_ptr<VideoDecodeStatsDB::DecodeStatsEntry>>
+          stats);
+
   // Internal callback for database queries made from SavePerfRecord(). Compares
   // past performance to this latest record as means of "grading" the accuracy
   // of the GetPerfInfo() API. Comparison is recorded via UKM. Then saves the
@@ -5,6 +5,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/memory/ptr_util.h"
@@ -181,6 +183,18 @@ class VideoDecodePerfHistoryTest : public testing::Test {
   MOCK_METHOD2(MockGetPerfInfoCB,
                void(bool is_smooth, bool is_power_efficient));
 
+  // Tests may set this as the callback for
+  // VideoDecodePerfHistory::GetPerfInfoBatch() to check the results of the
+  // call. Each result is an (is_smooth, is_power_efficient) pair.
+  void GetPerfInfoBatchCB(std::vector<mojom::VideoDecodePerfInfoPtr> infos) {
+    std::vector<std::pair<bool, bool>> results;
+    for (const auto& info : infos)
+      results.emplace_back(info->is_smooth, info->is_power_efficient);
+    MockGetPerfInfoBatchCB(results);
+  }
+  MOCK_METHOD1(MockGetPerfInfoBatchCB,
+               void(const std::vector<std::pair<bool, bool>>& results));
+
   // Tests should EXPECT_CALL this method prior to ClearHistory() to know that
   // the operation has completed.
   MOCK_METHOD0(MockOnClearedHistory, void());
@@ -442,6 +456,75 @@ TEST_P(VideoDecodePerfHistoryParamTest, GetPerfInfo_Smooth) {
   }
 }
 
+TEST_P(VideoDecodePerfHistoryParamTest, GetPerfInfoBatch) {
+  // NOTE: The when the DB initialization is deferred, All EXPECT_CALLs are then
+  // delayed until we db_->CompleteInitialize(). testing::InSequence enforces
+  // that EXPECT_CALLs arrive in top-to-bottom order.
+  PerfHistoryTestParams params = GetParam();
+  testing::InSequence dummy;
+
+  // Complete initialization in advance of API calls when not asked to defer.
+  if (!params.defer_initialize)
+    PreInitializeDB(/* success */ true);
+
+  // Add a smooth and a "not smooth" record, as in GetPerfInfo_Smooth.
+  const VideoCodecProfile kKnownProfile = VP9PROFILE_PROFILE0;
+  const VideoCodecProfile kUnknownProfile = VP9PROFILE_PROFILE2;
+  const gfx::Size kKownSize(100, 200);
+  const int kSmoothFrameRate = 30;
+  const int kNotSmoothFrameRate = 90;
+  const int kFramesDecoded = 1000;
+  const int kPowerEfficientFramesDecoded = kFramesDecoded;
+  const int kNotPowerEfficientFramesDecoded = 0;
+  const int kSmoothFramesDropped =
+      kFramesDecoded * GetMaxSmoothDroppedFramesPercent();
+  const int kNotSmoothFramesDropped =
+      kFramesDecoded * GetMaxSmoothDroppedFramesPercent() + 1;
+
+  SavePerfRecord(UkmVerifcation::kSaveTriggersUkm, kOrigin, kIsTopFrame,
+                 MakeFeatures(kKnownProfile, kKownSize, kSmoothFrameRate,
+                              params.key_system, params.use_hw_secure_codecs),
+                 MakeTargets(kFramesDecoded, kSmoothFramesDropped,
+                             kPowerEfficientFramesDecoded),
+                 kPlayerId);
+  SavePerfRecord(UkmVerifcation::kSaveTriggersUkm, kOrigin, kIsTopFrame,
+                 MakeFeatures(kKnownProfile, kKownSize, kNotSmoothFrameRate,
+                              params.key_system, params.use_hw_secure_codecs),
+                 MakeTargets(kFramesDecoded, kNotSmoothFramesDropped,
+                             kNotPowerEfficientFramesDecoded),
+                 kPlayerId);
+
+  // Verify the batch gives the same answers as GetPerfInfo() would, in the
+  // order of the configs, including the optimistic answer for an unknown one.
+  std::vector<mojom::PredictionFeaturesPtr> features;
+  features.push_back(MakeFeaturesPtr(kUnknownProfile, kKownSize,
+                                     kSmoothFrameRate, params.key_system,
+                                     params.use_hw_secure_codecs));
+  features.push_back(MakeFeaturesPtr(kKnownProfile, kKownSize,
+                                     kNotSmoothFrameRate, params.key_system,
+                                     params.use_hw_secure_codecs));
+  features.push_back(MakeFeaturesPtr(kKnownProfile, kKownSize,
+                                     kSmoothFrameRate, params.key_system,
+                                     params.use_hw_secure_codecs));
+  EXPECT_CALL(*this,
+              MockGetPerfInfoBatchCB(testing::ElementsAre(
+                  std::make_pair(kIsSmooth, kIsPowerEfficient),
+                  std::make_pair(kIsNotSmooth, kIsNotPowerEfficient),
+                  std::make_pair(kIsSmooth, kIsPowerEfficient))));
+  perf_history_->GetPerfInfoBatch(
+      std::move(features),
+      base::BindOnce(&VideoDecodePerfHistoryParamTest::GetPerfInfoBatchCB,
+                     base::Unretained(this)));
+
+  // Complete successful deferred DB initialization (see comment at top of test)
+  if (params.defer_initialize) {
+    GetFakeDB()->CompleteInitialize(true);
+
+    // Allow initialize-deferred API calls to complete.
+    task_environment_.RunUntilIdle();
+  }
+}
+
 TEST_P(VideoDecodePerfHistoryParamTest, GetPerfInfo_PowerEfficient) {
   // NOTE: The when the DB initialization is deferred, All EXPECT_CALLs are then
   // delayed until we db_->CompleteInitialize(). testing::InSequence enforces
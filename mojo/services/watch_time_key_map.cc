@@ -0,0 +1,41 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/mojo/services/watch_time_key_map.h"
+
+namespace media {
+
+WatchTimeKeyMap::WatchTimeKeyMap() = default;
+
+WatchTimeKeyMap::WatchTimeKeyMap(const WatchTimeKeyMap& rhs) = default;
+
+WatchTimeKeyMap& WatchTimeKeyMap::operator=(const WatchTimeKeyMap& rhs) =
+    default;
+
+WatchTimeKeyMap::~WatchTimeKeyMap() = default;
+
+base::TimeDelta& WatchTimeKeyMap::operator[](WatchTimeKey key) {
+  const size_t index = Index(key);
+  if (!present_[index]) {
+    present_.set(index);
+    values_[index] = base::TimeDelta();
+  }
+  return values_[index];
+}
+
+void WatchTimeKeyMap::erase(WatchTimeKey key) {
+  present_.reset(Index(key));
+}
+
+void WatchTimeKeyMap::clear() {
+  present_.reset();
+}
+
+size_t WatchTimeKeyMap::NextIndex(size_t index) const {
+  while (index < kWatchTimeKeyCount && !present_[index])
+    index++;
+  return index;
+}
+
+}  // namespace media
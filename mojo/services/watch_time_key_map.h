@@ -0,0 +1,100 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_MOJO_SERVICES_WATCH_TIME_KEY_MAP_H_
+#define MEDIA_MOJO_SERVICES_WATCH_TIME_KEY_MAP_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <bitset>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/time/time.h"
+#include "media/base/watch_time_keys.h"
+#include "media/mojo/services/media_mojo_export.h"
+
+namespace media {
+
+// Map from WatchTimeKey to base::TimeDelta, stored in fixed arrays indexed by
+// key.  There are only a few dozen keys, and every watch time report updates
+// several of them, so this never allocates and never searches.  Iterates in
+// key order, like base::flat_map.
+class MEDIA_MOJO_EXPORT WatchTimeKeyMap {
+ public:
+  using value_type = std::pair<WatchTimeKey, base::TimeDelta>;
+
+  // Iterates over the keys that are present.  Entries are returned by value.
+  class const_iterator {
+   public:
+    value_type operator*() const {
+      return {static_cast<WatchTimeKey>(index_), map_->values_[index_]};
+    }
+    const_iterator& operator++() {
+      index_ = map_->NextIndex(index_ + 1);
+      return *this;
+    }
+    bool operator==(const const_iterator& rhs) const {
+      return index_ == rhs.index_;
+    }
+    bool operator!=(const const_iterator& rhs) const {
+      return index_ != rhs.index_;
+    }
+
+   private:
+    friend class WatchTimeKeyMap;
+    const_iterator(const WatchTimeKeyMap* map, size_t index)
+        : map_(map), index_(index) {}
+
+    const WatchTimeKeyMap* map_;
+    size_t index_;
+  };
+
+  WatchTimeKeyMap();
+  WatchTimeKeyMap(const WatchTimeKeyMap& rhs);
+  WatchTimeKeyMap& operator=(const WatchTimeKeyMap& rhs);
+  ~WatchTimeKeyMap();
+
+  const_iterator begin() const { return const_iterator(this, NextIndex(0)); }
+  const_iterator end() const {
+    return const_iterator(this, kWatchTimeKeyCount);
+  }
+
+  bool empty() const { return present_.none(); }
+  size_t size() const { return present_.count(); }
+
+  bool contains(WatchTimeKey key) const { return present_[Index(key)]; }
+
+  // Returns the value for |key|, which must be present.
+  base::TimeDelta at(WatchTimeKey key) const {
+    DCHECK(contains(key));
+    return values_[Index(key)];
+  }
+
+  // Returns the value for |key|, adding it with a zero value if it isn't
+  // present.
+  base::TimeDelta& operator[](WatchTimeKey key);
+
+  void erase(WatchTimeKey key);
+  void clear();
+
+ private:
+  static size_t Index(WatchTimeKey key) {
+    const size_t index = static_cast<size_t>(key);
+    DCHECK_LT(index, kWatchTimeKeyCount);
+    return index;
+  }
+
+  // Returns the first index at or after |index| whose key is present, or
+  // kWatchTimeKeyCount if there is none.
+  size_t NextIndex(size_t index) const;
+
+  std::bitset<kWatchTimeKeyCount> present_;
+  std::array<base::TimeDelta, kWatchTimeKeyCount> values_;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_MOJO_SERVICES_WATCH_TIME_KEY_MAP_H_
@@ -0,0 +1,65 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/mojo/services/watch_time_key_map.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+TEST(WatchTimeKeyMapTest, StartsEmpty) {
+  WatchTimeKeyMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_FALSE(map.contains(WatchTimeKey::kAudioAll));
+}
+
+TEST(WatchTimeKeyMapTest, ZeroValuesArePresent) {
+  WatchTimeKeyMap map;
+  map[WatchTimeKey::kVideoAll];
+  EXPECT_TRUE(map.contains(WatchTimeKey::kVideoAll));
+  EXPECT_EQ(map.at(WatchTimeKey::kVideoAll), base::TimeDelta());
+
+  map[WatchTimeKey::kVideoAll] += base::Seconds(2);
+  map[WatchTimeKey::kVideoAll] += base::Seconds(3);
+  EXPECT_EQ(map.at(WatchTimeKey::kVideoAll), base::Seconds(5));
+}
+
+TEST(WatchTimeKeyMapTest, IteratesInKeyOrder) {
+  WatchTimeKeyMap map;
+  map[WatchTimeKey::kWatchTimeKeyMax] = base::Seconds(3);
+  map[WatchTimeKey::kAudioAll] = base::Seconds(1);
+  map[WatchTimeKey::kAudioVideoAll] = base::Seconds(2);
+  EXPECT_EQ(map.size(), 3u);
+
+  std::vector<WatchTimeKeyMap::value_type> entries;
+  for (const auto& kv : map)
+    entries.push_back(kv);
+  EXPECT_EQ(entries, std::vector<WatchTimeKeyMap::value_type>(
+                         {{WatchTimeKey::kAudioAll, base::Seconds(1)},
+                          {WatchTimeKey::kAudioVideoAll, base::Seconds(2)},
+                          {WatchTimeKey::kWatchTimeKeyMax, base::Seconds(3)}}));
+}
+
+TEST(WatchTimeKeyMapTest, EraseAndClear) {
+  WatchTimeKeyMap map;
+  map[WatchTimeKey::kAudioAll] = base::Seconds(1);
+  map[WatchTimeKey::kVideoAll] = base::Seconds(2);
+
+  map.erase(WatchTimeKey::kAudioAll);
+  EXPECT_FALSE(map.contains(WatchTimeKey::kAudioAll));
+  EXPECT_EQ(map.size(), 1u);
+
+  // An erased key comes back with a zero value.
+  EXPECT_EQ(map[WatchTimeKey::kAudioAll], base::TimeDelta());
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+}  // namespace media
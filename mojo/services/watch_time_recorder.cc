@@ -103,6 +103,12 @@ void WatchTimeRecorder::RecordWatchTime(WatchTimeKey key,
   watch_time_info_[key] = watch_time;
 }
 
+void WatchTimeRecorder::RecordWatchTimeBatch(
+    std::vector<mojom::WatchTimeEntryPtr> entries) {
+  for (const auto& entry : entries)
+    watch_time_info_[entry->key] = entry->watch_time;
+}
+
 void WatchTimeRecorder::FinalizeWatchTime(
     const std::vector<WatchTimeKey>& keys_to_finalize) {
   // If the filter set is empty, treat that as finalizing all keys; otherwise
@@ -111,7 +117,7 @@ void WatchTimeRecorder::FinalizeWatchTime(
 
   // Record metrics to be finalized, but do not erase them yet; they are still
   // needed by for UKM and MTBR recording below.
-  for (auto& kv : watch_time_info_) {
+  for (const auto& kv : watch_time_info_) {
     if (!should_finalize_everything &&
         std::find(keys_to_finalize.begin(), keys_to_finalize.end(), kv.first) ==
             keys_to_finalize.end()) {
@@ -154,13 +160,16 @@ void WatchTimeRecorder::FinalizeWatchTime(
   if (ShouldRecordUma() && !properties_->is_background &&
       !properties_->is_muted) {
     for (auto& mapping : extended_metrics_keys_) {
-      auto it = watch_time_info_.find(mapping.watch_time_key);
-      if (it == watch_time_info_.end() || it->second < kMinimumElapsedWatchTime)
+      if (!watch_time_info_.contains(mapping.watch_time_key))
+        continue;
+      const base::TimeDelta watch_time =
+          watch_time_info_.at(mapping.watch_time_key);
+      if (watch_time < kMinimumElapsedWatchTime)
         continue;
 
       if (underflow_count_) {
         RecordMeanTimeBetweenRebuffers(mapping.mtbr_key,
-                                       it->second / underflow_count_);
+                                       watch_time / underflow_count_);
       }
 
       RecordRebuffersCount(mapping.smooth_rate_key, underflow_count_);
@@ -243,7 +252,7 @@ void WatchTimeRecorder::UpdateSecondaryProperties(
     // Flush any existing watch time for the current UKM record. The client is
     // responsible for ensuring recent watch time has been reported before
     // updating the secondary properties.
-    for (auto& kv : watch_time_info_)
+    for (const auto& kv : watch_time_info_)
       last_record.aggregate_watch_time_info[kv.first] += kv.second;
     last_record.total_underflow_count += underflow_count_;
     last_record.total_completed_underflow_count += completed_underflow_count_;
@@ -283,7 +292,7 @@ void WatchTimeRecorder::UpdateSecondaryProperties(
     last_record.total_underflow_duration = -underflow_duration_;
     last_record.total_video_frames_decoded = -video_frames_decoded_;
     last_record.total_video_frames_dropped = -video_frames_dropped_;
-    for (auto& kv : watch_time_info_)
+    for (const auto& kv : watch_time_info_)
       last_record.aggregate_watch_time_info[kv.first] = -kv.second;
   }
 }
@@ -357,7 +366,7 @@ void WatchTimeRecorder::RecordUkmPlaybackData() {
       builder.SetDuration(*clamped_duration_ms);
 
     bool recorded_all_metric = false;
-    for (auto& kv : ukm_record.aggregate_watch_time_info) {
+    for (const auto& kv : ukm_record.aggregate_watch_time_info) {
       DCHECK_GE(kv.second, base::TimeDelta());
 
       if (kv.first == WatchTimeKey::kAudioAll ||
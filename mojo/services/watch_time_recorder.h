@@ -7,14 +7,16 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "base/compiler_specific.h"
-#include "base/containers/flat_map.h"
 #include "base/time/time.h"
 #include "media/base/audio_codecs.h"
 #include "media/base/pipeline_status.h"
 #include "media/base/video_codecs.h"
 #include "media/mojo/mojom/watch_time_recorder.mojom.h"
 #include "media/mojo/services/media_mojo_export.h"
+#include "media/mojo/services/watch_time_key_map.h"
 #include "services/metrics/public/cpp/ukm_source_id.h"
 #include "url/gurl.h"
 
@@ -42,6 +44,8 @@ class MEDIA_MOJO_EXPORT WatchTimeRecorder : public mojom::WatchTimeRecorder {
 
   // mojom::WatchTimeRecorder implementation:
   void RecordWatchTime(WatchTimeKey key, base::TimeDelta watch_time) override;
+  void RecordWatchTimeBatch(
+      std::vector<mojom::WatchTimeEntryPtr> entries) override;
   void FinalizeWatchTime(
       const std::vector<WatchTimeKey>& watch_time_keys) override;
   void OnError(PipelineStatus status) override;
@@ -90,7 +94,7 @@ class MEDIA_MOJO_EXPORT WatchTimeRecorder : public mojom::WatchTimeRecorder {
   };
   const std::vector<ExtendedMetricsKeyMap> extended_metrics_keys_;
 
-  using WatchTimeInfo = base::flat_map<WatchTimeKey, base::TimeDelta>;
+  using WatchTimeInfo = WatchTimeKeyMap;
   WatchTimeInfo watch_time_info_;
 
   // Aggregate record of all watch time for a given set of secondary properties.
@@ -0,0 +1,100 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/callback_helpers.h"
+#include "base/cxx17_backports.h"
+#include "base/time/time.h"
+#include "media/base/watch_time_keys.h"
+#include "media/mojo/services/watch_time_recorder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+
+namespace {
+
+// Number of players in the process, e.g. muted autoplay videos on a page.
+constexpr size_t kNumPlayers = 200;
+
+// Length of the simulated playback.
+constexpr base::TimeDelta kPlaybackDuration = base::Minutes(1);
+
+// How often each player reports its watch time.
+constexpr base::TimeDelta kReportingInterval = base::Seconds(5);
+
+// Keys that a muted, foreground, audio+video src= player updates at each
+// report.
+constexpr WatchTimeKey kMutedPlaybackKeys[] = {
+    WatchTimeKey::kAudioVideoMutedAll,
+    WatchTimeKey::kAudioVideoMutedSrc,
+    WatchTimeKey::kAudioVideoMutedBattery,
+    WatchTimeKey::kAudioVideoMutedDisplayInline,
+    WatchTimeKey::kAudioVideoMutedNativeControlsOff,
+};
+
+// Reports the mojo messages that |kNumPlayers| muted players send for a minute
+// of playback each, and the time the recorders take to handle them.  Messages
+// are passed to the recorders directly, as the mojo stubs would.
+void RunReportingTest(bool batched, const std::string& story) {
+  std::vector<std::unique_ptr<WatchTimeRecorder>> recorders;
+  for (size_t i = 0; i < kNumPlayers; i++) {
+    recorders.push_back(std::make_unique<WatchTimeRecorder>(
+        mojom::PlaybackProperties::New(true, true, false, true, false, false,
+                                       false, mojom::MediaStreamType::kNone),
+        ukm::kInvalidSourceId, true, i, base::DoNothing()));
+  }
+
+  size_t num_messages = 0;
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (base::TimeDelta watch_time = kReportingInterval;
+       watch_time <= kPlaybackDuration; watch_time += kReportingInterval) {
+    for (auto& recorder : recorders) {
+      if (batched) {
+        std::vector<mojom::WatchTimeEntryPtr> entries;
+        entries.reserve(base::size(kMutedPlaybackKeys));
+        for (WatchTimeKey key : kMutedPlaybackKeys)
+          entries.push_back(mojom::WatchTimeEntry::New(key, watch_time));
+        recorder->RecordWatchTimeBatch(std::move(entries));
+        num_messages++;
+      } else {
+        for (WatchTimeKey key : kMutedPlaybackKeys) {
+          recorder->RecordWatchTime(key, watch_time);
+          num_messages++;
+        }
+      }
+    }
+  }
+  const base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  const double minutes = kPlaybackDuration.InSecondsF() / 60;
+  perf_test::PerfResultReporter reporter("watch_time_recorder", story);
+  reporter.RegisterImportantMetric("_messages_per_player_minute", "count");
+  reporter.RegisterImportantMetric("_handling_time_per_player_minute", "us");
+  reporter.AddResult("_messages_per_player_minute",
+                     num_messages / (kNumPlayers * minutes));
+  reporter.AddResult("_handling_time_per_player_minute",
+                     elapsed.InMicrosecondsF() / (kNumPlayers * minutes));
+
+  // Finalize outside of the measurement.
+  recorders.clear();
+}
+
+}  // namespace
+
+TEST(WatchTimeRecorderPerfTest, SingleKeyReports) {
+  RunReportingTest(false, "single_key_reports");
+}
+
+TEST(WatchTimeRecorderPerfTest, BatchedReports) {
+  RunReportingTest(true, "batched_reports");
+}
+
+}  // namespace media
@@ -882,6 +882,54 @@ TEST_F(WatchTimeRecorderTest, BasicUkmAudioVideo) {
   }
 }
 
+TEST_F(WatchTimeRecorderTest, BatchedReporting) {
+  mojom::PlaybackPropertiesPtr properties =
+      mojom::PlaybackProperties::New(true, true, false, false, false, false,
+                                     false, mojom::MediaStreamType::kNone);
+  Initialize(properties.Clone());
+  wtr_->UpdateSecondaryProperties(CreateSecondaryProperties());
+
+  constexpr base::TimeDelta kWatchTime1 = base::Seconds(25);
+  constexpr base::TimeDelta kWatchTime2 = base::Seconds(50);
+
+  // Every key of a report is sent in one message, and later reports replace
+  // the values of earlier ones, as with RecordWatchTime().
+  std::vector<mojom::WatchTimeEntryPtr> entries;
+  entries.push_back(
+      mojom::WatchTimeEntry::New(WatchTimeKey::kAudioVideoAll, kWatchTime1));
+  entries.push_back(
+      mojom::WatchTimeEntry::New(WatchTimeKey::kAudioVideoSrc, kWatchTime1));
+  entries.push_back(
+      mojom::WatchTimeEntry::New(WatchTimeKey::kAudioVideoAc, kWatchTime1));
+  wtr_->RecordWatchTimeBatch(std::move(entries));
+
+  entries.clear();
+  entries.push_back(
+      mojom::WatchTimeEntry::New(WatchTimeKey::kAudioVideoAll, kWatchTime2));
+  entries.push_back(
+      mojom::WatchTimeEntry::New(WatchTimeKey::kAudioVideoSrc, kWatchTime2));
+  entries.push_back(
+      mojom::WatchTimeEntry::New(WatchTimeKey::kAudioVideoAc, kWatchTime2));
+  wtr_->RecordWatchTimeBatch(std::move(entries));
+  wtr_.reset();
+  base::RunLoop().RunUntilIdle();
+
+  ExpectWatchTime(
+      {ConvertWatchTimeKeyToStringForUma(WatchTimeKey::kAudioVideoAll),
+       ConvertWatchTimeKeyToStringForUma(WatchTimeKey::kAudioVideoSrc),
+       ConvertWatchTimeKeyToStringForUma(WatchTimeKey::kAudioVideoAc)},
+      kWatchTime2);
+
+  const auto& entries_by_name =
+      test_recorder_->GetEntriesByName(UkmEntry::kEntryName);
+  EXPECT_EQ(1u, entries_by_name.size());
+  for (const auto* entry : entries_by_name) {
+    EXPECT_UKM(UkmEntry::kWatchTimeName, kWatchTime2.InMilliseconds());
+    EXPECT_UKM(UkmEntry::kWatchTime_ACName, kWatchTime2.InMilliseconds());
+    EXPECT_NO_UKM(UkmEntry::kWatchTime_BatteryName);
+  }
+}
+
 TEST_F(WatchTimeRecorderTest, BasicUkmAudioVideoWithExtras) {
   mojom::PlaybackPropertiesPtr properties =
       mojom::PlaybackProperties::New(true, true, false, false, true, true,
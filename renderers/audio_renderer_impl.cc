@@ -33,6 +33,7 @@
 #include "media/base/media_client.h"
 #include "media/base/media_log.h"
 #include "media/base/media_switches.h"
+#include "media/base/pipeline_latency_profiler.h"
 #include "media/base/renderer_client.h"
 #include "media/base/timestamp_constants.h"
 #include "media/filters/audio_clock.h"
@@ -1109,6 +1110,8 @@ int AudioRendererImpl::Render(base::TimeDelta delay,
                               int prior_frames_skipped,
                               AudioBus* audio_bus) {
   TRACE_EVENT1("media", "AudioRendererImpl::Render", "id", media_log_->id());
+  ScopedPipelineStageTimer stage_timer(DemuxerStream::AUDIO,
+                                       PipelineStage::kRender);
   int frames_requested = audio_bus->frames();
   DVLOG(4) << __func__ << " delay:" << delay
            << " prior_frames_skipped:" << prior_frames_skipped
@@ -8,9 +8,13 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/feature_list.h"
+#include "base/no_destructor.h"
 #include "build/build_config.h"
 #include "media/base/audio_buffer.h"
 #include "media/base/decoder_factory.h"
+#include "media/base/media_switches.h"
+#include "media/filters/video_decoder_scorer.h"
 #include "media/renderers/audio_renderer_impl.h"
 #include "media/renderers/renderer_impl.h"
 #include "media/renderers/video_renderer_impl.h"
@@ -19,6 +23,18 @@
 
 namespace media {
 
+namespace {
+
+// Returns the scorer shared by the video renderers of this process, so that
+// the decode stats of one playback rank the decoders of the next.
+scoped_refptr<VideoDecoderScorer> GetSharedVideoDecoderScorer() {
+  static base::NoDestructor<scoped_refptr<VideoDecoderScorer>> scorer(
+      base::MakeRefCounted<VideoDecoderScorer>());
+  return *scorer;
+}
+
+}  // namespace
+
 #if defined(OS_ANDROID)
 DefaultRendererFactory::DefaultRendererFactory(
     MediaLog* media_log,
@@ -108,7 +124,7 @@ std::unique_ptr<Renderer> DefaultRendererFactory::CreateRenderer(
         media_task_runner, std::move(worker_task_runner), gpu_factories);
   }
 
-  std::unique_ptr<VideoRenderer> video_renderer(new VideoRendererImpl(
+  auto video_renderer = std::make_unique<VideoRendererImpl>(
       media_task_runner, video_renderer_sink,
       // Unretained is safe here, because the RendererFactory is guaranteed to
       // outlive the RendererImpl. The RendererImpl is destroyed when WMPI
@@ -120,7 +136,9 @@ std::unique_ptr<Renderer> DefaultRendererFactory::CreateRenderer(
                           base::Unretained(this), media_task_runner,
                           std::move(request_overlay_info_cb),
                           target_color_space, gpu_factories),
-      true, media_log_, std::move(gmb_pool)));
+      true, media_log_, std::move(gmb_pool));
+  if (base::FeatureList::IsEnabled(kVideoDecoderScoring))
+    video_renderer->SetDecoderScorer(GetSharedVideoDecoderScorer());
 
   return std::make_unique<RendererImpl>(
       media_task_runner, std::move(audio_renderer), std::move(video_renderer));
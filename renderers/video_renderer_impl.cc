@@ -22,9 +22,11 @@
 #include "media/base/bind_to_current_loop.h"
 #include "media/base/media_log.h"
 #include "media/base/media_switches.h"
+#include "media/base/pipeline_latency_profiler.h"
 #include "media/base/pipeline_status.h"
 #include "media/base/renderer_client.h"
 #include "media/base/video_frame.h"
+#include "media/base/video_util.h"
 
 namespace media {
 
@@ -40,6 +42,14 @@ namespace {
 // SetLatencyHint(), so we needed to peg this with a constant.
 constexpr int kAbsoluteMaxFrames = 24;
 
+// Content hashing stops after this many hashed frames in a row differ from
+// their predecessor, since such content is unlikely to repeat.
+constexpr int kMaxChangedContentHashes = 4;
+
+// While content hashing is stopped, a pair of consecutive frames is hashed
+// once per this many frames to find out whether the content became static.
+constexpr int kContentHashProbeInterval = 30;
+
 bool ShouldUseLowDelayMode(DemuxerStream* stream) {
   return base::FeatureList::IsEnabled(kLowDelayVideoRenderingOnLiveStream) &&
          stream->liveness() == DemuxerStream::LIVENESS_LIVE;
@@ -75,7 +85,9 @@ VideoRendererImpl::VideoRendererImpl(
       last_frame_opaque_(false),
       painted_first_frame_(false),
       min_buffered_frames_(initial_buffering_size_.value()),
-      max_buffered_frames_(initial_buffering_size_.value()) {
+      max_buffered_frames_(initial_buffering_size_.value()),
+      compute_content_hashes_(
+          base::FeatureList::IsEnabled(kVideoFrameContentHashing)) {
   DCHECK(create_video_decoders_cb_);
 }
 
@@ -181,6 +193,13 @@ void VideoRendererImpl::Initialize(
       task_runner_, create_video_decoders_cb_, media_log_);
   video_decoder_stream_->set_config_change_observer(base::BindRepeating(
       &VideoRendererImpl::OnConfigChange, weak_factory_.GetWeakPtr()));
+  current_decoder_type_ = VideoDecoderType::kUnknown;
+  if (decoder_scorer_) {
+    video_decoder_stream_->set_decoder_score_cb(
+        decoder_scorer_->GetDecoderScoreCB());
+    video_decoder_stream_->set_decoder_change_observer(base::BindRepeating(
+        &VideoRendererImpl::OnDecoderChange, weak_factory_.GetWeakPtr()));
+  }
   if (gpu_memory_buffer_pool_) {
     video_decoder_stream_->SetPrepareCB(base::BindRepeating(
         &GpuMemoryBufferVideoFramePool::MaybeCreateHardwareFrame,
@@ -226,6 +245,8 @@ scoped_refptr<VideoFrame> VideoRendererImpl::Render(
     RenderingMode rendering_mode) {
   TRACE_EVENT_BEGIN1("media", "VideoRendererImpl::Render", "id",
                      media_log_->id());
+  ScopedPipelineStageTimer stage_timer(DemuxerStream::VIDEO,
+                                       PipelineStage::kRender);
   base::AutoLock auto_lock(lock_);
   DCHECK_EQ(state_, kPlaying);
   last_render_time_ = tick_clock_->NowTicks();
@@ -385,6 +406,18 @@ void VideoRendererImpl::OnConfigChange(const VideoDecoderConfig& config) {
   }
 }
 
+void VideoRendererImpl::OnDecoderChange(VideoDecoder* decoder) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  current_decoder_type_ =
+      decoder ? decoder->GetDecoderType() : VideoDecoderType::kUnknown;
+}
+
+void VideoRendererImpl::SetDecoderScorer(
+    scoped_refptr<VideoDecoderScorer> scorer) {
+  DCHECK(!video_decoder_stream_);
+  decoder_scorer_ = std::move(scorer);
+}
+
 void VideoRendererImpl::SetTickClockForTesting(
     const base::TickClock* tick_clock) {
   tick_clock_ = tick_clock;
@@ -556,15 +589,53 @@ void VideoRendererImpl::UpdateLatencyHintBufferingCaps_Locked(
   }
 }
 
+void VideoRendererImpl::MaybeComputeContentHash(VideoFrame* frame) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+
+  // Only frames that repeat their predecessor can skip an upload, so stop
+  // hashing content that keeps changing, and probe it now and then.
+  if (changed_content_hashes_ >= kMaxChangedContentHashes) {
+    if (++frames_since_content_hash_ < kContentHashProbeInterval)
+      return;
+    // Hash this frame and the next one. Unless they match, hashing stops
+    // again after the next one.
+    changed_content_hashes_ = kMaxChangedContentHashes - 2;
+  }
+  frames_since_content_hash_ = 0;
+
+  TRACE_EVENT0("media", "VideoRendererImpl::ComputeContentHash");
+  const absl::optional<uint64_t> content_hash =
+      ComputeVideoFrameContentHash(*frame);
+  if (content_hash && content_hash == last_content_hash_)
+    changed_content_hashes_ = 0;
+  else
+    ++changed_content_hashes_;
+  last_content_hash_ = content_hash;
+  frame->metadata().content_hash = content_hash;
+}
+
 void VideoRendererImpl::FrameReady(VideoDecoderStream::ReadResult result) {
   DCHECK(task_runner_->BelongsToCurrentThread());
+
+  const StatusCode code = result.code();
+  scoped_refptr<VideoFrame> frame;
+  if (result.has_value()) {
+    frame = std::move(result).value();
+    // Hash the frame before taking |lock_|, which Render() needs in order to
+    // hand the compositor its next frame.
+    if (compute_content_hashes_ && !frame->metadata().end_of_stream &&
+        !frame->metadata().content_hash) {
+      MaybeComputeContentHash(frame.get());
+    }
+  }
+
   base::AutoLock auto_lock(lock_);
   DCHECK_EQ(state_, kPlaying);
   CHECK(pending_read_);
   pending_read_ = false;
 
   // Can happen when demuxers are preparing for a new Seek().
-  switch (result.code()) {
+  switch (code) {
     case StatusCode::kOk:
       break;
     case StatusCode::kAborted:
@@ -582,8 +653,6 @@ void VideoRendererImpl::FrameReady(VideoDecoderStream::ReadResult result) {
       return;
   }
 
-  DCHECK(result.has_value());
-  scoped_refptr<VideoFrame> frame = std::move(result).value();
   DCHECK(frame);
 
   last_frame_ready_time_ = tick_clock_->NowTicks();
@@ -821,6 +890,16 @@ void VideoRendererImpl::UpdateStats_Locked(bool force_update) {
   stats_.video_frame_duration_average = algorithm_->average_frame_duration();
   OnStatisticsUpdate(stats_);
 
+  if (decoder_scorer_ && current_decoder_type_ != VideoDecoderType::kUnknown) {
+    VideoDecoderScorer::DecodeStats decode_stats;
+    decode_stats.frames_decoded = stats_.video_frames_decoded;
+    decode_stats.frames_dropped = stats_.video_frames_dropped;
+    decode_stats.frames_power_efficient =
+        stats_.video_frames_decoded_power_efficient;
+    decoder_scorer_->AppendStats(current_decoder_type_,
+                                 current_decoder_config_, decode_stats);
+  }
+
   stats_.video_frames_decoded = 0;
   stats_.video_frames_dropped = 0;
   stats_.video_frames_decoded_power_efficient = 0;
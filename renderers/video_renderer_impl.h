@@ -29,6 +29,7 @@
 #include "media/base/video_renderer.h"
 #include "media/base/video_renderer_sink.h"
 #include "media/filters/decoder_stream.h"
+#include "media/filters/video_decoder_scorer.h"
 #include "media/filters/video_renderer_algorithm.h"
 #include "media/renderers/default_renderer_factory.h"
 #include "media/video/gpu_memory_buffer_video_frame_pool.h"
@@ -79,6 +80,10 @@ class MEDIA_EXPORT VideoRendererImpl
   void OnTimeStopped() override;
   void SetLatencyHint(absl::optional<base::TimeDelta> latency_hint) override;
 
+  // Ranks the candidate video decoders with |scorer|, and adds the decode
+  // stats of this renderer to it. Must be called before Initialize().
+  void SetDecoderScorer(scoped_refptr<VideoDecoderScorer> scorer);
+
   void SetTickClockForTesting(const base::TickClock* tick_clock);
   size_t frames_queued_for_testing() const {
     return algorithm_->frames_queued();
@@ -114,10 +119,18 @@ class MEDIA_EXPORT VideoRendererImpl
   // RenderClient of the new config.
   void OnConfigChange(const VideoDecoderConfig& config);
 
+  // Called by the VideoDecoderStream when it selects a decoder, to attribute
+  // the decode stats passed to |decoder_scorer_|.
+  void OnDecoderChange(VideoDecoder* decoder);
+
   // Callback for |video_decoder_stream_| to deliver decoded video frames and
   // report video decoding status.
   void FrameReady(VideoDecoderStream::ReadResult result);
 
+  // Sets the content hash of |frame| if its content may repeat that of the
+  // previous frame, judging by whether recent frames repeated.
+  void MaybeComputeContentHash(VideoFrame* frame);
+
   // Helper method for enqueueing a frame to |alogorithm_|.
   void AddReadyFrame_Locked(scoped_refptr<VideoFrame> frame);
 
@@ -136,9 +149,10 @@ class MEDIA_EXPORT VideoRendererImpl
   void TransitionToHaveNothing();
   void TransitionToHaveNothing_Locked();
 
-  // Runs |statistics_cb_| with |frames_decoded_| and |frames_dropped_|, resets
-  // them to 0. If |force_update| is true, sends an update even if no frames
-  // have been decoded since the last update.
+  // Runs |statistics_cb_| with |frames_decoded_| and |frames_dropped_|, and
+  // adds them to |decoder_scorer_| if set, then resets them to 0. If
+  // |force_update| is true, sends an update even if no frames have been
+  // decoded since the last update.
   void UpdateStats_Locked(bool force_update = false);
 
   // Notifies |client_| if the current frame rate has changed since it was last
@@ -218,6 +232,11 @@ class MEDIA_EXPORT VideoRendererImpl
   // to the upper layers when when the new config is the same.
   VideoDecoderConfig current_decoder_config_;
 
+  // Ranks the decoders of |video_decoder_stream_| and receives the decode
+  // stats of the current decoder, of type |current_decoder_type_|. Optional.
+  scoped_refptr<VideoDecoderScorer> decoder_scorer_;
+  VideoDecoderType current_decoder_type_ = VideoDecoderType::kUnknown;
+
   // Used for accessing data members.
   base::Lock lock_;
 
@@ -353,6 +372,17 @@ class MEDIA_EXPORT VideoRendererImpl
   // one MEDIA_LOG.
   bool is_latency_hint_media_logged_ = false;
 
+  // Whether decoded frames should be tagged with a content hash so that the
+  // compositor can skip re-uploading unchanged frames.
+  const bool compute_content_hashes_;
+
+  // State of MaybeComputeContentHash(), only used on |task_runner_|: the last
+  // hash computed, how many hashed frames in a row differed from their
+  // predecessor, and how many frames went unhashed since the last hash.
+  absl::optional<uint64_t> last_content_hash_;
+  int changed_content_hashes_ = 0;
+  int frames_since_content_hash_ = 0;
+
   // NOTE: Weak pointers must be invalidated before all other member variables.
   base::WeakPtrFactory<VideoRendererImpl> weak_factory_{this};
 
@@ -32,6 +32,7 @@
 #include "media/base/test_helpers.h"
 #include "media/base/video_frame.h"
 #include "media/base/wall_clock_time_source.h"
+#include "media/filters/video_decoder_scorer.h"
 #include "media/renderers/video_renderer_impl.h"
 #include "media/video/mock_gpu_memory_buffer_video_frame_pool.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -761,6 +762,47 @@ TEST_F(VideoRendererImplTest, RenderingStopsAfterOneFrameWithEOS) {
   Destroy();
 }
 
+TEST_F(VideoRendererImplTest, DecoderScorerReceivesDecodeStats) {
+  const VideoDecoderConfig config = demuxer_stream_.video_decoder_config();
+  auto scorer = base::MakeRefCounted<VideoDecoderScorer>();
+  VideoDecoderScorer::DecodeStats stats;
+  stats.frames_decoded = VideoDecoderScorer::kMinFramesForScore - 1;
+  scorer->AppendStats(VideoDecoderType::kTesting, config, stats);
+  renderer_->SetDecoderScorer(scorer);
+
+  InitializeWithLowDelay(true);
+  EXPECT_EQ(scorer->Score(config, *decoder_),
+            VideoDecoderScorer::kUnknownScore);
+  QueueFrames("0");
+
+  EXPECT_CALL(mock_cb_, FrameReceived(HasTimestampMatcher(0))).Times(1);
+  EXPECT_CALL(mock_cb_, OnBufferingStateChange(BUFFERING_HAVE_ENOUGH, _));
+  EXPECT_CALL(mock_cb_, OnStatisticsUpdate(_)).Times(AnyNumber());
+  EXPECT_CALL(mock_cb_, OnVideoNaturalSizeChange(_)).Times(1);
+  EXPECT_CALL(mock_cb_, OnVideoOpacityChange(_)).Times(1);
+
+  {
+    SCOPED_TRACE("Waiting for sink to stop.");
+    WaitableMessageLoopEvent event;
+
+    null_video_sink_->set_stop_cb(event.GetClosure());
+    StartPlayingFrom(0);
+    renderer_->OnTimeProgressing();
+
+    EXPECT_TRUE(IsDecodePending());
+    SatisfyPendingDecodeWithEndOfStream();
+    WaitForEnded();
+
+    renderer_->OnTimeStopped();
+    event.RunAndWait();
+  }
+
+  // The decoded frame completes the stats needed to score the decoder.
+  EXPECT_GT(scorer->Score(config, *decoder_),
+            VideoDecoderScorer::kUnknownScore);
+  Destroy();
+}
+
 // Tests the case where the video started and received a single Render() call,
 // then the video was put into the background.
 TEST_F(VideoRendererImplTest, RenderingStartedThenStopped) {
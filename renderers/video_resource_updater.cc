@@ -49,6 +49,7 @@
 #include "third_party/khronos/GLES3/gl3.h"
 #include "third_party/libyuv/include/libyuv.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "ui/gfx/color_space.h"
 #include "ui/gfx/geometry/size_conversions.h"
 #include "ui/gfx/geometry/skia_conversions.h"
 #include "ui/gl/gl_enums.h"
@@ -289,12 +290,29 @@ class VideoResourceUpdater::PlaneResource {
            unique_frame_id_ == unique_frame_id && plane_index_ == plane_index;
   }
 
+  // Returns true if this resource holds plane |plane_index| of a VideoFrame
+  // whose VideoFrameMetadata::content_hash is |content_hash|, and which was
+  // uploaded for |color_space|. The hash only covers the pixels, so frames
+  // with the same pixels in another color space do not match.
+  bool MatchesContent(absl::optional<uint64_t> content_hash,
+                      const gfx::ColorSpace& color_space,
+                      size_t plane_index) {
+    return content_hash && has_unique_frame_id_and_plane_index_ &&
+           content_hash_ == content_hash &&
+           content_color_space_ == color_space && plane_index_ == plane_index;
+  }
+
   // Sets the unique identifiers for this resource, may only be called when
   // there is a single reference to the resource (i.e. |ref_count_| == 1).
-  void SetUniqueId(int unique_frame_id, size_t plane_index) {
+  void SetUniqueId(int unique_frame_id,
+                   size_t plane_index,
+                   absl::optional<uint64_t> content_hash,
+                   const gfx::ColorSpace& content_color_space) {
     DCHECK_EQ(ref_count_, 1);
     plane_index_ = plane_index;
     unique_frame_id_ = unique_frame_id;
+    content_hash_ = content_hash;
+    content_color_space_ = content_color_space;
     has_unique_frame_id_and_plane_index_ = true;
   }
 
@@ -325,6 +343,11 @@ class VideoResourceUpdater::PlaneResource {
   size_t plane_index_ = 0u;
   // Indicates if the above two members have been set or not.
   bool has_unique_frame_id_and_plane_index_ = false;
+  // Content hash of the VideoFrame plane stored in this resource, if known.
+  // Lets frames with distinct ids but identical content share the resource.
+  absl::optional<uint64_t> content_hash_;
+  // The color space the plane above was uploaded for.
+  gfx::ColorSpace content_color_space_;
 };
 
 class VideoResourceUpdater::SoftwarePlaneResource
@@ -719,6 +742,20 @@ VideoResourceUpdater::CreateExternalResourcesFromVideoFrame(
     return CreateForSoftwarePlanes(std::move(video_frame));
 }
 
+uint8_t* VideoResourceUpdater::EnsureUploadPixels(size_t needed_size) {
+  if (upload_pixels_size_ < needed_size) {
+    // Leave some headroom so that small increases in frame size, e.g. from
+    // adaptive streaming, do not reallocate on every step. Free the existing
+    // data first so that the memory can be reused, if possible. Note that the
+    // new array is purposely not initialized.
+    const size_t new_size = needed_size + needed_size / 8;
+    upload_pixels_.reset();
+    upload_pixels_.reset(new uint8_t[new_size]);
+    upload_pixels_size_ = new_size;
+  }
+  return upload_pixels_.get();
+}
+
 viz::ResourceFormat VideoResourceUpdater::YuvResourceFormat(
     int bits_per_channel) {
   DCHECK(raster_context_provider_ || context_provider_);
@@ -742,7 +779,8 @@ VideoResourceUpdater::RecycleOrAllocateResource(
     viz::ResourceFormat resource_format,
     const gfx::ColorSpace& color_space,
     int unique_id,
-    int plane_index) {
+    int plane_index,
+    absl::optional<uint64_t> content_hash) {
   PlaneResource* recyclable_resource = nullptr;
   for (auto& resource : all_resources_) {
     // If the plane index is valid (positive, or 0, meaning all planes)
@@ -756,6 +794,15 @@ VideoResourceUpdater::RecycleOrAllocateResource(
       return resource.get();
     }
 
+    // The same holds for a resource which holds identical content from an
+    // earlier frame, as long as its size and format also match.
+    if (plane_index != -1 &&
+        resource->MatchesContent(content_hash, color_space, plane_index) &&
+        resource->resource_size() == resource_size &&
+        resource->resource_format() == resource_format) {
+      return resource.get();
+    }
+
     // Otherwise check whether this is an unreferenced resource of the right
     // format that we can recycle. Remember it, but don't return immediately,
     // because we still want to find any reusable resources.
@@ -809,7 +856,7 @@ void VideoResourceUpdater::CopyHardwarePlane(
   const int no_plane_index = -1;  // Do not recycle referenced textures.
   PlaneResource* plane_resource = RecycleOrAllocateResource(
       output_plane_resource_size, copy_resource_format, resource_color_space,
-      no_unique_id, no_plane_index);
+      no_unique_id, no_plane_index, /*content_hash=*/absl::nullopt);
   HardwarePlaneResource* hardware_resource = plane_resource->AsHardware();
   hardware_resource->add_ref();
 
@@ -1042,13 +1089,20 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
       };
   base::EraseIf(all_resources_, can_delete_resource_fn);
 
+  // Identical content may only share resources when the planes are uploaded
+  // as is; RGB conversion also depends on the frame's color space.
+  const absl::optional<uint64_t> content_hash =
+      software_compositor() || texture_needs_rgb_conversion || is_rgb
+          ? absl::nullopt
+          : video_frame->metadata().content_hash;
+
   // Recycle or allocate resources for each video plane.
   std::vector<PlaneResource*> plane_resources;
   plane_resources.reserve(output_plane_count);
   for (size_t i = 0; i < output_plane_count; ++i) {
     plane_resources.push_back(RecycleOrAllocateResource(
         outplane_plane_sizes[i], output_resource_format, output_color_space,
-        video_frame->unique_id(), i));
+        video_frame->unique_id(), i, content_hash));
     plane_resources.back()->add_ref();
   }
 
@@ -1095,16 +1149,10 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
         size_t bytes_per_row = viz::ResourceSizes::CheckedWidthInBytes<size_t>(
             video_frame->coded_size().width(), output_resource_format);
         size_t needed_size = bytes_per_row * video_frame->coded_size().height();
-        if (upload_pixels_size_ < needed_size) {
-          // Free the existing data first so that the memory can be reused,
-          // if possible. Note that the new array is purposely not initialized.
-          upload_pixels_.reset();
-          upload_pixels_.reset(new uint8_t[needed_size]);
-          upload_pixels_size_ = needed_size;
-        }
+        uint8_t* upload_pixels = EnsureUploadPixels(needed_size);
 
         PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
-            video_frame.get(), upload_pixels_.get(), bytes_per_row);
+            video_frame.get(), upload_pixels, bytes_per_row);
 
         // Copy pixels into texture.
         auto* gl = ContextGL();
@@ -1116,10 +1164,11 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
           gl->TexSubImage2D(
               hardware_resource->texture_target(), 0, 0, 0, plane_size.width(),
               plane_size.height(), GLDataFormat(output_resource_format),
-              GLDataType(output_resource_format), upload_pixels_.get());
+              GLDataType(output_resource_format), upload_pixels);
         }
       }
-      plane_resource->SetUniqueId(video_frame->unique_id(), 0);
+      plane_resource->SetUniqueId(video_frame->unique_id(), 0, absl::nullopt,
+                                  gfx::ColorSpace());
     }
 
     viz::TransferableResource transferable_resource;
@@ -1171,14 +1220,39 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
     external_resources.offset = 0;
   }
 
+  // Use 4-byte row alignment (OpenGL default) for upload performance.
+  // Assuming that GL_UNPACK_ALIGNMENT has not changed from default.
+  constexpr size_t kDefaultUnpackAlignment = 4;
+
+  // Reserve staging space for every plane up front so that all planes of the
+  // frame share one allocation which is reused by subsequent frames.
+  size_t upload_pixels_offset = 0;
+  if (yuv_resource_format == viz::LUMINANCE_F16 ||
+      bits_per_channel > static_cast<size_t>(
+                             viz::BitsPerPixel(yuv_resource_format))) {
+    size_t total_size = 0;
+    for (auto* plane_resource : plane_resources) {
+      const gfx::Size& size = plane_resource->resource_size();
+      total_size += cc::MathUtil::CheckedRoundUp<size_t>(
+                        viz::ResourceSizes::CheckedWidthInBytes<size_t>(
+                            size.width(), yuv_resource_format),
+                        kDefaultUnpackAlignment) *
+                    size.height();
+    }
+    EnsureUploadPixels(total_size);
+  }
+
   auto* gl = ContextGL();
   // We need to transfer data from |video_frame| to the plane resources.
   for (size_t i = 0; i < plane_resources.size(); ++i) {
     HardwarePlaneResource* plane_resource = plane_resources[i]->AsHardware();
 
-    // Skip the transfer if this |video_frame|'s plane has been processed.
-    if (plane_resource->Matches(video_frame->unique_id(), i))
+    // Skip the transfer if this |video_frame|'s plane has been processed, or
+    // if the resource already holds identical content from another frame.
+    if (plane_resource->Matches(video_frame->unique_id(), i) ||
+        plane_resource->MatchesContent(content_hash, output_color_space, i)) {
       continue;
+    }
 
     const viz::ResourceFormat plane_resource_format =
         plane_resource->resource_format();
@@ -1198,9 +1272,6 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
         viz::ResourceSizes::CheckedWidthInBytes<size_t>(
             resource_size_pixels.width(), plane_resource_format);
 
-    // Use 4-byte row alignment (OpenGL default) for upload performance.
-    // Assuming that GL_UNPACK_ALIGNMENT has not changed from default.
-    constexpr size_t kDefaultUnpackAlignment = 4;
     const size_t upload_image_stride = cc::MathUtil::CheckedRoundUp<size_t>(
         bytes_per_row, kDefaultUnpackAlignment);
 
@@ -1241,38 +1312,32 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
       }
       pixels = video_frame->data(i);
     } else {
-      // Avoid malloc for each frame/plane if possible.
+      // Each plane gets its own slice of the staging area reserved above.
       const size_t needed_size =
           upload_image_stride * resource_size_pixels.height();
-      if (upload_pixels_size_ < needed_size) {
-        // Free the existing data first so that the memory can be reused,
-        // if possible. Note that the new array is purposely not initialized.
-        upload_pixels_.reset();
-        upload_pixels_.reset(new uint8_t[needed_size]);
-        upload_pixels_size_ = needed_size;
-      }
+      DCHECK_LE(upload_pixels_offset + needed_size, upload_pixels_size_);
+      uint8_t* upload_pixels = upload_pixels_.get() + upload_pixels_offset;
+      upload_pixels_offset += needed_size;
 
       if (plane_resource_format == viz::LUMINANCE_F16) {
-        for (int row = 0; row < resource_size_pixels.height(); ++row) {
-          uint16_t* dst = reinterpret_cast<uint16_t*>(
-              &upload_pixels_[upload_image_stride * row]);
-          const uint16_t* src = reinterpret_cast<uint16_t*>(
-              video_frame->data(i) + (video_stride_bytes * row));
-          half_float_maker->MakeHalfFloats(src, bytes_per_row / 2, dst);
-        }
+        half_float_maker->MakeHalfFloatsPlane(
+            reinterpret_cast<const uint16_t*>(video_frame->data(i)),
+            video_stride_bytes, reinterpret_cast<uint16_t*>(upload_pixels),
+            upload_image_stride, bytes_per_row / 2,
+            resource_size_pixels.height());
       } else if (needs_bit_downshifting) {
         DCHECK(plane_resource_format == viz::LUMINANCE_8 ||
                plane_resource_format == viz::RED_8);
         const int scale = 0x10000 >> (bits_per_channel - 8);
         libyuv::Convert16To8Plane(
             reinterpret_cast<uint16_t*>(video_frame->data(i)),
-            video_stride_bytes / 2, upload_pixels_.get(), upload_image_stride,
-            scale, bytes_per_row, resource_size_pixels.height());
+            video_stride_bytes / 2, upload_pixels, upload_image_stride, scale,
+            bytes_per_row, resource_size_pixels.height());
       } else {
         NOTREACHED();
       }
 
-      pixels = upload_pixels_.get();
+      pixels = upload_pixels;
     }
 
     // Copy pixels into texture. TexSubImage2D() is applicable because
@@ -1294,7 +1359,8 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
       gl->PixelStorei(GL_UNPACK_ALIGNMENT, kDefaultUnpackAlignment);
     }
 
-    plane_resource->SetUniqueId(video_frame->unique_id(), i);
+    plane_resource->SetUniqueId(video_frame->unique_id(), i, content_hash,
+                                output_color_space);
   }
 
   // Set the sync token otherwise resource is assumed to be synchronized.
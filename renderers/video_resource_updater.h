@@ -23,6 +23,7 @@
 #include "components/viz/common/resources/transferable_resource.h"
 #include "gpu/command_buffer/client/gles2_interface.h"
 #include "media/base/media_export.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 #include "ui/gfx/buffer_types.h"
 #include "ui/gfx/geometry/size.h"
 
@@ -163,12 +164,15 @@ class MEDIA_EXPORT VideoResourceUpdater
   // it is assumed that the resource has the right data already and will only be
   // used for reading, and so is returned even if it is still referenced.
   // Passing -1 for |plane_index| avoids returning referenced
-  // resources.
-  PlaneResource* RecycleOrAllocateResource(const gfx::Size& resource_size,
-                                           viz::ResourceFormat resource_format,
-                                           const gfx::ColorSpace& color_space,
-                                           int unique_id,
-                                           int plane_index);
+  // resources. Likewise, a resource holding |plane_index| of an earlier frame
+  // with the same non-null |content_hash| is returned as is.
+  PlaneResource* RecycleOrAllocateResource(
+      const gfx::Size& resource_size,
+      viz::ResourceFormat resource_format,
+      const gfx::ColorSpace& color_space,
+      int unique_id,
+      int plane_index,
+      absl::optional<uint64_t> content_hash);
   PlaneResource* AllocateResource(const gfx::Size& plane_size,
                                   viz::ResourceFormat format,
                                   const gfx::ColorSpace& color_space);
@@ -196,6 +200,10 @@ class MEDIA_EXPORT VideoResourceUpdater
 
   gpu::gles2::GLES2Interface* ContextGL();
 
+  // Returns |upload_pixels_|, growing it first if it is smaller than
+  // |needed_size| bytes.
+  uint8_t* EnsureUploadPixels(size_t needed_size);
+
   void RecycleResource(uint32_t plane_resource_id,
                        const gpu::SyncToken& sync_token,
                        bool lost_resource);
@@ -224,7 +232,9 @@ class MEDIA_EXPORT VideoResourceUpdater
   std::unique_ptr<PaintCanvasVideoRenderer> video_renderer_;
   uint32_t next_plane_resource_id_ = 1;
 
-  // Temporary pixel buffer when converting between formats.
+  // Temporary pixel buffer when converting between formats. For multi-plane
+  // frames each plane is staged in its own slice of this buffer, see
+  // EnsureUploadPixels().
   std::unique_ptr<uint8_t[]> upload_pixels_;
   size_t upload_pixels_size_ = 0;
 
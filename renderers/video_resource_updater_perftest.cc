@@ -0,0 +1,146 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "components/viz/client/client_resource_provider.h"
+#include "components/viz/test/test_context_provider.h"
+#include "components/viz/test/test_gles2_interface.h"
+#include "media/base/video_frame.h"
+#include "media/base/video_util.h"
+#include "media/renderers/video_resource_updater.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "third_party/khronos/GLES2/gl2ext.h"
+
+namespace media {
+
+namespace {
+
+constexpr int kBenchmarkFrames = 300;
+constexpr gfx::Size kFrameSize(1280, 720);
+constexpr int kTickerHeight = 64;
+
+// Counts the bytes passed to TexSubImage2D(), i.e. the texture uploads.
+class UploadBytesCounterGLES2Interface : public viz::TestGLES2Interface {
+ public:
+  void TexSubImage2D(GLenum target,
+                     GLint level,
+                     GLint xoffset,
+                     GLint yoffset,
+                     GLsizei width,
+                     GLsizei height,
+                     GLenum format,
+                     GLenum type,
+                     const void* pixels) override {
+    size_t components = 1;
+    if (format == GL_RG_EXT)
+      components = 2;
+    else if (format == GL_RGBA || format == GL_BGRA_EXT)
+      components = 4;
+    const size_t component_size = type == GL_UNSIGNED_BYTE ? 1 : 2;
+    upload_bytes_ += static_cast<size_t>(width) * height * components *
+                     component_size;
+  }
+
+  size_t upload_bytes() const { return upload_bytes_; }
+
+ private:
+  size_t upload_bytes_ = 0;
+};
+
+// Returns a new frame, as a decoder would output, showing a still background
+// and, if |ticker| is set, a strip along the bottom which scrolls by one pixel
+// every |index|.
+scoped_refptr<VideoFrame> CreateContentFrame(int index, bool ticker) {
+  scoped_refptr<VideoFrame> frame =
+      VideoFrame::CreateFrame(PIXEL_FORMAT_I420, kFrameSize,
+                              gfx::Rect(kFrameSize), kFrameSize,
+                              base::Milliseconds(index * 33));
+  for (size_t plane = 0; plane < VideoFrame::NumPlanes(frame->format());
+       ++plane) {
+    const int rows = frame->rows(plane);
+    const int row_bytes = frame->row_bytes(plane);
+    const int ticker_rows = kTickerHeight * rows / kFrameSize.height();
+    for (int y = 0; y < rows; ++y) {
+      uint8_t* row = frame->visible_data(plane) + y * frame->stride(plane);
+      if (!ticker || y < rows - ticker_rows) {
+        memset(row, 16 + 32 * plane, row_bytes);
+        continue;
+      }
+      for (int x = 0; x < row_bytes; ++x)
+        row[x] = static_cast<uint8_t>((x + index) * 7);
+    }
+  }
+  return frame;
+}
+
+// Feeds |kBenchmarkFrames| new frames to a VideoResourceUpdater, hashing every
+// one of them if |hash_content| is set, and reports the time and the texture
+// upload bytes per frame. VideoRendererImpl stops hashing changing content, so
+// the "ticker_hashed" story is the worst case.
+void RunUploadBenchmark(bool ticker,
+                        bool hash_content,
+                        const std::string& story) {
+  base::test::SingleThreadTaskEnvironment task_environment;
+  auto gl = std::make_unique<UploadBytesCounterGLES2Interface>();
+  UploadBytesCounterGLES2Interface* gl_ptr = gl.get();
+  scoped_refptr<viz::TestContextProvider> context_provider =
+      viz::TestContextProvider::Create(std::move(gl));
+  context_provider->BindToCurrentThread();
+  viz::ClientResourceProvider resource_provider;
+  auto updater = std::make_unique<VideoResourceUpdater>(
+      context_provider.get(), /*raster_context_provider=*/nullptr,
+      /*shared_bitmap_reporter=*/nullptr, &resource_provider,
+      /*use_stream_video_draw_quad=*/false,
+      /*use_gpu_memory_buffer_resources=*/false, /*use_r16_texture=*/false,
+      /*max_resource_size=*/10000);
+
+  base::TimeDelta elapsed;
+  for (int i = 0; i < kBenchmarkFrames; ++i) {
+    scoped_refptr<VideoFrame> frame = CreateContentFrame(i, ticker);
+    const base::TimeTicks start = base::TimeTicks::Now();
+    if (hash_content)
+      frame->metadata().content_hash = ComputeVideoFrameContentHash(*frame);
+    VideoFrameExternalResources resources =
+        updater->CreateExternalResourcesFromVideoFrame(frame);
+    elapsed += base::TimeTicks::Now() - start;
+    ASSERT_EQ(VideoFrameResourceType::YUV, resources.type);
+    for (auto& release_callback : resources.release_callbacks)
+      std::move(release_callback).Run(gpu::SyncToken(), false);
+  }
+
+  perf_test::PerfResultReporter reporter("video_resource_updater", story);
+  reporter.RegisterImportantMetric("_time_per_frame", "us");
+  reporter.RegisterImportantMetric("_upload_bytes_per_frame", "bytes");
+  reporter.AddResult("_time_per_frame",
+                     elapsed.InMicrosecondsF() / kBenchmarkFrames);
+  reporter.AddResult(
+      "_upload_bytes_per_frame",
+      static_cast<double>(gl_ptr->upload_bytes()) / kBenchmarkFrames);
+}
+
+}  // namespace
+
+// Slides or a paused screen capture: every frame repeats the previous one.
+TEST(VideoResourceUpdaterPerfTest, StaticContent) {
+  RunUploadBenchmark(/*ticker=*/false, /*hash_content=*/false, "static");
+  RunUploadBenchmark(/*ticker=*/false, /*hash_content=*/true, "static_hashed");
+}
+
+// A still picture with a scrolling news ticker, which changes every frame.
+TEST(VideoResourceUpdaterPerfTest, Ticker) {
+  RunUploadBenchmark(/*ticker=*/true, /*hash_content=*/false, "ticker");
+  RunUploadBenchmark(/*ticker=*/true, /*hash_content=*/true, "ticker_hashed");
+}
+
+}  // namespace media
@@ -435,6 +435,57 @@ TEST_F(VideoResourceUpdaterTest, ReuseResourceNoDelete) {
   EXPECT_EQ(0, gl_->UploadCount());
 }
 
+TEST_F(VideoResourceUpdaterTest, ReuseResourceForIdenticalContent) {
+  std::unique_ptr<VideoResourceUpdater> updater = CreateUpdaterForHardware();
+  scoped_refptr<VideoFrame> video_frame = CreateTestYUVVideoFrame();
+  video_frame->metadata().content_hash = 1234u;
+
+  gl_->ResetUploadCount();
+  VideoFrameExternalResources resources =
+      updater->CreateExternalResourcesFromVideoFrame(video_frame);
+  EXPECT_EQ(VideoFrameResourceType::YUV, resources.type);
+  EXPECT_EQ(3, gl_->UploadCount());
+  for (auto& release_callback : resources.release_callbacks)
+    std::move(release_callback).Run(gpu::SyncToken(), false);
+
+  // A different frame with the same content hash reuses the uploaded planes.
+  scoped_refptr<VideoFrame> static_frame = CreateTestYUVVideoFrame();
+  static_frame->metadata().content_hash = 1234u;
+  ASSERT_NE(video_frame->unique_id(), static_frame->unique_id());
+  gl_->ResetUploadCount();
+  resources = updater->CreateExternalResourcesFromVideoFrame(static_frame);
+  EXPECT_EQ(VideoFrameResourceType::YUV, resources.type);
+  EXPECT_EQ(3u, resources.resources.size());
+  EXPECT_EQ(0, gl_->UploadCount());
+  for (auto& release_callback : resources.release_callbacks)
+    std::move(release_callback).Run(gpu::SyncToken(), false);
+
+  // The same pixels in another color space must be uploaded again.
+  scoped_refptr<VideoFrame> bt709_frame = CreateTestYUVVideoFrame();
+  bt709_frame->metadata().content_hash = 1234u;
+  bt709_frame->set_color_space(gfx::ColorSpace::CreateREC709());
+  gl_->ResetUploadCount();
+  resources = updater->CreateExternalResourcesFromVideoFrame(bt709_frame);
+  EXPECT_EQ(3, gl_->UploadCount());
+  for (auto& release_callback : resources.release_callbacks)
+    std::move(release_callback).Run(gpu::SyncToken(), false);
+
+  // Changed content must be uploaded again.
+  scoped_refptr<VideoFrame> changed_frame = CreateTestYUVVideoFrame();
+  changed_frame->metadata().content_hash = 5678u;
+  gl_->ResetUploadCount();
+  resources = updater->CreateExternalResourcesFromVideoFrame(changed_frame);
+  EXPECT_EQ(3, gl_->UploadCount());
+  for (auto& release_callback : resources.release_callbacks)
+    std::move(release_callback).Run(gpu::SyncToken(), false);
+
+  // Frames without a content hash are always uploaded.
+  gl_->ResetUploadCount();
+  resources = updater->CreateExternalResourcesFromVideoFrame(
+      CreateTestYUVVideoFrame());
+  EXPECT_EQ(3, gl_->UploadCount());
+}
+
 TEST_F(VideoResourceUpdaterTest, SoftwareFrameSoftwareCompositor) {
   std::unique_ptr<VideoResourceUpdater> updater = CreateUpdaterForSoftware();
   scoped_refptr<VideoFrame> video_frame = CreateTestYUVVideoFrame();
@@ -0,0 +1,397 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/test/demuxer_trace.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/pickle.h"
+#include "base/strings/string_piece.h"
+
+namespace media {
+
+namespace {
+
+// "MDTR", followed by the format version.
+constexpr uint32_t kMagic = 0x4d445452;
+constexpr uint32_t kVersion = 1;
+
+// Tags the kind of each serialized Read.
+enum class ReadKind : int {
+  kBuffer = 0,
+  kEndOfStream = 1,
+  kConfigChange = 2,
+  kMaxValue = kConfigChange,
+};
+
+template <typename T>
+bool ReadEnum(base::PickleIterator* iter, T min_value, T max_value, T* out) {
+  int value;
+  if (!iter->ReadInt(&value) || value < static_cast<int>(min_value) ||
+      value > static_cast<int>(max_value)) {
+    return false;
+  }
+  *out = static_cast<T>(value);
+  return true;
+}
+
+void WriteTimeDelta(base::Pickle* pickle, base::TimeDelta value) {
+  pickle->WriteInt64(value.InMicroseconds());
+}
+
+bool ReadTimeDelta(base::PickleIterator* iter, base::TimeDelta* out) {
+  int64_t value;
+  if (!iter->ReadInt64(&value))
+    return false;
+  *out = base::Microseconds(value);
+  return true;
+}
+
+void WriteBytes(base::Pickle* pickle, const std::vector<uint8_t>& bytes) {
+  pickle->WriteData(reinterpret_cast<const char*>(bytes.data()),
+                    static_cast<int>(bytes.size()));
+}
+
+bool ReadBytes(base::PickleIterator* iter, std::vector<uint8_t>* out) {
+  const char* data;
+  int size;
+  if (!iter->ReadData(&data, &size))
+    return false;
+  out->assign(data, data + size);
+  return true;
+}
+
+void WriteAudioConfig(base::Pickle* pickle, const AudioDecoderConfig& config) {
+  DCHECK(!config.is_encrypted());
+  pickle->WriteInt(static_cast<int>(config.codec()));
+  pickle->WriteInt(static_cast<int>(config.profile()));
+  pickle->WriteInt(config.sample_format());
+  pickle->WriteInt(config.channel_layout());
+  pickle->WriteInt(config.channels());
+  pickle->WriteInt(config.samples_per_second());
+  WriteBytes(pickle, config.extra_data());
+  WriteTimeDelta(pickle, config.seek_preroll());
+  pickle->WriteInt(config.codec_delay());
+}
+
+bool ReadAudioConfig(base::PickleIterator* iter, AudioDecoderConfig* config) {
+  AudioCodec codec;
+  AudioCodecProfile profile;
+  SampleFormat sample_format;
+  ChannelLayout channel_layout;
+  int channels;
+  int samples_per_second;
+  std::vector<uint8_t> extra_data;
+  base::TimeDelta seek_preroll;
+  int codec_delay;
+  if (!ReadEnum(iter, AudioCodec::kUnknown, AudioCodec::kMaxValue, &codec) ||
+      !ReadEnum(iter, AudioCodecProfile::kUnknown, AudioCodecProfile::kMaxValue,
+                &profile) ||
+      !ReadEnum(iter, kUnknownSampleFormat, kSampleFormatMax,
+                &sample_format) ||
+      !ReadEnum(iter, CHANNEL_LAYOUT_NONE, CHANNEL_LAYOUT_MAX,
+                &channel_layout) ||
+      !iter->ReadInt(&channels) || !iter->ReadInt(&samples_per_second) ||
+      !ReadBytes(iter, &extra_data) || !ReadTimeDelta(iter, &seek_preroll) ||
+      !iter->ReadInt(&codec_delay)) {
+    return false;
+  }
+
+  config->Initialize(codec, sample_format, channel_layout, samples_per_second,
+                     extra_data, EncryptionScheme::kUnencrypted, seek_preroll,
+                     codec_delay);
+  config->set_profile(profile);
+  if (channel_layout == CHANNEL_LAYOUT_DISCRETE)
+    config->SetChannelsForDiscrete(channels);
+  return config->IsValidConfig();
+}
+
+void WriteVideoConfig(base::Pickle* pickle, const VideoDecoderConfig& config) {
+  DCHECK(!config.is_encrypted());
+  pickle->WriteInt(static_cast<int>(config.codec()));
+  pickle->WriteInt(config.profile());
+  pickle->WriteInt(static_cast<int>(config.alpha_mode()));
+  const VideoColorSpace& color_space = config.color_space_info();
+  pickle->WriteInt(static_cast<int>(color_space.primaries));
+  pickle->WriteInt(static_cast<int>(color_space.transfer));
+  pickle->WriteInt(static_cast<int>(color_space.matrix));
+  pickle->WriteInt(static_cast<int>(color_space.range));
+  pickle->WriteInt(config.video_transformation().rotation);
+  pickle->WriteBool(config.video_transformation().mirrored);
+  pickle->WriteInt(config.coded_size().width());
+  pickle->WriteInt(config.coded_size().height());
+  pickle->WriteInt(config.visible_rect().x());
+  pickle->WriteInt(config.visible_rect().y());
+  pickle->WriteInt(config.visible_rect().width());
+  pickle->WriteInt(config.visible_rect().height());
+  pickle->WriteInt(config.natural_size().width());
+  pickle->WriteInt(config.natural_size().height());
+  WriteBytes(pickle, config.extra_data());
+  pickle->WriteUInt32(config.level());
+}
+
+bool ReadVideoConfig(base::PickleIterator* iter, VideoDecoderConfig* config) {
+  VideoCodec codec;
+  VideoCodecProfile profile;
+  VideoDecoderConfig::AlphaMode alpha_mode;
+  int primaries;
+  int transfer;
+  int matrix;
+  int range;
+  VideoRotation rotation;
+  bool mirrored;
+  int coded_width, coded_height;
+  int visible_x, visible_y, visible_width, visible_height;
+  int natural_width, natural_height;
+  std::vector<uint8_t> extra_data;
+  VideoCodecLevel level;
+  if (!ReadEnum(iter, VideoCodec::kUnknown, VideoCodec::kMaxValue, &codec) ||
+      !ReadEnum(iter, VIDEO_CODEC_PROFILE_UNKNOWN, VIDEO_CODEC_PROFILE_MAX,
+                &profile) ||
+      !ReadEnum(iter, VideoDecoderConfig::AlphaMode::kHasAlpha,
+                VideoDecoderConfig::AlphaMode::kIsOpaque, &alpha_mode) ||
+      !iter->ReadInt(&primaries) || !iter->ReadInt(&transfer) ||
+      !iter->ReadInt(&matrix) || !iter->ReadInt(&range) ||
+      !ReadEnum(iter, VIDEO_ROTATION_0, VIDEO_ROTATION_MAX, &rotation) ||
+      !iter->ReadBool(&mirrored) || !iter->ReadInt(&coded_width) ||
+      !iter->ReadInt(&coded_height) || !iter->ReadInt(&visible_x) ||
+      !iter->ReadInt(&visible_y) || !iter->ReadInt(&visible_width) ||
+      !iter->ReadInt(&visible_height) || !iter->ReadInt(&natural_width) ||
+      !iter->ReadInt(&natural_height) || !ReadBytes(iter, &extra_data) ||
+      !iter->ReadUInt32(&level)) {
+    return false;
+  }
+
+  // The int constructor maps unknown color space values to INVALID.
+  config->Initialize(
+      codec, profile, alpha_mode,
+      VideoColorSpace(primaries, transfer, matrix,
+                      static_cast<gfx::ColorSpace::RangeID>(range)),
+      VideoTransformation(rotation, mirrored),
+      gfx::Size(coded_width, coded_height),
+      gfx::Rect(visible_x, visible_y, visible_width, visible_height),
+      gfx::Size(natural_width, natural_height), extra_data,
+      EncryptionScheme::kUnencrypted);
+  config->set_level(level);
+  return config->IsValidConfig();
+}
+
+void WriteRead(base::Pickle* pickle,
+               DemuxerStream::Type type,
+               const DemuxerTrace::Read& read) {
+  if (!read.buffer) {
+    pickle->WriteInt(static_cast<int>(ReadKind::kConfigChange));
+    if (type == DemuxerStream::AUDIO)
+      WriteAudioConfig(pickle, read.audio_config);
+    else
+      WriteVideoConfig(pickle, read.video_config);
+    return;
+  }
+
+  if (read.buffer->end_of_stream()) {
+    pickle->WriteInt(static_cast<int>(ReadKind::kEndOfStream));
+    return;
+  }
+
+  const DecoderBuffer& buffer = *read.buffer;
+  pickle->WriteInt(static_cast<int>(ReadKind::kBuffer));
+  WriteTimeDelta(pickle, buffer.timestamp());
+  WriteTimeDelta(pickle, buffer.duration());
+  pickle->WriteBool(buffer.is_key_frame());
+  WriteTimeDelta(pickle, buffer.discard_padding().first);
+  WriteTimeDelta(pickle, buffer.discard_padding().second);
+  pickle->WriteData(reinterpret_cast<const char*>(buffer.data()),
+                    static_cast<int>(buffer.data_size()));
+}
+
+bool ReadRead(base::PickleIterator* iter,
+              DemuxerStream::Type type,
+              DemuxerTrace::Read* read) {
+  ReadKind kind;
+  if (!ReadEnum(iter, ReadKind::kBuffer, ReadKind::kMaxValue, &kind))
+    return false;
+
+  switch (kind) {
+    case ReadKind::kConfigChange:
+      return type == DemuxerStream::AUDIO
+                 ? ReadAudioConfig(iter, &read->audio_config)
+                 : ReadVideoConfig(iter, &read->video_config);
+    case ReadKind::kEndOfStream:
+      read->buffer = DecoderBuffer::CreateEOSBuffer();
+      return true;
+    case ReadKind::kBuffer:
+      break;
+  }
+
+  base::TimeDelta timestamp;
+  base::TimeDelta duration;
+  bool is_key_frame;
+  DecoderBuffer::DiscardPadding discard_padding;
+  const char* data;
+  int size;
+  if (!ReadTimeDelta(iter, &timestamp) || !ReadTimeDelta(iter, &duration) ||
+      !iter->ReadBool(&is_key_frame) ||
+      !ReadTimeDelta(iter, &discard_padding.first) ||
+      !ReadTimeDelta(iter, &discard_padding.second) ||
+      !iter->ReadData(&data, &size)) {
+    return false;
+  }
+
+  read->buffer =
+      DecoderBuffer::CopyFrom(reinterpret_cast<const uint8_t*>(data), size);
+  read->buffer->set_timestamp(timestamp);
+  read->buffer->set_duration(duration);
+  read->buffer->set_is_key_frame(is_key_frame);
+  read->buffer->set_discard_padding(discard_padding);
+  return true;
+}
+
+}  // namespace
+
+DemuxerTrace::Read::Read() = default;
+DemuxerTrace::Read::Read(const Read& other) = default;
+DemuxerTrace::Read::~Read() = default;
+
+DemuxerTrace::Stream::Stream() = default;
+DemuxerTrace::Stream::Stream(const Stream& other) = default;
+DemuxerTrace::Stream::~Stream() = default;
+
+DemuxerTrace::Segment::Segment() = default;
+DemuxerTrace::Segment::Segment(const Segment& other) = default;
+DemuxerTrace::Segment::~Segment() = default;
+
+DemuxerTrace::DemuxerTrace() = default;
+DemuxerTrace::DemuxerTrace(const DemuxerTrace& other) = default;
+DemuxerTrace::~DemuxerTrace() = default;
+
+// static
+std::unique_ptr<DemuxerTrace> DemuxerTrace::Deserialize(
+    const base::Pickle& pickle) {
+  base::PickleIterator iter(pickle);
+  uint32_t magic;
+  uint32_t version;
+  if (!iter.ReadUInt32(&magic) || magic != kMagic ||
+      !iter.ReadUInt32(&version) || version != kVersion) {
+    return nullptr;
+  }
+
+  auto trace = std::make_unique<DemuxerTrace>();
+  uint32_t num_streams;
+  if (!ReadTimeDelta(&iter, &trace->start_time) ||
+      !ReadTimeDelta(&iter, &trace->duration) ||
+      !iter.ReadUInt32(&num_streams)) {
+    return nullptr;
+  }
+
+  for (uint32_t i = 0; i < num_streams; ++i) {
+    Stream stream;
+    if (!ReadEnum(&iter, DemuxerStream::AUDIO, DemuxerStream::VIDEO,
+                  &stream.type) ||
+        !ReadEnum(&iter, DemuxerStream::LIVENESS_UNKNOWN,
+                  DemuxerStream::LIVENESS_MAX, &stream.liveness) ||
+        !iter.ReadBool(&stream.supports_config_changes)) {
+      return nullptr;
+    }
+    const bool config_ok =
+        stream.type == DemuxerStream::AUDIO
+            ? ReadAudioConfig(&iter, &stream.audio_config)
+            : ReadVideoConfig(&iter, &stream.video_config);
+    if (!config_ok)
+      return nullptr;
+    trace->streams.push_back(std::move(stream));
+  }
+
+  uint32_t num_segments;
+  if (!iter.ReadUInt32(&num_segments))
+    return nullptr;
+
+  for (uint32_t i = 0; i < num_segments; ++i) {
+    Segment segment;
+    if (!ReadTimeDelta(&iter, &segment.seek_time))
+      return nullptr;
+    segment.reads.resize(num_streams);
+    for (uint32_t s = 0; s < num_streams; ++s) {
+      uint32_t num_reads;
+      if (!iter.ReadUInt32(&num_reads))
+        return nullptr;
+      for (uint32_t r = 0; r < num_reads; ++r) {
+        Read read;
+        if (!ReadRead(&iter, trace->streams[s].type, &read))
+          return nullptr;
+        segment.reads[s].push_back(std::move(read));
+      }
+    }
+    trace->segments.push_back(std::move(segment));
+  }
+
+  return trace;
+}
+
+// static
+std::unique_ptr<DemuxerTrace> DemuxerTrace::ReadFromFile(
+    const base::FilePath& path) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return nullptr;
+  return Deserialize(
+      base::Pickle(contents.data(), static_cast<int>(contents.size())));
+}
+
+void DemuxerTrace::Serialize(base::Pickle* pickle) const {
+  pickle->WriteUInt32(kMagic);
+  pickle->WriteUInt32(kVersion);
+  WriteTimeDelta(pickle, start_time);
+  WriteTimeDelta(pickle, duration);
+
+  pickle->WriteUInt32(streams.size());
+  for (const Stream& stream : streams) {
+    pickle->WriteInt(stream.type);
+    pickle->WriteInt(stream.liveness);
+    pickle->WriteBool(stream.supports_config_changes);
+    if (stream.type == DemuxerStream::AUDIO)
+      WriteAudioConfig(pickle, stream.audio_config);
+    else
+      WriteVideoConfig(pickle, stream.video_config);
+  }
+
+  pickle->WriteUInt32(segments.size());
+  for (const Segment& segment : segments) {
+    DCHECK_EQ(segment.reads.size(), streams.size());
+    WriteTimeDelta(pickle, segment.seek_time);
+    for (size_t s = 0; s < streams.size(); ++s) {
+      pickle->WriteUInt32(segment.reads[s].size());
+      for (const Read& read : segment.reads[s])
+        WriteRead(pickle, streams[s].type, read);
+    }
+  }
+}
+
+bool DemuxerTrace::WriteToFile(const base::FilePath& path) const {
+  base::Pickle pickle;
+  Serialize(&pickle);
+  return base::WriteFile(
+      path, base::StringPiece(static_cast<const char*>(pickle.data()),
+                              pickle.size()));
+}
+
+size_t DemuxerTrace::GetBufferCount() const {
+  size_t count = 0;
+  for (const Segment& segment : segments) {
+    for (const std::vector<Read>& stream_reads : segment.reads) {
+      for (const Read& read : stream_reads) {
+        if (read.buffer && !read.buffer->end_of_stream())
+          ++count;
+      }
+    }
+  }
+  return count;
+}
+
+}  // namespace media
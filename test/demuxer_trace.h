@@ -0,0 +1,99 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_TEST_DEMUXER_TRACE_H_
+#define MEDIA_TEST_DEMUXER_TRACE_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/memory/scoped_refptr.h"
+#include "base/time/time.h"
+#include "media/base/audio_decoder_config.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/demuxer_stream.h"
+#include "media/base/timestamp_constants.h"
+#include "media/base/video_decoder_config.h"
+
+namespace base {
+class FilePath;
+class Pickle;
+}  // namespace base
+
+namespace media {
+
+// The exact sequence of DemuxerStream::Read() results a playback session saw,
+// split at each seek. Recorded by DemuxerTraceRecorder and replayed by
+// DemuxerTracePlayer, so that the decoders and renderers of a session can be
+// benchmarked without its network, container and timing noise.
+//
+// Only clear content is supported; buffers keep their data, timestamps,
+// duration, key frame flag and discard padding, but not their side data.
+struct DemuxerTrace {
+  // One successful Read(): either a buffer (possibly end of stream) or a
+  // config change, in which case |buffer| is null and the config matching the
+  // stream type holds the new config.
+  struct Read {
+    Read();
+    Read(const Read& other);
+    ~Read();
+
+    scoped_refptr<DecoderBuffer> buffer;
+    AudioDecoderConfig audio_config;
+    VideoDecoderConfig video_config;
+  };
+
+  struct Stream {
+    Stream();
+    Stream(const Stream& other);
+    ~Stream();
+
+    DemuxerStream::Type type = DemuxerStream::UNKNOWN;
+    DemuxerStream::Liveness liveness = DemuxerStream::LIVENESS_UNKNOWN;
+    bool supports_config_changes = false;
+    // Configs the stream had when the demuxer finished initializing.
+    AudioDecoderConfig audio_config;
+    VideoDecoderConfig video_config;
+  };
+
+  // The reads between two seeks.
+  struct Segment {
+    Segment();
+    Segment(const Segment& other);
+    ~Segment();
+
+    // Time of the Seek() that started the segment.
+    base::TimeDelta seek_time;
+    // Reads of each stream, indexed like |streams|.
+    std::vector<std::vector<Read>> reads;
+  };
+
+  DemuxerTrace();
+  DemuxerTrace(const DemuxerTrace& other);
+  ~DemuxerTrace();
+
+  // Returns null if |pickle| does not hold a valid trace.
+  static std::unique_ptr<DemuxerTrace> Deserialize(const base::Pickle& pickle);
+  static std::unique_ptr<DemuxerTrace> ReadFromFile(
+      const base::FilePath& path);
+
+  // Buffer data is written as-is and every other field as a fixed size
+  // integer, so a trace is about as large as the media it was recorded from.
+  void Serialize(base::Pickle* pickle) const;
+  bool WriteToFile(const base::FilePath& path) const;
+
+  // Returns the number of non end of stream buffers in all segments.
+  size_t GetBufferCount() const;
+
+  base::TimeDelta start_time;
+  base::TimeDelta duration = kInfiniteDuration;
+  std::vector<Stream> streams;
+  std::vector<Segment> segments;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_TEST_DEMUXER_TRACE_H_
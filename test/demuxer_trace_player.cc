@@ -0,0 +1,229 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/test/demuxer_trace_player.h"
+
+#include <utility>
+
+#include "base/check.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "media/base/bind_to_current_loop.h"
+
+namespace media {
+
+// Returns the recorded reads of one stream of the current segment, in order.
+class DemuxerTracePlayer::TraceStream : public DemuxerStream {
+ public:
+  TraceStream(DemuxerTracePlayer* player, const DemuxerTrace::Stream& stream)
+      : player_(player),
+        stream_(stream),
+        audio_config_(stream.audio_config),
+        video_config_(stream.video_config) {}
+  TraceStream(const TraceStream&) = delete;
+  TraceStream& operator=(const TraceStream&) = delete;
+  ~TraceStream() override = default;
+
+  // Starts returning |reads|, and stops aborting reads.
+  void SetReads(const std::vector<DemuxerTrace::Read>* reads) {
+    DCHECK(!read_cb_);
+    reads_ = reads;
+    next_read_ = 0;
+    aborted_ = false;
+  }
+
+  // Aborts the pending read, and every read until the next SetReads().
+  void Abort() {
+    aborted_ = true;
+    if (read_cb_)
+      std::move(read_cb_).Run(kAborted, nullptr);
+  }
+
+  bool has_returned_reads() const { return next_read_ > 0; }
+
+  // DemuxerStream implementation.
+  void Read(ReadCB read_cb) override {
+    DCHECK(!read_cb_);
+    read_cb_ = BindToCurrentLoop(std::move(read_cb));
+
+    if (aborted_) {
+      std::move(read_cb_).Run(kAborted, nullptr);
+      return;
+    }
+
+    if (next_read_ == reads_->size()) {
+      if (!player_->OnStreamStarved())
+        std::move(read_cb_).Run(kOk, DecoderBuffer::CreateEOSBuffer());
+      return;
+    }
+
+    const DemuxerTrace::Read& read = (*reads_)[next_read_++];
+    if (read.buffer) {
+      std::move(read_cb_).Run(kOk, read.buffer);
+      return;
+    }
+
+    if (type() == AUDIO)
+      audio_config_ = read.audio_config;
+    else
+      video_config_ = read.video_config;
+    std::move(read_cb_).Run(kConfigChanged, nullptr);
+  }
+  AudioDecoderConfig audio_decoder_config() override { return audio_config_; }
+  VideoDecoderConfig video_decoder_config() override { return video_config_; }
+  Type type() const override { return stream_.type; }
+  Liveness liveness() const override { return stream_.liveness; }
+  bool SupportsConfigChanges() override {
+    return stream_.supports_config_changes;
+  }
+
+ private:
+  DemuxerTracePlayer* const player_;
+  const DemuxerTrace::Stream& stream_;
+  AudioDecoderConfig audio_config_;
+  VideoDecoderConfig video_config_;
+
+  const std::vector<DemuxerTrace::Read>* reads_ = nullptr;
+  size_t next_read_ = 0;
+  bool aborted_ = false;
+  ReadCB read_cb_;
+};
+
+DemuxerTracePlayer::DemuxerTracePlayer(const DemuxerTrace* trace)
+    : trace_(trace) {
+  DCHECK(trace_);
+}
+
+DemuxerTracePlayer::~DemuxerTracePlayer() = default;
+
+std::vector<DemuxerStream*> DemuxerTracePlayer::GetAllStreams() {
+  std::vector<DemuxerStream*> streams;
+  for (const auto& stream : streams_)
+    streams.push_back(stream.get());
+  return streams;
+}
+
+std::string DemuxerTracePlayer::GetDisplayName() const {
+  return "DemuxerTracePlayer";
+}
+
+void DemuxerTracePlayer::Initialize(DemuxerHost* host,
+                                    PipelineStatusCallback status_cb) {
+  status_cb = BindToCurrentLoop(std::move(status_cb));
+  if (trace_->streams.empty() || trace_->segments.empty()) {
+    std::move(status_cb).Run(DEMUXER_ERROR_NO_SUPPORTED_STREAMS);
+    return;
+  }
+
+  const DemuxerTrace::Segment& segment = trace_->segments.front();
+  for (size_t i = 0; i < trace_->streams.size(); ++i) {
+    streams_.push_back(std::make_unique<TraceStream>(this, trace_->streams[i]));
+    streams_.back()->SetReads(&segment.reads[i]);
+  }
+
+  host->SetDuration(trace_->duration);
+  std::move(status_cb).Run(PIPELINE_OK);
+}
+
+void DemuxerTracePlayer::AbortPendingReads() {
+  for (const auto& stream : streams_)
+    stream->Abort();
+}
+
+void DemuxerTracePlayer::StartWaitingForSeek(base::TimeDelta seek_time) {}
+
+void DemuxerTracePlayer::CancelPendingSeek(base::TimeDelta seek_time) {}
+
+void DemuxerTracePlayer::Seek(base::TimeDelta time,
+                              PipelineStatusCallback status_cb) {
+  status_cb = BindToCurrentLoop(std::move(status_cb));
+
+  // Mirror DemuxerTraceRecorder, which only starts a segment once the previous
+  // one has reads.
+  bool has_returned_reads = false;
+  for (const auto& stream : streams_)
+    has_returned_reads |= stream->has_returned_reads();
+  if (has_returned_reads) {
+    if (current_segment_ + 1 == trace_->segments.size()) {
+      DLOG(ERROR) << "The trace has no seek to " << time;
+      std::move(status_cb).Run(PIPELINE_ERROR_INVALID_STATE);
+      return;
+    }
+    ++current_segment_;
+  }
+
+  const DemuxerTrace::Segment& segment = trace_->segments[current_segment_];
+  DLOG_IF(WARNING, time != segment.seek_time)
+      << "Seeking to " << time << " while the trace sought to "
+      << segment.seek_time;
+
+  // Streams have no pending reads here since the pipeline aborts them first.
+  segment_ended_ = false;
+  for (size_t i = 0; i < streams_.size(); ++i)
+    streams_[i]->SetReads(&segment.reads[i]);
+  std::move(status_cb).Run(PIPELINE_OK);
+}
+
+void DemuxerTracePlayer::Stop() {
+  AbortPendingReads();
+}
+
+base::TimeDelta DemuxerTracePlayer::GetStartTime() const {
+  return trace_->start_time;
+}
+
+base::Time DemuxerTracePlayer::GetTimelineOffset() const {
+  return base::Time();
+}
+
+int64_t DemuxerTracePlayer::GetMemoryUsage() const {
+  return 0;
+}
+
+absl::optional<container_names::MediaContainerName>
+DemuxerTracePlayer::GetContainerForMetrics() const {
+  return absl::nullopt;
+}
+
+void DemuxerTracePlayer::OnEnabledAudioTracksChanged(
+    const std::vector<MediaTrack::Id>& track_ids,
+    base::TimeDelta curr_time,
+    TrackChangeCB change_completed_cb) {
+  // Traces do not record track changes, so every stream stays enabled.
+  std::vector<DemuxerStream*> streams;
+  for (const auto& stream : streams_) {
+    if (stream->type() == DemuxerStream::AUDIO)
+      streams.push_back(stream.get());
+  }
+  std::move(change_completed_cb).Run(DemuxerStream::AUDIO, streams);
+}
+
+void DemuxerTracePlayer::OnSelectedVideoTrackChanged(
+    const std::vector<MediaTrack::Id>& track_ids,
+    base::TimeDelta curr_time,
+    TrackChangeCB change_completed_cb) {
+  std::vector<DemuxerStream*> streams;
+  for (const auto& stream : streams_) {
+    if (stream->type() == DemuxerStream::VIDEO)
+      streams.push_back(stream.get());
+  }
+  std::move(change_completed_cb).Run(DemuxerStream::VIDEO, streams);
+}
+
+bool DemuxerTracePlayer::OnStreamStarved() {
+  if (current_segment_ + 1 == trace_->segments.size())
+    return false;
+
+  if (!segment_ended_) {
+    segment_ended_ = true;
+    if (segment_ended_cb_) {
+      base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE,
+                                                    segment_ended_cb_);
+    }
+  }
+  return true;
+}
+
+}  // namespace media
@@ -0,0 +1,81 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_TEST_DEMUXER_TRACE_PLAYER_H_
+#define MEDIA_TEST_DEMUXER_TRACE_PLAYER_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "media/base/demuxer.h"
+#include "media/test/demuxer_trace.h"
+
+namespace media {
+
+// A Demuxer that returns the reads of a DemuxerTrace instead of parsing media.
+// Each Seek() after reads have been returned moves on to the next segment of
+// the trace, so the client must repeat the seeks of the recorded session, in
+// order; see set_segment_ended_cb().
+class DemuxerTracePlayer : public Demuxer {
+ public:
+  // |trace| must outlive the player.
+  explicit DemuxerTracePlayer(const DemuxerTrace* trace);
+  DemuxerTracePlayer(const DemuxerTracePlayer&) = delete;
+  DemuxerTracePlayer& operator=(const DemuxerTracePlayer&) = delete;
+  ~DemuxerTracePlayer() override;
+
+  // Sets a callback run when a stream is asked for a read past the end of a
+  // segment that is followed by another, i.e. when the recorded session
+  // sought. The read stays pending until the next Seek(). Other streams may
+  // have a few recorded reads left at that point, which the seek skips.
+  void set_segment_ended_cb(base::RepeatingClosure segment_ended_cb) {
+    segment_ended_cb_ = std::move(segment_ended_cb);
+  }
+
+  // MediaResource implementation.
+  std::vector<DemuxerStream*> GetAllStreams() override;
+
+  // Demuxer implementation.
+  std::string GetDisplayName() const override;
+  void Initialize(DemuxerHost* host, PipelineStatusCallback status_cb) override;
+  void AbortPendingReads() override;
+  void StartWaitingForSeek(base::TimeDelta seek_time) override;
+  void CancelPendingSeek(base::TimeDelta seek_time) override;
+  void Seek(base::TimeDelta time, PipelineStatusCallback status_cb) override;
+  void Stop() override;
+  base::TimeDelta GetStartTime() const override;
+  base::Time GetTimelineOffset() const override;
+  int64_t GetMemoryUsage() const override;
+  absl::optional<container_names::MediaContainerName> GetContainerForMetrics()
+      const override;
+  void OnEnabledAudioTracksChanged(const std::vector<MediaTrack::Id>& track_ids,
+                                   base::TimeDelta curr_time,
+                                   TrackChangeCB change_completed_cb) override;
+  void OnSelectedVideoTrackChanged(const std::vector<MediaTrack::Id>& track_ids,
+                                   base::TimeDelta curr_time,
+                                   TrackChangeCB change_completed_cb) override;
+
+ private:
+  class TraceStream;
+
+  // Called by a stream that has a read pending and no reads left in the
+  // current segment. Returns false if this is the last segment, in which case
+  // the stream ends instead, so that traces recorded up to a Stop() in the
+  // middle of the media still end.
+  bool OnStreamStarved();
+
+  const DemuxerTrace* const trace_;
+  std::vector<std::unique_ptr<TraceStream>> streams_;
+  size_t current_segment_ = 0;
+  bool segment_ended_ = false;
+  base::RepeatingClosure segment_ended_cb_;
+};
+
+}  // namespace media
+
+#endif  // MEDIA_TEST_DEMUXER_TRACE_PLAYER_H_
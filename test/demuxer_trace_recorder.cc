@@ -0,0 +1,210 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/test/demuxer_trace_recorder.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/check.h"
+
+namespace media {
+
+// Forwards to a stream of the wrapped demuxer and hands each successful read
+// to the recorder before returning it.
+class DemuxerTraceRecorder::RecordingStream : public DemuxerStream {
+ public:
+  RecordingStream(DemuxerTraceRecorder* recorder,
+                  size_t index,
+                  DemuxerStream* stream)
+      : recorder_(recorder), index_(index), stream_(stream) {}
+  RecordingStream(const RecordingStream&) = delete;
+  RecordingStream& operator=(const RecordingStream&) = delete;
+  ~RecordingStream() override = default;
+
+  // DemuxerStream implementation.
+  void Read(ReadCB read_cb) override {
+    stream_->Read(base::BindOnce(&RecordingStream::OnRead,
+                                 weak_factory_.GetWeakPtr(),
+                                 std::move(read_cb)));
+  }
+  AudioDecoderConfig audio_decoder_config() override {
+    return stream_->audio_decoder_config();
+  }
+  VideoDecoderConfig video_decoder_config() override {
+    return stream_->video_decoder_config();
+  }
+  Type type() const override { return stream_->type(); }
+  Liveness liveness() const override { return stream_->liveness(); }
+  void EnableBitstreamConverter() override {
+    stream_->EnableBitstreamConverter();
+  }
+  bool SupportsConfigChanges() override {
+    return stream_->SupportsConfigChanges();
+  }
+
+ private:
+  void OnRead(ReadCB read_cb,
+              Status status,
+              scoped_refptr<DecoderBuffer> buffer) {
+    if (status == kOk || status == kConfigChanged) {
+      DemuxerTrace::Read read;
+      read.buffer = buffer;
+      if (status == kConfigChanged && type() == AUDIO)
+        read.audio_config = stream_->audio_decoder_config();
+      else if (status == kConfigChanged)
+        read.video_config = stream_->video_decoder_config();
+      recorder_->OnRead(index_, std::move(read));
+    }
+    std::move(read_cb).Run(status, std::move(buffer));
+  }
+
+  DemuxerTraceRecorder* const recorder_;
+  const size_t index_;
+  DemuxerStream* const stream_;
+
+  base::WeakPtrFactory<RecordingStream> weak_factory_{this};
+};
+
+DemuxerTraceRecorder::DemuxerTraceRecorder(std::unique_ptr<Demuxer> demuxer)
+    : demuxer_(std::move(demuxer)) {}
+
+DemuxerTraceRecorder::~DemuxerTraceRecorder() = default;
+
+std::vector<DemuxerStream*> DemuxerTraceRecorder::GetAllStreams() {
+  std::vector<DemuxerStream*> streams;
+  for (const auto& stream : streams_)
+    streams.push_back(stream.get());
+  return streams;
+}
+
+std::string DemuxerTraceRecorder::GetDisplayName() const {
+  return demuxer_->GetDisplayName();
+}
+
+void DemuxerTraceRecorder::Initialize(DemuxerHost* host,
+                                      PipelineStatusCallback status_cb) {
+  host_ = host;
+  demuxer_->Initialize(
+      this, base::BindOnce(&DemuxerTraceRecorder::OnInitialized,
+                           weak_factory_.GetWeakPtr(), std::move(status_cb)));
+}
+
+void DemuxerTraceRecorder::AbortPendingReads() {
+  demuxer_->AbortPendingReads();
+}
+
+void DemuxerTraceRecorder::StartWaitingForSeek(base::TimeDelta seek_time) {
+  demuxer_->StartWaitingForSeek(seek_time);
+}
+
+void DemuxerTraceRecorder::CancelPendingSeek(base::TimeDelta seek_time) {
+  demuxer_->CancelPendingSeek(seek_time);
+}
+
+void DemuxerTraceRecorder::Seek(base::TimeDelta time,
+                                PipelineStatusCallback status_cb) {
+  // A seek that follows another without any read in between, e.g. the initial
+  // seek, replaces it instead of leaving an empty segment behind.
+  DCHECK(!trace_.segments.empty());
+  bool has_reads = false;
+  for (const auto& stream_reads : trace_.segments.back().reads)
+    has_reads |= !stream_reads.empty();
+  if (has_reads) {
+    trace_.segments.emplace_back();
+    trace_.segments.back().reads.resize(trace_.streams.size());
+  }
+  trace_.segments.back().seek_time = time;
+
+  demuxer_->Seek(time, std::move(status_cb));
+}
+
+void DemuxerTraceRecorder::Stop() {
+  demuxer_->Stop();
+}
+
+base::TimeDelta DemuxerTraceRecorder::GetStartTime() const {
+  return demuxer_->GetStartTime();
+}
+
+base::Time DemuxerTraceRecorder::GetTimelineOffset() const {
+  return demuxer_->GetTimelineOffset();
+}
+
+int64_t DemuxerTraceRecorder::GetMemoryUsage() const {
+  return demuxer_->GetMemoryUsage();
+}
+
+absl::optional<container_names::MediaContainerName>
+DemuxerTraceRecorder::GetContainerForMetrics() const {
+  return demuxer_->GetContainerForMetrics();
+}
+
+void DemuxerTraceRecorder::OnEnabledAudioTracksChanged(
+    const std::vector<MediaTrack::Id>& track_ids,
+    base::TimeDelta curr_time,
+    TrackChangeCB change_completed_cb) {
+  demuxer_->OnEnabledAudioTracksChanged(track_ids, curr_time,
+                                        std::move(change_completed_cb));
+}
+
+void DemuxerTraceRecorder::OnSelectedVideoTrackChanged(
+    const std::vector<MediaTrack::Id>& track_ids,
+    base::TimeDelta curr_time,
+    TrackChangeCB change_completed_cb) {
+  demuxer_->OnSelectedVideoTrackChanged(track_ids, curr_time,
+                                        std::move(change_completed_cb));
+}
+
+void DemuxerTraceRecorder::OnBufferedTimeRangesChanged(
+    const Ranges<base::TimeDelta>& ranges) {
+  host_->OnBufferedTimeRangesChanged(ranges);
+}
+
+void DemuxerTraceRecorder::SetDuration(base::TimeDelta duration) {
+  trace_.duration = duration;
+  host_->SetDuration(duration);
+}
+
+void DemuxerTraceRecorder::OnDemuxerError(PipelineStatus error) {
+  host_->OnDemuxerError(error);
+}
+
+void DemuxerTraceRecorder::OnInitialized(PipelineStatusCallback status_cb,
+                                         PipelineStatus status) {
+  if (status == PIPELINE_OK) {
+    trace_.start_time = demuxer_->GetStartTime();
+    for (DemuxerStream* stream : demuxer_->GetAllStreams()) {
+      // Text tracks are rendered outside of the media pipeline.
+      if (stream->type() != DemuxerStream::AUDIO &&
+          stream->type() != DemuxerStream::VIDEO) {
+        continue;
+      }
+
+      DemuxerTrace::Stream trace_stream;
+      trace_stream.type = stream->type();
+      trace_stream.liveness = stream->liveness();
+      trace_stream.supports_config_changes = stream->SupportsConfigChanges();
+      if (stream->type() == DemuxerStream::AUDIO)
+        trace_stream.audio_config = stream->audio_decoder_config();
+      else
+        trace_stream.video_config = stream->video_decoder_config();
+      trace_.streams.push_back(std::move(trace_stream));
+
+      streams_.push_back(
+          std::make_unique<RecordingStream>(this, streams_.size(), stream));
+    }
+    trace_.segments.emplace_back();
+    trace_.segments.back().reads.resize(trace_.streams.size());
+  }
+  std::move(status_cb).Run(status);
+}
+
+void DemuxerTraceRecorder::OnRead(size_t stream_index,
+                                  DemuxerTrace::Read read) {
+  trace_.segments.back().reads[stream_index].push_back(std::move(read));
+}
+
+}  // namespace media
@@ -0,0 +1,76 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_TEST_DEMUXER_TRACE_RECORDER_H_
+#define MEDIA_TEST_DEMUXER_TRACE_RECORDER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/weak_ptr.h"
+#include "media/base/demuxer.h"
+#include "media/test/demuxer_trace.h"
+
+namespace media {
+
+// Wraps a Demuxer and records every successful read of its streams, and every
+// seek, into a DemuxerTrace. Aborted reads are not recorded since they do not
+// reach the decoders, and neither are track changes.
+class DemuxerTraceRecorder : public Demuxer, private DemuxerHost {
+ public:
+  explicit DemuxerTraceRecorder(std::unique_ptr<Demuxer> demuxer);
+  DemuxerTraceRecorder(const DemuxerTraceRecorder&) = delete;
+  DemuxerTraceRecorder& operator=(const DemuxerTraceRecorder&) = delete;
+  ~DemuxerTraceRecorder() override;
+
+  // The reads recorded so far. Has no streams until Initialize() succeeds.
+  const DemuxerTrace& trace() const { return trace_; }
+
+  // MediaResource implementation.
+  std::vector<DemuxerStream*> GetAllStreams() override;
+
+  // Demuxer implementation.
+  std::string GetDisplayName() const override;
+  void Initialize(DemuxerHost* host, PipelineStatusCallback status_cb) override;
+  void AbortPendingReads() override;
+  void StartWaitingForSeek(base::TimeDelta seek_time) override;
+  void CancelPendingSeek(base::TimeDelta seek_time) override;
+  void Seek(base::TimeDelta time, PipelineStatusCallback status_cb) override;
+  void Stop() override;
+  base::TimeDelta GetStartTime() const override;
+  base::Time GetTimelineOffset() const override;
+  int64_t GetMemoryUsage() const override;
+  absl::optional<container_names::MediaContainerName> GetContainerForMetrics()
+      const override;
+  void OnEnabledAudioTracksChanged(const std::vector<MediaTrack::Id>& track_ids,
+                                   base::TimeDelta curr_time,
+                                   TrackChangeCB change_completed_cb) override;
+  void OnSelectedVideoTrackChanged(const std::vector<MediaTrack::Id>& track_ids,
+                                   base::TimeDelta curr_time,
+                                   TrackChangeCB change_completed_cb) override;
+
+ private:
+  class RecordingStream;
+
+  // DemuxerHost implementation.
+  void OnBufferedTimeRangesChanged(
+      const Ranges<base::TimeDelta>& ranges) override;
+  void SetDuration(base::TimeDelta duration) override;
+  void OnDemuxerError(PipelineStatus error) override;
+
+  void OnInitialized(PipelineStatusCallback status_cb, PipelineStatus status);
+  void OnRead(size_t stream_index, DemuxerTrace::Read read);
+
+  const std::unique_ptr<Demuxer> demuxer_;
+  DemuxerHost* host_ = nullptr;
+  std::vector<std::unique_ptr<RecordingStream>> streams_;
+  DemuxerTrace trace_;
+
+  base::WeakPtrFactory<DemuxerTraceRecorder> weak_factory_{this};
+};
+
+}  // namespace media
+
+#endif  // MEDIA_TEST_DEMUXER_TRACE_RECORDER_H_
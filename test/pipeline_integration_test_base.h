@@ -224,8 +224,9 @@ class PipelineIntegrationTestBase : public Pipeline::Client {
   void QuitAfterCurrentTimeTask(base::TimeDelta quit_time,
                                 base::OnceClosure quit_closure);
 
-  // Creates Demuxer and sets |demuxer_|.
-  void CreateDemuxer(std::unique_ptr<DataSource> data_source);
+  // Creates Demuxer and sets |demuxer_|. Subclasses may override this to wrap
+  // or replace the demuxer.
+  virtual void CreateDemuxer(std::unique_ptr<DataSource> data_source);
 
   void OnVideoFramePaint(scoped_refptr<VideoFrame> frame);
 
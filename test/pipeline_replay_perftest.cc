@@ -0,0 +1,230 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/pickle.h"
+#include "base/process/process_metrics.h"
+#include "base/run_loop.h"
+#include "base/time/time.h"
+#include "media/base/pipeline_latency_profiler.h"
+#include "media/test/demuxer_trace.h"
+#include "media/test/demuxer_trace_player.h"
+#include "media/test/demuxer_trace_recorder.h"
+#include "media/test/pipeline_integration_test_base.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace media {
+
+// Replays the DemuxerTrace at this path in DemuxerTraceReplayPerfTest.FromFile.
+static const char kDemuxerTraceSwitch[] = "demuxer-trace";
+
+// Saves the traces recorded by the other tests in this directory.
+static const char kSaveDemuxerTracesSwitch[] = "save-demuxer-traces";
+
+static const int kReplayIterations = 10;
+
+// Records the demuxer reads of the session it plays when constructed without a
+// trace, and replays |trace| instead of demuxing a file otherwise.
+class TracePipeline : public PipelineIntegrationTestBase {
+ public:
+  explicit TracePipeline(const DemuxerTrace* trace = nullptr)
+      : trace_(trace) {}
+
+  // Starts replaying |trace_|.
+  PipelineStatus StartReplay() {
+    DCHECK(trace_);
+    return StartInternal(nullptr, nullptr, kNormal);
+  }
+
+  // Plays |trace_| to the end, seeking wherever the recorded session did.
+  bool ReplayToEnd() {
+    Play();
+    for (size_t i = 1; i < trace_->segments.size(); ++i) {
+      if (!segment_ended_ && !ended_) {
+        base::RunLoop run_loop;
+        quit_closure_ = run_loop.QuitClosure();
+        run_loop.Run();
+      }
+      segment_ended_ = false;
+      if (!Seek(trace_->segments[i].seek_time))
+        return false;
+    }
+    return WaitUntilOnEnded();
+  }
+
+  const DemuxerTrace& recorded_trace() const { return recorder_->trace(); }
+
+  PipelineStatistics GetStatistics() const {
+    return pipeline_->GetStatistics();
+  }
+
+ protected:
+  void CreateDemuxer(std::unique_ptr<DataSource> data_source) override {
+    if (trace_) {
+      auto player = std::make_unique<DemuxerTracePlayer>(trace_);
+      player->set_segment_ended_cb(base::BindRepeating(
+          &TracePipeline::OnSegmentEnded, base::Unretained(this)));
+      demuxer_ = std::move(player);
+      return;
+    }
+
+    PipelineIntegrationTestBase::CreateDemuxer(std::move(data_source));
+    auto recorder = std::make_unique<DemuxerTraceRecorder>(std::move(demuxer_));
+    recorder_ = recorder.get();
+    demuxer_ = std::move(recorder);
+  }
+
+  void OnEnded() override {
+    PipelineIntegrationTestBase::OnEnded();
+    if (quit_closure_)
+      std::move(quit_closure_).Run();
+  }
+
+ private:
+  void OnSegmentEnded() {
+    segment_ended_ = true;
+    if (quit_closure_)
+      std::move(quit_closure_).Run();
+  }
+
+  const DemuxerTrace* const trace_;
+  DemuxerTraceRecorder* recorder_ = nullptr;
+  bool segment_ended_ = false;
+  base::OnceClosure quit_closure_;
+};
+
+// Plays |filename| with a seek from |seek_from| back to |seek_to|, and returns
+// the reads it made, after a round trip through the file format.
+static std::unique_ptr<DemuxerTrace> RecordTrace(const std::string& filename,
+                                                 base::TimeDelta seek_from,
+                                                 base::TimeDelta seek_to) {
+  TracePipeline pipeline;
+  EXPECT_EQ(PIPELINE_OK, pipeline.Start(filename));
+  pipeline.Play();
+  EXPECT_TRUE(pipeline.WaitUntilCurrentTimeIsAfter(seek_from));
+  EXPECT_TRUE(pipeline.Seek(seek_to));
+  EXPECT_TRUE(pipeline.WaitUntilOnEnded());
+  pipeline.Stop();
+
+  const DemuxerTrace& recorded_trace = pipeline.recorded_trace();
+  EXPECT_EQ(recorded_trace.segments.size(), 2u);
+
+  base::Pickle pickle;
+  recorded_trace.Serialize(&pickle);
+  std::unique_ptr<DemuxerTrace> trace = DemuxerTrace::Deserialize(pickle);
+  if (!trace) {
+    ADD_FAILURE() << "Failed to deserialize the trace of " << filename;
+    return nullptr;
+  }
+  EXPECT_EQ(trace->GetBufferCount(), recorded_trace.GetBufferCount());
+
+  const base::FilePath save_dir =
+      base::CommandLine::ForCurrentProcess()->GetSwitchValuePath(
+          kSaveDemuxerTracesSwitch);
+  if (!save_dir.empty())
+    EXPECT_TRUE(trace->WriteToFile(save_dir.AppendASCII(filename + ".trace")));
+
+  return trace;
+}
+
+// Replays |trace| as fast as the decoders and renderers allow, and reports the
+// wall and process CPU time, and the video frame counts, per replay along with
+// the latency of each pipeline stage.
+static void RunReplayBenchmark(const DemuxerTrace& trace,
+                               const std::string& story) {
+  PipelineLatencyProfiler* profiler = PipelineLatencyProfiler::GetInstance();
+  profiler->Reset();
+  profiler->SetEnabled(true);
+
+  std::unique_ptr<base::ProcessMetrics> process_metrics =
+      base::ProcessMetrics::CreateCurrentProcessMetrics();
+  base::TimeDelta wall_time;
+  base::TimeDelta cpu_time;
+  uint64_t video_frames_decoded = 0;
+  uint64_t video_frames_dropped = 0;
+
+  for (int i = 0; i < kReplayIterations; ++i) {
+    TracePipeline pipeline(&trace);
+    ASSERT_EQ(PIPELINE_OK, pipeline.StartReplay());
+
+    const base::TimeTicks start = base::TimeTicks::Now();
+    const base::TimeDelta cpu_start = process_metrics->GetCumulativeCPUUsage();
+    ASSERT_TRUE(pipeline.ReplayToEnd());
+    cpu_time += process_metrics->GetCumulativeCPUUsage() - cpu_start;
+    wall_time += base::TimeTicks::Now() - start;
+
+    const PipelineStatistics statistics = pipeline.GetStatistics();
+    video_frames_decoded += statistics.video_frames_decoded;
+    video_frames_dropped += statistics.video_frames_dropped;
+    pipeline.Stop();
+  }
+
+  profiler->SetEnabled(false);
+
+  perf_test::PerfResultReporter reporter("demuxer_trace_replay", story);
+  reporter.RegisterImportantMetric("_wall_time", "ms");
+  reporter.RegisterImportantMetric("_cpu_time", "ms");
+  reporter.RegisterImportantMetric("_video_frames_decoded", "count");
+  reporter.RegisterImportantMetric("_video_frames_dropped", "count");
+  reporter.AddResult("_wall_time",
+                     wall_time.InMillisecondsF() / kReplayIterations);
+  reporter.AddResult("_cpu_time",
+                     cpu_time.InMillisecondsF() / kReplayIterations);
+  reporter.AddResult("_video_frames_decoded",
+                     static_cast<double>(video_frames_decoded) /
+                         kReplayIterations);
+  reporter.AddResult("_video_frames_dropped",
+                     static_cast<double>(video_frames_dropped) /
+                         kReplayIterations);
+
+  for (const auto& kv : profiler->GetHistograms()) {
+    const std::string stage =
+        std::string("_") + DemuxerStream::GetTypeName(kv.first.first) + "_" +
+        GetPipelineStageName(kv.first.second);
+    reporter.RegisterImportantMetric(stage + "_p50", "us");
+    reporter.RegisterImportantMetric(stage + "_p99", "us");
+    reporter.AddResult(stage + "_p50",
+                       kv.second.Percentile(50).InMicrosecondsF());
+    reporter.AddResult(stage + "_p99",
+                       kv.second.Percentile(99).InMicrosecondsF());
+  }
+  profiler->Reset();
+}
+
+TEST(DemuxerTraceReplayPerfTest, VP8Vorbis) {
+  std::unique_ptr<DemuxerTrace> trace = RecordTrace(
+      "bear-320x240.webm", base::Milliseconds(1500), base::Milliseconds(500));
+  ASSERT_TRUE(trace);
+  RunReplayBenchmark(*trace, "bear-320x240.webm");
+}
+
+TEST(DemuxerTraceReplayPerfTest, VP9) {
+  std::unique_ptr<DemuxerTrace> trace = RecordTrace(
+      "bear-vp9.webm", base::Milliseconds(1500), base::Milliseconds(500));
+  ASSERT_TRUE(trace);
+  RunReplayBenchmark(*trace, "bear-vp9.webm");
+}
+
+TEST(DemuxerTraceReplayPerfTest, FromFile) {
+  const base::FilePath path =
+      base::CommandLine::ForCurrentProcess()->GetSwitchValuePath(
+          kDemuxerTraceSwitch);
+  if (path.empty())
+    GTEST_SKIP() << "No --" << kDemuxerTraceSwitch << " given";
+
+  std::unique_ptr<DemuxerTrace> trace = DemuxerTrace::ReadFromFile(path);
+  ASSERT_TRUE(trace) << "Failed to read " << path;
+  RunReplayBenchmark(*trace, path.BaseName().MaybeAsASCII());
+}
+
+}  // namespace media
@@ -3,12 +3,68 @@
 // found in the LICENSE file.
 
 #include "media/video/half_float_maker.h"
+
+#include "build/build_config.h"
 #include "third_party/libyuv/include/libyuv.h"
 
+// NaCl does not allow intrinsics.
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include <emmintrin.h>
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace media {
 
+namespace {
+
+// Sets the 0x3800 exponent bits on each of the |num| values in |src|. See
+// HalfFloatMaker_xor below for why this produces half-floats.
+void OrExponentRow(const uint16_t* src, size_t num, uint16_t* dst) {
+  size_t i = 0;
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+  const __m128i exponent = _mm_set1_epi16(0x3800);
+  for (; i + 16 <= num; i += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_or_si128(a, exponent));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8),
+                     _mm_or_si128(b, exponent));
+  }
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  const uint16x8_t exponent = vdupq_n_u16(0x3800);
+  for (; i + 16 <= num; i += 16) {
+    vst1q_u16(dst + i, vorrq_u16(vld1q_u16(src + i), exponent));
+    vst1q_u16(dst + i + 8, vorrq_u16(vld1q_u16(src + i + 8), exponent));
+  }
+#endif
+
+  // Handle any remaining values that wouldn't fit in a SIMD pass.
+  for (; i < num; i++)
+    dst[i] = src[i] | 0x3800;
+}
+
+}  // namespace
+
 HalfFloatMaker::~HalfFloatMaker() = default;
 
+void HalfFloatMaker::MakeHalfFloatsPlane(const uint16_t* src,
+                                         size_t src_stride,
+                                         uint16_t* dst,
+                                         size_t dst_stride,
+                                         size_t width,
+                                         size_t rows) {
+  const uint8_t* src_row = reinterpret_cast<const uint8_t*>(src);
+  uint8_t* dst_row = reinterpret_cast<uint8_t*>(dst);
+  for (size_t row = 0; row < rows; ++row) {
+    MakeHalfFloats(reinterpret_cast<const uint16_t*>(src_row), width,
+                   reinterpret_cast<uint16_t*>(dst_row));
+    src_row += src_stride;
+    dst_row += dst_stride;
+  }
+}
+
 // By OR-ing with 0x3800, 10-bit numbers become half-floats in the
 // range [0.5..1) and 9-bit numbers get the range [0.5..0.75).
 //
@@ -32,13 +88,23 @@ class HalfFloatMaker_xor : public HalfFloatMaker {
     return 2048.0 / max_input_value;
   }
   void MakeHalfFloats(const uint16_t* src, size_t num, uint16_t* dst) override {
-    // Micro-benchmarking indicates that the compiler does
-    // a good enough job of optimizing this loop that trying
-    // to manually operate on one uint64 at a time is not
-    // actually helpful.
-    // Note to future optimizers: Benchmark your optimizations!
-    for (size_t i = 0; i < num; i++)
-      dst[i] = src[i] | 0x3800;
+    // Note to future optimizers: Benchmark your optimizations! See
+    // half_float_maker_perftest.cc.
+    OrExponentRow(src, num, dst);
+  }
+  void MakeHalfFloatsPlane(const uint16_t* src,
+                           size_t src_stride,
+                           uint16_t* dst,
+                           size_t dst_stride,
+                           size_t width,
+                           size_t rows) override {
+    // When both planes are tightly packed the whole plane is one long row.
+    if (src_stride == dst_stride && src_stride == width * sizeof(uint16_t)) {
+      OrExponentRow(src, width * rows, dst);
+      return;
+    }
+    HalfFloatMaker::MakeHalfFloatsPlane(src, src_stride, dst, dst_stride, width,
+                                        rows);
   }
 
  private:
@@ -73,6 +139,18 @@ class HalfFloatMaker_libyuv : public HalfFloatMaker {
     libyuv::HalfFloatPlane(src, stride, dst, stride, libyuv_multiplier_, num,
                            rows);
   }
+  void MakeHalfFloatsPlane(const uint16_t* src,
+                           size_t src_stride,
+                           uint16_t* dst,
+                           size_t dst_stride,
+                           size_t width,
+                           size_t rows) override {
+    // libyuv picks the fastest row function available at runtime (F16C/AVX2,
+    // SSE2 or NEON), so hand it the whole plane rather than a row at a time.
+    libyuv::HalfFloatPlane(src, static_cast<int>(src_stride), dst,
+                           static_cast<int>(dst_stride), libyuv_multiplier_,
+                           static_cast<int>(width), static_cast<int>(rows));
+  }
 
  private:
   float libyuv_multiplier_;
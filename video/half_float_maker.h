@@ -24,6 +24,16 @@ class MEDIA_EXPORT HalfFloatMaker {
   virtual void MakeHalfFloats(const uint16_t* src,
                               size_t num,
                               uint16_t* dst) = 0;
+  // Convert a plane of |rows| rows of |width| short integers into half-floats.
+  // |src_stride| and |dst_stride| are in bytes. This is equivalent to calling
+  // MakeHalfFloats() once per row, but lets implementations convert the whole
+  // plane in a single pass.
+  virtual void MakeHalfFloatsPlane(const uint16_t* src,
+                                   size_t src_stride,
+                                   uint16_t* dst,
+                                   size_t dst_stride,
+                                   size_t width,
+                                   size_t rows);
   // The half-floats made needs by this class will be in the range
   // [Offset() .. Offset() + 1.0/Multiplier]. So if you want results
   // in the 0-1 range, you need to do:
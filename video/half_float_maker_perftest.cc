@@ -0,0 +1,85 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+
+#include "base/time/time.h"
+#include "media/base/video_frame.h"
+#include "media/video/half_float_maker.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace media {
+
+namespace {
+
+constexpr int kBenchmarkIterations = 50;
+constexpr gfx::Size k4KSize(3840, 2160);
+
+// Stride of the half-float staging buffer, rounded up to the 4 byte GL unpack
+// alignment used by VideoResourceUpdater.
+size_t UploadStride(int width) {
+  return (width * sizeof(uint16_t) + 3) & ~3;
+}
+
+void RunUploadPreparationBenchmark(VideoPixelFormat format,
+                                   int bits_per_channel,
+                                   const std::string& story) {
+  scoped_refptr<VideoFrame> frame = VideoFrame::CreateFrame(
+      format, k4KSize, gfx::Rect(k4KSize), k4KSize, base::TimeDelta());
+  ASSERT_TRUE(frame);
+  const size_t num_planes = VideoFrame::NumPlanes(format);
+  const uint16_t max_value = (1 << bits_per_channel) - 1;
+  size_t staging_size = 0;
+  for (size_t plane = 0; plane < num_planes; ++plane) {
+    const gfx::Size plane_size =
+        VideoFrame::PlaneSizeInSamples(format, plane, k4KSize);
+    uint16_t* data = reinterpret_cast<uint16_t*>(frame->data(plane));
+    const size_t num_values = frame->stride(plane) / 2 * plane_size.height();
+    for (size_t i = 0; i < num_values; ++i)
+      data[i] = i & max_value;
+    staging_size += UploadStride(plane_size.width()) * plane_size.height();
+  }
+  std::unique_ptr<uint8_t[]> staging(new uint8_t[staging_size]);
+
+  std::unique_ptr<HalfFloatMaker> half_float_maker =
+      HalfFloatMaker::NewHalfFloatMaker(bits_per_channel);
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kBenchmarkIterations; ++i) {
+    uint8_t* dst = staging.get();
+    for (size_t plane = 0; plane < num_planes; ++plane) {
+      const gfx::Size plane_size =
+          VideoFrame::PlaneSizeInSamples(format, plane, k4KSize);
+      const size_t dst_stride = UploadStride(plane_size.width());
+      half_float_maker->MakeHalfFloatsPlane(
+          reinterpret_cast<const uint16_t*>(frame->data(plane)),
+          frame->stride(plane), reinterpret_cast<uint16_t*>(dst), dst_stride,
+          plane_size.width(), plane_size.height());
+      dst += dst_stride * plane_size.height();
+    }
+  }
+  const double elapsed = (base::TimeTicks::Now() - start).InSecondsF();
+
+  perf_test::PerfResultReporter reporter("half_float_maker", story);
+  reporter.RegisterImportantMetric("_upload_preparation", "runs/s");
+  reporter.AddResult("_upload_preparation", kBenchmarkIterations / elapsed);
+}
+
+}  // namespace
+
+// Benchmarks conversion of all planes of a 4K 10-bit frame into the half-float
+// layout uploaded by VideoResourceUpdater.
+TEST(HalfFloatMakerPerfTest, I010_4K) {
+  RunUploadPreparationBenchmark(PIXEL_FORMAT_YUV420P10, 10, "i010_4k");
+}
+
+// Same as above for 12-bit content, which takes the libyuv path.
+TEST(HalfFloatMakerPerfTest, I012_4K) {
+  RunUploadPreparationBenchmark(PIXEL_FORMAT_YUV420P12, 12, "i012_4k");
+}
+
+}  // namespace media
@@ -64,4 +64,43 @@ TEST_F(HalfFloatMakerTest, MakeHalfFloatTest) {
   }
 }
 
+TEST_F(HalfFloatMakerTest, MakeHalfFloatsPlaneMatchesRows) {
+  constexpr size_t kWidth = 37;
+  constexpr size_t kRows = 5;
+  constexpr size_t kSrcStride = 48;
+  constexpr size_t kDstStride = 40;
+  uint16_t src[kSrcStride * kRows];
+  for (size_t i = 0; i < kSrcStride * kRows; i++)
+    src[i] = (i * 7) & 0x3FF;
+
+  for (int bits : {10, 12, 16}) {
+    std::unique_ptr<media::HalfFloatMaker> half_float_maker =
+        media::HalfFloatMaker::NewHalfFloatMaker(bits);
+
+    uint16_t plane[kDstStride * kRows] = {};
+    half_float_maker->MakeHalfFloatsPlane(src, kSrcStride * sizeof(uint16_t),
+                                          plane, kDstStride * sizeof(uint16_t),
+                                          kWidth, kRows);
+    for (size_t row = 0; row < kRows; row++) {
+      uint16_t expected[kWidth];
+      half_float_maker->MakeHalfFloats(src + row * kSrcStride, kWidth,
+                                       expected);
+      for (size_t i = 0; i < kWidth; i++) {
+        EXPECT_EQ(expected[i], plane[row * kDstStride + i])
+            << "bits = " << bits << " row = " << row << " i = " << i;
+      }
+    }
+
+    // Tightly packed planes may be converted as a single row.
+    uint16_t packed[kWidth * kRows];
+    half_float_maker->MakeHalfFloatsPlane(src, kWidth * sizeof(uint16_t),
+                                          packed, kWidth * sizeof(uint16_t),
+                                          kWidth, kRows);
+    uint16_t expected[kWidth * kRows];
+    half_float_maker->MakeHalfFloats(src, kWidth * kRows, expected);
+    for (size_t i = 0; i < kWidth * kRows; i++)
+      EXPECT_EQ(expected[i], packed[i]) << "bits = " << bits << " i = " << i;
+  }
+}
+
 }  // namespace media